@@ -8,6 +8,8 @@
 //     -4 incorect file type
 //     -5 file size mismatch (filesize does not match expected filesize)
 //     -6 not yet implemented
+//     -7 file write failure
+//     -8 cancelled by the user
 
 #define APP_SUCCESS	1
 #define APPERR_PARAMETER 0
@@ -17,3 +19,5 @@
 #define APPERR_FILETYPE -4
 #define APPERR_FILESIZE -5
 #define APPERR_NYI -6
+#define APPERR_FILEWRITE -7
+#define APPERR_CANCELLED -8
@@ -61,6 +61,8 @@
 // V1.2.10.1 2023-11-5  Changed, Export file, output file default is same as input file with .bmp extension
 //                      Changed, ExportBMP, added automatically saving a matching .png using a global flag  
 // V1.3.1.1 2023-12-6   Moved app functions from FileFunction.cpp to AppFunctions.cpp
+// V1.3.2.1 2026-10-14  Added file write error message
+//                      Added cancelled message
 //
 #include "framework.h"
 #include "resource.h"
@@ -414,6 +416,14 @@ void MessageMySETIappError(HWND hWnd, int ErrNo, const wchar_t* Title) {
         MessageBox(hWnd, L"Not yet implemented", Title, MB_OK);
         break;
 
+    case -7:
+        MessageBox(hWnd, L"File write error", Title, MB_OK);
+        break;
+
+    case -8:
+        MessageBox(hWnd, L"Cancelled", Title, MB_OK);
+        break;
+
     default:
         break;
     }
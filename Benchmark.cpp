@@ -0,0 +1,415 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// Benchmark.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Benchmark of the core functions, run by 'MySETIcli bench'
+//
+// The input files are generated in a work folder: an image file of the
+// requested size, number of frames and pixel size, a packed bitstream with
+// one bit per pixel of the image, a SPP stream of about the same number of
+// bytes as the image and the reordering and convolution kernel files.
+// Each function is run Repeat times on these and the fastest run is reported
+// with its throughput in pixels and bits per second.  The bits are the bits
+// of the input (Xsize*Ysize*NumFrames*PixelSize*8 for the image functions).
+// The generated files are deleted afterwards.
+//
+// The result cache is not enabled in the console version so every run is
+// computed.
+//
+// V1.3.2.1 2026-10-14  Initial release
+//
+#include "framework.h"
+#include <stdio.h>
+#include <wchar.h>
+#include <functional>
+#include <vector>
+#include "AppErrors.h"
+#include "imaging.h"
+#include "ImageIO.h"
+#include "bitstream.h"
+#include "FileFunctions.h"
+#include "Timing.h"
+#include "Benchmark.h"
+
+#define BENCH_APID		100		// APID extracted from the SPP stream
+#define BENCH_SPP_DATA	1024	// SPP data field size in bytes
+
+typedef struct BENCHFILE {
+	const WCHAR* Name;
+	WCHAR Path[MAX_PATH];
+} BENCHFILE;
+
+static int WriteBenchImage(WCHAR* Filename, int Xsize, int Ysize, int NumFrames, int PixelSize);
+static int WriteBenchBits(WCHAR* Filename, ULONGLONG NumBits);
+static int WriteBenchSPP(WCHAR* Filename, ULONGLONG NumBytes);
+static int WriteBenchText(WCHAR* Filename, const char* Text);
+
+//*****************************************************************************************
+//
+//	RunBenchmark
+//
+//	Run the benchmark and print the results to the console
+//
+// Parameters:
+//	WCHAR* Folder			work folder for the generated files
+//	int Xsize				image x size, must be a multiple of 4 (reordering kernel size)
+//	int Ysize				image y size, must be a multiple of 4
+//	int NumFrames			# of frames in the image
+//	int PixelSize			1, 2 or 4 bytes per pixel
+//	int Repeat				# of times each function is run, the fastest is reported
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//		of the first function that failed
+//
+//*****************************************************************************************
+int RunBenchmark(WCHAR* Folder, int Xsize, int Ysize, int NumFrames, int PixelSize, int Repeat)
+{
+	BENCHFILE Files[] = {
+		{ L"bench_image.raw" },		// 0
+		{ L"bench_output.raw" },	// 1
+		{ L"bench_bits.bin" },		// 2
+		{ L"bench_spp.bin" },		// 3
+		{ L"bench_apid.csv" },		// 4
+		{ L"bench_reorder.txt" },	// 5
+		{ L"bench_kernel.txt" },	// 6
+		{ L"bench_output.bmp" },	// 7
+	};
+	WCHAR* ImageFile = Files[0].Path;
+	WCHAR* OutputFile = Files[1].Path;
+	WCHAR* BitsFile = Files[2].Path;
+	WCHAR* SPPFile = Files[3].Path;
+	WCHAR* APIDFile = Files[4].Path;
+	WCHAR* ReorderFile = Files[5].Path;
+	WCHAR* KernelFile = Files[6].Path;
+	WCHAR* BMPFile = Files[7].Path;
+	int NumFiles = sizeof(Files) / sizeof(BENCHFILE);
+	double NumPixels;
+	double ImageBits;
+	int FirstError = APP_SUCCESS;
+	int iRes;
+
+	if (Xsize <= 0 || Ysize <= 0 || (Xsize % 4) != 0 || (Ysize % 4) != 0) {
+		fwprintf(stderr, L"Benchmark image x and y sizes must be multiples of 4\n");
+		return APPERR_PARAMETER;
+	}
+	if (NumFrames < 1 || NumFrames > 32767 || (PixelSize != 1 && PixelSize != 2 && PixelSize != 4)) {
+		fwprintf(stderr, L"Benchmark needs 1 to 32767 frames and a pixel size of 1, 2 or 4\n");
+		return APPERR_PARAMETER;
+	}
+	if (Repeat < 1) {
+		Repeat = 1;
+	}
+
+	for (int i = 0; i < NumFiles; i++) {
+		swprintf_s(Files[i].Path, MAX_PATH, L"%s\\%s", Folder, Files[i].Name);
+	}
+
+	NumPixels = (double)Xsize * (double)Ysize * (double)NumFrames;
+	ImageBits = NumPixels * (double)PixelSize * 8.0;
+
+	// generate the inputs
+	iRes = WriteBenchImage(ImageFile, Xsize, Ysize, NumFrames, PixelSize);
+	if (iRes == APP_SUCCESS) {
+		iRes = WriteBenchBits(BitsFile, (ULONGLONG)NumPixels);
+	}
+	if (iRes == APP_SUCCESS) {
+		iRes = WriteBenchSPP(SPPFile, (ULONGLONG)(ImageBits / 8.0));
+	}
+	if (iRes == APP_SUCCESS) {
+		// 4x4 block, 1 based linear format, reverse the order of the pixels in the block
+		iRes = WriteBenchText(ReorderFile, "4,4,1\n16 15 14 13\n12 11 10 9\n8 7 6 5\n4 3 2 1\n");
+	}
+	if (iRes == APP_SUCCESS) {
+		iRes = WriteBenchText(KernelFile, "3,3\n0.0625 0.125 0.0625\n0.125 0.25 0.125\n0.0625 0.125 0.0625\n");
+	}
+	if (iRes != APP_SUCCESS) {
+		fwprintf(stderr, L"Could not create the benchmark input files in %s, error %d\n", Folder, iRes);
+		for (int i = 0; i < NumFiles; i++) {
+			_wremove(Files[i].Path);
+		}
+		return iRes;
+	}
+
+	wprintf(L"Benchmark %d x %d, %d frames, %d byte pixels, fastest of %d runs\n",
+		Xsize, Ysize, NumFrames, PixelSize, Repeat);
+	wprintf(L"%-18s %12s %12s %12s\n", L"Operation", L"Seconds", L"Mpixels/s", L"Mbits/s");
+
+	// run a function Repeat times and print the fastest run
+	auto Measure = [&](const WCHAR* Name, double Pixels, double Bits, const std::function<int(void)>& Run) {
+		double Best = -1.0;
+		double Seconds;
+		LONGLONG Start;
+		int Result = APP_SUCCESS;
+
+		for (int i = 0; i < Repeat; i++) {
+			Start = TimerNow();
+			Result = Run();
+			Seconds = TimerSeconds(Start, TimerNow());
+			if (Result != APP_SUCCESS) {
+				break;
+			}
+			if (Best < 0.0 || Seconds < Best) {
+				Best = Seconds;
+			}
+		}
+		if (Result != APP_SUCCESS) {
+			wprintf(L"%-18s failed, error %d\n", Name, Result);
+			if (FirstError == APP_SUCCESS) {
+				FirstError = Result;
+			}
+			return;
+		}
+		if (Best <= 0.0) {
+			wprintf(L"%-18s %12.6f %12s %12s\n", Name, Best, L"-", L"-");
+			return;
+		}
+		if (Pixels > 0.0) {
+			wprintf(L"%-18s %12.6f %12.3f %12.3f\n", Name, Best, Pixels / Best / 1.0e6, Bits / Best / 1.0e6);
+		}
+		else {
+			wprintf(L"%-18s %12.6f %12s %12.3f\n", Name, Best, L"-", Bits / Best / 1.0e6);
+		}
+	};
+
+	Measure(L"LoadImageFile", NumPixels, ImageBits, [&]() -> int {
+		IMAGINGHEADER Header;
+		int* Image;
+		int Result;
+
+		Result = LoadImageFile(&Image, ImageFile, &Header);
+		if (Result == APP_SUCCESS) {
+			delete[] Image;
+		}
+		return Result;
+	});
+
+	Measure(L"PixelReorder", NumPixels, ImageBits, [&]() -> int {
+		return PixelReorder(NULL, ReorderFile, ImageFile, OutputFile, 0, 0, 0, 0, 0);
+	});
+
+	Measure(L"ReorderAlg", NumPixels, ImageBits, [&]() -> int {
+		// algorithm 6, incrementally rotate the rows by 1
+		return ReorderAlg(ImageFile, OutputFile, 0, 0, 0, 6, 1, 0, 0, 0);
+	});
+
+	Measure(L"ConvolveImage", NumPixels, ImageBits, [&]() -> int {
+		return ConvolveImage(NULL, KernelFile, ImageFile, OutputFile);
+	});
+
+	Measure(L"RotateImage", NumPixels, ImageBits, [&]() -> int {
+		return RotateImage(NULL, ImageFile, OutputFile, 0);
+	});
+
+	// one frame per block, each bit is a pixel
+	Measure(L"BitStream2Image", NumPixels, NumPixels, [&]() -> int {
+		return BitStream2Image(NULL, BitsFile, OutputFile, 0, 0, Xsize * Ysize, NumFrames,
+			Xsize, 1, 0, 0, 0, 0);
+	});
+
+	Measure(L"ExtractSPP", 0.0, ImageBits, [&]() -> int {
+		return ExtractSPP(NULL, SPPFile, APIDFile, NULL, BENCH_APID, 0, 0, 0, 0);
+	});
+
+	// the first frame of the image
+	Measure(L"SaveBMP", (double)Xsize * (double)Ysize, (double)Xsize * (double)Ysize * (double)PixelSize * 8.0, [&]() -> int {
+		return SaveBMP(BMPFile, ImageFile, 0, 1, NULL);
+	});
+
+	for (int i = 0; i < NumFiles; i++) {
+		_wremove(Files[i].Path);
+	}
+
+	return FirstError;
+}
+
+//*****************************************************************************************
+//
+//	WriteBenchImage
+//
+//	Private function, write an image file of pseudo random pixels
+//
+//*****************************************************************************************
+static int WriteBenchImage(WCHAR* Filename, int Xsize, int Ysize, int NumFrames, int PixelSize)
+{
+	IMAGINGHEADER Header;
+	std::vector<int> Frame;
+	unsigned int Seed = 12345;
+	unsigned int Mask;
+	FILE* Out;
+	int iRes = APP_SUCCESS;
+
+	Header.Endian = (short)-1;
+	Header.HeaderSize = (short)sizeof(IMAGINGHEADER);
+	Header.ID = (short)0xaaaa;
+	Header.Version = (short)1;
+	Header.NumFrames = (short)NumFrames;
+	Header.PixelSize = (short)PixelSize;
+	Header.Xsize = Xsize;
+	Header.Ysize = Ysize;
+	for (int i = 0; i < 6; i++) {
+		Header.Padding[i] = 0;
+	}
+
+	_wfopen_s(&Out, Filename, L"wb");
+	if (Out == NULL) {
+		return APPERR_FILEOPEN;
+	}
+	if (fwrite(&Header, sizeof(IMAGINGHEADER), 1, Out) != 1) {
+		fclose(Out);
+		return APPERR_FILEWRITE;
+	}
+
+	Mask = PixelSize == 1 ? 0xff : (PixelSize == 2 ? 0xffff : 0x7fffffff);
+	Frame.resize((size_t)Xsize * (size_t)Ysize);
+	for (int CurrentFrame = 0; CurrentFrame < NumFrames && iRes == APP_SUCCESS; CurrentFrame++) {
+		for (size_t i = 0; i < Frame.size(); i++) {
+			Seed = Seed * 1103515245 + 12345;
+			Frame[i] = (int)((Seed >> 1) & Mask);
+		}
+		iRes = WriteImagePixels(Out, Frame.data(), Frame.size(), PixelSize, -1);
+	}
+
+	if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
+	return iRes;
+}
+
+//*****************************************************************************************
+//
+//	WriteBenchBits
+//
+//	Private function, write a packed bitstream file of pseudo random bits
+//
+//*****************************************************************************************
+static int WriteBenchBits(WCHAR* Filename, ULONGLONG NumBits)
+{
+	std::vector<BYTE> Bytes;
+	unsigned int Seed = 54321;
+	FILE* Out;
+	int iRes = APP_SUCCESS;
+
+	_wfopen_s(&Out, Filename, L"wb");
+	if (Out == NULL) {
+		return APPERR_FILEOPEN;
+	}
+
+	Bytes.resize((size_t)((NumBits + 7) / 8));
+	for (size_t i = 0; i < Bytes.size(); i++) {
+		Seed = Seed * 1103515245 + 12345;
+		Bytes[i] = (BYTE)(Seed >> 16);
+	}
+	if (fwrite(Bytes.data(), 1, Bytes.size(), Out) != Bytes.size()) {
+		iRes = APPERR_FILEWRITE;
+	}
+
+	if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
+	return iRes;
+}
+
+//*****************************************************************************************
+//
+//	WriteBenchSPP
+//
+//	Private function, write a SPP stream of about NumBytes bytes.
+//	1 in 4 packets is the benchmark APID, 1 in 8 is an idle packet.
+//
+//*****************************************************************************************
+static int WriteBenchSPP(WCHAR* Filename, ULONGLONG NumBytes)
+{
+	BYTE Packet[6 + BENCH_SPP_DATA];
+	ULONGLONG NumPackets;
+	unsigned int Seed = 777;
+	FILE* Out;
+	int iRes = APP_SUCCESS;
+
+	_wfopen_s(&Out, Filename, L"wb");
+	if (Out == NULL) {
+		return APPERR_FILEOPEN;
+	}
+
+	NumPackets = NumBytes / sizeof(Packet);
+	if (NumPackets == 0) {
+		NumPackets = 1;
+	}
+	for (ULONGLONG Count = 0; Count < NumPackets; Count++) {
+		int APID;
+		int SeqCount;
+
+		if ((Count % 8) == 7) {
+			APID = 0x7ff;
+		}
+		else if ((Count % 4) == 0) {
+			APID = BENCH_APID;
+		}
+		else {
+			APID = BENCH_APID + 1 + (int)(Count % 3);
+		}
+		SeqCount = (int)(Count & 0x3fff);
+
+		// primary header, big endian: version 0, TM, secondary header flag,
+		// APID, unsegmented, sequence count, data field length - 1
+		Packet[0] = (BYTE)(0x08 | ((APID >> 8) & 0x07));
+		Packet[1] = (BYTE)(APID & 0xff);
+		Packet[2] = (BYTE)(0xc0 | ((SeqCount >> 8) & 0x3f));
+		Packet[3] = (BYTE)(SeqCount & 0xff);
+		Packet[4] = (BYTE)(((BENCH_SPP_DATA - 1) >> 8) & 0xff);
+		Packet[5] = (BYTE)((BENCH_SPP_DATA - 1) & 0xff);
+		for (int i = 0; i < BENCH_SPP_DATA; i++) {
+			Seed = Seed * 1103515245 + 12345;
+			Packet[6 + i] = (BYTE)(Seed >> 16);
+		}
+		if (fwrite(Packet, sizeof(Packet), 1, Out) != 1) {
+			iRes = APPERR_FILEWRITE;
+			break;
+		}
+	}
+
+	if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
+	return iRes;
+}
+
+//*****************************************************************************************
+//
+//	WriteBenchText
+//
+//	Private function, write a kernel text file
+//
+//*****************************************************************************************
+static int WriteBenchText(WCHAR* Filename, const char* Text)
+{
+	FILE* Out;
+	int iRes = APP_SUCCESS;
+
+	_wfopen_s(&Out, Filename, L"w");
+	if (Out == NULL) {
+		return APPERR_FILEOPEN;
+	}
+	if (fputs(Text, Out) < 0) {
+		iRes = APPERR_FILEWRITE;
+	}
+	if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
+	return iRes;
+}
@@ -0,0 +1,7 @@
+#pragma once
+//
+// Benchmark.h
+// function prototypes for the benchmark in Benchmark.cpp
+//
+
+int RunBenchmark(WCHAR* Folder, int Xsize, int Ysize, int NumFrames, int PixelSize, int Repeat);
@@ -41,6 +41,16 @@
 //                        bit order flag applies to input file and which applies ot output file.
 //                      Changed, Bit Reorder dialog, added invert reorder transform
 // V1.3.1.1 2023-12-28  Replaced application error numbers with #define to improve clarity
+// V1.3.2.1 2026-10-14  Changed, Bit distances and bit sequences dialogs default to the run length histogram
+//                        report, the per bit/per sequence report is the Full report option
+//                      Added, Bitstream to image dialog, option to create the batch BMP files at the end
+//                      Added, Bitstream autocorrelation dialog
+//                      Added, Extract SPP dialog, demux all APIDs in one pass
+//                      Changed, Batch bitstream to image is queued as a background job
+//                      Added, Bitstream to image dialog, batch of the x sizes that are factors of
+//                        the bitstream length
+//                      Added, Find prime numbers dialog, factor pairs of a bitstream length
+//                      Changed, Find prime numbers dialog, bitstream length is 64 bit
 // 
 // Bit tools dialog box handlers
 // 
@@ -67,6 +77,7 @@
 #include "imaging.h"
 #include "FileFunctions.h"
 #include "BitStream.h"
+#include "JobRunner.h"
 
 
 // Add new callback prototype declarations in my MySETIapp.cpp
@@ -764,6 +775,7 @@ INT_PTR CALLBACK BitDistancesDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM
     case WM_INITDIALOG:
     {
         int BitOrder;
+        int FullReport;
 
         GetPrivateProfileString(L"BitDistancesDlg", L"BinaryInput", L"OriginalSource\\data17.bin", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
         SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
@@ -792,6 +804,17 @@ INT_PTR CALLBACK BitDistancesDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM
             CheckDlgButton(hDlg, IDC_INPUT_BITORDER, BST_CHECKED);
         }
 
+        FullReport = GetPrivateProfileInt(L"BitDistancesDlg", L"FullReport", 0, (LPCTSTR)strAppNameINI);
+        if (!FullReport) {
+            CheckDlgButton(hDlg, IDC_FULL_REPORT, BST_UNCHECKED);
+        }
+        else {
+            CheckDlgButton(hDlg, IDC_FULL_REPORT, BST_CHECKED);
+        }
+
+        GetPrivateProfileString(L"BitDistancesDlg", L"HistogramImage", L"", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString);
+
         return (INT_PTR)TRUE;
     }
 
@@ -848,22 +871,49 @@ INT_PTR CALLBACK BitDistancesDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM
             return (INT_PTR)TRUE;
         }
 
+        case IDC_IMAGE_OUTPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC rawType[] =
+            {
+                 { L"Image files", L"*.raw" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileSave(hDlg, szString, &pszFilename, FALSE, 2, rawType, L"*.raw")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString);
+            return (INT_PTR)TRUE;
+        }
+
         case IDC_REPORT:
         {
             BOOL bSuccess;
             WCHAR InputFile[MAX_PATH];
             WCHAR OutputFile[MAX_PATH];
+            WCHAR ImageFile[MAX_PATH];
             int PrologueSize;
             int BitOrder = 0;
 
             GetDlgItemText(hDlg, IDC_BINARY_INPUT, InputFile, MAX_PATH);
             GetDlgItemText(hDlg, IDC_TEXT_OUTPUT, OutputFile, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, ImageFile, MAX_PATH);
             PrologueSize = GetDlgItemInt(hDlg, IDC_PROLOGUE_SIZE, &bSuccess, TRUE);
             if (IsDlgButtonChecked(hDlg, IDC_INPUT_BITORDER) == BST_CHECKED) {
                 BitOrder = 1;
             }
 
-            BitDistance(hDlg, InputFile, OutputFile, PrologueSize, BitOrder);
+            if (IsDlgButtonChecked(hDlg, IDC_FULL_REPORT) == BST_CHECKED) {
+                BitDistance(hDlg, InputFile, OutputFile, PrologueSize, BitOrder);
+            }
+            else {
+                BitRunHistogram(hDlg, InputFile, OutputFile, ImageFile, PrologueSize, BitOrder);
+            }
 
             return (INT_PTR)TRUE;
         }
@@ -885,6 +935,16 @@ INT_PTR CALLBACK BitDistancesDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM
                 WritePrivateProfileString(L"BitDistancesDlg", L"BitOrder", L"0", (LPCTSTR)strAppNameINI);
             }
 
+            if (IsDlgButtonChecked(hDlg, IDC_FULL_REPORT) == BST_CHECKED) {
+                WritePrivateProfileString(L"BitDistancesDlg", L"FullReport", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"BitDistancesDlg", L"FullReport", L"0", (LPCTSTR)strAppNameINI);
+            }
+
+            GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString, MAX_PATH);
+            WritePrivateProfileString(L"BitDistancesDlg", L"HistogramImage", szString, (LPCTSTR)strAppNameINI);
+
             EndDialog(hDlg, LOWORD(wParam));
             return (INT_PTR)TRUE;
 
@@ -911,6 +971,7 @@ INT_PTR CALLBACK BitSequencesDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM
     case WM_INITDIALOG:
     {
         int BitOrder;
+        int FullReport;
 
         GetPrivateProfileString(L"BitSequencesDlg", L"BinaryInput", L"OriginalSource\\data17.bin", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
         SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
@@ -939,6 +1000,17 @@ INT_PTR CALLBACK BitSequencesDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM
             CheckDlgButton(hDlg, IDC_INPUT_BITORDER, BST_CHECKED);
         }
 
+        FullReport = GetPrivateProfileInt(L"BitSequencesDlg", L"FullReport", 0, (LPCTSTR)strAppNameINI);
+        if (!FullReport) {
+            CheckDlgButton(hDlg, IDC_FULL_REPORT, BST_UNCHECKED);
+        }
+        else {
+            CheckDlgButton(hDlg, IDC_FULL_REPORT, BST_CHECKED);
+        }
+
+        GetPrivateProfileString(L"BitSequencesDlg", L"HistogramImage", L"", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString);
+
         return (INT_PTR)TRUE;
     }
 
@@ -995,23 +1067,50 @@ INT_PTR CALLBACK BitSequencesDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM
             return (INT_PTR)TRUE;
         }
 
+        case IDC_IMAGE_OUTPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC rawType[] =
+            {
+                 { L"Image files", L"*.raw" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileSave(hDlg, szString, &pszFilename, FALSE, 2, rawType, L"*.raw")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString);
+            return (INT_PTR)TRUE;
+        }
+
         case IDC_REPORT:
         {
             BOOL bSuccess;
             WCHAR InputFile[MAX_PATH];
             WCHAR OutputFile[MAX_PATH];
+            WCHAR ImageFile[MAX_PATH];
             int PrologueSize;
             int BitOrder = 0;
 
             GetDlgItemText(hDlg, IDC_BINARY_INPUT, InputFile, MAX_PATH);
             GetDlgItemText(hDlg, IDC_TEXT_OUTPUT, OutputFile, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, ImageFile, MAX_PATH);
             PrologueSize = GetDlgItemInt(hDlg, IDC_PROLOGUE_SIZE, &bSuccess, TRUE);
             
             if (IsDlgButtonChecked(hDlg, IDC_INPUT_BITORDER) == BST_CHECKED) {
                 BitOrder = 1;
             }
 
-            BitSequences(hDlg, InputFile, OutputFile, PrologueSize, BitOrder);
+            if (IsDlgButtonChecked(hDlg, IDC_FULL_REPORT) == BST_CHECKED) {
+                BitSequences(hDlg, InputFile, OutputFile, PrologueSize, BitOrder);
+            }
+            else {
+                BitRunHistogram(hDlg, InputFile, OutputFile, ImageFile, PrologueSize, BitOrder);
+            }
 
             return (INT_PTR)TRUE;
         }
@@ -1033,6 +1132,16 @@ INT_PTR CALLBACK BitSequencesDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM
                 WritePrivateProfileString(L"BitSequencesDlg", L"BitOrder", L"0", (LPCTSTR)strAppNameINI);
             }
 
+            if (IsDlgButtonChecked(hDlg, IDC_FULL_REPORT) == BST_CHECKED) {
+                WritePrivateProfileString(L"BitSequencesDlg", L"FullReport", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"BitSequencesDlg", L"FullReport", L"0", (LPCTSTR)strAppNameINI);
+            }
+
+            GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString, MAX_PATH);
+            WritePrivateProfileString(L"BitSequencesDlg", L"HistogramImage", szString, (LPCTSTR)strAppNameINI);
+
             EndDialog(hDlg, LOWORD(wParam));
             return (INT_PTR)TRUE;
 
@@ -1222,6 +1331,212 @@ INT_PTR CALLBACK BitStatsDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
 
 }
 
+//*******************************************************************************
+//
+// Message handler for BitAutocorrelationDlg dialog box.
+// 
+//*******************************************************************************
+INT_PTR CALLBACK BitAutocorrelationDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    UNREFERENCED_PARAMETER(lParam);
+    switch (message)
+    {
+        WCHAR szString[MAX_PATH];
+
+    case WM_INITDIALOG:
+    {
+        int BitOrder;
+
+        GetPrivateProfileString(L"BitAutocorrelationDlg", L"BinaryInput", L"OriginalSource\\data17.bin", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
+
+        // get filesize
+        int FileSize;
+        FileSize = GetFileSize(szString) * 8;
+        if (FileSize >= 0) {
+            SetDlgItemInt(hDlg, IDC_FILESIZE, FileSize, TRUE);
+        }
+        else {
+            SetDlgItemInt(hDlg, IDC_FILESIZE, 0, TRUE);
+        }
+
+        GetPrivateProfileString(L"BitAutocorrelationDlg", L"TextOutput", L"data17-autocorrelation.txt", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_TEXT_OUTPUT, szString);
+
+        GetPrivateProfileString(L"BitAutocorrelationDlg", L"PrologueSize", L"80", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_PROLOGUE_SIZE, szString);
+
+        GetPrivateProfileString(L"BitAutocorrelationDlg", L"BlockHeaderBits", L"0", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_BLOCK_HEADER_BITS, szString);
+
+        GetPrivateProfileString(L"BitAutocorrelationDlg", L"BlockBits", L"65536", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_BLOCK_BITS, szString);
+
+        GetPrivateProfileString(L"BitAutocorrelationDlg", L"BlockNum", L"1", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_BLOCK_NUM, szString);
+
+        GetPrivateProfileString(L"BitAutocorrelationDlg", L"LagStart", L"2", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_START, szString);
+
+        GetPrivateProfileString(L"BitAutocorrelationDlg", L"LagEnd", L"4096", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_END, szString);
+
+        GetPrivateProfileString(L"BitAutocorrelationDlg", L"NumCandidates", L"20", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_NUM_CANDIDATES, szString);
+
+        BitOrder = GetPrivateProfileInt(L"BitAutocorrelationDlg", L"BitOrder", 0, (LPCTSTR)strAppNameINI);
+        if (!BitOrder) {
+            CheckDlgButton(hDlg, IDC_INPUT_BITORDER, BST_UNCHECKED);
+        }
+        else {
+            CheckDlgButton(hDlg, IDC_INPUT_BITORDER, BST_CHECKED);
+        }
+
+        return (INT_PTR)TRUE;
+    }
+    case WM_COMMAND:
+        switch (LOWORD(wParam)) {
+        case IDC_INPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC bitType[] =
+            {
+                 { L"bit stream files", L"*.bin" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileOpen(hDlg, szString, &pszFilename, FALSE, 2, bitType, L".bin")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
+
+            // get filesize
+            // IDC_FILESIZE
+            int FileSize;
+            FileSize = GetFileSize(szString) * 8;
+            if (FileSize >= 0) {
+                SetDlgItemInt(hDlg, IDC_FILESIZE, FileSize, TRUE);
+            }
+            else {
+                SetDlgItemInt(hDlg, IDC_FILESIZE, 0, TRUE);
+            }
+
+            return (INT_PTR)TRUE;
+        }
+        case IDC_TEXT_OUTPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_TEXT_OUTPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC textType[] =
+            {
+                 { L"text stream files", L"*.txt" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileSave(hDlg, szString, &pszFilename, FALSE, 2, textType, L"*.txt")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_TEXT_OUTPUT, szString);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_REPORT:
+        {
+            BOOL bSuccess;
+            WCHAR InputFile[MAX_PATH];
+            WCHAR OutputFile[MAX_PATH];
+            int PrologueSize;
+            int BlockNum;
+            int NumBlockBodyBits;
+            int BlockHeaderBits;
+            int MinLag;
+            int MaxLag;
+            int NumCandidates;
+            int BitOrder = 0;
+
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, InputFile, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_TEXT_OUTPUT, OutputFile, MAX_PATH);
+
+            PrologueSize = GetDlgItemInt(hDlg, IDC_PROLOGUE_SIZE, &bSuccess, TRUE);
+
+            BlockHeaderBits = GetDlgItemInt(hDlg, IDC_BLOCK_HEADER_BITS, &bSuccess, TRUE);
+
+            NumBlockBodyBits = GetDlgItemInt(hDlg, IDC_BLOCK_BITS, &bSuccess, TRUE);
+
+            BlockNum = GetDlgItemInt(hDlg, IDC_BLOCK_NUM, &bSuccess, TRUE);
+
+            MinLag = GetDlgItemInt(hDlg, IDC_START, &bSuccess, TRUE);
+
+            MaxLag = GetDlgItemInt(hDlg, IDC_END, &bSuccess, TRUE);
+
+            NumCandidates = GetDlgItemInt(hDlg, IDC_NUM_CANDIDATES, &bSuccess, TRUE);
+
+
+            if (IsDlgButtonChecked(hDlg, IDC_INPUT_BITORDER) == BST_CHECKED) {
+                BitOrder = 1;
+            }
+
+            BitAutocorrelation(hDlg, InputFile, OutputFile,
+                PrologueSize, BlockHeaderBits, NumBlockBodyBits,
+                BlockNum, MinLag, MaxLag, NumCandidates, BitOrder);
+
+            return (INT_PTR)TRUE;
+        }
+
+        case IDOK:
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, szString, MAX_PATH);
+            WritePrivateProfileString(L"BitAutocorrelationDlg", L"BinaryInput", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_TEXT_OUTPUT, szString, MAX_PATH);
+            WritePrivateProfileString(L"BitAutocorrelationDlg", L"TextOutput", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_PROLOGUE_SIZE, szString, MAX_PATH);
+            WritePrivateProfileString(L"BitAutocorrelationDlg", L"PrologueSize", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_BLOCK_HEADER_BITS, szString, MAX_PATH);
+            WritePrivateProfileString(L"BitAutocorrelationDlg", L"BlockHeaderBits", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_BLOCK_BITS, szString, MAX_PATH);
+            WritePrivateProfileString(L"BitAutocorrelationDlg", L"BlockBits", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_BLOCK_NUM, szString, MAX_PATH);
+            WritePrivateProfileString(L"BitAutocorrelationDlg", L"BlockNum", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_START, szString, MAX_PATH);
+            WritePrivateProfileString(L"BitAutocorrelationDlg", L"LagStart", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_END, szString, MAX_PATH);
+            WritePrivateProfileString(L"BitAutocorrelationDlg", L"LagEnd", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_NUM_CANDIDATES, szString, MAX_PATH);
+            WritePrivateProfileString(L"BitAutocorrelationDlg", L"NumCandidates", szString, (LPCTSTR)strAppNameINI);
+
+            if (IsDlgButtonChecked(hDlg, IDC_INPUT_BITORDER) == BST_CHECKED) {
+                WritePrivateProfileString(L"BitAutocorrelationDlg", L"BitOrder", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"BitAutocorrelationDlg", L"BitOrder", L"0", (LPCTSTR)strAppNameINI);
+            }
+
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+
+        case IDCANCEL:
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+        }
+    }
+    return (INT_PTR)FALSE;
+
+}
+
 //*******************************************************************************
 //
 // Message handler for BitReorderDlg dialog box.
@@ -1438,6 +1753,8 @@ INT_PTR CALLBACK BitImageDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
         int BitScale;
         int Invert;
         int InputBitOrder;
+        int DeferBMP;
+        int FactorXsizes;
 
         GetPrivateProfileString(L"BitImageDlg", L"BinaryInput", L"OriginalSource\\data17.bin", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
         SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
@@ -1508,6 +1825,22 @@ INT_PTR CALLBACK BitImageDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
             CheckDlgButton(hDlg, IDC_INVERT, BST_CHECKED);
         }
 
+        DeferBMP = GetPrivateProfileInt(L"BitImageDlg", L"DeferBMP", 0, (LPCTSTR)strAppNameINI);
+        if (!DeferBMP) {
+            CheckDlgButton(hDlg, IDC_DEFER_BMP, BST_UNCHECKED);
+        }
+        else {
+            CheckDlgButton(hDlg, IDC_DEFER_BMP, BST_CHECKED);
+        }
+
+        FactorXsizes = GetPrivateProfileInt(L"BitImageDlg", L"FactorXsizes", 0, (LPCTSTR)strAppNameINI);
+        if (!FactorXsizes) {
+            CheckDlgButton(hDlg, IDC_FACTOR_XSIZES, BST_UNCHECKED);
+        }
+        else {
+            CheckDlgButton(hDlg, IDC_FACTOR_XSIZES, BST_CHECKED);
+        }
+
         return (INT_PTR)TRUE;
     }
     case WM_COMMAND:
@@ -1581,6 +1914,8 @@ INT_PTR CALLBACK BitImageDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
             int BitScale = 0;
             int Invert = 0;
             int InputBitOrder = 0;
+            int DeferBMP = 0;
+            int FactorXsizes = 0;
 			int iRes;
 
             GetDlgItemText(hDlg, IDC_BINARY_INPUT, InputFile, MAX_PATH);
@@ -1615,7 +1950,47 @@ INT_PTR CALLBACK BitImageDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
                 Invert = 1;
             }
 
-            if (xsize >= xsizeEnd) {
+            if (IsDlgButtonChecked(hDlg, IDC_DEFER_BMP) == BST_CHECKED) {
+                DeferBMP = 1;
+            }
+
+            if (IsDlgButtonChecked(hDlg, IDC_FACTOR_XSIZES) == BST_CHECKED) {
+                FactorXsizes = 1;
+            }
+
+            if (FactorXsizes) {
+                // the bitstream after the prologue is a single block, the batch is
+                // every x size from X size to end X size that divides the # of pixels
+                // end X size < X size is no upper limit
+                std::vector<int> Xsizes;
+
+                iRes = BitStreamFactorSizes(InputFile, PrologueSize, BitDepth, xsize, xsizeEnd,
+                    &Xsizes, &NumBlockBodyBits, NULL);
+                if (iRes == APPERR_PARAMETER) {
+                    MessageBox(hDlg, L"1 <= Image bit depth <= 32, # bits in prologue >= 0", L"File I/O", MB_OK);
+                    return (INT_PTR)TRUE;
+                }
+                if (iRes == APPERR_FILESIZE) {
+                    MessageBox(hDlg, L"Bitstream is too long to factor", L"File incompatible", MB_OK);
+                    return (INT_PTR)TRUE;
+                }
+                if (iRes != APP_SUCCESS) {
+                    MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
+                    return (INT_PTR)TRUE;
+                }
+                if (Xsizes.empty()) {
+                    MessageBox(hDlg, L"No factor of the bitstream length is in the X size range", L"Batch process Bit stream to image file", MB_OK);
+                    return (INT_PTR)TRUE;
+                }
+
+                QueueJob(L"Batch bitstream to image", [=]() mutable {
+                    BatchBitStream2Image(NULL, InputFile, OutputFile,
+                        PrologueSize, 0, NumBlockBodyBits, 1, Xsizes,
+                        BitDepth, BitOrder, BitScale, Invert, InputBitOrder, DeferBMP);
+                    return APP_SUCCESS;
+                });
+            }
+            else if (xsize >= xsizeEnd) {
                 iRes = BitStream2Image(hDlg, InputFile, OutputFile,
                     PrologueSize, BlockHeaderBits, NumBlockBodyBits, BlockNum, xsize,
                     BitDepth, BitOrder, BitScale, Invert, InputBitOrder);
@@ -1623,9 +1998,13 @@ INT_PTR CALLBACK BitImageDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
                 wcscpy_s(szCurrentFilename, OutputFile);
             }
             else {
-                BatchBitStream2Image(hDlg, InputFile, OutputFile,
-                    PrologueSize, BlockHeaderBits, NumBlockBodyBits, BlockNum, xsize, xsizeEnd,
-                    BitDepth, BitOrder, BitScale, Invert, InputBitOrder);
+                // run on the job thread, the parameters are copied into the job
+                QueueJob(L"Batch bitstream to image", [=]() mutable {
+                    BatchBitStream2Image(NULL, InputFile, OutputFile,
+                        PrologueSize, BlockHeaderBits, NumBlockBodyBits, BlockNum, xsize, xsizeEnd,
+                        BitDepth, BitOrder, BitScale, Invert, InputBitOrder, DeferBMP);
+                    return APP_SUCCESS;
+                });
             }
             return (INT_PTR)TRUE;
         }
@@ -1686,6 +2065,20 @@ INT_PTR CALLBACK BitImageDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
                 WritePrivateProfileString(L"BitImageDlg", L"Invert", L"0", (LPCTSTR)strAppNameINI);
             }
 
+            if (IsDlgButtonChecked(hDlg, IDC_DEFER_BMP) == BST_CHECKED) {
+                WritePrivateProfileString(L"BitImageDlg", L"DeferBMP", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"BitImageDlg", L"DeferBMP", L"0", (LPCTSTR)strAppNameINI);
+            }
+
+            if (IsDlgButtonChecked(hDlg, IDC_FACTOR_XSIZES) == BST_CHECKED) {
+                WritePrivateProfileString(L"BitImageDlg", L"FactorXsizes", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"BitImageDlg", L"FactorXsizes", L"0", (LPCTSTR)strAppNameINI);
+            }
+
             EndDialog(hDlg, LOWORD(wParam));
             return (INT_PTR)TRUE;
 
@@ -1837,6 +2230,7 @@ INT_PTR CALLBACK ExtractSPPDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lP
     {
         int Strict;
         int SaveSPP;
+        int DemuxBinary;
 
         GetPrivateProfileString(L"ExtractSPPDlg", L"BinaryInput", L"encap_001.bin", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
         SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
@@ -1872,6 +2266,14 @@ INT_PTR CALLBACK ExtractSPPDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lP
             CheckDlgButton(hDlg, IDC_SAVE_SUMMARY, BST_CHECKED);
         }
 
+        DemuxBinary = GetPrivateProfileInt(L"ExtractSPPDlg", L"DemuxBinary", 0, (LPCTSTR)strAppNameINI);
+        if (!DemuxBinary) {
+            CheckDlgButton(hDlg, IDC_DEMUX_BINARY, BST_UNCHECKED);
+        }
+        else {
+            CheckDlgButton(hDlg, IDC_DEMUX_BINARY, BST_CHECKED);
+        }
+
         return (INT_PTR)TRUE;
     }
     case WM_COMMAND:
@@ -1971,6 +2373,42 @@ INT_PTR CALLBACK ExtractSPPDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lP
             return (INT_PTR)TRUE;
         }
 
+        case IDC_DEMUX:
+        {
+            BOOL bSuccess;
+            WCHAR InputFile[MAX_PATH];
+            WCHAR OutputFile[MAX_PATH];
+            WCHAR APIDoutputFile[MAX_PATH];
+            int SkipBytes;
+            int SecondaryHeaderSize;
+            int Strict = 0;
+            int SaveSPP = 0;
+            int DemuxBinary = 0;
+
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, InputFile, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_TEXT_OUTPUT2, APIDoutputFile, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_TEXT_OUTPUT, OutputFile, MAX_PATH);
+
+            SkipBytes = GetDlgItemInt(hDlg, IDC_SKIP_BYTES, &bSuccess, TRUE);
+            SecondaryHeaderSize = GetDlgItemInt(hDlg, IDC_HEADER2SIZE, &bSuccess, TRUE);
+            if (IsDlgButtonChecked(hDlg, IDC_STRICT) == BST_CHECKED) {
+                Strict = 1;
+            }
+            if (IsDlgButtonChecked(hDlg, IDC_SAVE_SUMMARY) == BST_CHECKED) {
+                SaveSPP = 1;
+            }
+            if (IsDlgButtonChecked(hDlg, IDC_DEMUX_BINARY) == BST_CHECKED) {
+                DemuxBinary = 1;
+            }
+
+            // every APID is saved to APIDoutputFile with the APID added to the name,
+            // the summary file has the packet and sequence count statistics for each APID
+            DemuxSPP(hDlg, InputFile, APIDoutputFile, OutputFile, SkipBytes,
+                SecondaryHeaderSize, Strict, DemuxBinary, SaveSPP);
+
+            return (INT_PTR)TRUE;
+        }
+
         case IDOK:
             GetDlgItemText(hDlg, IDC_BINARY_INPUT, szString, MAX_PATH);
             WritePrivateProfileString(L"ExtractSPPDlg", L"BinaryInput", szString, (LPCTSTR)strAppNameINI);
@@ -2004,6 +2442,13 @@ INT_PTR CALLBACK ExtractSPPDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lP
                 WritePrivateProfileString(L"ExtractSPPDlg", L"SaveSPP", L"0", (LPCTSTR)strAppNameINI);
             }
 
+            if (IsDlgButtonChecked(hDlg, IDC_DEMUX_BINARY) == BST_CHECKED) {
+                WritePrivateProfileString(L"ExtractSPPDlg", L"DemuxBinary", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"ExtractSPPDlg", L"DemuxBinary", L"0", (LPCTSTR)strAppNameINI);
+            }
+
             EndDialog(hDlg, LOWORD(wParam));
             return (INT_PTR)TRUE;
 
@@ -2015,6 +2460,27 @@ INT_PTR CALLBACK ExtractSPPDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lP
     return (INT_PTR)FALSE;
 }
 
+//*******************************************************************************
+//
+// ShowBitStreamLength
+//
+// Set IDC_FILESIZE to the # of bits in Filename, 0 if it can not be opened.
+// The length is 64 bit, GetFileSize()*8 overflows an int for files over 256 MB.
+// 
+//*******************************************************************************
+static void ShowBitStreamLength(HWND hDlg, WCHAR* Filename)
+{
+    std::vector<int> Xsizes;
+    int NumBlockBodyBits;
+    ULONGLONG NumBits = 0;
+    WCHAR szString[MAX_PATH];
+
+    // NumBits is set even when the stream is too long to factor
+    BitStreamFactorSizes(Filename, 0, 1, 1, 0, &Xsizes, &NumBlockBodyBits, &NumBits);
+    swprintf_s(szString, MAX_PATH, L"%llu", NumBits);
+    SetDlgItemText(hDlg, IDC_FILESIZE, szString);
+}
+
 //*******************************************************************************
 //
 // Message handler for FindAPrimeDlg dialog box.
@@ -2038,6 +2504,17 @@ INT_PTR CALLBACK FindAPrimeDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lP
         GetPrivateProfileString(L"FindAPrimeDlg", L"End", L"65536", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
         SetDlgItemText(hDlg, IDC_END, szString);
 
+        GetPrivateProfileString(L"FindAPrimeDlg", L"PrologueSize", L"0", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_PROLOGUE_SIZE, szString);
+
+        GetPrivateProfileString(L"FindAPrimeDlg", L"BitDepth", L"1", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_BIT_DEPTH, szString);
+
+        GetPrivateProfileString(L"FindAPrimeDlg", L"BinaryInput", L"OriginalSource\\data17.bin", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
+
+        ShowBitStreamLength(hDlg, szString);
+
         return (INT_PTR)TRUE;
     }
     case WM_COMMAND:
@@ -2062,6 +2539,30 @@ INT_PTR CALLBACK FindAPrimeDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lP
             return (INT_PTR)TRUE;
         }
 
+        case IDC_INPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC bitType[] =
+            {
+                 { L"bit stream files", L"*.bin" },
+                 { L"All Files", L"*.*" },
+            };
+
+            if (!CCFileOpen(hDlg, szString, &pszFilename, FALSE, 2, bitType, L"*.bin")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
+
+            ShowBitStreamLength(hDlg, szString);
+
+            return (INT_PTR)TRUE;
+        }
+
         case IDC_CALCULATE:
         {
             BOOL bSuccess;
@@ -2079,6 +2580,29 @@ INT_PTR CALLBACK FindAPrimeDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lP
             return (INT_PTR)TRUE;
         }
 
+        case IDC_FACTOR:
+        {
+            BOOL bSuccess;
+            WCHAR InputFile[MAX_PATH];
+            WCHAR OutputFile[MAX_PATH];
+            int PrologueSize;
+            int BitDepth;
+
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, InputFile, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_TEXT_OUTPUT, OutputFile, MAX_PATH);
+
+            PrologueSize = GetDlgItemInt(hDlg, IDC_PROLOGUE_SIZE, &bSuccess, TRUE);
+            BitDepth = GetDlgItemInt(hDlg, IDC_BIT_DEPTH, &bSuccess, TRUE);
+            if (BitDepth <= 0 || BitDepth > 32) {
+                MessageBox(hDlg, L"1 <= Image bit depth <= 32", L"File I/O", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+
+            FactorBitStreamLength(hDlg, InputFile, OutputFile, PrologueSize, BitDepth);
+
+            return (INT_PTR)TRUE;
+        }
+
         case IDOK:
             GetDlgItemText(hDlg, IDC_TEXT_OUTPUT, szString, MAX_PATH);
             WritePrivateProfileString(L"FindAPrimeDlg", L"TextOutput", szString, (LPCTSTR)strAppNameINI);
@@ -2089,6 +2613,15 @@ INT_PTR CALLBACK FindAPrimeDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lP
             GetDlgItemText(hDlg, IDC_END, szString, MAX_PATH);
             WritePrivateProfileString(L"FindAPrimeDlg", L"End", szString, (LPCTSTR)strAppNameINI);
 
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, szString, MAX_PATH);
+            WritePrivateProfileString(L"FindAPrimeDlg", L"BinaryInput", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_PROLOGUE_SIZE, szString, MAX_PATH);
+            WritePrivateProfileString(L"FindAPrimeDlg", L"PrologueSize", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_BIT_DEPTH, szString, MAX_PATH);
+            WritePrivateProfileString(L"FindAPrimeDlg", L"BitDepth", szString, (LPCTSTR)strAppNameINI);
+
             EndDialog(hDlg, LOWORD(wParam));
             return (INT_PTR)TRUE;
 
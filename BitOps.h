@@ -0,0 +1,102 @@
+#pragma once
+//
+// BitOps.h
+// 64 bit popcount and bit scan helpers that build for both x64 and Win32
+//
+// The 64 bit intrinsics (__popcnt64, _BitScanForward64, _BitScanReverse64)
+// only exist for x64, the Win32 builds use the 32 bit intrinsics on the two
+// halves of the word.  The POPCNT instruction is not part of the x64 or SSE2
+// baseline, it is only used if CPUID reports it, otherwise the bits are
+// counted in registers.
+//
+#include <intrin.h>
+
+//*****************************************************************************************
+//
+//	CpuHasPopcnt
+//
+//	true if the processor has the POPCNT instruction (CPUID 1, ECX bit 23)
+//
+//*****************************************************************************************
+inline bool CpuHasPopcnt(void)
+{
+	int CpuInfo[4];
+
+	__cpuid(CpuInfo, 1);
+	return (CpuInfo[2] & (1 << 23)) != 0;
+}
+
+//*****************************************************************************************
+//
+//	PopCount64
+//
+//	number of 1 bits in Value
+//
+//*****************************************************************************************
+inline int PopCount64(unsigned long long Value)
+{
+	static const bool UsePopcnt = CpuHasPopcnt();
+
+	if (UsePopcnt) {
+#if defined(_M_X64)
+		return (int)__popcnt64(Value);
+#else
+		return (int)(__popcnt((unsigned int)Value) + __popcnt((unsigned int)(Value >> 32)));
+#endif
+	}
+
+	// count the bits in pairs, nibbles and then bytes
+	Value = Value - ((Value >> 1) & 0x5555555555555555ULL);
+	Value = (Value & 0x3333333333333333ULL) + ((Value >> 2) & 0x3333333333333333ULL);
+	Value = (Value + (Value >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+	return (int)((Value * 0x0101010101010101ULL) >> 56);
+}
+
+//*****************************************************************************************
+//
+//	ScanForward64
+//
+//	Index of the lowest 1 bit in Value, same as _BitScanForward64()
+//
+//  return value:
+//	false - Value is 0, Index is not set
+//
+//*****************************************************************************************
+inline bool ScanForward64(unsigned long* Index, unsigned long long Value)
+{
+#if defined(_M_X64)
+	return _BitScanForward64(Index, Value) != 0;
+#else
+	if (_BitScanForward(Index, (unsigned long)Value)) {
+		return true;
+	}
+	if (_BitScanForward(Index, (unsigned long)(Value >> 32))) {
+		*Index += 32;
+		return true;
+	}
+	return false;
+#endif
+}
+
+//*****************************************************************************************
+//
+//	ScanReverse64
+//
+//	Index of the highest 1 bit in Value, same as _BitScanReverse64()
+//
+//  return value:
+//	false - Value is 0, Index is not set
+//
+//*****************************************************************************************
+inline bool ScanReverse64(unsigned long* Index, unsigned long long Value)
+{
+#if defined(_M_X64)
+	return _BitScanReverse64(Index, Value) != 0;
+#else
+	if (_BitScanReverse(Index, (unsigned long)(Value >> 32))) {
+		*Index += 32;
+		return true;
+	}
+	return _BitScanReverse(Index, (unsigned long)Value) != 0;
+#endif
+}
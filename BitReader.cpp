@@ -0,0 +1,456 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// BitReader.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file defines the class methods for the BitReader class used by the
+// bitstream functions in BitStream.cpp
+//
+// The bitstream file is memory mapped (or read into memory if it can not be mapped).
+// The bits are returned in the order of the bit transmission message.  The input
+// file bit order within a byte is handled when a 64 bit word is loaded so that
+// the first bit in the stream is always the MSB of the word:
+//      BitOrder 0 - bits in a byte are MSB to LSB (0x80 is the first bit)
+//      BitOrder 1 - bits in a byte are LSB to MSB (0x01 is the first bit)
+// 
+// Run lengths and bit counts are done a word at a time using the
+// bit scan and popcount instructions.
+// 
+// Bits past the end of the file are read as 0.  The caller is responsible for
+// not reading past BitsLeft().
+//
+// V1.3.2.1 2026-10-14  Initial release
+//                      Added, OpenView
+//                      Changed, popcount and bit scan use BitOps.h so that Win32 builds
+//                      and CPUs without POPCNT are supported
+//
+#include "framework.h"
+#include <stdio.h>
+#include "AppErrors.h"
+#include "imaging.h"
+#include "ImageIO.h"
+#include "BitReader.h"
+#include "BitOps.h"
+
+//*******************************************************************************
+//
+// BitReader::Open
+// 
+// Open a bitstream file
+// 
+// Parameters:
+//  WCHAR* Filename         bitstream file
+//  int InputBitOrder       0 - standard byte bit order for input file, MSB first
+//                          1 - swap byte bit order for input file, LSB first
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int BitReader::Open(WCHAR* Filename, int InputBitOrder)
+{
+    int iRes;
+
+    Close();
+    BitOrder = InputBitOrder;
+
+    iRes = MapImageFile(Filename, &Map);
+    if (iRes == APP_SUCCESS) {
+        Data = Map.View;
+        DataSize = (size_t)Map.FileSize;
+        TotalBits = (ULONGLONG)DataSize * 8;
+        return APP_SUCCESS;
+    }
+    if (iRes == APPERR_FILEOPEN) {
+        return APPERR_FILEOPEN;
+    }
+    if (iRes == APPERR_FILEREAD) {
+        // empty file, nothing to map
+        return APP_SUCCESS;
+    }
+
+    // could not map the file, read it into memory
+    FILE* In;
+    long long FileSize;
+    size_t NumRead;
+
+    _wfopen_s(&In, Filename, L"rb");
+    if (In == NULL) {
+        return APPERR_FILEOPEN;
+    }
+    _fseeki64(In, 0, SEEK_END);
+    FileSize = _ftelli64(In);
+    _fseeki64(In, 0, SEEK_SET);
+    if (FileSize <= 0) {
+        fclose(In);
+        return APP_SUCCESS;
+    }
+
+    Buffer = new BYTE[(size_t)FileSize];
+    if (Buffer == NULL) {
+        fclose(In);
+        return APPERR_MEMALLOC;
+    }
+    NumRead = fread(Buffer, 1, (size_t)FileSize, In);
+    fclose(In);
+    if (NumRead != (size_t)FileSize) {
+        delete[] Buffer;
+        Buffer = NULL;
+        return APPERR_FILEREAD;
+    }
+
+    Data = Buffer;
+    DataSize = (size_t)FileSize;
+    TotalBits = (ULONGLONG)DataSize * 8;
+    return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+// BitReader::OpenView
+// 
+// Read a bitstream that is already in memory, typically the data of another
+// BitReader so that several threads can each read their own part of the same
+// file.  The memory is owned by the caller and must stay valid until Close().
+// 
+// Parameters:
+//  const BYTE* ViewData    start of the bitstream bytes
+//  size_t ViewSize         # of bytes in the bitstream
+//  int InputBitOrder       0 - standard byte bit order for input file, MSB first
+//                          1 - swap byte bit order for input file, LSB first
+// 
+//*******************************************************************************
+void BitReader::OpenView(const BYTE* ViewData, size_t ViewSize, int InputBitOrder)
+{
+    Close();
+    BitOrder = InputBitOrder;
+    Data = ViewData;
+    DataSize = ViewSize;
+    TotalBits = (ULONGLONG)DataSize * 8;
+    return;
+}
+
+//*******************************************************************************
+//
+// BitReader::Close
+// 
+//*******************************************************************************
+void BitReader::Close(void)
+{
+    if (Map.View != NULL) {
+        UnmapImageFile(&Map);
+    }
+    if (Buffer != NULL) {
+        delete[] Buffer;
+        Buffer = NULL;
+    }
+    Data = NULL;
+    DataSize = 0;
+    TotalBits = 0;
+    Position = 0;
+    return;
+}
+
+//*******************************************************************************
+//
+// BitReader::GetTotalBits, GetPosition, BitsLeft
+// 
+// Size of the bitstream, current bit position, # of bits after
+// the current position
+// 
+//*******************************************************************************
+ULONGLONG BitReader::GetTotalBits(void)
+{
+    return TotalBits;
+}
+
+ULONGLONG BitReader::GetPosition(void)
+{
+    return Position;
+}
+
+ULONGLONG BitReader::BitsLeft(void)
+{
+    return TotalBits - Position;
+}
+
+//*******************************************************************************
+//
+// BitReader::Seek, Skip
+// 
+// Set the current bit position, or move it forward by NumBits.
+// The position is limited to the end of the bitstream.
+// 
+//*******************************************************************************
+void BitReader::Seek(ULONGLONG BitPosition)
+{
+    Position = BitPosition;
+    if (Position > TotalBits) {
+        Position = TotalBits;
+    }
+    return;
+}
+
+void BitReader::Skip(ULONGLONG NumBits)
+{
+    if (NumBits > BitsLeft()) {
+        NumBits = BitsLeft();
+    }
+    Position += NumBits;
+    return;
+}
+
+//*******************************************************************************
+//
+// BitReader::GetData, GetDataSize
+// 
+// Raw bytes of the bitstream file
+// 
+//*******************************************************************************
+const BYTE* BitReader::GetData(void)
+{
+    return Data;
+}
+
+size_t BitReader::GetDataSize(void)
+{
+    return DataSize;
+}
+
+//*******************************************************************************
+//
+// BitReader::LoadWord
+// 
+// private function
+// 
+// Load 8 bytes starting at ByteIndex as a word with the first bit
+// of the stream in the MSB.  Bytes past the end of the file are 0.
+// 
+//*******************************************************************************
+ULONGLONG BitReader::LoadWord(size_t ByteIndex)
+{
+    ULONGLONG Word = 0;
+
+    if (ByteIndex + 8 <= DataSize) {
+        memcpy(&Word, Data + ByteIndex, 8);
+    }
+    else if (ByteIndex < DataSize) {
+        memcpy(&Word, Data + ByteIndex, DataSize - ByteIndex);
+    }
+    // first byte in the file becomes the most significant byte
+    Word = _byteswap_uint64(Word);
+
+    if (BitOrder) {
+        // reverse the bit order within each byte
+        Word = ((Word >> 1) & 0x5555555555555555ULL) | ((Word & 0x5555555555555555ULL) << 1);
+        Word = ((Word >> 2) & 0x3333333333333333ULL) | ((Word & 0x3333333333333333ULL) << 2);
+        Word = ((Word >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((Word & 0x0f0f0f0f0f0f0f0fULL) << 4);
+    }
+    return Word;
+}
+
+//*******************************************************************************
+//
+// BitReader::PeekWord
+// 
+// Next 64 bits of the stream without changing the position.
+// The bit at the current position is the MSB.
+// 
+//*******************************************************************************
+ULONGLONG BitReader::PeekWord(void)
+{
+    ULONGLONG Word;
+    size_t ByteIndex;
+    int Shift;
+
+    ByteIndex = (size_t)(Position >> 3);
+    Shift = (int)(Position & 7);
+
+    Word = LoadWord(ByteIndex);
+    if (Shift != 0) {
+        Word = (Word << Shift) | (LoadWord(ByteIndex + 8) >> (64 - Shift));
+    }
+    return Word;
+}
+
+//*******************************************************************************
+//
+// BitReader::PeekBit, GetBit
+// 
+// Bit at the current position in the stream, 0 or 1
+// GetBit() also moves to the next bit
+// 
+//*******************************************************************************
+int BitReader::PeekBit(void)
+{
+    BYTE CurrentByte;
+
+    if (Position >= TotalBits) {
+        return 0;
+    }
+    CurrentByte = Data[Position >> 3];
+    if (BitOrder == 0) {
+        return (CurrentByte >> (7 - (Position & 7))) & 1;
+    }
+    return (CurrentByte >> (Position & 7)) & 1;
+}
+
+int BitReader::GetBit(void)
+{
+    int BitValue;
+
+    BitValue = PeekBit();
+    if (Position < TotalBits) {
+        Position++;
+    }
+    return BitValue;
+}
+
+//*******************************************************************************
+//
+// BitReader::ReadBits
+// 
+// Extract the next NumBits (1 to 32) bits from the stream.  The first bit
+// is the MSB of the result.
+// 
+//*******************************************************************************
+unsigned int BitReader::ReadBits(int NumBits)
+{
+    ULONGLONG Word;
+
+    if (NumBits <= 0) {
+        return 0;
+    }
+    Word = PeekWord();
+    Skip((ULONGLONG)NumBits);
+    return (unsigned int)(Word >> (64 - NumBits));
+}
+
+//*******************************************************************************
+//
+// BitReader::ReadBitsArray
+// 
+// Extract Count values of NumBits (1 to 32) bits each from the stream.
+// This is the same as calling ReadBits() Count times but the stream is
+// only reloaded when the current 64 bit word has been used.
+// Only complete values are extracted.
+// 
+//  return value:
+//  # of values extracted, less than Count if the end of the stream is reached
+// 
+//*******************************************************************************
+size_t BitReader::ReadBitsArray(int* Values, size_t Count, int NumBits)
+{
+    ULONGLONG Word;
+    int Used;
+
+    if (NumBits <= 0) {
+        return 0;
+    }
+    if (Count > BitsLeft() / (ULONGLONG)NumBits) {
+        Count = (size_t)(BitsLeft() / (ULONGLONG)NumBits);
+    }
+
+    Word = PeekWord();
+    Used = 0;
+    for (size_t i = 0; i < Count; i++) {
+        if (Used + NumBits > 64) {
+            Position += Used;
+            Word = PeekWord();
+            Used = 0;
+        }
+        Values[i] = (int)(unsigned int)((Word << Used) >> (64 - NumBits));
+        Used += NumBits;
+    }
+    Position += Used;
+
+    return Count;
+}
+
+//*******************************************************************************
+//
+// BitReader::CountOnes
+// 
+// Count the number of 1 bits in the next NumBits bits of the stream.
+// The position is moved past the counted bits.
+// 
+//*******************************************************************************
+ULONGLONG BitReader::CountOnes(ULONGLONG NumBits)
+{
+    ULONGLONG Count = 0;
+    ULONGLONG Word;
+
+    if (NumBits > BitsLeft()) {
+        NumBits = BitsLeft();
+    }
+
+    while (NumBits >= 64) {
+        Count += PopCount64(PeekWord());
+        Position += 64;
+        NumBits -= 64;
+    }
+    if (NumBits > 0) {
+        Word = PeekWord() >> (64 - NumBits);
+        Count += PopCount64(Word);
+        Position += NumBits;
+    }
+    return Count;
+}
+
+//*******************************************************************************
+//
+// BitReader::RunLength
+// 
+// Count the number of consecutive bits equal to BitValue starting at the
+// current position, up to MaxBits.  The position is moved past the run so that
+// it is at the first bit that is not BitValue (or MaxBits/end of stream).
+// 
+//*******************************************************************************
+ULONGLONG BitReader::RunLength(int BitValue, ULONGLONG MaxBits)
+{
+    ULONGLONG Length = 0;
+    ULONGLONG Word;
+    unsigned long Index;
+    ULONGLONG WordRun;
+
+    if (MaxBits > BitsLeft()) {
+        MaxBits = BitsLeft();
+    }
+
+    while (Length < MaxBits) {
+        Word = PeekWord();
+        if (BitValue) {
+            Word = ~Word;
+        }
+        // run length in this word is the # of leading 0 bits
+        if (ScanReverse64(&Index, Word)) {
+            WordRun = 63 - Index;
+        }
+        else {
+            WordRun = 64;
+        }
+        if (WordRun > MaxBits - Length) {
+            WordRun = MaxBits - Length;
+        }
+        Length += WordRun;
+        Position += WordRun;
+        if (WordRun < 64) {
+            break;
+        }
+    }
+    return Length;
+}
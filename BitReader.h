@@ -0,0 +1,50 @@
+#pragma once
+//
+// BitReader.h
+// class definition for the bitstream reader in BitReader.cpp
+//
+// requires imaging.h and ImageIO.h (IMAGEFILEMAP)
+//
+
+class BitReader
+{
+private:
+	IMAGEFILEMAP Map = { NULL, NULL, NULL, 0 };	// used when the file is memory mapped
+	BYTE* Buffer = NULL;				// used when the file is read into memory
+	const BYTE* Data = NULL;			// start of the bitstream bytes
+	size_t DataSize = 0;				// # of bytes in the bitstream
+	ULONGLONG TotalBits = 0;			// # of bits in the bitstream
+	ULONGLONG Position = 0;				// current bit position in the bitstream
+	int BitOrder = 0;					// 0 - MSB to LSB in each byte, 1 - LSB to MSB
+
+	ULONGLONG LoadWord(size_t ByteIndex);
+
+public:
+	BitReader() {
+	};
+
+	~BitReader() {
+		Close();
+	};
+
+	int Open(WCHAR* Filename, int InputBitOrder);
+	void OpenView(const BYTE* ViewData, size_t ViewSize, int InputBitOrder);
+	void Close(void);
+
+	ULONGLONG GetTotalBits(void);
+	ULONGLONG GetPosition(void);
+	ULONGLONG BitsLeft(void);
+	void Seek(ULONGLONG BitPosition);
+	void Skip(ULONGLONG NumBits);
+
+	const BYTE* GetData(void);
+	size_t GetDataSize(void);
+
+	ULONGLONG PeekWord(void);
+	int PeekBit(void);
+	int GetBit(void);
+	unsigned int ReadBits(int NumBits);
+	size_t ReadBitsArray(int* Values, size_t Count, int NumBits);
+	ULONGLONG CountOnes(ULONGLONG NumBits);
+	ULONGLONG RunLength(int BitValue, ULONGLONG MaxBits);
+};
@@ -28,6 +28,8 @@
 //     -4 incorect file type
 //     -5 file sizes mismatch
 //     -6 not yet implemented
+//     -7 file write failure
+//     -8 cancelled by the user
 //
 // Some function return TRUE/FALSE results
 //
@@ -47,19 +49,152 @@
 //                      Changed, Extract Btistream to text file dialogs, added flag for input file bit order swap
 // V1.3.1.1 2023-12-28  Replaced application error numbers with #define to improve clarity
 //                      Changed batch processing for images to show result of each image after each step
+// V1.3.2.1 2026-10-14  Changed, bitstream analysis functions use the BitReader class (memory mapped input,
+//                        word at a time run lengths and bit counts)
+//                      Fixed, Bit sequences report, length of a final 0 sequence
+//                      Fixed, Bitstream stats, footer bits were counted as a block header
+//                      Fixed, Bitstream to image, pixel carry over between blocks, 32 bit pixel reset
+//                        and frames larger than the image header size
+//                      Added, Run length and gap histogram report, BitRunHistogram()
+//                      Changed, Batch bitstream to image decodes the bitstream once for all x sizes
+//                        and writes the x sizes in parallel, optional BMP files after the batch
+//                      Added, Bitstream autocorrelation report, BitAutocorrelation()
+//                      Added, single pass demultiplex of all APIDs in a SPP stream, DemuxSPP()
+//                      Changed, ExtractSPP packet and byte counters are 64 bit
+//                      Changed, run length histogram image is displayed directly from memory
+//                      Changed, Batch bitstream to image reports progress and can be cancelled
+//                        when run as a background job
+//                      Changed, Bitstream to image goes through the result cache (ResultCache.cpp)
+//                      Changed, ExtractSPP completed summary is only shown when there is a dialog
+//                      Changed, Bitstream to image and batch bitstream to image write the image
+//                        file version set in the settings (ImageFile.cpp)
+//                      Changed, Bitstream to image and batch bitstream to image borrow their pixel
+//                        buffers from the buffer pool (BufferPool.cpp)
+//                      Changed, FindAPrime uses a multithreaded segmented sieve of Eratosthenes
+//                      Added, factor pairs (xsize,ysize) of the bitstream length, FactorBitStreamLength(),
+//                        batch bitstream to image of the factor x sizes
+//                      Changed, autocorrelation bit counts use PopCount64() (BitOps.h) for Win32 builds
+//                      Correction, Batch bitstream to image reports AutoPNG .png file write errors
 //
 #include "framework.h"
 #include <windowsx.h>
 #include <time.h>
 #include <stdio.h>
+#include <limits.h>
+#include <math.h>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
 #include <atlstr.h>
 #include <strsafe.h>
 #include "AppErrors.h"
 #include "ImageDialog.h"
+#include "JobRunner.h"
 #include "globals.h"
 #include "BitStream.h"
 #include "imaging.h"
 #include "FileFunctions.h"
+#include "PngWriter.h"
+#include "ImageIO.h"
+#include "ImageFile.h"
+#include "BitReader.h"
+#include "BitOps.h"
+#include "Parallel.h"
+#include "ResultCache.h"
+#include "BufferPool.h"
+
+// size of the text output buffer used by the bit by bit text reports
+#define TEXTBUFFER_SIZE (64*1024)
+
+typedef struct TEXTBUFFER {
+    FILE* Out;                      // text output file
+    size_t Length;                  // # of characters in Text
+    char Text[TEXTBUFFER_SIZE];
+} TEXTBUFFER;
+
+// run lengths up to RUNHISTOGRAM_DENSE are counted in a table, longer runs
+// (which are rare) are counted in a map
+#define RUNHISTOGRAM_DENSE 4096
+#define RUNHISTOGRAM_END ((ULONGLONG)-1)
+
+// a correlation peak is reported as a harmonic of a shorter period if the
+// shorter period has at least this fraction of its correlation
+#define HARMONIC_RATIO 0.9
+
+// smallest section of the stream that is given its own thread
+#define RUNSECTION_MINBITS (1024*1024)
+
+// run length histogram used by BitRunHistogram()
+class RUNHISTOGRAM
+{
+public:
+    long long Sequences = 0;        // # of runs counted
+    long long Total = 0;            // sum of the run lengths
+    ULONGLONG MaxLength = 0;        // longest run counted
+
+    void Add(ULONGLONG Length, long long Number = 1);
+    void Merge(RUNHISTOGRAM& Source);
+    void Shift(void);
+    long long Count(ULONGLONG Length);
+    ULONGLONG NextLength(ULONGLONG Length);
+    void Fill(int* Row, int Xsize);
+
+private:
+    std::vector<long long> Dense;                   // Dense[Length], Length <= RUNHISTOGRAM_DENSE
+    std::map<ULONGLONG, long long> Long;            // Length > RUNHISTOGRAM_DENSE
+};
+
+// result of one section of the stream in BitRunHistogram()
+typedef struct RUNSECTION {
+    RUNHISTOGRAM Runs[2];           // runs that are completely inside the section, 0 and 1 runs
+    int Single;                     // TRUE if the section is a single run
+    int FirstValue;                 // first run in the section, -1 if the section is empty
+    ULONGLONG FirstLength;
+    int LastValue;                  // last run in the section, may continue in the next section
+    ULONGLONG LastLength;
+} RUNSECTION;
+
+// # of numbers in one segment of the prime sieve, one byte each
+#define SIEVE_SEGMENT_SIZE (256*1024)
+
+// number of APID values, the APID is 11 bits
+#define SPP_NUM_APID 2048
+
+// size of the stdio buffer for each APID output file in DemuxSPP()
+#define SPPSINK_BUFFERSIZE (64*1024)
+
+// largest text line for one packet, fixed fields + 4 characters per data byte
+#define SPPLINE_SIZE (128 + 4*65536)
+
+// APID output file and sequence count statistics used by DemuxSPP()
+typedef struct SPPSINK {
+    FILE* Out;                      // APID output file, NULL until the first packet for the APID
+    long long NumPackets;           // # of packets
+    long long NumBytes;             // # of bytes in the packets, primary headers + data fields
+    int FirstSeqCount;              // sequence count of the first packet
+    int LastSeqCount;               // sequence count of the previous packet
+    long long NumGaps;              // # of breaks in the sequence count
+    long long NumMissing;           // # of packets missing in the breaks
+    long long MaxMissing;           // largest # of packets missing in one break
+    long long NumRepeats;           // # of packets with the same sequence count as the previous packet
+} SPPSINK;
+
+// private functions in this file
+static size_t DecodeBitStreamPixels(BitReader* Reader, int* Pixels, size_t NumPixels,
+    int BitDepth, int BitOrder, int BitScale, int Invert);
+static int DecodeBitStreamImage(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
+    int PrologueSize, int BlockHeaderBits, int NumBlockBodyBits, int BlockNum, int xsize,
+    int BitDepth, int BitOrder, int BitScale, int Invert, int InputBitOrder);
+static int NumberedFilename(WCHAR* NewFilename, WCHAR* OutputFile, int Number, const WCHAR* NewExt);
+static TEXTBUFFER* OpenTextBuffer(FILE* Out);
+static void PutText(TEXTBUFFER* Buffer, const char* Text);
+static void CloseTextBuffer(TEXTBUFFER* Buffer);
+static void SievePrimes(int Limit, std::vector<int>* Primes);
+static void SieveSegment(LONGLONG Low, LONGLONG High, const std::vector<int>& BasePrimes,
+    BYTE* Composite, std::vector<int>* Primes);
 
 //*******************************************************************
 //
@@ -102,22 +237,20 @@ void ExtractFromBitStreamText(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
 {
     // This function is large because of formatting the output
     //  text file into header, {block header, block}, footer
-    FILE* In;
     FILE* Out;
-    int CurrentBit = 0;
+    BitReader Reader;
+    TEXTBUFFER* Text;
     int CurrentPrologueBit = 0;
     int CurrentFooterBit = 0;
-    int CurrentByteBit = 0;
     int CurrentBlock = 0;
     int CurrentHeaderBit = 0;
     int CurrentBlockBit = 0;
     int CurrentBlockCol = 0;
-    int CurentX = 0;
-    int CurrentY = 0;
+    int iRes;
     errno_t ErrNum;
 
-    ErrNum = _wfopen_s(&In, InputFile, L"rb");
-    if (In==NULL) {
+    iRes = Reader.Open(InputFile, BitOrder);
+    if (iRes != APP_SUCCESS) {
         MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
         return;
     }
@@ -125,164 +258,95 @@ void ExtractFromBitStreamText(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
     // this is a text file
     ErrNum = _wfopen_s(&Out, OutputFile, L"w");
     if (Out==NULL) {
-        fclose(In);
         MessageBox(hDlg, L"Could not open text output file", L"File I/O", MB_OK);
         return;
     }
 
-    while (!feof(In)) {
-        char CurrentByte;
+    Text = OpenTextBuffer(Out);
+    if (Text == NULL) {
+        fclose(Out);
+        MessageBox(hDlg, L"Text buffer allocation failure", L"Memory", MB_OK);
+        return;
+    }
+
+    // process input file bit by bit
+    // The reader returns the bits in the order of the bit transmission message,
+    // the selected bit order in byte, LSB to MSB or MSB to LSB, is handled by the reader.
+    // This does not imply any bit ordering in the message itself.
+    while (Reader.BitsLeft() > 0) {
         int BitValue;
-        size_t NumRead;
-        CurrentByteBit = 0;
 
-        NumRead = fread(&CurrentByte, 1, 1, In);
-        if (NumRead != 1) {
-            break;
+        BitValue = Reader.PeekBit();
+        if (Invert == 1) {
+            BitValue = BitValue ^ 1;
         }
-        // process input file bit by bit
-        // while extracting use selected bit order in byte, LSB to MSB or MSB to LSB
-        // variable Endian is really referring to bit order in byte not byte order in multiple byte sequence
-        while (CurrentByteBit < 8) {
-            // process data bit by bit in the order of the bit transmission message
-            // input file is byte oriented MSB to LSB representing the bit order that the message was received
-            // This does not imply any bit ordering in the message itself.
-            if (BitOrder == 0) {
-                BitValue = CurrentByte & (0x80 >> CurrentByteBit);
-            }
-            else {
-                BitValue = CurrentByte & (0x01 << CurrentByteBit);
-            }
-            if (Invert == 1) {
-                if (BitValue == 0) {
-                    BitValue = 1;
-                }
-                else {
-                    BitValue = 0;
-                }
-            }
-            // allow for message prolouge/header at the beginning of the message 
-            if (PrologueSize > 0) {
-                if (CurrentPrologueBit < PrologueSize) {
-                    // process header bits
-                    if (!BitValue) {
-                        if (CurrentPrologueBit == PrologueSize - 1) {
-                            fprintf(Out, "0\n");
-                        } else {
-                            fprintf(Out, "0,");
-                        }
-                    }
-                    else {
-                        if (CurrentPrologueBit == PrologueSize - 1) {
-                            fprintf(Out, "1\n");
-                        }
-                        else {
-                            fprintf(Out, "1,");
-                        }
-                    }
-                    CurrentByteBit++;
-                    CurrentPrologueBit++;
-                    CurrentBit++;
-                    continue;
-                } else {
-                    if (CurrentPrologueBit == PrologueSize) {
-                        CurrentPrologueBit++; // do not process anymore prologue bits
-                        fprintf(Out, "\n");
-                    }
+        // allow for message prolouge/header at the beginning of the message 
+        if (PrologueSize > 0) {
+            if (CurrentPrologueBit < PrologueSize) {
+                // process header bits
+                PutText(Text, BitValue ? "1" : "0");
+                PutText(Text, (CurrentPrologueBit == PrologueSize - 1) ? "\n" : ",");
+                Reader.Skip(1);
+                CurrentPrologueBit++;
+                continue;
+            } else {
+                if (CurrentPrologueBit == PrologueSize) {
+                    CurrentPrologueBit++; // do not process anymore prologue bits
+                    PutText(Text, "\n");
                 }
             }
+        }
 
-            // allow there to be a multibit header at start of a block
-            if (NumBlockHeaderBits > 0) {
-                if (CurrentHeaderBit < NumBlockHeaderBits) {
-                    // process header bits
-                    if (!BitValue) {
-                        if (CurrentHeaderBit == NumBlockHeaderBits - 1) {
-                            fprintf(Out, "0\n");
-                        }
-                        else {
-                            fprintf(Out, "0,");
-                        }
-                    } else {
-                        if (CurrentHeaderBit == NumBlockHeaderBits - 1) {
-                            fprintf(Out, "1\n");
-                        }
-                        else {
-                            fprintf(Out, "1,");
-                        }
-                    }
-                    CurrentByteBit++;
-                    CurrentHeaderBit++;
-                    CurrentBit++;
-                    continue;
-                } else {
-                    if (CurrentBlockBit == 0) {
-                        fprintf(Out, "\n");
-                    }
+        // allow there to be a multibit header at start of a block
+        if (NumBlockHeaderBits > 0) {
+            if (CurrentHeaderBit < NumBlockHeaderBits) {
+                // process header bits
+                PutText(Text, BitValue ? "1" : "0");
+                PutText(Text, (CurrentHeaderBit == NumBlockHeaderBits - 1) ? "\n" : ",");
+                Reader.Skip(1);
+                CurrentHeaderBit++;
+                continue;
+            } else {
+                if (CurrentBlockBit == 0) {
+                    PutText(Text, "\n");
                 }
             }
+        }
 
-            // process a block of a specified number of bits
-            if (CurrentBlock < NumBlocks) {
-                if (CurrentBlockBit < NumBlockBodyBits) {
-                    if (!BitValue) {
-                        if (CurrentBlockCol == (xsize - 1)) {
-                            fprintf(Out, "0\n"); // for 0
-                        }
-                        else {
-                            fprintf(Out, "0,"); // for 0
-                        }
-                    } else {
-                        if (CurrentBlockCol == (xsize - 1)) {
-                            fprintf(Out, "1\n"); // for 1
-                        }
-                        else {
-                            fprintf(Out, "1,"); // for 1
-                        }
-                    }
-                    CurrentBlockCol++;
-                    // assume block is in raster format with xsize bits on a line
-                    if (CurrentBlockCol >= xsize) {
-                        CurrentBlockCol = 0;
-                    }
-                    CurrentByteBit++;
-                    CurrentBlockBit++;
-                    CurrentBit++;
-                    continue;
+        // process a block of a specified number of bits
+        if (CurrentBlock < NumBlocks) {
+            if (CurrentBlockBit < NumBlockBodyBits) {
+                PutText(Text, BitValue ? "1" : "0");
+                PutText(Text, (CurrentBlockCol == (xsize - 1)) ? "\n" : ",");
+                CurrentBlockCol++;
+                // assume block is in raster format with xsize bits on a line
+                if (CurrentBlockCol >= xsize) {
+                    CurrentBlockCol = 0;
                 }
-                else {
-                    // start on next block
-                    fprintf(Out, "\n");
-                    CurrentHeaderBit = 0;
-                    CurrentBlockBit = 0;
-                    CurrentBlock++;
-                }
-                // don't increment CurrentByteBit, the current bit is the first bit of next block
+                Reader.Skip(1);
+                CurrentBlockBit++;
                 continue;
             }
-            // only get here if processing footer
-            // process footer bits
-            if (!BitValue) {
-                if (CurrentFooterBit == 0) {
-                    fprintf(Out, "0");
-                } else {
-                    fprintf(Out, ",0");
-                }
-            } else {
-                if (CurrentFooterBit == 0) {
-                    fprintf(Out, "1");
-                }
-                else {
-                    fprintf(Out, ",1");
-                }
+            else {
+                // start on next block
+                PutText(Text, "\n");
+                CurrentHeaderBit = 0;
+                CurrentBlockBit = 0;
+                CurrentBlock++;
             }
-            CurrentFooterBit++;
-            CurrentByteBit++;
-            CurrentBit++;
+            // don't move to the next bit, the current bit is the first bit of next block
+            continue;
         }
-        //fprintf(Out, "\n");
+        // only get here if processing footer
+        // process footer bits
+        if (CurrentFooterBit != 0) {
+            PutText(Text, ",");
+        }
+        PutText(Text, BitValue ? "1" : "0");
+        CurrentFooterBit++;
+        Reader.Skip(1);
     }
-    fclose(In);
+    CloseTextBuffer(Text);
     fclose(Out);
 
     return;
@@ -305,89 +369,50 @@ void ExtractFromBitStreamText(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
 void BitDistance(HWND hDlg, WCHAR* InputFile,WCHAR* OutputFile, int SkipSize,
     int BitOrder)
 {
-    FILE* In;
     FILE* Out;
-    int CurrentBit;
-    int CurrentPrologueBit;
-    int CurrentByteBit;
-    int CurrentPage;
-    int CurrentHeaderBit;
-    int CurrentPageBit;
-    int CurrentPageCol;
-    int CurentX;
-    int CurrentY;
+    BitReader Reader;
+    long long CurrentBit;
+    long long NumOnes;
+    long long Distance;
+    long long LastOne;
+    int iRes;
     errno_t ErrNum;
-    int NumOnes;
-    int Distance;
-    int LastOne;
 
-    ErrNum = _wfopen_s(&In, InputFile, L"rb");
-    if (In==NULL) {
+    iRes = Reader.Open(InputFile, BitOrder);
+    if (iRes != APP_SUCCESS) {
         MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
         return;
     }
 
     ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
     if (Out==NULL) {
-        fclose(In);
         MessageBox(hDlg, L"Could not open text output file", L"File I/O", MB_OK);
         return;
     }
 
-    CurrentBit = 0;
-    CurrentPage = 0;
-    CurrentHeaderBit = 0;
-    CurrentPageBit = 0;
-    CurentX = 0;
-    CurrentY = 0;
-    CurrentPrologueBit = 0;
-    CurrentPageCol = 0;
-    Distance = 0;
-    LastOne = -1;
+    if (SkipSize < 0) {
+        SkipSize = 0;
+    }
+    Reader.Skip(SkipSize);
+    LastOne = (long long)SkipSize - 1;
     NumOnes = 0;
 
-    while (!feof(In)) {
-        char CurrentByte;
-        int BitValue;
-        size_t NumRead;
-
-        CurrentByteBit = 0;
-
-        NumRead = fread(&CurrentByte, 1, 1, In);
-        if (NumRead <= 0) {
+    // process data in the order of the bit transmission message
+    // the runs of 0 bits between the 1 bits are skipped a word at a time
+    while (Reader.BitsLeft() > 0) {
+        Reader.RunLength(0, Reader.BitsLeft());
+        if (Reader.BitsLeft() == 0) {
             break;
         }
-
-        // process data bit by bit in the order of the bit transmission message
-        // input file is byte oriented MSB to LSB representing the bit order that the message was received
-        // This does not imply any bit ordering in the message itself.
-        while (CurrentByteBit < 8) {
-            if (CurrentBit < SkipSize) {
-                CurrentByteBit++;
-                CurrentBit++;
-                continue;
-            }
-            else if (CurrentBit == SkipSize) {
-                LastOne = CurrentBit - 1;
-            }
-            if (BitOrder == 0) {
-                BitValue = CurrentByte & (0x80 >> CurrentByteBit);
-            }
-            else {
-                BitValue = CurrentByte & (0x01 << CurrentByteBit);
-            }
-            if (BitValue) {
-                NumOnes++;
-                Distance = CurrentBit - LastOne;
-                fprintf(Out, "%5d,%5d\n", CurrentBit - SkipSize, Distance);
-                LastOne = CurrentBit;
-            }
-            CurrentByteBit++;
-            CurrentBit++;
-        }
+        // this is a 1 bit
+        CurrentBit = (long long)Reader.GetPosition();
+        NumOnes++;
+        Distance = CurrentBit - LastOne;
+        fprintf(Out, "%5lld,%5lld\n", CurrentBit - SkipSize, Distance);
+        LastOne = CurrentBit;
+        Reader.Skip(1);
     }
-    fprintf(Out, "Number of ones: %5d\n", NumOnes);
-    fclose(In);
+    fprintf(Out, "Number of ones: %5lld\n", NumOnes);
     fclose(Out);
 
     return;
@@ -410,152 +435,315 @@ void BitDistance(HWND hDlg, WCHAR* InputFile,WCHAR* OutputFile, int SkipSize,
 void BitSequences(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int SkipSize,
     int BitOrder)
 {
-    FILE* In;
     FILE* Out;
+    BitReader Reader;
+    long long NumOnes = 0;
+    long long NumZeros = 0;
+    long long NumSequences = 0;
+    long long Length;
+    int BitValue;
+    int iRes;
     errno_t ErrNum;
-    int CurrentBit = 0;
-    int CurrentPrologueBit = 0;
-    int CurrentByteBit = 0;
-    int NumOnes = 0;
-    int NumZeros = 0;
-    int LastBit = 0;
-    int BitCounter = 0;
-    int OneLength = 0;
-    int ZeroLength = 0;
-    int NumSequences = 0;
-    int CurrentState = 0; // 0 - this is first bit in file, 1 - counting 1 sequence, 2 counting 0 sequence
 
-    ErrNum = _wfopen_s(&In, InputFile, L"rb");
-    if (In==NULL) {
+    iRes = Reader.Open(InputFile, BitOrder);
+    if (iRes != APP_SUCCESS) {
         MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
         return;
     }
 
     ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
     if (Out==NULL) {
-        fclose(In);
         MessageBox(hDlg, L"Could not open text output file", L"File I/O", MB_OK);
         return;
     }
 
     fprintf(Out, "  Seq#,Bit, length\n");
 
-    while (!feof(In)) {
-        char CurrentByte;
-        int BitValue;
-        size_t NumRead;
-
-        CurrentByteBit = 0;
+    // skip Prologue bits
+    if (SkipSize > 0) {
+        Reader.Skip(SkipSize);
+    }
 
-        NumRead = fread(&CurrentByte, 1, 1, In);
-        if (NumRead <= 0) {
-            break;
+    // process data in the order of the bit transmission message
+    // each sequence is a run of bits with the same value as its first bit
+    while (Reader.BitsLeft() > 0) {
+        BitValue = Reader.PeekBit();
+        Length = (long long)Reader.RunLength(BitValue, Reader.BitsLeft());
+        NumSequences++;
+        if (BitValue) {
+            NumOnes += Length;
+            fprintf(Out, "%6lld, 1 ,%6lld\n", NumSequences, Length);
+        }
+        else {
+            NumZeros += Length;
+            fprintf(Out, "%6lld, 0 ,%6lld\n", NumSequences, Length);
         }
+    }
+
+    fprintf(Out, "Number of ones: %5lld\nNumber of Zeros: %5lld\n#sequences: %5lld", NumOnes, NumZeros, NumSequences);
+    fclose(Out);
+
+    return;
+}
+
+//*******************************************************************
+//
+//  BitRunHistogram
+// 
+// Generates a summary of the run lengths in a bitstream file instead
+// of the one line per sequence/per 1 bit reports of BitSequences() and
+// BitDistance().
+// The histograms are:
+//      run length -> # of 0 sequences of that length
+//      run length -> # of 1 sequences of that length
+//      gap length -> # of 1 bits that are that distance from the previous 1 bit
+//                    (the same distance as reported by BitDistance())
+// 
+// The file is split into sections that are processed in parallel, each
+// section has its own partial histogram.  The runs that cross a section
+// boundary are joined when the partial histograms are merged.
+// 
+// Parameters:
+// HWND hDlg            Handle of calling window/dialog
+// WCHAR* InputFile     Packed binary bitstream file
+// WCHAR* OutputFile    CSV text output file, only lengths with a non zero count
+//                      are listed
+// WCHAR* ImageFile     Optional histogram image file. "" -  no image file
+//                      The image has 3 rows, 0 sequences, 1 sequences, gaps
+//                      Column x is the count for length x+1.  Lengths longer than
+//                      RUNHISTOGRAM_DENSE are counted in the last column.
+// int SkipSize         # of bits to skip before starting (typically the prologue)
+// int BitOrder         0 - standard byte bit order for input file
+//                      1 - swap byte bit order for input file
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************
+int BitRunHistogram(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, WCHAR* ImageFile,
+    int SkipSize, int BitOrder)
+{
+    FILE* Out;
+    BitReader Reader;
+    RUNSECTION* Sections;
+    RUNHISTOGRAM Runs[2];
+    RUNHISTOGRAM Gaps;
+    int NumSections;
+    ULONGLONG StartBit;
+    ULONGLONG NumBits;
+    ULONGLONG PendingLength = 0;
+    int PendingValue = -1;
+    int FirstValue = -1;
+    int iRes;
+    errno_t ErrNum;
+
+    iRes = Reader.Open(InputFile, BitOrder);
+    if (iRes != APP_SUCCESS) {
+        MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
+        return iRes;
+    }
 
-        // process data bit by bit in the order of the bit transmission message
-        // input file is byte oriented MSB to LSB representing the bit order that the message was received
-        // This does not imply any bit ordering in the message itself.
+    if (SkipSize < 0) {
+        SkipSize = 0;
+    }
+    Reader.Skip(SkipSize);
+    StartBit = Reader.GetPosition();
+    NumBits = Reader.BitsLeft();
+
+    // split the stream into sections, small files are done in one section
+    NumSections = GetWorkerCount();
+    if ((ULONGLONG)NumSections > NumBits / RUNSECTION_MINBITS + 1) {
+        NumSections = (int)(NumBits / RUNSECTION_MINBITS + 1);
+    }
+    Sections = new RUNSECTION[NumSections];
+    if (Sections == NULL) {
+        MessageBox(hDlg, L"Run histogram memory allocation failure", L"Memory", MB_OK);
+        return APPERR_MEMALLOC;
+    }
 
-        while (CurrentByteBit < 8) {
-            // skip Prologue bits
-            if (CurrentBit < SkipSize) {
-                CurrentByteBit++;
-                CurrentBit++;
+    ParallelFor(0, NumSections, [&](int First, int Last) {
+        BitReader SectionReader;
+
+        // each thread has its own read position in the same file data
+        SectionReader.OpenView(Reader.GetData(), Reader.GetDataSize(), BitOrder);
+        for (int i = First; i < Last; i++) {
+            ULONGLONG Start = StartBit + (NumBits * i) / NumSections;
+            ULONGLONG End = StartBit + (NumBits * (i + 1)) / NumSections;
+            RUNSECTION* Section = &Sections[i];
+            int BitValue;
+            ULONGLONG Length;
+
+            Section->Single = TRUE;
+            Section->FirstValue = -1;
+            Section->FirstLength = 0;
+            Section->LastValue = -1;
+            Section->LastLength = 0;
+            SectionReader.Seek(Start);
+            if (Start >= End) {
                 continue;
             }
 
-            // current bit
-            if (BitOrder == 0) {
-                BitValue = CurrentByte & (0x80 >> CurrentByteBit);
-            }
-            else {
-                BitValue = CurrentByte & (0x01 << CurrentByteBit);
-            }
-            // process this bit
-            // possible states:
-            //      first bit
-            //      counting zeros
-            //      counting ones
-            // 
-            switch (CurrentState) {
-            case 0:
-            {
-                if (BitValue) {
-                    CurrentState = 1;
-                    NumOnes = 1;
-                    OneLength = 1;
-                }
-                else {
-                    CurrentState = 2;
-                    NumZeros = 1;
-                    ZeroLength = 1;
+            // the first run may continue from the previous section
+            Section->FirstValue = SectionReader.PeekBit();
+            Section->FirstLength = SectionReader.RunLength(Section->FirstValue, End - Start);
+            Section->LastValue = Section->FirstValue;
+            Section->LastLength = Section->FirstLength;
+
+            while (SectionReader.GetPosition() < End) {
+                BitValue = SectionReader.PeekBit();
+                Length = SectionReader.RunLength(BitValue, End - SectionReader.GetPosition());
+                if (!Section->Single) {
+                    // the previous run is complete
+                    Section->Runs[Section->LastValue].Add(Section->LastLength);
                 }
-                break;
+                Section->Single = FALSE;
+                // the last run may continue in the next section
+                Section->LastValue = BitValue;
+                Section->LastLength = Length;
             }
+        }
+    });
 
-            case 1:
-            {
-                if (BitValue) {
-                    // another 1
-                    NumOnes++;
-                    OneLength++;
-                    break;
-                }
+    // merge the partial histograms in stream order, joining the runs
+    // that cross the section boundaries
+    for (int i = 0; i < NumSections; i++) {
+        RUNSECTION* Section = &Sections[i];
 
-                // this is a 0, so change states
-                // save result of 1 sequence
-                NumSequences++;
-                fprintf(Out, "%6d, 1 ,%6d\n", NumSequences, OneLength);
-                ZeroLength = 1;
-                NumZeros++;
-                CurrentState = 2;
-                break;
+        if (Section->FirstValue < 0) {
+            continue;
+        }
+        Runs[0].Merge(Section->Runs[0]);
+        Runs[1].Merge(Section->Runs[1]);
+        if (FirstValue < 0) {
+            FirstValue = Section->FirstValue;
+        }
+        if (Section->FirstValue == PendingValue) {
+            PendingLength += Section->FirstLength;
+        }
+        else {
+            if (PendingValue >= 0) {
+                Runs[PendingValue].Add(PendingLength);
             }
+            PendingValue = Section->FirstValue;
+            PendingLength = Section->FirstLength;
+        }
+        if (!Section->Single) {
+            Runs[PendingValue].Add(PendingLength);
+            PendingValue = Section->LastValue;
+            PendingLength = Section->LastLength;
+        }
+    }
+    delete[] Sections;
+
+    // the gaps are found from the runs
+    //  each 0 sequence followed by a 1 bit is a gap of length+1
+    //  every other 1 bit is a gap of 1
+    //  a final 0 sequence is not a gap, it is added after the gaps are found
+    Gaps.Merge(Runs[0]);
+    Gaps.Shift();
+    if (PendingValue >= 0) {
+        Runs[PendingValue].Add(PendingLength);
+    }
+    Gaps.Add(1, Runs[1].Total - Runs[1].Sequences + (FirstValue == 1 ? 1 : 0));
 
-            case 2:
-            {
-                if (BitValue == 0) {
-                    // another 0
-                    NumZeros++;
-                    ZeroLength++;
-                    break;
-                }
+    ErrNum = _wfopen_s(&Out, OutputFile, L"w");
+    if (Out == NULL) {
+        MessageBox(hDlg, L"Could not open text output file", L"File I/O", MB_OK);
+        return APPERR_FILEOPEN;
+    }
 
-                // this is a 1, so change states
-                // save result of 0 sequence
-                NumSequences++;
-                fprintf(Out, "%6d, 0 ,%6d\n", NumSequences, ZeroLength);
-                OneLength = 1;
-                NumOnes++;
-                CurrentState = 1;
-                break;
+    fprintf(Out, "Length, 0 sequences, 1 sequences,      gaps\n");
+    {
+        ULONGLONG Length = 0;
+        ULONGLONG Next;
+
+        // step through the lengths that have a count in any of the histograms
+        while (TRUE) {
+            Next = Runs[0].NextLength(Length);
+            if (Runs[1].NextLength(Length) < Next) {
+                Next = Runs[1].NextLength(Length);
             }
-
-            default:
-                // should never get here
+            if (Gaps.NextLength(Length) < Next) {
+                Next = Gaps.NextLength(Length);
+            }
+            if (Next == RUNHISTOGRAM_END) {
                 break;
-            };
-
-            CurrentByteBit++;
-            CurrentBit++;
+            }
+            Length = Next;
+            fprintf(Out, "%6llu, %11lld, %11lld, %9lld\n", Length,
+                Runs[0].Count(Length), Runs[1].Count(Length), Gaps.Count(Length));
         }
     }
-
-    // save last state results
-    if (CurrentState==1) {
-        NumSequences++;
-        fprintf(Out, "%6d, 1 ,%6d\n", NumSequences, OneLength);
+    fprintf(Out, "\nNumber of ones: %5lld\nNumber of Zeros: %5lld\n#sequences: %5lld\n",
+        Runs[1].Total, Runs[0].Total, Runs[0].Sequences + Runs[1].Sequences);
+    fprintf(Out, "Longest 0 sequence: %llu\nLongest 1 sequence: %llu\n",
+        Runs[0].MaxLength, Runs[1].MaxLength);
+
+    if (fclose(Out) != 0) {
+        MessageBox(hDlg, L"Could not write text output file", L"File I/O", MB_OK);
+        return APPERR_FILEWRITE;
     }
-    else if (CurrentState == 2) {
-        NumSequences++;
-        fprintf(Out, "%6d, 0 ,%6d\n", NumSequences, OneLength);
+
+    if (ImageFile == NULL || wcslen(ImageFile) == 0) {
+        return APP_SUCCESS;
     }
 
-    fprintf(Out, "Number of ones: %5d\nNumber of Zeros: %5d\n#sequences: %5d", NumOnes, NumZeros,NumSequences);
-    fclose(In);
-    fclose(Out);
+    // histogram image, one row per histogram
+    {
+        IMAGINGHEADER ImgHeader;
+        int* Image;
+        int Xsize;
 
-    return;
+        Xsize = (int)Runs[0].MaxLength;
+        if ((int)Runs[1].MaxLength > Xsize) {
+            Xsize = (int)Runs[1].MaxLength;
+        }
+        if ((int)Gaps.MaxLength > Xsize) {
+            Xsize = (int)Gaps.MaxLength;
+        }
+        if (Xsize > RUNHISTOGRAM_DENSE || Xsize < 0) {
+            Xsize = RUNHISTOGRAM_DENSE;
+        }
+        if (Xsize < 1) {
+            Xsize = 1;
+        }
+
+        Image = new int[(size_t)Xsize * 3];
+        if (Image == NULL) {
+            MessageBox(hDlg, L"Histogram image memory allocation failure", L"Memory", MB_OK);
+            return APPERR_MEMALLOC;
+        }
+        Runs[0].Fill(Image, Xsize);
+        Runs[1].Fill(Image + Xsize, Xsize);
+        Gaps.Fill(Image + 2 * Xsize, Xsize);
+
+        ImgHeader.Endian = (short)-1;  // PC format
+        ImgHeader.HeaderSize = (short)sizeof(IMAGINGHEADER);
+        ImgHeader.ID = (short)0xaaaa;
+        ImgHeader.Version = (short)1;
+        ImgHeader.NumFrames = (short)1;
+        ImgHeader.PixelSize = (short)4;
+        ImgHeader.Xsize = Xsize;
+        ImgHeader.Ysize = 3;
+        for (int i = 0; i < 6; i++) {
+            ImgHeader.Padding[i] = 0;
+        }
+
+        iRes = WriteImageFile(ImageFile, Image, &ImgHeader);
+        if (iRes != APP_SUCCESS) {
+            delete[] Image;
+            MessageBox(hDlg, L"Could not write histogram image file", L"File I/O", MB_OK);
+            return iRes;
+        }
+
+        if (DisplayResults) {
+            DisplayImageFrame(Image, &ImgHeader);
+        }
+        delete[] Image;
+    }
+
+    return APP_SUCCESS;
 }
 
 //******************************************************************************
@@ -654,24 +842,22 @@ void BitStreamStats(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
     int PrologueSize, int NumBlockHeaderBits, int NumBlockBodyBits,
     int BlockNum, int BitOrder)
 {
-    FILE* In;
     FILE* Out;
-    int CurrentBit = 0;
-    int CurrentPrologueBit = 0;
-    int CurrentFooterBit = 0;
-    int CurrentByteBit = 0;
+    BitReader Reader;
+    const BYTE* Data;
+    size_t DataSize;
     int CurrentBlock = 0;
-    int CurrentHeaderBit = 0;
-    int CurrentBlockBit = 0;
-    int CurentX = 0;
-    int CurrentY = 0;
-    int NumberOfOnes = 0;
-    int TotalBits = 0;
-    int Histo[256];
+    long long CurrentBlockBit = 0;
+    long long CurrentFooterBit = 0;
+    long long NumberOfOnes = 0;
+    long long Ones;
+    long long TotalBits = 0;
+    long long Histo[256];
+    int iRes;
     errno_t ErrNum;
 
-    ErrNum = _wfopen_s(&In, InputFile, L"rb");
-    if (In==NULL) {
+    iRes = Reader.Open(InputFile, BitOrder);
+    if (iRes != APP_SUCCESS) {
         MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
         return;
     }
@@ -679,7 +865,6 @@ void BitStreamStats(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
     // this is a text file
     ErrNum = _wfopen_s(&Out, OutputFile, L"w");
     if (Out==NULL) {
-        fclose(In);
         MessageBox(hDlg, L"Could not open text output file", L"File I/O", MB_OK);
         return;
     }
@@ -689,122 +874,79 @@ void BitStreamStats(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
     fprintf(Out, "Header size per block:%d\nBlock size:%d\n\n",
         NumBlockHeaderBits, NumBlockBodyBits);
     fprintf(Out, "Bit stats:\n");
+
+    // histogram of the bytes in the file
     for (int i = 0; i < 256; i++) {
         Histo[i] = 0;
     }
+    Data = Reader.GetData();
+    DataSize = Reader.GetDataSize();
+    for (size_t i = 0; i < DataSize; i++) {
+        Histo[Data[i]]++;
+    }
 
-    while (!feof(In)) {
-        unsigned char CurrentByte;
-        int BitValue;
-        size_t NumRead;
-        CurrentByteBit = 0;
-
-        NumRead = fread(&CurrentByte, 1, 1, In);
-        if (NumRead != 1) {
-            break;
+    // count the bits set in each section of the file in the order
+    // of the bit transmission message.
+    // The count for a section is reported once a bit following the section is found
+    // allow for message prolouge/header at the beginning of the message 
+    if (PrologueSize > 0) {
+        NumberOfOnes = (long long)Reader.CountOnes(PrologueSize);
+        TotalBits += NumberOfOnes;
+        if (Reader.BitsLeft() > 0) {
+            fprintf(Out, "Number of bits set in prologue (header): %6lld, %5.1f%%\n", NumberOfOnes,
+                100.0*(float)NumberOfOnes / (float)PrologueSize);
+            NumberOfOnes = 0;
         }
-        Histo[CurrentByte]++; // add to histogram
-
-        // process input file bit by bit
-        // while extracting use selected bit order in byte, LSB to MSB or MSB to LSB
-        // variable Endian is really referring to bit order in byte not byte order in multiple byte sequence
-        while (CurrentByteBit < 8) {
-            // process data bit by bit in the order of the bit transmission message
-            // input file is byte oriented MSB to LSB representing the bit order that the message was received
-            // This does not imply any bit ordering in the message itself.
-            if (BitOrder == 0) {
-                BitValue = CurrentByte & (0x80 >> CurrentByteBit);
-            }
-            else {
-                BitValue = CurrentByte & (0x01 << CurrentByteBit);
-            }
-            // allow for message prolouge/header at the beginning of the message 
-            if (PrologueSize > 0) {
-                if (CurrentPrologueBit < PrologueSize) {
-                    // process header bits
-                    if (BitValue) {
-                        NumberOfOnes++;
-                        TotalBits++;
-                    }
-                    CurrentByteBit++;
-                    CurrentPrologueBit++;
-                    CurrentBit++;
-                    continue;
-                } else {
-                    if (CurrentPrologueBit == PrologueSize) {
-                        fprintf(Out, "Number of bits set in prologue (header): %6d, %5.1f%%\n", NumberOfOnes,
-                            100.0*(float)NumberOfOnes / (float)PrologueSize);
-                        NumberOfOnes = 0;
-                        CurrentPrologueBit++; // do not process anymore prologue bits
-                    }
-                }
-            }
+    }
 
-            // allow there to be a multibit header at start of a block
-            if (NumBlockHeaderBits > 0) {
-                if (CurrentHeaderBit < NumBlockHeaderBits) {
-                    // process header bits
-                    if (BitValue) {
-                        NumberOfOnes++;
-                        TotalBits++;
-                     }
-                    CurrentByteBit++;
-                    CurrentHeaderBit++;
-                    CurrentBit++;
-                    continue;
-                } else {
-                    if (CurrentBlockBit == 0) {
-                        fprintf(Out, "Number of bits set in header, block %3d: %6d, %5.1f%%\n",
-                            CurrentBlock, NumberOfOnes,
-                            100.0*(float)NumberOfOnes / (float)NumBlockHeaderBits);
-                        NumberOfOnes = 0;
-                    }
-                }
+    while (CurrentBlock < BlockNum && Reader.BitsLeft() > 0) {
+        // allow there to be a multibit header at start of a block
+        if (NumBlockHeaderBits > 0) {
+            Ones = (long long)Reader.CountOnes(NumBlockHeaderBits);
+            NumberOfOnes += Ones;
+            TotalBits += Ones;
+            if (Reader.BitsLeft() == 0) {
+                break;
             }
+            fprintf(Out, "Number of bits set in header, block %3d: %6lld, %5.1f%%\n",
+                CurrentBlock, NumberOfOnes,
+                100.0*(float)NumberOfOnes / (float)NumBlockHeaderBits);
+            NumberOfOnes = 0;
+        }
 
-            // process a block of a specified number of bits
-            if (CurrentBlock < BlockNum) {
-                if (CurrentBlockBit < NumBlockBodyBits) {
-                    if (BitValue) {
-                        NumberOfOnes++;
-                        TotalBits++;
-                    }
-                    CurrentByteBit++;
-                    CurrentBlockBit++;
-                    CurrentBit++;
-                    continue;
-                } else {
-                    // start on next block
-                    fprintf(Out, "Number of bits set in body, block %3d: %6d, %5.1f%%\n",
-                        CurrentBlock, NumberOfOnes,
-                        100.0*(float)NumberOfOnes / (float)NumBlockBodyBits);
-                    NumberOfOnes = 0;
-                    CurrentHeaderBit = 0;
-                    CurrentBlockBit = 0;
-                    CurrentBlock++;
-                }
-                // don't increment CurrentByteBit, the current bit is the first bit of next block
-                continue;
-            }
-            // only get here if processing footer
-            // process footer bits
-            if (BitValue) {
-                NumberOfOnes++;
-                TotalBits++;
-            }
-            CurrentFooterBit++;
-            CurrentByteBit++;
-            CurrentBit++;
+        // process a block of a specified number of bits
+        CurrentBlockBit = (long long)Reader.BitsLeft();
+        if (CurrentBlockBit > NumBlockBodyBits) {
+            CurrentBlockBit = NumBlockBodyBits;
+        }
+        Ones = (long long)Reader.CountOnes(CurrentBlockBit);
+        NumberOfOnes += Ones;
+        TotalBits += Ones;
+        if (CurrentBlockBit < NumBlockBodyBits || Reader.BitsLeft() == 0) {
+            // end of file, the last block is reported below
+            break;
         }
-        
+        // start on next block
+        fprintf(Out, "Number of bits set in body, block %3d: %6lld, %5.1f%%\n",
+            CurrentBlock, NumberOfOnes,
+            100.0*(float)NumberOfOnes / (float)NumBlockBodyBits);
+        NumberOfOnes = 0;
+        CurrentBlockBit = 0;
+        CurrentBlock++;
     }
+
+    // the remaining bits are the footer
+    CurrentFooterBit = (long long)Reader.BitsLeft();
     if (CurrentFooterBit != 0) {
-        fprintf(Out, "Number of bits found in footer: %6d\n", CurrentFooterBit);
-        fprintf(Out, "Number of bits set in footer: %6d, %5.1f%%\n",
+        Ones = (long long)Reader.CountOnes(CurrentFooterBit);
+        NumberOfOnes += Ones;
+        TotalBits += Ones;
+        fprintf(Out, "Number of bits found in footer: %6lld\n", CurrentFooterBit);
+        fprintf(Out, "Number of bits set in footer: %6lld, %5.1f%%\n",
             NumberOfOnes, 100.0*(float)NumberOfOnes / (float)CurrentFooterBit);
     } else {
         if (CurrentBlockBit >= NumBlockBodyBits) {
-            fprintf(Out, "Number of bits set in body, block %3d: %6d, %5.1f%%\n",
+            fprintf(Out, "Number of bits set in body, block %3d: %6lld, %5.1f%%\n",
                 CurrentBlock, NumberOfOnes,
                 100.0 * (float)NumberOfOnes / (float)NumBlockBodyBits);
         } else {
@@ -813,13 +955,12 @@ void BitStreamStats(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
         fprintf(Out, "No footer bits\n");
     }
     
-    fprintf(Out, "Total number of bits set: %d\n", TotalBits);
+    fprintf(Out, "Total number of bits set: %lld\n", TotalBits);
     fprintf(Out, "Histogram of bytes in the stream file:\nValue,Count\n");
     for(int i = 0; i < 256; i++) {
-        fprintf(Out, "%5d, %d\n", i, Histo[i]);
+        fprintf(Out, "%5d, %lld\n", i, Histo[i]);
     }
 
-    fclose(In);
     fclose(Out);
 
     return;
@@ -827,44 +968,337 @@ void BitStreamStats(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
 
 //******************************************************************************
 //
-// ExtractBits
+// BitAutocorrelation
+// 
+// Report the autocorrelation of the bitstream over a range of lags and rank
+// the lags that are the best candidates for the period (message width) of the
+// bitstream.  A period of Lag bits is an image xsize of Lag/(image bit depth).
+// 
+// The same block model as BitStreamStats() is used.  The prologue and the
+// block headers are skipped, the correlation is calculated within the body of
+// each block and summed over the blocks.
+// 
+// The correlation for a lag is calculated 64 bits at a time by XOR of the
+// body and the body shifted by the lag and counting the bits that are
+// different.  The lags are processed in parallel.
+// The correlation is normalized for the density of 1 bits in the stream:
+//      C = ((1 - 2*Different/Compared) - m*m)/(1 - m*m)
+//      m = 2*(fraction of 1 bits) - 1
+//  C is 1 for a perfectly periodic stream, about 0 for random bits.
 // 
-// Extract specifed bits from binary packed bitstream file
-// to a text file
-//
 // Parameters:
-//  HWND hDlg           Handle of calling window or dialog
-//  WCHAR* InputFile    Packed Binary Btstream input file
-//  CHAR* OutputFile    Name of text file to output
-//  int SkipSize        Numberof bits to skip from beginning
-//  int CopyBits        Number of bits to copy
-//  int xsize           Number of bit to report on a line
-//                      (if 0 then all bits are on one line)
+//  HWND hDlg               handle of calling window/dialog
+//  WCHAR* InputFile        Name of packed binary bitstream
+//  WCHAR* OutputFile       Name of text output file
+//  int PrologueSize        # of bits in prologue (0 - no prologue)      
+//  int NumBlockHeaderBits  # of bits in block header (0 - no block header)
+//  int NumBlockBodyBits    # of bits in block body (>=1)
+//  int BlockNum            # of blocks (>=1)
+//  int MinLag              smallest lag in bits (>=1)
+//  int MaxLag              largest lag in bits (<NumBlockBodyBits)
+//  int NumCandidates       # of candidate periods to report
+//  int BitOrder            0 - standard byte bit order for input file
+//                          1 - swap byte bit order for input file
 // 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
 //******************************************************************************
-void ExtractBits(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
-    int SkipSize, int CopyBits, int xsize, int Invert, int BitOrder)
+int BitAutocorrelation(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
+    int PrologueSize, int NumBlockHeaderBits, int NumBlockBodyBits, int BlockNum,
+    int MinLag, int MaxLag, int NumCandidates, int BitOrder)
 {
-    FILE* In;
     FILE* Out;
-    int CurrentBit = 0;
-    int CurrentByteBit = 0;
-    int CurrentX = 0;
-    int CurrentCopyBits = 0;
+    BitReader Reader;
+    ULONGLONG* Words;
+    int* BodyBits;
+    long long* Different;
+    long long* Compared;
+    double* Correlation;
+    size_t WordsPerBlock;
+    ULONGLONG BlockStride;
+    int NumLags;
+    int NumBlocks;
+    long long TotalBits = 0;
+    long long TotalOnes = 0;
+    double Mean;
+    int iRes;
     errno_t ErrNum;
 
-    if (SkipSize<0) {
-        MessageBox(hDlg, L"# of bits to skip < 0", L"Parameter error", MB_OK);
-        return;
+    if (NumBlockBodyBits <= 1) {
+        MessageBox(hDlg, L"# bits in block must be > 1", L"Parameter error", MB_OK);
+        return APPERR_PARAMETER;
     }
-
-    if (CopyBits <= 0) {
-        MessageBox(hDlg, L"# of bits to copy <= 0", L"Parameter error", MB_OK);
-        return;
+    if (BlockNum <= 0) {
+        MessageBox(hDlg, L"Number of blocks must be >= 1", L"Parameter error", MB_OK);
+        return APPERR_PARAMETER;
+    }
+    if (MinLag < 1) {
+        MinLag = 1;
+    }
+    if (MaxLag >= NumBlockBodyBits) {
+        MaxLag = NumBlockBodyBits - 1;
+    }
+    if (MaxLag < MinLag) {
+        MessageBox(hDlg, L"1 <= lag start <= lag end < # bits in block", L"Parameter error", MB_OK);
+        return APPERR_PARAMETER;
+    }
+    if (NumCandidates < 1) {
+        NumCandidates = 1;
+    }
+    if (PrologueSize < 0) {
+        PrologueSize = 0;
+    }
+    if (NumBlockHeaderBits < 0) {
+        NumBlockHeaderBits = 0;
     }
 
-    ErrNum = _wfopen_s(&In, InputFile, L"rb");
-    if (In==NULL) {
+    iRes = Reader.Open(InputFile, BitOrder);
+    if (iRes != APP_SUCCESS) {
+        MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
+        return iRes;
+    }
+
+    // # of blocks that start in the file
+    BlockStride = (ULONGLONG)NumBlockHeaderBits + (ULONGLONG)NumBlockBodyBits;
+    NumBlocks = 0;
+    if (Reader.GetTotalBits() > (ULONGLONG)PrologueSize + (ULONGLONG)NumBlockHeaderBits) {
+        ULONGLONG FileBlocks = (Reader.GetTotalBits() - PrologueSize - NumBlockHeaderBits + BlockStride - 1) / BlockStride;
+        NumBlocks = FileBlocks < (ULONGLONG)BlockNum ? (int)FileBlocks : BlockNum;
+    }
+    if (NumBlocks == 0) {
+        MessageBox(hDlg, L"No block body bits in the file with these settings", L"File I/O", MB_OK);
+        return APPERR_FILESIZE;
+    }
+
+    // copy the block bodies into word arrays, each body starts on a word boundary
+    // and is followed by at least one word of 0 so that the shifted body can
+    // always be read with 2 words
+    WordsPerBlock = (size_t)(NumBlockBodyBits / 64) + 2;
+    Words = new ULONGLONG[(size_t)NumBlocks * WordsPerBlock];
+    if (Words == NULL) {
+        MessageBox(hDlg, L"Bitstream memory allocation failure", L"Memory", MB_OK);
+        return APPERR_MEMALLOC;
+    }
+    BodyBits = new int[NumBlocks];
+    if (BodyBits == NULL) {
+        delete[] Words;
+        MessageBox(hDlg, L"Bitstream memory allocation failure", L"Memory", MB_OK);
+        return APPERR_MEMALLOC;
+    }
+    for (int Block = 0; Block < NumBlocks; Block++) {
+        ULONGLONG* Body = Words + (size_t)Block * WordsPerBlock;
+        ULONGLONG Left;
+
+        Reader.Seek((ULONGLONG)PrologueSize + (ULONGLONG)Block * BlockStride + (ULONGLONG)NumBlockHeaderBits);
+        Left = Reader.BitsLeft();
+        BodyBits[Block] = Left < (ULONGLONG)NumBlockBodyBits ? (int)Left : NumBlockBodyBits;
+        for (size_t i = 0; i < WordsPerBlock; i++) {
+            Body[i] = 0;
+        }
+        for (int i = 0; i < BodyBits[Block]; i += 64) {
+            Body[i / 64] = Reader.PeekWord();
+            if (BodyBits[Block] - i < 64) {
+                // clear the bits after the end of the body
+                Body[i / 64] &= ~(~0ULL >> (BodyBits[Block] - i));
+            }
+            Reader.Skip(64);
+        }
+        for (size_t i = 0; i < WordsPerBlock; i++) {
+            TotalOnes += PopCount64(Body[i]);
+        }
+        TotalBits += BodyBits[Block];
+    }
+    Reader.Close();
+
+    NumLags = MaxLag - MinLag + 1;
+    Different = new long long[NumLags];
+    Compared = new long long[NumLags];
+    Correlation = new double[NumLags];
+    if (Different == NULL || Compared == NULL || Correlation == NULL) {
+        delete[] Words;
+        delete[] BodyBits;
+        delete[] Different;
+        delete[] Compared;
+        delete[] Correlation;
+        MessageBox(hDlg, L"Autocorrelation memory allocation failure", L"Memory", MB_OK);
+        return APPERR_MEMALLOC;
+    }
+
+    ParallelFor(0, NumLags, [&](int First, int Last) {
+        for (int i = First; i < Last; i++) {
+            int Lag = MinLag + i;
+            int WordShift = Lag / 64;
+            int BitShift = Lag % 64;
+
+            Different[i] = 0;
+            Compared[i] = 0;
+            for (int Block = 0; Block < NumBlocks; Block++) {
+                const ULONGLONG* Body = Words + (size_t)Block * WordsPerBlock;
+                int NumCompared = BodyBits[Block] - Lag;
+
+                if (NumCompared <= 0) {
+                    continue;
+                }
+                for (int k = 0; k * 64 < NumCompared; k++) {
+                    ULONGLONG Shifted;
+                    ULONGLONG Diff;
+
+                    // bits k*64+Lag to k*64+Lag+63 of the body
+                    Shifted = Body[k + WordShift];
+                    if (BitShift != 0) {
+                        Shifted = (Shifted << BitShift) | (Body[k + WordShift + 1] >> (64 - BitShift));
+                    }
+                    Diff = Body[k] ^ Shifted;
+                    if (NumCompared - k * 64 < 64) {
+                        Diff &= ~(~0ULL >> (NumCompared - k * 64));
+                    }
+                    Different[i] += PopCount64(Diff);
+                }
+                Compared[i] += NumCompared;
+            }
+        }
+    });
+    delete[] Words;
+    delete[] BodyBits;
+
+    Mean = 2.0 * (double)TotalOnes / (double)TotalBits - 1.0;
+    for (int i = 0; i < NumLags; i++) {
+        if (Compared[i] == 0 || Mean * Mean >= 1.0) {
+            Correlation[i] = 0.0;
+        }
+        else {
+            Correlation[i] = ((1.0 - 2.0 * (double)Different[i] / (double)Compared[i]) - Mean * Mean) /
+                (1.0 - Mean * Mean);
+        }
+    }
+
+    // the candidates are the local peaks of the correlation, best first
+    std::vector<int> Peaks;
+    std::vector<int> Fundamental(NumLags, 0);
+    std::vector<char> IsPeak(NumLags, 0);
+    for (int i = 0; i < NumLags; i++) {
+        if ((i == 0 || Correlation[i] > Correlation[i - 1]) &&
+            (i == NumLags - 1 || Correlation[i] >= Correlation[i + 1])) {
+            Peaks.push_back(i);
+            IsPeak[i] = 1;
+        }
+    }
+    // a periodic stream also has peaks at the multiples of the period, a peak is
+    // a harmonic if a peak at a lag that divides it has nearly the same correlation
+    for (int i : Peaks) {
+        int Lag = MinLag + i;
+        for (int k = Lag / MinLag; k >= 2; k--) {
+            int Divisor;
+            if ((Lag % k) != 0) {
+                continue;
+            }
+            Divisor = Lag / k;
+            if (IsPeak[Divisor - MinLag] &&
+                Correlation[Divisor - MinLag] >= HARMONIC_RATIO * Correlation[i]) {
+                Fundamental[i] = Divisor;
+                break;
+            }
+        }
+    }
+    // the periods that are not harmonics are reported first
+    std::stable_sort(Peaks.begin(), Peaks.end(), [&](int a, int b) {
+        if ((Fundamental[a] == 0) != (Fundamental[b] == 0)) {
+            return Fundamental[a] == 0;
+        }
+        return Correlation[a] > Correlation[b];
+    });
+    if ((int)Peaks.size() > NumCandidates) {
+        Peaks.resize(NumCandidates);
+    }
+
+    ErrNum = _wfopen_s(&Out, OutputFile, L"w");
+    if (Out == NULL) {
+        delete[] Different;
+        delete[] Compared;
+        delete[] Correlation;
+        MessageBox(hDlg, L"Could not open text output file", L"File I/O", MB_OK);
+        return APPERR_FILEOPEN;
+    }
+
+    fprintf(Out, "Bitstream autocorrelation\n");
+    fprintf(Out, "File report settings:\nHeader size:%d\nNumber of Blocks:%d\n",
+        PrologueSize, BlockNum);
+    fprintf(Out, "Header size per block:%d\nBlock size:%d\n", NumBlockHeaderBits, NumBlockBodyBits);
+    fprintf(Out, "Lags:%d to %d\n\n", MinLag, MaxLag);
+    fprintf(Out, "Blocks in file:%d\nBody bits:%lld\nBody bits set:%lld, %5.1f%%\n\n",
+        NumBlocks, TotalBits, TotalOnes, 100.0 * (double)TotalOnes / (double)TotalBits);
+
+    fprintf(Out, "Candidate periods (xsize = Lag/image bit depth):\n");
+    fprintf(Out, "Rank,   Lag, Correlation,  z-score, Multiple of\n");
+    for (int Rank = 0; Rank < (int)Peaks.size(); Rank++) {
+        int Lag = MinLag + Peaks[Rank];
+
+        fprintf(Out, "%4d, %5d, %11.5f, %8.1f,", Rank + 1, Lag, Correlation[Peaks[Rank]],
+            Correlation[Peaks[Rank]] * sqrt((double)Compared[Peaks[Rank]]));
+        if (Fundamental[Peaks[Rank]]) {
+            fprintf(Out, " %d", Fundamental[Peaks[Rank]]);
+        }
+        fprintf(Out, "\n");
+    }
+
+    fprintf(Out, "\nAutocorrelation:\n  Lag, Correlation\n");
+    for (int i = 0; i < NumLags; i++) {
+        fprintf(Out, "%5d, %11.5f\n", MinLag + i, Correlation[i]);
+    }
+
+    delete[] Different;
+    delete[] Compared;
+    delete[] Correlation;
+
+    if (fclose(Out) != 0) {
+        MessageBox(hDlg, L"Could not write text output file", L"File I/O", MB_OK);
+        return APPERR_FILEWRITE;
+    }
+
+    return APP_SUCCESS;
+}
+
+//******************************************************************************
+//
+// ExtractBits
+// 
+// Extract specifed bits from binary packed bitstream file
+// to a text file
+//
+// Parameters:
+//  HWND hDlg           Handle of calling window or dialog
+//  WCHAR* InputFile    Packed Binary Btstream input file
+//  CHAR* OutputFile    Name of text file to output
+//  int SkipSize        Numberof bits to skip from beginning
+//  int CopyBits        Number of bits to copy
+//  int xsize           Number of bit to report on a line
+//                      (if 0 then all bits are on one line)
+// 
+//******************************************************************************
+void ExtractBits(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
+    int SkipSize, int CopyBits, int xsize, int Invert, int BitOrder)
+{
+    FILE* Out;
+    BitReader Reader;
+    TEXTBUFFER* Text;
+    int CurrentCopyBits = 0;
+    int iRes;
+    errno_t ErrNum;
+
+    if (SkipSize<0) {
+        MessageBox(hDlg, L"# of bits to skip < 0", L"Parameter error", MB_OK);
+        return;
+    }
+
+    if (CopyBits <= 0) {
+        MessageBox(hDlg, L"# of bits to copy <= 0", L"Parameter error", MB_OK);
+        return;
+    }
+
+    iRes = Reader.Open(InputFile, BitOrder);
+    if (iRes != APP_SUCCESS) {
         MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
         return;
     }
@@ -872,106 +1306,48 @@ void ExtractBits(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
     // this is a text file
     ErrNum = _wfopen_s(&Out, OutputFile, L"w");
     if (Out==NULL) {
-        fclose(In);
         MessageBox(hDlg, L"Could not open text output file", L"File I/O", MB_OK);
         return;
     }
 
-    while (!feof(In)) {
-        char CurrentByte;
+    Text = OpenTextBuffer(Out);
+    if (Text == NULL) {
+        fclose(Out);
+        MessageBox(hDlg, L"Text buffer allocation failure", L"Memory", MB_OK);
+        return;
+    }
+
+    // Skip bits at the beginning of the message 
+    Reader.Skip(SkipSize);
+
+    // Copy the specified number of bits
+    // in the order of the bit transmission message
+    while (CurrentCopyBits < CopyBits && Reader.BitsLeft() > 0) {
         int BitValue;
-        size_t NumRead;
-        CurrentByteBit = 0;
 
-        NumRead = fread(&CurrentByte, 1, 1, In);
-        if (NumRead != 1) {
-            break;
+        BitValue = Reader.GetBit();
+        if (Invert) {
+            BitValue = BitValue ^ 1;
         }
-        // process input file bit by bit
-        // while extracting use selected bit order in byte, LSB to MSB or MSB to LSB
-        // variable Endian is really referring to bit order in byte not byte order in multiple byte sequence
-        while (CurrentByteBit < 8) {
-            // process data bit by bit in the order of the bit transmission message
-            // input file is byte oriented MSB to LSB representing the bit order that the message was received
-            // This does not imply any bit ordering in the message itself.
-            if (BitOrder == 0) {
-                BitValue = CurrentByte & (0x80 >> CurrentByteBit);
-            }
-            else {
-                BitValue = CurrentByte & (0x01 << CurrentByteBit);
-            }
-            if (Invert) {
-                if (BitValue == 0) {
-                    BitValue = 1;
-                }
-                else {
-                    BitValue = 0;
-                }
-            }
-            
-            // Skip bits at the beginning of the message 
-            if (CurrentBit< SkipSize) {
-                    CurrentByteBit++;
-                    CurrentBit++;
-                    continue;
-            }
-            if (CurrentCopyBits < CopyBits) {
-                // save bit
-                if (xsize == 0) {
-                    if (CurrentCopyBits == 0) {
-                        if (!BitValue) {
-                            fprintf(Out, "0");
-                        }
-                        else {
-                            fprintf(Out, "1");
-                        }
-                    } else {
-                        if (!BitValue) {
-                            fprintf(Out, ",0");
-                        }
-                        else {
-                            fprintf(Out, ",1");
-                        }
-                    }
-                } else {
-                    if (CurrentCopyBits % xsize == (xsize - 1)) {
-                        if (!BitValue) {
-                            fprintf(Out, "0\n");
-                        }
-                        else {
-                            fprintf(Out, "1\n");
-                        }
-                    }
-                    else {
-                        if (!BitValue) {
-                            fprintf(Out, "0,");
-                        }
-                        else {
-                            fprintf(Out, "1,");
-                        }
-                    }
-                }
-            } else {
-                // finshed succesfully
-                fclose(In);
-                fclose(Out);
-                return;
+        // save bit
+        if (xsize == 0) {
+            if (CurrentCopyBits != 0) {
+                PutText(Text, ",");
             }
-            // Copy the specified number of bits
-            CurrentCopyBits++;
-            CurrentByteBit++;
-            CurrentBit++;
+            PutText(Text, BitValue ? "1" : "0");
+        } else {
+            PutText(Text, BitValue ? "1" : "0");
+            PutText(Text, (CurrentCopyBits % xsize == (xsize - 1)) ? "\n" : ",");
         }
+        CurrentCopyBits++;
     }
+    CloseTextBuffer(Text);
+    fclose(Out);
 
-    
     if (CurrentCopyBits != CopyBits) {
         MessageBox(hDlg, L"Warning: unexpected end of input file", L"File error", MB_OK);
     }
 
-    fclose(In);
-    fclose(Out);
-
     return;
 }
 
@@ -997,334 +1373,532 @@ void ExtractBits(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
 //  int BitDepth            # of bits converted per pixel
 //  int BitOrder            0 - LSB to MSB, 1 - MSB to LSB
 //  int BitScale            Scale binary output, 0,1 -> 0,255
+//  int Invert              1 - invert the input bits
+//  int InputBitOrder       1 - swap byte bit order for input file
+//  int DeferBMP            if DisplayResults is set, 0 - create the BMP file of each x size
+//                          as it is done, 1 - create the BMP files after all the x sizes are done
 // 
 //  The Ysize of the image is calculated as Ysize = NumBlockBodyBits/(xsize*bitdepth)
 //
+//  The bitstream is decoded once, the pixels of a block are the same for all
+//  x sizes.  Each output image uses the first Xsize*Ysize pixels of each block.
+//  The image files for the x sizes are written in parallel.
+//
 //******************************************************************************
 void BatchBitStream2Image(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
     int PrologueSize, int BlockHeaderBits, int NumBlockBodyBits, int BlockNum, int xsize, int xsizeEnd, 
-    int BitDepth, int BitOrder, int BitScale, int Invert, int InputBitOrder)
+    int BitDepth, int BitOrder, int BitScale, int Invert, int InputBitOrder, int DeferBMP)
 {
-    for (int CurrentXsize = xsize; CurrentXsize <= xsizeEnd; CurrentXsize++) {
-        // for Batch processing, cutup filename, reassemble with index number (Kernel)
-        int err;
-        WCHAR Drive[_MAX_DRIVE];
-        WCHAR Dir[_MAX_DIR];
-        WCHAR Fname[_MAX_FNAME];
-        WCHAR Ext[_MAX_EXT];
-
-        // split apart original filename
-        err = _wsplitpath_s(OutputFile, Drive, _MAX_DRIVE, Dir, _MAX_DIR, Fname,
-            _MAX_FNAME, Ext, _MAX_EXT);
-        if (err != 0) {
-            MessageBox(hDlg, L"Could not creat output filename", L"Batch File I/O", MB_OK);
-            return;
-        }
-        // change the fname portion to add _kernel# 1 based
-        // use Kernel+1
-        WCHAR NewFname[_MAX_FNAME];
-        WCHAR NewFilename[MAX_PATH];
-        WCHAR BMPfilename[MAX_PATH];
+    std::vector<int> Xsizes;
 
-        swprintf_s(NewFname, _MAX_FNAME, L"%s_%d", Fname, CurrentXsize);
-
-        // reassemble filename
-        err = _wmakepath_s(NewFilename, _MAX_PATH, Drive, Dir, NewFname, Ext);
-        if (err != 0) {
-            MessageBox(hDlg, L"Could not creat output filename", L"Batch File I/O", MB_OK);
-            return;
-        }
-        // create BMP of file
-        if (DisplayResults) {
-            err = _wmakepath_s(BMPfilename, _MAX_PATH, Drive, Dir, NewFname, L".bmp");
-            if (err != 0) {
-                MessageBox(hDlg, L"Could not creat output filename", L"Batch File I/O", MB_OK);
-                return;
-            }
-        }
+    if (xsize <= 0) {
+        MessageBox(hDlg, L"x size must be >= 1", L"File I/O", MB_OK);
+        return;
+    }
 
-        // add CurrentXsize index to filename portion
-        // reconstruct full filename
-        
-        err= BitStream2Image(hDlg, InputFile, NewFilename,
-            PrologueSize, BlockHeaderBits, NumBlockBodyBits, BlockNum, CurrentXsize,
-            BitDepth, BitOrder, BitScale, Invert, InputBitOrder);
-        if (err != 1) {
-            TCHAR pszMessageBuf[MAX_PATH];
-            StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH,
-                TEXT("Error occurred while processing batch# %d\nEror# %d\n"),
-                CurrentXsize, err);
-            MessageBox(hDlg, pszMessageBuf, L"Batch process Bit stream to image file", MB_OK);
-            return;
-        }
-        if (DisplayResults) {
-            SaveBMP(BMPfilename, NewFilename, FALSE, AutoScaleResults);
-        }
+    for (int CurrentXsize = xsize; CurrentXsize <= xsizeEnd; CurrentXsize++) {
+        Xsizes.push_back(CurrentXsize);
     }
 
+    BatchBitStream2Image(hDlg, InputFile, OutputFile, PrologueSize, BlockHeaderBits, NumBlockBodyBits,
+        BlockNum, Xsizes, BitDepth, BitOrder, BitScale, Invert, InputBitOrder, DeferBMP);
     return;
 }
 
 //******************************************************************************
 //
-// BitStream2Image
+// BatchBitStream2Image
 // 
-// Convert packed binary bitstream file to image file
+// BatchBitStream2Image for a list of x sizes instead of a range, for example
+// the factor pairs of the bitstream length from BitStreamFactorSizes().
+// The index number added to each filename is the x size.
 // 
 // Parameters:
-//  HWND hDlg               Handle of calling window or dialog
-//  WCHAR* InputFile        Packed Binary Btstream input file
-//  CHAR* OutputFile        Name of text file to output
-//  int PrologueSize        # of bits to skip in prologue
-//  int BlockHeaderBits     # of block header bits to skip
-//  int NumBlockBodyBits    # of bits in block (each block is converted to a frame
-//                          in the output image file) 
-//  int BlockNum            # of block in bitstream (becomes # of frames
-//                          in the output image file
-//  int xsize               # of pixels in a row
-//  int BitDepth            # of bits converted per pixel
-//  int BitOrder            0 - LSB to MSB, 1 - MSB to LSB
-//  int BitScale            Scale binary output, 0,1 -> 0,255
-// 
-//  The Ysize of the image is calculated as Ysize = NumBlockBodyBits/(xsize*bitdepth)
+//  const std::vector<int>& Xsizes  x sizes of the batch, replaces xsize, xsizeEnd
+//  the other parameters are the same as above
 //
 //******************************************************************************
-int BitStream2Image(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
-    int PrologueSize, int BlockHeaderBits, int NumBlockBodyBits, int BlockNum, int xsize,
-    int BitDepth, int BitOrder, int BitScale, int Invert, int InputBitOrder)
+void BatchBitStream2Image(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
+    int PrologueSize, int BlockHeaderBits, int NumBlockBodyBits, int BlockNum, const std::vector<int>& Xsizes,
+    int BitDepth, int BitOrder, int BitScale, int Invert, int InputBitOrder, int DeferBMP)
 {
-    FILE* In;
-    FILE* OutRaw;
-    int CurrentBit=0;
-    int CurrentPrologueBit=0;
-    int CurrentByteBit;
-    int CurrentPage=0;
-    int CurrentHeaderBit=0;
-    int CurrentPageBit=0;
-    int CurrentPageCol=0;
-    int CurentX=0;
-    int CurrentY=0;
-    int CurrentPixelBit;
-    errno_t ErrNum;
-    union PIXEL {
-        unsigned char bit8;
-        unsigned short bit16;
-        long bit32;
-    } Pixel;
+    BitReader Reader;
+    PoolBuffer<BYTE> Pixels;
+    PoolBuffer<size_t> BlockPixels;
+    size_t PixelsPerBlock;
+    ULONGLONG BlockStride;
+    int NumFileBlocks;
+    int PixelSize;
+    int NumWidths;
+    int NumWorkers;
+    int WorkersDone = 0;
+    int Error = APP_SUCCESS;
+    int ErrorXsize = 0;
+    int iRes;
+    std::mutex Lock;
+    std::atomic<int> NextWidth(0);
+    std::atomic<int> Completed(0);
+    std::vector<std::thread> Workers;
 
-    if (xsize <= 0) {
+    if (!Xsizes.empty() && *std::min_element(Xsizes.begin(), Xsizes.end()) <= 0) {
         MessageBox(hDlg, L"x size must be >= 1", L"File I/O", MB_OK);
-        return APPERR_PARAMETER;
+        return;
     }
 
     if (NumBlockBodyBits <= 0) {
         MessageBox(hDlg, L"# bits in block >= 1", L"File I/O", MB_OK);
-        return APPERR_PARAMETER;
+        return;
     }
 
     if (BitDepth <= 0 || BitDepth > 32) {
         MessageBox(hDlg, L"1 <= Image bit depth <= 32", L"File I/O", MB_OK);
-        return APPERR_PARAMETER;
+        return;
     }
 
     if (BitDepth != 1 && BitScale) {
         MessageBox(hDlg, L"Scale Binary can only be used if Image bit depth is 1", L"File I/O", MB_OK);
-        return APPERR_PARAMETER;
+        return;
     }
 
-    ErrNum = _wfopen_s(&In, InputFile, L"rb");
-    if (In==NULL) {
-        MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
-        return APPERR_FILEOPEN;
+    if (Xsizes.empty()) {
+        return;
     }
-
-    ErrNum = _wfopen_s(&OutRaw, OutputFile, L"wb");
-    if (OutRaw==NULL) {
-        fclose(In);
-        MessageBox(hDlg, L"Could not open raw output file", L"File I/O", MB_OK);
-        return APPERR_FILEOPEN;
+    if (BlockNum < 0) {
+        BlockNum = 0;
     }
 
-    // Initialize image file header
-    IMAGINGHEADER ImgHeader;
+    iRes = Reader.Open(InputFile, InputBitOrder);
+    if (iRes != APP_SUCCESS) {
+        MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
+        return;
+    }
 
-    ImgHeader.Endian = (short)-1;  // PC format
-    ImgHeader.HeaderSize = (short) sizeof(IMAGINGHEADER);
-    ImgHeader.ID = (short)0xaaaa;
-    ImgHeader.Version = (short)1;
-    ImgHeader.NumFrames = (short)BlockNum;
     if (BitDepth <= 8) {
-        ImgHeader.PixelSize = (short)1;
+        PixelSize = 1;
     } else if (BitDepth <= 16) {
-        ImgHeader.PixelSize = (short)2;
+        PixelSize = 2;
     } else {
-        ImgHeader.PixelSize = (short)4;
+        PixelSize = 4;
     }
-    ImgHeader.Xsize = xsize;
-    ImgHeader.Ysize = (NumBlockBodyBits / (xsize* BitDepth));
-    ImgHeader.Padding[0] = 0;
-    ImgHeader.Padding[1] = 0;
-    ImgHeader.Padding[2] = 0;
-    ImgHeader.Padding[3] = 0;
-    ImgHeader.Padding[4] = 0;
-    ImgHeader.Padding[5] = 0;
 
-    // write header to file
-    fwrite(&ImgHeader, sizeof(IMAGINGHEADER),1, OutRaw);
+    // The pixel sequence of a block does not depend on the x size, only the
+    // image header and the number of pixels used from each block change.
+    // Decode all the blocks once, in the output file pixel format.
+    // only the blocks that start in the file have pixels
+    if (PrologueSize < 0) {
+        PrologueSize = 0;
+    }
+    if (BlockHeaderBits < 0) {
+        BlockHeaderBits = 0;
+    }
+    BlockStride = (ULONGLONG)BlockHeaderBits + (ULONGLONG)NumBlockBodyBits;
+    NumFileBlocks = 0;
+    if (Reader.GetTotalBits() > (ULONGLONG)PrologueSize) {
+        ULONGLONG FileBlocks = (Reader.GetTotalBits() - PrologueSize + BlockStride - 1) / BlockStride;
+        NumFileBlocks = FileBlocks < (ULONGLONG)BlockNum ? (int)FileBlocks : BlockNum;
+    }
 
-    CurrentPixelBit = BitDepth - 1;
-    Pixel.bit32 = 0;
+    // the decoded pixels are borrowed from the buffer pool (BufferPool.cpp)
+    // and returned when this function returns
+    PixelsPerBlock = (size_t)(NumBlockBodyBits / BitDepth);
+    if (Pixels.Allocate((size_t)NumFileBlocks * PixelsPerBlock * (size_t)PixelSize + 1) == NULL) {
+        MessageBox(hDlg, L"Bitstream memory allocation failure", L"Memory", MB_OK);
+        return;
+    }
+    if (BlockPixels.Allocate((size_t)NumFileBlocks + 1) == NULL) {
+        MessageBox(hDlg, L"Bitstream memory allocation failure", L"Memory", MB_OK);
+        return;
+    }
 
-    while (!feof(In)) {
-        char CurrentByte;
-        int BitValue;
-        size_t NumRead;
-        CurrentByteBit = 0;
+    ParallelFor(0, NumFileBlocks, [&](int First, int Last) {
+        BitReader BlockReader;
+        PoolBuffer<int> Frame;
+        ULONGLONG BlockStart;
 
-        NumRead = fread(&CurrentByte, 1, 1, In);
-        if (NumRead <= 0) {
-            break;
+        if (Frame.Allocate(PixelsPerBlock + 1) == NULL) {
+            std::lock_guard<std::mutex> Guard(Lock);
+            Error = APPERR_MEMALLOC;
+            return;
         }
-
-        // process data bit by bit in the order of the bit transmission message
-        // input file is byte oriented MSB to LSB representing the bit order that the message was received
-        // This does not imply any bit ordering in the message itself.
-        while (CurrentByteBit < 8) {
-            // MSB to LSB in input data file 
-            if (InputBitOrder) {
-                BitValue = CurrentByte & (0x01 << CurrentByteBit);
-            }
-            else {
-                BitValue = CurrentByte & (0x80 >> CurrentByteBit);
-            }
-            if (Invert==1) {
-                if (BitValue == 0) {
-                    BitValue = 1;
-                }
-                else {
-                    BitValue = 0;
-                }
-            }
-            // Prologue block processing
-            // skip prologue, PrologueSize bits
-            if (PrologueSize > 0) {  // 0 based index
-                if (CurrentPrologueBit < PrologueSize) {
-                    CurrentByteBit++;
-                    CurrentPrologueBit++;
-                    CurrentBit++;
-                    continue;
-                }
-                else {
-                    if (CurrentPrologueBit == PrologueSize) {
-                        // mark so don't process in this block again
-                        CurrentPrologueBit++;
-                    }
-                }
+        BlockReader.OpenView(Reader.GetData(), Reader.GetDataSize(), InputBitOrder);
+        for (int Block = First; Block < Last; Block++) {
+            if (JobCancelled()) {
+                break;
             }
-            // end of prologque processing
-
-            // Page header block processing, one header per page
-            // skip page headers
-            if (BlockHeaderBits > 0) {
-                if (CurrentHeaderBit < BlockHeaderBits) {
-                    // process header bits
-                    CurrentByteBit++;
-                    CurrentHeaderBit++;
-                    CurrentBit++;
-                    continue;
+            // same block layout as BitStream2Image()
+            BlockStart = (ULONGLONG)PrologueSize + (ULONGLONG)Block * BlockStride + (ULONGLONG)BlockHeaderBits;
+            BlockReader.Seek(BlockStart);
+            BlockPixels[Block] = DecodeBitStreamPixels(&BlockReader, Frame, PixelsPerBlock,
+                BitDepth, BitOrder, BitScale, Invert);
+            NarrowPixels(Pixels + (size_t)Block * PixelsPerBlock * (size_t)PixelSize, Frame,
+                BlockPixels[Block], PixelSize, -1);
+        }
+    });
+    Reader.Close();
+    if (Error != APP_SUCCESS) {
+        MessageBox(hDlg, L"Bitstream memory allocation failure", L"Memory", MB_OK);
+        return;
+    }
+    if (JobCancelled()) {
+        return;
+    }
+
+    // write the image files for the x sizes in parallel
+    NumWidths = (int)Xsizes.size();
+    NumWorkers = GetWorkerCount();
+    if (NumWorkers > NumWidths) {
+        NumWorkers = NumWidths;
+    }
+
+    // the .png files of the BMP files made by this batch
+    PngBatch PngFiles;
+
+    auto Worker = [&]() {
+        WCHAR NewFilename[MAX_PATH];
+        WCHAR BMPfilename[MAX_PATH];
+        IMAGINGHEADER ImgHeader;
+        ImageFileWriter OutRaw;
+        size_t FramePixels;
+        size_t NumPixels;
+        int CurrentXsize;
+        int Width;
+        int Result;
+
+        for (;;) {
+            Width = NextWidth++;
+            if (Width >= NumWidths) {
+                break;
+            }
+            CurrentXsize = Xsizes[Width];
+            {
+                std::lock_guard<std::mutex> Guard(Lock);
+                if (Error == APP_SUCCESS && JobCancelled()) {
+                    Error = APPERR_CANCELLED;
+                }
+                if (Error != APP_SUCCESS) {
+                    break;
                 }
             }
-            // end of page header block processing
-
-            // these bits belong in page/tile/image
-
-            if (CurrentPageBit < NumBlockBodyBits) {
-                // this assumes that there could be 1 to 16 bits per pixel in the resulting image
-                if (BitValue) {
-                    // add to image byte if if bit depth is <=8, add to image int16 is bit depth >8
-                    // right now don't worry about pixel bit depth > 16
-                    // PixelByte, Pixel are a union.
-
-                    // data is always stored in resulting image MSB to LSB in byte/short
-                    // since Pixel value starts as 0 only need to set bits not clear them
-                    // Decode using Endian flag for LSB-MSB or MSB-LSB order
-                    if (BitDepth <= 8) {
-                        if (BitOrder) {
-                            // bit stream order is MSB to LSB
-                            Pixel.bit8 = Pixel.bit8 | (1 << CurrentPixelBit);
-                        }
-                        else {
-                            // bit stream order is LSB to MSB
-                            Pixel.bit8 = Pixel.bit8 | (1 << ((BitDepth - 1) - CurrentPixelBit));
-                        }
-                    }
-                    else if (BitDepth <= 16) {
-                        if (BitOrder) {
-                            // bit stream order is MSB to LSB
-                            Pixel.bit16 = Pixel.bit16 | (1 << CurrentPixelBit);
-                        }
-                        else {
-                            // bit stream order is LSB to MSB
-                            Pixel.bit16 = Pixel.bit16 | (1 << ((BitDepth - 1) - CurrentPixelBit));
-                        }
-                    }
-                    else {
-                        if (BitOrder) {
-                            // bit stream order is MSB to LSB
-                            Pixel.bit32 = Pixel.bit32 | (1 << CurrentPixelBit);
-                        }
-                        else {
-                            // bit stream order is LSB to MSB
-                            Pixel.bit32 = Pixel.bit32 | (1 << ((BitDepth - 1) - CurrentPixelBit));
-                        }
-                    }
+
+            Result = NumberedFilename(NewFilename, OutputFile, CurrentXsize, NULL);
+
+            if (Result == APP_SUCCESS) {
+                ImgHeader.Endian = (short)-1;  // PC format
+                ImgHeader.HeaderSize = (short)sizeof(IMAGINGHEADER);
+                ImgHeader.ID = (short)0xaaaa;
+                ImgHeader.Version = (short)1;
+                ImgHeader.NumFrames = (short)BlockNum;
+                ImgHeader.PixelSize = (short)PixelSize;
+                ImgHeader.Xsize = CurrentXsize;
+                ImgHeader.Ysize = (NumBlockBodyBits / (CurrentXsize * BitDepth));
+                for (int i = 0; i < 6; i++) {
+                    ImgHeader.Padding[i] = 0;
                 }
-                CurrentPixelBit--;
-                if (CurrentPixelBit < 0) {
-                    if (BitDepth <= 8) {
-                        if (BitScale && Pixel.bit8 && (BitDepth == 1)) {
-                            Pixel.bit8 = 255;
+                FramePixels = (size_t)ImgHeader.Xsize * (size_t)ImgHeader.Ysize;
+
+                Result = OutRaw.Open(NewFilename, &ImgHeader);
+                if (Result == APP_SUCCESS) {
+                    // each frame is the first Xsize*Ysize pixels of its block
+                    for (int Block = 0; Block < NumFileBlocks && Result == APP_SUCCESS; Block++) {
+                        NumPixels = BlockPixels[Block] < FramePixels ? BlockPixels[Block] : FramePixels;
+                        if (NumPixels == 0) {
+                            continue;
                         }
-                        fwrite(&Pixel.bit8, 1, 1, OutRaw);
+                        Result = OutRaw.WriteFilePixels(Pixels + (size_t)Block * PixelsPerBlock * (size_t)PixelSize,
+                            NumPixels);
                     }
-                    else if (BitDepth <= 16) {
-                        fwrite(&Pixel.bit16, 2, 1, OutRaw);
+                    if (OutRaw.Close() != APP_SUCCESS && Result == APP_SUCCESS) {
+                        Result = APPERR_FILEWRITE;
                     }
-                    else {
-                        fwrite(&Pixel.bit32, 4, 1, OutRaw);
+                }
+            }
 
-                    }
-                    Pixel.bit16 = 0;
-                    CurrentPixelBit = BitDepth - 1;
+            if (Result == APP_SUCCESS && DisplayResults && !DeferBMP) {
+                Result = NumberedFilename(BMPfilename, OutputFile, CurrentXsize, L".bmp");
+                if (Result == APP_SUCCESS) {
+                    SaveBMP(BMPfilename, NewFilename, FALSE, AutoScaleResults, &PngFiles);
                 }
-                CurrentPageCol++;
-                if (CurrentPageCol >= xsize) {
-                    CurrentPageCol = 0;
+            }
+
+            if (Result != APP_SUCCESS) {
+                std::lock_guard<std::mutex> Guard(Lock);
+                if (Error == APP_SUCCESS) {
+                    Error = Result;
+                    ErrorXsize = CurrentXsize;
                 }
-                CurrentByteBit++;
-                CurrentPageBit++;
-                CurrentBit++;
-                continue;
+                break;
             }
-            else {
-                // start on next page
-                CurrentHeaderBit = 0;
-                CurrentPageBit = 0;
-                CurrentPixelBit = BitDepth - 1;
-                CurrentPage++;
-                if (CurrentPage==BlockNum) {
-                    fclose(In);
-                    fclose(OutRaw);
-                    if (DisplayResults) {
-                        DisplayImage(OutputFile);
-                    }
-                    return APP_SUCCESS;
+            Completed++;
+        }
+
+        std::lock_guard<std::mutex> Guard(Lock);
+        WorkersDone++;
+    };
+
+    for (int i = 0; i < NumWorkers; i++) {
+        try {
+            Workers.emplace_back(Worker);
+        }
+        catch (...) {
+            break;
+        }
+    }
+    NumWorkers = (int)Workers.size();
+    if (NumWorkers == 0) {
+        // no threads available, do it on this thread
+        Worker();
+        NumWorkers = 1;
+    }
+
+    // show progress while waiting
+    {
+        WCHAR Caption[MAX_PATH];
+        WCHAR Progress[MAX_PATH];
+        int Shown = -1;
+        int Done;
+
+        GetWindowText(hDlg, Caption, MAX_PATH);
+        EnableWindow(hDlg, FALSE);
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> Guard(Lock);
+                Done = WorkersDone;
+            }
+            if (Done == NumWorkers) {
+                break;
+            }
+            if (Completed != Shown) {
+                Shown = Completed;
+                swprintf_s(Progress, MAX_PATH, L"Converting, x size %d of %d completed", Shown, NumWidths);
+                SetWindowText(hDlg, Progress);
+                JobProgress(Shown, NumWidths);
+            }
+            WaitProcessingMessages(100);
+        }
+
+        for (auto& Thread : Workers) {
+            Thread.join();
+        }
+
+        // BMP files are created after all the image files are done
+        if (Error == APP_SUCCESS && DisplayResults && DeferBMP) {
+            WCHAR NewFilename[MAX_PATH];
+            WCHAR BMPfilename[MAX_PATH];
+
+            for (int Width = 0; Width < NumWidths; Width++) {
+                int CurrentXsize = Xsizes[Width];
+
+                swprintf_s(Progress, MAX_PATH, L"Saving BMP, x size %d of %d", Width + 1, NumWidths);
+                SetWindowText(hDlg, Progress);
+                JobProgress(Width, NumWidths);
+                if (JobCancelled()) {
+                    Error = APPERR_CANCELLED;
+                    break;
+                }
+                if (NumberedFilename(NewFilename, OutputFile, CurrentXsize, NULL) != APP_SUCCESS ||
+                    NumberedFilename(BMPfilename, OutputFile, CurrentXsize, L".bmp") != APP_SUCCESS) {
+                    Error = APPERR_PARAMETER;
+                    ErrorXsize = CurrentXsize;
+                    break;
                 }
+                SaveBMP(BMPfilename, NewFilename, FALSE, AutoScaleResults, &PngFiles);
+                WaitProcessingMessages(0);
             }
         }
+        SetWindowText(hDlg, Caption);
+        EnableWindow(hDlg, TRUE);
+    }
+
+    BlockPixels.Free();
+    Pixels.Free();
+
+    // the .png files of the BMP files are written by the PNG encode queue
+    int PngError = WaitAutoPNG(hDlg, &PngFiles);
+
+    if (Error == APPERR_CANCELLED) {
+        return;
+    }
+    if (Error != APP_SUCCESS) {
+        TCHAR pszMessageBuf[MAX_PATH];
+        StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH,
+            TEXT("Error occurred while processing batch# %d\nEror# %d\n"),
+            ErrorXsize, Error);
+        MessageBox(hDlg, pszMessageBuf, L"Batch process Bit stream to image file", MB_OK);
+        return;
+    }
+    if (PngError != APP_SUCCESS) {
+        return;
+    }
+
+    // show the last image of the batch
+    if (DisplayResults) {
+        WCHAR NewFilename[MAX_PATH];
+
+        if (NumberedFilename(NewFilename, OutputFile, Xsizes.back(), NULL) == APP_SUCCESS) {
+            DisplayImage(NewFilename);
+        }
+    }
+
+    return;
+}
+
+//******************************************************************************
+//
+// BitStream2Image
+// 
+// Convert packed binary bitstream file to image file
+// 
+// Parameters:
+//  HWND hDlg               Handle of calling window or dialog
+//  WCHAR* InputFile        Packed Binary Btstream input file
+//  CHAR* OutputFile        Name of text file to output
+//  int PrologueSize        # of bits to skip in prologue
+//  int BlockHeaderBits     # of block header bits to skip
+//  int NumBlockBodyBits    # of bits in block (each block is converted to a frame
+//                          in the output image file) 
+//  int BlockNum            # of block in bitstream (becomes # of frames
+//                          in the output image file
+//  int xsize               # of pixels in a row
+//  int BitDepth            # of bits converted per pixel
+//  int BitOrder            0 - LSB to MSB, 1 - MSB to LSB
+//  int BitScale            Scale binary output, 0,1 -> 0,255
+// 
+//  The Ysize of the image is calculated as Ysize = NumBlockBodyBits/(xsize*bitdepth)
+//
+//******************************************************************************
+int BitStream2Image(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
+    int PrologueSize, int BlockHeaderBits, int NumBlockBodyBits, int BlockNum, int xsize,
+    int BitDepth, int BitOrder, int BitScale, int Invert, int InputBitOrder)
+{
+    int Params[] = { PrologueSize, BlockHeaderBits, NumBlockBodyBits, BlockNum, xsize,
+        BitDepth, BitOrder, BitScale, Invert, InputBitOrder };
+
+    return CachedFileResult(L"BitStream2Image", InputFile, OutputFile,
+        Params, sizeof(Params) / sizeof(int), [&]() -> int {
+        return DecodeBitStreamImage(hDlg, InputFile, OutputFile,
+            PrologueSize, BlockHeaderBits, NumBlockBodyBits, BlockNum, xsize,
+            BitDepth, BitOrder, BitScale, Invert, InputBitOrder);
+    });
+}
+
+//******************************************************************************
+//
+// DecodeBitStreamImage
+// 
+// BitStream2Image() without the result cache, see BitStream2Image() for a
+// description of the parameters
+//
+//******************************************************************************
+static int DecodeBitStreamImage(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
+    int PrologueSize, int BlockHeaderBits, int NumBlockBodyBits, int BlockNum, int xsize,
+    int BitDepth, int BitOrder, int BitScale, int Invert, int InputBitOrder)
+{
+    ImageFileWriter OutRaw;
+    BitReader Reader;
+    PoolBuffer<int> Frame;
+    size_t FramePixels;
+    size_t NumPixels;
+    ULONGLONG BodyStart;
+    int CurrentPage;
+    int iRes;
+
+    if (xsize <= 0) {
+        MessageBox(hDlg, L"x size must be >= 1", L"File I/O", MB_OK);
+        return APPERR_PARAMETER;
+    }
+
+    if (NumBlockBodyBits <= 0) {
+        MessageBox(hDlg, L"# bits in block >= 1", L"File I/O", MB_OK);
+        return APPERR_PARAMETER;
+    }
+
+    if (BitDepth <= 0 || BitDepth > 32) {
+        MessageBox(hDlg, L"1 <= Image bit depth <= 32", L"File I/O", MB_OK);
+        return APPERR_PARAMETER;
+    }
+
+    if (BitDepth != 1 && BitScale) {
+        MessageBox(hDlg, L"Scale Binary can only be used if Image bit depth is 1", L"File I/O", MB_OK);
+        return APPERR_PARAMETER;
+    }
+
+    iRes = Reader.Open(InputFile, InputBitOrder);
+    if (iRes != APP_SUCCESS) {
+        MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
+        return iRes;
+    }
+
+    // Initialize image file header
+    IMAGINGHEADER ImgHeader;
+
+    ImgHeader.Endian = (short)-1;  // PC format
+    ImgHeader.HeaderSize = (short) sizeof(IMAGINGHEADER);
+    ImgHeader.ID = (short)0xaaaa;
+    ImgHeader.Version = (short)1;
+    ImgHeader.NumFrames = (short)BlockNum;
+    if (BitDepth <= 8) {
+        ImgHeader.PixelSize = (short)1;
+    } else if (BitDepth <= 16) {
+        ImgHeader.PixelSize = (short)2;
+    } else {
+        ImgHeader.PixelSize = (short)4;
+    }
+    ImgHeader.Xsize = xsize;
+    ImgHeader.Ysize = (NumBlockBodyBits / (xsize* BitDepth));
+    ImgHeader.Padding[0] = 0;
+    ImgHeader.Padding[1] = 0;
+    ImgHeader.Padding[2] = 0;
+    ImgHeader.Padding[3] = 0;
+    ImgHeader.Padding[4] = 0;
+    ImgHeader.Padding[5] = 0;
+
+    // write header to file
+    iRes = OutRaw.Open(OutputFile, &ImgHeader);
+    if (iRes != APP_SUCCESS) {
+        MessageBox(hDlg, L"Could not open raw output file", L"File I/O", MB_OK);
+        return iRes;
+    }
+
+    // each block body becomes a frame of Xsize*Ysize pixels
+    FramePixels = (size_t)ImgHeader.Xsize * (size_t)ImgHeader.Ysize;
+    if (Frame.Allocate(FramePixels + 1) == NULL) {
+        OutRaw.Close();
+        MessageBox(hDlg, L"Frame memory allocation failure", L"Memory", MB_OK);
+        return APPERR_MEMALLOC;
+    }
+
+    // skip prologue, PrologueSize bits
+    if (PrologueSize > 0) {
+        Reader.Skip(PrologueSize);
+    }
+
+    for (CurrentPage = 0; CurrentPage < BlockNum && Reader.BitsLeft() > 0; CurrentPage++) {
+        // skip page header, one header per page
+        if (BlockHeaderBits > 0) {
+            Reader.Skip(BlockHeaderBits);
+        }
+        BodyStart = Reader.GetPosition();
+
+        // these bits belong in page/tile/image
+        NumPixels = DecodeBitStreamPixels(&Reader, Frame, FramePixels, BitDepth,
+            BitOrder, BitScale, Invert);
+        iRes = OutRaw.WritePixels(Frame, NumPixels);
+        if (iRes != APP_SUCCESS) {
+            OutRaw.Close();
+            MessageBox(hDlg, L"Could not write raw output file", L"File I/O", MB_OK);
+            return iRes;
+        }
+
+        // bits left in the block body after the last complete row are not used
+        Reader.Seek(BodyStart + (ULONGLONG)NumBlockBodyBits);
+    }
+
+    Frame.Free();
+    iRes = OutRaw.Close();
+    if (iRes != APP_SUCCESS) {
+        MessageBox(hDlg, L"Could not write raw output file", L"File I/O", MB_OK);
+        return iRes;
     }
-    fclose(In);
-    fclose(OutRaw);
     
     if (DisplayResults) {
         DisplayImage(OutputFile);
@@ -1465,12 +2039,12 @@ int ExtractSPP(HWND hDlg, WCHAR* InputFile, WCHAR* APIDoutputFile, WCHAR* Output
     FILE* Out = NULL;
     FILE* OutAPID = NULL;
     int iRes;
-    int NumPackets = 0;
-    int NumIdlePackets = 0;
-    int NumTMpackets = 0;
-    int NumTCpackets = 0;
-    int NumAPIDmatches = 0;
-    int TotalBytes = 0;
+    long long NumPackets = 0;
+    long long NumIdlePackets = 0;
+    long long NumTMpackets = 0;
+    long long NumTCpackets = 0;
+    long long NumAPIDmatches = 0;
+    long long TotalBytes = 0;
     errno_t ErrNum;
 
     // open input file
@@ -1523,9 +2097,11 @@ int ExtractSPP(HWND hDlg, WCHAR* InputFile, WCHAR* APIDoutputFile, WCHAR* Output
             // generate summary
             TCHAR pszMessageBuf[MAX_PATH];
             StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH,
-                TEXT("Processed:\n# of total packets: %d\n# idle packets: %d\n# of telemtry packets: %d\n# of telecommand packets: %d\n# matching APID packets: %d\nTotal bytes processeed: %d"),
+                TEXT("Processed:\n# of total packets: %lld\n# idle packets: %lld\n# of telemtry packets: %lld\n# of telecommand packets: %lld\n# matching APID packets: %lld\nTotal bytes processeed: %lld"),
                 NumPackets, NumIdlePackets,NumTMpackets, NumTCpackets, NumAPIDmatches, TotalBytes);
-            MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
+            if (hDlg != NULL) {
+                MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
+            }
             if (SaveSPP) {
                 fclose(Out);
             }
@@ -1546,7 +2122,7 @@ int ExtractSPP(HWND hDlg, WCHAR* InputFile, WCHAR* APIDoutputFile, WCHAR* Output
             MessageBox(hDlg, L"Invalid SPP encountered", L"File I/O", MB_OK);
             TCHAR pszMessageBuf[MAX_PATH];
             StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH,
-                TEXT("Processed:\n# of total packets: %d\n# idle packets: %d\n# of telemtry packets: %d\n# of telecommand packets: %d\n# matching APID packets: %d\nTotal bytes processeed: %d"),
+                TEXT("Processed:\n# of total packets: %lld\n# idle packets: %lld\n# of telemtry packets: %lld\n# of telecommand packets: %lld\n# matching APID packets: %lld\nTotal bytes processeed: %lld"),
                 NumPackets, NumIdlePackets, NumTMpackets, NumTCpackets, NumAPIDmatches, TotalBytes);
             MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
             if (SaveSPP) {
@@ -1579,7 +2155,7 @@ int ExtractSPP(HWND hDlg, WCHAR* InputFile, WCHAR* APIDoutputFile, WCHAR* Output
                 MessageBox(hDlg, L"Incomplete packet encountered\nEOF before end of packet", L"File I/O", MB_OK);
                 TCHAR pszMessageBuf[MAX_PATH];
                 StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH,
-                    TEXT("Processed:\n# of total packets: %d\n# idle packets: %d\n# of telemtry packets: %d\n# of telecommand packets: %d\n# matching APID packets: %d\nTotal bytes processeed: %d"),
+                    TEXT("Processed:\n# of total packets: %lld\n# idle packets: %lld\n# of telemtry packets: %lld\n# of telecommand packets: %lld\n# matching APID packets: %lld\nTotal bytes processeed: %lld"),
                     NumPackets, NumIdlePackets, NumTMpackets, NumTCpackets, NumAPIDmatches, TotalBytes);
                 MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
                 return APPERR_FILEREAD;
@@ -1587,7 +2163,7 @@ int ExtractSPP(HWND hDlg, WCHAR* InputFile, WCHAR* APIDoutputFile, WCHAR* Output
             continue;
         }
         if (SaveSPP) {
-            fprintf(Out, "%7d,   %1d,    %1d,      %1d, 0x%04x,      %1d,    %5d,   %5d", NumPackets,
+            fprintf(Out, "%7lld,   %1d,    %1d,      %1d, 0x%04x,      %1d,    %5d,   %5d", NumPackets,
                 PriHeader.PVN, PriHeader.Type, PriHeader.SecHeaderFlag, PriHeader.APID,
                 PriHeader.SeqFlag, PriHeader.SeqCount, PriHeader.DataLength);
         }
@@ -1605,7 +2181,7 @@ int ExtractSPP(HWND hDlg, WCHAR* InputFile, WCHAR* APIDoutputFile, WCHAR* Output
                 MessageBox(hDlg, L"bad format, file, too small", L"File I/O", MB_OK);
                 TCHAR pszMessageBuf[MAX_PATH];
                 StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH,
-                    TEXT("Processed:\n# of total packets: %d\n# idle packets: %d\n# of telemtry packets: %d\n# of telecommand packets: %d\n# matching APID packets: %d\nTotal bytes processeed: %d"),
+                    TEXT("Processed:\n# of total packets: %lld\n# idle packets: %lld\n# of telemtry packets: %lld\n# of telecommand packets: %lld\n# matching APID packets: %lld\nTotal bytes processeed: %lld"),
                     NumPackets, NumIdlePackets, NumTMpackets, NumTCpackets, NumAPIDmatches, TotalBytes);
                 MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
                 return APPERR_FILEREAD;
@@ -1618,7 +2194,7 @@ int ExtractSPP(HWND hDlg, WCHAR* InputFile, WCHAR* APIDoutputFile, WCHAR* Output
             fprintf(Out, ", ***\n"); // flag target APID SPP in summary file
         }
 
-        fprintf(OutAPID, "%7d,   %1d,    %1d,      %1d, 0x%04x,      %1d,    %5d,   %5d", NumPackets,
+        fprintf(OutAPID, "%7lld,   %1d,    %1d,      %1d, 0x%04x,      %1d,    %5d,   %5d", NumPackets,
             PriHeader.PVN, PriHeader.Type, PriHeader.SecHeaderFlag, PriHeader.APID,
             PriHeader.SeqFlag, PriHeader.SeqCount, PriHeader.DataLength);
 
@@ -1638,7 +2214,7 @@ int ExtractSPP(HWND hDlg, WCHAR* InputFile, WCHAR* APIDoutputFile, WCHAR* Output
                 MessageBox(hDlg, L"Memory allocation failure", L"Program error", MB_OK);
                 TCHAR pszMessageBuf[MAX_PATH];
                 StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH,
-                    TEXT("Processed:\n# of total packets: %d\n# idle packets: %d\n# of telemtry packets: %d\n# of telecommand packets: %d\n# matching APID packets: %d\nTotal bytes processeed: %d"),
+                    TEXT("Processed:\n# of total packets: %lld\n# idle packets: %lld\n# of telemtry packets: %lld\n# of telecommand packets: %lld\n# matching APID packets: %lld\nTotal bytes processeed: %lld"),
                     NumPackets, NumIdlePackets, NumTMpackets, NumTCpackets, NumAPIDmatches, TotalBytes);
                 MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
                 return APPERR_FILEREAD;
@@ -1655,7 +2231,7 @@ int ExtractSPP(HWND hDlg, WCHAR* InputFile, WCHAR* APIDoutputFile, WCHAR* Output
                 MessageBox(hDlg, L"Packet data field too short", L"File I/O", MB_OK);
                 TCHAR pszMessageBuf[MAX_PATH];
                 StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH,
-                    TEXT("Processed:\n# of total packets: %d\n# idle packets: %d\n# of telemtry packets: %d\n# of telecommand packets: %d\n# matching APID packets: %d\nTotal bytes processeed: %d"),
+                    TEXT("Processed:\n# of total packets: %lld\n# idle packets: %lld\n# of telemtry packets: %lld\n# of telecommand packets: %lld\n# matching APID packets: %lld\nTotal bytes processeed: %lld"),
                     NumPackets, NumIdlePackets, NumTMpackets, NumTCpackets, NumAPIDmatches, TotalBytes);
                 MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
                 return APPERR_FILEREAD;
@@ -1673,9 +2249,11 @@ int ExtractSPP(HWND hDlg, WCHAR* InputFile, WCHAR* APIDoutputFile, WCHAR* Output
 
     TCHAR pszMessageBuf[MAX_PATH];
     StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH,
-        TEXT("Processed:\n# of total packets: %d\n# idle packets: %d\n# of telemtry packets: %d\n# of telecommand packets: %d\n# matching APID packets: %d\nTotal bytes processeed: %d"),
+        TEXT("Processed:\n# of total packets: %lld\n# idle packets: %lld\n# of telemtry packets: %lld\n# of telecommand packets: %lld\n# matching APID packets: %lld\nTotal bytes processeed: %lld"),
         NumPackets, NumIdlePackets, NumTMpackets, NumTCpackets, NumAPIDmatches, TotalBytes);
-    MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
+    if (hDlg != NULL) {
+        MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
+    }
 
     if (SaveSPP) {
         fclose(Out);
@@ -1688,56 +2266,325 @@ int ExtractSPP(HWND hDlg, WCHAR* InputFile, WCHAR* APIDoutputFile, WCHAR* Output
 
 //*******************************************************************
 //
-//  DecodeSPP
+// DemuxSPP
 // 
-// Private function for ExtractSPP()
+// Demultiplex all the APIDs in a SPP binary stream in one pass.
+// The input file is memory mapped and read through once.  IDLE packets
+// are discarded.  Every other APID is routed to its own output file, the
+// APID is added to the output filename, name.ext -> name_APID.ext
+// The output files are:
+//      Binary - the complete packets (primary header and data field) as in
+//               the input file.  These are SPP binary streams that can be
+//               used as input to ExtractSPP() and DemuxSPP().
+//      Text   - the same csv format as the target APID file in ExtractSPP()
+//               decoded primary header and data field in HEX coded bytes
+//               with SecondaryHeaderSize bytes skipped.
+// 
+// The sequence count of each APID is tracked.  A break in the count is a
+// gap, the # of packets missing in the gaps and sequence counts repeated from
+// the previous packet are counted.  If SaveReport is enabled these statistics
+// are saved to ReportFile, one line for each APID.
+// 
+// Parameters:
+//  HWND hDlg               handle of calling window/dialog
+//  WCHAR* InputFile        Packed Binary bit stream file
+//  WCHAR* OutputFile       APID output filename, the APID is added to this name
+//  WCHAR* ReportFile       CSV file with the statistics for each APID
+//  int SkipBytes           Number of byte in input file to initially skip
+//  int SecondaryHeaderSize The number of bytes to skip (the secondary header)
+//                          at the start of the data field for text output
+//  int Strict              0 - only basic check for conforming to standards
+//                          1 - must comply with the packet primary header standards
+//  int BinaryOutput        0 - text APID files
+//                          1 - binary APID files
+//  int SaveReport          0 - do not save the APID statistics file
+//                          1 - save the APID statistics file
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
 //
 //*******************************************************************
-int DecodeSPP(SPP_PRIMARY_HEADER* PackedPriHeader, SPP_UNPACKED_PRIMARY_HEADER* PriHeader,
-            int Strict)
+int DemuxSPP(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, WCHAR* ReportFile,
+    int SkipBytes, int SecondaryHeaderSize, int Strict, int BinaryOutput, int SaveReport)
 {
-    PriHeader->PVN = (PackedPriHeader->ID & 0xe000) >> 13 ;
-
-    PriHeader->Type = (PackedPriHeader->ID & 0x1000) >>12;
-
-    PriHeader->SecHeaderFlag = (PackedPriHeader->ID & 0x0800) >> 11;
-
-    PriHeader->APID = PackedPriHeader->ID & 0x7ff;
-
-    PriHeader->SeqFlag = (PackedPriHeader->SEQ & 0xc000) >>14;
-
-    PriHeader->SeqCount = PackedPriHeader->SEQ & 0x3fff;
-
-    PriHeader->DataLength = PackedPriHeader->DataLength+1; // need to increment by 1 to be accurate
-
-    if (PriHeader->PVN != 0) {
-        return APPERR_PARAMETER;
+    static const char HexDigits[] = "0123456789abcdef";
+    BitReader Reader;
+    SPP_UNPACKED_PRIMARY_HEADER PriHeader;
+    SPP_PRIMARY_HEADER PackedPriHeader;
+    SPPSINK* Sinks;
+    SPPSINK* Sink;
+    const BYTE* Data;
+    const BYTE* Packet;
+    size_t DataSize;
+    size_t Position;
+    size_t PacketSize;
+    char* Line = NULL;
+    const WCHAR* ErrorMessage = NULL;
+    int iRes;
+    int Result = APP_SUCCESS;
+    int NumAPIDs = 0;
+    long long NumPackets = 0;
+    long long NumIdlePackets = 0;
+    long long NumTMpackets = 0;
+    long long NumTCpackets = 0;
+    long long TotalBytes = 0;
+
+    iRes = Reader.Open(InputFile, 0);
+    if (iRes != APP_SUCCESS) {
+        MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
+        return iRes;
+    }
+    Data = Reader.GetData();
+    DataSize = Reader.GetDataSize();
+    if (SkipBytes < 0 || (size_t)SkipBytes >= DataSize) {
+        MessageBox(hDlg, L"bad format, file, too small\nNot likely SPP binary file", L"File I/O", MB_OK);
+        return APPERR_FILEREAD;
+    }
+    if (SecondaryHeaderSize < 0) {
+        SecondaryHeaderSize = 0;
     }
 
-    // strict application of ECSS-E-ST-70-41C or otherwise only apply CCSDS 133.0-B-1
-    if (!Strict) {
-        return APP_SUCCESS;
+    Sinks = new SPPSINK[SPP_NUM_APID];
+    if (Sinks == NULL) {
+        MessageBox(hDlg, L"Memory allocation failure", L"Program error", MB_OK);
+        return APPERR_MEMALLOC;
+    }
+    memset(Sinks, 0, sizeof(SPPSINK) * SPP_NUM_APID);
+
+    if (!BinaryOutput) {
+        Line = new char[SPPLINE_SIZE];
+        if (Line == NULL) {
+            delete[] Sinks;
+            MessageBox(hDlg, L"Memory allocation failure", L"Program error", MB_OK);
+            return APPERR_MEMALLOC;
+        }
     }
 
-    // flag incorrect settings in SPP primary header
+    // every APID can have an output file open at the same time
+    _setmaxstdio(SPP_NUM_APID + 64);
 
-    // Almost all telemtry packets have a packet secondary header, IDLE and time packets do not
-    if (PriHeader->Type == 0 && PriHeader->SecHeaderFlag != 1) {
-        // IDLE packets and spacecraft time packets do not have secondary header
-        if (PriHeader->APID != 0x7ff && PriHeader->APID !=0x000) {
-            return APPERR_PARAMETER;
+    Position = (size_t)SkipBytes;
+    while (DataSize - Position >= sizeof(PackedPriHeader)) {
+        // SPP header
+        memcpy(&PackedPriHeader, Data + Position, sizeof(PackedPriHeader));
+        PackedPriHeader.ID = ByteSwap(PackedPriHeader.ID);
+        PackedPriHeader.SEQ = ByteSwap(PackedPriHeader.SEQ);
+        PackedPriHeader.DataLength = ByteSwap(PackedPriHeader.DataLength);
+
+        iRes = DecodeSPP(&PackedPriHeader, &PriHeader, Strict);
+        if (iRes == APPERR_PARAMETER) {
+            ErrorMessage = L"Invalid SPP encountered";
+            Result = APPERR_PARAMETER;
+            break;
         }
-    }
-    if (PriHeader->SeqFlag != 3) {
-        return APPERR_PARAMETER;
-    }
 
-    return APP_SUCCESS;
-}
+        // SPP data field length, this includes secondary header, user data, and CRC/checksum
+        PacketSize = sizeof(PackedPriHeader) + (size_t)PriHeader.DataLength;
+        if (DataSize - Position < PacketSize) {
+            ErrorMessage = L"Incomplete packet encountered\nEOF before end of packet";
+            Result = APPERR_FILEREAD;
+            break;
+        }
+        Packet = Data + Position;
+        Position += PacketSize;
+        TotalBytes += PacketSize;
 
-//*******************************************************************
-//
-//  ByteSwap
+        NumPackets++;
+        if (PriHeader.Type == 1) {
+            NumTCpackets++;
+        }
+        else {
+            NumTMpackets++;
+        }
+        if (PriHeader.APID == 0x7ff) {
+            // This is an IDLE packet,skip
+            NumIdlePackets++;
+            continue;
+        }
+
+        Sink = &Sinks[PriHeader.APID];
+        if (Sink->Out == NULL) {
+            // first packet for this APID
+            WCHAR SinkFilename[MAX_PATH];
+
+            if (NumberedFilename(SinkFilename, OutputFile, PriHeader.APID, BinaryOutput ? L".bin" : NULL) != APP_SUCCESS) {
+                ErrorMessage = L"Could not create APID output filename";
+                Result = APPERR_PARAMETER;
+                break;
+            }
+            _wfopen_s(&Sink->Out, SinkFilename, BinaryOutput ? L"wb" : L"w");
+            if (Sink->Out == NULL) {
+                ErrorMessage = L"Could not open APID output file";
+                Result = APPERR_FILEOPEN;
+                break;
+            }
+            setvbuf(Sink->Out, NULL, _IOFBF, SPPSINK_BUFFERSIZE);
+            if (!BinaryOutput) {
+                fprintf(Sink->Out, "   SPP#, PVN, Type, SHflag,   APID, SeqFlg, SeqCount, DataLen, Data Field ->\n");
+            }
+            NumAPIDs++;
+            Sink->FirstSeqCount = PriHeader.SeqCount;
+        }
+        else {
+            // the 14 bit sequence count wraps around
+            int Delta = (PriHeader.SeqCount - Sink->LastSeqCount) & 0x3fff;
+            if (Delta == 0) {
+                Sink->NumRepeats++;
+            }
+            else if (Delta != 1) {
+                Sink->NumGaps++;
+                Sink->NumMissing += Delta - 1;
+                if (Delta - 1 > Sink->MaxMissing) {
+                    Sink->MaxMissing = Delta - 1;
+                }
+            }
+        }
+        Sink->LastSeqCount = PriHeader.SeqCount;
+        Sink->NumPackets++;
+        Sink->NumBytes += PacketSize;
+
+        if (BinaryOutput) {
+            if (fwrite(Packet, 1, PacketSize, Sink->Out) != PacketSize) {
+                ErrorMessage = L"Could not write APID output file";
+                Result = APPERR_FILEWRITE;
+                break;
+            }
+        }
+        else {
+            size_t Length;
+
+            Length = (size_t)sprintf_s(Line, SPPLINE_SIZE, "%7lld,   %1d,    %1d,      %1d, 0x%04x,      %1d,    %5d,   %5d",
+                NumPackets, PriHeader.PVN, PriHeader.Type, PriHeader.SecHeaderFlag, PriHeader.APID,
+                PriHeader.SeqFlag, PriHeader.SeqCount, PriHeader.DataLength);
+
+            // skip sepcifed number of bytes at the beginning of the data field, nominally the secondary header
+            for (int i = SecondaryHeaderSize; i < PriHeader.DataLength; i++) {
+                BYTE Value = Packet[sizeof(PackedPriHeader) + i];
+                Line[Length++] = ',';
+                Line[Length++] = ' ';
+                Line[Length++] = HexDigits[Value >> 4];
+                Line[Length++] = HexDigits[Value & 0x0f];
+            }
+            Line[Length++] = '\n';
+            if (fwrite(Line, 1, Length, Sink->Out) != Length) {
+                ErrorMessage = L"Could not write APID output file";
+                Result = APPERR_FILEWRITE;
+                break;
+            }
+        }
+    }
+
+    if (Result == APP_SUCCESS && NumPackets == 0) {
+        ErrorMessage = L"Input file is wrong type";
+        Result = APPERR_FILEREAD;
+    }
+
+    for (int APID = 0; APID < SPP_NUM_APID; APID++) {
+        if (Sinks[APID].Out != NULL) {
+            if (fclose(Sinks[APID].Out) != 0 && Result == APP_SUCCESS) {
+                ErrorMessage = L"Could not write APID output file";
+                Result = APPERR_FILEWRITE;
+            }
+            Sinks[APID].Out = NULL;
+        }
+    }
+
+    if (SaveReport && NumAPIDs != 0) {
+        FILE* Out = NULL;
+
+        _wfopen_s(&Out, ReportFile, L"w");
+        if (Out == NULL) {
+            if (Result == APP_SUCCESS) {
+                ErrorMessage = L"Could not open APID statistics output file";
+                Result = APPERR_FILEOPEN;
+            }
+        }
+        else {
+            fprintf(Out, "  APID, # packets, # bytes, First SeqCount, Last SeqCount, # gaps, # missing, Largest gap, # repeats\n");
+            for (int APID = 0; APID < SPP_NUM_APID; APID++) {
+                Sink = &Sinks[APID];
+                if (Sink->NumPackets == 0) {
+                    continue;
+                }
+                fprintf(Out, "0x%04x, %9lld, %7lld, %14d, %13d, %6lld, %9lld, %11lld, %9lld\n",
+                    APID, Sink->NumPackets, Sink->NumBytes, Sink->FirstSeqCount, Sink->LastSeqCount,
+                    Sink->NumGaps, Sink->NumMissing, Sink->MaxMissing, Sink->NumRepeats);
+            }
+            fclose(Out);
+        }
+    }
+
+    if (Line != NULL) {
+        delete[] Line;
+    }
+    delete[] Sinks;
+
+    if (ErrorMessage != NULL) {
+        MessageBox(hDlg, ErrorMessage, L"File I/O", MB_OK);
+    }
+
+    TCHAR pszMessageBuf[MAX_PATH];
+    StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH,
+        TEXT("Processed:\n# of total packets: %lld\n# idle packets: %lld\n# of telemtry packets: %lld\n# of telecommand packets: %lld\n# of APIDs: %d\nTotal bytes processeed: %lld"),
+        NumPackets, NumIdlePackets, NumTMpackets, NumTCpackets, NumAPIDs, TotalBytes);
+    MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
+
+    return Result;
+}
+
+//*******************************************************************
+//
+//  DecodeSPP
+// 
+// Private function for ExtractSPP()
+//
+//*******************************************************************
+int DecodeSPP(SPP_PRIMARY_HEADER* PackedPriHeader, SPP_UNPACKED_PRIMARY_HEADER* PriHeader,
+            int Strict)
+{
+    PriHeader->PVN = (PackedPriHeader->ID & 0xe000) >> 13 ;
+
+    PriHeader->Type = (PackedPriHeader->ID & 0x1000) >>12;
+
+    PriHeader->SecHeaderFlag = (PackedPriHeader->ID & 0x0800) >> 11;
+
+    PriHeader->APID = PackedPriHeader->ID & 0x7ff;
+
+    PriHeader->SeqFlag = (PackedPriHeader->SEQ & 0xc000) >>14;
+
+    PriHeader->SeqCount = PackedPriHeader->SEQ & 0x3fff;
+
+    PriHeader->DataLength = PackedPriHeader->DataLength+1; // need to increment by 1 to be accurate
+
+    if (PriHeader->PVN != 0) {
+        return APPERR_PARAMETER;
+    }
+
+    // strict application of ECSS-E-ST-70-41C or otherwise only apply CCSDS 133.0-B-1
+    if (!Strict) {
+        return APP_SUCCESS;
+    }
+
+    // flag incorrect settings in SPP primary header
+
+    // Almost all telemtry packets have a packet secondary header, IDLE and time packets do not
+    if (PriHeader->Type == 0 && PriHeader->SecHeaderFlag != 1) {
+        // IDLE packets and spacecraft time packets do not have secondary header
+        if (PriHeader->APID != 0x7ff && PriHeader->APID !=0x000) {
+            return APPERR_PARAMETER;
+        }
+    }
+    if (PriHeader->SeqFlag != 3) {
+        return APPERR_PARAMETER;
+    }
+
+    return APP_SUCCESS;
+}
+
+//*******************************************************************
+//
+//  ByteSwap
 //
 //*******************************************************************
 uint16_t ByteSwap(uint16_t Value) {
@@ -1833,44 +2680,638 @@ void RemoveNULLbytes(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int NULLval
 //
 //  FindAPrime
 // 
-// First experiment with ChatGPT writing code
+//  Write the prime numbers between Start and End to a text file
+// 
+//  The primes are found with a segmented sieve of Eratosthenes.  The
+//  primes up to sqrt(End) are found first, these are used to cross out
+//  the composite numbers of each segment of SIEVE_SEGMENT_SIZE numbers.
+//  A segment fits in the L2 cache and the segments are independent, a
+//  group of segments is sieved in parallel by the worker threads and
+//  then written in order.
+// 
+// Parameters:
+//  HWND hDlg               Handle of calling window or dialog
+//  WCHAR* Filename         text output file
+//  int Start               first number to test
+//  int End                 last number to test
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
 //
 //*******************************************************************
-int is_prime(int num);
-
 int FindAPrime(HWND hDlg, WCHAR* Filename, int Start, int End)
 {
     FILE* Out;
+    TEXTBUFFER* Text;
+    std::vector<int> BasePrimes;
+    std::vector<std::vector<int>> SegmentPrimes;
+    LONGLONG First;
+    LONGLONG NumSegments;
+    int GroupSize;
+    int Count = 1;
+    char Line[64];
     errno_t ErrNum;
-  
+
     ErrNum = _wfopen_s(&Out, Filename, L"w");
     if (Out == NULL) {
         MessageBox(hDlg, L"Could not open raw output file", L"File I/O", MB_OK);
         return APPERR_FILEOPEN;
     }
 
-    fprintf(Out, "Prime numbers between %d and %d:\n", Start, End);
+    Text = OpenTextBuffer(Out);
+    if (Text == NULL) {
+        fclose(Out);
+        MessageBox(hDlg, L"Text buffer allocation failure", L"Memory", MB_OK);
+        return APPERR_MEMALLOC;
+    }
+
+    sprintf_s(Line, sizeof(Line), "Prime numbers between %d and %d:\n", Start, End);
+    PutText(Text, Line);
+
+    // 0 and 1 are not prime
+    First = Start < 2 ? 2 : Start;
+    NumSegments = 0;
+    if ((LONGLONG)End >= First) {
+        NumSegments = ((LONGLONG)End - First + SIEVE_SEGMENT_SIZE) / SIEVE_SEGMENT_SIZE;
+        SievePrimes((int)sqrt((double)End) + 1, &BasePrimes);
+    }
+
+    // enough segments in a group to keep all the worker threads busy
+    GroupSize = GetWorkerCount() * 4;
+    SegmentPrimes.resize(GroupSize);
+
+    for (LONGLONG Group = 0; Group < NumSegments; Group += GroupSize) {
+        int NumInGroup = (int)((NumSegments - Group) < GroupSize ? (NumSegments - Group) : GroupSize);
 
-    for (int i = Start, j=1; i <= End; ++i) {
-        if (is_prime(i)) {
-            fprintf(Out, "%d: %d\n",j,i);
-            j++;
+        ParallelFor(0, NumInGroup, [&](int StartSegment, int EndSegment) {
+            std::vector<BYTE> Composite(SIEVE_SEGMENT_SIZE);
+
+            for (int Segment = StartSegment; Segment < EndSegment; Segment++) {
+                LONGLONG Low = First + (Group + Segment) * SIEVE_SEGMENT_SIZE;
+                LONGLONG High = Low + SIEVE_SEGMENT_SIZE;
+                if (High > (LONGLONG)End + 1) {
+                    High = (LONGLONG)End + 1;
+                }
+                SieveSegment(Low, High, BasePrimes, Composite.data(), &SegmentPrimes[Segment]);
+            }
+        });
+
+        for (int Segment = 0; Segment < NumInGroup; Segment++) {
+            for (int Prime : SegmentPrimes[Segment]) {
+                sprintf_s(Line, sizeof(Line), "%d: %d\n", Count, Prime);
+                PutText(Text, Line);
+                Count++;
+            }
         }
     }
+
+    CloseTextBuffer(Text);
     fclose(Out);
     return APP_SUCCESS;
 }
 
-// from ChatGPT, simple prime calcuator, only good for smaller prime numbers
-// Function to check if a number is prime
-BOOL is_prime(int num) {
-    if (num <= 1) {
-        return FALSE;  // Not prime
+//*******************************************************************
+//
+//  SievePrimes
+// 
+//  private function
+// 
+//  Sieve of Eratosthenes for the primes <= Limit, these are the primes
+//  used to sieve the segments.
+//
+//*******************************************************************
+static void SievePrimes(int Limit, std::vector<int>* Primes)
+{
+    std::vector<BYTE> Composite((size_t)Limit + 1, 0);
+
+    Primes->clear();
+    for (int Number = 2; Number <= Limit; Number++) {
+        if (Composite[Number]) {
+            continue;
+        }
+        Primes->push_back(Number);
+        for (LONGLONG Multiple = (LONGLONG)Number * Number; Multiple <= Limit; Multiple += Number) {
+            Composite[(size_t)Multiple] = 1;
+        }
+    }
+    return;
+}
+
+//*******************************************************************
+//
+//  SieveSegment
+// 
+//  private function
+// 
+//  Find the primes in Low <= number < High, Low >= 2.  BasePrimes must
+//  hold all the primes <= sqrt(High-1).  Composite is the work area of
+//  at least High-Low bytes.
+//
+//*******************************************************************
+static void SieveSegment(LONGLONG Low, LONGLONG High, const std::vector<int>& BasePrimes,
+    BYTE* Composite, std::vector<int>* Primes)
+{
+    size_t Size = (size_t)(High - Low);
+
+    memset(Composite, 0, Size);
+    for (int Prime : BasePrimes) {
+        LONGLONG Multiple = (LONGLONG)Prime * Prime;
+        if (Multiple >= High) {
+            break;
+        }
+        // smaller multiples of Prime are crossed out by smaller primes
+        if (Multiple < Low) {
+            Multiple = ((Low + Prime - 1) / Prime) * Prime;
+        }
+        for (; Multiple < High; Multiple += Prime) {
+            Composite[Multiple - Low] = 1;
+        }
     }
-    for (int i = 2; i * i <= num; ++i) {
-        if (num % i == 0) {
-            return FALSE;  // Not prime
+
+    Primes->clear();
+    for (size_t i = 0; i < Size; i++) {
+        if (!Composite[i]) {
+            Primes->push_back((int)(Low + (LONGLONG)i));
         }
     }
-    return TRUE;  // Prime
-}
\ No newline at end of file
+    return;
+}
+
+//*******************************************************************
+//
+//  BitStreamFactorSizes
+// 
+//  The bits after the prologue of a bitstream file are NumPixels pixels
+//  of BitDepth bits.  Find all the x sizes of an image of exactly
+//  NumPixels pixels, these are the factor pairs (xsize,ysize) of NumPixels.
+//  The x sizes from xsize to xsizeEnd are returned in ascending order.
+//  If xsizeEnd < xsize there is no upper limit.
+// 
+//  The x sizes are the sweep list for BatchBitStream2Image() with the whole
+//  bitstream, after the prologue, as a single block of NumBlockBodyBits.
+// 
+// Parameters:
+//  WCHAR* InputFile        Packed Binary Btstream input file
+//  int PrologueSize        # of bits to skip in prologue
+//  int BitDepth            # of bits per pixel
+//  int xsize               smallest x size
+//  int xsizeEnd            largest x size
+//  std::vector<int>* Xsizes    x sizes of the factor pairs
+//  int* NumBlockBodyBits   # of bits used, NumPixels*BitDepth
+//  ULONGLONG* NumBits      # of bits after the prologue, NULL if not needed
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//      APPERR_FILESIZE if NumBlockBodyBits would not fit in an 'int'
+//
+//*******************************************************************
+int BitStreamFactorSizes(WCHAR* InputFile, int PrologueSize, int BitDepth, int xsize, int xsizeEnd,
+    std::vector<int>* Xsizes, int* NumBlockBodyBits, ULONGLONG* NumBits)
+{
+    BitReader Reader;
+    std::vector<int> Primes;
+    std::vector<ULONGLONG> Factors;
+    ULONGLONG StreamBits = 0;
+    ULONGLONG NumPixels;
+    ULONGLONG Remainder;
+    int iRes;
+
+    Xsizes->clear();
+    *NumBlockBodyBits = 0;
+    if (BitDepth <= 0 || BitDepth > 32 || PrologueSize < 0) {
+        return APPERR_PARAMETER;
+    }
+
+    // the file size is taken from the memory mapped view
+    iRes = Reader.Open(InputFile, 0);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
+    if (Reader.GetTotalBits() > (ULONGLONG)PrologueSize) {
+        StreamBits = Reader.GetTotalBits() - (ULONGLONG)PrologueSize;
+    }
+    Reader.Close();
+    if (NumBits != NULL) {
+        *NumBits = StreamBits;
+    }
+
+    NumPixels = StreamBits / (ULONGLONG)BitDepth;
+    if (NumPixels == 0) {
+        return APP_SUCCESS;
+    }
+    if (NumPixels * (ULONGLONG)BitDepth > (ULONGLONG)INT_MAX) {
+        return APPERR_FILESIZE;
+    }
+    *NumBlockBodyBits = (int)(NumPixels * (ULONGLONG)BitDepth);
+
+    // prime factors of NumPixels, the primes up to sqrt(NumPixels) are enough,
+    // what is left after dividing them out is 1 or a prime
+    SievePrimes((int)sqrt((double)NumPixels) + 1, &Primes);
+    Factors.push_back(1);
+    Remainder = NumPixels;
+    for (int Prime : Primes) {
+        if ((ULONGLONG)Prime * (ULONGLONG)Prime > Remainder) {
+            break;
+        }
+        size_t NumFactors = Factors.size();
+        ULONGLONG Power = 1;
+        while (Remainder % (ULONGLONG)Prime == 0) {
+            Remainder /= (ULONGLONG)Prime;
+            Power *= (ULONGLONG)Prime;
+            for (size_t i = 0; i < NumFactors; i++) {
+                Factors.push_back(Factors[i] * Power);
+            }
+        }
+    }
+    if (Remainder > 1) {
+        size_t NumFactors = Factors.size();
+        for (size_t i = 0; i < NumFactors; i++) {
+            Factors.push_back(Factors[i] * Remainder);
+        }
+    }
+    std::sort(Factors.begin(), Factors.end());
+
+    for (ULONGLONG Factor : Factors) {
+        if (Factor < (ULONGLONG)xsize) {
+            continue;
+        }
+        if (xsizeEnd >= xsize && Factor > (ULONGLONG)xsizeEnd) {
+            break;
+        }
+        Xsizes->push_back((int)Factor);
+    }
+
+    return APP_SUCCESS;
+}
+
+//*******************************************************************
+//
+//  FactorBitStreamLength
+// 
+//  Write the factor pairs (xsize,ysize) of the bitstream length of a
+//  file to a text file, see BitStreamFactorSizes()
+// 
+// Parameters:
+//  HWND hDlg               Handle of calling window or dialog
+//  WCHAR* InputFile        Packed Binary Btstream input file
+//  WCHAR* OutputFile       text output file
+//  int PrologueSize        # of bits to skip in prologue
+//  int BitDepth            # of bits per pixel
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************
+int FactorBitStreamLength(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int PrologueSize, int BitDepth)
+{
+    FILE* Out;
+    TEXTBUFFER* Text;
+    std::vector<int> Xsizes;
+    ULONGLONG NumBits;
+    int NumBlockBodyBits;
+    char Line[128];
+    errno_t ErrNum;
+    int iRes;
+
+    iRes = BitStreamFactorSizes(InputFile, PrologueSize, BitDepth, 1, 0, &Xsizes, &NumBlockBodyBits, &NumBits);
+    if (iRes == APPERR_PARAMETER) {
+        MessageBox(hDlg, L"1 <= Image bit depth <= 32, # bits in prologue >= 0", L"File I/O", MB_OK);
+        return iRes;
+    }
+    if (iRes == APPERR_FILESIZE) {
+        MessageBox(hDlg, L"Bitstream is too long to factor", L"File incompatible", MB_OK);
+        return iRes;
+    }
+    if (iRes != APP_SUCCESS) {
+        MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
+        return iRes;
+    }
+
+    ErrNum = _wfopen_s(&Out, OutputFile, L"w");
+    if (Out == NULL) {
+        MessageBox(hDlg, L"Could not open text output file", L"File I/O", MB_OK);
+        return APPERR_FILEOPEN;
+    }
+
+    Text = OpenTextBuffer(Out);
+    if (Text == NULL) {
+        fclose(Out);
+        MessageBox(hDlg, L"Text buffer allocation failure", L"Memory", MB_OK);
+        return APPERR_MEMALLOC;
+    }
+
+    sprintf_s(Line, sizeof(Line), "Bitstream length: %llu bits after a %d bit prologue\n", NumBits, PrologueSize);
+    PutText(Text, Line);
+    sprintf_s(Line, sizeof(Line), "Pixels: %d of %d bits, %llu bits not used\n",
+        NumBlockBodyBits / BitDepth, BitDepth, NumBits - (ULONGLONG)NumBlockBodyBits);
+    PutText(Text, Line);
+    sprintf_s(Line, sizeof(Line), "%d factor pairs\nxsize,ysize\n", (int)Xsizes.size());
+    PutText(Text, Line);
+    for (int Xsize : Xsizes) {
+        sprintf_s(Line, sizeof(Line), "%d,%d\n", Xsize, (NumBlockBodyBits / BitDepth) / Xsize);
+        PutText(Text, Line);
+    }
+
+    CloseTextBuffer(Text);
+    fclose(Out);
+    return APP_SUCCESS;
+}
+
+//*******************************************************************
+//
+// DecodeBitStreamPixels
+// 
+// private function
+// 
+// Decode up to NumPixels pixels of BitDepth bits from the current
+// position of the bitstream reader.
+// 
+// Parameters:
+//  BitReader* Reader       bitstream positioned at the first pixel
+//  int* Pixels             decoded pixels
+//  size_t NumPixels        # of pixels to decode
+//  int BitDepth            # of bits converted per pixel (1 to 32)
+//  int BitOrder            0 - LSB to MSB, 1 - MSB to LSB
+//  int BitScale            Scale binary output, 0,1 -> 0,255
+//  int Invert              1 - invert the input bits
+// 
+//  return value:
+//  # of complete pixels decoded
+//
+//*******************************************************************
+static size_t DecodeBitStreamPixels(BitReader* Reader, int* Pixels, size_t NumPixels,
+    int BitDepth, int BitOrder, int BitScale, int Invert)
+{
+    size_t NumDecoded;
+    unsigned int InvertMask = 0;
+
+    // the first bit of each pixel is the MSB of the value read
+    NumDecoded = Reader->ReadBitsArray(Pixels, NumPixels, BitDepth);
+
+    if (Invert == 1) {
+        InvertMask = (BitDepth == 32) ? 0xffffffff : ((1U << BitDepth) - 1);
+    }
+
+    for (size_t i = 0; i < NumDecoded; i++) {
+        unsigned int Value;
+
+        Value = (unsigned int)Pixels[i] ^ InvertMask;
+        if (!BitOrder) {
+            // bit stream order is LSB to MSB, reverse the BitDepth bits
+            Value = ((Value >> 1) & 0x55555555) | ((Value & 0x55555555) << 1);
+            Value = ((Value >> 2) & 0x33333333) | ((Value & 0x33333333) << 2);
+            Value = ((Value >> 4) & 0x0f0f0f0f) | ((Value & 0x0f0f0f0f) << 4);
+            Value = ((Value >> 8) & 0x00ff00ff) | ((Value & 0x00ff00ff) << 8);
+            Value = (Value >> 16) | (Value << 16);
+            Value = Value >> (32 - BitDepth);
+        }
+        if (BitScale && Value) {
+            Value = 255;
+        }
+        Pixels[i] = (int)Value;
+    }
+
+    return NumDecoded;
+}
+
+//*******************************************************************
+//
+// NumberedFilename
+// 
+// private function
+// 
+// Output filename for one x size of BatchBitStream2Image() or one APID of DemuxSPP()
+// The number is added to the filename, name.ext -> name_number.ext
+// 
+// Parameters:
+//  WCHAR* NewFilename      resulting filename, MAX_PATH characters
+//  WCHAR* OutputFile       batch output filename
+//  int Number              x size of this image file or the APID
+//  const WCHAR* NewExt     NULL - keep the extension of OutputFile
+//                          otherwise replace the extension (e.g. L".bmp")
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************
+static int NumberedFilename(WCHAR* NewFilename, WCHAR* OutputFile, int Number, const WCHAR* NewExt)
+{
+    int err;
+    WCHAR Drive[_MAX_DRIVE];
+    WCHAR Dir[_MAX_DIR];
+    WCHAR Fname[_MAX_FNAME];
+    WCHAR Ext[_MAX_EXT];
+    WCHAR NewFname[_MAX_FNAME];
+
+    // split apart original filename
+    err = _wsplitpath_s(OutputFile, Drive, _MAX_DRIVE, Dir, _MAX_DIR, Fname,
+        _MAX_FNAME, Ext, _MAX_EXT);
+    if (err != 0) {
+        return APPERR_PARAMETER;
+    }
+
+    // add number to filename portion
+    swprintf_s(NewFname, _MAX_FNAME, L"%s_%d", Fname, Number);
+
+    // reassemble filename
+    err = _wmakepath_s(NewFilename, _MAX_PATH, Drive, Dir, NewFname, NewExt == NULL ? Ext : NewExt);
+    if (err != 0) {
+        return APPERR_PARAMETER;
+    }
+    return APP_SUCCESS;
+}
+
+//*******************************************************************
+//
+// OpenTextBuffer, PutText, CloseTextBuffer
+// 
+// private functions
+// 
+// Buffered output for the bit by bit text reports.  The text is
+// written to the file in TEXTBUFFER_SIZE blocks instead of a
+// fprintf() for each bit.
+// 
+//*******************************************************************
+static TEXTBUFFER* OpenTextBuffer(FILE* Out)
+{
+    TEXTBUFFER* Buffer;
+
+    Buffer = new TEXTBUFFER;
+    if (Buffer == NULL) {
+        return NULL;
+    }
+    Buffer->Out = Out;
+    Buffer->Length = 0;
+    return Buffer;
+}
+
+static void PutText(TEXTBUFFER* Buffer, const char* Text)
+{
+    while (*Text) {
+        if (Buffer->Length == TEXTBUFFER_SIZE) {
+            fwrite(Buffer->Text, 1, Buffer->Length, Buffer->Out);
+            Buffer->Length = 0;
+        }
+        Buffer->Text[Buffer->Length++] = *Text++;
+    }
+    return;
+}
+
+static void CloseTextBuffer(TEXTBUFFER* Buffer)
+{
+    if (Buffer->Length != 0) {
+        fwrite(Buffer->Text, 1, Buffer->Length, Buffer->Out);
+    }
+    delete Buffer;
+    return;
+}
+
+//*******************************************************************
+//
+// RUNHISTOGRAM::Add
+// 
+// Add Number runs of Length bits to the histogram
+// 
+//*******************************************************************
+void RUNHISTOGRAM::Add(ULONGLONG Length, long long Number)
+{
+    if (Length == 0 || Number == 0) {
+        return;
+    }
+    if (Length <= RUNHISTOGRAM_DENSE) {
+        if (Dense.size() <= (size_t)Length) {
+            Dense.resize((size_t)Length + 1, 0);
+        }
+        Dense[(size_t)Length] += Number;
+    }
+    else {
+        Long[Length] += Number;
+    }
+    Sequences += Number;
+    Total += (long long)Length * Number;
+    if (Length > MaxLength) {
+        MaxLength = Length;
+    }
+    return;
+}
+
+//*******************************************************************
+//
+// RUNHISTOGRAM::Merge
+// 
+// Add the counts of the Source histogram
+// 
+//*******************************************************************
+void RUNHISTOGRAM::Merge(RUNHISTOGRAM& Source)
+{
+    for (size_t i = 1; i < Source.Dense.size(); i++) {
+        Add(i, Source.Dense[i]);
+    }
+    for (auto& Entry : Source.Long) {
+        Add(Entry.first, Entry.second);
+    }
+    return;
+}
+
+//*******************************************************************
+//
+// RUNHISTOGRAM::Shift
+// 
+// Add 1 to the length of every run in the histogram
+// 
+//*******************************************************************
+void RUNHISTOGRAM::Shift(void)
+{
+    RUNHISTOGRAM Shifted;
+
+    for (size_t i = 1; i < Dense.size(); i++) {
+        Shifted.Add(i + 1, Dense[i]);
+    }
+    for (auto& Entry : Long) {
+        Shifted.Add(Entry.first + 1, Entry.second);
+    }
+    *this = Shifted;
+    return;
+}
+
+//*******************************************************************
+//
+// RUNHISTOGRAM::Count
+// 
+// # of runs of Length bits
+// 
+//*******************************************************************
+long long RUNHISTOGRAM::Count(ULONGLONG Length)
+{
+    if (Length <= RUNHISTOGRAM_DENSE) {
+        if ((size_t)Length < Dense.size()) {
+            return Dense[(size_t)Length];
+        }
+        return 0;
+    }
+    auto Entry = Long.find(Length);
+    if (Entry == Long.end()) {
+        return 0;
+    }
+    return Entry->second;
+}
+
+//*******************************************************************
+//
+// RUNHISTOGRAM::NextLength
+// 
+// Next run length > Length that has a count
+// RUNHISTOGRAM_END if there are no more lengths
+// 
+//*******************************************************************
+ULONGLONG RUNHISTOGRAM::NextLength(ULONGLONG Length)
+{
+    for (size_t i = (size_t)Length + 1; i < Dense.size(); i++) {
+        if (Dense[i] != 0) {
+            return i;
+        }
+    }
+    auto Entry = Long.upper_bound(Length);
+    if (Entry == Long.end()) {
+        return RUNHISTOGRAM_END;
+    }
+    return Entry->first;
+}
+
+//*******************************************************************
+//
+// RUNHISTOGRAM::Fill
+// 
+// Copy the histogram to an image row, Row[x] is the count for
+// length x+1.  Longer runs are counted in the last column.
+// The counts are limited to the largest int.
+// 
+//*******************************************************************
+void RUNHISTOGRAM::Fill(int* Row, int Xsize)
+{
+    long long Overflow = 0;
+
+    for (int x = 0; x < Xsize; x++) {
+        Row[x] = 0;
+    }
+    for (size_t i = 1; i < Dense.size(); i++) {
+        if (i <= (size_t)Xsize) {
+            Row[i - 1] = (int)(Dense[i] > INT_MAX ? INT_MAX : Dense[i]);
+        }
+        else {
+            Overflow += Dense[i];
+        }
+    }
+    for (auto& Entry : Long) {
+        Overflow += Entry.second;
+    }
+    if (Overflow != 0) {
+        Overflow += Row[Xsize - 1];
+        Row[Xsize - 1] = (int)(Overflow > INT_MAX ? INT_MAX : Overflow);
+    }
+    return;
+}
@@ -0,0 +1,355 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// BufferPool.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Process wide pool of large image buffers
+//
+// The batch functions (PixelReorderBatch, BatchBitStream2Image, the kernel batch)
+// allocate and free the same large image, frame and address table buffers for
+// every file they process.  Each new allocation of this size is committed by the
+// OS page by page and each page is zeroed on first use.  The pool keeps the
+// released blocks and hands them out again, so after the first file the buffers
+// are already committed.
+//
+// Blocks of POOL_MIN_BYTES or more are rounded up to one of 4 sizes per power of
+// two so that buffers of similar size can reuse the same block.  They are allocated
+// with VirtualAlloc, using large pages when the process can enable the lock pages
+// in memory privilege (SeLockMemoryPrivilege), this reduces TLB misses when a
+// large image is walked in reordering address order.  Smaller blocks are ordinary
+// heap allocations and are not cached.
+//
+// The cache of released blocks is limited to 1/8 of the physical memory (at most
+// POOL_MAX_CACHE), the least recently released blocks are returned to the OS
+// first.  If an allocation fails, the cache is released and the allocation is
+// tried again.
+//
+// PoolBuffer (BufferPool.h) is a handle that returns its block to the pool when it
+// goes out of scope.
+//
+// V1.3.2.1 2026-10-14  Initial release
+//
+#include "framework.h"
+#include <mutex>
+#include <map>
+#include "BufferPool.h"
+
+// most bytes kept in the cache of released blocks
+#define POOL_MAX_CACHE ((size_t)2*1024*1024*1024)
+
+// bytes in front of every block, keeps the blocks 64 byte aligned
+#define POOL_HEADER_BYTES 64
+
+#define POOL_BLOCK_ID 0x4c4f4f50
+
+// where the memory of a block came from
+#define POOL_SOURCE_HEAP 0
+#define POOL_SOURCE_PAGES 1
+#define POOL_SOURCE_LARGE_PAGES 2
+
+typedef struct POOLBLOCK {
+	DWORD ID;				// POOL_BLOCK_ID, checked by PoolFree
+	int Source;				// POOL_SOURCE_
+	size_t Bytes;			// total bytes of the block including this header
+	ULONGLONG LastUse;		// release order of cached blocks, oldest first
+} POOLBLOCK;
+
+static_assert(sizeof(POOLBLOCK) <= POOL_HEADER_BYTES, "POOLBLOCK does not fit in the block header");
+
+static std::mutex PoolMutex;
+static std::multimap<size_t, POOLBLOCK*> CachedBlocks;	// released blocks by size
+static size_t CachedBytes = 0;
+static size_t CacheLimit = 0;
+static size_t LargePageSize = 0;						// 0 - large pages are not used
+static ULONGLONG ReleaseCount = 0;
+static bool PoolInitialized = false;
+
+static void InitBufferPool(void);
+static size_t PoolBlockSize(size_t Bytes);
+static POOLBLOCK* NewPoolBlock(size_t Bytes);
+static void ReleasePoolBlock(POOLBLOCK* Block);
+static void TrimCache(size_t Limit);
+
+//*****************************************************************************************
+//
+//	PoolAlloc
+//
+//	Borrow a block of memory from the buffer pool.  The memory is not
+//	initialized, it may contain the pixels of a previous image.
+//
+// Parameters:
+//	size_t Bytes		size of the block
+//
+//  return value:
+//	pointer to the block, release it with PoolFree()
+//	NULL - memory allocation failure
+//
+//*****************************************************************************************
+void* PoolAlloc(size_t Bytes)
+{
+	POOLBLOCK* Block = NULL;
+	size_t BlockBytes;
+
+	if (Bytes > ((size_t)-1) / 2) {
+		return NULL;
+	}
+
+	if (Bytes < POOL_MIN_BYTES) {
+		BYTE* Heap = new BYTE[Bytes + POOL_HEADER_BYTES];
+		if (Heap == NULL) {
+			return NULL;
+		}
+		Block = (POOLBLOCK*)Heap;
+		Block->ID = POOL_BLOCK_ID;
+		Block->Source = POOL_SOURCE_HEAP;
+		Block->Bytes = Bytes + POOL_HEADER_BYTES;
+		Block->LastUse = 0;
+		return Heap + POOL_HEADER_BYTES;
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(PoolMutex);
+
+		if (!PoolInitialized) {
+			InitBufferPool();
+		}
+		BlockBytes = PoolBlockSize(Bytes);
+
+		// a cached block of the same size class, or at most one class larger
+		auto Cached = CachedBlocks.lower_bound(BlockBytes);
+		if (Cached != CachedBlocks.end() && Cached->first <= BlockBytes + BlockBytes / 4) {
+			Block = Cached->second;
+			CachedBytes -= Cached->first;
+			CachedBlocks.erase(Cached);
+		}
+	}
+
+	if (Block == NULL) {
+		Block = NewPoolBlock(BlockBytes);
+		if (Block == NULL) {
+			// the cached blocks may be what is using the memory
+			TrimBufferPool();
+			Block = NewPoolBlock(BlockBytes);
+			if (Block == NULL) {
+				return NULL;
+			}
+		}
+	}
+
+	return (BYTE*)Block + POOL_HEADER_BYTES;
+}
+
+//*****************************************************************************************
+//
+//	PoolFree
+//
+//	Return a block from PoolAlloc() to the buffer pool.  NULL is ignored.
+//
+//*****************************************************************************************
+void PoolFree(void* Memory)
+{
+	POOLBLOCK* Block;
+
+	if (Memory == NULL) {
+		return;
+	}
+
+	Block = (POOLBLOCK*)((BYTE*)Memory - POOL_HEADER_BYTES);
+	if (Block->ID != POOL_BLOCK_ID) {
+		// not a pool block, leak it rather than corrupt the heap
+		return;
+	}
+
+	if (Block->Source == POOL_SOURCE_HEAP) {
+		Block->ID = 0;
+		delete[] (BYTE*)Block;
+		return;
+	}
+
+	std::lock_guard<std::mutex> Lock(PoolMutex);
+
+	if (Block->Bytes > CacheLimit) {
+		ReleasePoolBlock(Block);
+		return;
+	}
+
+	Block->LastUse = ++ReleaseCount;
+	CachedBlocks.insert(std::make_pair(Block->Bytes, Block));
+	CachedBytes += Block->Bytes;
+	TrimCache(CacheLimit);
+	return;
+}
+
+//*****************************************************************************************
+//
+//	TrimBufferPool
+//
+//	Return all the cached blocks to the OS.  Blocks still in use are not
+//	affected, they are released when they are returned to the pool.
+//
+//*****************************************************************************************
+void TrimBufferPool(void)
+{
+	std::lock_guard<std::mutex> Lock(PoolMutex);
+
+	TrimCache(0);
+	return;
+}
+
+//*****************************************************************************************
+//
+//	InitBufferPool
+//
+//	Private function, called once with PoolMutex held.  Set the cache limit and
+//	enable large pages if this process is allowed to lock pages in memory.
+//
+//*****************************************************************************************
+static void InitBufferPool(void)
+{
+	MEMORYSTATUSEX Status;
+	HANDLE hToken;
+	TOKEN_PRIVILEGES Privileges;
+
+	PoolInitialized = true;
+
+	CacheLimit = POOL_MAX_CACHE;
+	Status.dwLength = sizeof(MEMORYSTATUSEX);
+	if (GlobalMemoryStatusEx(&Status) && Status.ullTotalPhys / 8 < (DWORDLONG)CacheLimit) {
+		CacheLimit = (size_t)(Status.ullTotalPhys / 8);
+	}
+
+	if (GetLargePageMinimum() == 0) {
+		return;
+	}
+
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &hToken)) {
+		return;
+	}
+
+	Privileges.PrivilegeCount = 1;
+	Privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+	if (LookupPrivilegeValue(NULL, SE_LOCK_MEMORY_NAME, &Privileges.Privileges[0].Luid)) {
+		// AdjustTokenPrivileges succeeds even if the privilege was not assigned
+		// to the user, ERROR_NOT_ALL_ASSIGNED is reported by GetLastError()
+		if (AdjustTokenPrivileges(hToken, FALSE, &Privileges, 0, NULL, NULL) &&
+			GetLastError() == ERROR_SUCCESS) {
+			LargePageSize = GetLargePageMinimum();
+		}
+	}
+
+	CloseHandle(hToken);
+	return;
+}
+
+//*****************************************************************************************
+//
+//	PoolBlockSize
+//
+//	Private function, total size of the block that holds Bytes.  The size is
+//	rounded up to one of 4 size classes per power of two and then to a whole
+//	number of pages.
+//
+//*****************************************************************************************
+static size_t PoolBlockSize(size_t Bytes)
+{
+	size_t BlockBytes = Bytes + POOL_HEADER_BYTES;
+	size_t PowerOf2 = 1;
+	size_t Step;
+
+	while (PowerOf2 <= BlockBytes / 2) {
+		PowerOf2 <<= 1;
+	}
+	Step = PowerOf2 / 4;
+	BlockBytes = ((BlockBytes + Step - 1) / Step) * Step;
+
+	// POOL_MIN_BYTES is 1MB, so Step is always a multiple of a 4K page,
+	// large pages only make sense for blocks of at least one large page
+	if (LargePageSize != 0 && BlockBytes >= LargePageSize) {
+		BlockBytes = ((BlockBytes + LargePageSize - 1) / LargePageSize) * LargePageSize;
+	}
+
+	return BlockBytes;
+}
+
+//*****************************************************************************************
+//
+//	NewPoolBlock
+//
+//	Private function, allocate a new block from the OS.  Large pages are tried
+//	first, they can fail when the physical memory is fragmented.
+//
+//*****************************************************************************************
+static POOLBLOCK* NewPoolBlock(size_t Bytes)
+{
+	POOLBLOCK* Block = NULL;
+	int Source = POOL_SOURCE_PAGES;
+
+	if (LargePageSize != 0 && (Bytes % LargePageSize) == 0) {
+		Block = (POOLBLOCK*)VirtualAlloc(NULL, Bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		Source = POOL_SOURCE_LARGE_PAGES;
+	}
+	if (Block == NULL) {
+		Block = (POOLBLOCK*)VirtualAlloc(NULL, Bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		Source = POOL_SOURCE_PAGES;
+	}
+	if (Block == NULL) {
+		return NULL;
+	}
+
+	Block->ID = POOL_BLOCK_ID;
+	Block->Source = Source;
+	Block->Bytes = Bytes;
+	Block->LastUse = 0;
+	return Block;
+}
+
+//*****************************************************************************************
+//
+//	ReleasePoolBlock
+//
+//	Private function, return a VirtualAlloc block to the OS
+//
+//*****************************************************************************************
+static void ReleasePoolBlock(POOLBLOCK* Block)
+{
+	Block->ID = 0;
+	VirtualFree(Block, 0, MEM_RELEASE);
+	return;
+}
+
+//*****************************************************************************************
+//
+//	TrimCache
+//
+//	Private function, called with PoolMutex held.  Release the least recently
+//	cached blocks until the cache holds at most Limit bytes.
+//
+//*****************************************************************************************
+static void TrimCache(size_t Limit)
+{
+	while (CachedBytes > Limit && !CachedBlocks.empty()) {
+		auto Oldest = CachedBlocks.begin();
+		for (auto Cached = CachedBlocks.begin(); Cached != CachedBlocks.end(); Cached++) {
+			if (Cached->second->LastUse < Oldest->second->LastUse) {
+				Oldest = Cached;
+			}
+		}
+		CachedBytes -= Oldest->first;
+		ReleasePoolBlock(Oldest->second);
+		CachedBlocks.erase(Oldest);
+	}
+	return;
+}
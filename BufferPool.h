@@ -0,0 +1,116 @@
+#pragma once
+//
+// BufferPool.h
+// function prototypes and the buffer handle class for the buffer pool in BufferPool.cpp
+//
+#include <type_traits>
+
+// blocks smaller than this are ordinary heap allocations and are not cached
+#define POOL_MIN_BYTES ((size_t)1024*1024)
+
+void* PoolAlloc(size_t Bytes);
+
+void PoolFree(void* Block);
+
+void TrimBufferPool(void);
+
+//*****************************************************************************************
+//
+//	PoolBuffer
+//
+//	Array of Count elements borrowed from the buffer pool.  The memory is
+//	returned to the pool when the handle is destroyed, so an early return
+//	from a function does not need to release it.  The elements are not
+//	initialized.
+//
+//	PoolBuffer<int> Image;
+//	if (!Image.Allocate(NumPixels)) {
+//		return APPERR_MEMALLOC;
+//	}
+//	Image[0] = 0;
+//
+//*****************************************************************************************
+template <typename T>
+class PoolBuffer
+{
+	static_assert(std::is_trivial<T>::value, "PoolBuffer elements must be trivial types");
+
+private:
+	T* Data = NULL;						// borrowed memory, NULL if none
+	size_t Count = 0;					// # of elements in Data
+
+public:
+	PoolBuffer() {
+	};
+
+	explicit PoolBuffer(size_t NewCount) {
+		Allocate(NewCount);
+	};
+
+	~PoolBuffer() {
+		Free();
+	};
+
+	PoolBuffer(const PoolBuffer&) = delete;
+	PoolBuffer& operator=(const PoolBuffer&) = delete;
+
+	PoolBuffer(PoolBuffer&& Other) noexcept {
+		Data = Other.Data;
+		Count = Other.Count;
+		Other.Data = NULL;
+		Other.Count = 0;
+	};
+
+	PoolBuffer& operator=(PoolBuffer&& Other) noexcept {
+		if (this != &Other) {
+			Free();
+			Data = Other.Data;
+			Count = Other.Count;
+			Other.Data = NULL;
+			Other.Count = 0;
+		}
+		return *this;
+	};
+
+	// the current memory is kept if it already holds NewCount elements
+	// returns NULL if the memory could not be allocated
+	T* Allocate(size_t NewCount) {
+		if (Data != NULL && Count >= NewCount) {
+			return Data;
+		}
+		Free();
+		Data = (T*)PoolAlloc((NewCount ? NewCount : 1) * sizeof(T));
+		if (Data != NULL) {
+			Count = NewCount;
+		}
+		return Data;
+	};
+
+	void Free(void) {
+		if (Data != NULL) {
+			PoolFree(Data);
+			Data = NULL;
+		}
+		Count = 0;
+	};
+
+	// the caller becomes responsible for releasing the memory with PoolFree()
+	T* Detach(void) {
+		T* Block = Data;
+		Data = NULL;
+		Count = 0;
+		return Block;
+	};
+
+	T* Get(void) const {
+		return Data;
+	};
+
+	size_t Size(void) const {
+		return Count;
+	};
+
+	operator T*() const {
+		return Data;
+	};
+};
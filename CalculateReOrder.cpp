@@ -25,8 +25,14 @@
 //							MxN Block [P1,P2] output decom
 // V1.2.10.1 2023-11-5  Added new algorithm for reordering
 //							Added split image left/right                      
+// V1.3.2.1 2026-10-14	Added ComputeReorderTable, the address mapping for all the pixels
+//						in a frame is calculated once and stored in an address table
+//						Correction, algorithm 0 linear address used Xsize*Ysize as the row size
 // 
 //*******************************************************************************
+#include "framework.h"
+#include <atomic>
+#include "Parallel.h"
 #include "CalculateReOrder.h"
 
 int CalcQuad_UL_UR_LL_LR_l2r_t2b(int x, int y, int Xsize, int Ysize);
@@ -71,7 +77,7 @@ int CalculateReOrder(int x, int y, int Xsize, int Ysize, int Algorithm, int P1,
 	case 0:
 		(*ResizeFlag) = 1;
 		// no reorder, linear adress calculation
-		Address = x + (y * Xsize * Ysize);
+		Address = x + (y * Xsize);
 		break;
 
 	case 1:
@@ -154,6 +160,71 @@ int CalculateReOrder(int x, int y, int Xsize, int Ysize, int Algorithm, int P1,
 	return Address;
 }
 
+//******************************************************************************
+//
+// ComputeReorderTable
+// 
+// This calculates the origin address in the input image for every
+// pixel in one Xsize by Ysize output frame.  The mapping only depends
+// on the frame size, the algorithm and its parameters so it is the same
+// for all frames in the image.
+// 
+// AddressTable[y*Xsize + x] = CalculateReOrder(x, y, ...)
+// 
+// The rows of the table are calculated in parallel.
+// 
+// Parameters:
+//	int* AddressTable		table of Xsize*Ysize entries to be filled in
+//	int Xsize				output frame x size
+//	int Ysize				output frame y size
+//	int Algorithm			Algorithm to use for reordering
+//	int P1,P2,P3			Algorithm parameters
+// 
+//  return value:
+//	ResizeFlag value   -1	Error, invalid algorithm specified or
+//							an address is outside of the Xsize*Ysize frame
+//						0	Don't resize image
+//						1	resize image
+//
+//*******************************************************************************
+int ComputeReorderTable(int* AddressTable, int Xsize, int Ysize, int Algorithm, int P1, int P2, int P3)
+{
+	int ResizeFlag;
+	int FrameSize;
+	std::atomic<bool> OutOfRange(false);
+
+	CalculateReOrder(0, 0, Xsize, Ysize, Algorithm, P1, P2, P3, &ResizeFlag);
+	if (ResizeFlag < 0) {
+		return ResizeFlag;
+	}
+
+	FrameSize = Xsize * Ysize;
+
+	ParallelFor(0, Ysize, [&](int StartY, int EndY) {
+		int RowFlag;
+		int Address;
+		int* Row;
+
+		for (int y = StartY; y < EndY; y++) {
+			Row = AddressTable + (size_t)y * (size_t)Xsize;
+			for (int x = 0; x < Xsize; x++) {
+				Address = CalculateReOrder(x, y, Xsize, Ysize, Algorithm, P1, P2, P3, &RowFlag);
+				if (Address < 0 || Address >= FrameSize) {
+					OutOfRange = true;
+					Address = 0;
+				}
+				Row[x] = Address;
+			}
+		}
+	});
+
+	if (OutOfRange) {
+		return -1;
+	}
+
+	return ResizeFlag;
+}
+
 //******************************************************************************
 //
 // CalcQuad_UL_UR_LL_LR_l2r_t2b
@@ -1,2 +1,4 @@
 #pragma once
 int CalculateReOrder(int x, int y, int Xsize, int Ysize, int Algorithm, int P1, int P2, int P3, int* ResizeFlag);
+
+int ComputeReorderTable(int* AddressTable, int Xsize, int Ysize, int Algorithm, int P1, int P2, int P3);
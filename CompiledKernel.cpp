@@ -0,0 +1,385 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// CompiledKernel.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Compiled reordering kernel files
+//
+// Exploring a message means running PixelReorder and BlockReorder with the
+// same reordering kernel file over and over.  Each run parses the text file,
+// converts the linear formats to the relative format and, for PixelReorder,
+// builds the same decom address table for the same image size.
+//
+// After a kernel file has been read the parsed kernels are saved in a binary
+// file next to it, <kernel file>.rkc.  The next run maps that file and copies
+// the kernels out of it instead of parsing the text file.  PixelReorder (not
+// batch) also stores the decom address table for the image size it was run
+// with, so the next run on an image of that size copies the table instead of
+// computing it.
+//
+// The compiled file layout:
+//	COMPILEDKERNELHEADER
+//	int DecomX[DecomXsize*DecomYsize*NumKernels]	relative format
+//	int DecomY[DecomXsize*DecomYsize*NumKernels]
+//	int DecomAddress[Xsize*Ysize]					only when Xsize*Ysize != 0
+//
+// The compiled file records the size and last write time of the kernel file,
+// it is ignored when the kernel file has changed.  A compiled file made in
+// batch mode has all the kernels, it can be used with batch mode on or off.
+// A compiled file made with batch mode off only has the first kernel.
+// Adding the decom address table to a batch compiled file keeps all the
+// kernels.
+//
+// The compiled file is only a copy of the text file.  Any failure to read or
+// write it means the text file is read as usual.
+//
+// V1.3.2.1 2026-10-14  Initial release
+//                      Correction, PixelReorder (not batch) keeps the kernels of a batch compiled file
+//
+#include "framework.h"
+#include <stdio.h>
+#include <strsafe.h>
+#include <vector>
+#include "AppErrors.h"
+#include "Imaging.h"
+#include "ImageIO.h"
+#include "CompiledKernel.h"
+
+#define COMPILEDKERNEL_ID		0x434b5252			// 'RRKC'
+#define COMPILEDKERNEL_VERSION	1
+#define COMPILEDKERNEL_MAXTABLE	(16*1024*1024)		// largest decom address table saved, # of entries
+
+#pragma pack(push, 1)
+typedef struct COMPILEDKERNELHEADER {
+	DWORD ID;				// COMPILEDKERNEL_ID
+	LONG32 Version;			// COMPILEDKERNEL_VERSION
+	ULONGLONG SourceSize;	// size of the kernel text file
+	ULONGLONG SourceTime;	// last write time of the kernel text file
+	LONG32 Batch;			// 1 - all the kernels in the file, 0 - only the first kernel
+	LONG32 DecomXsize;		// kernel size
+	LONG32 DecomYsize;
+	LONG32 NumKernels;		// # of kernels
+	LONG32 Xsize;			// image size of the decom address table
+	LONG32 Ysize;			// 0 - no table
+} COMPILEDKERNELHEADER;
+#pragma pack(pop)
+
+static BOOL GetSourceInfo(WCHAR* TextInput, ULONGLONG* Size, ULONGLONG* WriteTime);
+static int MapCompiledKernels(WCHAR* TextInput, IMAGEFILEMAP* Map, const COMPILEDKERNELHEADER** HeaderPtr);
+
+//*****************************************************************************************
+//
+//	LoadCompiledKernels
+//
+//	Read the reordering kernels from the compiled copy of a kernel file
+//
+// Parameters:
+//	WCHAR* TextInput		reordering kernel text file
+//	int EnableBatch			1 - all the kernels, 0 - only the first kernel
+//	int** DecomXptr			receives the kernels in the relative format as
+//	int** DecomYptr			ReadReoderingFile() returns them, the caller deletes these
+//	int* DecomXsize			receives the kernel size
+//	int* DecomYsize
+//
+//  return value:
+//  > 0 - # of kernels
+//  <= 0 - there is no compiled copy that is up to date, see standardized app error list
+//
+//*****************************************************************************************
+int LoadCompiledKernels(WCHAR* TextInput, int EnableBatch, int** DecomXptr, int** DecomYptr,
+	int* DecomXsize, int* DecomYsize)
+{
+	IMAGEFILEMAP Map;
+	const COMPILEDKERNELHEADER* Header;
+	int iRes;
+
+	iRes = MapCompiledKernels(TextInput, &Map, &Header);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+	if (EnableBatch && !Header->Batch) {
+		// only has the first kernel
+		UnmapImageFile(&Map);
+		return APPERR_FILETYPE;
+	}
+
+	int NumKernels = EnableBatch ? Header->NumKernels : 1;
+	size_t KernelSize = (size_t)Header->DecomXsize * (size_t)Header->DecomYsize;
+	const int* StoredX = (const int*)(Map.View + sizeof(COMPILEDKERNELHEADER));
+	const int* StoredY = StoredX + KernelSize * (size_t)Header->NumKernels;
+
+	int* DecomX = new int[KernelSize * (size_t)NumKernels];
+	if (DecomX == NULL) {
+		UnmapImageFile(&Map);
+		return APPERR_MEMALLOC;
+	}
+	int* DecomY = new int[KernelSize * (size_t)NumKernels];
+	if (DecomY == NULL) {
+		delete[] DecomX;
+		UnmapImageFile(&Map);
+		return APPERR_MEMALLOC;
+	}
+	memcpy(DecomX, StoredX, KernelSize * (size_t)NumKernels * sizeof(int));
+	memcpy(DecomY, StoredY, KernelSize * (size_t)NumKernels * sizeof(int));
+
+	*DecomXsize = Header->DecomXsize;
+	*DecomYsize = Header->DecomYsize;
+	*DecomXptr = DecomX;
+	*DecomYptr = DecomY;
+	UnmapImageFile(&Map);
+	return NumKernels;
+}
+
+//*****************************************************************************************
+//
+//	SaveCompiledKernels
+//
+//	Save the compiled copy of a kernel file.  The file is written under a
+//	temporary name and then renamed so a run in another thread or process
+//	never maps a partly written file.  Failures are ignored.
+//
+// Parameters:
+//	WCHAR* TextInput		reordering kernel text file
+//	int EnableBatch			1 - DecomX,DecomY are all the kernels in the file
+//							0 - only the first kernel
+//	int* DecomX				kernels in the relative format
+//	int* DecomY
+//	int DecomXsize			kernel size
+//	int DecomYsize
+//	int NumKernels			# of kernels in DecomX,DecomY
+//	int* DecomAddress		decom address table from ComputeReordering(), NULL for none
+//	int Xsize				image size of DecomAddress
+//	int Ysize
+//
+//*****************************************************************************************
+void SaveCompiledKernels(WCHAR* TextInput, int EnableBatch, int* DecomX, int* DecomY,
+	int DecomXsize, int DecomYsize, int NumKernels, int* DecomAddress, int Xsize, int Ysize)
+{
+	COMPILEDKERNELHEADER Header;
+	WCHAR Filename[MAX_PATH];
+	WCHAR TempFilename[MAX_PATH];
+	FILE* Out;
+	errno_t ErrNum;
+
+	if (NumKernels <= 0 || DecomXsize <= 0 || DecomYsize <= 0) {
+		return;
+	}
+	memset(&Header, 0, sizeof(Header));
+	if (!GetSourceInfo(TextInput, &Header.SourceSize, &Header.SourceTime)) {
+		return;
+	}
+	if (DecomAddress == NULL || Xsize <= 0 || Ysize <= 0 ||
+			(size_t)Xsize * (size_t)Ysize > COMPILEDKERNEL_MAXTABLE) {
+		DecomAddress = NULL;
+		Xsize = 0;
+		Ysize = 0;
+	}
+	if (FAILED(StringCchPrintf(Filename, MAX_PATH, L"%s.rkc", TextInput)) ||
+		FAILED(StringCchPrintf(TempFilename, MAX_PATH, L"%s.%u.tmp", Filename, (unsigned)GetCurrentThreadId()))) {
+		return;
+	}
+
+	Header.ID = COMPILEDKERNEL_ID;
+	Header.Version = COMPILEDKERNEL_VERSION;
+	Header.Batch = EnableBatch ? 1 : 0;
+	Header.DecomXsize = DecomXsize;
+	Header.DecomYsize = DecomYsize;
+	Header.NumKernels = NumKernels;
+	Header.Xsize = Xsize;
+	Header.Ysize = Ysize;
+
+	ErrNum = _wfopen_s(&Out, TempFilename, L"wb");
+	if (!Out) {
+		return;
+	}
+	size_t Entries = (size_t)DecomXsize * (size_t)DecomYsize * (size_t)NumKernels;
+	size_t TableSize = (size_t)Xsize * (size_t)Ysize;
+	BOOL Written = fwrite(&Header, sizeof(Header), 1, Out) == 1 &&
+		fwrite(DecomX, sizeof(int), Entries, Out) == Entries &&
+		fwrite(DecomY, sizeof(int), Entries, Out) == Entries &&
+		(TableSize == 0 || fwrite(DecomAddress, sizeof(int), TableSize, Out) == TableSize);
+	if (fclose(Out) != 0) {
+		Written = FALSE;
+	}
+
+	if (!Written || !MoveFileEx(TempFilename, Filename, MOVEFILE_REPLACE_EXISTING)) {
+		DeleteFile(TempFilename);
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	CompiledReordering
+//
+//	ComputeReordering() with the decom address table kept in the compiled copy
+//	of the kernel file.  The table is copied from the compiled file when it was
+//	made for this kernel and image size, otherwise it is computed and saved.
+//
+// Parameters:
+//	WCHAR* TextInput		reordering kernel text file
+//	int* DecomAddress		receives Xsize*Ysize addresses
+//	int Xsize				image size
+//	int Ysize
+//	int* DecomX				kernel from ReadReoderingFile()
+//	int* DecomY
+//	int DecomXsize			kernel size
+//	int DecomYsize
+//
+//*****************************************************************************************
+void CompiledReordering(WCHAR* TextInput, int* DecomAddress, int Xsize, int Ysize,
+	int* DecomX, int* DecomY, int DecomXsize, int DecomYsize)
+{
+	IMAGEFILEMAP Map;
+	const COMPILEDKERNELHEADER* Header;
+	size_t TotalSize = (size_t)Xsize * (size_t)Ysize;
+	size_t KernelSize = (size_t)DecomXsize * (size_t)DecomYsize;
+	std::vector<int> BatchX;
+	std::vector<int> BatchY;
+	int BatchKernels = 0;
+
+	if (MapCompiledKernels(TextInput, &Map, &Header) == APP_SUCCESS) {
+		const int* StoredX = (const int*)(Map.View + sizeof(COMPILEDKERNELHEADER));
+		size_t StoredSize = (size_t)Header->DecomXsize * (size_t)Header->DecomYsize * (size_t)Header->NumKernels;
+		const int* StoredY = StoredX + StoredSize;
+		const int* Table = StoredY + StoredSize;
+
+		// the table is only good for the same first kernel
+		if (Header->DecomXsize == DecomXsize && Header->DecomYsize == DecomYsize &&
+				memcmp(StoredX, DecomX, KernelSize * sizeof(int)) == 0 &&
+				memcmp(StoredY, DecomY, KernelSize * sizeof(int)) == 0) {
+			if (Header->Xsize == Xsize && Header->Ysize == Ysize) {
+				// copy the table and make sure every address is in the image
+				size_t i;
+				for (i = 0; i < TotalSize; i++) {
+					if (Table[i] < 0 || (size_t)Table[i] >= TotalSize) {
+						break;
+					}
+					DecomAddress[i] = Table[i];
+				}
+				if (i == TotalSize) {
+					UnmapImageFile(&Map);
+					return;
+				}
+			}
+			// a batch compiled file keeps all of its kernels when the table
+			// is saved, otherwise batch and non batch runs keep replacing it
+			if (Header->Batch) {
+				BatchKernels = Header->NumKernels;
+				BatchX.assign(StoredX, StoredX + KernelSize * (size_t)BatchKernels);
+				BatchY.assign(StoredY, StoredY + KernelSize * (size_t)BatchKernels);
+			}
+		}
+		UnmapImageFile(&Map);
+	}
+
+	ComputeReordering(DecomAddress, Xsize, Ysize, DecomX, DecomY, DecomXsize, DecomYsize);
+	if (TotalSize <= COMPILEDKERNEL_MAXTABLE) {
+		if (BatchKernels > 0) {
+			SaveCompiledKernels(TextInput, 1, BatchX.data(), BatchY.data(), DecomXsize, DecomYsize,
+				BatchKernels, DecomAddress, Xsize, Ysize);
+		}
+		else {
+			SaveCompiledKernels(TextInput, 0, DecomX, DecomY, DecomXsize, DecomYsize, 1,
+				DecomAddress, Xsize, Ysize);
+		}
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	GetSourceInfo
+//
+//	size and last write time of a kernel file
+//
+//  return value:
+//  TRUE - file exists
+//
+//*****************************************************************************************
+static BOOL GetSourceInfo(WCHAR* TextInput, ULONGLONG* Size, ULONGLONG* WriteTime)
+{
+	WIN32_FILE_ATTRIBUTE_DATA FileInfo;
+
+	if (!GetFileAttributesEx(TextInput, GetFileExInfoStandard, &FileInfo)) {
+		return FALSE;
+	}
+	*Size = ((ULONGLONG)FileInfo.nFileSizeHigh << 32) | (ULONGLONG)FileInfo.nFileSizeLow;
+	*WriteTime = ((ULONGLONG)FileInfo.ftLastWriteTime.dwHighDateTime << 32) |
+		(ULONGLONG)FileInfo.ftLastWriteTime.dwLowDateTime;
+	return TRUE;
+}
+
+//*****************************************************************************************
+//
+//	MapCompiledKernels
+//
+//	Map the compiled copy of a kernel file and check it is complete and
+//	up to date with the kernel file
+//
+// Parameters:
+//	WCHAR* TextInput		reordering kernel text file
+//	IMAGEFILEMAP* Map		receives the view of the compiled file,
+//							release it with UnmapImageFile()
+//	const COMPILEDKERNELHEADER** HeaderPtr	receives the header at the start of the view
+//
+//  return value:
+//  1 - Success
+//  !=1 no compiled file or it is out of date, nothing is mapped
+//
+//*****************************************************************************************
+static int MapCompiledKernels(WCHAR* TextInput, IMAGEFILEMAP* Map, const COMPILEDKERNELHEADER** HeaderPtr)
+{
+	WCHAR Filename[MAX_PATH];
+	ULONGLONG SourceSize;
+	ULONGLONG SourceTime;
+	int iRes;
+
+	if (!GetSourceInfo(TextInput, &SourceSize, &SourceTime)) {
+		return APPERR_FILEOPEN;
+	}
+	if (FAILED(StringCchPrintf(Filename, MAX_PATH, L"%s.rkc", TextInput))) {
+		return APPERR_FILEOPEN;
+	}
+	iRes = MapImageFile(Filename, Map);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	ULONGLONG FileSize = (ULONGLONG)Map->FileSize;
+	const COMPILEDKERNELHEADER* Header = (const COMPILEDKERNELHEADER*)Map->View;
+	if (FileSize < sizeof(COMPILEDKERNELHEADER) ||
+			Header->ID != COMPILEDKERNEL_ID || Header->Version != COMPILEDKERNEL_VERSION ||
+			Header->SourceSize != SourceSize || Header->SourceTime != SourceTime ||
+			Header->DecomXsize <= 0 || Header->DecomYsize <= 0 || Header->NumKernels <= 0 ||
+			(!Header->Batch && Header->NumKernels != 1) ||
+			Header->Xsize < 0 || Header->Ysize < 0) {
+		UnmapImageFile(Map);
+		return APPERR_FILETYPE;
+	}
+
+	// the sizes in the header must add up to the file size
+	ULONGLONG Entries = (ULONGLONG)Header->DecomXsize * (ULONGLONG)Header->DecomYsize;
+	ULONGLONG TableSize = (ULONGLONG)Header->Xsize * (ULONGLONG)Header->Ysize;
+	if (Entries > FileSize / (ULONGLONG)Header->NumKernels || TableSize > FileSize ||
+			sizeof(COMPILEDKERNELHEADER) + (2 * Entries * (ULONGLONG)Header->NumKernels + TableSize) * sizeof(int) != FileSize) {
+		UnmapImageFile(Map);
+		return APPERR_FILESIZE;
+	}
+
+	*HeaderPtr = Header;
+	return APP_SUCCESS;
+}
@@ -0,0 +1,14 @@
+#pragma once
+//
+// CompiledKernel.h
+// function prototypes for the compiled reordering kernel files in CompiledKernel.cpp
+//
+
+int LoadCompiledKernels(WCHAR* TextInput, int EnableBatch, int** DecomXptr, int** DecomYptr,
+	int* DecomXsize, int* DecomYsize);
+
+void SaveCompiledKernels(WCHAR* TextInput, int EnableBatch, int* DecomX, int* DecomY,
+	int DecomXsize, int DecomYsize, int NumKernels, int* DecomAddress, int Xsize, int Ysize);
+
+void CompiledReordering(WCHAR* TextInput, int* DecomAddress, int Xsize, int Ysize,
+	int* DecomX, int* DecomY, int DecomXsize, int DecomYsize);
@@ -0,0 +1,360 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// Convolution.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Convolution engine used by ConvolveImage()
+//
+// The original convolution calculated each output pixel separately with
+// CalculateConvPixel().  This calculates a row of output pixels at a time.
+// For each kernel entry the weighted input row is added to a row of
+// accumulators.  These are simple unit stride loops that the compiler
+// vectorizes.  The kernel entries are applied in the same order as
+// CalculateConvPixel() did and the float sum is rounded through a double
+// the same way, so the results are the same.
+//
+// If the kernel is separable (every row of the kernel is a multiple of the same
+// row vector) the convolution is done as a horizontal 1D pass followed
+// by a vertical 1D pass.  This reduces the number of multiplies per pixel
+// from KernelXsize*KernelYsize to KernelXsize+KernelYsize.  Since the sums are
+// done in a different order, and the kernel file values are rounded, an output
+// pixel can differ by 1 from the 2D calculation when the result is close to
+// the rounding point.
+//
+// The output rows of all the frames are split into bands that are processed
+// in parallel.
+//
+// The output image has the same border as the original Convolve(), pixels
+// where the kernel does not fit inside of the image are not changed.
+//
+// V1.3.2.1 2026-10-14  Initial release, row blocked, separable and multithreaded convolution
+//                      Correction, output pixels are rounded through a double as CalculateConvPixel() did,
+//                      CalculateConvPixel() removed
+//
+#include "framework.h"
+#include <math.h>
+#include "Parallel.h"
+#include "Convolution.h"
+
+// the separable convolution is only used if the largest possible change
+// in an output pixel from separating the kernel is less than this
+#define SEPARABLE_TOLERANCE 0.25f
+
+static void ConvolveRows(float* Kernel, int KernelXsize, int KernelYsize, int* Image, int* NewImage,
+	int xsize, int StartX, int EndX, int StartRow, int EndRow, float* Accumulator);
+
+static void ConvolveRowsSeparable(float* RowKernel, float* ColumnKernel, int KernelXsize, int KernelYsize,
+	int* Image, int* NewImage, int xsize, int StartX, int EndX, int StartRow, int EndRow,
+	float* Accumulator, float* RowPass);
+
+//*****************************************************************************************
+//
+//	SeparateKernel
+//
+//	Split the 2D kernel into the product of a column vector and a row vector,
+//		Kernel[y*KernelXsize + x] ~= ColumnKernel[y] * RowKernel[x]
+//	The kernel files are text with a limited number of digits so a separable
+//	kernel is usually not exactly the product of the 2 vectors.  The sum of the
+//	absolute differences is returned so that the caller can decide if the
+//	separable result is close enough.
+//
+// Parameters:
+//	float* Kernel			KernelXsize by KernelYsize kernel
+//	int KernelXsize			kernel x size
+//	int KernelYsize			kernel y size
+//	float* RowKernel		receives the KernelXsize row vector
+//	float* ColumnKernel		receives the KernelYsize column vector
+//
+//  return value:
+//  >=0 sum of the absolute differences between the kernel and the
+//		product of RowKernel and ColumnKernel
+//  <0  kernel is all 0, can't be separated
+//
+//*****************************************************************************************
+float SeparateKernel(float* Kernel, int KernelXsize, int KernelYsize, float* RowKernel, float* ColumnKernel)
+{
+	int PivotX = 0;
+	int PivotY = 0;
+	float MaxValue = 0.0f;
+	float Pivot;
+	float Residual;
+
+	// use the largest kernel entry as the pivot
+	for (int y = 0; y < KernelYsize; y++) {
+		for (int x = 0; x < KernelXsize; x++) {
+			if (fabsf(Kernel[y * KernelXsize + x]) > MaxValue) {
+				MaxValue = fabsf(Kernel[y * KernelXsize + x]);
+				PivotX = x;
+				PivotY = y;
+			}
+		}
+	}
+	if (MaxValue == 0.0f) {
+		return -1.0f;
+	}
+
+	Pivot = Kernel[PivotY * KernelXsize + PivotX];
+	for (int x = 0; x < KernelXsize; x++) {
+		RowKernel[x] = Kernel[PivotY * KernelXsize + x] / Pivot;
+	}
+	for (int y = 0; y < KernelYsize; y++) {
+		ColumnKernel[y] = Kernel[y * KernelXsize + PivotX];
+	}
+
+	Residual = 0.0f;
+	for (int y = 0; y < KernelYsize; y++) {
+		for (int x = 0; x < KernelXsize; x++) {
+			Residual += fabsf(Kernel[y * KernelXsize + x] - ColumnKernel[y] * RowKernel[x]);
+		}
+	}
+
+	return Residual;
+}
+
+//*****************************************************************************************
+//
+//	ConvolveFrames
+//
+//	Convolve all the frames of an image with the kernel.  NewImage must be
+//	initialized by the caller since the border pixels are not written.
+//
+// Parameters:
+//	float* Kernel			KernelXsize by KernelYsize kernel
+//	int KernelXsize			kernel x size
+//	int KernelYsize			kernel y size
+//	int* Image				input image, NumFrames of xsize by ysize
+//	int* NewImage			output image, same size as the input image
+//	int xsize				image x size
+//	int ysize				image y size
+//	int NumFrames			number of frames in the image
+//
+//  return value: none
+//
+//*****************************************************************************************
+void ConvolveFrames(float* Kernel, int KernelXsize, int KernelYsize, int* Image, int* NewImage,
+	int xsize, int ysize, int NumFrames)
+{
+	int StartX, EndX;
+	int StartY, EndY;
+	int Separable;
+	int MaxPixel;
+	float Residual;
+	float* RowKernel;
+	float* ColumnKernel;
+
+	// same output area as the original Convolve()
+	if (KernelXsize % 2) {
+		StartX = KernelXsize / 2 + 1;
+	}
+	else {
+		StartX = KernelXsize / 2;
+	}
+	EndX = xsize - StartX;
+
+	if (KernelYsize % 2) {
+		StartY = KernelYsize / 2 + 1;
+	}
+	else {
+		StartY = KernelYsize / 2;
+	}
+	EndY = ysize - StartY;
+
+	if (StartX >= EndX || StartY >= EndY) {
+		// kernel does not fit in the image
+		return;
+	}
+
+	RowKernel = new float[KernelXsize];
+	ColumnKernel = new float[KernelYsize];
+	Separable = FALSE;
+	if (RowKernel != NULL && ColumnKernel != NULL && KernelXsize > 1 && KernelYsize > 1) {
+		Residual = SeparateKernel(Kernel, KernelXsize, KernelYsize, RowKernel, ColumnKernel);
+		if (Residual >= 0.0f) {
+			// largest change in an output pixel from using the separated kernel
+			MaxPixel = 0;
+			for (size_t i = 0; i < (size_t)xsize * (size_t)ysize * (size_t)NumFrames; i++) {
+				if (abs(Image[i]) > MaxPixel) {
+					MaxPixel = abs(Image[i]);
+				}
+			}
+			if (Residual * (float)MaxPixel <= SEPARABLE_TOLERANCE) {
+				Separable = TRUE;
+			}
+		}
+	}
+
+	// split the output rows of all the frames into bands
+	ParallelFor(0, NumFrames * (EndY - StartY), [&](int StartBand, int EndBand) {
+		float* Accumulator;
+		float* RowPass = NULL;
+		int Frame;
+		int FirstRow;
+		int LastRow;
+		size_t FrameOffset;
+
+		Accumulator = new float[(size_t)xsize];
+		if (Separable) {
+			RowPass = new float[(size_t)(EndBand - StartBand + KernelYsize) * (size_t)xsize];
+		}
+
+		for (int Row = StartBand; Row < EndBand; Row = LastRow - StartY + Frame * (EndY - StartY)) {
+			// process the rows of the band that are in this frame
+			Frame = Row / (EndY - StartY);
+			FirstRow = StartY + Row % (EndY - StartY);
+			LastRow = FirstRow + (EndBand - Row);
+			if (LastRow > EndY) {
+				LastRow = EndY;
+			}
+			FrameOffset = (size_t)Frame * (size_t)xsize * (size_t)ysize;
+
+			if (Separable) {
+				ConvolveRowsSeparable(RowKernel, ColumnKernel, KernelXsize, KernelYsize,
+					Image + FrameOffset, NewImage + FrameOffset, xsize, StartX, EndX,
+					FirstRow, LastRow, Accumulator, RowPass);
+			}
+			else {
+				ConvolveRows(Kernel, KernelXsize, KernelYsize, Image + FrameOffset, NewImage + FrameOffset,
+					xsize, StartX, EndX, FirstRow, LastRow, Accumulator);
+			}
+		}
+
+		delete[] Accumulator;
+		if (RowPass != NULL) {
+			delete[] RowPass;
+		}
+	});
+
+	delete[] RowKernel;
+	delete[] ColumnKernel;
+	return;
+}
+
+//*****************************************************************************************
+//
+//	ConvolveRows
+//
+//	private function for ConvolveFrames()
+//
+//	2D convolution of output rows StartRow to EndRow-1 of one frame
+//	Accumulator is a work buffer of xsize floats
+//
+//*****************************************************************************************
+static void ConvolveRows(float* Kernel, int KernelXsize, int KernelYsize, int* Image, int* NewImage,
+	int xsize, int StartX, int EndX, int StartRow, int EndRow, float* Accumulator)
+{
+	int* InputRow;
+	int* OutputRow;
+	int XOffset;
+	float Weight;
+
+	for (int y = StartRow; y < EndRow; y++) {
+		for (int x = StartX; x < EndX; x++) {
+			Accumulator[x] = 0.0f;
+		}
+
+		// add each kernel entry times its shifted input row
+		for (int i = 0; i < KernelYsize; i++) {
+			InputRow = Image + (size_t)(y - KernelYsize / 2 + i) * (size_t)xsize;
+			for (int j = 0; j < KernelXsize; j++) {
+				Weight = Kernel[j + (i * KernelXsize)];
+				XOffset = j - KernelXsize / 2;
+				for (int x = StartX; x < EndX; x++) {
+					Accumulator[x] += Weight * (float)InputRow[x + XOffset];
+				}
+			}
+		}
+
+		OutputRow = NewImage + (size_t)y * (size_t)xsize;
+		for (int x = StartX; x < EndX; x++) {
+			if (Accumulator[x] < 0.0f) {
+				OutputRow[x] = 0;
+			}
+			else {
+				OutputRow[x] = (int)((double)Accumulator[x] + 0.5);
+			}
+		}
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	ConvolveRowsSeparable
+//
+//	private function for ConvolveFrames()
+//
+//	Separable convolution of output rows StartRow to EndRow-1 of one frame.
+//	The horizontal pass is done for all the input rows needed by the band
+//	and saved in RowPass, then the vertical pass is done for each output row.
+//	Accumulator is a work buffer of xsize floats, RowPass is a work buffer of
+//	(EndRow-StartRow+KernelYsize-1)*xsize floats
+//
+//*****************************************************************************************
+static void ConvolveRowsSeparable(float* RowKernel, float* ColumnKernel, int KernelXsize, int KernelYsize,
+	int* Image, int* NewImage, int xsize, int StartX, int EndX, int StartRow, int EndRow,
+	float* Accumulator, float* RowPass)
+{
+	int FirstInputRow;
+	int NumInputRows;
+	int* InputRow;
+	int* OutputRow;
+	int XOffset;
+	float* PassRow;
+	float Weight;
+
+	// horizontal pass
+	FirstInputRow = StartRow - KernelYsize / 2;
+	NumInputRows = EndRow - StartRow + KernelYsize - 1;
+	for (int r = 0; r < NumInputRows; r++) {
+		InputRow = Image + (size_t)(FirstInputRow + r) * (size_t)xsize;
+		PassRow = RowPass + (size_t)r * (size_t)xsize;
+		for (int x = StartX; x < EndX; x++) {
+			PassRow[x] = 0.0f;
+		}
+		for (int j = 0; j < KernelXsize; j++) {
+			Weight = RowKernel[j];
+			XOffset = j - KernelXsize / 2;
+			for (int x = StartX; x < EndX; x++) {
+				PassRow[x] += Weight * (float)InputRow[x + XOffset];
+			}
+		}
+	}
+
+	// vertical pass
+	for (int y = StartRow; y < EndRow; y++) {
+		for (int x = StartX; x < EndX; x++) {
+			Accumulator[x] = 0.0f;
+		}
+		for (int i = 0; i < KernelYsize; i++) {
+			Weight = ColumnKernel[i];
+			PassRow = RowPass + (size_t)(y - StartRow + i) * (size_t)xsize;
+			for (int x = StartX; x < EndX; x++) {
+				Accumulator[x] += Weight * PassRow[x];
+			}
+		}
+
+		OutputRow = NewImage + (size_t)y * (size_t)xsize;
+		for (int x = StartX; x < EndX; x++) {
+			if (Accumulator[x] < 0.0f) {
+				OutputRow[x] = 0;
+			}
+			else {
+				OutputRow[x] = (int)((double)Accumulator[x] + 0.5);
+			}
+		}
+	}
+	return;
+}
@@ -0,0 +1,10 @@
+#pragma once
+//
+// Convolution.h
+// function prototypes for the convolution engine in Convolution.cpp
+//
+
+float SeparateKernel(float* Kernel, int KernelXsize, int KernelYsize, float* RowKernel, float* ColumnKernel);
+
+void ConvolveFrames(float* Kernel, int KernelXsize, int KernelYsize, int* Image, int* NewImage,
+	int xsize, int ysize, int NumFrames);
@@ -63,6 +63,17 @@
 // V1.3.1.1 2023-12-6   Corrected setting options in FileOpen and FileSave.  This does not have actual impact
 //                      on the existing application since it doesn't use the Folders only option.
 //                      Replaced application error numbers with #define to improve clarity
+// V1.3.2.1 2026-10-14  Changed, Display image file loads the image directly into the image window
+//                      instead of converting it to the BMP results file
+//                      Added, DisplayImageFrame() to display an image already in memory
+//                      Display image file pages through the frames, PgUp/PgDn
+//                      Display from a background job is done on the UI thread
+//                      Changed, SaveBMP with AutoPNG encodes the PNG from the BMP image in memory
+//                      on the PNG encode queue (PngWriter.cpp) instead of reloading the BMP file
+//                      Changed, SaveBMP2PNG no longer uses GDI+
+//                      Added, WaitAutoPNG() reports the errors of the queued .png files
+//                      Changed, SaveBMP queues the .png for the PngBatch of the operation,
+//                        WaitAutoPNG() only reports the errors of that batch
 //
 #include "framework.h"
 #include "resource.h"
@@ -70,13 +81,17 @@
 #include <winver.h>
 #include <vector>
 #include <atlstr.h>
-#include <gdiplus.h>
 #include <strsafe.h>
 #include "AppErrors.h"
 #include "ImageDialog.h"
 #include "globals.h"
 #include "imaging.h"
 #include "FileFunctions.h"
+#include "JobRunner.h"
+#include "PngWriter.h"
+
+static int BMPimage2PNG(WCHAR* Filename, const BYTE* BMPimage, int Width, int Height, int Stride,
+    int BitCount, BOOL TopDown, const RGBQUAD* ColorTable, PngBatch* Batch);
 
 //****************************************************************
 //
@@ -420,26 +435,31 @@ int DisplayImage(WCHAR* Filename)
 {
     // determine if .BMP or .RAW file type by examing the header
     // record in the file.
-    // if the file is an image file ten convert it to a BMP
-    // file in order to dusplay it.  Use the filename in global
-    // szBMPFilename then update the image.  If iot is a BMP file
+    // if the file is an image file then it is displayed one frame
+    // at a time, only the displayed frame is decoded.  If it is a BMP file
     // then copy it to the filename in global szBMPFilename.
     IMAGINGHEADER ImageHeader;
     size_t iRes;
 
+    // a job displays its results through the UI thread
+    if (IsJobThread()) {
+        return RunOnUIThread([&]() { return DisplayImage(Filename); });
+    }
+
     iRes = ReadImageHeader(Filename, &ImageHeader);
     if (iRes== 1) {
         // this is a image file
-        // convert to BMP file
-        iRes = SaveBMP(szBMPFilename, Filename, DefaultRBG, AutoScaleResults);
-        if (iRes !=1) {
-            return (int) iRes;
+        // load it directly into the image window
+        if (hwndImage == NULL) {
+            return APP_SUCCESS;
         }
-        if (hwndImage != NULL) {
-            SendMessage(hwndImage, WM_COMMAND, IDC_GENERATE_BMP, 0l);
-            ShowWindow(hwndImage, SW_SHOW);
-            // todo:
+
+        iRes = ImgDlg->OpenFrameFile(Filename, DefaultRBG, AutoScaleResults);
+        if (iRes != APP_SUCCESS) {
+            return (int) iRes;
         }
+        SendMessage(hwndImage, WM_COMMAND, IDC_UPDATE_IMAGE, 0l);
+        ShowWindow(hwndImage, SW_SHOW);
         return APP_SUCCESS;
     }
 
@@ -471,12 +491,57 @@ int DisplayImage(WCHAR* Filename)
     }
 
     if (hwndImage != NULL) {
+        ImgDlg->CloseFrameFile();
         SendMessage(hwndImage, WM_COMMAND, IDC_GENERATE_BMP, 0l);
         ShowWindow(hwndImage, SW_SHOW);
     }
     return APP_SUCCESS;
 }
 
+//****************************************************************
+//
+//  DisplayImageFrame
+// 
+//  Display an image that is already in memory in the image
+//  display window.  This is used to display results without
+//  writing and reading back a BMP file.  A BMP file is only
+//  created when it is exported.
+// 
+//  Parmeters:
+//      Image - image pixels, all frames
+//      Header - image header for Image
+// 
+//  return value:
+//  1 - Success
+//  see standardized app error list at top of this source file
+//
+//****************************************************************
+int DisplayImageFrame(const int* Image, IMAGINGHEADER* Header)
+{
+    int iRes;
+
+    // a job displays its results through the UI thread
+    if (IsJobThread()) {
+        return RunOnUIThread([&]() { return DisplayImageFrame(Image, Header); });
+    }
+
+    if (hwndImage == NULL) {
+        return APP_SUCCESS;
+    }
+
+    // the result replaces any image file being paged through
+    ImgDlg->CloseFrameFile();
+    iRes = ImgDlg->LoadImageFrame(Image, Header, DefaultRBG, AutoScaleResults);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
+
+    SendMessage(hwndImage, WM_COMMAND, IDC_UPDATE_IMAGE, 0l);
+    ShowWindow(hwndImage, SW_SHOW);
+
+    return APP_SUCCESS;
+}
+
 //****************************************************************
 //
 //  This function is called from the main app message handler in response
@@ -619,7 +684,10 @@ void ExportFile(HWND hWnd, int wmId)
 
     // convert to file
     if (wmId == IDM_FILE_TOBMP) {
-        SaveBMP(szString, InputFile,RGBframes, AutoScale);
+        PngBatch PngFiles;
+
+        SaveBMP(szString, InputFile,RGBframes, AutoScale, &PngFiles);
+        WaitAutoPNG(hWnd, &PngFiles);
         wcscpy_s(szCurrentFilename, szString);
         if (DisplayResults) {
             DisplayImage(szCurrentFilename);
@@ -646,6 +714,8 @@ void ExportFile(HWND hWnd, int wmId)
 //                  This flag is ignored if the # of frames in the
 //                  image is not a multiple of 3.
 //      AutoScale - auto scale the output image
+//      Batch - batch of the operation for the AutoPNG .png file,
+//              NULL writes the .png file before returning
 // 
 //  Xsize of image must be <= 8192
 // 
@@ -668,13 +738,16 @@ void ExportFile(HWND hWnd, int wmId)
 //          from the others. Only the first 3 frames are used.
 //
 //  If input image is odd columns in size it is 0 padded to even size.
+//
+//  With AutoPNG and a PngBatch the matching .png file is written later by
+//  the PNG encode queue, errors writing it are returned by WaitAutoPNG().
 //  
 //  return value:
 //  1 - Success
 //  see standardized app error list at top of this source file
 //
 //****************************************************************
-int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
+int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale, PngBatch* Batch)
 {
     int iRes;
     int* InputImage;
@@ -1067,26 +1140,56 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
     // write color map only if greyscale image
     if (!RGBframes) {
         fwrite(ColorTable, sizeof(RGBQUAD), 256, Out);
-        delete[] ColorTable;
     }
 
     // write the image data
-    int Address = 0;
-    for (int i = 0; i < (int)BMPimageBytes; i++) {
-        fwrite(&BMPimage[i], 1, 1, Out);
-        Address++;
-    }
-
-    free(BMPimage);
+    fwrite(BMPimage, 1, BMPimageBytes, Out);
     fclose(Out);
 
+    iRes = APP_SUCCESS;
     if (AutoPNG) {
-        if (SaveBMP2PNG(Filename) != 1) {
-            return APPERR_PARAMETER;
-        }
+        // the matching .png is encoded from the BMP image on the PNG encode queue
+        iRes = BMPimage2PNG(Filename, BMPimage, biWidth, ImageHeader.Ysize, (int)(BMPimageBytes / ImageHeader.Ysize),
+            RGBframes ? 24 : 8, TRUE, ColorTable, Batch);
     }
 
-    return APP_SUCCESS;
+    free(BMPimage);
+    if (ColorTable != NULL) {
+        delete[] ColorTable;
+    }
+
+    return iRes;
+}
+
+//****************************************************************
+//
+//  WaitAutoPNG
+// 
+//  Wait for the .png files queued by SaveBMP() with AutoPNG to be
+//  written and show the first error.  Called when an operation that
+//  saves BMP files is finished.
+//
+//  Parmeters:
+//      hWnd - window for the error message
+//      Batch - batch passed to SaveBMP() by the operation
+// 
+//  return value:
+//  1 - Success
+//  !=1 first error writing a .png file of the batch since the last call
+//
+//****************************************************************
+int WaitAutoPNG(HWND hWnd, PngBatch* Batch)
+{
+    int iRes;
+
+    iRes = WaitPNGBatch(Batch);
+    if (iRes != APP_SUCCESS) {
+        TCHAR pszMessageBuf[MAX_PATH];
+        StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH,
+            TEXT("Could not write the AutoPNG .png file\nError# %d\n"), iRes);
+        MessageBox(hWnd, pszMessageBuf, L"File I/O", MB_OK);
+    }
+    return iRes;
 }
 
 //****************************************************************
@@ -1763,100 +1866,143 @@ int GetFileSize(WCHAR* szString)
 
 //****************************************************************
 //
-//  GetEncoderClsid
+//  SaveBMP2PNG
 // 
-// This is based on a solution provided at:
-// https://learn.microsoft.com/en-us/windows/win32/gdiplus/-gdiplus-retrieving-the-class-identifier-for-an-encoder-use
+//  Write a .png file with the same name as a BMP file.  The BMP file
+//  must be an uncompressed 8 bpp (color map) or 24 bpp file, the types
+//  written by SaveBMP().
+//
+//  Parmeters:
+//      Filename - BMP file
 // 
+//  return value:
+//  1 - Success
+//  see standardized app error list at top of this source file
+//
 //****************************************************************
-// using namespace Gdiplus;
-INT GetEncoderClsid(const WCHAR* format, CLSID* pClsid);  // helper function
-
-INT GetEncoderClsid(const WCHAR* format, CLSID* pClsid) {
-    UINT  num = 0;          // number of image encoders
-    UINT  size = 0;         // size of the image encoder array in bytes
-
-    Gdiplus::ImageCodecInfo* pImageCodecInfo = NULL;
+int SaveBMP2PNG(WCHAR* Filename)
+{
+    BITMAPFILEHEADER BMPheader;
+    BITMAPINFOHEADER BMPinfoheader;
+    RGBQUAD ColorTable[256];
+    FILE* In;
+    errno_t ErrNum;
 
-    Gdiplus::GetImageEncodersSize(&num, &size);
-    if (size == 0)
-        return -1;  // Failure
+    ErrNum = _wfopen_s(&In, Filename, L"rb");
+    if (In == NULL) {
+        return APPERR_FILEOPEN;
+    }
 
-    pImageCodecInfo = (Gdiplus::ImageCodecInfo*)(malloc(size));
-    if (pImageCodecInfo == NULL)
-        return -1;  // Failure
+    if (fread(&BMPheader, sizeof(BMPheader), 1, In) != 1 ||
+        fread(&BMPinfoheader, sizeof(BMPinfoheader), 1, In) != 1) {
+        fclose(In);
+        return APPERR_FILEREAD;
+    }
+    if (BMPheader.bfType != 0x4d42 || BMPinfoheader.biSize < sizeof(BMPinfoheader) ||
+        BMPinfoheader.biCompression != BI_RGB || BMPinfoheader.biPlanes != 1 ||
+        (BMPinfoheader.biBitCount != 8 && BMPinfoheader.biBitCount != 24) ||
+        BMPinfoheader.biWidth <= 0 || BMPinfoheader.biWidth > 65536 ||
+        BMPinfoheader.biHeight == 0 || BMPinfoheader.biHeight < -65536 || BMPinfoheader.biHeight > 65536) {
+        fclose(In);
+        return APPERR_FILETYPE;
+    }
 
-    GetImageEncoders(num, size, pImageCodecInfo);
+    int Width = BMPinfoheader.biWidth;
+    int Height = BMPinfoheader.biHeight < 0 ? -BMPinfoheader.biHeight : BMPinfoheader.biHeight;
+    int Stride = ((((Width * BMPinfoheader.biBitCount) + 31) & ~31) >> 3);
 
-    for (UINT j = 0; j < num; ++j)
-    {
-        if (wcscmp(pImageCodecInfo[j].MimeType, format) == 0)
-        {
-            *pClsid = pImageCodecInfo[j].Clsid;
-            free(pImageCodecInfo);
-            return j;  // Success
+    // color map follows the info header, unused entries are black
+    memset(ColorTable, 0, sizeof(ColorTable));
+    if (BMPinfoheader.biBitCount == 8) {
+        DWORD NumColors = BMPinfoheader.biClrUsed == 0 ? 256 : BMPinfoheader.biClrUsed;
+        if (NumColors > 256 || fseek(In, sizeof(BMPheader) + BMPinfoheader.biSize, SEEK_SET) != 0 ||
+            fread(ColorTable, sizeof(RGBQUAD), NumColors, In) != NumColors) {
+            fclose(In);
+            return APPERR_FILETYPE;
         }
     }
 
-    free(pImageCodecInfo);
-    return -1;  // Failure
+    std::vector<BYTE> BMPimage((size_t)Stride * (size_t)Height);
+    if (fseek(In, BMPheader.bfOffBits, SEEK_SET) != 0 ||
+        fread(BMPimage.data(), 1, BMPimage.size(), In) != BMPimage.size()) {
+        fclose(In);
+        return APPERR_FILEREAD;
+    }
+    fclose(In);
+
+    return BMPimage2PNG(Filename, BMPimage.data(), Width, Height, Stride, BMPinfoheader.biBitCount,
+        BMPinfoheader.biHeight < 0, BMPinfoheader.biBitCount == 8 ? ColorTable : NULL, NULL);
 }
 
 //****************************************************************
 //
-//  SaveBMP2PNG
+//  BMPimage2PNG
 // 
-// This is based on a solution provided at:
-// https://learn.microsoft.com/en-us/windows/win32/gdiplus/-gdiplus-converting-a-bmp-image-to-a-png-image-use
+//  private function for SaveBMP() and SaveBMP2PNG()
+//
+//  Write the .png file that matches a BMP file from the BMP image data,
+//  see WritePNG() in PngWriter.cpp
+//
+//  Parmeters:
+//      Filename - BMP file, the .png has the same name
+//      BMPimage - BMP image data, Stride bytes per row
+//      Width, Height - image size in pixels
+//      Stride - bytes per row in BMPimage
+//      BitCount - 8 color map, 24 RGB (stored as blue, green, red)
+//      TopDown - TRUE BMPimage starts with the top row, FALSE bottom row (BMP default)
+//      ColorTable - 256 entry color map of an 8 bit image
+//      Batch - the PNG file is written by the PNG encode queue for this batch
+//              NULL, the PNG file is written before returning
 // 
+//  return value:
+//  1 - Success
+//  see standardized app error list at top of this source file
+//
 //****************************************************************
-// using namespace Gdiplus;
-
-int SaveBMP2PNG(WCHAR* Filename)
+static int BMPimage2PNG(WCHAR* Filename, const BYTE* BMPimage, int Width, int Height, int Stride,
+    int BitCount, BOOL TopDown, const RGBQUAD* ColorTable, PngBatch* Batch)
 {
-    // Initialize GDI+.
-    Gdiplus::GdiplusStartupInput gdiplusStartupInput;
-    ULONG_PTR gdiplusToken;
-    Gdiplus::GdiplusStartup(&gdiplusToken, &gdiplusStartupInput, NULL);
-
-    CLSID   encoderClsid;
-    Gdiplus::Status  stat;
+    int err;
+    WCHAR Drive[_MAX_DRIVE];
+    WCHAR Dir[_MAX_DIR];
+    WCHAR Fname[_MAX_FNAME];
+    WCHAR Ext[_MAX_EXT];
+    WCHAR PNGfilename[MAX_PATH];
 
-    // load BMP file to image
-    Gdiplus::Image* image = new Gdiplus::Image(Filename);
-
-    // Get the CLSID of the PNG encoder.
-    GetEncoderClsid(L"image/png", &encoderClsid);
     // generate .png name version of Filename
-    {
-        //parse for just filename
-        int err;
-        WCHAR Drive[_MAX_DRIVE];
-        WCHAR Dir[_MAX_DIR];
-        WCHAR Fname[_MAX_FNAME];
-        WCHAR Ext[_MAX_EXT];
-        WCHAR PNGfilename[MAX_PATH];
+    err = _wsplitpath_s(Filename, Drive, _MAX_DRIVE, Dir, _MAX_DIR, Fname,
+        _MAX_FNAME, Ext, _MAX_EXT);
+    if (err != 0) {
+        return APPERR_PARAMETER;
+    }
+    err = _wmakepath_s(PNGfilename, _MAX_PATH, Drive, Dir, Fname, L".png");
+    if (err != 0) {
+        return APPERR_PARAMETER;
+    }
 
-        // split apart original filename
-        err = _wsplitpath_s(Filename, Drive, _MAX_DRIVE, Dir, _MAX_DIR, Fname,
-            _MAX_FNAME, Ext, _MAX_EXT);
-        if (err != 0) {
-            return APPERR_PARAMETER;
+    // PNG rows are top row first, RGB order
+    int Channels = BitCount == 24 ? 3 : 1;
+    size_t RowSize = (size_t)Width * (size_t)Channels;
+    std::vector<BYTE> Pixels(RowSize * (size_t)Height);
+    for (int y = 0; y < Height; y++) {
+        const BYTE* Row = BMPimage + (size_t)(TopDown ? y : Height - 1 - y) * (size_t)Stride;
+        BYTE* PNGrow = &Pixels[(size_t)y * RowSize];
+        if (Channels == 1) {
+            memcpy(PNGrow, Row, RowSize);
         }
-
-        err = _wmakepath_s(PNGfilename, _MAX_PATH, Drive, Dir, Fname, L".png");
-        if (err != 0) {
-            return APPERR_PARAMETER;
+        else {
+            for (int x = 0; x < Width; x++) {
+                PNGrow[x * 3] = Row[x * 3 + 2];
+                PNGrow[x * 3 + 1] = Row[x * 3 + 1];
+                PNGrow[x * 3 + 2] = Row[x * 3];
+            }
         }
-
-        stat = image->Save(PNGfilename, &encoderClsid, NULL);
     }
-    delete image;
-    Gdiplus::GdiplusShutdown(gdiplusToken);
 
-    if (stat == Gdiplus::Ok) {
-        return APP_SUCCESS;
+    if (Batch != NULL) {
+        return QueuePNG(PNGfilename, std::move(Pixels), Width, Height, Channels,
+            Channels == 1 ? ColorTable : NULL, Batch);
     }
-
-    return APPERR_PARAMETER;
+    return WritePNG(PNGfilename, Pixels.data(), Width, Height, Channels,
+        Channels == 1 ? ColorTable : NULL);
 }
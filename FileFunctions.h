@@ -2,6 +2,7 @@
 // 
 // function prototypes
 //
+class PngBatch;				// PngWriter.h
 BOOL CCFileSave(HWND hWnd, LPWSTR pszCurrentFilename, LPWSTR* pszFilename,
 				BOOL bSelectFolder, int NumTypes, COMDLG_FILTERSPEC* FileTypes,
 				LPCWSTR szDefExt);
@@ -9,9 +10,11 @@ BOOL CCFileOpen(HWND hWnd, LPWSTR pszCurrentFilename, LPWSTR* pszFilename,
 				BOOL bSelectFolder, int NumTypes, COMDLG_FILTERSPEC* FileTypes,
 				LPCWSTR szDefExt);
 void ExportFile(HWND hWnd, int wmId);
-int SaveBMP(WCHAR* Filename, WCHAR* InputFile, int RGBframes, int AutoScale);
+int SaveBMP(WCHAR* Filename, WCHAR* InputFile, int RGBframes, int AutoScale, PngBatch* Batch);
+int WaitAutoPNG(HWND hWnd, PngBatch* Batch);
 int SaveTXT(WCHAR* Filename, WCHAR* InputFile);
 int DisplayImage(WCHAR* Filename);
+int DisplayImageFrame(const int* Image, IMAGINGHEADER* Header);
 int ImportBMP(HWND hWnd);
 int HEX2Binary(HWND hWnd);
 int CamIRaImport(HWND hWnd);
@@ -27,6 +27,12 @@
 //                      Changed, zoom, pan behavior of bitmap
 //                      Changed window resize of image display
 // V1.3.1   2023-12-28  Merged into MySETIapp
+// V1.3.2.1 2026-10-14  Added, LoadImageFrame, display an image directly from memory
+//                      Image is displayed as bitmap tiles, only visible tiles are drawn
+//                      Added, image file frame paging, only the displayed frame is decoded
+//                      Changed, the render target is kept between images and resized with the
+//                        window, the bitmap is updated in place when the image size is unchanged
+//                      Added, image file frame paging of version 2 image files (ImageFile.cpp)
 // 
 //
 #include "framework.h"
@@ -36,12 +42,19 @@
 #pragma comment(lib, "d2d1.lib")
 #include <CommCtrl.h>
 #include <math.h>
+#include <limits.h>
 #include "AppErrors.h"
+#include "imaging.h"
+#include "ImageIO.h"
+#include "ImageFile.h"
 #include "ImageDialog.h"
 
 #define MINZOOM 0.5f
 #define MAXZOOM 40.0f
 
+// largest bitmap tile, smaller if the Direct2D device has a lower limit
+#define MAXTILESIZE 4096
+
 extern HWND hwndImage;
 
 //*******************************************************************************
@@ -67,10 +80,7 @@ int ImageDialog::InitializeDirect2D(void)
 void ImageDialog::ReleaseDirect2D(void)
 {
     // release resources
-    if (pBitmap) {
-        pBitmap->Release();
-        pBitmap = nullptr;
-    }
+    ReleaseTiles();
 
     if (pRenderTarget) {
         pRenderTarget->Release();
@@ -92,10 +102,7 @@ void ImageDialog::ReleaseDirect2D(void)
 //*******************************************************************************
 void ImageDialog::ReleaseBitmapRender(void)
 {
-    if (pBitmap) {
-        pBitmap->Release();
-        pBitmap = nullptr;
-    }
+    ReleaseTiles();
     if (pRenderTarget) {
         pRenderTarget->Release();
         pRenderTarget = nullptr;
@@ -105,61 +112,171 @@ void ImageDialog::ReleaseBitmapRender(void)
 
 //*******************************************************************************
 //
+// ReleaseTiles
+// 
+//*******************************************************************************
+void ImageDialog::ReleaseTiles(void)
+{
+    for (size_t i = 0; i < Tiles.size(); i++) {
+        if (Tiles[i]) {
+            Tiles[i]->Release();
+        }
+    }
+    Tiles.clear();
+    TilesX = 0;
+    TilesY = 0;
+    return;
+}
+
+//*******************************************************************************
+//
+// LoadCOLORREFimage
 // 
+// Upload ColorImage to the Direct2D bitmap tiles.  The image is split into
+// tiles of at most TileSize x TileSize pixels so images larger than the
+// Direct2D bitmap size limit can be displayed.  Most images are a single tile.
+// The render target is created the first time (or after it was lost) and is
+// kept for the following images.  If the image is the same size as the
+// current tiles they are updated in place, the tiles are only recreated
+// when the image size changes.
 // 
 //*******************************************************************************
 BOOL ImageDialog::LoadCOLORREFimage(HWND hWnd)
 {
-    // delete old data first
+    if (!ColorImage) {
+        return FALSE;
+    }
 
-    if (pBitmap) {
-        pBitmap->Release();
-        pBitmap = nullptr;
+    if (!CreateRenderTarget(hWnd)) {
+        BitmapSize = { 0.0f, 0.0f };
+        return FALSE;
     }
 
+    if (!Tiles.empty()) {
+        if (BitmapSize.x == (float)DisplayXsize && BitmapSize.y == (float)DisplayYsize) {
+            // same size, update the existing tiles
+            BOOL Updated = TRUE;
+            for (int ty = 0; ty < TilesY && Updated; ty++) {
+                for (int tx = 0; tx < TilesX; tx++) {
+                    const COLORREF* Source = ColorImage + (size_t)ty * TileSize * DisplayXsize + (size_t)tx * TileSize;
+                    HRESULT hRes = Tiles[(size_t)ty * TilesX + tx]->CopyFromMemory(NULL, Source,
+                                        DisplayXsize * sizeof(COLORREF));
+                    if (FAILED(hRes)) {
+                        Updated = FALSE;
+                        break;
+                    }
+                }
+            }
+            if (Updated) {
+                return TRUE;
+            }
+        }
+        ReleaseTiles();
+    }
+
+    TilesX = (DisplayXsize + TileSize - 1) / TileSize;
+    TilesY = (DisplayYsize + TileSize - 1) / TileSize;
+    Tiles.assign((size_t)TilesX * TilesY, nullptr);
+
+    for (int ty = 0; ty < TilesY; ty++) {
+        for (int tx = 0; tx < TilesX; tx++) {
+            int x0 = tx * TileSize;
+            int y0 = ty * TileSize;
+            int Width = min(TileSize, DisplayXsize - x0);
+            int Height = min(TileSize, DisplayYsize - y0);
+            const COLORREF* Source = ColorImage + (size_t)y0 * DisplayXsize + x0;
+
+            // bitmap properties set to RGBA 8 bit ignore alpha,96 DPI (Windows default DPI)
+            HRESULT hRes = pRenderTarget->CreateBitmap(D2D1::SizeU(Width, Height), Source,
+                                            DisplayXsize * sizeof(COLORREF),
+                                            bitmapProperties, &Tiles[(size_t)ty * TilesX + tx]);
+            if (FAILED(hRes) || !Tiles[(size_t)ty * TilesX + tx]) {
+                ReleaseTiles();
+                BitmapSize = { 0.0f, 0.0f };
+                return FALSE;
+            }
+        }
+    }
+
+    BitmapSize = { (float)DisplayXsize, (float)DisplayYsize };
+    return TRUE;
+}
+
+//*******************************************************************************
+//
+// CreateRenderTarget
+// 
+// Create the render target for the window if it does not exist.
+// 
+//*******************************************************************************
+BOOL ImageDialog::CreateRenderTarget(HWND hWnd)
+{
     if (pRenderTarget) {
-        pRenderTarget->Release();
-        pRenderTarget = nullptr;
+        return TRUE;
     }
 
-    if (!ColorImage) {
+    if (!pFactory) {
         return FALSE;
     }
 
-    // create render target
+    // the tiles belong to the render target that created them
+    ReleaseTiles();
+
     RECT Rect;
     int xt, yt;
     GetClientRect(hWnd, &Rect);
     xt = (Rect.right - Rect.left) - 1;
     yt = (Rect.bottom - Rect.top) - 1;
+    if (xt < 1) xt = 1;
+    if (yt < 1) yt = 1;
 
     pFactory->CreateHwndRenderTarget(
         D2D1::RenderTargetProperties(),
         D2D1::HwndRenderTargetProperties(hWnd, D2D1::SizeU(xt, yt)),
         &pRenderTarget
     );
+    if (!pRenderTarget) {
+        return FALSE;
+    }
+    hwndTarget = hWnd;
 
-    if (pRenderTarget) {
-        // bitmap properties set to RGBA 8 bit ignore alpha,96 DPI (Windows default DPI)
-        HRESULT hRes = pRenderTarget->CreateBitmap(D2D1::SizeU(DisplayXsize, DisplayYsize), ColorImage,
-                                        DisplayXsize * sizeof(COLORREF),
-                                        bitmapProperties, &pBitmap);
-        if (FAILED(hRes)) {
-            if (pBitmap) {
-                pBitmap->Release();
-                pBitmap = nullptr;
-            }
-            BitmapSize = { 0.0f, 0.0f };
-            return FALSE;
-        }
+    TileSize = (int)pRenderTarget->GetMaximumBitmapSize();
+    if (TileSize <= 0 || TileSize > MAXTILESIZE) {
+        TileSize = MAXTILESIZE;
+    }
 
-        if (pBitmap) {
-            BitmapSize = { (float)DisplayXsize, (float)DisplayYsize };
-            return TRUE;
-        }
+    return TRUE;
+}
+
+//*******************************************************************************
+//
+// ResizeRenderTarget
+// 
+// Resize the render target to the client area of the window (WM_SIZE).
+// 
+//*******************************************************************************
+BOOL ImageDialog::ResizeRenderTarget(HWND hWnd)
+{
+    if (!pRenderTarget) {
+        // nothing has been displayed yet or the target was lost
+        return LoadCOLORREFimage(hWnd);
     }
-    BitmapSize = { 0.0f, 0.0f };
-    return FALSE;
+
+    RECT Rect;
+    int xt, yt;
+    GetClientRect(hWnd, &Rect);
+    xt = (Rect.right - Rect.left) - 1;
+    yt = (Rect.bottom - Rect.top) - 1;
+    if (xt < 1) xt = 1;
+    if (yt < 1) yt = 1;
+
+    HRESULT hRes = pRenderTarget->Resize(D2D1::SizeU(xt, yt));
+    if (FAILED(hRes)) {
+        ReleaseBitmapRender();
+        return LoadCOLORREFimage(hWnd);
+    }
+
+    return Tiles.empty() ? FALSE : TRUE;
 }
 
 //*******************************************************************************
@@ -169,8 +286,13 @@ BOOL ImageDialog::LoadCOLORREFimage(HWND hWnd)
 //*******************************************************************************
 BOOL ImageDialog::Repaint()
 {
+    // the render target was lost, recreate it and the bitmap
+    if (!pRenderTarget && ColorImage && hwndTarget) {
+        LoadCOLORREFimage(hwndTarget);
+    }
+
     // only do this if target exists
-    if (pRenderTarget) {
+    if (pRenderTarget && !Tiles.empty()) {
         pRenderTarget->BeginDraw();
 
         // set scaling and offset 
@@ -181,17 +303,39 @@ BOOL ImageDialog::Repaint()
         pRenderTarget->Clear(D2D1::ColorF(D2D1::ColorF::Bisque));
         
         //Pan bitmap in bitmap pixel steps not display pixel steps
-        D2D1_SIZE_F RectSize = pBitmap->GetSize();
         int ix, iy;
         ix = (int)(panOffset.x + 0.5f);
         iy = (int)(panOffset.y + 0.5f);
 
-        D2D1_RECT_F Rectf = D2D1::RectF((float)ix, float(iy), (float)ix + RectSize.width, float(iy) + RectSize.height);
-        pRenderTarget->DrawBitmap(pBitmap, Rectf, 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+        // part of the image in the window, in bitmap pixels
+        D2D1_SIZE_F TargetSize = pRenderTarget->GetSize();
+        float VisibleLeft = -(float)ix;
+        float VisibleTop = -(float)iy;
+        float VisibleRight = VisibleLeft + TargetSize.width / scaleFactor;
+        float VisibleBottom = VisibleTop + TargetSize.height / scaleFactor;
+
+        // only draw the tiles that are visible
+        for (int ty = 0; ty < TilesY; ty++) {
+            float y0 = (float)(ty * TileSize);
+            float y1 = min(y0 + (float)TileSize, BitmapSize.y);
+            if (y1 <= VisibleTop || y0 >= VisibleBottom) {
+                continue;
+            }
+            for (int tx = 0; tx < TilesX; tx++) {
+                float x0 = (float)(tx * TileSize);
+                float x1 = min(x0 + (float)TileSize, BitmapSize.x);
+                if (x1 <= VisibleLeft || x0 >= VisibleRight) {
+                    continue;
+                }
+                D2D1_RECT_F Rectf = D2D1::RectF((float)ix + x0, (float)iy + y0, (float)ix + x1, (float)iy + y1);
+                pRenderTarget->DrawBitmap(Tiles[(size_t)ty * TilesX + tx], Rectf, 1.0f,
+                    D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+            }
+        }
         
         HRESULT hr = pRenderTarget->EndDraw();
         if (hr == D2DERR_RECREATE_TARGET) {
-            // close resources so they are recreated
+            // close resources so they are recreated on the next repaint
             ReleaseBitmapRender();
         }
         return TRUE;
@@ -494,6 +638,12 @@ void ImageDialog::UpdateStatusBar(HWND ParentWindow) {
             scaleFactor,
             (int)BitmapSize.x,(int)BitmapSize.y);
 
+        if (NumPages > 1) {
+            WCHAR szFrame[64];
+            swprintf_s(szFrame, 64, L", Frame %d/%d", CurrentPage + 1, NumPages);
+            wcscat_s(szString, MAX_PATH, szFrame);
+        }
+
         SendMessage(hwndStatusBar, SB_SETTEXT, MAKEWPARAM(0, SBT_POPOUT), reinterpret_cast<LPARAM>(szString));
     }
 }
@@ -846,3 +996,342 @@ int  ImageDialog::LoadBMPfile(WCHAR* InputFilename, BOOL Invert)
     
     return APP_SUCCESS;
 }
+
+//****************************************************************
+//
+//  LoadImageFrame
+// 
+//  Load the display image directly from an image in memory, this
+//  replaces converting the image to a BMP file with SaveBMP() and
+//  reading it back with LoadBMPfile().  The pixels are scaled the
+//  same way as SaveBMP().
+// 
+//  Parameters:
+//      const int* Image        image pixels, all frames as loaded by LoadImageFile()
+//      IMAGINGHEADER* Header   image header for Image
+//      BOOL RGBframes          RBG/Greyscale interpetation flag
+//                              This flag is ignored if the # of frames in the
+//                              image is not a multiple of 3.
+//      BOOL AutoScale          auto scale the image
+//
+//  Input parameter RBGframes FALSE
+//      the first frame is displayed as a greyscale image
+//      AutoScale only applies to 8 bit images, 16 and 32 bit images
+//      are always automatically scaled 0 to 255.
+//
+//  Input parameter RBGframes TRUE
+//      1st frame Red, 2nd frame Green, 3rd frame Blue
+//      autoscaling stretchs each color independently from the others.
+// 
+//  return value:
+//  1 - Success
+//  see standardized app error list at top of this source file
+//
+//****************************************************************
+int ImageDialog::LoadImageFrame(const int* Image, IMAGINGHEADER* Header, BOOL RGBframes, BOOL AutoScale)
+{
+    int NumColors;
+    int MaxValue;
+    size_t FrameSize;
+    float Scale[3];
+    float Offset[3];
+
+    if (Image == NULL || Header->Xsize <= 0 || Header->Ysize <= 0 || Header->NumFrames <= 0) {
+        return APPERR_PARAMETER;
+    }
+
+    if (RGBframes && Header->NumFrames % 3 == 0) {
+        NumColors = 3;
+    }
+    else {
+        NumColors = 1;
+        // there is no 16 or 32 bit greyscale display
+        if (Header->PixelSize > 1) {
+            AutoScale = TRUE;
+        }
+    }
+
+    // the pixel values as they are saved in the image file
+    if (Header->PixelSize == 1) {
+        MaxValue = 255;
+    }
+    else if (Header->PixelSize == 2) {
+        MaxValue = 65535;
+    }
+    else {
+        MaxValue = INT_MAX;
+    }
+
+    FrameSize = (size_t)Header->Xsize * (size_t)Header->Ysize;
+
+    // scan each color frame for scaling, negative pixels are displayed as 0
+    for (int Color = 0; Color < NumColors; Color++) {
+        const int* Frame = Image + Color * FrameSize;
+        int PixelMin;
+        int PixelMax;
+
+        if (!AutoScale) {
+            Scale[Color] = 1.0f;
+            Offset[Color] = 0.0f;
+            continue;
+        }
+
+        PixelMin = MaxValue;
+        PixelMax = 0;
+        for (size_t i = 0; i < FrameSize; i++) {
+            int Pixel = Frame[i];
+            if (Pixel < 0) Pixel = 0;
+            if (Pixel > MaxValue) Pixel = MaxValue;
+            if (Pixel < PixelMin) PixelMin = Pixel;
+            if (Pixel > PixelMax) PixelMax = Pixel;
+        }
+
+        if (PixelMax == PixelMin) {
+            // frame is all the same value
+            // Make frame all white
+            Scale[Color] = 0.0f;
+            Offset[Color] = 255.0f;
+        }
+        else {
+            Scale[Color] = 255.0f / ((float)PixelMax - (float)PixelMin);
+            Offset[Color] = 0.0f - (Scale[Color] * (float)PixelMin);
+        }
+    }
+
+    if (!CreateColorImage(Header->Xsize, Header->Ysize, 1)) {
+        return APPERR_MEMALLOC;
+    }
+
+    // COLORREF is R8G8B8A8, red is the low byte
+    for (size_t i = 0; i < FrameSize; i++) {
+        COLORREF ColorPixel = 0;
+
+        for (int Color = 0; Color < NumColors; Color++) {
+            int Pixel = Image[Color * FrameSize + i];
+            if (Pixel < 0) Pixel = 0;
+            if (Pixel > MaxValue) Pixel = MaxValue;
+            Pixel = (int)(Scale[Color] * (float)Pixel + Offset[Color] + 0.5f);
+            if (Pixel < 0) Pixel = 0;
+            if (Pixel > 255) Pixel = 255;
+            ColorPixel |= (COLORREF)Pixel << (8 * Color);
+        }
+        if (NumColors == 1) {
+            // greyscale
+            ColorPixel |= (ColorPixel << 8) | (ColorPixel << 16);
+        }
+        ColorImage[i] = ColorPixel;
+    }
+
+    return APP_SUCCESS;
+}
+
+//****************************************************************
+//
+//  OpenFrameFile
+// 
+//  Display an image file one page at a time.  A page is one frame
+//  for greyscale display or 3 frames for RGB display.  Only the
+//  page being displayed is decoded, so a large stack of frames
+//  does not have to be loaded into memory.  The first page is
+//  displayed, use ShowFrame() to select other pages.
+// 
+//  The file is not kept open between pages so it can still be
+//  overwritten by the other image processing functions.
+// 
+//  Parameters:
+//      WCHAR* Filename         image file to display
+//      BOOL RGBframes          RBG/Greyscale interpetation flag
+//                              This flag is ignored if the # of frames in the
+//                              image is not a multiple of 3.
+//      BOOL AutoScale          auto scale the image
+//
+//  return value:
+//  1 - Success
+//  see standardized app error list at top of this source file
+//
+//****************************************************************
+int ImageDialog::OpenFrameFile(WCHAR* Filename, BOOL RGBframes, BOOL AutoScale)
+{
+    IMAGINGHEADER Header;
+    int iRes;
+
+    CloseFrameFile();
+
+    iRes = ReadImageHeader(Filename, &Header);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
+    if (Header.Xsize <= 0 || Header.Ysize <= 0 || Header.NumFrames <= 0) {
+        return APPERR_PARAMETER;
+    }
+
+    wcscpy_s(FrameFilename, MAX_PATH, Filename);
+    FrameRGB = RGBframes;
+    FrameAutoScale = AutoScale;
+    if (RGBframes && Header.NumFrames % 3 == 0) {
+        FramesPerPage = 3;
+    }
+    else {
+        FramesPerPage = 1;
+    }
+    NumPages = Header.NumFrames / FramesPerPage;
+
+    iRes = ShowFrame(0);
+    if (iRes != APP_SUCCESS) {
+        CloseFrameFile();
+    }
+    return iRes;
+}
+
+//****************************************************************
+//
+//  ShowFrame
+// 
+//  Decode one page of the image file opened by OpenFrameFile()
+//  into the display image.  The caller is responsible for updating
+//  the display (IDC_UPDATE_IMAGE).
+// 
+//  Parameters:
+//      int Page        page to display, 0 is the first page
+//
+//  return value:
+//  1 - Success
+//  see standardized app error list at top of this source file
+//
+//****************************************************************
+int ImageDialog::ShowFrame(int Page)
+{
+    IMAGINGHEADER Header;
+    IMAGEFILEMAP Map;
+    size_t FrameSize;
+    size_t PageSize;
+    int iRes;
+
+    if (NumPages <= 0 || Page < 0 || Page >= NumPages) {
+        return APPERR_PARAMETER;
+    }
+
+    iRes = MapImageFile(FrameFilename, &Map);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
+    if (Map.FileSize < (LONGLONG)sizeof(IMAGINGHEADER)) {
+        UnmapImageFile(&Map);
+        return APPERR_FILEREAD;
+    }
+    memcpy(&Header, Map.View, sizeof(IMAGINGHEADER));
+
+    // the file may have been rewritten since it was opened
+    if (Header.Xsize <= 0 || Header.Ysize <= 0 ||
+        (Header.PixelSize != 1 && Header.PixelSize != 2 && Header.PixelSize != 4) ||
+        Header.NumFrames / FramesPerPage != NumPages) {
+        UnmapImageFile(&Map);
+        return APPERR_FILETYPE;
+    }
+
+    FrameSize = (size_t)Header.Xsize * (size_t)Header.Ysize;
+    PageSize = FrameSize * (size_t)FramesPerPage;
+    if (Header.Version == IMAGEFILE_VERSION_PACKED) {
+        // version 2 file, only the frames of the page are read and decoded
+        UnmapImageFile(&Map);
+        return ShowPackedFrame(Page, PageSize);
+    }
+    if ((ULONGLONG)(Map.FileSize - sizeof(IMAGINGHEADER)) <
+        (ULONGLONG)(Page + 1) * PageSize * (ULONGLONG)Header.PixelSize) {
+        UnmapImageFile(&Map);
+        return APPERR_FILESIZE;
+    }
+
+    int* Image;
+    Image = new int[PageSize];
+    if (Image == NULL) {
+        UnmapImageFile(&Map);
+        return APPERR_MEMALLOC;
+    }
+
+    WidenPixels(Image, Map.View + sizeof(IMAGINGHEADER) + (size_t)Page * PageSize * Header.PixelSize,
+        PageSize, (int)Header.PixelSize, (int)Header.Endian);
+    UnmapImageFile(&Map);
+
+    Header.NumFrames = (short)FramesPerPage;
+    iRes = LoadImageFrame(Image, &Header, FrameRGB, FrameAutoScale);
+    delete[] Image;
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
+
+    CurrentPage = Page;
+    return APP_SUCCESS;
+}
+
+//****************************************************************
+//
+//  ShowPackedFrame
+// 
+//  ShowFrame for a version 2 image file (ImageFile.cpp)
+//
+//****************************************************************
+int ImageDialog::ShowPackedFrame(int Page, size_t PageSize)
+{
+    ImageFileReader InFile;
+    IMAGINGHEADER Header;
+    int iRes;
+
+    iRes = InFile.Open(FrameFilename, &Header);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
+
+    int* Image;
+    Image = new int[PageSize];
+    if (Image == NULL) {
+        return APPERR_MEMALLOC;
+    }
+
+    iRes = InFile.ReadFrames(Page * FramesPerPage, FramesPerPage, Image);
+    InFile.Close();
+    if (iRes != APP_SUCCESS) {
+        delete[] Image;
+        return iRes;
+    }
+
+    Header.NumFrames = (short)FramesPerPage;
+    iRes = LoadImageFrame(Image, &Header, FrameRGB, FrameAutoScale);
+    delete[] Image;
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
+
+    CurrentPage = Page;
+    return APP_SUCCESS;
+}
+
+//****************************************************************
+//
+//  GetFrame
+// 
+//  return the page being displayed and the # of pages in the
+//  image file.  Pages is set to 0 if no image file is open.
+//
+//****************************************************************
+int ImageDialog::GetFrame(int* Pages)
+{
+    *Pages = NumPages;
+    return CurrentPage;
+}
+
+//****************************************************************
+//
+//  CloseFrameFile
+// 
+//  Stop paging through the image file, the display image is kept.
+//
+//****************************************************************
+void ImageDialog::CloseFrameFile(void)
+{
+    FrameFilename[0] = 0;
+    NumPages = 0;
+    CurrentPage = 0;
+    FramesPerPage = 1;
+    return;
+}
@@ -2,6 +2,8 @@
 #include "framework.h"
 #include <windows.h>
 #include <d2d1.h>
+#include <vector>
+#include "imaging.h"
 
 union ICOLOR {
 	COLORREF ColorRef;
@@ -13,7 +15,10 @@ class ImageDialog
 private:
 	ID2D1Factory* pFactory = nullptr;
 	ID2D1HwndRenderTarget* pRenderTarget = nullptr;
-	ID2D1Bitmap* pBitmap = nullptr;
+	std::vector<ID2D1Bitmap*> Tiles;	// image bitmap split in tiles, row major
+	int TileSize = 0;					// tile width and height in pixels
+	int TilesX = 0;						// # of tile columns
+	int TilesY = 0;						// # of tile rows
 	D2D1_BITMAP_PROPERTIES bitmapProperties = { D2D1::PixelFormat(DXGI_FORMAT_R8G8B8A8_UNORM,
 														 D2D1_ALPHA_MODE_IGNORE),
 												96.0f, 96.0f };
@@ -36,6 +41,19 @@ private:
 	int DisplayXsize = 0;
 	int DisplayYsize = 0;
 	WINDOWPOS WindowPos = { NULL,NULL,0,0,0,0,0 };
+	HWND hwndTarget = NULL;		// window of the render target
+
+	// image file displayed one page at a time
+	WCHAR FrameFilename[MAX_PATH] = { 0 };
+	int NumPages = 0;			// 0 if no image file is open
+	int CurrentPage = 0;
+	int FramesPerPage = 1;		// 3 for RGB display
+	BOOL FrameRGB = FALSE;
+	BOOL FrameAutoScale = FALSE;
+
+	BOOL CreateRenderTarget(HWND hWnd);
+	void ReleaseTiles(void);
+	int ShowPackedFrame(int Page, size_t PageSize);
 
 public:
 	ImageDialog() {
@@ -48,6 +66,7 @@ public:
 	void ReleaseDirect2D(void);
 	void ReleaseBitmapRender(void);
 	BOOL LoadCOLORREFimage(HWND hWnd);
+	BOOL ResizeRenderTarget(HWND hWnd);
 	BOOL Repaint(void);
 
 	void Rescale(int Delta);
@@ -74,4 +93,9 @@ public:
 	COLORREF* GetColorImage(void);
 	COLORREF* CreateColorImage(int xsize, int ysize, int Numframes);
 	int  LoadBMPfile(WCHAR* InputFilename, BOOL Invert);
+	int  LoadImageFrame(const int* Image, IMAGINGHEADER* Header, BOOL RGBframes, BOOL AutoScale);
+	int  OpenFrameFile(WCHAR* Filename, BOOL RGBframes, BOOL AutoScale);
+	int  ShowFrame(int Page);
+	int  GetFrame(int* Pages);
+	void CloseFrameFile(void);
 };
\ No newline at end of file
@@ -23,6 +23,8 @@
 //                      Fixed parameter in IDC_BMP_GENERATE when x,y sizes are the same
 //                      Added window position reset
 // V1.3.1   2023-12-28  Merged into MySETIapp
+// V1.3.2.1 2026-10-14  Added, IDC_UPDATE_IMAGE, display the image already loaded by LoadImageFrame
+//                      Changed, WM_SIZE resizes the render target instead of recreating it
 //
 #include "framework.h"
 #include "resource.h"
@@ -116,6 +118,18 @@ INT_PTR CALLBACK ImageDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
             return (INT_PTR)TRUE;
         }
 
+        case IDC_UPDATE_IMAGE:
+        {
+            // the display image was loaded directly with ImgDlg->LoadImageFrame()
+            if (ImgDlg->LoadCOLORREFimage(hwndImage)) {
+                ShowWindow(hDlg, SW_SHOW);
+                ImgDlg->Repaint();
+                ImgDlg->UpdateStatusBar(hDlg);
+            }
+
+            return (INT_PTR)TRUE;
+        }
+
         default:
             return (INT_PTR)FALSE;
         } // end of WM_COMMAND
@@ -171,7 +185,7 @@ INT_PTR CALLBACK ImageDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
 
     case WM_SIZE:
     {
-        if (ImgDlg->LoadCOLORREFimage(hwndImage)) {
+        if (ImgDlg->ResizeRenderTarget(hwndImage)) {
             ImgDlg->Repaint();
         }
 
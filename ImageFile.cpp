@@ -0,0 +1,933 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// ImageFile.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Image file reader and writer, version 1 and version 2 image files
+//
+// A version 1 image file is the 32 byte IMAGINGHEADER followed by all the
+// pixels, PixelSize bytes per pixel.  Most of the images are binary, the
+// pixels are 0 or 1 (or 0 and 255 when scaled for display) but still use
+// a byte or more per pixel.
+//
+// A version 2 image file stores each frame separately:
+//
+//	IMAGINGHEADER				Version 2, the other fields are the same as version 1
+//	ULONGLONG Offsets[NumFrames+1]	file offset of each frame, frame i is the
+//								Offsets[i+1]-Offsets[i] bytes starting at Offsets[i]
+//	frames						a frame with every pixel 0 is 0 bytes, any other
+//								frame is an IMAGEFRAME followed by the frame data
+//
+// The frame data is PixelSize bytes per pixel in the byte order set by
+// Endian, the same as version 1.  When every pixel of a frame is either 0 or
+// the same value (OneValue) the frame is bit packed (FRAME_BITPACKED), 1 bit
+// per pixel, the first pixel of the frame is the most significant bit of
+// the first byte.  When compression is on the frame data is compressed with
+// LZ4 (FRAME_LZ4, see Lz4.cpp) if that makes it smaller.  The offset table
+// and IMAGEFRAME are PC format.
+//
+// The offset table lets a reader go straight to the frames it needs, so
+// extracting frames, displaying a page or streaming a block of frames does
+// not read or decompress the rest of the file.
+//
+// Version 1 is the default, version 2 is only written when it is selected
+// in the settings (SetImageFileFormat) or by ConvertImageFile.  Both
+// versions are read by LoadImageFile, LoadImageBuffer, StreamImageFile,
+// ImageExtract and the image display.
+//
+// V1.3.2.1 2026-10-14  Initial release
+//
+#include "framework.h"
+#include <stdio.h>
+#include <vector>
+#include <atomic>
+#include "AppErrors.h"
+#include "imaging.h"
+#include "ImageIO.h"
+#include "Parallel.h"
+#include "Lz4.h"
+#include "ImageFile.h"
+
+// target # of pixels in the block of whole frames encoded at a time
+#define IMAGEFILE_BATCH_PIXELS (16*1024*1024)
+
+static std::atomic<int> FileVersion(1);			// image file version written by default
+static std::atomic<int> FileCompress(0);		// TRUE - compress version 2 frames
+
+//*****************************************************************************************
+//
+//	SetImageFileFormat
+//
+//	Set the image file format used by ImageFileWriter::Open(Filename, Header),
+//	called at startup and from the settings dialog
+//
+// Parameters:
+//	int Version				1 - version 1, IMAGEFILE_VERSION_PACKED - version 2
+//	BOOL Compress			TRUE - LZ4 compress the frames of version 2 files
+//
+//*****************************************************************************************
+void SetImageFileFormat(int Version, BOOL Compress)
+{
+	FileVersion = Version == IMAGEFILE_VERSION_PACKED ? IMAGEFILE_VERSION_PACKED : 1;
+	FileCompress = Compress ? TRUE : FALSE;
+}
+
+//*****************************************************************************************
+//
+//	GetImageFileFormat
+//
+//	Current image file format setting, see SetImageFileFormat
+//
+//*****************************************************************************************
+void GetImageFileFormat(int* Version, BOOL* Compress)
+{
+	*Version = FileVersion;
+	*Compress = FileCompress;
+}
+
+//*****************************************************************************************
+//
+//	BinaryValue
+//
+//	Private function, check if every pixel is either 0 or the same value
+//
+//  return value:
+//  TRUE - binary, *One is the value of the pixels that are not 0, 0 if all are 0
+//
+//*****************************************************************************************
+template <typename STORAGETYPE>
+static BOOL BinaryValue(const STORAGETYPE* Pixels, size_t NumPixels, STORAGETYPE* One)
+{
+	size_t i;
+
+	*One = 0;
+	for (i = 0; i < NumPixels; i++) {
+		if (Pixels[i] != 0) {
+			*One = Pixels[i];
+			break;
+		}
+	}
+	for (; i < NumPixels; i++) {
+		if (Pixels[i] != 0 && Pixels[i] != *One) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+//*****************************************************************************************
+//
+//	PackBits
+//
+//	Private function, pack a binary frame 1 bit per pixel, most significant bit first
+//
+//*****************************************************************************************
+template <typename STORAGETYPE>
+static void PackBits(BYTE* Bits, const STORAGETYPE* Pixels, size_t NumPixels)
+{
+	size_t NumBytes = NumPixels / 8;
+
+	for (size_t i = 0; i < NumBytes; i++) {
+		const STORAGETYPE* Group = &Pixels[i * 8];
+		BYTE Value = 0;
+		for (int j = 0; j < 8; j++) {
+			Value = (BYTE)((Value << 1) | (Group[j] != 0 ? 1 : 0));
+		}
+		Bits[i] = Value;
+	}
+	if (NumPixels % 8) {
+		BYTE Value = 0;
+		for (size_t j = NumBytes * 8; j < NumPixels; j++) {
+			Value = (BYTE)((Value << 1) | (Pixels[j] != 0 ? 1 : 0));
+		}
+		Bits[NumBytes] = (BYTE)(Value << (8 - NumPixels % 8));
+	}
+}
+
+//*****************************************************************************************
+//
+//	UnpackBits
+//
+//	Private function, expand a bit packed frame, set bits are One, clear bits are 0
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+static void UnpackBits(PIXELTYPE* Image, const BYTE* Bits, size_t NumPixels, PIXELTYPE One)
+{
+	size_t NumBytes = NumPixels / 8;
+
+	for (size_t i = 0; i < NumBytes; i++) {
+		PIXELTYPE* Group = &Image[i * 8];
+		BYTE Value = Bits[i];
+		for (int j = 0; j < 8; j++) {
+			Group[j] = (Value & (0x80 >> j)) ? One : 0;
+		}
+	}
+	for (size_t j = NumBytes * 8; j < NumPixels; j++) {
+		Image[j] = (Bits[NumBytes] & (0x80 >> (j % 8))) ? One : 0;
+	}
+}
+
+//*****************************************************************************************
+//
+//	EncodeFrame
+//
+//	Private function, encode one frame of a version 2 image file
+//
+// Parameters:
+//	const BYTE* Pixels		frame pixels in the file pixel format
+//	size_t FramePixels		# of pixels in the frame
+//	int PixelSize			1,2 or 4 bytes
+//	int Endian				0 MAC format, -1 PC format
+//	BOOL Compress			TRUE - LZ4 compress the frame data if it is smaller
+//	std::vector<BYTE>& Stored	receives the frame as stored in the file,
+//							empty for a frame of all 0 pixels
+//
+//*****************************************************************************************
+static void EncodeFrame(const BYTE* Pixels, size_t FramePixels, int PixelSize, int Endian,
+	BOOL Compress, std::vector<BYTE>& Stored)
+{
+	IMAGEFRAME FrameHeader = { 0 };
+	std::vector<BYTE> Bits;
+	const BYTE* Data = Pixels;
+	size_t DataSize = FramePixels * (size_t)PixelSize;
+	BOOL Binary;
+	int OneValue = 0;
+
+	if (PixelSize == 1) {
+		BYTE One;
+		Binary = BinaryValue(Pixels, FramePixels, &One);
+		OneValue = (int)One;
+	}
+	else if (PixelSize == 2) {
+		USHORT One;
+		Binary = BinaryValue((const USHORT*)Pixels, FramePixels, &One);
+		WidenPixels(&OneValue, (const BYTE*)&One, 1, PixelSize, Endian);
+	}
+	else {
+		ULONG One;
+		Binary = BinaryValue((const ULONG*)Pixels, FramePixels, &One);
+		WidenPixels(&OneValue, (const BYTE*)&One, 1, PixelSize, Endian);
+	}
+
+	if (Binary && OneValue == 0) {
+		Stored.clear();
+		return;
+	}
+
+	if (Binary) {
+		Bits.resize((FramePixels + 7) / 8);
+		if (PixelSize == 1) {
+			PackBits(Bits.data(), Pixels, FramePixels);
+		}
+		else if (PixelSize == 2) {
+			PackBits(Bits.data(), (const USHORT*)Pixels, FramePixels);
+		}
+		else {
+			PackBits(Bits.data(), (const ULONG*)Pixels, FramePixels);
+		}
+		FrameHeader.Encoding = FRAME_BITPACKED;
+		FrameHeader.OneValue = OneValue;
+		Data = Bits.data();
+		DataSize = Bits.size();
+	}
+
+	Stored.resize(sizeof(IMAGEFRAME) + DataSize);
+	if (Compress) {
+		// only kept if it is smaller than the data
+		size_t CompressedSize = Lz4Compress(Data, DataSize, &Stored[sizeof(IMAGEFRAME)], DataSize - 1);
+		if (CompressedSize != 0) {
+			FrameHeader.Encoding |= FRAME_LZ4;
+			Stored.resize(sizeof(IMAGEFRAME) + CompressedSize);
+			memcpy(Stored.data(), &FrameHeader, sizeof(IMAGEFRAME));
+			return;
+		}
+	}
+	memcpy(&Stored[sizeof(IMAGEFRAME)], Data, DataSize);
+	memcpy(Stored.data(), &FrameHeader, sizeof(IMAGEFRAME));
+}
+
+//*****************************************************************************************
+//
+//	ToFilePixels, FromFilePixels
+//
+//	Private functions, convert pixels to and from the file pixel format.
+//	'int' pixels are clamped the same as WriteImagePixels().  BYTE pixels
+//	are the file pixels, PixelSize bytes each.  USHORT pixels are 2 byte
+//	pixels, MAC format pixels are byte swapped.
+//
+//*****************************************************************************************
+static void ToFilePixels(BYTE* Pixels, const int* Image, size_t NumPixels, int PixelSize, int Endian)
+{
+	NarrowPixels(Pixels, Image, NumPixels, PixelSize, Endian);
+}
+
+static void ToFilePixels(BYTE* Pixels, const BYTE* Image, size_t NumPixels, int PixelSize, int Endian)
+{
+	UNREFERENCED_PARAMETER(Endian);
+	memcpy(Pixels, Image, NumPixels * (size_t)PixelSize);
+}
+
+static void ToFilePixels(BYTE* Pixels, const USHORT* Image, size_t NumPixels, int PixelSize, int Endian)
+{
+	USHORT* Dest = (USHORT*)Pixels;
+
+	UNREFERENCED_PARAMETER(PixelSize);
+	if (Endian) {
+		memcpy(Dest, Image, NumPixels * sizeof(USHORT));
+		return;
+	}
+	for (size_t i = 0; i < NumPixels; i++) {
+		Dest[i] = _byteswap_ushort(Image[i]);
+	}
+}
+
+static void FromFilePixels(int* Image, const BYTE* Pixels, size_t NumPixels, int PixelSize, int Endian)
+{
+	WidenPixels(Image, Pixels, NumPixels, PixelSize, Endian);
+}
+
+static void FromFilePixels(BYTE* Image, const BYTE* Pixels, size_t NumPixels, int PixelSize, int Endian)
+{
+	UNREFERENCED_PARAMETER(PixelSize);
+	UNREFERENCED_PARAMETER(Endian);
+	memcpy(Image, Pixels, NumPixels);
+}
+
+static void FromFilePixels(USHORT* Image, const BYTE* Pixels, size_t NumPixels, int PixelSize, int Endian)
+{
+	const USHORT* Src = (const USHORT*)Pixels;
+
+	UNREFERENCED_PARAMETER(PixelSize);
+	if (Endian) {
+		memcpy(Image, Src, NumPixels * sizeof(USHORT));
+		return;
+	}
+	for (size_t i = 0; i < NumPixels; i++) {
+		Image[i] = _byteswap_ushort(Src[i]);
+	}
+}
+
+//*****************************************************************************************
+//
+//	DecodeFrame
+//
+//	Private function, decode one frame of a version 2 image file
+//
+// Parameters:
+//	const BYTE* Stored		frame as stored in the file
+//	size_t StoredSize		# of bytes in Stored, 0 - all pixels are 0
+//	size_t FramePixels		# of pixels in the frame
+//	int PixelSize			1,2 or 4 bytes
+//	int Endian				0 MAC format, -1 PC format
+//	std::vector<BYTE>& Scratch	work buffer for a compressed frame
+//	PIXELTYPE* Image		receives the FramePixels pixels
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+static int DecodeFrame(const BYTE* Stored, size_t StoredSize, size_t FramePixels, int PixelSize, int Endian,
+	std::vector<BYTE>& Scratch, PIXELTYPE* Image)
+{
+	IMAGEFRAME FrameHeader;
+	const BYTE* Data;
+	size_t DataSize;
+	size_t FrameSize;
+	int iRes;
+
+	if (StoredSize == 0) {
+		memset(Image, 0, FramePixels * sizeof(PIXELTYPE));
+		return APP_SUCCESS;
+	}
+	if (StoredSize < sizeof(IMAGEFRAME)) {
+		return APPERR_FILEREAD;
+	}
+	memcpy(&FrameHeader, Stored, sizeof(IMAGEFRAME));
+	if (FrameHeader.Encoding & ~(FRAME_BITPACKED | FRAME_LZ4)) {
+		return APPERR_FILETYPE;
+	}
+	Data = Stored + sizeof(IMAGEFRAME);
+	DataSize = StoredSize - sizeof(IMAGEFRAME);
+
+	if (FrameHeader.Encoding & FRAME_BITPACKED) {
+		FrameSize = (FramePixels + 7) / 8;
+	}
+	else {
+		FrameSize = FramePixels * (size_t)PixelSize;
+	}
+
+	if (FrameHeader.Encoding & FRAME_LZ4) {
+		Scratch.resize(FrameSize);
+		iRes = Lz4Decompress(Data, DataSize, Scratch.data(), FrameSize);
+		if (iRes != APP_SUCCESS) {
+			return iRes;
+		}
+		Data = Scratch.data();
+	}
+	else if (DataSize != FrameSize) {
+		return APPERR_FILEREAD;
+	}
+	else if (((size_t)Data % (size_t)PixelSize) != 0) {
+		// the frames are not aligned in the file, 2 and 4 byte pixels are
+		// converted from an aligned copy
+		Scratch.assign(Data, Data + FrameSize);
+		Data = Scratch.data();
+	}
+
+	if (FrameHeader.Encoding & FRAME_BITPACKED) {
+		UnpackBits(Image, Data, FramePixels, (PIXELTYPE)FrameHeader.OneValue);
+	}
+	else {
+		FromFilePixels(Image, Data, FramePixels, PixelSize, Endian);
+	}
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	ImageFileWriter::Open
+//
+//	Create an image file and write its header.  The first version uses the
+//	image file format setting (SetImageFileFormat).
+//
+// Parameters:
+//	WCHAR* Filename			image file to create
+//	IMAGINGHEADER* ImageHeader	header of the image, the Version and HeaderSize
+//							are set by the writer
+//	int Version				1 - version 1, IMAGEFILE_VERSION_PACKED - version 2
+//	BOOL Compression		TRUE - LZ4 compress the frames of a version 2 file
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+int ImageFileWriter::Open(WCHAR* Filename, IMAGINGHEADER* ImageHeader)
+{
+	return Open(Filename, ImageHeader, FileVersion, FileCompress);
+}
+
+int ImageFileWriter::Open(WCHAR* Filename, IMAGINGHEADER* ImageHeader, int Version, BOOL Compression)
+{
+	errno_t ErrNum;
+
+	Close();
+	Result = APP_SUCCESS;
+	FramesWritten = 0;
+	FrameFill = 0;
+
+	if (ImageHeader->PixelSize != 1 && ImageHeader->PixelSize != 2 && ImageHeader->PixelSize != 4) {
+		return APPERR_PARAMETER;
+	}
+	if (Version == IMAGEFILE_VERSION_PACKED &&
+		(ImageHeader->Xsize <= 0 || ImageHeader->Ysize <= 0 || ImageHeader->NumFrames <= 0)) {
+		return APPERR_PARAMETER;
+	}
+
+	memcpy(&Header, ImageHeader, sizeof(IMAGINGHEADER));
+	Header.HeaderSize = (short)sizeof(IMAGINGHEADER);
+	Header.Version = (short)(Version == IMAGEFILE_VERSION_PACKED ? IMAGEFILE_VERSION_PACKED : 1);
+	Compress = Compression;
+	FramePixels = (size_t)Header.Xsize * (size_t)Header.Ysize;
+
+	ErrNum = _wfopen_s(&Out, Filename, L"wb");
+	if (Out == NULL) {
+		return APPERR_FILEOPEN;
+	}
+
+	if (fwrite(&Header, sizeof(IMAGINGHEADER), 1, Out) != 1) {
+		Result = APPERR_FILEWRITE;
+		return Close();
+	}
+
+	if (Header.Version == IMAGEFILE_VERSION_PACKED) {
+		// the offset table is written again by Close() when all the frames are known
+		Offsets.assign((size_t)Header.NumFrames + 1, 0);
+		Offsets[0] = (ULONGLONG)sizeof(IMAGINGHEADER) + (ULONGLONG)Offsets.size() * sizeof(ULONGLONG);
+		if (fwrite(Offsets.data(), sizeof(ULONGLONG), Offsets.size(), Out) != Offsets.size()) {
+			Result = APPERR_FILEWRITE;
+			return Close();
+		}
+		Frame.resize(FramePixels * (size_t)Header.PixelSize);
+	}
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	ImageFileWriter::WritePixels
+//
+//	Write the next NumPixels pixels of the image.  The pixels do not have
+//	to be whole frames.  'int' pixels are clamped to the PixelSize of the file,
+//	BYTE and USHORT pixels must match the PixelSize.
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+int ImageFileWriter::WritePixels(const int* Image, size_t NumPixels)
+{
+	if (Out == NULL || Result != APP_SUCCESS) {
+		return Out == NULL ? APPERR_PARAMETER : Result;
+	}
+	if (Header.Version != IMAGEFILE_VERSION_PACKED) {
+		Result = WriteImagePixels(Out, Image, NumPixels, (int)Header.PixelSize, (int)Header.Endian);
+		return Result;
+	}
+	return AddPixels(Image, NumPixels);
+}
+
+int ImageFileWriter::WritePixels(const BYTE* Image, size_t NumPixels)
+{
+	if (Header.PixelSize != 1) {
+		return APPERR_PARAMETER;
+	}
+	return WriteFilePixels(Image, NumPixels);
+}
+
+int ImageFileWriter::WritePixels(const USHORT* Image, size_t NumPixels)
+{
+	if (Out == NULL || Result != APP_SUCCESS) {
+		return Out == NULL ? APPERR_PARAMETER : Result;
+	}
+	if (Header.Version != IMAGEFILE_VERSION_PACKED) {
+		Result = WriteImagePixels(Out, Image, NumPixels, (int)Header.PixelSize, (int)Header.Endian);
+		return Result;
+	}
+	if (Header.PixelSize != 2) {
+		return APPERR_PARAMETER;
+	}
+	return AddPixels(Image, NumPixels);
+}
+
+//*****************************************************************************************
+//
+//	ImageFileWriter::WriteFilePixels
+//
+//	Write the next NumPixels pixels of the image, the pixels are already in
+//	the file pixel format, PixelSize bytes each in the header byte order
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+int ImageFileWriter::WriteFilePixels(const BYTE* Pixels, size_t NumPixels)
+{
+	if (Out == NULL || Result != APP_SUCCESS) {
+		return Out == NULL ? APPERR_PARAMETER : Result;
+	}
+	if (Header.Version != IMAGEFILE_VERSION_PACKED) {
+		if (NumPixels && fwrite(Pixels, (size_t)Header.PixelSize, NumPixels, Out) != NumPixels) {
+			Result = APPERR_FILEWRITE;
+		}
+		return Result;
+	}
+	return AddFilePixels(Pixels, NumPixels);
+}
+
+int ImageFileWriter::AddFilePixels(const BYTE* Pixels, size_t NumPixels)
+{
+	return AddPixels(Pixels, NumPixels);
+}
+
+//*****************************************************************************************
+//
+//	ImageFileWriter::AddPixels
+//
+//	Private function, add pixels to a version 2 file.  Whole frames are taken
+//	straight from Image and encoded in parallel, the rest is collected in
+//	Frame until the frame is complete.  Pixels past the last frame are not
+//	part of the image and are ignored.
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+int ImageFileWriter::AddPixels(const PIXELTYPE* Image, size_t NumPixels)
+{
+	// BYTE pixels are file pixels, PixelSize bytes per pixel
+	size_t Step = sizeof(PIXELTYPE) == 1 ? (size_t)Header.PixelSize : 1;
+	size_t FrameBytes = FramePixels * (size_t)Header.PixelSize;
+	size_t Done = 0;
+	int PixelSize = (int)Header.PixelSize;
+	int Endian = (int)Header.Endian;
+
+	while (Done < NumPixels && Result == APP_SUCCESS && FramesWritten < Header.NumFrames) {
+		if (FrameFill == 0 && NumPixels - Done >= FramePixels) {
+			int NumFrames = (int)((NumPixels - Done) / FramePixels);
+			int MaxFrames = (int)(IMAGEFILE_BATCH_PIXELS / FramePixels);
+
+			if (MaxFrames < 1) {
+				MaxFrames = 1;
+			}
+			if (NumFrames > MaxFrames) {
+				NumFrames = MaxFrames;
+			}
+			if (NumFrames > Header.NumFrames - FramesWritten) {
+				NumFrames = Header.NumFrames - FramesWritten;
+			}
+
+			std::vector<std::vector<BYTE>> Stored((size_t)NumFrames);
+			const PIXELTYPE* First = &Image[Done * Step];
+			ParallelFor(0, NumFrames, [&](int StartFrame, int EndFrame) {
+				std::vector<BYTE> Pixels(FrameBytes);
+				for (int i = StartFrame; i < EndFrame; i++) {
+					ToFilePixels(Pixels.data(), &First[(size_t)i * FramePixels * Step], FramePixels, PixelSize, Endian);
+					EncodeFrame(Pixels.data(), FramePixels, PixelSize, Endian, Compress, Stored[i]);
+				}
+			});
+			for (int i = 0; i < NumFrames && Result == APP_SUCCESS; i++) {
+				Result = WriteStoredFrame(Stored[i]);
+			}
+			Done += (size_t)NumFrames * FramePixels;
+			continue;
+		}
+
+		size_t Count = FramePixels - FrameFill;
+		if (Count > NumPixels - Done) {
+			Count = NumPixels - Done;
+		}
+		ToFilePixels(&Frame[FrameFill * (size_t)PixelSize], &Image[Done * Step], Count, PixelSize, Endian);
+		FrameFill += Count;
+		Done += Count;
+
+		if (FrameFill == FramePixels) {
+			std::vector<BYTE> Stored;
+			EncodeFrame(Frame.data(), FramePixels, PixelSize, Endian, Compress, Stored);
+			Result = WriteStoredFrame(Stored);
+			FrameFill = 0;
+		}
+	}
+	return Result;
+}
+
+//*****************************************************************************************
+//
+//	ImageFileWriter::WriteStoredFrame
+//
+//	Private function, write the next encoded frame and add it to the offset table
+//
+//*****************************************************************************************
+int ImageFileWriter::WriteStoredFrame(const std::vector<BYTE>& Stored)
+{
+	if (!Stored.empty() && fwrite(Stored.data(), 1, Stored.size(), Out) != Stored.size()) {
+		return APPERR_FILEWRITE;
+	}
+	Offsets[(size_t)FramesWritten + 1] = Offsets[FramesWritten] + (ULONGLONG)Stored.size();
+	FramesWritten++;
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	ImageFileWriter::Close
+//
+//	Finish and close the image file.  In a version 2 file a partly written
+//	frame is filled with 0 pixels, frames that were not written are all 0 and
+//	the offset table is written.
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file,
+//		the first error of any of the writes
+//
+//*****************************************************************************************
+int ImageFileWriter::Close(void)
+{
+	int iRes;
+
+	if (Out == NULL) {
+		return Result;
+	}
+
+	if (Header.Version == IMAGEFILE_VERSION_PACKED && Result == APP_SUCCESS) {
+		if (FrameFill != 0) {
+			std::vector<BYTE> Stored;
+			memset(&Frame[FrameFill * (size_t)Header.PixelSize], 0, (FramePixels - FrameFill) * (size_t)Header.PixelSize);
+			EncodeFrame(Frame.data(), FramePixels, (int)Header.PixelSize, (int)Header.Endian, Compress, Stored);
+			Result = WriteStoredFrame(Stored);
+			FrameFill = 0;
+		}
+		for (; FramesWritten < Header.NumFrames; FramesWritten++) {
+			Offsets[(size_t)FramesWritten + 1] = Offsets[FramesWritten];
+		}
+		if (Result == APP_SUCCESS) {
+			if (_fseeki64(Out, (long long)sizeof(IMAGINGHEADER), SEEK_SET) != 0 ||
+				fwrite(Offsets.data(), sizeof(ULONGLONG), Offsets.size(), Out) != Offsets.size()) {
+				Result = APPERR_FILEWRITE;
+			}
+		}
+	}
+
+	iRes = fclose(Out);
+	Out = NULL;
+	if (iRes != 0 && Result == APP_SUCCESS) {
+		Result = APPERR_FILEWRITE;
+	}
+	Frame.clear();
+	Offsets.clear();
+	return Result;
+}
+
+//*****************************************************************************************
+//
+//	ImageFileReader::Open
+//
+//	Open an image file and read its header and, for a version 2 file, the
+//	frame offset table
+//
+// Parameters:
+//	WCHAR* Filename			image file to open
+//	IMAGINGHEADER* ImageHeader	receives the header, the Version is returned
+//							as 1 since the header describes the pixels read
+//							by ReadFrames, see GetVersion() for the file version
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+int ImageFileReader::Open(WCHAR* Filename, IMAGINGHEADER* ImageHeader)
+{
+	long long FileSize;
+	errno_t ErrNum;
+	int iRes;
+
+	Close();
+
+	ErrNum = _wfopen_s(&In, Filename, L"rb");
+	if (In == NULL) {
+		return APPERR_FILEOPEN;
+	}
+
+	if (fread(&Header, sizeof(IMAGINGHEADER), 1, In) != 1) {
+		Close();
+		return APPERR_FILEREAD;
+	}
+
+	iRes = ValidateLoadHeader(&Header);
+	if (iRes != APP_SUCCESS) {
+		Close();
+		return iRes;
+	}
+	FramePixels = (size_t)Header.Xsize * (size_t)Header.Ysize;
+
+	if (Header.Version == IMAGEFILE_VERSION_PACKED) {
+		Offsets.resize((size_t)Header.NumFrames + 1);
+		if (fread(Offsets.data(), sizeof(ULONGLONG), Offsets.size(), In) != Offsets.size()) {
+			Close();
+			return APPERR_FILEREAD;
+		}
+		_fseeki64(In, 0, SEEK_END);
+		FileSize = _ftelli64(In);
+
+		// the frames follow the table in order and end inside the file
+		if (Offsets[0] < (ULONGLONG)sizeof(IMAGINGHEADER) + (ULONGLONG)Offsets.size() * sizeof(ULONGLONG) ||
+			FileSize < 0 || Offsets[Header.NumFrames] > (ULONGLONG)FileSize) {
+			Close();
+			return APPERR_FILEREAD;
+		}
+		for (int i = 0; i < Header.NumFrames; i++) {
+			if (Offsets[(size_t)i + 1] < Offsets[i]) {
+				Close();
+				return APPERR_FILEREAD;
+			}
+		}
+	}
+
+	memcpy(ImageHeader, &Header, sizeof(IMAGINGHEADER));
+	ImageHeader->Version = (short)1;
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	ImageFileReader::ReadFrames
+//
+//	Read NumFrames frames starting with FirstFrame.  Only those frames are
+//	read from the file.  'int' pixels can be read from any file, BYTE and
+//	USHORT pixels must match the PixelSize of the file.
+//
+// Parameters:
+//	int FirstFrame			first frame to read, 0 based
+//	int NumFrames			# of frames to read
+//	PIXELTYPE* Image		receives NumFrames*Xsize*Ysize pixels
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+int ImageFileReader::ReadFrames(int FirstFrame, int NumFrames, int* Image)
+{
+	return Read(FirstFrame, NumFrames, Image);
+}
+
+int ImageFileReader::ReadFrames(int FirstFrame, int NumFrames, BYTE* Image)
+{
+	if (Header.PixelSize != 1) {
+		return APPERR_PARAMETER;
+	}
+	return Read(FirstFrame, NumFrames, Image);
+}
+
+int ImageFileReader::ReadFrames(int FirstFrame, int NumFrames, USHORT* Image)
+{
+	if (Header.PixelSize != 2) {
+		return APPERR_PARAMETER;
+	}
+	return Read(FirstFrame, NumFrames, Image);
+}
+
+template <typename PIXELTYPE>
+int ImageFileReader::Read(int FirstFrame, int NumFrames, PIXELTYPE* Image)
+{
+	std::vector<BYTE> Stored;
+	std::atomic<int> Error(APP_SUCCESS);
+	ULONGLONG Start;
+	int PixelSize = (int)Header.PixelSize;
+	int Endian = (int)Header.Endian;
+
+	if (In == NULL || FirstFrame < 0 || NumFrames < 0 || FirstFrame + NumFrames > Header.NumFrames) {
+		return APPERR_PARAMETER;
+	}
+	if (NumFrames == 0) {
+		return APP_SUCCESS;
+	}
+
+	if (Header.Version != IMAGEFILE_VERSION_PACKED) {
+		long long Position = (long long)sizeof(IMAGINGHEADER) +
+			(long long)FirstFrame * (long long)FramePixels * (long long)PixelSize;
+		if (_fseeki64(In, Position, SEEK_SET) != 0) {
+			return APPERR_FILEREAD;
+		}
+		return ReadImagePixels(In, Image, (size_t)NumFrames * FramePixels, PixelSize, Endian);
+	}
+
+	// the frames are next to each other in the file, read them in one piece
+	// and decode them in parallel
+	Start = Offsets[FirstFrame];
+	Stored.resize((size_t)(Offsets[(size_t)FirstFrame + NumFrames] - Start));
+	if (_fseeki64(In, (long long)Start, SEEK_SET) != 0) {
+		return APPERR_FILEREAD;
+	}
+	if (!Stored.empty() && fread(Stored.data(), 1, Stored.size(), In) != Stored.size()) {
+		return APPERR_FILEREAD;
+	}
+
+	ParallelFor(0, NumFrames, [&](int StartFrame, int EndFrame) {
+		std::vector<BYTE> Scratch;
+		for (int i = StartFrame; i < EndFrame; i++) {
+			size_t Frame = (size_t)FirstFrame + i;
+			int Result = DecodeFrame(&Stored.data()[Offsets[Frame] - Start], (size_t)(Offsets[Frame + 1] - Offsets[Frame]),
+				FramePixels, PixelSize, Endian, Scratch, &Image[(size_t)i * FramePixels]);
+			if (Result != APP_SUCCESS) {
+				Error = Result;
+			}
+		}
+	});
+	return Error;
+}
+
+//*****************************************************************************************
+//
+//	ImageFileReader::Close
+//
+//*****************************************************************************************
+void ImageFileReader::Close(void)
+{
+	if (In != NULL) {
+		fclose(In);
+		In = NULL;
+	}
+	Offsets.clear();
+}
+
+//*****************************************************************************************
+//
+//	ConvertImageFile
+//
+//	Copy an image file to a new image file with a different file version,
+//	for example to pack an archive of version 1 files.  The image is copied
+//	a block of frames at a time.
+//
+// Parameters:
+//	WCHAR* InputFile		image file to convert
+//	WCHAR* OutputFile		new image file, must not be the input file
+//	int Version				1 - version 1, IMAGEFILE_VERSION_PACKED - version 2
+//	BOOL Compress			TRUE - LZ4 compress the frames of a version 2 file
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+int ConvertImageFile(WCHAR* InputFile, WCHAR* OutputFile, int Version, BOOL Compress)
+{
+	ImageFileReader Reader;
+	ImageFileWriter Writer;
+	IMAGINGHEADER Header;
+	std::vector<int> Block;
+	size_t FramePixels;
+	int FramesPerBlock;
+	int iRes;
+
+	if (_wcsicmp(InputFile, OutputFile) == 0) {
+		return APPERR_PARAMETER;
+	}
+
+	iRes = Reader.Open(InputFile, &Header);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	FramePixels = (size_t)Header.Xsize * (size_t)Header.Ysize;
+	FramesPerBlock = (int)(IMAGEFILE_BATCH_PIXELS / FramePixels);
+	if (FramesPerBlock < 1) {
+		FramesPerBlock = 1;
+	}
+	if (FramesPerBlock > Header.NumFrames) {
+		FramesPerBlock = Header.NumFrames;
+	}
+	Block.resize((size_t)FramesPerBlock * FramePixels);
+
+	iRes = Writer.Open(OutputFile, &Header, Version, Compress);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	for (int First = 0; First < Header.NumFrames; First += FramesPerBlock) {
+		int NumFrames = Header.NumFrames - First;
+		if (NumFrames > FramesPerBlock) {
+			NumFrames = FramesPerBlock;
+		}
+		iRes = Reader.ReadFrames(First, NumFrames, Block.data());
+		if (iRes != APP_SUCCESS) {
+			Writer.Close();
+			return iRes;
+		}
+		iRes = Writer.WritePixels(Block.data(), (size_t)NumFrames * FramePixels);
+		if (iRes != APP_SUCCESS) {
+			Writer.Close();
+			return iRes;
+		}
+	}
+
+	return Writer.Close();
+}
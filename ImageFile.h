@@ -0,0 +1,95 @@
+#pragma once
+//
+// ImageFile.h
+// class definitions for the image file reader and writer in ImageFile.cpp
+//
+#include <vector>
+
+// IMAGINGHEADER.Version of an image file with a frame offset table and
+// bit packed or compressed frames, see ImageFile.cpp for the layout
+#define IMAGEFILE_VERSION_PACKED	2
+
+// IMAGEFRAME.Encoding flags
+#define FRAME_BITPACKED		0x01	// 1 bit per pixel, a set bit is OneValue, a clear bit is 0
+#define FRAME_LZ4			0x02	// the frame data is compressed in the LZ4 block format
+
+// start of each frame in a version 2 image file that is not all 0
+#pragma pack(push, 1)
+typedef struct IMAGEFRAME {
+	BYTE Encoding;			// FRAME_ flags, 0 - PixelSize bytes per pixel
+	BYTE Reserved[3];		// 0
+	LONG32 OneValue;		// pixel value of a set bit in a FRAME_BITPACKED frame
+} IMAGEFRAME;
+#pragma pack(pop)
+
+void SetImageFileFormat(int Version, BOOL Compress);
+
+void GetImageFileFormat(int* Version, BOOL* Compress);
+
+int ConvertImageFile(WCHAR* InputFile, WCHAR* OutputFile, int Version, BOOL Compress);
+
+// Writes an image file a block of pixels at a time, the pixels are
+// written in order, frame after frame, as with WriteImagePixels()
+class ImageFileWriter
+{
+private:
+	FILE* Out = NULL;
+	IMAGINGHEADER Header;				// header of the file being written
+	BOOL Compress = FALSE;				// TRUE - LZ4 compress the frames (version 2)
+	int Result = APP_SUCCESS;			// first error, later writes are ignored
+	size_t FramePixels = 0;				// Xsize*Ysize
+	int FramesWritten = 0;				// # of complete frames written (version 2)
+	size_t FrameFill = 0;				// # of pixels in Frame (version 2)
+	std::vector<BYTE> Frame;			// frame being filled, in the file pixel format
+	std::vector<ULONGLONG> Offsets;		// frame offset table (version 2)
+
+	int AddFilePixels(const BYTE* Pixels, size_t NumPixels);
+	int WriteStoredFrame(const std::vector<BYTE>& Stored);
+	template <typename PIXELTYPE> int AddPixels(const PIXELTYPE* Image, size_t NumPixels);
+
+public:
+	ImageFileWriter() {
+	};
+
+	~ImageFileWriter() {
+		Close();
+	};
+
+	int Open(WCHAR* Filename, IMAGINGHEADER* ImageHeader);
+	int Open(WCHAR* Filename, IMAGINGHEADER* ImageHeader, int Version, BOOL Compression);
+	int WritePixels(const int* Image, size_t NumPixels);
+	int WritePixels(const BYTE* Image, size_t NumPixels);
+	int WritePixels(const USHORT* Image, size_t NumPixels);
+	int WriteFilePixels(const BYTE* Pixels, size_t NumPixels);
+	int Close(void);
+};
+
+// Reads any frames of a version 1 or version 2 image file
+class ImageFileReader
+{
+private:
+	FILE* In = NULL;
+	IMAGINGHEADER Header;				// header as stored in the file
+	size_t FramePixels = 0;				// Xsize*Ysize
+	std::vector<ULONGLONG> Offsets;		// frame offset table (version 2)
+
+	template <typename PIXELTYPE> int Read(int FirstFrame, int NumFrames, PIXELTYPE* Image);
+
+public:
+	ImageFileReader() {
+	};
+
+	~ImageFileReader() {
+		Close();
+	};
+
+	int Open(WCHAR* Filename, IMAGINGHEADER* ImageHeader);
+	int ReadFrames(int FirstFrame, int NumFrames, int* Image);
+	int ReadFrames(int FirstFrame, int NumFrames, BYTE* Image);
+	int ReadFrames(int FirstFrame, int NumFrames, USHORT* Image);
+	void Close(void);
+
+	int GetVersion(void) {
+		return Header.Version == IMAGEFILE_VERSION_PACKED ? IMAGEFILE_VERSION_PACKED : 1;
+	};
+};
@@ -0,0 +1,1020 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// ImageIO.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Bulk image file I/O
+//
+// The image file pixels were originally read one pixel at a time using fread()
+// and then converted from BYTE, USHORT or LONG to 'int' one pixel at a time.
+// These functions move the pixel data using either a memory mapped view of
+// the file or large block reads.  The conversion to 'int' is done for a complete
+// block of pixels at a time.  The conversion loops are kept as simple unit stride
+// loops so that the compiler can vectorize them.
+//
+// The same applies to writing image files.  The 'int' image is clamped and
+// narrowed to the PixelSize of the file one block at a time and written
+// with a single fwrite per block.
+//
+// Application standardized error numbers for functions that perform transform processes:
+//      1 - success
+//      0 - parameter or image header problem
+//     -1 memory allocation failure
+//     -2 open file failure
+//     -3 file read failure
+//     -4 incorect file type
+//     -5 file sizes mismatch
+//     -6 not yet implemented
+//     -7 file write failure
+//
+// Native pixel size
+//
+// 1 and 2 byte images can also be held in memory at their file pixel size
+// (IMAGEBUFFER8, IMAGEBUFFER16) instead of 'int'.  These are read and written
+// without the conversion to 'int', 2 byte MAC format pixels are only byte
+// swapped.  The image buffer functions are templates instantiated for
+// IMAGEBUFFER, IMAGEBUFFER8 and IMAGEBUFFER16.
+//
+// Streaming (StreamImageFile)
+//
+// Images with many frames can be larger than the available memory once they
+// are converted to 'int'.  These are processed a block of frames at a time.
+// While one block is being transformed the next block is read by a reader
+// thread and the previous result is written by a writer thread, so the peak
+// memory use is 2 input and 2 output blocks regardless of the file size.
+//
+// V1.3.2.1 2026-10-14  Initial release, bulk loading of image file pixels
+//                      Added, block image writer shared by the image transforms
+//                      Added, in memory image buffers used by the transform pipeline
+//                      Added, double buffered streaming of large images a block of frames at a time
+//                      Added, 1 and 2 byte image buffers that keep the file pixel size
+//                      Added, image files are read and written through ImageFileReader and
+//                      ImageFileWriter (ImageFile.cpp), version 1 or version 2 image files
+//                      Added, image buffers are borrowed from the buffer pool (BufferPool.cpp)
+//                      Correction, MapImageFile opens files that are open for writing elsewhere
+//
+#include "framework.h"
+#include <stdio.h>
+#include <thread>
+#include "AppErrors.h"
+#include "imaging.h"
+#include "ImageIO.h"
+#include "ImageFile.h"
+#include "BufferPool.h"
+
+// number of bytes read in one block when the file can not be memory mapped
+#define IMAGEIO_BLOCKSIZE (4*1024*1024)
+
+// target # of pixels in one block of frames when an image is streamed
+#define STREAM_BLOCK_PIXELS (16*1024*1024)
+
+//*****************************************************************************************
+//
+//	MapImageFile
+//
+//	Open a read only memory mapped view of the entire file.
+//	UnmapImageFile() must be called to release the view when finished.
+//
+// Parameters:
+//	WCHAR* Filename			File to map
+//	IMAGEFILEMAP* Map		structure receiving the view information
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+int MapImageFile(WCHAR* Filename, IMAGEFILEMAP* Map)
+{
+	LARGE_INTEGER Size;
+
+	Map->hFile = INVALID_HANDLE_VALUE;
+	Map->hMapping = NULL;
+	Map->View = NULL;
+	Map->FileSize = 0;
+
+	// shared for writing the same as _wfopen_s(L"rb"), the file can be open in another program
+	Map->hFile = CreateFile(Filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+				OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (Map->hFile == INVALID_HANDLE_VALUE) {
+		return APPERR_FILEOPEN;
+	}
+
+	if (!GetFileSizeEx(Map->hFile, &Size) || Size.QuadPart == 0) {
+		// an empty file can not be mapped
+		UnmapImageFile(Map);
+		return APPERR_FILEREAD;
+	}
+	if ((ULONGLONG)Size.QuadPart > (ULONGLONG)((SIZE_T)-1)) {
+		// larger than the address space
+		UnmapImageFile(Map);
+		return APPERR_MEMALLOC;
+	}
+	Map->FileSize = Size.QuadPart;
+
+	Map->hMapping = CreateFileMapping(Map->hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (Map->hMapping == NULL) {
+		UnmapImageFile(Map);
+		return APPERR_MEMALLOC;
+	}
+
+	Map->View = (BYTE*)MapViewOfFile(Map->hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (Map->View == NULL) {
+		UnmapImageFile(Map);
+		return APPERR_MEMALLOC;
+	}
+
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	UnmapImageFile
+//
+//	Release a view created by MapImageFile().  This can be called on a partially
+//	created view.
+//
+// Parameters:
+//	IMAGEFILEMAP* Map		view to release
+//
+//*****************************************************************************************
+void UnmapImageFile(IMAGEFILEMAP* Map)
+{
+	if (Map->View) {
+		UnmapViewOfFile(Map->View);
+		Map->View = NULL;
+	}
+	if (Map->hMapping) {
+		CloseHandle(Map->hMapping);
+		Map->hMapping = NULL;
+	}
+	if (Map->hFile != INVALID_HANDLE_VALUE) {
+		CloseHandle(Map->hFile);
+		Map->hFile = INVALID_HANDLE_VALUE;
+	}
+	Map->FileSize = 0;
+	return;
+}
+
+//*****************************************************************************************
+//
+//	WidenPixels
+//
+//	Convert a block of image file pixels to 'int'
+//	1 byte pixels are unsigned (BYTE), 2 byte pixels are unsigned (USHORT),
+//	4 byte pixels are signed (LONG).
+//	Endian 0 is MAC format, the 2 and 4 byte pixels are byte swapped.
+//
+// Parameters:
+//	int* Image				destination, NumPixels entries
+//	const BYTE* Pixels		pixels as stored in the image file
+//	size_t NumPixels		number of pixels to convert
+//	int PixelSize			1,2 or 4 bytes
+//	int Endian				0 MAC format, -1 PC format
+//
+//*****************************************************************************************
+void WidenPixels(int* Image, const BYTE* Pixels, size_t NumPixels, int PixelSize, int Endian)
+{
+	if (PixelSize == 1) {
+		for (size_t i = 0; i < NumPixels; i++) {
+			Image[i] = (int)Pixels[i];
+		}
+	}
+	else if (PixelSize == 2) {
+		const USHORT* Src = (const USHORT*)Pixels;
+		if (!Endian) {
+			for (size_t i = 0; i < NumPixels; i++) {
+				Image[i] = (int)_byteswap_ushort(Src[i]);
+			}
+		}
+		else {
+			for (size_t i = 0; i < NumPixels; i++) {
+				Image[i] = (int)Src[i];
+			}
+		}
+	}
+	else {
+		if (!Endian) {
+			const ULONG* Src = (const ULONG*)Pixels;
+			for (size_t i = 0; i < NumPixels; i++) {
+				Image[i] = (int)_byteswap_ulong(Src[i]);
+			}
+		}
+		else {
+			memcpy(Image, Pixels, NumPixels * sizeof(int));
+		}
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	ReadImagePixels
+//
+//	Read and convert pixels from an open image file using large block reads.
+//	This is used when the image file can not be memory mapped.
+//	The file must be positioned at the first pixel to read.
+//
+// Parameters:
+//	FILE* In				open image file
+//	int* Image				destination, NumPixels entries
+//	size_t NumPixels		number of pixels to read
+//	int PixelSize			1,2 or 4 bytes
+//	int Endian				0 MAC format, -1 PC format
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+int ReadImagePixels(FILE* In, int* Image, size_t NumPixels, int PixelSize, int Endian)
+{
+	BYTE* Block;
+	size_t BlockPixels;
+	size_t iRead;
+
+	if (PixelSize != 1 && PixelSize != 2 && PixelSize != 4) {
+		return APPERR_PARAMETER;
+	}
+
+	BlockPixels = IMAGEIO_BLOCKSIZE / PixelSize;
+	if (BlockPixels > NumPixels) {
+		BlockPixels = NumPixels;
+	}
+	if (BlockPixels == 0) {
+		return APP_SUCCESS;
+	}
+
+	Block = new BYTE[BlockPixels * PixelSize];
+	if (Block == NULL) {
+		return APPERR_MEMALLOC;
+	}
+
+	for (size_t i = 0; i < NumPixels; i += BlockPixels) {
+		size_t Count = NumPixels - i;
+		if (Count > BlockPixels) {
+			Count = BlockPixels;
+		}
+		iRead = fread(Block, PixelSize, Count, In);
+		if (iRead != Count) {
+			delete[] Block;
+			return APPERR_FILEREAD;
+		}
+		WidenPixels(&Image[i], Block, Count, PixelSize, Endian);
+	}
+
+	delete[] Block;
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	NarrowPixels
+//
+//	Convert a block of 'int' pixels to the image file pixel format.
+//	1 byte pixels are clamped to 0-255, 2 byte pixels are clamped to 0-65535,
+//	4 byte pixels are not changed.
+//	Endian 0 is MAC format, the 2 and 4 byte pixels are byte swapped.
+//
+// Parameters:
+//	BYTE* Pixels			destination, NumPixels*PixelSize bytes
+//	const int* Image		'int' pixels to convert
+//	size_t NumPixels		number of pixels to convert
+//	int PixelSize			1,2 or 4 bytes
+//	int Endian				0 MAC format, -1 PC format
+//
+//*****************************************************************************************
+void NarrowPixels(BYTE* Pixels, const int* Image, size_t NumPixels, int PixelSize, int Endian)
+{
+	if (PixelSize == 1) {
+		for (size_t i = 0; i < NumPixels; i++) {
+			int Value = Image[i];
+			Value = Value < 0 ? 0 : Value;
+			Value = Value > 255 ? 255 : Value;
+			Pixels[i] = (BYTE)Value;
+		}
+	}
+	else if (PixelSize == 2) {
+		USHORT* Dest = (USHORT*)Pixels;
+		for (size_t i = 0; i < NumPixels; i++) {
+			int Value = Image[i];
+			Value = Value < 0 ? 0 : Value;
+			Value = Value > 65535 ? 65535 : Value;
+			Dest[i] = (USHORT)Value;
+		}
+		if (!Endian) {
+			for (size_t i = 0; i < NumPixels; i++) {
+				Dest[i] = _byteswap_ushort(Dest[i]);
+			}
+		}
+	}
+	else {
+		if (!Endian) {
+			ULONG* Dest = (ULONG*)Pixels;
+			for (size_t i = 0; i < NumPixels; i++) {
+				Dest[i] = _byteswap_ulong((ULONG)Image[i]);
+			}
+		}
+		else {
+			memcpy(Pixels, Image, NumPixels * sizeof(int));
+		}
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	WriteImagePixels
+//
+//	Clamp, narrow and write pixels to an open image file in large blocks.
+//	The file must be positioned where the first pixel is to be written,
+//	normally just after the image header.
+//
+// Parameters:
+//	FILE* Out				open image file
+//	const int* Image		pixels to write
+//	size_t NumPixels		number of pixels to write
+//	int PixelSize			1,2 or 4 bytes
+//	int Endian				0 MAC format, -1 PC format
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+int WriteImagePixels(FILE* Out, const int* Image, size_t NumPixels, int PixelSize, int Endian)
+{
+	BYTE* Block;
+	size_t BlockPixels;
+	size_t iWrite;
+
+	if (PixelSize != 1 && PixelSize != 2 && PixelSize != 4) {
+		return APPERR_PARAMETER;
+	}
+
+	BlockPixels = IMAGEIO_BLOCKSIZE / PixelSize;
+	if (BlockPixels > NumPixels) {
+		BlockPixels = NumPixels;
+	}
+	if (BlockPixels == 0) {
+		return APP_SUCCESS;
+	}
+
+	Block = new BYTE[BlockPixels * PixelSize];
+	if (Block == NULL) {
+		return APPERR_MEMALLOC;
+	}
+
+	for (size_t i = 0; i < NumPixels; i += BlockPixels) {
+		size_t Count = NumPixels - i;
+		if (Count > BlockPixels) {
+			Count = BlockPixels;
+		}
+		NarrowPixels(Block, &Image[i], Count, PixelSize, Endian);
+		iWrite = fwrite(Block, PixelSize, Count, Out);
+		if (iWrite != Count) {
+			delete[] Block;
+			return APPERR_FILEWRITE;
+		}
+	}
+
+	delete[] Block;
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	SwapPixels
+//
+//	Byte swap a block of 2 byte pixels, MAC format <-> PC format.
+//	1 byte pixels are not changed.
+//
+//*****************************************************************************************
+static void SwapPixels(BYTE* Image, size_t NumPixels)
+{
+	UNREFERENCED_PARAMETER(Image);
+	UNREFERENCED_PARAMETER(NumPixels);
+	return;
+}
+
+static void SwapPixels(USHORT* Image, size_t NumPixels)
+{
+	for (size_t i = 0; i < NumPixels; i++) {
+		Image[i] = _byteswap_ushort(Image[i]);
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	ReadNativePixels
+//
+//	Read 1 or 2 byte pixels from an open image file without converting them
+//	to 'int'.  The pixels are read straight into Image.  2 byte MAC format
+//	pixels are byte swapped after they are read.
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+static int ReadNativePixels(FILE* In, PIXELTYPE* Image, size_t NumPixels, int PixelSize, int Endian)
+{
+	size_t BlockPixels = IMAGEIO_BLOCKSIZE / sizeof(PIXELTYPE);
+
+	if (PixelSize != (int)sizeof(PIXELTYPE)) {
+		return APPERR_PARAMETER;
+	}
+
+	for (size_t i = 0; i < NumPixels; i += BlockPixels) {
+		size_t Count = NumPixels - i;
+		if (Count > BlockPixels) {
+			Count = BlockPixels;
+		}
+		if (fread(&Image[i], sizeof(PIXELTYPE), Count, In) != Count) {
+			return APPERR_FILEREAD;
+		}
+		if (!Endian) {
+			SwapPixels(&Image[i], Count);
+		}
+	}
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	WriteNativePixels
+//
+//	Write 1 or 2 byte pixels to an open image file.  The pixels are already
+//	at the file pixel size, so no clamping is needed.  2 byte MAC format
+//	pixels are byte swapped in a block before they are written.
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+static int WriteNativePixels(FILE* Out, const PIXELTYPE* Image, size_t NumPixels, int PixelSize, int Endian)
+{
+	PIXELTYPE* Block;
+	size_t BlockPixels;
+
+	if (PixelSize != (int)sizeof(PIXELTYPE)) {
+		return APPERR_PARAMETER;
+	}
+
+	if (Endian || sizeof(PIXELTYPE) == 1) {
+		if (NumPixels && fwrite(Image, sizeof(PIXELTYPE), NumPixels, Out) != NumPixels) {
+			return APPERR_FILEWRITE;
+		}
+		return APP_SUCCESS;
+	}
+
+	BlockPixels = IMAGEIO_BLOCKSIZE / sizeof(PIXELTYPE);
+	if (BlockPixels > NumPixels) {
+		BlockPixels = NumPixels;
+	}
+	if (BlockPixels == 0) {
+		return APP_SUCCESS;
+	}
+
+	Block = new PIXELTYPE[BlockPixels];
+	if (Block == NULL) {
+		return APPERR_MEMALLOC;
+	}
+
+	for (size_t i = 0; i < NumPixels; i += BlockPixels) {
+		size_t Count = NumPixels - i;
+		if (Count > BlockPixels) {
+			Count = BlockPixels;
+		}
+		memcpy(Block, &Image[i], Count * sizeof(PIXELTYPE));
+		SwapPixels(Block, Count);
+		if (fwrite(Block, sizeof(PIXELTYPE), Count, Out) != Count) {
+			delete[] Block;
+			return APPERR_FILEWRITE;
+		}
+	}
+
+	delete[] Block;
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	ReadImagePixels, WriteImagePixels
+//
+//	1 and 2 byte pixel versions, PixelSize must match the pixel type
+//
+//*****************************************************************************************
+int ReadImagePixels(FILE* In, BYTE* Image, size_t NumPixels, int PixelSize, int Endian)
+{
+	return ReadNativePixels(In, Image, NumPixels, PixelSize, Endian);
+}
+
+int ReadImagePixels(FILE* In, USHORT* Image, size_t NumPixels, int PixelSize, int Endian)
+{
+	return ReadNativePixels(In, Image, NumPixels, PixelSize, Endian);
+}
+
+int WriteImagePixels(FILE* Out, const BYTE* Image, size_t NumPixels, int PixelSize, int Endian)
+{
+	return WriteNativePixels(Out, Image, NumPixels, PixelSize, Endian);
+}
+
+int WriteImagePixels(FILE* Out, const USHORT* Image, size_t NumPixels, int PixelSize, int Endian)
+{
+	return WriteNativePixels(Out, Image, NumPixels, PixelSize, Endian);
+}
+
+//*****************************************************************************************
+//
+//	WriteImageFile
+//
+//	Write a complete image file, header followed by all the frames.
+//	The number of pixels written is Xsize*Ysize*NumFrames from the header.
+//	The file version is the image file format setting (ImageFile.cpp).
+//
+// Parameters:
+//	WCHAR* Filename			image file to create
+//	const int* Image		pixels to write, BYTE and USHORT pixels must match
+//							the header PixelSize
+//	IMAGINGHEADER* Header	header for the output image file
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+static int WritePixelFile(WCHAR* Filename, const PIXELTYPE* Image, IMAGINGHEADER* Header)
+{
+	ImageFileWriter OutFile;
+	int iRes;
+
+	iRes = OutFile.Open(Filename, Header);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	OutFile.WritePixels(Image, (size_t)Header->Xsize * (size_t)Header->Ysize * (size_t)Header->NumFrames);
+
+	// the first write error is returned by Close
+	return OutFile.Close();
+}
+
+int WriteImageFile(WCHAR* Filename, const int* Image, IMAGINGHEADER* Header)
+{
+	return WritePixelFile(Filename, Image, Header);
+}
+
+int WriteImageFile(WCHAR* Filename, const BYTE* Image, IMAGINGHEADER* Header)
+{
+	return WritePixelFile(Filename, Image, Header);
+}
+
+int WriteImageFile(WCHAR* Filename, const USHORT* Image, IMAGINGHEADER* Header)
+{
+	return WritePixelFile(Filename, Image, Header);
+}
+
+//*****************************************************************************************
+//
+//	ReserveImageBuffer
+//
+//	Set the header of an image buffer and make sure the buffer can hold
+//	Xsize*Ysize*NumFrames pixels.  The pixel memory is only reallocated when
+//	it is too small, so a buffer can be reused for a series of images without
+//	reallocating memory for each one.  The pixel values are not preserved.
+//
+// Parameters:
+//	IMAGEBUFFER* Buffer		buffer to size, zero initialize before first use
+//	IMAGINGHEADER* Header	header of the image the buffer will hold
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+int ReserveImageBuffer(PIXELBUFFER<PIXELTYPE>* Buffer, IMAGINGHEADER* Header)
+{
+	size_t NumPixels;
+
+	if (Header->Xsize <= 0 || Header->Ysize <= 0 || Header->NumFrames <= 0) {
+		return APPERR_PARAMETER;
+	}
+	NumPixels = (size_t)Header->Xsize * (size_t)Header->Ysize * (size_t)Header->NumFrames;
+
+	if (Buffer->Image == NULL || Buffer->Capacity < NumPixels) {
+		if (Buffer->Image) {
+			PoolFree(Buffer->Image);
+		}
+		Buffer->Capacity = 0;
+		Buffer->Image = (PIXELTYPE*)PoolAlloc(NumPixels * sizeof(PIXELTYPE));
+		if (Buffer->Image == NULL) {
+			return APPERR_MEMALLOC;
+		}
+		Buffer->Capacity = NumPixels;
+	}
+
+	memcpy(&Buffer->Header, Header, sizeof(IMAGINGHEADER));
+	return APP_SUCCESS;
+}
+
+template int ReserveImageBuffer(IMAGEBUFFER* Buffer, IMAGINGHEADER* Header);
+template int ReserveImageBuffer(IMAGEBUFFER8* Buffer, IMAGINGHEADER* Header);
+template int ReserveImageBuffer(IMAGEBUFFER16* Buffer, IMAGINGHEADER* Header);
+
+//*****************************************************************************************
+//
+//	FreeImageBuffer
+//
+//	Release the pixel memory of an image buffer.
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+void FreeImageBuffer(PIXELBUFFER<PIXELTYPE>* Buffer)
+{
+	if (Buffer->Image) {
+		PoolFree(Buffer->Image);
+		Buffer->Image = NULL;
+	}
+	Buffer->Capacity = 0;
+	return;
+}
+
+template void FreeImageBuffer(IMAGEBUFFER* Buffer);
+template void FreeImageBuffer(IMAGEBUFFER8* Buffer);
+template void FreeImageBuffer(IMAGEBUFFER16* Buffer);
+
+//*****************************************************************************************
+//
+//	LoadImageBuffer
+//
+//	Load an image file into an image buffer.  Any previous image in the
+//	buffer is replaced, its memory is reused if it is large enough.  The
+//	image is converted to 'int', see LoadNativeBuffer for the 1 and 2 byte
+//	image buffers.  The buffer is released if the file can not be loaded.
+//
+// Parameters:
+//	IMAGEBUFFER* Buffer		buffer to receive the image
+//	WCHAR* Filename			image file to load
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+int LoadImageBuffer(IMAGEBUFFER* Buffer, WCHAR* Filename)
+{
+	IMAGINGHEADER Header;
+	int iRes;
+
+	iRes = LoadImagePixels(Filename, &Header, [=](IMAGINGHEADER* FileHeader) -> int* {
+		if (ReserveImageBuffer(Buffer, FileHeader) != APP_SUCCESS) {
+			return NULL;
+		}
+		return Buffer->Image;
+	});
+	if (iRes != APP_SUCCESS) {
+		FreeImageBuffer(Buffer);
+	}
+	return iRes;
+}
+
+//*****************************************************************************************
+//
+//	LoadNativeBuffer
+//
+//	LoadImageBuffer for 1 and 2 byte image buffers.  The image file PixelSize
+//	must match the buffer pixel type, APPERR_FILETYPE is returned if it
+//	does not.
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+static int LoadNativeBuffer(PIXELBUFFER<PIXELTYPE>* Buffer, WCHAR* Filename)
+{
+	ImageFileReader InFile;
+	IMAGINGHEADER Header;
+	int iRes;
+
+	iRes = InFile.Open(Filename, &Header);
+	if (iRes == APP_SUCCESS && Header.PixelSize != (short)sizeof(PIXELTYPE)) {
+		iRes = APPERR_FILETYPE;
+	}
+	if (iRes == APP_SUCCESS) {
+		iRes = ReserveImageBuffer(Buffer, &Header);
+	}
+	if (iRes == APP_SUCCESS) {
+		iRes = InFile.ReadFrames(0, Header.NumFrames, Buffer->Image);
+	}
+
+	if (iRes != APP_SUCCESS) {
+		FreeImageBuffer(Buffer);
+	}
+	return iRes;
+}
+
+int LoadImageBuffer(IMAGEBUFFER8* Buffer, WCHAR* Filename)
+{
+	return LoadNativeBuffer(Buffer, Filename);
+}
+
+int LoadImageBuffer(IMAGEBUFFER16* Buffer, WCHAR* Filename)
+{
+	return LoadNativeBuffer(Buffer, Filename);
+}
+
+//*****************************************************************************************
+//
+//	SaveImageBuffer
+//
+//	Write the image in an image buffer to an image file.
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+int SaveImageBuffer(WCHAR* Filename, PIXELBUFFER<PIXELTYPE>* Buffer)
+{
+	if (Buffer->Image == NULL) {
+		return APPERR_PARAMETER;
+	}
+	return WriteImageFile(Filename, Buffer->Image, &Buffer->Header);
+}
+
+template int SaveImageBuffer(WCHAR* Filename, IMAGEBUFFER* Buffer);
+template int SaveImageBuffer(WCHAR* Filename, IMAGEBUFFER8* Buffer);
+template int SaveImageBuffer(WCHAR* Filename, IMAGEBUFFER16* Buffer);
+
+//*****************************************************************************************
+//
+//	ClampImageBuffer
+//
+//	Clamp the pixels in an image buffer to the range of the header PixelSize,
+//	the same clamping that is applied when the image is written to a file.
+//	1 byte pixels are clamped to 0-255, 2 byte pixels are clamped to 0-65535,
+//	4 byte pixels are not changed.  This is used between the steps of a
+//	pipeline so that each step sees the same pixels it would if the previous
+//	step had been written to a file and loaded back.
+//
+//*****************************************************************************************
+void ClampImageBuffer(IMAGEBUFFER* Buffer)
+{
+	size_t NumPixels;
+	int MaxValue;
+
+	if (Buffer->Image == NULL || Buffer->Header.PixelSize == 4) {
+		return;
+	}
+	MaxValue = Buffer->Header.PixelSize == 1 ? 255 : 65535;
+	NumPixels = (size_t)Buffer->Header.Xsize * (size_t)Buffer->Header.Ysize * (size_t)Buffer->Header.NumFrames;
+
+	int* Image = Buffer->Image;
+	for (size_t i = 0; i < NumPixels; i++) {
+		int Value = Image[i];
+		Value = Value < 0 ? 0 : Value;
+		Value = Value > MaxValue ? MaxValue : Value;
+		Image[i] = Value;
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	StreamFramesPerBlock
+//
+//	Decide if an image should be streamed by StreamImageFile instead of being
+//	loaded into memory.  An image is streamed when it has more than one frame
+//	and more than STREAM_MIN_PIXELS pixels.
+//
+// Parameters:
+//	IMAGINGHEADER* Header	header of the input image
+//
+//  return value:
+//  0 - load the image into memory
+//  >0 # of frames to process in each block
+//
+//*****************************************************************************************
+int StreamFramesPerBlock(IMAGINGHEADER* Header)
+{
+	size_t FramePixels;
+	size_t NumPixels;
+	int FramesPerBlock;
+
+	if (Header->NumFrames <= 1 || Header->Xsize <= 0 || Header->Ysize <= 0) {
+		return 0;
+	}
+	FramePixels = (size_t)Header->Xsize * (size_t)Header->Ysize;
+	NumPixels = FramePixels * (size_t)Header->NumFrames;
+	if (NumPixels <= STREAM_MIN_PIXELS) {
+		return 0;
+	}
+
+	FramesPerBlock = (int)(STREAM_BLOCK_PIXELS / FramePixels);
+	if (FramesPerBlock < 1) {
+		FramesPerBlock = 1;
+	}
+	if (FramesPerBlock > Header->NumFrames) {
+		FramesPerBlock = Header->NumFrames;
+	}
+	return FramesPerBlock;
+}
+
+//*****************************************************************************************
+//
+//	StreamImageFile
+//
+//	Apply a transform to an image file a block of frames at a time and write
+//	the result to an output image file.  The blocks are held as PIXELTYPE pixels,
+//	a 1 or 2 byte PIXELTYPE must match the input file PixelSize and the transform
+//	must keep it.  The next block is read and the previous
+//	result is written by separate threads while the current block is transformed.
+//	Only 2 input blocks and 2 output blocks are in memory at any time.
+//
+//	The transform is called once for each block with an IMAGEBUFFER holding
+//	FramesPerBlock frames (fewer for the last block).  It must process each frame
+//	independently and produce the same number of frames with the same frame size
+//	for every block.  The transform may change the input buffer.
+//
+// Parameters:
+//	WCHAR* InputFile			input image file
+//	WCHAR* OutputFile			output image file
+//	int FramesPerBlock			# of frames in each block (see StreamFramesPerBlock)
+//	PIXELTRANSFORM& Transform	transform applied to each block, returns APP_SUCCESS or an error
+//	IMAGINGHEADER* OutputHeader	receives the header of the output image file, may be NULL
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//      APPERR_PARAMETER is returned for an invalid input header or when the
+//		transform does not produce the same frame size for all blocks
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+int StreamImageFile(WCHAR* InputFile, WCHAR* OutputFile, int FramesPerBlock,
+	const PIXELTRANSFORM<PIXELTYPE>& Transform, IMAGINGHEADER* OutputHeader)
+{
+	ImageFileReader InFile;
+	ImageFileWriter OutFile;
+	IMAGINGHEADER Header;
+	IMAGINGHEADER OutHeader;
+	PIXELBUFFER<PIXELTYPE> Input[2] = { 0 };
+	PIXELBUFFER<PIXELTYPE> Output[2] = { 0 };
+	std::thread Reader;
+	std::thread Writer;
+	int ReadResult = APP_SUCCESS;
+	int WriteResult = APP_SUCCESS;
+	int NumBlocks;
+	int iRes;
+
+	iRes = InFile.Open(InputFile, &Header);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	if (FramesPerBlock <= 0 || FramesPerBlock > Header.NumFrames) {
+		FramesPerBlock = Header.NumFrames;
+	}
+	NumBlocks = (Header.NumFrames + FramesPerBlock - 1) / FramesPerBlock;
+
+	// read a block of frames from the input file into a buffer
+	auto ReadBlock = [&](int Block, PIXELBUFFER<PIXELTYPE>* Buffer) -> int {
+		IMAGINGHEADER BlockHeader;
+		int Result;
+
+		memcpy(&BlockHeader, &Header, sizeof(IMAGINGHEADER));
+		BlockHeader.NumFrames = Header.NumFrames - Block * FramesPerBlock;
+		if (BlockHeader.NumFrames > FramesPerBlock) {
+			BlockHeader.NumFrames = FramesPerBlock;
+		}
+		Result = ReserveImageBuffer(Buffer, &BlockHeader);
+		if (Result != APP_SUCCESS) {
+			return Result;
+		}
+		return InFile.ReadFrames(Block * FramesPerBlock, (int)BlockHeader.NumFrames, Buffer->Image);
+	};
+
+	// write a transformed block of frames to the output file
+	auto WriteBlock = [&](PIXELBUFFER<PIXELTYPE>* Buffer) -> int {
+		return OutFile.WritePixels(Buffer->Image,
+			(size_t)Buffer->Header.Xsize * (size_t)Buffer->Header.Ysize * (size_t)Buffer->Header.NumFrames);
+	};
+
+	ReadResult = ReadBlock(0, &Input[0]);
+
+	for (int Block = 0; Block < NumBlocks; Block++) {
+		int Current = Block % 2;
+		int BlockFrames;
+
+		// wait for this block to be read
+		if (Reader.joinable()) {
+			Reader.join();
+		}
+		iRes = ReadResult;
+		if (iRes != APP_SUCCESS) {
+			break;
+		}
+		BlockFrames = Input[Current].Header.NumFrames;
+
+		// read the next block while this one is transformed
+		if (Block + 1 < NumBlocks) {
+			auto ReadNext = [&ReadBlock, &ReadResult, &Input, Block, Current]() {
+				ReadResult = ReadBlock(Block + 1, &Input[1 - Current]);
+			};
+			try {
+				Reader = std::thread(ReadNext);
+			}
+			catch (...) {
+				ReadNext();
+			}
+		}
+
+		// Output[Current] was written by the writer 2 blocks ago, which
+		// was joined before the last block was handed to the writer
+		iRes = Transform(&Input[Current], &Output[Current]);
+		if (iRes != APP_SUCCESS) {
+			break;
+		}
+
+		if (Block == 0) {
+			memcpy(&OutHeader, &Output[0].Header, sizeof(IMAGINGHEADER));
+			OutHeader.NumFrames = Header.NumFrames;
+			if (Output[0].Header.NumFrames != BlockFrames) {
+				iRes = APPERR_PARAMETER;
+				break;
+			}
+			// the output file is created once the output frame size is known
+			iRes = OutFile.Open(OutputFile, &OutHeader);
+			if (iRes != APP_SUCCESS) {
+				break;
+			}
+		}
+		else if (Output[Current].Header.Xsize != OutHeader.Xsize ||
+				Output[Current].Header.Ysize != OutHeader.Ysize ||
+				Output[Current].Header.PixelSize != OutHeader.PixelSize ||
+				Output[Current].Header.NumFrames != BlockFrames) {
+			iRes = APPERR_PARAMETER;
+			break;
+		}
+
+		// wait for the previous block to be written before writing this one
+		if (Writer.joinable()) {
+			Writer.join();
+		}
+		iRes = WriteResult;
+		if (iRes != APP_SUCCESS) {
+			break;
+		}
+		auto WriteCurrent = [&WriteBlock, &WriteResult, &Output, Current]() {
+			WriteResult = WriteBlock(&Output[Current]);
+		};
+		try {
+			Writer = std::thread(WriteCurrent);
+		}
+		catch (...) {
+			WriteCurrent();
+		}
+	}
+
+	if (Reader.joinable()) {
+		Reader.join();
+	}
+	if (Writer.joinable()) {
+		Writer.join();
+	}
+	if (iRes == APP_SUCCESS) {
+		iRes = WriteResult;
+	}
+
+	InFile.Close();
+	if (OutFile.Close() != APP_SUCCESS && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
+	FreeImageBuffer(&Input[0]);
+	FreeImageBuffer(&Input[1]);
+	FreeImageBuffer(&Output[0]);
+	FreeImageBuffer(&Output[1]);
+
+	if (iRes == APP_SUCCESS && OutputHeader) {
+		memcpy(OutputHeader, &OutHeader, sizeof(IMAGINGHEADER));
+	}
+	return iRes;
+}
+
+template int StreamImageFile(WCHAR* InputFile, WCHAR* OutputFile, int FramesPerBlock,
+	const PIXELTRANSFORM<int>& Transform, IMAGINGHEADER* OutputHeader);
+template int StreamImageFile(WCHAR* InputFile, WCHAR* OutputFile, int FramesPerBlock,
+	const PIXELTRANSFORM<BYTE>& Transform, IMAGINGHEADER* OutputHeader);
+template int StreamImageFile(WCHAR* InputFile, WCHAR* OutputFile, int FramesPerBlock,
+	const PIXELTRANSFORM<USHORT>& Transform, IMAGINGHEADER* OutputHeader);
@@ -0,0 +1,84 @@
+#pragma once
+//
+// ImageIO.h
+// function prototypes for the bulk image file I/O functions in ImageIO.cpp
+//
+#include <functional>
+
+// images with more than one frame and more than this # of pixels are
+// streamed through StreamImageFile instead of being loaded into memory
+#define STREAM_MIN_PIXELS ((size_t)128*1024*1024)
+
+// transform applied to each block of frames by StreamImageFile
+template <typename PIXELTYPE>
+using PIXELTRANSFORM = std::function<int(PIXELBUFFER<PIXELTYPE>* Input, PIXELBUFFER<PIXELTYPE>* Output)>;
+typedef PIXELTRANSFORM<int> FRAMETRANSFORM;
+
+// supplies the memory for the 'int' pixels of the image described by Header,
+// returns NULL if the memory can not be allocated, used by LoadImagePixels
+typedef std::function<int*(IMAGINGHEADER* Header)> IMAGEALLOCATOR;
+
+template <typename T> class PoolBuffer;
+
+// read only memory mapped view of a file
+typedef struct IMAGEFILEMAP {
+	HANDLE hFile;			// file handle from CreateFile
+	HANDLE hMapping;		// file mapping handle from CreateFileMapping
+	BYTE* View;				// start of the mapped view, the image header is at View[0]
+	LONGLONG FileSize;		// size of the mapped file in bytes
+} IMAGEFILEMAP;
+
+// image file loaders in Imaging.cpp
+int LoadImagePixels(WCHAR* ImagingFilename, IMAGINGHEADER* Header, const IMAGEALLOCATOR& Allocate);
+
+int LoadImageFile(PoolBuffer<int>* Image, WCHAR* ImagingFilename, IMAGINGHEADER* Header);
+
+int MapImageFile(WCHAR* Filename, IMAGEFILEMAP* Map);
+
+void UnmapImageFile(IMAGEFILEMAP* Map);
+
+void WidenPixels(int* Image, const BYTE* Pixels, size_t NumPixels, int PixelSize, int Endian);
+
+int ReadImagePixels(FILE* In, int* Image, size_t NumPixels, int PixelSize, int Endian);
+
+int ReadImagePixels(FILE* In, BYTE* Image, size_t NumPixels, int PixelSize, int Endian);
+
+int ReadImagePixels(FILE* In, USHORT* Image, size_t NumPixels, int PixelSize, int Endian);
+
+void NarrowPixels(BYTE* Pixels, const int* Image, size_t NumPixels, int PixelSize, int Endian);
+
+int WriteImagePixels(FILE* Out, const int* Image, size_t NumPixels, int PixelSize, int Endian);
+
+int WriteImagePixels(FILE* Out, const BYTE* Image, size_t NumPixels, int PixelSize, int Endian);
+
+int WriteImagePixels(FILE* Out, const USHORT* Image, size_t NumPixels, int PixelSize, int Endian);
+
+int WriteImageFile(WCHAR* Filename, const int* Image, IMAGINGHEADER* Header);
+
+int WriteImageFile(WCHAR* Filename, const BYTE* Image, IMAGINGHEADER* Header);
+
+int WriteImageFile(WCHAR* Filename, const USHORT* Image, IMAGINGHEADER* Header);
+
+// instantiated for IMAGEBUFFER, IMAGEBUFFER8 and IMAGEBUFFER16
+template <typename PIXELTYPE>
+int ReserveImageBuffer(PIXELBUFFER<PIXELTYPE>* Buffer, IMAGINGHEADER* Header);
+
+template <typename PIXELTYPE>
+void FreeImageBuffer(PIXELBUFFER<PIXELTYPE>* Buffer);
+
+int LoadImageBuffer(IMAGEBUFFER* Buffer, WCHAR* Filename);
+
+int LoadImageBuffer(IMAGEBUFFER8* Buffer, WCHAR* Filename);
+
+int LoadImageBuffer(IMAGEBUFFER16* Buffer, WCHAR* Filename);
+
+template <typename PIXELTYPE>
+int SaveImageBuffer(WCHAR* Filename, PIXELBUFFER<PIXELTYPE>* Buffer);
+
+void ClampImageBuffer(IMAGEBUFFER* Buffer);
+
+int StreamFramesPerBlock(IMAGINGHEADER* Header);
+
+template <typename PIXELTYPE>
+int StreamImageFile(WCHAR* InputFile, WCHAR* OutputFile, int FramesPerBlock,
+	const PIXELTRANSFORM<PIXELTYPE>& Transform, IMAGINGHEADER* OutputHeader);
@@ -29,6 +29,8 @@
 //     -4 incorect file type
 //     -5 file sizes mismatch
 //     -6 not yet implemented
+//     -7 file write failure
+//     -8 cancelled by the user
 //
 // Some function return TRUE/FALSE results
 //
@@ -72,18 +74,146 @@
 //						Correction, Extract image, fixed error when extracting multiple frames
 // V1.3.1.1 2023-12-28  Replaced application error numbers with #define to improve clarity
 //						Changed all batch processing to allow display of results from each step
+// V1.3.2.1 2026-10-14	Changed, LoadImageFile uses a memory mapped view of the file (or block
+//						reads if mapping fails) and converts whole blocks of pixels at a time
+//						Changed, image transforms write their output through the shared block
+//						writer WriteImagePixels (ImageIO.cpp) with uniform pixel clamping
+//						Correction, Accordion left/right now writes all frames
+//						Correction, Append right/end, frame offsets for multiple frame images
+//						Correction, Extract image, binary scaling tested the pixel value
+//						Changed, ReorderAlg calculates the reordering address table once
+//						and applies it to all frames in parallel
+//						Changed, PixelReorder batch mode processes the kernels in parallel
+//						with a pool of worker threads and a separate output file I/O thread
+//						Correction, PixelReorder memory leak of reordering kernels on errors
+//						Changed, ConvolveImage uses the convolution engine in Convolution.cpp,
+//						row blocked, separable kernels in 2 passes, multithreaded
+//						Correction, ConvolveImage memory leaks on errors
+//						Changed, image transforms display their results directly from memory
+//						Added, in memory (IMAGEBUFFER) versions of the fold, rotate, mirror,
+//						convolve, resize, reorder by algorithm, decimate, replicate and
+//						math constant transforms, the file versions call these
+//						Correction, StdDecimateImage, x and y sizes must both be divisible
+//						Correction, ReplicateImage no longer requires the image size to
+//						be divisible by the replication size
+//						Changed, ExtractSymbols, BlockReorder and PixelReorder batch mode
+//						report progress and can be cancelled when run as a background job
+//						Changed, fold, accordion, rotate, mirror, add/subtract, math constant,
+//						replicate and decimate transforms process the frames and rows in parallel
+//						Correction, AddSubtractImages memory leak when the images are incompatible
+//						Changed, rotate and mirror use the tiled SSE2 kernels in Transpose.cpp
+//						and can be done in place
+//						Changed, fold, rotate, mirror, convolve, resize, reorder by algorithm,
+//						decimate, replicate and math constant stream images that are too large
+//						to load a block of frames at a time (StreamImageFile in ImageIO.cpp)
+//						Changed, fold, rotate, mirror, reorder by algorithm, add/subtract and
+//						decimate keep 1 and 2 byte images at their pixel size (IMAGEBUFFER8,
+//						IMAGEBUFFER16) instead of converting them to 'int'
+//						Changed, ImageExtract and ReorderAlg go through the result cache
+//						(ResultCache.cpp)
+//						Added, the file image transforms add their load, compute and write
+//						times to the timing log (Timing.cpp)
+//						Changed, StdDecimateImage block sums use a summed area table
+//						(IntegralImage.cpp), 64 bit block sums
+//						Changed, ExtractSymbols finds the symbols from packed null bitmaps
+//						made in one pass over the image
+//						Correction, ExtractSymbols memory leak when no symbols are found
+//						Added, ExtractSymbolsMultiSize, symbol size report for a range of
+//						symbol sizes evaluated in parallel
+//						Added, LoadImageFile and ImageExtract read version 2 image files
+//						(ImageFile.cpp), ImageExtract only reads the frames it extracts
+//						Changed, ImageExtract writes the image file version set in the settings
+//						Changed, ReportImageHeader reports the image file version
+//						Added, ReadReoderingFile reads and saves a compiled copy of the kernel
+//						file (CompiledKernel.cpp), PixelReorder keeps its decom address table there
+//						Changed, ComputeReordering walks the kernel tile without modulo or division
+//						Changed, AddSubtractImages, AddSubtractKernel and MathConstant2Image use
+//						the SSE2 pixel math kernels (PixelMath.cpp)
+//						Added, ImageMath, min, max, AND, OR, XOR, threshold of 2 images
+//						Added, MathConstant2Image min, max, AND, OR, XOR, threshold, subtract
+//						Correction, AddSubtractKernel only did the first frame
+//						Added, LoadImageFile into a PoolBuffer from the buffer pool (BufferPool.cpp),
+//						LoadImagePixels loads into memory supplied by the caller
+//						Changed, PixelReorder and the reordering kernel batch borrow their image
+//						and address table buffers from the buffer pool
+//						Changed, ExtractSymbols bit counts and bit scans use BitOps.h for Win32 builds
+//						Correction, image transforms report image header, pixel and close write errors
+//						Correction, reordering kernel batch, PixelReorderBatch and BlockReorder batch
+//						report AutoPNG .png file write errors
+//						Changed, PixelReorder goes through the result cache, the kernel file content
+//						is part of the key, a kernel batch is not cached
+//						Removed, CalculateConvPixel, the convolution is done in Convolution.cpp
+//						Correction, PixelReorder invert, the pixels no kernel address maps to are 0
 //
 #include "framework.h"
 #include <stdio.h>
 #include <wchar.h>
+#include <limits.h>
 #include <atlstr.h>
 #include <strsafe.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <deque>
 #include "AppErrors.h"
 #include "ImageDialog.h"
 #include "Globals.h"
 #include "Imaging.h"
 #include "FileFunctions.h"
 #include "CalculateReOrder.h"
+#include "ImageIO.h"
+#include "Parallel.h"
+#include "Convolution.h"
+#include "JobRunner.h"
+#include "Transpose.h"
+#include "ResultCache.h"
+#include "Timing.h"
+#include "IntegralImage.h"
+#include "ImageFile.h"
+#include "CompiledKernel.h"
+#include "PixelMath.h"
+#include "BufferPool.h"
+#include "BitOps.h"
+#include "PngWriter.h"
+
+static int LoadPackedImageFile(WCHAR* ImagingFilename, IMAGINGHEADER* Header, const IMAGEALLOCATOR& Allocate);
+static int ExtractSubimage(HWND hDlg, WCHAR* InputImageFile, WCHAR* OutputImageFile,
+	int ScaleBinary, int SubimageXloc, int SubimageYloc, int StartFrame, int EndFrame,
+	int SubimageXsize, int SubimageYsize, int OutputXsize, int OutputYsize, int Centered);
+static int ReorderPixels(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, WCHAR* OutputFile,
+	int ScalePixel, int LinearOnly, int EnableBatch, int GenerateBMP, int Invert);
+static void ApplyReordering(int* OutputFrame, int* InputFrame, int* DecomAddress, int FrameSize, int Invert);
+static int WriteReorderKernelFile(WCHAR* OutputFile, int Kernel, IMAGINGHEADER* ImgHeader,
+	int* OutputImage, int GenerateBMP, PngBatch* PngFiles);
+template <typename PIXELTYPE>
+static int WriteTransformResult(HWND hDlg, WCHAR* OutputFile, PIXELBUFFER<PIXELTYPE>* Output);
+static void DisplayTransformResult(WCHAR* OutputFile, IMAGEBUFFER* Output);
+static void DisplayTransformResult(WCHAR* OutputFile, IMAGEBUFFER8* Output);
+static void DisplayTransformResult(WCHAR* OutputFile, IMAGEBUFFER16* Output);
+static int RunFileTransform(const WCHAR* Operation, HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
+	const FRAMETRANSFORM& Transform, const WCHAR* LoadError, IMAGINGHEADER* OutputHeader);
+template <typename TRANSFORM>
+static int RunNativeFileTransform(const WCHAR* Operation, HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
+	const TRANSFORM& Transform, int OutputPixelSize, const WCHAR* LoadError, IMAGINGHEADER* OutputHeader);
+template <typename PIXELTYPE>
+static int RunPixelTransform(const WCHAR* Operation, HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FramesPerBlock,
+	const PIXELTRANSFORM<PIXELTYPE>& Transform, const WCHAR* LoadError, IMAGINGHEADER* OutputHeader);
+static int PeekImageHeader(WCHAR* InputFile, IMAGINGHEADER* Header);
+template <typename PIXELTYPE>
+static int ImageMathFiles(HWND hDlg, WCHAR* InputFile, WCHAR* InputFile2, WCHAR* OutputFile,
+	int Operation, int* ArithmeticFlag);
+static int PixelSizeMax(int PixelSize);
+static int PixelReorderKernels(HWND hDlg, int* InputImage, IMAGINGHEADER* ImgHeader,
+	int* DecomX, int* DecomY, int DecomXsize, int DecomYsize, int NumKernels,
+	WCHAR* OutputFile, int GenerateBMP, int Invert);
+static void BuildPixelBitmap(const int* Image, int Xsize, int Ysize, ULONGLONG* PixelBits, ULONGLONG* RowBits);
+static void BuildSymbolBitmap(const ULONGLONG* PixelBits, const ULONGLONG* RowBits, int Xsize, int Ysize,
+	int xsizesymbol, int ysizesymbol, int Approach, ULONGLONG* ColumnBits, ULONGLONG* SymbolBits, BOOL Parallel);
+static void SymbolGroupStats(const ULONGLONG* SymbolBits, int TotalInputSymbols, int MaxNull,
+	int* NumSymbolsGroups, int* LongestSymbolGroup);
+static size_t NextBitSet(const ULONGLONG* Bits, size_t Start, size_t NumBits);
 
 //*****************************************************************************************
 //
@@ -124,106 +254,513 @@
 //
 //*****************************************************************************************
 int LoadImageFile(int** ImagePtr, WCHAR* ImagingFilename, IMAGINGHEADER* Header)
+{
+	int* Image = NULL;
+	int iRes;
+
+	*ImagePtr = NULL;
+
+	iRes = LoadImagePixels(ImagingFilename, Header, [&](IMAGINGHEADER* FileHeader) -> int* {
+		size_t NumPixels = (size_t)FileHeader->Xsize * (size_t)FileHeader->Ysize * (size_t)FileHeader->NumFrames;
+		Image = new int[NumPixels];  // alocate array of 'int's to receive image
+		return Image;
+	});
+	if (iRes != APP_SUCCESS) {
+		if (Image) {
+			delete[] Image;
+		}
+		return iRes;
+	}
+
+	*ImagePtr = Image;
+	// calling routine is responsible for deleting 'Image' memory
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	LoadImageFile
+// 
+//	LoadImageFile into a buffer borrowed from the buffer pool (BufferPool.cpp).
+//	The memory is returned to the pool when the PoolBuffer goes out of scope,
+//	the caller does not delete it.  The PoolBuffer memory is reused if it is
+//	large enough for the image.
+// 
+//*****************************************************************************************
+int LoadImageFile(PoolBuffer<int>* Image, WCHAR* ImagingFilename, IMAGINGHEADER* Header)
+{
+	return LoadImagePixels(ImagingFilename, Header, [=](IMAGINGHEADER* FileHeader) -> int* {
+		size_t NumPixels = (size_t)FileHeader->Xsize * (size_t)FileHeader->Ysize * (size_t)FileHeader->NumFrames;
+		return Image->Allocate(NumPixels);
+	});
+}
+
+//*****************************************************************************************
+//
+//	LoadImagePixels
+// 
+//	The image file loader used by LoadImageFile and LoadImageBuffer.  Once the
+//	header has been read and checked, Allocate is called with the header to get
+//	the memory for the Xsize*Ysize*NumFrames 'int' pixels.  Allocate returns
+//	NULL if the memory can not be allocated.  The memory belongs to the caller,
+//	it is not released by this function even if there is an error.
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+int LoadImagePixels(WCHAR* ImagingFilename, IMAGINGHEADER* Header, const IMAGEALLOCATOR& Allocate)
 {
 	FILE* In;
 	size_t iRead;
+	IMAGEFILEMAP Map;
+	int* Image;
+	int iRes;
+
+	// The file is memory mapped so the pixels can be converted directly
+	// from the file view.  If the file can not be mapped (empty file or
+	// the file is too large for the address space) fall back to block reads.
+	iRes = MapImageFile(ImagingFilename, &Map);
+	if (iRes == APPERR_FILEOPEN) {
+		return APPERR_FILEOPEN;
+	}
+
+	if (iRes == APP_SUCCESS) {
+		if (Map.FileSize < (LONGLONG)sizeof(IMAGINGHEADER)) {
+			UnmapImageFile(&Map);
+			return APPERR_FILEREAD;
+		}
+		memcpy(Header, Map.View, sizeof(IMAGINGHEADER));
+
+		iRes = ValidateLoadHeader(Header);
+		if (iRes != APP_SUCCESS) {
+			UnmapImageFile(&Map);
+			return iRes;
+		}
+		if (Header->Version == IMAGEFILE_VERSION_PACKED) {
+			UnmapImageFile(&Map);
+			return LoadPackedImageFile(ImagingFilename, Header, Allocate);
+		}
+
+		size_t NumPixels = (size_t)Header->Xsize * (size_t)Header->Ysize * (size_t)Header->NumFrames;
+		if ((ULONGLONG)(Map.FileSize - sizeof(IMAGINGHEADER)) < (ULONGLONG)NumPixels * (ULONGLONG)Header->PixelSize) {
+			UnmapImageFile(&Map);
+			return APPERR_FILEREAD;
+		}
+
+		Image = Allocate(Header);
+		if (Image == NULL) {
+			UnmapImageFile(&Map);
+			return APPERR_MEMALLOC;
+		}
+
+		WidenPixels(Image, Map.View + sizeof(IMAGINGHEADER), NumPixels,
+			(int)Header->PixelSize, (int)Header->Endian);
+
+		UnmapImageFile(&Map);
+		return APP_SUCCESS;
+	}
 
 	_wfopen_s(&In, ImagingFilename, L"rb");
 	if (In == NULL) {
-		*ImagePtr = NULL;
 		return APPERR_FILEOPEN;
 	}
 
 	iRead = fread(Header, sizeof(IMAGINGHEADER), 1, In);
 	if (iRead != 1) {
-		*ImagePtr = NULL;
 		fclose(In);
 		return APPERR_FILEREAD;
 	}
 
+	iRes = ValidateLoadHeader(Header);
+	if (iRes != APP_SUCCESS) {
+		fclose(In);
+		return iRes;
+	}
+	if (Header->Version == IMAGEFILE_VERSION_PACKED) {
+		fclose(In);
+		return LoadPackedImageFile(ImagingFilename, Header, Allocate);
+	}
+
+	size_t NumPixels = (size_t)Header->Xsize * (size_t)Header->Ysize * (size_t)Header->NumFrames;
 
-	if (Header->Endian != 0 && Header->Endian != -1 && Header->ID != 0xaaaa) {
-		*ImagePtr = NULL;
+	Image = Allocate(Header);
+	if (Image == NULL) {
 		fclose(In);
+		return APPERR_MEMALLOC;
+	}
+
+	// pixels are read in large blocks and converted (BYTE,SHORT or LONG)
+	// and Endian to get correct 'int' one block at a time
+	iRes = ReadImagePixels(In, Image, NumPixels, (int)Header->PixelSize, (int)Header->Endian);
+	fclose(In);
+	return iRes;
+}
+
+//*****************************************************************************************
+//
+//	LoadPackedImageFile
+// 
+//	Private function for LoadImagePixels, load a version 2 image file (ImageFile.cpp),
+//	the frames are decoded in parallel
+// 
+//*****************************************************************************************
+static int LoadPackedImageFile(WCHAR* ImagingFilename, IMAGINGHEADER* Header, const IMAGEALLOCATOR& Allocate)
+{
+	ImageFileReader Reader;
+	int* Image;
+	int iRes;
+
+	iRes = Reader.Open(ImagingFilename, Header);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	Image = Allocate(Header);
+	if (Image == NULL) {
+		return APPERR_MEMALLOC;
+	}
+
+	return Reader.ReadFrames(0, Header->NumFrames, Image);
+}
+
+//*****************************************************************************************
+//
+//	ValidateLoadHeader
+// 
+//	Check the image header read by LoadImageFile or StreamImageFile
+// 
+// Parameters:
+//	IMAGINGHEADER* Header	pointer to IMAGINGHEADER structure read from the file
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+int ValidateLoadHeader(IMAGINGHEADER* Header)
+{
+	if (Header->Endian != 0 && Header->Endian != -1 && Header->ID != 0xaaaa) {
 		return APPERR_PARAMETER;
 	}
 
 	if (Header->Xsize <= 0 || Header->Ysize <= 0 || Header->NumFrames <= 0) {
-		*ImagePtr = NULL;
-		fclose(In);
 		return APPERR_PARAMETER;
 	}
 
 	if (Header->PixelSize != 1 && Header->PixelSize != 2 && Header->PixelSize != 4) {
-		*ImagePtr = NULL;
-		fclose(In);
 		return APPERR_PARAMETER;
 	}
 
-	int* Image;
-	int xsize;
-	int ysize;
-	int NumFrames;
-	int PixelSize;
-	int Endian;
-	xsize = (int)Header->Xsize;
-	ysize = (int)Header->Ysize;
-	NumFrames = (int)Header->NumFrames;
-	PixelSize = (int)Header->PixelSize;
-	Endian = (int)Header->Endian;
-
-	Image = new int[(size_t)xsize * (size_t)ysize * (size_t)NumFrames];  // alocate array of 'int's to receive image
-	if (Image == NULL) {
-		*ImagePtr = NULL;
-		fclose(In);
-		return APPERR_MEMALLOC;
-	}
+	return APP_SUCCESS;
+}
 
-	*ImagePtr = Image;
+//******************************************************************************
+//
+// WriteTransformResult
+// 
+// Private function for the image transforms that work through an IMAGEBUFFER
+// 
+// Write the result of a transform to the output image file, display the
+// result if enabled and release the result buffer.
+// 
+// Parameters:
+//	HWND hDlg				Handle of calling window or dialog, NULL - don't
+//							show an error message, just return the error
+//	WCHAR* OutputFile		output image file
+//	PIXELBUFFER* Output		transform result, released on return
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+template <typename PIXELTYPE>
+static int WriteTransformResult(HWND hDlg, WCHAR* OutputFile, PIXELBUFFER<PIXELTYPE>* Output)
+{
+	int iRes;
 
-	// we don't read entire file in one fread since we may need
-	// to covert pixel(BYTE,SHORT or LONG) and Endian to get correct 'int'
-	PIXEL Pixel;
-	for (int i = 0; i < xsize * ysize * NumFrames; i++) {
-		iRead = fread(&Pixel, PixelSize, 1, In);
-		if (iRead != 1) {
-			fclose(In);
-			delete[] Image;
-			*ImagePtr = NULL;
-			return APPERR_FILEREAD;
+	iRes = SaveImageBuffer(OutputFile, Output);
+	if (iRes != APP_SUCCESS) {
+		FreeImageBuffer(Output);
+		if (hDlg) {
+			MessageBox(hDlg, L"Could not write output file", L"File I/O", MB_OK);
 		}
+		return iRes;
+	}
+
+	if (DisplayResults) {
+		DisplayTransformResult(OutputFile, Output);
+	}
+	FreeImageBuffer(Output);
+
+	return APP_SUCCESS;
+}
+
+//******************************************************************************
+//
+// DisplayTransformResult
+// 
+// Private function, display the result of a transform.  An 'int' result is
+// displayed from memory, a 1 or 2 byte result is displayed from the file
+// that was written.
+// 
+//*******************************************************************************
+static void DisplayTransformResult(WCHAR* OutputFile, IMAGEBUFFER* Output)
+{
+	UNREFERENCED_PARAMETER(OutputFile);
+	DisplayImageFrame(Output->Image, &Output->Header);
+	return;
+}
+
+static void DisplayTransformResult(WCHAR* OutputFile, IMAGEBUFFER8* Output)
+{
+	UNREFERENCED_PARAMETER(Output);
+	DisplayImage(OutputFile);
+	return;
+}
+
+static void DisplayTransformResult(WCHAR* OutputFile, IMAGEBUFFER16* Output)
+{
+	UNREFERENCED_PARAMETER(Output);
+	DisplayImage(OutputFile);
+	return;
+}
+
+//******************************************************************************
+//
+// RunFileTransform
+// 
+// Private function for the image transforms that work through an IMAGEBUFFER
+// 
+// Apply an in memory transform to an image file and write the result to the
+// output image file.  Images with more than one frame that are larger than
+// STREAM_MIN_PIXELS are not loaded into memory, they are streamed through
+// StreamImageFile() a block of frames at a time.  The transform must process
+// each frame independently.  Errors from the transform are reported by the
+// transform.
+// 
+// Parameters:
+//	const WCHAR* Operation	name of the operation in the timing log
+//	HWND hDlg				Handle of calling window or dialog, NULL - don't
+//							show an error message, just return the error
+//	WCHAR* InputFile		input image file
+//	WCHAR* OutputFile		output image file
+//	FRAMETRANSFORM& Transform	transform to apply
+//	WCHAR* LoadError		message shown when the input image can not be read
+//	IMAGINGHEADER* OutputHeader	receives the header of the output image, may be NULL
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+static int RunFileTransform(const WCHAR* Operation, HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
+	const FRAMETRANSFORM& Transform, const WCHAR* LoadError, IMAGINGHEADER* OutputHeader)
+{
+	IMAGINGHEADER Header;
+	int FramesPerBlock = 0;
+
+	// check the size of the image to decide if it is streamed
+	if (PeekImageHeader(InputFile, &Header) == APP_SUCCESS) {
+		FramesPerBlock = StreamFramesPerBlock(&Header);
+	}
+
+	return RunPixelTransform<int>(Operation, hDlg, InputFile, OutputFile, FramesPerBlock, Transform, LoadError, OutputHeader);
+}
+
+//******************************************************************************
+//
+// RunNativeFileTransform
+// 
+// Private function for the image transforms that are templates for
+// IMAGEBUFFER, IMAGEBUFFER8 and IMAGEBUFFER16
+// 
+// Same as RunFileTransform() except that 1 and 2 byte images are kept at
+// their file pixel size (IMAGEBUFFER8, IMAGEBUFFER16) from the load to the
+// write instead of being converted to 'int'.  This uses 1/4 or 1/2 of the
+// memory and memory bandwidth.  The transform is called with the buffer type
+// that matches the input image so it is normally a generic lambda:
+//		[&](auto* In, auto* Out) -> int { return FoldImageLeftBuffer(In, Out, FoldColumn); }
+// 
+// Parameters:
+//	see RunFileTransform()
+//	int OutputPixelSize		pixel size the transform produces, 0 - same as the
+//							input image.  If this is not the input pixel size
+//							the 'int' transform is used.
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+template <typename TRANSFORM>
+static int RunNativeFileTransform(const WCHAR* Operation, HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
+	const TRANSFORM& Transform, int OutputPixelSize, const WCHAR* LoadError, IMAGINGHEADER* OutputHeader)
+{
+	IMAGINGHEADER Header;
+	int FramesPerBlock = 0;
+	int PixelSize = 4;
 
-		if (PixelSize == 1) {
-			Image[i] = (int)Pixel.Byte[0];
+	if (PeekImageHeader(InputFile, &Header) == APP_SUCCESS) {
+		FramesPerBlock = StreamFramesPerBlock(&Header);
+		if (OutputPixelSize == 0 || OutputPixelSize == Header.PixelSize) {
+			PixelSize = Header.PixelSize;
 		}
-		else if (PixelSize == 2) {
-			if (!Endian) {
-				int swap;
-				swap = Pixel.Byte[0];
-				Pixel.Byte[0] = Pixel.Byte[1];
-				Pixel.Byte[1] = swap;
+	}
+
+	if (PixelSize == 1) {
+		return RunPixelTransform<BYTE>(Operation, hDlg, InputFile, OutputFile, FramesPerBlock,
+			Transform, LoadError, OutputHeader);
+	}
+	if (PixelSize == 2) {
+		return RunPixelTransform<USHORT>(Operation, hDlg, InputFile, OutputFile, FramesPerBlock,
+			Transform, LoadError, OutputHeader);
+	}
+	return RunPixelTransform<int>(Operation, hDlg, InputFile, OutputFile, FramesPerBlock,
+		Transform, LoadError, OutputHeader);
+}
+
+//******************************************************************************
+//
+// RunPixelTransform
+// 
+// Private function, the body of RunFileTransform() and RunNativeFileTransform()
+// 
+// Parameters:
+//	see RunFileTransform()
+//	int FramesPerBlock		0 - load the input image, >0 stream the input image
+//							this many frames at a time
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+template <typename PIXELTYPE>
+static int RunPixelTransform(const WCHAR* Operation, HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FramesPerBlock,
+	const PIXELTRANSFORM<PIXELTYPE>& Transform, const WCHAR* LoadError, IMAGINGHEADER* OutputHeader)
+{
+	PIXELBUFFER<PIXELTYPE> Input = { 0 };
+	PIXELBUFFER<PIXELTYPE> Output = { 0 };
+	int TransformResult = APP_SUCCESS;
+	OPTIMING Timing = { 0.0, 0.0, 0.0, 0.0 };
+	ULONGLONG NumPixels;
+	LONGLONG Start;
+	LONGLONG Mark;
+	LONGLONG Now;
+	int iRes;
+
+	Start = TimerNow();
+	if (FramesPerBlock == 0) {
+		iRes = LoadImageBuffer(&Input, InputFile);
+		if (iRes != APP_SUCCESS) {
+			if (hDlg) {
+				MessageBox(hDlg, LoadError, L"File I/O error", MB_OK);
 			}
-			Image[i] = (int)Pixel.uShort;
+			return iRes;
 		}
-		else {
-			if (!Endian) {
-				int swap;
-				swap = Pixel.Byte[0];
-				Pixel.Byte[0] = Pixel.Byte[3];
-				Pixel.Byte[3] = swap;
-				swap = Pixel.Byte[1];
-				Pixel.Byte[1] = Pixel.Byte[2];
-				Pixel.Byte[2] = swap;
+		NumPixels = (ULONGLONG)Input.Header.Xsize * (ULONGLONG)Input.Header.Ysize *
+			(ULONGLONG)Input.Header.NumFrames;
+		Mark = TimerNow();
+		Timing.Load = TimerSeconds(Start, Mark);
+
+		iRes = Transform(&Input, &Output);
+		FreeImageBuffer(&Input);
+		if (iRes != APP_SUCCESS) {
+			FreeImageBuffer(&Output);
+			return iRes;
+		}
+		Now = TimerNow();
+		Timing.Compute = TimerSeconds(Mark, Now);
+		Mark = Now;
+
+		if (OutputHeader) {
+			memcpy(OutputHeader, &Output.Header, sizeof(IMAGINGHEADER));
+		}
+		iRes = WriteTransformResult(hDlg, OutputFile, &Output);
+		if (iRes == APP_SUCCESS && TimingEnabled()) {
+			Now = TimerNow();
+			Timing.Write = TimerSeconds(Mark, Now);
+			Timing.Total = TimerSeconds(Start, Now);
+			LogOperationTiming(Operation, InputFile, NumPixels, &Timing);
+		}
+		return iRes;
+	}
+
+	// too large to load, stream the image a block of frames at a time
+	// the reads and writes overlap the transform, only the transform is timed
+	NumPixels = 0;
+	iRes = StreamImageFile<PIXELTYPE>(InputFile, OutputFile, FramesPerBlock,
+		[&](PIXELBUFFER<PIXELTYPE>* BlockIn, PIXELBUFFER<PIXELTYPE>* BlockOut) -> int {
+			LONGLONG BlockStart = TimerNow();
+
+			TransformResult = Transform(BlockIn, BlockOut);
+			Timing.Compute += TimerSeconds(BlockStart, TimerNow());
+			NumPixels += (ULONGLONG)BlockIn->Header.Xsize * (ULONGLONG)BlockIn->Header.Ysize *
+				(ULONGLONG)BlockIn->Header.NumFrames;
+			return TransformResult;
+		}, OutputHeader);
+	if (iRes != APP_SUCCESS) {
+		if (hDlg && TransformResult == APP_SUCCESS) {
+			if (iRes == APPERR_FILEOPEN || iRes == APPERR_FILEWRITE) {
+				MessageBox(hDlg, L"Could not write output file", L"File I/O", MB_OK);
+			}
+			else {
+				MessageBox(hDlg, LoadError, L"File I/O error", MB_OK);
 			}
-			Image[i] = (int)Pixel.Long;
 		}
+		return iRes;
+	}
+
+	// the result is displayed from the file, only the displayed frame is loaded
+	if (DisplayResults) {
+		DisplayImage(OutputFile);
+	}
+
+	if (TimingEnabled()) {
+		Timing.Load = -1.0;
+		Timing.Write = -1.0;
+		Timing.Total = TimerSeconds(Start, TimerNow());
+		LogOperationTiming(Operation, InputFile, NumPixels, &Timing);
 	}
-	fclose(In);
-	// calling routine is responsible for deleting 'Image' memory
 
 	return APP_SUCCESS;
 }
 
+//******************************************************************************
+//
+// PeekImageHeader
+// 
+// Private function, read and check the header of an image file without
+// loading the image
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+static int PeekImageHeader(WCHAR* InputFile, IMAGINGHEADER* Header)
+{
+	FILE* In;
+	int iRes;
+
+	_wfopen_s(&In, InputFile, L"rb");
+	if (In == NULL) {
+		return APPERR_FILEOPEN;
+	}
+	if (fread(Header, sizeof(IMAGINGHEADER), 1, In) != 1) {
+		fclose(In);
+		return APPERR_FILEREAD;
+	}
+	fclose(In);
+
+	iRes = ValidateLoadHeader(Header);
+	Header->Version = (short)1;
+	return iRes;
+}
+
 //*****************************************************************************************
 //
 //	ReportImageHeader
@@ -277,8 +814,9 @@ void ReportImageHeader(HWND hDlg, WCHAR* Filename)
 
 	// report contents of image header
 	TCHAR pszMessageBuf[MAX_PATH];
-	StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Image Pixel file Properties\n# of frames: %d\nXsize: %d\nYsize: %d\nPixelSize: %d byte(s)"),
-		(int)ImageHeader.NumFrames, (int)ImageHeader.Xsize, (int)ImageHeader.Ysize, (int)ImageHeader.PixelSize);
+	StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Image Pixel file Properties\n# of frames: %d\nXsize: %d\nYsize: %d\nPixelSize: %d byte(s)\nFile version: %d%s"),
+		(int)ImageHeader.NumFrames, (int)ImageHeader.Xsize, (int)ImageHeader.Ysize, (int)ImageHeader.PixelSize,
+		(int)ImageHeader.Version, ImageHeader.Version == IMAGEFILE_VERSION_PACKED ? TEXT(" (packed frames)") : TEXT(""));
 	MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
 
 	return;
@@ -409,6 +947,10 @@ int ReadImageHeader(WCHAR* Filename, IMAGINGHEADER* ImageHeader)
 		return APPERR_PARAMETER;
 	}
 
+	// the header describes the image, not how it is stored, a header copied
+	// to a file written pixel by pixel must be a version 1 header
+	ImageHeader->Version = (short)1;
+
 	return APP_SUCCESS;
 }
 
@@ -457,13 +999,35 @@ int ImageExtract(HWND hDlg, WCHAR* InputImageFile, WCHAR* OutputImageFile,
 	int ScaleBinary, int SubimageXloc, int SubimageYloc, int StartFrame, int EndFrame,
 	int SubimageXsize, int SubimageYsize, int OutputXsize, int OutputYsize, int Centered)
 {
-	FILE* In;
-	FILE* Out;
+	int Params[] = { ScaleBinary, SubimageXloc, SubimageYloc, StartFrame, EndFrame,
+		SubimageXsize, SubimageYsize, OutputXsize, OutputYsize, Centered };
+
+	return CachedFileResult(L"ImageExtract", InputImageFile, OutputImageFile,
+		Params, sizeof(Params) / sizeof(int), [&]() -> int {
+		return ExtractSubimage(hDlg, InputImageFile, OutputImageFile,
+			ScaleBinary, SubimageXloc, SubimageYloc, StartFrame, EndFrame,
+			SubimageXsize, SubimageYsize, OutputXsize, OutputYsize, Centered);
+	});
+}
+
+//******************************************************************************
+//
+// ExtractSubimage
+// 
+// ImageExtract() without the result cache, see ImageExtract() for a description
+// of the parameters
+//
+//******************************************************************************
+static int ExtractSubimage(HWND hDlg, WCHAR* InputImageFile, WCHAR* OutputImageFile,
+	int ScaleBinary, int SubimageXloc, int SubimageYloc, int StartFrame, int EndFrame,
+	int SubimageXsize, int SubimageYsize, int OutputXsize, int OutputYsize, int Centered)
+{
+	ImageFileReader InFile;
+	ImageFileWriter OutFile;
 	IMAGINGHEADER InputHeader;
 	IMAGINGHEADER OutputHeader;
 	int* Image;
 	int* SubImage;
-	int i;
 	int Address;
 	int SubAddress;
 	int CopyFrames;
@@ -471,11 +1035,7 @@ int ImageExtract(HWND hDlg, WCHAR* InputImageFile, WCHAR* OutputImageFile,
 	int OutputFrameSize;
 	int InputOffset;
 	int OutputOffset;
-	int SkipSize;
 	int iRes;
-	PIXEL Pixel;
-	errno_t ErrNum;
-	size_t iRead;
 
 	if (SubimageXsize > OutputXsize) {
 		MessageBox(hDlg, L"Sub Image x size is larger than output image x size", L"File I/O", MB_OK);
@@ -515,8 +1075,8 @@ int ImageExtract(HWND hDlg, WCHAR* InputImageFile, WCHAR* OutputImageFile,
 	}
 
 	// read image
-	ErrNum = _wfopen_s(&In, InputImageFile, L"rb");
-	if (In == NULL) {
+	iRes = InFile.Open(InputImageFile, &InputHeader);
+	if (iRes != APP_SUCCESS) {
 		MessageBox(hDlg, L"Could not open image input file", L"File I/O", MB_OK);
 		return APPERR_FILEOPEN;
 	}
@@ -526,45 +1086,18 @@ int ImageExtract(HWND hDlg, WCHAR* InputImageFile, WCHAR* OutputImageFile,
 
 	Image = (int*)calloc((size_t)InputFrameSize * (size_t)CopyFrames, sizeof(int));
 	if (Image == NULL) {
-		fclose(In);
 		MessageBox(hDlg, L"Input Image alloc failure", L"File I/O", MB_OK);
 		return APPERR_MEMALLOC;
 	}
-	// initially skip frames that are not required
-	if (StartFrame != 0) {
-		SkipSize = (StartFrame * InputFrameSize * InputHeader.PixelSize) + InputHeader.HeaderSize;
-	}
-	else {
-		SkipSize = InputHeader.HeaderSize;
-	}
-	if (fseek(In, SkipSize, SEEK_SET) != 0) {
+
+	// read only the requested frames, frames that are not required are skipped
+	iRes = InFile.ReadFrames(StartFrame, CopyFrames, Image);
+	if (iRes != APP_SUCCESS) {
 		free(Image);
-		fclose(In);
 		MessageBox(hDlg, L"bad format, Image file, too small", L"File I/O", MB_OK);
-		return APPERR_FILEREAD;
-	}
-
-	// read rest of requested frames
-	for (i = 0; i < (InputFrameSize * CopyFrames); i++) {
-		iRead = fread(&Pixel, InputHeader.PixelSize, 1, In);
-		if (iRead != 1) {
-			free(Image);
-			fclose(In);
-			MessageBox(hDlg, L"bad format, Image file, too small", L"File I/O", MB_OK);
-			return APPERR_FILEREAD;
-		}
-		if (InputHeader.PixelSize == 1) {
-			Image[i] = (int)Pixel.Byte[0];
-		}
-		else if (InputHeader.PixelSize == 2) {
-			Image[i] = (int)Pixel.uShort;
-		}
-		else {
-			// Pixel size is 4
-			Image[i] = (int)Pixel.Long;
-		}
+		return iRes;
 	}
-	fclose(In);
+	InFile.Close();
 
 	SubImage = (int*)calloc((size_t)SubimageXsize *
 		(size_t)SubimageYsize *
@@ -632,16 +1165,7 @@ int ImageExtract(HWND hDlg, WCHAR* InputImageFile, WCHAR* OutputImageFile,
 		}
 	}
 
-	// write result to output file
-	ErrNum = _wfopen_s(&Out, OutputImageFile, L"wb");
-	if (Out == NULL) {
-		free(Image);
-		free(SubImage);
-		MessageBox(hDlg, L"Could not open output file", L"File I/O", MB_OK);
-		return APPERR_FILEOPEN;
-	}
-
-	// write out upated header for output file
+	// upated header for output file
 	OutputHeader.Endian = (short)-1;
 	OutputHeader.HeaderSize = (short)sizeof(IMAGINGHEADER);
 	OutputHeader.ID = (short)0xaaaa;
@@ -656,37 +1180,32 @@ int ImageExtract(HWND hDlg, WCHAR* InputImageFile, WCHAR* OutputImageFile,
 	OutputHeader.Padding[3] = 0;
 	OutputHeader.Padding[4] = 0;
 	OutputHeader.Padding[5] = 0;
-	fwrite(&OutputHeader, sizeof(IMAGINGHEADER), 1, Out);
+
+	// write result to output file
+	iRes = OutFile.Open(OutputImageFile, &OutputHeader);
+	if (iRes != APP_SUCCESS) {
+		free(Image);
+		free(SubImage);
+		MessageBox(hDlg, L"Could not open output file", L"File I/O", MB_OK);
+		return iRes;
+	}
 
 	// write to output file
-	for (Address = 0; Address < (OutputFrameSize * CopyFrames); Address++) {
-		if (OutputHeader.PixelSize == 1) {
-			Pixel.Byte[0] = Image[Address];
-			if (ScaleBinary && Pixel.Byte != 0) {
-				Pixel.Byte[0] = 255;
-			}
-		}
-		else if (OutputHeader.PixelSize == 2) {
-			Pixel.uShort = Image[Address];
-			if (ScaleBinary && Pixel.uShort != 0) {
-				Pixel.uShort = 255;
-			}
-		}
-		else {
-			Pixel.Long = Image[Address];
-			if (ScaleBinary && Pixel.Long != 0) {
-				Pixel.Long = 255;
+	if (ScaleBinary) {
+		for (Address = 0; Address < (OutputFrameSize * CopyFrames); Address++) {
+			if (Image[Address] != 0) {
+				Image[Address] = 255;
 			}
 		}
-		fwrite(&Pixel, OutputHeader.PixelSize, 1, Out);
 	}
+	OutFile.WritePixels(Image, (size_t)OutputFrameSize * (size_t)CopyFrames);
 
-	fclose(Out);
+	OutFile.Close();
 	free(SubImage);
-	free(Image);
 	if (DisplayResults) {
-		DisplayImage(OutputImageFile);
+		DisplayImageFrame(Image, &OutputHeader);
 	}
+	free(Image);
 
 	return APP_SUCCESS;
 }
@@ -787,7 +1306,6 @@ int ImageAppendEnd(HWND hDlg, WCHAR* ImageInputFile, WCHAR* ImageInputFile2, WCH
 
 	FILE* Out;
 	errno_t ErrNum;
-	int PixelValue;
 
 	// write result to output file
 	ErrNum = _wfopen_s(&Out, ImageOutputFile, L"wb");
@@ -798,37 +1316,49 @@ int ImageAppendEnd(HWND hDlg, WCHAR* ImageInputFile, WCHAR* ImageInputFile2, WCH
 		return APPERR_FILEOPEN;
 	}
 	// save new imahe header
-	fwrite(&OutputHeader, sizeof(OutputHeader), 1, Out);
+	iRes = APP_SUCCESS;
+	if (fwrite(&OutputHeader, sizeof(OutputHeader), 1, Out) != 1) {
+		iRes = APPERR_FILEWRITE;
+	}
 
 	if (IncrFrames) {
-		for (int i = 0; i < (InputHeader.NumFrames * OutputHeader.Xsize * OutputHeader.Ysize); i++) {
-			PixelValue = Image1[i];
-			fwrite(&PixelValue, OutputHeader.PixelSize, 1, Out);
+		if (iRes == APP_SUCCESS) {
+			iRes = WriteImagePixels(Out, Image1,
+				(size_t)InputHeader.NumFrames * (size_t)OutputHeader.Xsize * (size_t)OutputHeader.Ysize,
+				OutputHeader.PixelSize, OutputHeader.Endian);
 		}
-		for (int i = 0; i < (InputHeader2.NumFrames * OutputHeader.Xsize * OutputHeader.Ysize); i++) {
-			PixelValue = Image2[i];
-			fwrite(&PixelValue, OutputHeader.PixelSize, 1, Out);
+		if (iRes == APP_SUCCESS) {
+			iRes = WriteImagePixels(Out, Image2,
+				(size_t)InputHeader2.NumFrames * (size_t)OutputHeader.Xsize * (size_t)OutputHeader.Ysize,
+				OutputHeader.PixelSize, OutputHeader.Endian);
 		}
 	}
 	else {
-		for (int i = 0; i < InputHeader.NumFrames; i++) {
+		for (int i = 0; i < InputHeader.NumFrames && iRes == APP_SUCCESS; i++) {
 			int Offset;
+			int Offset2;
 			Offset = i * InputHeader.Xsize * InputHeader.Ysize;
-			for (int j = 0; j < InputHeader.Xsize * InputHeader.Ysize; j++) {
-				PixelValue = Image1[j + Offset];
-				fwrite(&PixelValue, OutputHeader.PixelSize, 1, Out);
+			iRes = WriteImagePixels(Out, &Image1[Offset], (size_t)InputHeader.Xsize * (size_t)InputHeader.Ysize,
+				OutputHeader.PixelSize, OutputHeader.Endian);
+			if (iRes != APP_SUCCESS) {
+				break;
 			}
 			// Xsize is the same for both input images but Ysize may be different
-			for (int j = 0; j < InputHeader.Xsize * InputHeader2.Ysize; j++) {
-				PixelValue = Image2[j + Offset];
-				fwrite(&PixelValue, OutputHeader.PixelSize, 1, Out);
-			}
+			Offset2 = i * InputHeader.Xsize * InputHeader2.Ysize;
+			iRes = WriteImagePixels(Out, &Image2[Offset2], (size_t)InputHeader.Xsize * (size_t)InputHeader2.Ysize,
+				OutputHeader.PixelSize, OutputHeader.Endian);
 		}
 	}
 
-	fclose(Out);
+	if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
 	delete[] Image1;
 	delete[] Image2;
+	if (iRes != APP_SUCCESS) {
+		MessageBox(hDlg, L"Could not write output file", L"File I/O", MB_OK);
+		return iRes;
+	}
 
 	if (DisplayResults) {
 		DisplayImage(ImageOutputFile);
@@ -918,7 +1448,6 @@ int ImageAppendRight(HWND hDlg, WCHAR* ImageInputFile, WCHAR* ImageInputFile2,
 
 	FILE* Out;
 	errno_t ErrNum;
-	int PixelValue;
 
 	// write result to output file
 	ErrNum = _wfopen_s(&Out, ImageOutputFile, L"wb");
@@ -929,29 +1458,39 @@ int ImageAppendRight(HWND hDlg, WCHAR* ImageInputFile, WCHAR* ImageInputFile2,
 		return APPERR_FILEOPEN;
 	}
 	// save new imahe header
-	fwrite(&OutputHeader, sizeof(OutputHeader), 1, Out);
+	iRes = APP_SUCCESS;
+	if (fwrite(&OutputHeader, sizeof(OutputHeader), 1, Out) != 1) {
+		iRes = APPERR_FILEWRITE;
+	}
 
-	for (int i = 0; i < InputHeader.NumFrames; i++) {
+	for (int i = 0; i < InputHeader.NumFrames && iRes == APP_SUCCESS; i++) {
 		for (int j = 0; j < InputHeader.Ysize; j++) {
 			int Offset1;
 			int Offset2;
-			Offset1 = j * InputHeader.Xsize;
-			Offset2 = j * InputHeader2.Xsize;
+			Offset1 = (i * InputHeader.Ysize + j) * InputHeader.Xsize;
+			Offset2 = (i * InputHeader2.Ysize + j) * InputHeader2.Xsize;
 			// Ysize are same for both input images
-			for (int k = 0; k < InputHeader.Xsize; k++) {
-				PixelValue = Image1[k + Offset1];
-				fwrite(&PixelValue, OutputHeader.PixelSize, 1, Out);
+			iRes = WriteImagePixels(Out, &Image1[Offset1], InputHeader.Xsize,
+				OutputHeader.PixelSize, OutputHeader.Endian);
+			if (iRes == APP_SUCCESS) {
+				iRes = WriteImagePixels(Out, &Image2[Offset2], InputHeader2.Xsize,
+					OutputHeader.PixelSize, OutputHeader.Endian);
 			}
-			for (int k = 0; k < InputHeader2.Xsize; k++) {
-				PixelValue = Image2[k + Offset2];
-				fwrite(&PixelValue, OutputHeader.PixelSize, 1, Out);
+			if (iRes != APP_SUCCESS) {
+				break;
 			}
 		}
 	}
 
-	fclose(Out);
+	if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
 	delete[] Image1;
 	delete[] Image2;
+	if (iRes != APP_SUCCESS) {
+		MessageBox(hDlg, L"Could not write output file", L"File I/O", MB_OK);
+		return iRes;
+	}
 
 	if (DisplayResults) {
 		DisplayImage(ImageOutputFile);
@@ -1040,6 +1579,7 @@ int ImageAppendRight(HWND hDlg, WCHAR* ImageInputFile, WCHAR* ImageInputFile2,
 //	reordering file.  When batch processing the kernels are listed sequentially.
 //	Batch processing ends when a comment, EOF or an error in a kernel is encountered.
 //	An index number starting at 1 is added to the output filename for each kernel processed.
+//	The kernels are processed in parallel, see PixelReorderKernels().
 // 
 // Parameters:
 //	HWND hDlg				Handle of calling window or dialog
@@ -1065,22 +1605,51 @@ int ImageAppendRight(HWND hDlg, WCHAR* ImageInputFile, WCHAR* ImageInputFile2,
 //******************************************************************************
 int PixelReorder(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, WCHAR* OutputFile,
 	int ScalePixel, int LinearOnly, int EnableBatch, int GenerateBMP, int Invert)
+{
+	int Params[] = { ScalePixel, LinearOnly, EnableBatch, GenerateBMP, Invert };
+
+	// a batch writes a numbered output file for each kernel, the cache
+	// only holds a single output file
+	if (EnableBatch) {
+		return ReorderPixels(hDlg, TextInput, InputFile, OutputFile,
+			ScalePixel, LinearOnly, EnableBatch, GenerateBMP, Invert);
+	}
+
+	// the content of the reordering kernel file is part of the key
+	return CachedFileResult(L"PixelReorder", InputFile, TextInput, OutputFile,
+		Params, sizeof(Params) / sizeof(int), [&]() -> int {
+		return ReorderPixels(hDlg, TextInput, InputFile, OutputFile,
+			ScalePixel, LinearOnly, EnableBatch, GenerateBMP, Invert);
+	});
+}
+
+//******************************************************************************
+//
+// ReorderPixels
+// 
+// PixelReorder() without the result cache, see PixelReorder() for a description
+//
+//******************************************************************************
+static int ReorderPixels(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, WCHAR* OutputFile,
+	int ScalePixel, int LinearOnly, int EnableBatch, int GenerateBMP, int Invert)
 {
 	FILE* Out;
 	IMAGINGHEADER ImgHeader;
-	int* InputImage;
+	PoolBuffer<int> InputImage;
+	PoolBuffer<int> DecomAddress;
+	PoolBuffer<int> OutputImage;
 	int* DecomX;
 	int* DecomY;
-	int* DecomAddress;
 	int DecomXsize;
 	int DecomYsize;
-	int Offset;
 	int iRes;
 	int NumKernels;
-	PIXEL Pixel;
 	errno_t ErrNum;
 
 	// read input image file
+	// the image buffers are borrowed from the buffer pool so that a batch of
+	// files does not allocate new memory for each file, they are returned to
+	// the pool when this function returns
 	iRes = LoadImageFile(&InputImage, InputFile, &ImgHeader);
 	if (iRes != APP_SUCCESS) {
 		MessageBox(hDlg, L"Could not load image file", L"File I/O", MB_OK);
@@ -1088,190 +1657,485 @@ int PixelReorder(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, WCHAR* OutputFil
 	}
 
 	if (LinearOnly && ImgHeader.Ysize != 1) {
-		delete[] InputImage;
 		MessageBox(hDlg, L"Input file requires linear image file (Ysize=1)", L"File incompatible", MB_OK);
 		return APPERR_FILETYPE;
 	}
 
 	NumKernels = ReadReoderingFile(TextInput, &DecomX, &DecomY, &DecomXsize, &DecomYsize, LinearOnly, EnableBatch);
 	if (NumKernels <= 0) {
-		delete[] InputImage;
 		MessageBox(hDlg, L"Pixel reodering file read failure", L"File incompatible", MB_OK);
 		return APPERR_FILETYPE;
 	}
 
 	if (LinearOnly && DecomYsize != 1) {
-		delete[] InputImage;
+		delete[] DecomY;
+		delete[] DecomX;
 		MessageBox(hDlg, L"Reordering kernel Ysize must be 1", L"File incompatible", MB_OK);
 		return APPERR_FILETYPE;
 	}
 
 	if (ImgHeader.Xsize % DecomXsize != 0 || ImgHeader.Ysize % DecomYsize != 0) {
-		delete[] InputImage;
+		delete[] DecomY;
+		delete[] DecomX;
 		MessageBox(hDlg, L"Input image must be divisble by\nreordering list size in both x and y", L"File I/O", MB_OK);
 		return APPERR_PARAMETER;
 	}
 
+	if (EnableBatch) {
+		// each kernel is written to its own file, the kernels are processed in parallel
+		iRes = PixelReorderKernels(hDlg, InputImage, &ImgHeader, DecomX, DecomY, DecomXsize, DecomYsize,
+			NumKernels, OutputFile, GenerateBMP, Invert);
+		delete[] DecomY;
+		delete[] DecomX;
+		return iRes;
+	}
+
 	int FrameSize = ImgHeader.Xsize * ImgHeader.Ysize;
-	DecomAddress = new int[(size_t)FrameSize];
-	if (DecomAddress == NULL) {
+	if (DecomAddress.Allocate((size_t)FrameSize) == NULL) {
 		delete[] DecomY;
 		delete[] DecomX;
-		delete[] InputImage;
 		MessageBox(hDlg, L"Decom address table allocation failure", L"System Error", MB_OK);
 		return APPERR_MEMALLOC;
 	}
 
-	int* OutputImage;
-	OutputImage = new int[(size_t)FrameSize* ImgHeader.NumFrames];
-	if (OutputImage == NULL) {
+	if (OutputImage.Allocate((size_t)FrameSize * ImgHeader.NumFrames) == NULL) {
 		delete[] DecomY;
 		delete[] DecomX;
-		delete[] InputImage;
-		delete[] DecomAddress;
 		MessageBox(hDlg, L"Output Image allocation failure", L"System Error", MB_OK);
 		return APPERR_MEMALLOC;
 	}
 
-	int KernelOffset;
+	// calculate decom address table
+	// A reordering list is made for an entire frame, so that
+	// applying it is just a simple lookup table
+	// the table is kept in the compiled copy of the kernel file
+	CompiledReordering(TextInput, DecomAddress, ImgHeader.Xsize, ImgHeader.Ysize, DecomX, DecomY, DecomXsize, DecomYsize);
+
+	// compute new image, the frames are independent of each other
+	ParallelFor(0, ImgHeader.NumFrames, [&](int StartFrame, int EndFrame) {
+		for (int Frame = StartFrame; Frame < EndFrame; Frame++) {
+			ApplyReordering(OutputImage + (size_t)Frame * (size_t)FrameSize,
+				InputImage + (size_t)Frame * (size_t)FrameSize, DecomAddress, FrameSize, Invert);
+		}
+	});
+
+	delete[] DecomY;
+	delete[] DecomX;
+	InputImage.Free();
+	DecomAddress.Free();
+
+	// write result to output file
+	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
+	if (!Out) {
+		MessageBox(hDlg, L"Could not open output file", L"File I/O", MB_OK);
+		return APPERR_FILEOPEN;
+	}
+
+	// write imgheader record out, no parameters in the header have changed
+	iRes = APPERR_FILEWRITE;
+	if (fwrite(&ImgHeader, sizeof(ImgHeader), 1, Out) == 1) {
+		// write image
+		iRes = WriteImagePixels(Out, OutputImage,
+			FrameSize * (size_t)ImgHeader.NumFrames,
+			ImgHeader.PixelSize, ImgHeader.Endian);
+	}
+
+	if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
+	if (iRes != APP_SUCCESS) {
+		MessageBox(hDlg, L"Could not write output file", L"File I/O", MB_OK);
+		return iRes;
+	}
+
+	if (DisplayResults) {
+		DisplayImageFrame(OutputImage, &ImgHeader);
+	}
+
+	return APP_SUCCESS;
+}
+
+//******************************************************************************
+//
+// ApplyReordering
+// 
+// private function for PixelReorder()
+//
+// Apply a decom address table from ComputeReordering() to one frame
+//
+//*******************************************************************************
+static void ApplyReordering(int* OutputFrame, int* InputFrame, int* DecomAddress, int FrameSize, int Invert)
+{
+	if (Invert == 0) {
+		for (int i = 0; i < FrameSize; i++) {
+			OutputFrame[i] = InputFrame[DecomAddress[i]];
+		}
+	}
+	else {
+		// the kernel need not be a permutation, pixels that no input pixel
+		// maps to are 0 rather than what was left in a reused buffer
+		memset(OutputFrame, 0, (size_t)FrameSize * sizeof(int));
+		for (int i = 0; i < FrameSize; i++) {
+			OutputFrame[DecomAddress[i]] = InputFrame[i];
+		}
+	}
+	return;
+}
+
+//******************************************************************************
+//
+// WriteReorderKernelFile
+// 
+// private function for PixelReorderKernels()
+//
+// Write the reordered image for one kernel of a batch.  The kernel index
+// number, 1 based, is added to the filename:
+//		OutputFile = path\name.ext  ->  path\name_<Kernel+1>.ext
+// If GenerateBMP is set then path\name_<Kernel+1>.bmp is also created, its
+// AutoPNG .png file is queued for PngFiles.
+// 
+// This has no user interaction so that it can run on the batch I/O thread.
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+static int WriteReorderKernelFile(WCHAR* OutputFile, int Kernel, IMAGINGHEADER* ImgHeader,
+	int* OutputImage, int GenerateBMP, PngBatch* PngFiles)
+{
+	FILE* Out;
+	errno_t ErrNum;
+	int err;
+	int iRes;
+	WCHAR BMPfilename[MAX_PATH];
+	WCHAR NewFilename[MAX_PATH];
+	WCHAR Drive[_MAX_DRIVE];
+	WCHAR Dir[_MAX_DIR];
+	WCHAR Fname[_MAX_FNAME];
+	WCHAR Ext[_MAX_EXT];
+	WCHAR NewFname[_MAX_FNAME];
+
+	// split apart original filename
+	err = _wsplitpath_s(OutputFile, Drive, _MAX_DRIVE, Dir, _MAX_DIR, Fname,
+		_MAX_FNAME, Ext, _MAX_EXT);
+	if (err != 0) {
+		return APPERR_FILEOPEN;
+	}
+	// change the fname portion to add _kernel# 1 based
+	swprintf_s(NewFname, _MAX_FNAME, L"%s_%d", Fname, Kernel + 1);
+
+	// reassemble filename
+	err = _wmakepath_s(NewFilename, _MAX_PATH, Drive, Dir, NewFname, Ext);
+	if (err != 0) {
+		return APPERR_FILEOPEN;
+	}
+
+	// write result to output file
+	ErrNum = _wfopen_s(&Out, NewFilename, L"wb");
+	if (!Out) {
+		return APPERR_FILEOPEN;
+	}
+
+	// write imgheader record out, no parameters in the header have changed
+	iRes = APPERR_FILEWRITE;
+	if (fwrite(ImgHeader, sizeof(IMAGINGHEADER), 1, Out) == 1) {
+		// write image
+		iRes = WriteImagePixels(Out, OutputImage,
+			(size_t)ImgHeader->Xsize * (size_t)ImgHeader->Ysize * (size_t)ImgHeader->NumFrames,
+			ImgHeader->PixelSize, ImgHeader->Endian);
+	}
+	if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	// create BMP of file
+	if (GenerateBMP) {
+		err = _wmakepath_s(BMPfilename, _MAX_PATH, Drive, Dir, NewFname, L".bmp");
+		if (err != 0) {
+			return APPERR_FILEOPEN;
+		}
+		SaveBMP(BMPfilename, NewFilename, FALSE, TRUE, PngFiles);
+	}
+
+	return APP_SUCCESS;
+}
+
+//******************************************************************************
+//
+// PixelReorderKernels
+// 
+// private function for PixelReorder()
+//
+// Batch processing of the reordering kernels.  Each kernel is applied to the
+// input image and the result is written to its own output file, see
+// WriteReorderKernelFile().
+// 
+// The kernels are independent of each other so they are processed by a pool
+// of worker threads.  The input image is shared, read only, by the workers.
+// Each worker has its own decom address table and takes an output image
+// buffer from a small pool of buffers.  Finished output images are queued
+// for a single I/O thread that writes the files (and BMP files) and then returns
+// the buffer to the pool.  The size of the pool limits the memory used when
+// the writing can not keep up with the workers.
+// 
+// The calling (UI) thread shows the number of kernels completed in the dialog
+// caption and keeps processing window messages until the batch is done.
+//
+// Parameters:
+//	HWND hDlg				Handle of calling window or dialog
+//	int* InputImage			Input image
+//	IMAGINGHEADER* ImgHeader Input image header
+//	int* DecomX				Reordering kernels from ReadReoderingFile()
+//	int* DecomY
+//	int DecomXsize			Reordering kernel size
+//	int DecomYsize
+//	int NumKernels			Number of kernels in DecomX, DecomY
+//	WCHAR* OutputFile		Output filename, the kernel # is added to this name
+//	int GenerateBMP			1 - Generate BMP file for each kernel
+//	int Invert				0 - forward reordering transform
+//							1 - inverse reordering transform
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+static int PixelReorderKernels(HWND hDlg, int* InputImage, IMAGINGHEADER* ImgHeader,
+	int* DecomX, int* DecomY, int DecomXsize, int DecomYsize, int NumKernels,
+	WCHAR* OutputFile, int GenerateBMP, int Invert)
+{
+	struct REORDERJOB {
+		int Kernel;
+		int* OutputImage;
+	};
+	int FrameSize;
+	size_t ImageSize;
+	int NumWorkers;
+	int NumBuffers;
+	int WorkersDone = 0;
+	int Error = APP_SUCCESS;
+	int PngError;
+	PngBatch PngFiles;
+	std::vector<PoolBuffer<int>> OutputBuffers;
+	std::vector<int*> FreeBuffers;
+	std::deque<REORDERJOB> WriteQueue;
+	std::mutex Lock;
+	std::condition_variable BufferReady;
+	std::condition_variable WriteReady;
+	std::atomic<int> NextKernel(0);
+	std::atomic<int> Completed(0);
+	std::atomic<bool> WriterDone(false);
+	std::vector<std::thread> Workers;
+
+	FrameSize = ImgHeader->Xsize * ImgHeader->Ysize;
+	ImageSize = (size_t)FrameSize * (size_t)ImgHeader->NumFrames;
+
+	NumWorkers = GetWorkerCount();
+	if (NumWorkers > NumKernels) {
+		NumWorkers = NumKernels;
+	}
+
+	// output image buffer pool, 2 extra so that the workers can continue
+	// while the I/O thread is writing
+	// the buffers are borrowed from the buffer pool and returned when this function returns
+	NumBuffers = NumWorkers + 2;
+	OutputBuffers.reserve(NumBuffers);
+	for (int i = 0; i < NumBuffers; i++) {
+		PoolBuffer<int> Buffer;
+		if (Buffer.Allocate(ImageSize) == NULL) {
+			break;
+		}
+		FreeBuffers.push_back(Buffer);
+		OutputBuffers.push_back(std::move(Buffer));
+	}
+	if (FreeBuffers.empty()) {
+		MessageBox(hDlg, L"Output Image allocation failure", L"System Error", MB_OK);
+		return APPERR_MEMALLOC;
+	}
+	NumBuffers = (int)FreeBuffers.size();
+	if (NumWorkers > NumBuffers) {
+		NumWorkers = NumBuffers;
+	}
+
+	// first error stops the batch, wake up everyone waiting
+	auto SetError = [&](int ErrorCode) {
+		{
+			std::lock_guard<std::mutex> Guard(Lock);
+			if (Error == APP_SUCCESS) {
+				Error = ErrorCode;
+			}
+		}
+		BufferReady.notify_all();
+		WriteReady.notify_all();
+	};
 
-	for (int Kernel = 0; Kernel < NumKernels; Kernel++) {
-		WCHAR BMPfilename[MAX_PATH];
-		WCHAR NewFilename[MAX_PATH];
+	auto Worker = [&]() {
+		PoolBuffer<int> DecomAddress;
+		int* OutputImage;
+		int Kernel;
+		int KernelOffset;
 
-		// calculate decom address table
-		// A reordering list is made for an entire frame, so that
-		// applying it is just a simple lookup table
-		KernelOffset = Kernel * DecomXsize * DecomYsize;
+		if (DecomAddress.Allocate((size_t)FrameSize) == NULL) {
+			SetError(APPERR_MEMALLOC);
+		}
+		else {
+			for (;;) {
+				Kernel = NextKernel++;
+				if (Kernel >= NumKernels) {
+					break;
+				}
+				if (JobCancelled()) {
+					SetError(APPERR_CANCELLED);
+					break;
+				}
 
-		ComputeReordering(DecomAddress, ImgHeader.Xsize, ImgHeader.Ysize, DecomX + KernelOffset, DecomY + KernelOffset, DecomXsize, DecomYsize);
-		// compute new image
-		for (int Frame = 0; Frame < ImgHeader.NumFrames; Frame++) {
-			Offset = Frame * FrameSize;
-			for (int i = 0; i < FrameSize; i++) {
-				if (Invert == 0) {
-					OutputImage[Offset + i] = InputImage[Offset + DecomAddress[i]];
+				{
+					std::unique_lock<std::mutex> Guard(Lock);
+					BufferReady.wait(Guard, [&] { return !FreeBuffers.empty() || Error != APP_SUCCESS; });
+					if (Error != APP_SUCCESS) {
+						break;
+					}
+					OutputImage = FreeBuffers.back();
+					FreeBuffers.pop_back();
 				}
-				else {
-					OutputImage[Offset + DecomAddress[i]] = InputImage[Offset + i];
+
+				// calculate decom address table for this kernel
+				KernelOffset = Kernel * DecomXsize * DecomYsize;
+				ComputeReordering(DecomAddress, ImgHeader->Xsize, ImgHeader->Ysize,
+					DecomX + KernelOffset, DecomY + KernelOffset, DecomXsize, DecomYsize);
+
+				// compute new image
+				for (int Frame = 0; Frame < ImgHeader->NumFrames; Frame++) {
+					ApplyReordering(OutputImage + (size_t)Frame * (size_t)FrameSize,
+						InputImage + (size_t)Frame * (size_t)FrameSize, DecomAddress, FrameSize, Invert);
 				}
+
+				{
+					std::lock_guard<std::mutex> Guard(Lock);
+					WriteQueue.push_back({ Kernel, OutputImage });
+				}
+				WriteReady.notify_one();
 			}
 		}
-		
-		if (EnableBatch) {
-			// for Batch processing, cutup filename, reassemble with index number (Kernel)
-			int err;
-			WCHAR Drive[_MAX_DRIVE];
-			WCHAR Dir[_MAX_DIR];
-			WCHAR Fname[_MAX_FNAME];
-			WCHAR Ext[_MAX_EXT];
 
-			// split apart original filename
-			err = _wsplitpath_s(OutputFile, Drive, _MAX_DRIVE, Dir, _MAX_DIR, Fname,
-				_MAX_FNAME, Ext, _MAX_EXT);
-			if (err != 0) {
-				delete[] DecomY;
-				delete[] DecomX;
-				delete[] InputImage;
-				delete[] DecomAddress;
-				delete[] OutputImage;
-				MessageBox(hDlg, L"Could not creat output filename", L"Batch File I/O", MB_OK);
-				return APPERR_FILEOPEN;
-			}
-			// change the fname portion to add _kernel# 1 based
-			// use Kernel+1
-			WCHAR NewFname[_MAX_FNAME];
+		{
+			std::lock_guard<std::mutex> Guard(Lock);
+			WorkersDone++;
+		}
+		WriteReady.notify_one();
+	};
 
-			swprintf_s(NewFname, _MAX_FNAME, L"%s_%d", Fname, Kernel + 1);
+	auto Writer = [&]() {
+		REORDERJOB Job;
+		int iRes;
+		int CurrentError;
 
-			// reassemble filename
-			err = _wmakepath_s(NewFilename, _MAX_PATH, Drive, Dir, NewFname, Ext);
-			if (err != 0) {
-				delete[] DecomY;
-				delete[] DecomX;
-				delete[] InputImage;
-				delete[] DecomAddress;
-				delete[] OutputImage;
-				MessageBox(hDlg, L"Could not creat output filename", L"Batch File I/O", MB_OK);
-				return APPERR_FILEOPEN;
-			}
-			// create BMP of file
-			if (GenerateBMP) {
-				err = _wmakepath_s(BMPfilename, _MAX_PATH, Drive, Dir, NewFname, L".bmp");
-				if (err != 0) {
-					delete[] DecomY;
-					delete[] DecomX;
-					delete[] InputImage;
-					delete[] DecomAddress;
-					delete[] OutputImage;
-					MessageBox(hDlg, L"Could not creat output filename", L"Batch File I/O", MB_OK);
-					return APPERR_FILEOPEN;
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> Guard(Lock);
+				WriteReady.wait(Guard, [&] { return !WriteQueue.empty() || WorkersDone == NumWorkers; });
+				if (WriteQueue.empty()) {
+					break;
 				}
+				Job = WriteQueue.front();
+				WriteQueue.pop_front();
+				CurrentError = Error;
 			}
 
+			if (CurrentError == APP_SUCCESS) {
+				iRes = WriteReorderKernelFile(OutputFile, Job.Kernel, ImgHeader, Job.OutputImage, GenerateBMP, &PngFiles);
+				if (iRes != APP_SUCCESS) {
+					SetError(iRes);
+				}
+			}
 
-			// write result to output file
-			ErrNum = _wfopen_s(&Out, NewFilename, L"wb");
-			if (!Out) {
-				delete[] DecomY;
-				delete[] DecomX;
-				delete[] InputImage;
-				delete[] DecomAddress;
-				delete[] OutputImage;
-				MessageBox(hDlg, L"Could not open output file", L"File I/O", MB_OK);
-				return APPERR_FILEOPEN;
+			{
+				std::lock_guard<std::mutex> Guard(Lock);
+				FreeBuffers.push_back(Job.OutputImage);
 			}
+			BufferReady.notify_one();
+			Completed++;
 		}
-		else {
-			// write result to output file
-			ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-			if (!Out) {
-				delete[] DecomY;
-				delete[] DecomX;
-				delete[] InputImage;
-				delete[] DecomAddress;
-				delete[] OutputImage;
-				MessageBox(hDlg, L"Could not open output file", L"File I/O", MB_OK);
-				return APPERR_FILEOPEN;
-			}
+		WriterDone = true;
+	};
+
+	for (int i = 0; i < NumWorkers; i++) {
+		try {
+			Workers.emplace_back(Worker);
+		}
+		catch (...) {
+			break;
 		}
+	}
+	if (Workers.empty()) {
+		MessageBox(hDlg, L"Could not start worker threads", L"System Error", MB_OK);
+		return APPERR_MEMALLOC;
+	}
+	{
+		// only the workers that were started will report that they are done
+		std::lock_guard<std::mutex> Guard(Lock);
+		NumWorkers = (int)Workers.size();
+	}
+	std::thread IOThread(Writer);
 
-		// write imgheader record out, no parameters in the header have changed
-		fwrite(&ImgHeader, sizeof(ImgHeader), 1, Out);
-		
-		// write image
-		for (int i = 0; i < (FrameSize * ImgHeader.NumFrames); i++) {
-			Pixel.Long = OutputImage[i];
-			if (ImgHeader.PixelSize == 1) {
-				if (Pixel.Long > 255) Pixel.Long = 255;
-				fwrite(&Pixel.Byte, 1, 1, Out);
-			}
-			else if (ImgHeader.PixelSize == 2) {
-				if (Pixel.Long > 65535) Pixel.Long = 65535;
-				fwrite(&Pixel.uShort, 2, 1, Out);
-			}
-			else {
-				fwrite(&Pixel.Long, 4, 1, Out);
+	// show progress while waiting
+	{
+		WCHAR Caption[MAX_PATH];
+		WCHAR Progress[MAX_PATH];
+		int Shown = -1;
+
+		GetWindowText(hDlg, Caption, MAX_PATH);
+		EnableWindow(hDlg, FALSE);
+		while (!WriterDone) {
+			if (Completed != Shown) {
+				Shown = Completed;
+				swprintf_s(Progress, MAX_PATH, L"Reordering, kernel %d of %d completed", Shown, NumKernels);
+				SetWindowText(hDlg, Progress);
+				JobProgress(Shown, NumKernels);
 			}
+			WaitProcessingMessages(100);
 		}
+		SetWindowText(hDlg, Caption);
+		EnableWindow(hDlg, TRUE);
+	}
 
-		fclose(Out);
-		if (EnableBatch && GenerateBMP) {
-			SaveBMP(BMPfilename, NewFilename, FALSE, TRUE);
-		}
+	for (auto& Thread : Workers) {
+		Thread.join();
+	}
+	IOThread.join();
 
+	// the .png files of the BMP files are written by the PNG encode queue
+	PngError = APP_SUCCESS;
+	if (GenerateBMP) {
+		PngError = WaitAutoPNG(hDlg, &PngFiles);
 	}
-	delete[] DecomY;
-	delete[] DecomX;
-	delete[] InputImage;
-	delete[] DecomAddress;
-	delete[] OutputImage;
 
-	if (DisplayResults && !EnableBatch) {
-		DisplayImage(OutputFile);
+	switch (Error) {
+	case APP_SUCCESS:
+	case APPERR_CANCELLED:
+		break;
+
+	case APPERR_MEMALLOC:
+		MessageBox(hDlg, L"Decom address table allocation failure", L"System Error", MB_OK);
+		break;
+
+	case APPERR_FILEOPEN:
+		MessageBox(hDlg, L"Could not open output file", L"Batch File I/O", MB_OK);
+		break;
+
+	default:
+		MessageBox(hDlg, L"Could not write output file", L"Batch File I/O", MB_OK);
+		break;
 	}
 
-	return APP_SUCCESS;
+	if (Error == APP_SUCCESS) {
+		return PngError;
+	}
+	return Error;
 }
 
 //******************************************************************************
@@ -1296,6 +2160,18 @@ int ReadReoderingFile(WCHAR* TextInput, int** DecomXptr, int** DecomYptr,
 	int* DecomX;
 	int* DecomY;
 	int LinearFormat;
+	int NumKernels;
+
+	// the compiled copy of the kernel file is already parsed and converted
+	NumKernels = LoadCompiledKernels(TextInput, EnableBatch, DecomXptr, DecomYptr, DecomXsize, DecomYsize);
+	if (NumKernels > 0) {
+		if (LinearOnly && (*DecomYsize != 1)) {
+			delete[] *DecomYptr;
+			delete[] *DecomXptr;
+			return APPERR_FILETYPE;
+		}
+		return NumKernels;
+	}
 
 	ErrNum = _wfopen_s(&TextIn, TextInput, L"r");
 	if (!TextIn) {
@@ -1326,7 +2202,7 @@ int ReadReoderingFile(WCHAR* TextInput, int** DecomXptr, int** DecomYptr,
 
 	// scan file to determine number of kernels to process
 	int NumTotal = 0;
-	int NumKernels = 0;
+	NumKernels = 0;
 	if (!EnableBatch) {
 		NumKernels = 1;
 	}
@@ -1410,6 +2286,10 @@ int ReadReoderingFile(WCHAR* TextInput, int** DecomXptr, int** DecomYptr,
 		}
 	}
 	fclose(TextIn);
+	if (NumKernels > 0) {
+		SaveCompiledKernels(TextInput, EnableBatch, DecomX, DecomY, *DecomXsize, *DecomYsize,
+			NumKernels, NULL, 0, 0);
+	}
 	*DecomXptr = DecomX;
 	*DecomYptr = DecomY;
 	return NumKernels;
@@ -1477,6 +2357,10 @@ int ConvertDecomList2Relative(int* DecomX, int* DecomY, int DecomXsize, int Deco
 // 
 // private function for PixelReorder()
 //
+// The image is walked a row at a time with the position in the kernel tile
+// kept as counters that wrap around, the kernel entries are converted to
+// linear address offsets once so the inner loop has no modulo or division.
+//
 //*******************************************************************************
 void ComputeReordering(int* DecomAddress, int xsize, int ysize, int* DecomX, int* DecomY,
 	int DecomXsize, int DecomYsize)
@@ -1486,24 +2370,40 @@ void ComputeReordering(int* DecomAddress, int xsize, int ysize, int* DecomX, int
 	int CalculatedAddress = 0;
 	int TotalSize;  // to make sure new address never exceeds the image size
 	int Ykernel, Xkernel;
-	int DecomXYindex;
-	int Offset;
 
 	TotalSize = xsize * ysize;
 
+	// address offset of each Decom list entry
+	std::vector<int> KernelOffset((size_t)DecomXsize * (size_t)DecomYsize);
+	for (size_t i = 0; i < KernelOffset.size(); i++) {
+		KernelOffset[i] = DecomX[i] + (xsize * DecomY[i]);
+	}
+
 	// translate current x,y into Decom list position
 	// subdivide the image into subgroups which are DecomXsize by DecomYsize in size
+	Ykernel = 0;	// y pixel position in current reorder subgroup
 	for (y = 0; y < ysize; y++) {
-		Ykernel = y % DecomYsize;  // compute y pixel position in current reorder subgroup
+		const int* KernelRow = &KernelOffset[(size_t)Ykernel * (size_t)DecomXsize];
+		Xkernel = 0;	// x pixel position in current reorder subgroup
 		for (x = 0; x < xsize; x++) {
-			Xkernel = x % DecomXsize;   // compute x pixel position in current reorder subgroup
-			DecomXYindex = Xkernel + (Ykernel * DecomXsize);
-			Offset = DecomX[DecomXYindex] + (xsize * DecomY[DecomXYindex]);
 			// calculate address offset based on Decom list entry
-			CalculatedAddress = LinearAddress + Offset;
-			if (CalculatedAddress < 0) CalculatedAddress = 0; // make sure address is not < 0
-			DecomAddress[LinearAddress] = CalculatedAddress % TotalSize; // limit address to image size
+			CalculatedAddress = LinearAddress + KernelRow[Xkernel];
+			if (CalculatedAddress < 0) {
+				CalculatedAddress = 0; // make sure address is not < 0
+			}
+			else if (CalculatedAddress >= TotalSize) {
+				CalculatedAddress = CalculatedAddress % TotalSize; // limit address to image size
+			}
+			DecomAddress[LinearAddress] = CalculatedAddress;
 			LinearAddress++;
+			Xkernel++;
+			if (Xkernel == DecomXsize) {
+				Xkernel = 0;
+			}
+		}
+		Ykernel++;
+		if (Ykernel == DecomYsize) {
+			Ykernel = 0;
 		}
 	}
 	return;
@@ -1534,48 +2434,69 @@ void ComputeReordering(int* DecomAddress, int xsize, int ysize, int* DecomX, int
 //*******************************************************************************
 int FoldImageLeft(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldColumn)
 {
-	FILE* Out;
-	errno_t ErrNum;
-	int* InputImage;
+	IMAGINGHEADER OutputHeader;
 	int iRes;
-	int InputXsize;
-	int InputYsize;
-	IMAGINGHEADER ImageHeader;
 
-	iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
+	iRes = RunNativeFileTransform(L"FoldImageLeft", hDlg, InputFile, OutputFile, [&](auto* In, auto* Out) -> int {
+		int Result;
+
+		if (In->Header.Xsize % 2) {
+			MessageBox(hDlg, L"xsize must be even", L"Input file incompatible", MB_OK);
+			return APPERR_PARAMETER;
+		}
+
+		Result = FoldImageLeftBuffer(In, Out, FoldColumn);
+		if (Result != APP_SUCCESS) {
+			MessageBox(hDlg, L"Output image alloc failure", L"File I/O", MB_OK);
+		}
+		return Result;
+	}, 0, L"Could not load input image, check format", &OutputHeader);
 	if (iRes != APP_SUCCESS) {
-		MessageBox(hDlg, L"Could not load input image, check format", L"File I/O error", MB_OK);
 		return iRes;
 	}
 
-	InputXsize = ImageHeader.Xsize;
-	InputYsize = ImageHeader.Ysize;
+	TCHAR pszMessageBuf[MAX_PATH];
+	StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Output image size is: %d,%d"), (int)OutputHeader.Xsize, (int)OutputHeader.Ysize);
+	MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
+	return APP_SUCCESS;
+}
 
-	if (InputXsize % 2) {
-		delete[] InputImage;
-		MessageBox(hDlg, L"xsize must be even", L"Input file incompatible", MB_OK);
-		return -0;
-	}
+//******************************************************************************
+//
+// FoldImageLeftBuffer
+// 
+// In memory version of FoldImageLeft(), see FoldImageLeft() for a description.
+// 
+// Parameters:
+//	IMAGEBUFFER* In			input image, xsize must be even
+//	IMAGEBUFFER* Out		folded image, must not be In
+//	int FoldColumn			Column to fold at
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+template <typename PIXELTYPE>
+int FoldImageLeftBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int FoldColumn)
+{
+	IMAGINGHEADER ImageHeader;
+	int InputXsize;
+	int InputYsize;
+	PIXELTYPE* InputImage;
+	int iRes;
 
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-	if (!Out) {
-		delete[] InputImage;
-		MessageBox(hDlg, L"Could not open results file", L"File I/O", MB_OK);
-		return APPERR_FILEOPEN;
+	InputXsize = In->Header.Xsize;
+	InputYsize = In->Header.Ysize;
+	InputImage = In->Image;
+
+	if (InputXsize % 2) {
+		return APPERR_PARAMETER;
 	}
 
-	int LeftAddress;
-	int RightAddress;
-	int RightPixel, LeftPixel;
 	int StartXleft;
 	int StartXright;
-	int RightX;
-	int LeftX;
 	int OutputXsize;
-	int Offset;
-	PIXEL Pixel;
-	int i;
-	int y;
 	// Calculations need to work for both even and odd sized image sizes
 	if ((float)FoldColumn < ((float)InputXsize / 2.0)) {
 		// extend image to left
@@ -1616,14 +2537,28 @@ int FoldImageLeft(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldColumn
 		OutputXsize = InputXsize / 2;
 	}
 
-	// write new header
+	ImageHeader = In->Header;
 	ImageHeader.Xsize = OutputXsize;
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
+	iRes = ReserveImageBuffer(Out, &ImageHeader);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	// fold image, the frames and rows are independent of each other
+	PIXELTYPE* OutputImage = Out->Image;
+	ParallelForFrames(ImageHeader.NumFrames, InputYsize, [&](int Frame, int StartY, int EndY) {
+		int LeftAddress;
+		int RightAddress;
+		int RightPixel, LeftPixel;
+		int RightX;
+		int LeftX;
+		int Offset;
+		int i;
+		PIXELTYPE* OutputRow;
 
-	// fold image
-	for (int Frame = 0; Frame < ImageHeader.NumFrames; Frame++) {
 		Offset = Frame * InputXsize * InputYsize;
-		for (y = 0; y < InputYsize; y++) {
+		OutputRow = OutputImage + ((size_t)Frame * (size_t)InputYsize + (size_t)StartY) * (size_t)OutputXsize;
+		for (int y = StartY; y < EndY; y++, OutputRow += OutputXsize) {
 			for (LeftX = StartXleft, RightX = StartXright, i = 0; i < OutputXsize; i++, LeftX++, RightX--) {
 				RightAddress = y * InputXsize + RightX + Offset;
 				LeftAddress = y * InputXsize + LeftX + Offset;
@@ -1642,51 +2577,79 @@ int FoldImageLeft(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldColumn
 					RightPixel = InputImage[RightAddress];
 				}
 
-				Pixel.Long = (LeftPixel + RightPixel);
-				if (ImageHeader.PixelSize == 1) {
-					if (Pixel.Long > 255) Pixel.Long = 255; //clip output
-					fwrite(&Pixel.Byte, 1, 1, Out);
-				}
-				else if (ImageHeader.PixelSize == 2) {
-					if (Pixel.Long > 65535) Pixel.Long = 65535; // clip output
-					fwrite(&Pixel.uShort, 2, 1, Out);
-				}
-				else {
-					fwrite(&Pixel.Long, 4, 1, Out);
-				}
+				OutputRow[i] = SaturatePixel<PIXELTYPE>(LeftPixel + RightPixel);
 			}
 		}
-	}
+	});
 
-	fclose(Out);
-	delete[] InputImage;
+	return APP_SUCCESS;
+}
 
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
+template int FoldImageLeftBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, int FoldColumn);
+template int FoldImageLeftBuffer(IMAGEBUFFER8* In, IMAGEBUFFER8* Out, int FoldColumn);
+template int FoldImageLeftBuffer(IMAGEBUFFER16* In, IMAGEBUFFER16* Out, int FoldColumn);
+
+//******************************************************************************
+//
+// FoldImageRight
+//
+// This function folds an image along a vertcal axis.  It folds the left side
+// of the image onto the right side. The fold axis does not have
+// to be in the middle of the image. The image will be appropriately extended as
+// needed. If the image is folded in the middle, for example at column 128 in a
+// 256 wide image then the output file will be 128 wide.  If it is not split in
+// the middle then the ouput image width will be larger to accomodate the fold.
+// This is not an issue.  Think of folding a piece of paper and how it may overlap.
+// 
+// Parameters:
+//	HWND hDlg				Handle of calling window or dialog
+//	WCHAR* ImageFile		Input image file
+//	WCHAR* OutputFile		Folded image output file
+//	int FoldColumn			Column to fold at
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int FoldImageRight(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldColumn)
+{
+	IMAGINGHEADER OutputHeader;
+	int iRes;
+
+	iRes = RunNativeFileTransform(L"FoldImageRight", hDlg, InputFile, OutputFile, [&](auto* In, auto* Out) -> int {
+		int Result;
+
+		if (In->Header.Xsize % 2) {
+			MessageBox(hDlg, L"xsize must be even", L"Input file incompatible", MB_OK);
+			return APPERR_PARAMETER;
+		}
+
+		Result = FoldImageRightBuffer(In, Out, FoldColumn);
+		if (Result != APP_SUCCESS) {
+			MessageBox(hDlg, L"Output image alloc failure", L"File I/O", MB_OK);
+		}
+		return Result;
+	}, 0, L"Could not load input image, check format", &OutputHeader);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
 	}
 
 	TCHAR pszMessageBuf[MAX_PATH];
-	StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Output image size is: %d,%d"), (int)OutputXsize, (int)InputYsize);
+	StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Output image size is: %d,%d"), (int)OutputHeader.Xsize, (int)OutputHeader.Ysize);
 	MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
 	return APP_SUCCESS;
 }
 
 //******************************************************************************
 //
-// FoldImageRight
-//
-// This function folds an image along a vertcal axis.  It folds the left side
-// of the image onto the right side. The fold axis does not have
-// to be in the middle of the image. The image will be appropriately extended as
-// needed. If the image is folded in the middle, for example at column 128 in a
-// 256 wide image then the output file will be 128 wide.  If it is not split in
-// the middle then the ouput image width will be larger to accomodate the fold.
-// This is not an issue.  Think of folding a piece of paper and how it may overlap.
+// FoldImageRightBuffer
+// 
+// In memory version of FoldImageRight(), see FoldImageRight() for a description.
 // 
 // Parameters:
-//	HWND hDlg				Handle of calling window or dialog
-//	WCHAR* ImageFile		Input image file
-//	WCHAR* OutputFile		Folded image output file
+//	IMAGEBUFFER* In			input image, xsize must be even
+//	IMAGEBUFFER* Out		folded image, must not be In
 //	int FoldColumn			Column to fold at
 // 
 //  return value:
@@ -1694,51 +2657,26 @@ int FoldImageLeft(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldColumn
 //  !=1 Error see standardized app error list at top of this source file
 //
 //*******************************************************************************
-int FoldImageRight(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldColumn)
+template <typename PIXELTYPE>
+int FoldImageRightBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int FoldColumn)
 {
-	FILE* Out;
-	errno_t ErrNum;
-	int* InputImage;
-	int iRes;
+	IMAGINGHEADER ImageHeader;
 	int InputXsize;
 	int InputYsize;
-	IMAGINGHEADER ImageHeader;
-
-	iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
-	if (iRes != APP_SUCCESS) {
-		MessageBox(hDlg, L"Could not load input image, check format", L"File I/O error", MB_OK);
-		return iRes;
-	}
+	PIXELTYPE* InputImage;
+	int iRes;
 
-	InputXsize = ImageHeader.Xsize;
-	InputYsize = ImageHeader.Ysize;
+	InputXsize = In->Header.Xsize;
+	InputYsize = In->Header.Ysize;
+	InputImage = In->Image;
 
 	if (InputXsize % 2) {
-		delete[] InputImage;
-		MessageBox(hDlg, L"xsize must be even", L"Input file incompatible", MB_OK);
 		return APPERR_PARAMETER;
 	}
 
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-	if (!Out) {
-		delete[] InputImage;
-		_fcloseall();
-		MessageBox(hDlg, L"Could not open results file", L"File I/O", MB_OK);
-		return APPERR_FILEOPEN;
-	}
-
-	int LeftAddress;
-	int RightAddress;
-	int RightPixel, LeftPixel;
 	int StartXleft;
 	int StartXright;
-	int RightX;
-	int LeftX;
 	int OutputXsize;
-	int Offset;
-	PIXEL Pixel;
-	int i;
-	int y;
 
 	if ((float)FoldColumn < ((float)InputXsize / 2.0)) {
 		if (InputXsize % 2 == 0) {
@@ -1779,14 +2717,28 @@ int FoldImageRight(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldColum
 		OutputXsize = InputXsize / 2;
 	}
 
-	// write new header
+	ImageHeader = In->Header;
 	ImageHeader.Xsize = OutputXsize;
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
+	iRes = ReserveImageBuffer(Out, &ImageHeader);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	// fold image, the frames and rows are independent of each other
+	PIXELTYPE* OutputImage = Out->Image;
+	ParallelForFrames(ImageHeader.NumFrames, InputYsize, [&](int Frame, int StartY, int EndY) {
+		int LeftAddress;
+		int RightAddress;
+		int RightPixel, LeftPixel;
+		int RightX;
+		int LeftX;
+		int Offset;
+		int i;
+		PIXELTYPE* OutputRow;
 
-	// fold image
-	for (int Frame = 0; Frame < ImageHeader.NumFrames; Frame++) {
 		Offset = Frame * InputXsize * InputYsize;
-		for (y = 0; y < InputYsize; y++) {
+		OutputRow = OutputImage + ((size_t)Frame * (size_t)InputYsize + (size_t)StartY) * (size_t)OutputXsize;
+		for (int y = StartY; y < EndY; y++, OutputRow += OutputXsize) {
 			for (LeftX = StartXleft, RightX = StartXright, i = 0; i < OutputXsize; i++, LeftX--, RightX++) {
 				RightAddress = y * InputXsize + RightX + Offset;
 				LeftAddress = y * InputXsize + LeftX + Offset;
@@ -1795,7 +2747,7 @@ int FoldImageRight(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldColum
 					LeftPixel = 0;
 				}
 				else {
-					LeftPixel = InputImage[LeftAddress];;
+					LeftPixel = InputImage[LeftAddress];
 				}
 				if (RightX >= InputXsize) {
 					// extended to right
@@ -1805,35 +2757,17 @@ int FoldImageRight(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldColum
 					RightPixel = InputImage[RightAddress];
 				}
 
-				Pixel.Long = (LeftPixel + RightPixel);
-				if (ImageHeader.PixelSize == 1) {
-					if (Pixel.Long > 255) Pixel.Long = 255; //clip output
-					fwrite(&Pixel.Byte, 1, 1, Out);
-				}
-				else if (ImageHeader.PixelSize == 2) {
-					if (Pixel.Long > 65535) Pixel.Long = 65535; // clip output
-					fwrite(&Pixel.uShort, 2, 1, Out);
-				}
-				else {
-					fwrite(&Pixel.Long, 4, 1, Out);
-				}
+				OutputRow[i] = SaturatePixel<PIXELTYPE>(LeftPixel + RightPixel);
 			}
 		}
-	}
-
-	fclose(Out);
-	delete[] InputImage;
-
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
-	}
+	});
 
-	TCHAR pszMessageBuf[MAX_PATH];
-	StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Output image size is: %d,%d"), (int)OutputXsize, (int)InputYsize);
-	MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
 	return APP_SUCCESS;
 }
 
+template int FoldImageRightBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, int FoldColumn);
+template int FoldImageRightBuffer(IMAGEBUFFER8* In, IMAGEBUFFER8* Out, int FoldColumn);
+template int FoldImageRightBuffer(IMAGEBUFFER16* In, IMAGEBUFFER16* Out, int FoldColumn);
 
 //*******************************************************************************
 //
@@ -1864,49 +2798,69 @@ int FoldImageRight(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldColum
 //*******************************************************************************
 int FoldImageDown(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldRow)
 {
-	FILE* Out;
-	errno_t ErrNum;
-	int* InputImage;
+	IMAGINGHEADER OutputHeader;
 	int iRes;
-	int InputXsize;
-	int InputYsize;
-	IMAGINGHEADER ImageHeader;
 
-	iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
+	iRes = RunNativeFileTransform(L"FoldImageDown", hDlg, InputFile, OutputFile, [&](auto* In, auto* Out) -> int {
+		int Result;
+
+		if (In->Header.Ysize % 2) {
+			MessageBox(hDlg, L"ysize must be even", L"Input file incompatible", MB_OK);
+			return APPERR_PARAMETER;
+		}
+
+		Result = FoldImageDownBuffer(In, Out, FoldRow);
+		if (Result != APP_SUCCESS) {
+			MessageBox(hDlg, L"Output image alloc failure", L"File I/O", MB_OK);
+		}
+		return Result;
+	}, 0, L"Could not load input image, check format", &OutputHeader);
 	if (iRes != APP_SUCCESS) {
-		MessageBox(hDlg, L"Could not load input image, check format", L"File I/O error", MB_OK);
 		return iRes;
 	}
 
-	InputXsize = ImageHeader.Xsize;
-	InputYsize = ImageHeader.Ysize;
+	TCHAR pszMessageBuf[MAX_PATH];
+	StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Output image size is: %d,%d"), (int)OutputHeader.Xsize, (int)OutputHeader.Ysize);
+	MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
+	return APP_SUCCESS;
+}
+
+//******************************************************************************
+//
+// FoldImageDownBuffer
+// 
+// In memory version of FoldImageDown(), see FoldImageDown() for a description.
+// 
+// Parameters:
+//	IMAGEBUFFER* In			input image, ysize must be even
+//	IMAGEBUFFER* Out		folded image, must not be In
+//	int FoldRow				Row to fold at
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+template <typename PIXELTYPE>
+int FoldImageDownBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int FoldRow)
+{
+	IMAGINGHEADER ImageHeader;
+	int InputXsize;
+	int InputYsize;
+	PIXELTYPE* InputImage;
+	int iRes;
+
+	InputXsize = In->Header.Xsize;
+	InputYsize = In->Header.Ysize;
+	InputImage = In->Image;
 
 	if (InputYsize % 2) {
-		delete[] InputImage;
-		MessageBox(hDlg, L"ysize must be even", L"Input file incompatible", MB_OK);
 		return APPERR_PARAMETER;
 	}
 
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-	if (!Out) {
-		delete[] InputImage;
-		_fcloseall();
-		MessageBox(hDlg, L"Could not open results file", L"File I/O", MB_OK);
-		return APPERR_FILEOPEN;
-	}
-
-	int TopAddress;
-	int BotAddress;
-	int TopPixel, BotPixel;
 	int StartYtop;
 	int StartYbot;
-	int TopY;
-	int BotY;
 	int OutputYsize;
-	int Offset;
-	PIXEL Pixel;
-	int i;
-	int x;
 
 	if (FoldRow < (InputYsize / 2)) {
 		// extend image to left
@@ -1927,16 +2881,29 @@ int FoldImageDown(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldRow)
 		OutputYsize = InputYsize / 2;
 	}
 
-
-	// write new header
+	ImageHeader = In->Header;
 	ImageHeader.Ysize = OutputYsize;
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
+	iRes = ReserveImageBuffer(Out, &ImageHeader);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	// fold image, the frames and rows are independent of each other
+	PIXELTYPE* OutputImage = Out->Image;
+	ParallelForFrames(ImageHeader.NumFrames, OutputYsize, [&](int Frame, int StartRow, int EndRow) {
+		int TopAddress;
+		int BotAddress;
+		int TopPixel, BotPixel;
+		int TopY;
+		int BotY;
+		int Offset;
+		int i;
+		PIXELTYPE* OutputRow;
 
-	// fold image
-	for (int Frame = 0; Frame < ImageHeader.NumFrames; Frame++) {
 		Offset = Frame * InputXsize * InputYsize;
-		for (TopY = StartYtop, BotY = StartYbot, i = 0; i < OutputYsize; i++, TopY--, BotY++) {
-			for (x = 0; x < InputXsize; x++) {
+		OutputRow = OutputImage + ((size_t)Frame * (size_t)OutputYsize + (size_t)StartRow) * (size_t)InputXsize;
+		for (TopY = StartYtop - StartRow, BotY = StartYbot + StartRow, i = StartRow; i < EndRow; i++, TopY--, BotY++, OutputRow += InputXsize) {
+			for (int x = 0; x < InputXsize; x++) {
 				TopAddress = TopY * InputXsize + x + Offset;
 				BotAddress = BotY * InputXsize + x + Offset;
 				if (TopY < 0) {
@@ -1954,35 +2921,18 @@ int FoldImageDown(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldRow)
 					BotPixel = InputImage[BotAddress];
 				}
 
-				Pixel.Long = (TopPixel + BotPixel);
-				if (ImageHeader.PixelSize == 1) {
-					if (Pixel.Long > 255) Pixel.Long = 255; //clip output
-					fwrite(&Pixel.Byte, 1, 1, Out);
-				}
-				else if (ImageHeader.PixelSize == 2) {
-					if (Pixel.Long > 65535) Pixel.Long = 65535; // clip output
-					fwrite(&Pixel.uShort, 2, 1, Out);
-				}
-				else {
-					fwrite(&Pixel.Long, 4, 1, Out);
-				}
+				OutputRow[x] = SaturatePixel<PIXELTYPE>(TopPixel + BotPixel);
 			}
 		}
-	}
-
-	fclose(Out);
-	delete[] InputImage;
-
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
-	}
+	});
 
-	TCHAR pszMessageBuf[MAX_PATH];
-	StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Output image size is: %d,%d"), (int)InputXsize, (int)OutputYsize);
-	MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
 	return APP_SUCCESS;
 }
 
+template int FoldImageDownBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, int FoldRow);
+template int FoldImageDownBuffer(IMAGEBUFFER8* In, IMAGEBUFFER8* Out, int FoldRow);
+template int FoldImageDownBuffer(IMAGEBUFFER16* In, IMAGEBUFFER16* Out, int FoldRow);
+
 //*******************************************************************************
 //
 // FoldImageUp
@@ -2012,49 +2962,69 @@ int FoldImageDown(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldRow)
 //*******************************************************************************
 int FoldImageUp(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldRow)
 {
-	FILE* Out;
-	errno_t ErrNum;
-	int* InputImage;
+	IMAGINGHEADER OutputHeader;
 	int iRes;
-	int InputXsize;
-	int InputYsize;
-	IMAGINGHEADER ImageHeader;
 
-	iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
+	iRes = RunNativeFileTransform(L"FoldImageUp", hDlg, InputFile, OutputFile, [&](auto* In, auto* Out) -> int {
+		int Result;
+
+		if (In->Header.Ysize % 2) {
+			MessageBox(hDlg, L"ysize must be even", L"Input file incompatible", MB_OK);
+			return APPERR_PARAMETER;
+		}
+
+		Result = FoldImageUpBuffer(In, Out, FoldRow);
+		if (Result != APP_SUCCESS) {
+			MessageBox(hDlg, L"Output image alloc failure", L"File I/O", MB_OK);
+		}
+		return Result;
+	}, 0, L"Could not load input image, check format", &OutputHeader);
 	if (iRes != APP_SUCCESS) {
-		MessageBox(hDlg, L"Could not load input image, check format", L"File I/O error", MB_OK);
 		return iRes;
 	}
 
-	InputXsize = ImageHeader.Xsize;
-	InputYsize = ImageHeader.Ysize;
+	TCHAR pszMessageBuf[MAX_PATH];
+	StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Output image size is: %d,%d"), (int)OutputHeader.Xsize, (int)OutputHeader.Ysize);
+	MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
+	return APP_SUCCESS;
+}
+
+//******************************************************************************
+//
+// FoldImageUpBuffer
+// 
+// In memory version of FoldImageUp(), see FoldImageUp() for a description.
+// 
+// Parameters:
+//	IMAGEBUFFER* In			input image, ysize must be even
+//	IMAGEBUFFER* Out		folded image, must not be In
+//	int FoldRow				Row to fold at
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+template <typename PIXELTYPE>
+int FoldImageUpBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int FoldRow)
+{
+	IMAGINGHEADER ImageHeader;
+	int InputXsize;
+	int InputYsize;
+	PIXELTYPE* InputImage;
+	int iRes;
+
+	InputXsize = In->Header.Xsize;
+	InputYsize = In->Header.Ysize;
+	InputImage = In->Image;
 
 	if (InputYsize % 2) {
-		delete[] InputImage;
-		MessageBox(hDlg, L"ysize must be even", L"Input file incompatible", MB_OK);
 		return APPERR_PARAMETER;
 	}
 
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-	if (!Out) {
-		delete[] InputImage;
-		_fcloseall();
-		MessageBox(hDlg, L"Could not open results file", L"File I/O", MB_OK);
-		return APPERR_FILEOPEN;
-	}
-
-	int TopAddress;
-	int BotAddress;
-	int TopPixel, BotPixel;
 	int StartYtop;
 	int StartYbot;
-	int TopY;
-	int BotY;
 	int OutputYsize;
-	int Offset;
-	PIXEL Pixel;
-	int i;
-	int x;
 
 	if (FoldRow < (InputYsize / 2)) {
 		// extend image to left
@@ -2075,17 +3045,29 @@ int FoldImageUp(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldRow)
 		OutputYsize = InputYsize / 2;
 	}
 
-
-
-	// write new header
+	ImageHeader = In->Header;
 	ImageHeader.Ysize = OutputYsize;
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
+	iRes = ReserveImageBuffer(Out, &ImageHeader);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	// fold image, the frames and rows are independent of each other
+	PIXELTYPE* OutputImage = Out->Image;
+	ParallelForFrames(ImageHeader.NumFrames, OutputYsize, [&](int Frame, int StartRow, int EndRow) {
+		int TopAddress;
+		int BotAddress;
+		int TopPixel, BotPixel;
+		int TopY;
+		int BotY;
+		int Offset;
+		int i;
+		PIXELTYPE* OutputRow;
 
-	// fold image
-	for (int Frame = 0; Frame < ImageHeader.NumFrames; Frame++) {
 		Offset = Frame * InputXsize * InputYsize;
-		for (TopY = StartYtop, BotY = StartYbot, i = 0; i < OutputYsize; i++, TopY++, BotY--) {
-			for (x = 0; x < InputXsize; x++) {
+		OutputRow = OutputImage + ((size_t)Frame * (size_t)OutputYsize + (size_t)StartRow) * (size_t)InputXsize;
+		for (TopY = StartYtop + StartRow, BotY = StartYbot - StartRow, i = StartRow; i < EndRow; i++, TopY++, BotY--, OutputRow += InputXsize) {
+			for (int x = 0; x < InputXsize; x++) {
 				TopAddress = TopY * InputXsize + x + Offset;
 				BotAddress = BotY * InputXsize + x + Offset;
 				if (TopY < 0) {
@@ -2103,35 +3085,18 @@ int FoldImageUp(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int FoldRow)
 					BotPixel = InputImage[BotAddress];
 				}
 
-				Pixel.Long = (TopPixel + BotPixel);
-				if (ImageHeader.PixelSize == 1) {
-					if (Pixel.Long > 255) Pixel.Long = 255; //clip output
-					fwrite(&Pixel.Byte, 1, 1, Out);
-				}
-				else if (ImageHeader.PixelSize == 2) {
-					if (Pixel.Long > 65535) Pixel.Long = 65535; // clip output
-					fwrite(&Pixel.uShort, 2, 1, Out);
-				}
-				else {
-					fwrite(&Pixel.Long, 4, 1, Out);
-				}
+				OutputRow[x] = SaturatePixel<PIXELTYPE>(TopPixel + BotPixel);
 			}
 		}
-	}
-
-	fclose(Out);
-	delete[] InputImage;
-
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
-	}
+	});
 
-	TCHAR pszMessageBuf[MAX_PATH];
-	StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Output image size is: %d,%d"), (int)InputXsize, (int)OutputYsize);
-	MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
 	return APP_SUCCESS;
 }
 
+template int FoldImageUpBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, int FoldRow);
+template int FoldImageUpBuffer(IMAGEBUFFER8* In, IMAGEBUFFER8* Out, int FoldRow);
+template int FoldImageUpBuffer(IMAGEBUFFER16* In, IMAGEBUFFER16* Out, int FoldRow);
+
 //******************************************************************************
 //
 // AccordionImageLeft
@@ -2188,22 +3153,9 @@ int AccordionImageLeft(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Accor
 		return APPERR_PARAMETER;
 	}
 
-	int LeftAddress;
-	int RightAddress;
-	int Address;
-	int RightPixel, LeftPixel;
-	int StartXleft;
-	int StartXright;
-	int RightX;
-	int LeftX;
 	int OutputXsize;
 	int NumFolds;
 	int FoldSize;
-	int InputOffset;
-	int OutputOffset;
-	PIXEL Pixel;
-	int i;
-	int y;
 
 	NumFolds = InputXsize / AccordionSize; // number of folds in accordion
 	FoldSize = InputXsize / NumFolds;
@@ -2216,11 +3168,23 @@ int AccordionImageLeft(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Accor
 		return APPERR_MEMALLOC;
 	}
 
-	// fold accordian
-	for (int Frame = 0; Frame < ImageHeader.NumFrames; Frame++) {
+	// fold accordian, the frames and rows are independent of each other
+	ParallelForFrames(ImageHeader.NumFrames, InputYsize, [&](int Frame, int StartY, int EndY) {
+		int LeftAddress;
+		int RightAddress;
+		int Address;
+		int RightPixel, LeftPixel;
+		int StartXleft;
+		int StartXright;
+		int RightX;
+		int LeftX;
+		int InputOffset;
+		int OutputOffset;
+		int i;
+
 		InputOffset = Frame * InputXsize * InputYsize;
 		OutputOffset = Frame * OutputXsize * InputYsize;
-		for (y = 0; y < InputYsize; y++) {
+		for (int y = StartY; y < EndY; y++) {
 			for (int j = 0; j < NumFolds; j++) {
 				Address = (y * OutputXsize) + (j * (FoldSize / 2)) + OutputOffset;
 				StartXleft = j * FoldSize;
@@ -2228,13 +3192,13 @@ int AccordionImageLeft(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Accor
 				for (LeftX = StartXleft, RightX = StartXright, i = 0; i < FoldSize / 2; i++, LeftX++, RightX--, Address++) {
 					RightAddress = y * InputXsize + RightX + InputOffset;
 					LeftAddress = y * InputXsize + LeftX + InputOffset;
-					LeftPixel = InputImage[LeftAddress];;
+					LeftPixel = InputImage[LeftAddress];
 					RightPixel = InputImage[RightAddress];
-					OutputImage[Address] = (int)(LeftPixel + RightPixel);
+					OutputImage[Address] = LeftPixel + RightPixel;
 				}
 			}
 		}
-	}
+	});
 	delete[] InputImage;
 
 	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
@@ -2246,30 +3210,26 @@ int AccordionImageLeft(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Accor
 
 	// write new header
 	ImageHeader.Xsize = OutputXsize;
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
-
-	// write file
-	for (Address = 0; Address < (OutputXsize * InputYsize); Address++) {
-		Pixel.Long = OutputImage[Address];
-		if (ImageHeader.PixelSize == 1) {
-			if (Pixel.Long > 255) Pixel.Long = 255; //clip output
-			fwrite(&Pixel.Byte, 1, 1, Out);
-		}
-		else if (ImageHeader.PixelSize == 2) {
-			if (Pixel.Long > 65535) Pixel.Long = 65535; // clip output
-			fwrite(&Pixel.uShort, 2, 1, Out);
-		}
-		else {
-			fwrite(&Pixel.Long, 4, 1, Out);
-		}
+	iRes = APPERR_FILEWRITE;
+	if (fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out) == 1) {
+		// write file, all frames
+		iRes = WriteImagePixels(Out, OutputImage,
+			(size_t)OutputXsize * (size_t)InputYsize * (size_t)ImageHeader.NumFrames,
+			ImageHeader.PixelSize, ImageHeader.Endian);
 	}
 
-	fclose(Out);
-	free(OutputImage);
-
+	if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
+	if (iRes != APP_SUCCESS) {
+		free(OutputImage);
+		MessageBox(hDlg, L"Could not write results file", L"File I/O", MB_OK);
+		return iRes;
+	}
 	if (DisplayResults) {
-		DisplayImage(OutputFile);
+		DisplayImageFrame(OutputImage, &ImageHeader);
 	}
+	free(OutputImage);
 
 	TCHAR pszMessageBuf[MAX_PATH];
 	StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Output image size is: %d,%d"), (int)OutputXsize, (int)InputYsize);
@@ -2336,22 +3296,9 @@ int AccordionImageRight(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Acco
 		return APPERR_PARAMETER;
 	}
 
-	int LeftAddress;
-	int RightAddress;
-	int Address;
-	int RightPixel, LeftPixel;
-	int StartXleft;
-	int StartXright;
-	int RightX;
-	int LeftX;
 	int OutputXsize;
 	int NumFolds;
 	int FoldSize;
-	int InputOffset;
-	int OutputOffset;
-	PIXEL Pixel;
-	int i;
-	int y;
 
 	NumFolds = InputXsize / AccordionSize; // number of folds in accordion
 	FoldSize = InputXsize / NumFolds;
@@ -2364,11 +3311,23 @@ int AccordionImageRight(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Acco
 		return APPERR_MEMALLOC;
 	}
 
-	// fold accordian
-	for (int Frame = 0; Frame < ImageHeader.NumFrames; Frame++) {
+	// fold accordian, the frames and rows are independent of each other
+	ParallelForFrames(ImageHeader.NumFrames, InputYsize, [&](int Frame, int StartY, int EndY) {
+		int LeftAddress;
+		int RightAddress;
+		int Address;
+		int RightPixel, LeftPixel;
+		int StartXleft;
+		int StartXright;
+		int RightX;
+		int LeftX;
+		int InputOffset;
+		int OutputOffset;
+		int i;
+
 		InputOffset = Frame * InputXsize * InputYsize;
 		OutputOffset = Frame * OutputXsize * InputYsize;
-		for (y = 0; y < InputYsize; y++) {
+		for (int y = StartY; y < EndY; y++) {
 			for (int j = 0; j < NumFolds; j++) {
 				Address = (y * OutputXsize) + (j * (FoldSize / 2)) + OutputOffset;
 				StartXleft = j * FoldSize + ((FoldSize / 2) - 1);
@@ -2382,7 +3341,7 @@ int AccordionImageRight(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Acco
 				}
 			}
 		}
-	}
+	});
 	delete[] InputImage;
 
 	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
@@ -2394,30 +3353,26 @@ int AccordionImageRight(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Acco
 
 	// write new header
 	ImageHeader.Xsize = OutputXsize;
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
-
-	// write file
-	for (Address = 0; Address < (OutputXsize * InputYsize); Address++) {
-		Pixel.Long = OutputImage[Address];
-		if (ImageHeader.PixelSize == 1) {
-			if (Pixel.Long > 255) Pixel.Long = 255; //clip output
-			fwrite(&Pixel.Byte, 1, 1, Out);
-		}
-		else if (ImageHeader.PixelSize == 2) {
-			if (Pixel.Long > 65535) Pixel.Long = 65535; // clip output
-			fwrite(&Pixel.uShort, 2, 1, Out);
-		}
-		else {
-			fwrite(&Pixel.Long, 4, 1, Out);
-		}
+	iRes = APPERR_FILEWRITE;
+	if (fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out) == 1) {
+		// write file, all frames
+		iRes = WriteImagePixels(Out, OutputImage,
+			(size_t)OutputXsize * (size_t)InputYsize * (size_t)ImageHeader.NumFrames,
+			ImageHeader.PixelSize, ImageHeader.Endian);
 	}
 
-	fclose(Out);
-	free(OutputImage);
-
+	if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
+	if (iRes != APP_SUCCESS) {
+		free(OutputImage);
+		MessageBox(hDlg, L"Could not write results file", L"File I/O", MB_OK);
+		return iRes;
+	}
 	if (DisplayResults) {
-		DisplayImage(OutputFile);
+		DisplayImageFrame(OutputImage, &ImageHeader);
 	}
+	free(OutputImage);
 
 	TCHAR pszMessageBuf[MAX_PATH];
 	StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Output image size is: %d,%d"), (int)OutputXsize, (int)InputYsize);
@@ -2453,8 +3408,8 @@ int LeftShiftImage(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile)
 	int NumSkipped;
 	int Skipped;
 	int RowsSkipped = 0;
-	PIXEL Pixel;
 	int* InputImage;
+	int* OutputRow;
 	IMAGINGHEADER ImageHeader;
 	int x, y;
 	int iRes;
@@ -2465,8 +3420,18 @@ int LeftShiftImage(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile)
 		return iRes;
 	}
 
+	// output is generated one row at a time
+	OutputRow = new int[(size_t)ImageHeader.Xsize];
+	if (OutputRow == NULL) {
+		delete[] InputImage;
+		MessageBox(hDlg, L"Output row alloc failure", L"File I/O", MB_OK);
+		return APPERR_MEMALLOC;
+	}
+
 	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
 	if (!Out) {
+		delete[] OutputRow;
+		delete[] InputImage;
 		MessageBox(hDlg, L"Could not open output file", L"File I/O", MB_OK);
 		return APPERR_FILEOPEN;
 	}
@@ -2475,70 +3440,61 @@ int LeftShiftImage(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile)
 	// Add skipped lines to end of frame to keep image same size as input image
 	// 
 	// write out image header
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
+	iRes = APP_SUCCESS;
+	if (fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out) != 1) {
+		iRes = APPERR_FILEWRITE;
+	}
 
 	int Address = 0;
+	int OutX;
 
-	for (int Frame = 0; Frame < ImageHeader.NumFrames; Frame++) {
+	for (int Frame = 0; Frame < ImageHeader.NumFrames && iRes == APP_SUCCESS; Frame++) {
 		for (int y = 0; y < ImageHeader.Ysize; y++) {
 			Skipped = 0;
 			NumSkipped = 0;
+			OutX = 0;
 			for (x = 0; x < ImageHeader.Xsize; x++) {
-				Pixel.Long = InputImage[Address];
-				Address++;
-				if (Pixel.Long >= 1 || Skipped == 1) {
-					if (ImageHeader.PixelSize == 1) {
-						fwrite(&Pixel.Byte, 1, 1, Out);
-					}
-					else if (ImageHeader.PixelSize == 2) {
-						fwrite(&Pixel.uShort, 2, 1, Out);
-					}
-					else {
-						fwrite(&Pixel.Long, 4, 1, Out);
-					}
+				if (InputImage[Address] >= 1 || Skipped == 1) {
+					OutputRow[OutX] = InputImage[Address];
+					OutX++;
 					Skipped = 1;
 				}
 				else {
 					NumSkipped++;
 				}
+				Address++;
 			}
-			Pixel.Long = 0;
 			if (NumSkipped >= ImageHeader.Xsize) {
 				RowsSkipped++;
 				continue;
 			}
 			// pad out row
-			for (x = 0; x < NumSkipped; x++) {
-				if (ImageHeader.PixelSize == 1) {
-					fwrite(&Pixel.Byte, 1, 1, Out);
-				}
-				else if (ImageHeader.PixelSize == 2) {
-					fwrite(&Pixel.uShort, 2, 1, Out);
-				}
-				else {
-					fwrite(&Pixel.Long, 4, 1, Out);
-				}
+			for (x = OutX; x < ImageHeader.Xsize; x++) {
+				OutputRow[x] = 0;
+			}
+			iRes = WriteImagePixels(Out, OutputRow, ImageHeader.Xsize, ImageHeader.PixelSize, ImageHeader.Endian);
+			if (iRes != APP_SUCCESS) {
+				break;
 			}
 		}
 	}
 	delete[] InputImage;
 
-	Pixel.Long = 0;
-	for (y = 0; y < RowsSkipped; y++) {
-		for (x = 0; x < ImageHeader.Xsize; x++) {
-			if (ImageHeader.PixelSize == 1) {
-				fwrite(&Pixel.Byte, 1, 1, Out);
-			}
-			else if (ImageHeader.PixelSize == 2) {
-				fwrite(&Pixel.uShort, 2, 1, Out);
-			}
-			else {
-				fwrite(&Pixel.Long, 4, 1, Out);
-			}
-		}
+	for (x = 0; x < ImageHeader.Xsize; x++) {
+		OutputRow[x] = 0;
+	}
+	for (y = 0; y < RowsSkipped && iRes == APP_SUCCESS; y++) {
+		iRes = WriteImagePixels(Out, OutputRow, ImageHeader.Xsize, ImageHeader.PixelSize, ImageHeader.Endian);
 	}
+	delete[] OutputRow;
 
-	fclose(Out);
+	if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
+	if (iRes != APP_SUCCESS) {
+		MessageBox(hDlg, L"Could not write output file", L"File I/O", MB_OK);
+		return iRes;
+	}
 
 	if (DisplayResults) {
 		DisplayImage(OutputFile);
@@ -2588,107 +3544,131 @@ int LeftShiftImage(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile)
 //*******************************************************************************
 int ConvolveImage(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, WCHAR* OutputFile)
 {
-	int iRes;
-	int* InputImage;
-	int* OutputImage;
 	float* Kernel;
 	int KernelXsize;
 	int KernelYsize;
-	PIXEL Pixel;
-	FILE* TextIn;
-	FILE* Out;
-	IMAGINGHEADER ImageHeader;
+	int iRes;
 
-	iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
+	// read in convolution kernel
+	iRes = ReadConvolutionKernel(TextInput, &Kernel, &KernelXsize, &KernelYsize);
 	if (iRes != APP_SUCCESS) {
-		MessageBox(hDlg, L"Could not load input image", L"File I/O error", MB_OK);
+		if (iRes == APPERR_FILEOPEN) {
+			MessageBox(hDlg, L"Could not open decom file", L"File I/O", MB_OK);
+		}
+		else if (iRes == APPERR_MEMALLOC) {
+			MessageBox(hDlg, L"Kernel allocation failure", L"File I/O", MB_OK);
+		}
+		else {
+			MessageBox(hDlg, L"bad format or too small, Kernel file", L"File I/O", MB_OK);
+		}
 		return iRes;
 	}
 
-	OutputImage = (int*)calloc((size_t)ImageHeader.Xsize * (size_t)ImageHeader.Ysize * (size_t)ImageHeader.NumFrames, sizeof(int));
-	if (OutputImage == NULL) {
-		return APPERR_MEMALLOC;
+	iRes = RunFileTransform(L"ConvolveImage", hDlg, InputFile, OutputFile, [&](IMAGEBUFFER* In, IMAGEBUFFER* Out) -> int {
+		return ConvolveImageBuffer(In, Out, Kernel, KernelXsize, KernelYsize);
+	}, L"Could not load input image", NULL);
+	delete[] Kernel;
+
+	return iRes;
+}
+
+//******************************************************************************
+//
+// ConvolveImageBuffer
+// 
+// In memory version of ConvolveImage().  The pixels along the border that the
+// kernel does not cover are set to 0.
+// 
+// Parameters:
+//	IMAGEBUFFER* In			input image
+//	IMAGEBUFFER* Out		convolved image, must not be In
+//	float* Kernel			convolution kernel, KernelXsize*KernelYsize
+//	int KernelXsize
+//	int KernelYsize
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int ConvolveImageBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, float* Kernel, int KernelXsize, int KernelYsize)
+{
+	int iRes;
+
+	if (KernelXsize <= 0 || KernelYsize <= 0) {
+		return APPERR_PARAMETER;
 	}
-	// read in convolution kernel
+
+	iRes = ReserveImageBuffer(Out, &In->Header);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+	memset(Out->Image, 0, (size_t)In->Header.Xsize * (size_t)In->Header.Ysize *
+					(size_t)In->Header.NumFrames * sizeof(int));
+
+	// all frames are convolved together so the work can be split across threads
+	ConvolveFrames(Kernel, KernelXsize, KernelYsize, In->Image, Out->Image,
+		In->Header.Xsize, In->Header.Ysize, In->Header.NumFrames);
+
+	return APP_SUCCESS;
+}
+
+//******************************************************************************
+//
+// ReadConvolutionKernel
+// 
+// Read a convolution kernel text file.  The first line is the kernel
+// x size and y size (xsize,ysize) followed by xsize*ysize kernel values.
+// 
+// Parameters:
+//	WCHAR* TextInput		kernel text file
+//	float** KernelPtr		returned kernel, caller must delete[] it
+//	int* KernelXsize
+//	int* KernelYsize
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int ReadConvolutionKernel(WCHAR* TextInput, float** KernelPtr, int* KernelXsize, int* KernelYsize)
+{
+	FILE* TextIn;
 	errno_t ErrNum;
+	float* Kernel;
+	int iRes;
+
+	*KernelPtr = NULL;
 
 	ErrNum = _wfopen_s(&TextIn, TextInput, L"r");
 	if (!TextIn) {
-		MessageBox(hDlg, L"Could not open decom file", L"File I/O", MB_OK);
 		return APPERR_FILEOPEN;
 	}
 
-	iRes = fscanf_s(TextIn, "%d,%d", &KernelXsize, &KernelYsize);
-	if (iRes != 2) {
+	iRes = fscanf_s(TextIn, "%d,%d", KernelXsize, KernelYsize);
+	if (iRes != 2 || *KernelXsize <= 0 || *KernelYsize <= 0) {
 		fclose(TextIn);
-		delete[] InputImage;
-		free(OutputImage);
-		MessageBox(hDlg, L"bad format, kernel file", L"File I/O", MB_OK);
 		return APPERR_FILEREAD;
 	}
 
-	Kernel = new float[(size_t)KernelXsize * (size_t)KernelYsize];
+	Kernel = new float[(size_t)*KernelXsize * (size_t)*KernelYsize];
 	if (Kernel == NULL) {
 		fclose(TextIn);
-		delete[] InputImage;
-		free(OutputImage);
-		MessageBox(hDlg, L"Kernel allocation failure", L"File I/O", MB_OK);
 		return APPERR_MEMALLOC;
 	}
 
-	for (int i = 0; i < (KernelXsize * KernelYsize); i++) {
+	for (int i = 0; i < (*KernelXsize * *KernelYsize); i++) {
 		Kernel[i] = 0;
 		iRes = fscanf_s(TextIn, "%f", &Kernel[i]);
-		if (iRes != APP_SUCCESS) {
+		if (iRes != 1) {
 			delete[] Kernel;
 			fclose(TextIn);
-			delete[] InputImage;
-			free(OutputImage);
-			MessageBox(hDlg, L"bad format or too small, Kernel file", L"File I/O", MB_OK);
 			return APPERR_FILEREAD;
 		}
 	}
 	fclose(TextIn);
 
-	int FrameOffset;
-	for (int Frame = 0; Frame < ImageHeader.NumFrames; Frame++) {
-		FrameOffset = Frame * ImageHeader.Xsize * ImageHeader.Ysize;
-		Convolve(Kernel, KernelXsize, KernelYsize, InputImage + FrameOffset, OutputImage + FrameOffset,
-			ImageHeader.Xsize, ImageHeader.Ysize);
-	}
-	delete[] InputImage;
-	delete[] Kernel;
-
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-	if (Out == NULL) {
-		free(OutputImage);
-		MessageBox(hDlg, L"Could not open output file", L"File I/O", MB_OK);
-		return APPERR_FILEOPEN;
-	}
-
-	// write out image header
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
-
-	// write image
-	for (int i = 0; i < (ImageHeader.Xsize * ImageHeader.Ysize * ImageHeader.NumFrames); i++) {
-		Pixel.Long = OutputImage[i];
-		if (ImageHeader.PixelSize == 1) {
-			fwrite(&Pixel.Byte, 1, 1, Out);
-		}
-		else if (ImageHeader.PixelSize == 2) {
-			fwrite(&Pixel.uShort, 2, 1, Out);
-		}
-		else {
-			fwrite(&Pixel.Long, 4, 1, Out);
-		}
-	}
-	fclose(Out);
-	free(OutputImage);
-
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
-	}
-
+	*KernelPtr = Kernel;
 	return APP_SUCCESS;
 }
 
@@ -2697,93 +3677,156 @@ int ConvolveImage(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, WCHAR* OutputFi
 // Convolve
 // 
 // Private function for ConvolveImage()
+// 
+// Convolve a single frame.  The convolution engine is in Convolution.cpp
 //
 //*******************************************************************************
 void Convolve(float* Kernel, int KernelXsize, int KernelYsize, int* Image, int* NewImage, int xsize, int ysize) {
-	int x, y;
-	int Address;
-	int StartX, EndX;
-	int StartY, EndY;
-
-	if (KernelXsize % 2) {
-		// even kernel X size
-		StartX = KernelXsize / 2 + 1;
-		EndX = xsize - StartX;
-	}
-	else {
-		// odd kernel X size
-		StartX = KernelXsize / 2;
-		EndX = xsize - StartX;
-	}
-
-	if (KernelYsize % 2) {
-		// even kernel Y size
-		StartY = KernelYsize / 2 + 1;
-		EndY = ysize - StartY;
-	}
-	else {
-		// odd kernel Y size
-		StartY = KernelYsize / 2;
-		EndY = ysize - StartY;
-	}
 
-	for (y = StartY; y < EndY; y++) {
-		for (x = StartX; x < EndX; x++) {
-			Address = x + (y * xsize);
-			NewImage[Address] = CalculateConvPixel(x, y, Image, Kernel, KernelXsize, KernelYsize, xsize);
-		}
-	}
+	// single frame, see Convolution.cpp
+	ConvolveFrames(Kernel, KernelXsize, KernelYsize, Image, NewImage, xsize, ysize, 1);
 
 	return;
 }
 
 //******************************************************************************
 //
-// CalculateConvPixel
+// AddImages
+// 
+// This function adds 2 image files together frame by frame.
+// The 2 files must be the same size and number of frames.
+// No scaling of the result is done.  Image is clipped based
+// on the PixelSize.  If result is <0 then 0.  If result is larger than
+// maximum value based on pixel size then maximum value for pixel size.
+// 
+// Parameters:
+//	HWND hDlg				Handle of calling window or dialog
+//	WCHAR* InputFile		Image file to sum next wnext file
+//	WCHAR* InputFile2		Image file to sum
+//	WCHAR* OutputFile		Summed image file
+//	int	AddFlag				TRUE -  added images
+//							FALSE - Subtract 2nd image from 1st image
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
 //
-// Private function for Convolve()
+//*******************************************************************************
+int AddSubtractImages(HWND hDlg, WCHAR* InputFile, WCHAR* InputFile2, WCHAR* OutputFile, int AddFlag)
+{
+	int ArithmeticFlag;
+
+	return ImageMath(hDlg, InputFile, InputFile2, OutputFile,
+		AddFlag ? PIXELMATH_ADD : PIXELMATH_SUBTRACT, &ArithmeticFlag);
+}
+
+//******************************************************************************
 //
+// ImageMath
+// 
+// This function combines 2 image files pixel by pixel, frame by frame.
+// The 2 files must be the same size and number of frames.
+// Image is clipped based on the PixelSize.  If result is <0 then 0.
+// If result is larger than maximum value based on pixel size then maximum
+// value for pixel size.
+// 
+// Parameters:
+//	HWND hDlg				Handle of calling window or dialog
+//	WCHAR* InputFile		first image file
+//	WCHAR* InputFile2		second image file
+//	WCHAR* OutputFile		result image file
+//	int Operation			PIXELMATH_ADD ... PIXELMATH_SUBTRACT, see PixelMath.h
+//	int* ArithmeticFlag		set to 1 if a result was clipped, 0 otherwise
 // 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
 //*******************************************************************************
-int CalculateConvPixel(int x, int y, int* Image, float* Kernel, int KernelXsize, int KernelYsize, int xsize)
+int ImageMath(HWND hDlg, WCHAR* InputFile, WCHAR* InputFile2, WCHAR* OutputFile, int Operation, int* ArithmeticFlag)
 {
-	float Summation;
-	int KernelAddress;
-	int PixelAddress;
-	int Pixel;
+	IMAGINGHEADER Input1Header;
+	IMAGINGHEADER Input2Header;
+
+	*ArithmeticFlag = 0;
+	if (Operation < 0 || Operation >= PIXELMATH_NUMOPS) {
+		return APPERR_PARAMETER;
+	}
 
-	Summation = 0.0;
-	for (int i = 0; i < KernelYsize; i++) {
-		for (int j = 0; j < KernelXsize; j++) {
-			KernelAddress = j + (i * KernelXsize);
-			PixelAddress = ((x - KernelXsize / 2) + j) + (((y - KernelYsize / 2) + i) * xsize);
-			Summation += Kernel[KernelAddress] * (float)Image[PixelAddress];
+	// 1 and 2 byte images with the same pixel size are combined at that size
+	if (PeekImageHeader(InputFile, &Input1Header) == APP_SUCCESS &&
+		PeekImageHeader(InputFile2, &Input2Header) == APP_SUCCESS &&
+		Input1Header.PixelSize == Input2Header.PixelSize) {
+		if (Input1Header.PixelSize == 1) {
+			return ImageMathFiles<BYTE>(hDlg, InputFile, InputFile2, OutputFile, Operation, ArithmeticFlag);
+		}
+		if (Input1Header.PixelSize == 2) {
+			return ImageMathFiles<USHORT>(hDlg, InputFile, InputFile2, OutputFile, Operation, ArithmeticFlag);
 		}
 	}
-	if (Summation < 0.0) {
-		Pixel = 0;
+	return ImageMathFiles<int>(hDlg, InputFile, InputFile2, OutputFile, Operation, ArithmeticFlag);
+}
+
+//******************************************************************************
+//
+// ImageMathFiles
+// 
+// Private function, ImageMath() with the images held as PIXELTYPE
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+template <typename PIXELTYPE>
+static int ImageMathFiles(HWND hDlg, WCHAR* InputFile, WCHAR* InputFile2, WCHAR* OutputFile,
+	int Operation, int* ArithmeticFlag)
+{
+	PIXELBUFFER<PIXELTYPE> Input = { 0 };
+	PIXELBUFFER<PIXELTYPE> Input2 = { 0 };
+	PIXELBUFFER<PIXELTYPE> Output = { 0 };
+	int iRes;
+
+	iRes = LoadImageBuffer(&Input, InputFile);
+	if (iRes != APP_SUCCESS) {
+		MessageBox(hDlg, L"Could not load first input image", L"File I/O error", MB_OK);
+		return iRes;
 	}
-	else {
-		Pixel = (int)(Summation + 0.5);
+
+	iRes = LoadImageBuffer(&Input2, InputFile2);
+	if (iRes != APP_SUCCESS) {
+		FreeImageBuffer(&Input);
+		MessageBox(hDlg, L"Could not load szecond input image", L"File I/O error", MB_OK);
+		return iRes;
+	}
+
+	iRes = ImageMathBuffer(&Input, &Input2, &Output, Operation, ArithmeticFlag);
+	FreeImageBuffer(&Input);
+	FreeImageBuffer(&Input2);
+	if (iRes != APP_SUCCESS) {
+		FreeImageBuffer(&Output);
+		if (iRes == APPERR_PARAMETER) {
+			MessageBox(hDlg, L"Input files must be same xsize, ysize, and # of frames", L"Files incomptaible", MB_OK);
+		}
+		else {
+			MessageBox(hDlg, L"Could not allocate output image", L"File I/O error", MB_OK);
+		}
+		return iRes;
 	}
-	return Pixel;
+
+	return WriteTransformResult(hDlg, OutputFile, &Output);
 }
 
 //******************************************************************************
 //
-// AddImages
+// AddSubtractImageBuffer
 // 
-// This function adds 2 image files together frame by frame.
-// The 2 files must be the same size and number of frames.
-// No scaling of the result is done.  Image is clipped based
-// on the PixelSize.  If result is <0 then 0.  If result is larger than
-// maximum value based on pixel size then maximum value for pixel size.
+// In memory version of AddSubtractImages()
 // 
 // Parameters:
-//	HWND hDlg				Handle of calling window or dialog
-//	WCHAR* InputFile		Image file to sum next wnext file
-//	WCHAR* InputFile2		Image file to sum
-//	WCHAR* OutputFile		Summed image file
+//	PIXELBUFFER* In			first image
+//	PIXELBUFFER* In2		second image, same size and # of frames as In
+//	PIXELBUFFER* Out		result image, must not be In or In2
 //	int	AddFlag				TRUE -  added images
 //							FALSE - Subtract 2nd image from 1st image
 // 
@@ -2792,91 +3835,103 @@ int CalculateConvPixel(int x, int y, int* Image, float* Kernel, int KernelXsize,
 //  !=1 Error see standardized app error list at top of this source file
 //
 //*******************************************************************************
-int AddSubtractImages(HWND hDlg, WCHAR* InputFile, WCHAR* InputFile2, WCHAR* OutputFile, int AddFlag)
+template <typename PIXELTYPE>
+int AddSubtractImageBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* In2, PIXELBUFFER<PIXELTYPE>* Out, int AddFlag)
 {
-	int iRes;
-	int* InputImage1;
-	int* InputImage2;
-	int* OutputImage;
-	errno_t ErrNum;
-	PIXEL Pixel;
-	FILE* Out;
-	IMAGINGHEADER Input1Header;
-	IMAGINGHEADER Input2Header;
+	int ArithmeticFlag;
+
+	return ImageMathBuffer(In, In2, Out, AddFlag ? PIXELMATH_ADD : PIXELMATH_SUBTRACT, &ArithmeticFlag);
+}
+
+template int AddSubtractImageBuffer(IMAGEBUFFER* In, IMAGEBUFFER* In2, IMAGEBUFFER* Out, int AddFlag);
+template int AddSubtractImageBuffer(IMAGEBUFFER8* In, IMAGEBUFFER8* In2, IMAGEBUFFER8* Out, int AddFlag);
+template int AddSubtractImageBuffer(IMAGEBUFFER16* In, IMAGEBUFFER16* In2, IMAGEBUFFER16* Out, int AddFlag);
+
+//******************************************************************************
+//
+// ImageMathBuffer
+// 
+// In memory version of ImageMath()
+// A result that is larger than the PixelSize can hold sets ArithmeticFlag,
+// for an 'int' image it is only clipped when the image is written.
+// 
+// Parameters:
+//	PIXELBUFFER* In			first image
+//	PIXELBUFFER* In2		second image, same size and # of frames as In
+//	PIXELBUFFER* Out		result image, must not be In or In2
+//	int Operation			PIXELMATH_ADD ... PIXELMATH_SUBTRACT, see PixelMath.h
+//	int* ArithmeticFlag		set to 1 if a result was clipped, 0 otherwise
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+template <typename PIXELTYPE>
+int ImageMathBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* In2, PIXELBUFFER<PIXELTYPE>* Out,
+	int Operation, int* ArithmeticFlag)
+{
+	IMAGINGHEADER ImageHeader;
+	PIXELTYPE* InputImage1;
+	PIXELTYPE* InputImage2;
+	PIXELTYPE* OutputImage;
+	int iRes;
 
-	iRes = LoadImageFile(&InputImage1, InputFile, &Input1Header);
-	if (iRes != APP_SUCCESS) {
-		MessageBox(hDlg, L"Could not load first input image", L"File I/O error", MB_OK);
-		return iRes;
+	*ArithmeticFlag = 0;
+	if (Operation < 0 || Operation >= PIXELMATH_NUMOPS) {
+		return APPERR_PARAMETER;
+	}
+	if (In->Header.Xsize != In2->Header.Xsize || In->Header.Ysize != In2->Header.Ysize ||
+		In->Header.NumFrames != In2->Header.NumFrames) {
+		return APPERR_PARAMETER;
 	}
 
-	iRes = LoadImageFile(&InputImage2, InputFile2, &Input2Header);
+	ImageHeader = In->Header;
+	iRes = ReserveImageBuffer(Out, &ImageHeader);
 	if (iRes != APP_SUCCESS) {
-		delete[] InputImage1;
-		MessageBox(hDlg, L"Could not load szecond input image", L"File I/O error", MB_OK);
 		return iRes;
 	}
+	InputImage1 = In->Image;
+	InputImage2 = In2->Image;
+	OutputImage = Out->Image;
 
-	if (Input1Header.Xsize != Input2Header.Xsize || Input1Header.Ysize != Input2Header.Ysize ||
-		Input1Header.NumFrames != Input2Header.NumFrames) {
-		MessageBox(hDlg, L"Input files must be same xsize, ysize, and # of frames", L"Files incomptaible", MB_OK);
-		return APPERR_PARAMETER;
-	}
-	OutputImage = new int[(size_t)Input1Header.Xsize * (size_t)Input1Header.Ysize * (size_t)Input1Header.NumFrames];
-	if (OutputImage == NULL) {
-		delete[] InputImage1;
-		delete[] InputImage2;
-		MessageBox(hDlg, L"Could not allocate output image", L"File I/O error", MB_OK);
-		return APPERR_PARAMETER;
-	}
+	// the frames and rows are independent of each other
+	int Xsize = ImageHeader.Xsize;
+	int WarnMax = PixelSizeMax(ImageHeader.PixelSize);
+	std::atomic<int> Clipped(0);
+	ParallelForFrames(ImageHeader.NumFrames, ImageHeader.Ysize, [&](int Frame, int StartY, int EndY) {
+		size_t Start = ((size_t)Frame * (size_t)ImageHeader.Ysize + (size_t)StartY) * (size_t)Xsize;
+		size_t NumPixels = (size_t)(EndY - StartY) * (size_t)Xsize;
 
-	for (int i = 0; i < (Input1Header.Xsize * Input1Header.Ysize * Input1Header.NumFrames); i++) {
-		if (AddFlag) {
-			OutputImage[i] = InputImage1[i] + InputImage2[i];
-		}
-		else {
-			OutputImage[i] = InputImage1[i] - InputImage2[i];
+		if (PixelMath(Operation, InputImage1 + Start, InputImage2 + Start, OutputImage + Start, NumPixels, WarnMax)) {
+			Clipped = 1;
 		}
-		if (OutputImage[i] < 0) OutputImage[i] = 0;
-	}
+	});
+	*ArithmeticFlag = Clipped;
 
-	delete[] InputImage1;
-	delete[] InputImage2;
-
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-	if (Out == NULL) {
-		delete[] OutputImage;
-		MessageBox(hDlg, L"Could not open output file", L"File I/O", MB_OK);
-		return APPERR_FILEOPEN;
-	}
+	return APP_SUCCESS;
+}
 
-	//write output image
-	fwrite(&Input1Header, sizeof(Input1Header), 1, Out);
+template int ImageMathBuffer(IMAGEBUFFER* In, IMAGEBUFFER* In2, IMAGEBUFFER* Out, int Operation, int* ArithmeticFlag);
+template int ImageMathBuffer(IMAGEBUFFER8* In, IMAGEBUFFER8* In2, IMAGEBUFFER8* Out, int Operation, int* ArithmeticFlag);
+template int ImageMathBuffer(IMAGEBUFFER16* In, IMAGEBUFFER16* In2, IMAGEBUFFER16* Out, int Operation, int* ArithmeticFlag);
 
-	// write image
-	for (int i = 0; i < (Input1Header.Xsize * Input1Header.Ysize * Input1Header.NumFrames); i++) {
-		Pixel.Long = OutputImage[i];
-		if (Input1Header.PixelSize == 1) {
-			if (Pixel.Long > 255) Pixel.Long = 255;
-			fwrite(&Pixel.Byte, 1, 1, Out);
-		}
-		else if (Input1Header.PixelSize == 2) {
-			if (Pixel.Long > 65535) Pixel.Long = 65535;
-			fwrite(&Pixel.uShort, 2, 1, Out);
-		}
-		else {
-			fwrite(&Pixel.Long, 4, 1, Out);
-		}
+//******************************************************************************
+//
+// PixelSizeMax
+// 
+// Private function, the largest pixel value an image file PixelSize can hold
+// 
+//*******************************************************************************
+static int PixelSizeMax(int PixelSize)
+{
+	if (PixelSize == 1) {
+		return 255;
 	}
-
-	delete[] OutputImage;
-	fclose(Out);
-
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
+	if (PixelSize == 2) {
+		return 65535;
 	}
-
-	return APP_SUCCESS;
+	return INT_MAX;
 }
 
 //******************************************************************************
@@ -2899,114 +3954,68 @@ int AddSubtractImages(HWND hDlg, WCHAR* InputFile, WCHAR* InputFile2, WCHAR* Out
 //*******************************************************************************
 int RotateImage(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Direction)
 {
-	int iRes;
-	int* InputImage;
-	int* OutputImage;
-	errno_t ErrNum;
-	PIXEL Pixel;
-	FILE* Out;
-	IMAGINGHEADER ImageHeader;
-
-	iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
-	if (iRes != APP_SUCCESS) {
-		MessageBox(hDlg, L"Could not load first input image", L"File I/O error", MB_OK);
-		return iRes;
-	}
-
-	int InputXsize = ImageHeader.Xsize;
-	int InputYsize = ImageHeader.Ysize;
-	int NumFrames = ImageHeader.NumFrames;
-
-	OutputImage = new int[(size_t)ImageHeader.Xsize * (size_t)ImageHeader.Ysize * (size_t)ImageHeader.NumFrames];
-	if (OutputImage == NULL) {
-		delete[] InputImage;
-		MessageBox(hDlg, L"Could not allocate output image", L"File I/O error", MB_OK);
-	}
-
-	int x;
-	int y;
-	int Offset;
-	int InputAddress;
-	int OutputAddress;
-	int InputPixel;
-	int FrameSize;
-	int inputXsize;
-	int inputYsize;
-
-	inputXsize = ImageHeader.Xsize;
-	inputYsize = ImageHeader.Ysize;
-	FrameSize = ImageHeader.Xsize * ImageHeader.Ysize;
+	return RunNativeFileTransform(L"RotateImage", hDlg, InputFile, OutputFile, [&](auto* In, auto* Out) -> int {
+		int Result;
 
-	if (!Direction) {
-		// rotate counter clockwise
-		for (int Frame = 0; Frame < NumFrames; Frame++) {
-			Offset = Frame * FrameSize;
-			for (y = 0; y < inputYsize; y++) {
-				InputAddress = y * inputXsize + Offset;
-				for (x = 0; x < inputXsize; x++) {
-					OutputAddress = ((inputXsize - 1) - x) * inputYsize + Offset + y;
-					InputPixel = InputImage[InputAddress + x];
-					OutputImage[OutputAddress] = InputPixel;
-				}
-			}
-		}
-	}
-	else {
-		// rotate clockwise
-		for (int Frame = 0; Frame < NumFrames; Frame++) {
-			Offset = Frame * FrameSize;
-			for (y = 0; y < inputYsize; y++) {
-				InputAddress = y * inputXsize + Offset;
-				for (x = 0; x < inputXsize; x++) {
-					OutputAddress = Offset + ((inputYsize - 1) - y) + (inputYsize * x);
-					InputPixel = InputImage[InputAddress + x];
-					OutputImage[OutputAddress] = InputPixel;
-				}
-			}
+		Result = RotateImageBuffer(In, Out, Direction);
+		if (Result != APP_SUCCESS) {
+			MessageBox(hDlg, L"Could not allocate output image", L"File I/O error", MB_OK);
 		}
-	}
-
-	delete[] InputImage;
-
-	ImageHeader.Xsize = inputYsize;
-	ImageHeader.Ysize = inputXsize;
+		return Result;
+	}, 0, L"Could not load first input image", NULL);
+}
 
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-	if (Out == NULL) {
-		delete[] OutputImage;
-		MessageBox(hDlg, L"Could not open output file", L"File I/O", MB_OK);
-		return APPERR_FILEOPEN;
-	}
+//******************************************************************************
+//
+// RotateImageBuffer
+// 
+// In memory version of RotateImage()
+// 
+// Parameters:
+//	IMAGEBUFFER* In			image to rotate
+//	IMAGEBUFFER* Out		rotated image, if this is In the image is rotated in place
+//	int Direction			0 - rotate image counter clockwise
+//							1 - rotate image clockwise
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+template <typename PIXELTYPE>
+int RotateImageBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int Direction)
+{
+	IMAGINGHEADER ImageHeader;
+	int iRes;
 
-	//write output image
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
+	ImageHeader = In->Header;
+	ImageHeader.Xsize = In->Header.Ysize;
+	ImageHeader.Ysize = In->Header.Xsize;
 
-	// write image
-	for (int i = 0; i < (ImageHeader.Xsize * ImageHeader.Ysize * ImageHeader.NumFrames); i++) {
-		Pixel.Long = OutputImage[i];
-		if (ImageHeader.PixelSize == 1) {
-			if (Pixel.Long > 255) Pixel.Long = 255;
-			fwrite(&Pixel.Byte, 1, 1, Out);
-		}
-		else if (ImageHeader.PixelSize == 2) {
-			if (Pixel.Long > 65535) Pixel.Long = 65535;
-			fwrite(&Pixel.uShort, 2, 1, Out);
-		}
-		else {
-			fwrite(&Pixel.Long, 4, 1, Out);
+	if (Out == In) {
+		iRes = RotateFramesInPlace(In->Image, In->Header.Xsize, In->Header.Ysize, In->Header.NumFrames, Direction);
+		if (iRes != APP_SUCCESS) {
+			return iRes;
 		}
+		In->Header = ImageHeader;
+		return APP_SUCCESS;
 	}
 
-	delete[] OutputImage;
-	fclose(Out);
-
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
+	iRes = ReserveImageBuffer(Out, &ImageHeader);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
 	}
 
+	// tiled transpose, see Transpose.cpp
+	RotateFrames(In->Image, Out->Image, In->Header.Xsize, In->Header.Ysize, In->Header.NumFrames, Direction);
+
 	return APP_SUCCESS;
 }
 
+template int RotateImageBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, int Direction);
+template int RotateImageBuffer(IMAGEBUFFER8* In, IMAGEBUFFER8* Out, int Direction);
+template int RotateImageBuffer(IMAGEBUFFER16* In, IMAGEBUFFER16* Out, int Direction);
+
 //******************************************************************************
 //
 // MirrorImage
@@ -3027,107 +4036,58 @@ int RotateImage(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Direction)
 //*******************************************************************************
 int MirrorImage(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Direction)
 {
-	int iRes;
-	int* InputImage;
-	int* OutputImage;
-	errno_t ErrNum;
-	PIXEL Pixel;
-	FILE* Out;
-	IMAGINGHEADER ImageHeader;
-
-	iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
-	if (iRes != APP_SUCCESS) {
-		MessageBox(hDlg, L"Could not load first input image", L"File I/O error", MB_OK);
-		return iRes;
-	}
-
-	int InputXsize = ImageHeader.Xsize;
-	int InputYsize = ImageHeader.Ysize;
-	int NumFrames = ImageHeader.NumFrames;
-
-	OutputImage = new int[(size_t)ImageHeader.Xsize * (size_t)ImageHeader.Ysize * (size_t)ImageHeader.NumFrames];
-	if (OutputImage == NULL) {
-		delete[] InputImage;
-		MessageBox(hDlg, L"Could not allocate output image", L"File I/O error", MB_OK);
-	}
-
-	int x;
-	int y;
-	int Offset;
-	int InputAddress;
-	int OutputAddress;
-	int InputPixel;
-	int FrameSize;
-
-	FrameSize = ImageHeader.Xsize * ImageHeader.Ysize;
+	return RunNativeFileTransform(L"MirrorImage", hDlg, InputFile, OutputFile, [&](auto* In, auto* Out) -> int {
+		int Result;
 
-	if (Direction) {
-		// mirror around vertical axis
-		for (int Frame = 0; Frame < NumFrames; Frame++) {
-			Offset = Frame * FrameSize;
-			for (y = 0; y < ImageHeader.Ysize; y++) {
-				OutputAddress = y * ImageHeader.Xsize + Offset;
-				InputAddress = OutputAddress + (ImageHeader.Xsize - 1);
-				for (x = 0; x < ImageHeader.Xsize; x++) {
-					InputPixel = InputImage[InputAddress - x];
-					OutputImage[OutputAddress + x] = InputPixel;
-				}
-			}
-		}
-	}
-	else {
-		// mirror around horizontal axis
-		for (int Frame = 0; Frame < NumFrames; Frame++) {
-			Offset = Frame * FrameSize;
-			for (y = 0; y < ImageHeader.Ysize; y++) {
-				OutputAddress = ((ImageHeader.Ysize - 1) - y) * ImageHeader.Xsize + Offset;
-				InputAddress = y * ImageHeader.Xsize + Offset;
-				for (x = 0; x < ImageHeader.Xsize; x++) {
-					InputPixel = InputImage[InputAddress + x];
-					OutputImage[OutputAddress + x] = InputPixel;
-				}
-			}
+		Result = MirrorImageBuffer(In, Out, Direction);
+		if (Result != APP_SUCCESS) {
+			MessageBox(hDlg, L"Could not allocate output image", L"File I/O error", MB_OK);
 		}
-	}
-
-	delete[] InputImage;
-
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-	if (Out == NULL) {
-		delete[] OutputImage;
-		MessageBox(hDlg, L"Could not open output file", L"File I/O", MB_OK);
-		return APPERR_FILEOPEN;
-	}
+		return Result;
+	}, 0, L"Could not load first input image", NULL);
+}
 
-	//write output image
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
+//******************************************************************************
+//
+// MirrorImageBuffer
+// 
+// In memory version of MirrorImage()
+// 
+// Parameters:
+//	IMAGEBUFFER* In			image to mirror
+//	IMAGEBUFFER* Out		mirrored image, if this is In the image is mirrored in place
+//	int Direction			0 - mirror around horizontal axis
+//							1 - mirror around vertical axis
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+template <typename PIXELTYPE>
+int MirrorImageBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int Direction)
+{
+	IMAGINGHEADER ImageHeader;
+	int iRes;
 
-	// write image
-	for (int i = 0; i < (ImageHeader.Xsize * ImageHeader.Ysize * ImageHeader.NumFrames); i++) {
-		Pixel.Long = OutputImage[i];
-		if (ImageHeader.PixelSize == 1) {
-			if (Pixel.Long > 255) Pixel.Long = 255;
-			fwrite(&Pixel.Byte, 1, 1, Out);
-		}
-		else if (ImageHeader.PixelSize == 2) {
-			if (Pixel.Long > 65535) Pixel.Long = 65535;
-			fwrite(&Pixel.uShort, 2, 1, Out);
-		}
-		else {
-			fwrite(&Pixel.Long, 4, 1, Out);
+	ImageHeader = In->Header;
+	if (Out != In) {
+		iRes = ReserveImageBuffer(Out, &ImageHeader);
+		if (iRes != APP_SUCCESS) {
+			return iRes;
 		}
 	}
 
-	delete[] OutputImage;
-	fclose(Out);
-
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
-	}
+	// see Transpose.cpp
+	MirrorFrames(In->Image, Out->Image, ImageHeader.Xsize, ImageHeader.Ysize, ImageHeader.NumFrames, Direction);
 
 	return APP_SUCCESS;
 }
 
+template int MirrorImageBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, int Direction);
+template int MirrorImageBuffer(IMAGEBUFFER8* In, IMAGEBUFFER8* Out, int Direction);
+template int MirrorImageBuffer(IMAGEBUFFER16* In, IMAGEBUFFER16* Out, int Direction);
+
 //******************************************************************************
 //
 // ResizeImage
@@ -3163,23 +4123,43 @@ int MirrorImage(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Direction)
 //*******************************************************************************
 int ResizeImage(WCHAR* InputFile, WCHAR* OutputFile, int Xsize, int Ysize, int PixelSize)
 {
-	int* InputImage;
+	return RunFileTransform(L"ResizeImage", NULL, InputFile, OutputFile, [&](IMAGEBUFFER* In, IMAGEBUFFER* Out) -> int {
+		return ResizeImageBuffer(In, Out, Xsize, Ysize, PixelSize);
+	}, NULL, NULL);
+}
+
+//******************************************************************************
+//
+// ResizeImageBuffer
+// 
+// In memory version of ResizeImage()
+// 
+// Parameters:
+//	IMAGEBUFFER* In			input image
+//	IMAGEBUFFER* Out		resized image, must not be In
+//	int Xsize				New x size (width), 0 - use input x size
+//	int Ysize				New y size (length), 0 - use input y size
+//	int PixelSize			New Pixel size in bytes (1,2 or 4), 0 - use input pixel size
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int ResizeImageBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, int Xsize, int Ysize, int PixelSize)
+{
 	IMAGINGHEADER ImageHeader;
-	errno_t ErrNum;
-	PIXEL Pixel;
-	FILE* Out;
 	int iRes;
 
-	iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
-	if (iRes != APP_SUCCESS) {
-		return iRes;
-	}
+	ImageHeader = In->Header;
 	if (Xsize == 0) Xsize = ImageHeader.Xsize;
 	if (Ysize == 0) Ysize = ImageHeader.Ysize;
 	if (PixelSize == 0) PixelSize = ImageHeader.PixelSize;
 
 	if (ImageHeader.Xsize * ImageHeader.Ysize != Xsize * Ysize) {
-		delete[] InputImage;
+		return APPERR_PARAMETER;
+	}
+	if (PixelSize != 1 && PixelSize != 2 && PixelSize != 4) {
 		return APPERR_PARAMETER;
 	}
 
@@ -3187,37 +4167,11 @@ int ResizeImage(WCHAR* InputFile, WCHAR* OutputFile, int Xsize, int Ysize, int P
 	ImageHeader.Ysize = Ysize;
 	ImageHeader.PixelSize = PixelSize;
 
-	// write out new image file
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-	if (Out == NULL) {
-		delete[] InputImage;
-		return APPERR_FILEOPEN;
-	}
-
-	//write output image
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
-
-	// write image
-	for (int i = 0; i < (ImageHeader.Xsize * ImageHeader.Ysize * ImageHeader.NumFrames); i++) {
-		Pixel.Long = InputImage[i];
-		if (ImageHeader.PixelSize == 1) {
-			if (Pixel.Long > 255) Pixel.Long = 255;
-			fwrite(&Pixel.Byte, 1, 1, Out);
-		}
-		else if (ImageHeader.PixelSize == 2) {
-			if (Pixel.Long > 65535) Pixel.Long = 65535;
-			fwrite(&Pixel.uShort, 2, 1, Out);
-		}
-		else {
-			fwrite(&Pixel.Long, 4, 1, Out);
-		}
-	}
-	fclose(Out);
-	delete[] InputImage;
-
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
+	iRes = ReserveImageBuffer(Out, &ImageHeader);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
 	}
+	memcpy(Out->Image, In->Image, (size_t)Xsize * (size_t)Ysize * (size_t)ImageHeader.NumFrames * sizeof(int));
 
 	return APP_SUCCESS;
 }
@@ -3259,21 +4213,54 @@ int ResizeImage(WCHAR* InputFile, WCHAR* OutputFile, int Xsize, int Ysize, int P
 //							0 - don't reorder (sill apply new sizes if needed)
 //  return value:
 //  1 - Success
-//	2 - Success, image size is the same size as the input image size
-//  !=1or2 Error see standardized app error list at top of this source file
+//	2 - Success, image size is the same size as the input image size
+//  !=1or2 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int ReorderAlg(WCHAR* InputFile, WCHAR* OutputFile, int Xsize, int Ysize, int PixelSize,
+	int Algorithm, int P1, int P2, int P3, int Invert)
+{
+	int Params[] = { Xsize, Ysize, PixelSize, Algorithm, P1, P2, P3, Invert };
+
+	return CachedFileResult(L"ReorderAlg", InputFile, OutputFile,
+		Params, sizeof(Params) / sizeof(int), [&]() -> int {
+		return RunNativeFileTransform(L"ReorderAlg", NULL, InputFile, OutputFile, [&](auto* In, auto* Out) -> int {
+			return ReorderAlgBuffer(In, Out, Xsize, Ysize, PixelSize, Algorithm, P1, P2, P3, Invert);
+		}, PixelSize, NULL, NULL);
+	});
+}
+
+//******************************************************************************
+//
+// ReorderAlgBuffer
+// 
+// In memory version of ReorderAlg(), see ReorderAlg() for a description
+// of the parameters.
+// 
+// Parameters:
+//	IMAGEBUFFER* In			input image
+//	IMAGEBUFFER* Out		reordered image, must not be In
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
 //
 //*******************************************************************************
-int ReorderAlg(WCHAR* InputFile, WCHAR* OutputFile, int Xsize, int Ysize, int PixelSize,
+template <typename PIXELTYPE>
+int ReorderAlgBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int Xsize, int Ysize, int PixelSize,
 	int Algorithm, int P1, int P2, int P3, int Invert)
 {
-	int* InputImage;
+	PIXELTYPE* InputImage;
+	PIXELTYPE* OutputImage;
+	int* AddressTable;
 	int ResizeFlag;
+	int FrameSize;
+	int iRes;
 	IMAGINGHEADER ImageHeader;
-	errno_t ErrNum;
-	PIXEL Pixel;
-	FILE* Out;
 
-	LoadImageFile(&InputImage, InputFile, &ImageHeader);
+	ImageHeader = In->Header;
+	InputImage = In->Image;
+
 	if (Xsize == 0) {
 		Xsize = ImageHeader.Xsize;
 	}
@@ -3288,7 +4275,6 @@ int ReorderAlg(WCHAR* InputFile, WCHAR* OutputFile, int Xsize, int Ysize, int Pi
 
 	if (ResizeFlag) {
 		if (ImageHeader.Xsize * ImageHeader.Ysize != Xsize * Ysize) {
-			delete[] InputImage;
 			return APPERR_PARAMETER;
 		}
 
@@ -3298,78 +4284,83 @@ int ReorderAlg(WCHAR* InputFile, WCHAR* OutputFile, int Xsize, int Ysize, int Pi
 	if (PixelSize != 0) {
 		ImageHeader.PixelSize = PixelSize;
 	}
+	if (sizeof(PIXELTYPE) != sizeof(int) && ImageHeader.PixelSize != In->Header.PixelSize) {
+		// 1 and 2 byte image buffers keep the pixel size
+		return APPERR_PARAMETER;
+	}
 
-	// reorder image
-	// 
+	// calculate the reordering address table once, it is the same for every frame
+	FrameSize = ImageHeader.Xsize * ImageHeader.Ysize;
+	AddressTable = new int[(size_t)FrameSize];
+	if (AddressTable == NULL) {
+		return APPERR_MEMALLOC;
+	}
 
-	int Offset;
-	int Address;
-	int OutOffset;
-	int* OutputImage;
+	ResizeFlag = ComputeReorderTable(AddressTable, ImageHeader.Xsize, ImageHeader.Ysize, Algorithm, P1, P2, P3);
+	if (ResizeFlag < 0) {
+		delete[] AddressTable;
+		return APPERR_PARAMETER;
+	}
 
-	OutputImage = new int[(size_t)ImageHeader.Xsize * (size_t)ImageHeader.Ysize * (size_t)ImageHeader.NumFrames];
+	if (Invert) {
+		// inverse of reorder algorithm
+		// convert the table OutputImage[AddressTable[i]] = InputImage[i]
+		// into a gather table so that all frames can be processed the same way.
+		// Output pixels that are not the target of any input pixel are set to 0
+		int* InverseTable;
 
-	for (int Frame = 0; Frame < ImageHeader.NumFrames; Frame++) {
-		Offset = Frame * ImageHeader.Xsize * ImageHeader.Ysize;
-		for (int y = 0; y < ImageHeader.Ysize; y++) {
-			OutOffset = y * ImageHeader.Xsize + Offset;
-			for (int x = 0; x < ImageHeader.Xsize; x++) {
-				Address = Offset + CalculateReOrder(x, y, ImageHeader.Xsize, ImageHeader.Ysize,
-					Algorithm, P1, P2, P3, &ResizeFlag);
-				if (!Invert) {
-					OutputImage[OutOffset + x] = InputImage[Address];
-				}
-				else {
-					// inverse of reorder algorithm
-					OutputImage[Address] = InputImage[OutOffset + x];
-				}
-			}
+		InverseTable = new int[(size_t)FrameSize];
+		if (InverseTable == NULL) {
+			delete[] AddressTable;
+			return APPERR_MEMALLOC;
+		}
+		for (int i = 0; i < FrameSize; i++) {
+			InverseTable[i] = -1;
 		}
+		for (int i = 0; i < FrameSize; i++) {
+			InverseTable[AddressTable[i]] = i;
+		}
+		delete[] AddressTable;
+		AddressTable = InverseTable;
 	}
-	delete[] InputImage;
 
-
-	// write out new image file
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-	if (Out == NULL) {
-		delete[] InputImage;
-		return APPERR_FILEOPEN;
+	iRes = ReserveImageBuffer(Out, &ImageHeader);
+	if (iRes != APP_SUCCESS) {
+		delete[] AddressTable;
+		return iRes;
 	}
+	OutputImage = Out->Image;
 
-	//write output image
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
-
-	// write image
-	for (int Frame=0; Frame < ImageHeader.NumFrames; Frame++) {
-		Offset = Frame * ImageHeader.Xsize * ImageHeader.Ysize;
-		for (int y = 0; y < ImageHeader.Ysize; y++) {
-			OutOffset = y * ImageHeader.Xsize + Offset;
+	// reorder image
+	// apply the address table to each row of each frame, in parallel
+	ParallelFor(0, ImageHeader.NumFrames * ImageHeader.Ysize, [&](int StartRow, int EndRow) {
+		size_t Offset;
+		size_t OutOffset;
+		int* Table;
+		int Address;
+
+		for (int Row = StartRow; Row < EndRow; Row++) {
+			Offset = (size_t)(Row / ImageHeader.Ysize) * (size_t)FrameSize;
+			OutOffset = (size_t)Row * (size_t)ImageHeader.Xsize;
+			Table = AddressTable + (OutOffset - Offset);
 			for (int x = 0; x < ImageHeader.Xsize; x++) {
-				Pixel.Long = OutputImage[OutOffset+x];
-				if (ImageHeader.PixelSize == 1) {
-					if (Pixel.Long > 255) Pixel.Long = 255;
-					fwrite(&Pixel.Byte, 1, 1, Out);
-				}
-				else if (ImageHeader.PixelSize == 2) {
-					if (Pixel.Long > 65535) Pixel.Long = 65535;
-					fwrite(&Pixel.uShort, 2, 1, Out);
-				}
-				else {
-					fwrite(&Pixel.Long, 4, 1, Out);
-				}
+				Address = Table[x];
+				OutputImage[OutOffset + x] = Address < 0 ? (PIXELTYPE)0 : InputImage[Offset + Address];
 			}
 		}
-	}
-	fclose(Out);
-	delete[] OutputImage;
-
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
-	}
+	});
+	delete[] AddressTable;
 
 	return APP_SUCCESS;
 }
 
+template int ReorderAlgBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, int Xsize, int Ysize, int PixelSize,
+	int Algorithm, int P1, int P2, int P3, int Invert);
+template int ReorderAlgBuffer(IMAGEBUFFER8* In, IMAGEBUFFER8* Out, int Xsize, int Ysize, int PixelSize,
+	int Algorithm, int P1, int P2, int P3, int Invert);
+template int ReorderAlgBuffer(IMAGEBUFFER16* In, IMAGEBUFFER16* Out, int Xsize, int Ysize, int PixelSize,
+	int Algorithm, int P1, int P2, int P3, int Invert);
+
 //******************************************************************************
 //
 // DecimateImage
@@ -3406,7 +4397,6 @@ int DecimateImage(WCHAR* InputFile, WCHAR* TextFile, WCHAR* OutputFile, int Scal
 	int* Kernel;
 	IMAGINGHEADER ImageHeader;
 	errno_t ErrNum;
-	PIXEL Pixel;
 	FILE* Out;
 	FILE* TextIn;
 	int iRes;
@@ -3545,36 +4535,36 @@ int DecimateImage(WCHAR* InputFile, WCHAR* TextFile, WCHAR* OutputFile, int Scal
 	//write output image
 	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
 	if (Out == NULL) {
+		delete[] OutputImage;
 		return APPERR_FILEOPEN;
 	}
 
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
-
 	// write image
-	for (int i = 0; i < (ImageHeader.Xsize * ImageHeader.Ysize * ImageHeader.NumFrames); i++) {
-		Pixel.Long = OutputImage[i];
-		if (ScalePixel && (Pixel.Long > 1)) {
-			Pixel.Long = 255;
-		}
-		if (ImageHeader.PixelSize == 1) {
-			if (Pixel.Long > 255) Pixel.Long = 255;
-			fwrite(&Pixel.Byte, 1, 1, Out);
-		}
-		else if (ImageHeader.PixelSize == 2) {
-			if (Pixel.Long > 65535) Pixel.Long = 65535;
-			fwrite(&Pixel.uShort, 2, 1, Out);
-		}
-		else {
-			fwrite(&Pixel.Long, 4, 1, Out);
+	if (ScalePixel) {
+		for (int i = 0; i < (ImageHeader.Xsize * ImageHeader.Ysize * ImageHeader.NumFrames); i++) {
+			if (OutputImage[i] > 1) {
+				OutputImage[i] = 255;
+			}
 		}
 	}
+	iRes = APPERR_FILEWRITE;
+	if (fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out) == 1) {
+		iRes = WriteImagePixels(Out, OutputImage,
+			(size_t)ImageHeader.Xsize * (size_t)ImageHeader.Ysize * (size_t)ImageHeader.NumFrames,
+			ImageHeader.PixelSize, ImageHeader.Endian);
+	}
 
-	fclose(Out);
-	delete[] OutputImage;
-
+	if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
+	if (iRes != APP_SUCCESS) {
+		delete[] OutputImage;
+		return iRes;
+	}
 	if (DisplayResults) {
-		DisplayImage(OutputFile);
+		DisplayImageFrame(OutputImage, &ImageHeader);
 	}
+	delete[] OutputImage;
 
 	return APP_SUCCESS;
 }
@@ -3606,24 +4596,49 @@ int DecimateImage(WCHAR* InputFile, WCHAR* TextFile, WCHAR* OutputFile, int Scal
 int StdDecimateImage(WCHAR* InputFile, WCHAR* OutputFile,
 						int Xsize, int Ysize, int PixelSize)
 {
-	int* InputImage;
-	int* OutputImage;
+	if (Xsize <= 0 || Ysize <= 0) {
+		return APPERR_PARAMETER;
+	}
+
+	return RunNativeFileTransform(L"StdDecimateImage", NULL, InputFile, OutputFile, [&](auto* In, auto* Out) -> int {
+		return StdDecimateImageBuffer(In, Out, Xsize, Ysize, PixelSize);
+	}, PixelSize, NULL, NULL);
+}
+
+//******************************************************************************
+//
+// StdDecimateImageBuffer
+// 
+// In memory version of StdDecimateImage()
+// 
+// Parameters:
+//	IMAGEBUFFER* In			input image
+//	IMAGEBUFFER* Out		decimated image, must not be In
+//	int Xsize				x decimate size
+//  int Ysize				y decimate size
+//	int PixelSize			pixel size of the decimated image, 0 - use input pixel size
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+template <typename PIXELTYPE>
+int StdDecimateImageBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int Xsize, int Ysize, int PixelSize)
+{
 	IMAGINGHEADER ImageHeader;
-	errno_t ErrNum;
-	PIXEL Pixel;
-	FILE* Out;
+	PIXELTYPE* InputImage;
+	PIXELTYPE* OutputImage;
 	int iRes;
+
 	if (Xsize <= 0 || Ysize <= 0) {
 		return APPERR_PARAMETER;
 	}
 
-	iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
-	if (iRes != APP_SUCCESS) {
-		delete[]InputImage;
-		return iRes;
-	}
+	ImageHeader = In->Header;
+	InputImage = In->Image;
 
-	if ((ImageHeader.Xsize % Xsize) != 0 && (ImageHeader.Ysize % Ysize) != 0) {
+	if ((ImageHeader.Xsize % Xsize) != 0 || (ImageHeader.Ysize % Ysize) != 0) {
 		// x,y images size must be divisible by x,y decimate size
 		return APPERR_PARAMETER;
 	}
@@ -3634,74 +4649,60 @@ int StdDecimateImage(WCHAR* InputFile, WCHAR* OutputFile,
 	OutXsize = ImageHeader.Xsize / Xsize;
 	OutYsize = ImageHeader.Ysize / Ysize;
 
-	// Apply decimation kernel
-	OutputImage = new int[(size_t)OutXsize * (size_t)OutYsize * (size_t)ImageHeader.NumFrames];
-	if (OutputImage == NULL) {
-		delete[] InputImage;
-		return APPERR_MEMALLOC;
-	}
-
-	int PixelSum;
-	int Address;
-	int AddressOut;
-
-	for (int FrameNum = 0; FrameNum < ImageHeader.NumFrames; FrameNum++) {
-		for (int y = 0, yout = 0; y < ImageHeader.Ysize; y = y + Ysize, yout++) {
-			for (int x = 0, xout = 0; x < ImageHeader.Xsize; x = x + Xsize, xout++) {
-				PixelSum = 0;
-				for (int i = 0; i < Ysize; i++) {
-					for (int j = 0; j < Xsize; j++) {
-						Address = (x + j) + (ImageHeader.Xsize * (y + i)) + (FrameNum * ImageHeader.Xsize * ImageHeader.Ysize);
-						PixelSum = PixelSum + InputImage[Address];
-					}
-				}
-				AddressOut = xout + (yout * OutXsize) + (FrameNum * OutXsize * OutYsize);
-				OutputImage[AddressOut] = PixelSum;
-			}
-		}
-	}
-
-	delete[] InputImage;
-
 	// update header
 	ImageHeader.Xsize = OutXsize;
 	ImageHeader.Ysize = OutYsize;
-	ImageHeader.PixelSize = PixelSize;
+	if (PixelSize != 0) {
+		ImageHeader.PixelSize = PixelSize;
+	}
+	if (sizeof(PIXELTYPE) != sizeof(int) && ImageHeader.PixelSize != In->Header.PixelSize) {
+		// 1 and 2 byte image buffers keep the pixel size
+		return APPERR_PARAMETER;
+	}
 
-	//write output image
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-	if (Out == NULL) {
-		return APPERR_FILEOPEN;
+	// Apply decimation kernel
+	iRes = ReserveImageBuffer(Out, &ImageHeader);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
 	}
+	OutputImage = Out->Image;
 
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
+	int InXsize = In->Header.Xsize;
+	int InYsize = In->Header.Ysize;
+	SummedAreaTable Table;
 
-	// write image
-	for (int i = 0; i < (ImageHeader.Xsize * ImageHeader.Ysize * ImageHeader.NumFrames); i++) {
-		Pixel.Long = OutputImage[i];
-		if (ImageHeader.PixelSize == 1) {
-			if (Pixel.Long > 255) Pixel.Long = 255;
-			fwrite(&Pixel.Byte, 1, 1, Out);
-		}
-		else if (ImageHeader.PixelSize == 2) {
-			if (Pixel.Long > 65535) Pixel.Long = 65535;
-			fwrite(&Pixel.uShort, 2, 1, Out);
-		}
-		else {
-			fwrite(&Pixel.Long, 4, 1, Out);
+	// each block sum is 4 lookups in the summed area table of the frame
+	// so the cost does not depend on the decimate size
+	for (int FrameNum = 0; FrameNum < ImageHeader.NumFrames; FrameNum++) {
+		iRes = Table.Build(&InputImage[(size_t)FrameNum * (size_t)InXsize * (size_t)InYsize], InXsize, InYsize);
+		if (iRes != APP_SUCCESS) {
+			return iRes;
 		}
-	}
 
-	fclose(Out);
-	delete[] OutputImage;
+		// the output rows are independent of each other
+		ParallelFor(0, OutYsize, [&](int StartRow, int EndRow) {
+			LONGLONG BlockSum;
+			int PixelSum;
+			size_t AddressOut;
 
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
+			for (int yout = StartRow; yout < EndRow; yout++) {
+				AddressOut = (size_t)yout * (size_t)OutXsize + (size_t)FrameNum * (size_t)OutXsize * (size_t)OutYsize;
+				for (int xout = 0; xout < OutXsize; xout++, AddressOut++) {
+					BlockSum = Table.Sum(xout * Xsize, yout * Ysize, Xsize, Ysize);
+					PixelSum = BlockSum > INT_MAX ? INT_MAX : (BlockSum < INT_MIN ? INT_MIN : (int)BlockSum);
+					OutputImage[AddressOut] = SaturatePixel<PIXELTYPE>(PixelSum);
+				}
+			}
+		});
 	}
 
 	return APP_SUCCESS;
 }
 
+template int StdDecimateImageBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, int Xsize, int Ysize, int PixelSize);
+template int StdDecimateImageBuffer(IMAGEBUFFER8* In, IMAGEBUFFER8* Out, int Xsize, int Ysize, int PixelSize);
+template int StdDecimateImageBuffer(IMAGEBUFFER16* In, IMAGEBUFFER16* Out, int Xsize, int Ysize, int PixelSize);
+
 //******************************************************************************
 //
 // AddConstant2Image
@@ -3710,86 +4711,83 @@ int StdDecimateImage(WCHAR* InputFile, WCHAR* OutputFile,
 int MathConstant2Image(WCHAR* InputFile, WCHAR* OutputFile, int Value,
 						int Operation, int Warn, int *ArithmeticFlag)
 {
-	int iRes;
-	int* InputImage;
-	int* OutputImage;
-	errno_t ErrNum;
-	PIXEL Pixel;
-	FILE* Out;
-	IMAGINGHEADER InputHeader;
 	if (Warn) *ArithmeticFlag = 0;
 
-	iRes = LoadImageFile(&InputImage, InputFile, &InputHeader);
-	if (iRes != APP_SUCCESS) {
-		return iRes;
-	}
-
-	OutputImage = new int[(size_t)InputHeader.Xsize * (size_t)InputHeader.Ysize * (size_t)InputHeader.NumFrames];
-	if (OutputImage == NULL) {
-		delete[] InputImage;
-		return APPERR_MEMALLOC;
-	}
-
-	for (int i = 0; i < (InputHeader.Xsize * InputHeader.Ysize * InputHeader.NumFrames); i++) {
-		switch (Operation) {
-		case 0: // add/subtract
-			OutputImage[i] = InputImage[i] + Value;
-		default:
-			break;
-
-		case 1: // multiply
-			OutputImage[i] = InputImage[i] * Value;
-			break;
-
-		case 2: // divide
-			OutputImage[i] = InputImage[i] / Value;
-			break;
-		}
+	// a streamed image is done in blocks, the warning is set if any block sets it
+	return RunFileTransform(L"MathConstant2Image", NULL, InputFile, OutputFile, [&](IMAGEBUFFER* In, IMAGEBUFFER* Out) -> int {
+		int BlockFlag = 0;
+		int Result;
 
-		if (OutputImage[i] < 0) {
-			OutputImage[i] = 0;
-			if(Warn) *ArithmeticFlag = 1;
+		Result = MathConstantImageBuffer(In, Out, Value, Operation, Warn, &BlockFlag);
+		if (Warn && BlockFlag) {
+			*ArithmeticFlag = 1;
 		}
-	}
+		return Result;
+	}, NULL, NULL);
+}
 
-	delete[] InputImage;
+//******************************************************************************
+//
+// MathConstantImageBuffer
+// 
+// In memory version of MathConstant2Image()
+// Results < 0 are set to 0.  If Warn is set, ArithmeticFlag is set when a
+// result was < 0 or is larger than the pixel size can hold.
+// 
+// Parameters:
+//	IMAGEBUFFER* In			input image
+//	IMAGEBUFFER* Out		result image, must not be In
+//	int Value				constant
+//	int Operation			0 - add, 1 - multiply, 2 - divide, 3 - min, 4 - max,
+//							5 - AND, 6 - OR, 7 - XOR, 8 - threshold (1 if >= Value)
+//							9 - subtract, see PixelMath.h
+//	int Warn				report underflow/overflow in ArithmeticFlag
+//	int* ArithmeticFlag
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int MathConstantImageBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, int Value,
+						int Operation, int Warn, int* ArithmeticFlag)
+{
+	int* InputImage;
+	int* OutputImage;
+	int iRes;
+	IMAGINGHEADER InputHeader;
 
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-	if (Out == NULL) {
-		delete[] OutputImage;
-		return APPERR_FILEOPEN;
+	if (Warn) *ArithmeticFlag = 0;
+	if (Operation < 0 || Operation >= PIXELMATH_NUMOPS) {
+		return APPERR_PARAMETER;
+	}
+	if (Operation == PIXELMATH_DIVIDE && Value == 0) {
+		return APPERR_PARAMETER;
 	}
 
-	//write output image
-	fwrite(&InputHeader, sizeof(InputHeader), 1, Out);
-
-	// write image
-	for (int i = 0; i < (InputHeader.Xsize * InputHeader.Ysize * InputHeader.NumFrames); i++) {
-		Pixel.Long = OutputImage[i];
-		if (InputHeader.PixelSize == 1) {
-			if (Pixel.Long > 255) {
-				Pixel.Long = 255;
-				if (Warn) *ArithmeticFlag = 1;
-			}
-			fwrite(&Pixel.Byte, 1, 1, Out);
-		}
-		else if (InputHeader.PixelSize == 2) {
-			if (Pixel.Long > 65535) {
-				Pixel.Long = 65535;
-				if (Warn) *ArithmeticFlag = 1;
-			}
-			fwrite(&Pixel.uShort, 2, 1, Out);
-		}
-		else {
-			fwrite(&Pixel.Long, 4, 1, Out);
-		}
+	InputHeader = In->Header;
+	iRes = ReserveImageBuffer(Out, &InputHeader);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
 	}
+	InputImage = In->Image;
+	OutputImage = Out->Image;
 
-	delete[] OutputImage;
-	fclose(Out);
+	// the frames and rows are independent of each other, the overflow
+	// check against the pixel size is done by the kernel before the
+	// writer clamps the pixels
+	int WarnMax = PixelSizeMax(InputHeader.PixelSize);
+	std::atomic<int> Clipped(0);
+	ParallelForFrames(InputHeader.NumFrames, InputHeader.Ysize, [&](int Frame, int StartY, int EndY) {
+		size_t Start = ((size_t)Frame * (size_t)InputHeader.Ysize + (size_t)StartY) * (size_t)InputHeader.Xsize;
+		size_t NumPixels = (size_t)(EndY - StartY) * (size_t)InputHeader.Xsize;
 
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
+		if (PixelMathConstant(Operation, InputImage + Start, Value, OutputImage + Start, NumPixels, WarnMax)) {
+			Clipped = 1;
+		}
+	});
+	if (Warn && Clipped) {
+		*ArithmeticFlag = 1;
 	}
 
 	return APP_SUCCESS;
@@ -3818,49 +4816,74 @@ int MathConstant2Image(WCHAR* InputFile, WCHAR* OutputFile, int Value,
 int ReplicateImage(WCHAR* InputFile, WCHAR* OutputFile,
 	int Xsize, int Ysize)
 {
-	int* InputImage;
-	int* OutputImage;
-	IMAGINGHEADER ImageHeader;
-	errno_t ErrNum;
-	PIXEL Pixel;
-	FILE* Out;
-	int iRes;
 	if (Xsize <= 0 || Ysize <= 0) {
 		return APPERR_PARAMETER;
 	}
 
-	iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
-	if (iRes != APP_SUCCESS) {
-		delete[]InputImage;
-		return iRes;
-	}
+	return RunFileTransform(L"ReplicateImage", NULL, InputFile, OutputFile, [&](IMAGEBUFFER* In, IMAGEBUFFER* Out) -> int {
+		return ReplicateImageBuffer(In, Out, Xsize, Ysize);
+	}, NULL, NULL);
+}
+
+//******************************************************************************
+//
+// ReplicateImageBuffer
+// 
+// In memory version of ReplicateImage()
+// 
+// Parameters:
+//	IMAGEBUFFER* In			input image
+//	IMAGEBUFFER* Out		enlarged image, must not be In
+//	int Xsize				x duplication size
+//  int Ysize				y duplication size
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int ReplicateImageBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, int Xsize, int Ysize)
+{
+	IMAGINGHEADER ImageHeader;
+	int* InputImage;
+	int* OutputImage;
+	int iRes;
 
-	if ((ImageHeader.Xsize % Xsize) != 0 && (ImageHeader.Ysize % Ysize) != 0) {
-		// x,y images size must be divisible by x,y decimate size
+	if (Xsize <= 0 || Ysize <= 0) {
 		return APPERR_PARAMETER;
 	}
 
+	ImageHeader = In->Header;
+	InputImage = In->Image;
+
 	int OutXsize;
 	int OutYsize;
 
 	OutXsize = ImageHeader.Xsize * Xsize;
 	OutYsize = ImageHeader.Ysize * Ysize;
 
-	// Apply decimation kernel
-	OutputImage = new int[(size_t)OutXsize * (size_t)OutYsize * (size_t)ImageHeader.NumFrames];
-	if (OutputImage == NULL) {
-		delete[] InputImage;
-		return APPERR_MEMALLOC;
+	// update header
+	ImageHeader.Xsize = OutXsize;
+	ImageHeader.Ysize = OutYsize;
+
+	iRes = ReserveImageBuffer(Out, &ImageHeader);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
 	}
+	OutputImage = Out->Image;
 
-	int PixelValue;
-	int Address;
-	int AddressOut;
+	int InXsize = In->Header.Xsize;
+	int InYsize = In->Header.Ysize;
 
-	for (int FrameNum = 0; FrameNum < ImageHeader.NumFrames; FrameNum++) {
-		for (int y = 0, yin = 0; y < OutYsize; y = y + Ysize, yin++) {
+	// the frames and input rows are independent of each other
+	ParallelForFrames(ImageHeader.NumFrames, InYsize, [&](int FrameNum, int StartRow, int EndRow) {
+		int PixelValue;
+		int Address;
+		int AddressOut;
+
+		for (int yin = StartRow, y = StartRow * Ysize; yin < EndRow; y = y + Ysize, yin++) {
 			for (int x = 0, xin = 0; x < OutXsize; x = x + Xsize, xin++) {
-				AddressOut = xin + (yin * ImageHeader.Xsize) + (FrameNum * ImageHeader.Xsize * ImageHeader.Ysize);
+				AddressOut = xin + (yin * InXsize) + (FrameNum * InXsize * InYsize);
 				PixelValue = InputImage[AddressOut];
 				for (int i = 0; i < Ysize; i++) {
 					for (int j = 0; j < Xsize; j++) {
@@ -3870,44 +4893,7 @@ int ReplicateImage(WCHAR* InputFile, WCHAR* OutputFile,
 				}
 			}
 		}
-	}
-
-	delete[] InputImage;
-
-	// update header
-	ImageHeader.Xsize = OutXsize;
-	ImageHeader.Ysize = OutYsize;
-
-	//write output image
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-	if (Out == NULL) {
-		return APPERR_FILEOPEN;
-	}
-
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
-
-	// write image
-	for (int i = 0; i < (ImageHeader.Xsize * ImageHeader.Ysize * ImageHeader.NumFrames); i++) {
-		Pixel.Long = OutputImage[i];
-		if (ImageHeader.PixelSize == 1) {
-			if (Pixel.Long > 255) Pixel.Long = 255;
-			fwrite(&Pixel.Byte, 1, 1, Out);
-		}
-		else if (ImageHeader.PixelSize == 2) {
-			if (Pixel.Long > 65535) Pixel.Long = 65535;
-			fwrite(&Pixel.uShort, 2, 1, Out);
-		}
-		else {
-			fwrite(&Pixel.Long, 4, 1, Out);
-		}
-	}
-
-	fclose(Out);
-	delete[] OutputImage;
-
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
-	}
+	});
 
 	return APP_SUCCESS;
 }
@@ -3948,6 +4934,9 @@ int ReplicateImage(WCHAR* InputFile, WCHAR* OutputFile,
 // For Approach1:	The input file xsize*ysize must be divisible by n*m
 // For Approach2:	The input file xsize must be divisible by n, The ysize must be divisble by m
 // This function may use a temporary image file for intermediate results.
+//
+// The image is scanned once into packed null bitmaps (see BuildPixelBitmap and
+// BuildSymbolBitmap), the symbol groups are found from the bitmap of the symbols.
 //	
 // Parameters:
 //	HWND hDlg				Handle of calling window or dialog
@@ -4057,7 +5046,23 @@ int ExtractSymbols(HWND hDlg, WCHAR* InputFile, WCHAR *OutputFile, int MaxNull,
 			}
 		}
 	}
+
+	// packed null bitmaps, one bit per pixel, per row, per symbol list column
+	// and per symbol.  A set bit is not null.  The symbol scans below only
+	// look at the symbol bitmap.
+	std::vector<ULONGLONG> PixelBits((size_t)ImageHeader.Xsize * (size_t)ImageHeader.Ysize / 64 + 2);
+	std::vector<ULONGLONG> RowBits((size_t)ImageHeader.Ysize / 64 + 2);
+	std::vector<ULONGLONG> ColumnBits((size_t)SymbolListXsize / 64 + 2);
+	std::vector<ULONGLONG> SymbolBits((size_t)TotalInputSymbols / 64 + 2);
+
+	BuildPixelBitmap(InputImage, ImageHeader.Xsize, ImageHeader.Ysize, PixelBits.data(), RowBits.data());
 	delete[] InputImage;
+	BuildSymbolBitmap(PixelBits.data(), RowBits.data(), ImageHeader.Xsize, ImageHeader.Ysize,
+		xsizesymbol, ysizesymbol, Approach, ColumnBits.data(), SymbolBits.data(), TRUE);
+
+	auto SymbolFound = [&](int SymbolNum) -> int {
+		return (int)((SymbolBits[(size_t)SymbolNum >> 6] >> (SymbolNum & 63)) & 1);
+	};
 
 	// At this point SymbolList is a linear list of symbols stored as a 2d image
 	// which is ((ImageHeader.Xsize*ImageHeader.Ysize)/ysizesymbol) (H) by ysizesymbol (V)
@@ -4078,29 +5083,23 @@ int ExtractSymbols(HWND hDlg, WCHAR* InputFile, WCHAR *OutputFile, int MaxNull,
 		TempHeader.Xsize = (ImageHeader.Xsize * ImageHeader.Ysize) / ysizesymbol;
 		TempHeader.Ysize = ysizesymbol;
 		TempHeader.NumFrames = 1;
-		fwrite(&TempHeader, sizeof(TempHeader), 1, TempFile);
-
-		for (int i = 0; i < (TempHeader.Xsize * TempHeader.Ysize); i++) {
-			PIXEL Pixel;
-			Pixel.Long = SymbolList[i];
-			if (ImageHeader.PixelSize == 1) {
-				if (Pixel.Long > 255) Pixel.Long = 255;
-				fwrite(&Pixel.Byte, 1, 1, TempFile);
-			}
-			else if (ImageHeader.PixelSize == 2) {
-				if (Pixel.Long > 65535) Pixel.Long = 65535;
-				fwrite(&Pixel.uShort, 2, 1, TempFile);
-			}
-			else {
-				fwrite(&Pixel.Long, 4, 1, TempFile);
-			}
+		iRes = APPERR_FILEWRITE;
+		if (fwrite(&TempHeader, sizeof(TempHeader), 1, TempFile) == 1) {
+			iRes = WriteImagePixels(TempFile, SymbolList, (size_t)TempHeader.Xsize * (size_t)TempHeader.Ysize,
+				TempHeader.PixelSize, TempHeader.Endian);
+		}
+		if (fclose(TempFile) != 0 && iRes == APP_SUCCESS) {
+			iRes = APPERR_FILEWRITE;
+		}
+		if (iRes != APP_SUCCESS) {
+			delete[] SymbolList;
+			MessageBox(hDlg, L"Could not write working image file", L"File I/O", MB_OK);
+			return iRes;
 		}
-		fclose(TempFile);
 	}
 
 	int LengthSymbolGroup;
 	int NumSymbols = 0;
-	PIXEL Pixel;
 	int LongestSymbolGroup = 0;
 
 	// scan the SymbolList image for number of symbols groups
@@ -4112,52 +5111,11 @@ int ExtractSymbols(HWND hDlg, WCHAR* InputFile, WCHAR *OutputFile, int MaxNull,
 	//
 	// First determine the longest 'sentence' in the SymbolList
 	//
-	{
-		LengthSymbolGroup = 0;
-		for (int i = 0; i < TotalInputSymbols; i++) {
-			int SymbolFlag;
-			SymbolFlag = SymbolTest(&SymbolList[i * xsizesymbol], xsizesymbol, ysizesymbol, SymbolListXsize, 0);
-			//look for start of symbol
-			if (SymbolFlag == 0) {
-				continue;
-			}
-			NumSymbols++;
-			NumSymbolsGroups++;
-			// found start of sentence
-			// now  find break that is greater then MaxNull
-			LengthSymbolGroup++;
-			if (LengthSymbolGroup > LongestSymbolGroup) {
-				LongestSymbolGroup++;
-			}
-			int NullsFound = 0;
-			for (i++; i < TotalInputSymbols; i++) {
-				SymbolFlag = SymbolTest(&SymbolList[i * xsizesymbol], xsizesymbol, ysizesymbol, SymbolListXsize, 0);
-				//look for start of symbol
-				if (SymbolFlag == 1) {
-					NullsFound = 0;
-					NumSymbols++;
-					LengthSymbolGroup++;
-					if (LengthSymbolGroup > LongestSymbolGroup) {
-						LongestSymbolGroup++;
-					}
-					continue;
-				}
-				NullsFound++;
-				if (NullsFound > MaxNull) {
-					// end of sentence
-					LengthSymbolGroup = 0;
-					break;
-				}
-				LengthSymbolGroup++;
-				if (LengthSymbolGroup > LongestSymbolGroup) {
-					LongestSymbolGroup++;
-				}
-			}
-		}
-	}
+	SymbolGroupStats(SymbolBits.data(), TotalInputSymbols, MaxNull, &NumSymbolsGroups, &LongestSymbolGroup);
 
 	if (LongestSymbolGroup == 0) {
 		// this is an empty file
+		delete[] SymbolList;
 		MessageBox(hDlg, L"No symbols found in the file", L"File empty", MB_OK);
 		return APPERR_PARAMETER;
 	}
@@ -4206,10 +5164,17 @@ int ExtractSymbols(HWND hDlg, WCHAR* InputFile, WCHAR *OutputFile, int MaxNull,
 		int i;
 		for (i = 0; i < TotalInputSymbols; i++) {
 			int SymbolFlag;
-			SymbolFlag = SymbolTest(&SymbolList[i * xsizesymbol], xsizesymbol, ysizesymbol, SymbolListXsize, 0);
 			//look for start of symbol
-			if (SymbolFlag == 0) {
-				continue;
+			i = (int)NextBitSet(SymbolBits.data(), i, TotalInputSymbols);
+			if (i >= TotalInputSymbols) {
+				break;
+			}
+			JobProgress(i, TotalInputSymbols);
+			if (JobCancelled()) {
+				delete[] OutputImage;
+				delete[] OutputGroup;
+				delete[] SymbolList;
+				return APPERR_CANCELLED;
 			}
 			GroupAddress = LengthSymbolGroup * xsizesymbol;
 			SymbolCopy(&SymbolList[i * xsizesymbol], &OutputGroup[GroupAddress], xsizesymbol, ysizesymbol,
@@ -4221,7 +5186,7 @@ int ExtractSymbols(HWND hDlg, WCHAR* InputFile, WCHAR *OutputFile, int MaxNull,
 			LengthSymbolGroup++;
 			int NullsFound = 0;
 			for (i++; i < TotalInputSymbols; i++) {
-				SymbolFlag = SymbolTest(&SymbolList[i * xsizesymbol], xsizesymbol, ysizesymbol, SymbolListXsize, 0);
+				SymbolFlag = SymbolFound(i);
 				//look for start of symbol
 				if (SymbolFlag == 1) {
 					NullsFound = 0;
@@ -4234,157 +5199,536 @@ int ExtractSymbols(HWND hDlg, WCHAR* InputFile, WCHAR *OutputFile, int MaxNull,
 				}
 				NullsFound++;
 
-				if (NullsFound > MaxNull) {
-					// end of sentence
-					//copy sentence (OutputGroup to OutputImage)
-					for (int n = 0; n < (OutXsize/ xsizesymbol); n++) {
-						int AddressOut;
-						GroupAddress = n * xsizesymbol;
-						AddressOut = (Sentence * OutXsize * ysizesymbol) + GroupAddress;
-						if (SymbolTest(&OutputGroup[GroupAddress], xsizesymbol, ysizesymbol, OutXsize, HIGHLIGHT_NULL)==0 ||
-							SymbolTest(&OutputGroup[GroupAddress], xsizesymbol, ysizesymbol, OutXsize, NULL_IN_PHRASE) == 0) {
-							// if this is null symbol, don't change bit value
-							SymbolCopy(&OutputGroup[GroupAddress], &OutputImage[AddressOut], xsizesymbol, ysizesymbol,
-								OutXsize, OutXsize, 0);
-						}
-						else {
-							SymbolCopy(&OutputGroup[GroupAddress], &OutputImage[AddressOut], xsizesymbol, ysizesymbol,
-								OutXsize, OutXsize, Highlight);
-						}
-					}
-					// clear symbol line for first symbol group
-					for (int k = 0; k < (OutXsize * ysizesymbol); k++) {
-						if (Highlight == 1) {
-							OutputGroup[k] = HIGHLIGHT_NULL;
-						}
-						else {
-							OutputGroup[k] = 0;
-						}
-					}
-					Sentence++;
-					LengthSymbolGroup = 0;
-					break;
-				}
-				NumSymbols++;
-				// copy special in phrase null value if needed
-				if (Highlight) {
-					GroupAddress = LengthSymbolGroup * xsizesymbol;
-					SymbolSet(&OutputGroup[GroupAddress], xsizesymbol, ysizesymbol, OutXsize, NULL_IN_PHRASE);
-				}
-				LengthSymbolGroup++;
-			}
-			if (i >= TotalInputSymbols) {
-				break;
+				if (NullsFound > MaxNull) {
+					// end of sentence
+					//copy sentence (OutputGroup to OutputImage)
+					for (int n = 0; n < (OutXsize/ xsizesymbol); n++) {
+						int AddressOut;
+						GroupAddress = n * xsizesymbol;
+						AddressOut = (Sentence * OutXsize * ysizesymbol) + GroupAddress;
+						if (SymbolTest(&OutputGroup[GroupAddress], xsizesymbol, ysizesymbol, OutXsize, HIGHLIGHT_NULL)==0 ||
+							SymbolTest(&OutputGroup[GroupAddress], xsizesymbol, ysizesymbol, OutXsize, NULL_IN_PHRASE) == 0) {
+							// if this is null symbol, don't change bit value
+							SymbolCopy(&OutputGroup[GroupAddress], &OutputImage[AddressOut], xsizesymbol, ysizesymbol,
+								OutXsize, OutXsize, 0);
+						}
+						else {
+							SymbolCopy(&OutputGroup[GroupAddress], &OutputImage[AddressOut], xsizesymbol, ysizesymbol,
+								OutXsize, OutXsize, Highlight);
+						}
+					}
+					// clear symbol line for first symbol group
+					for (int k = 0; k < (OutXsize * ysizesymbol); k++) {
+						if (Highlight == 1) {
+							OutputGroup[k] = HIGHLIGHT_NULL;
+						}
+						else {
+							OutputGroup[k] = 0;
+						}
+					}
+					Sentence++;
+					LengthSymbolGroup = 0;
+					break;
+				}
+				NumSymbols++;
+				// copy special in phrase null value if needed
+				if (Highlight) {
+					GroupAddress = LengthSymbolGroup * xsizesymbol;
+					SymbolSet(&OutputGroup[GroupAddress], xsizesymbol, ysizesymbol, OutXsize, NULL_IN_PHRASE);
+				}
+				LengthSymbolGroup++;
+			}
+			if (i >= TotalInputSymbols) {
+				break;
+			}
+		}
+		if (i >= TotalInputSymbols) {
+			// this is last sentence
+			//check if it needs to be output
+			if (Sentence < (OutYsize / ysizesymbol)) {
+				for (int n = 0; n < (OutXsize / xsizesymbol); n++) {
+					int AddressOut;
+						GroupAddress = n * xsizesymbol;
+						AddressOut = (Sentence * OutXsize * ysizesymbol) + GroupAddress;
+						if (SymbolTest(&OutputGroup[GroupAddress], xsizesymbol, ysizesymbol, OutXsize, HIGHLIGHT_NULL) == 0 ||
+							SymbolTest(&OutputGroup[GroupAddress], xsizesymbol, ysizesymbol, OutXsize, NULL_IN_PHRASE) == 0) {
+							// if this is null symbol, don't change bit value
+							SymbolCopy(&OutputGroup[GroupAddress], &OutputImage[AddressOut], xsizesymbol, ysizesymbol,
+								OutXsize, OutXsize, 0);
+						}
+						else {
+							SymbolCopy(&OutputGroup[GroupAddress], &OutputImage[AddressOut], xsizesymbol, ysizesymbol,
+								OutXsize, OutXsize, Highlight);
+						}
+				}
+			}
+			Sentence++;
+		}
+	}
+
+	delete[] OutputGroup; 
+	delete[] SymbolList;
+
+	ImageHeader.Xsize = OutXsize;
+	if (Highlight == 0) {
+		ImageHeader.Ysize = OutYsize;
+	}
+	else {
+		ImageHeader.Ysize = OutYsize * 2;
+	}
+	ImageHeader.NumFrames = 1;
+
+	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
+	if (!Out) {
+		delete[] OutputImage;
+		MessageBox(hDlg, L"Could not open output file", L"File I/O", MB_OK);
+		return APPERR_FILEOPEN;
+	}
+
+	// write out image header	
+	iRes = APP_SUCCESS;
+	if (fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out) != 1) {
+		iRes = APPERR_FILEWRITE;
+	}
+
+	// write image
+	if (iRes == APP_SUCCESS && Highlight == 0) {
+		iRes = WriteImagePixels(Out, OutputImage, (size_t)ImageHeader.Xsize * (size_t)ImageHeader.Ysize,
+			ImageHeader.PixelSize, ImageHeader.Endian);
+	}
+	else if (iRes == APP_SUCCESS) {
+		int* BlankRows;
+		BlankRows = new int[(size_t)OutXsize * (size_t)ysizesymbol];
+		if (BlankRows == NULL) {
+			delete[] OutputImage;
+			fclose(Out);
+			MessageBox(hDlg, L"Memory allocation failure", L"System Error", MB_OK);
+			return APPERR_MEMALLOC;
+		}
+		for (int k = 0; k < OutXsize * ysizesymbol; k++) {
+			BlankRows[k] = HIGHLIGHT_NULL;
+		}
+
+		int i = 0;
+		for (int y = 0; y < OutYsize && iRes == APP_SUCCESS; y += ysizesymbol) {
+			// symbol rows
+			iRes = WriteImagePixels(Out, &OutputImage[i], (size_t)ImageHeader.Xsize * (size_t)ysizesymbol,
+				ImageHeader.PixelSize, ImageHeader.Endian);
+			i += ImageHeader.Xsize * ysizesymbol;
+			// write blanks between phrases
+			if (iRes == APP_SUCCESS) {
+				iRes = WriteImagePixels(Out, BlankRows, (size_t)OutXsize * (size_t)ysizesymbol,
+					ImageHeader.PixelSize, ImageHeader.Endian);
+			}
+		}
+		delete[] BlankRows;
+	}
+
+	delete[] OutputImage;
+	if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
+	if (iRes != APP_SUCCESS) {
+		MessageBox(hDlg, L"Could not write output file", L"File I/O", MB_OK);
+		return iRes;
+	}
+
+	if (DisplayResults) {
+		DisplayImage(OutputFile);
+	}
+
+	return APP_SUCCESS;
+}
+
+//******************************************************************************
+//
+// ExtractSymbolsMultiSize
+// 
+// Evaluate a range of symbol x,y sizes for ExtractSymbols() in one pass.
+// The input image is only scanned once into the packed null bitmap, each
+// symbol size then works from the bitmap.  The symbol sizes are evaluated
+// in parallel.  The symbol sizes that do not divide the input image are
+// skipped (see restrictions in ExtractSymbols).
+//
+// The results are written to a csv text file, one line per symbol size:
+//	symbol x size, symbol y size, # of symbols, # of non null symbols,
+//	# of sentences, longest sentence (symbols), output image x size, y size
+// The output image size is without the highlight blank rows.  Use
+// ExtractSymbols() with the selected symbol size to make the image.
+// 
+// Parameters:
+//	HWND hDlg				Handle of calling window or dialog
+//	WCHAR* InputFile		input image file
+//	WCHAR* OutputFile		output csv text file
+//	int MaxNull				When the number of null blocks exceeds this size
+//							then the last symbol group is ended.
+//  int xsizesymbol			smallest x size of a block symbol
+//  int ysizesymbol			smallest y size of a block symbol
+//  int xsizesymbolMax		largest x size of a block symbol
+//  int ysizesymbolMax		largest y size of a block symbol
+//  int Approach			1 - treat input image as linear list of bits
+//							2 - subdivde image into blocks xsizesymbol by ysizesymbol
+//								treat those blocks as symbols.
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int ExtractSymbolsMultiSize(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int MaxNull,
+	int xsizesymbol, int ysizesymbol, int xsizesymbolMax, int ysizesymbolMax, int Approach)
+{
+	typedef struct SYMBOLSIZE {
+		int xsizesymbol;
+		int ysizesymbol;
+		int TotalInputSymbols;
+		int NumNonNull;
+		int NumSymbolsGroups;
+		int LongestSymbolGroup;
+	} SYMBOLSIZE;
+
+	std::vector<SYMBOLSIZE> Sizes;
+	std::atomic<int> NumDone(0);
+	IMAGINGHEADER ImageHeader;
+	int* InputImage;
+	errno_t ErrNum;
+	FILE* Out;
+	int iRes;
+
+	if (xsizesymbol <= 0 || ysizesymbol <= 0 || xsizesymbolMax < xsizesymbol || ysizesymbolMax < ysizesymbol) {
+		MessageBox(hDlg, L"Symbol sizes must be >= 1 and max sizes >= the symbol sizes", L"Bad Parameters", MB_OK);
+		return APPERR_PARAMETER;
+	}
+
+	if (Approach != 1 && Approach != 2) {
+		MessageBox(hDlg, L"Input file aprroach invalid", L"File I/O", MB_OK);
+		return APPERR_PARAMETER;
+	}
+
+	iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
+	if (iRes != APP_SUCCESS) {
+		MessageBox(hDlg, L"Error reading input file", L"File I/O", MB_OK);
+		return iRes;
+	}
+
+	if (ImageHeader.NumFrames != 1) {
+		delete[] InputImage;
+		MessageBox(hDlg, L"Multiple frame files are not supported", L"File I/O", MB_OK);
+		return APPERR_PARAMETER;
+	}
+
+	size_t NumPixels = (size_t)ImageHeader.Xsize * (size_t)ImageHeader.Ysize;
+
+	for (int y = ysizesymbol; y <= ysizesymbolMax; y++) {
+		for (int x = xsizesymbol; x <= xsizesymbolMax; x++) {
+			if ((NumPixels % ((size_t)x * (size_t)y)) != 0) {
+				continue;
 			}
-		}
-		if (i >= TotalInputSymbols) {
-			// this is last sentence
-			//check if it needs to be output
-			if (Sentence < (OutYsize / ysizesymbol)) {
-				for (int n = 0; n < (OutXsize / xsizesymbol); n++) {
-					int AddressOut;
-						GroupAddress = n * xsizesymbol;
-						AddressOut = (Sentence * OutXsize * ysizesymbol) + GroupAddress;
-						if (SymbolTest(&OutputGroup[GroupAddress], xsizesymbol, ysizesymbol, OutXsize, HIGHLIGHT_NULL) == 0 ||
-							SymbolTest(&OutputGroup[GroupAddress], xsizesymbol, ysizesymbol, OutXsize, NULL_IN_PHRASE) == 0) {
-							// if this is null symbol, don't change bit value
-							SymbolCopy(&OutputGroup[GroupAddress], &OutputImage[AddressOut], xsizesymbol, ysizesymbol,
-								OutXsize, OutXsize, 0);
-						}
-						else {
-							SymbolCopy(&OutputGroup[GroupAddress], &OutputImage[AddressOut], xsizesymbol, ysizesymbol,
-								OutXsize, OutXsize, Highlight);
-						}
-				}
+			if (Approach == 2 && (ImageHeader.Ysize % y) != 0) {
+				continue;
 			}
-			Sentence++;
+			SYMBOLSIZE Size = { x, y, (int)(NumPixels / ((size_t)x * (size_t)y)), 0, 0, 0 };
+			Sizes.push_back(Size);
 		}
 	}
+	if (Sizes.size() == 0) {
+		delete[] InputImage;
+		MessageBox(hDlg, L"None of the symbol sizes divide the input x,y size", L"Bad Parameters", MB_OK);
+		return APPERR_PARAMETER;
+	}
 
-	delete[] OutputGroup; 
-	delete[] SymbolList;
+	// the one pass over the image
+	std::vector<ULONGLONG> PixelBits(NumPixels / 64 + 2);
+	std::vector<ULONGLONG> RowBits((size_t)ImageHeader.Ysize / 64 + 2);
 
-	ImageHeader.Xsize = OutXsize;
-	if (Highlight == 0) {
-		ImageHeader.Ysize = OutYsize;
-	}
-	else {
-		ImageHeader.Ysize = OutYsize * 2;
+	BuildPixelBitmap(InputImage, ImageHeader.Xsize, ImageHeader.Ysize, PixelBits.data(), RowBits.data());
+	delete[] InputImage;
+
+	// each symbol size has its own column and symbol bitmaps
+	int NumSizes = (int)Sizes.size();
+	ParallelFor(0, NumSizes, [&](int StartSize, int EndSize) {
+		std::vector<ULONGLONG> ColumnBits;
+		std::vector<ULONGLONG> SymbolBits;
+
+		for (int i = StartSize; i < EndSize; i++) {
+			SYMBOLSIZE* Size = &Sizes[i];
+			if (JobCancelled()) {
+				break;
+			}
+			ColumnBits.assign(NumPixels / (size_t)Size->ysizesymbol / 64 + 2, 0);
+			SymbolBits.assign((size_t)Size->TotalInputSymbols / 64 + 2, 0);
+			BuildSymbolBitmap(PixelBits.data(), RowBits.data(), ImageHeader.Xsize, ImageHeader.Ysize,
+				Size->xsizesymbol, Size->ysizesymbol, Approach, ColumnBits.data(), SymbolBits.data(), FALSE);
+
+			for (size_t Word = 0; Word < SymbolBits.size(); Word++) {
+				Size->NumNonNull += PopCount64(SymbolBits[Word]);
+			}
+			SymbolGroupStats(SymbolBits.data(), Size->TotalInputSymbols, MaxNull,
+				&Size->NumSymbolsGroups, &Size->LongestSymbolGroup);
+
+			JobProgress(++NumDone, NumSizes);
+		}
+	});
+	if (JobCancelled()) {
+		return APPERR_CANCELLED;
 	}
-	ImageHeader.NumFrames = 1;
 
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
+	ErrNum = _wfopen_s(&Out, OutputFile, L"w");
 	if (!Out) {
-		delete[] OutputImage;
 		MessageBox(hDlg, L"Could not open output file", L"File I/O", MB_OK);
 		return APPERR_FILEOPEN;
 	}
 
-	// write out image header	
-	fwrite(&ImageHeader, sizeof(ImageHeader), 1, Out);
+	fprintf(Out, "symbol x size, symbol y size, # of symbols, # of non null symbols, # of sentences, longest sentence, output x size, output y size\n");
+	for (auto& Size : Sizes) {
+		fprintf(Out, "%d, %d, %d, %d, %d, %d, %d, %d\n", Size.xsizesymbol, Size.ysizesymbol,
+			Size.TotalInputSymbols, Size.NumNonNull, Size.NumSymbolsGroups, Size.LongestSymbolGroup,
+			Size.LongestSymbolGroup * Size.xsizesymbol, Size.NumSymbolsGroups * Size.ysizesymbol);
+	}
+	if (fclose(Out) != 0) {
+		MessageBox(hDlg, L"Could not write output file", L"File I/O", MB_OK);
+		return APPERR_FILEWRITE;
+	}
 
-	// write image
-	if (Highlight == 0) {
-		for (int i = 0; i < (ImageHeader.Xsize * ImageHeader.Ysize); i++) {
-			Pixel.Long = OutputImage[i];
-			if (ImageHeader.PixelSize == 1) {
-				if (Pixel.Long > 255) Pixel.Long = 255;
-				fwrite(&Pixel.Byte, 1, 1, Out);
-			}
-			else if (ImageHeader.PixelSize == 2) {
-				if (Pixel.Long > 65535) Pixel.Long = 65535;
-				fwrite(&Pixel.uShort, 2, 1, Out);
-			}
-			else {
-				fwrite(&Pixel.Long, 4, 1, Out);
+	return APP_SUCCESS;
+}
+
+//******************************************************************************
+//
+// BuildPixelBitmap
+// 
+// Private function for ExtractSymbols() and ExtractSymbolsMultiSize()
+//
+// This is the one pass over the input image.  Bit n of PixelBits is set
+// when pixel n (linear address) is not null (0).  Bit y of RowBits is set
+// when row y has a non null pixel.  The bitmaps must have at least 1 word
+// more than the bits, the bits past the end are set to 0.
+//
+//******************************************************************************
+static void BuildPixelBitmap(const int* Image, int Xsize, int Ysize, ULONGLONG* PixelBits, ULONGLONG* RowBits)
+{
+	size_t NumPixels = (size_t)Xsize * (size_t)Ysize;
+	int NumWords = (int)((NumPixels + 63) / 64);
+
+	// each word is 64 pixels, the words are independent of each other
+	ParallelFor(0, NumWords, [&](int StartWord, int EndWord) {
+		for (int Word = StartWord; Word < EndWord; Word++) {
+			size_t Start = (size_t)Word * 64;
+			size_t End = Start + 64 < NumPixels ? Start + 64 : NumPixels;
+			ULONGLONG Value = 0;
+
+			for (size_t i = Start; i < End; i++) {
+				Value |= (ULONGLONG)(Image[i] != 0) << (i - Start);
 			}
+			PixelBits[Word] = Value;
+		}
+	});
+	PixelBits[NumWords] = 0;
+
+	for (int Word = 0; Word <= (Ysize / 64); Word++) {
+		RowBits[Word] = 0;
+	}
+	for (int y = 0; y < Ysize; y++) {
+		if (NextBitSet(PixelBits, (size_t)y * (size_t)Xsize, ((size_t)y + 1) * (size_t)Xsize) < ((size_t)y + 1) * (size_t)Xsize) {
+			RowBits[y >> 6] |= 1ULL << (y & 63);
+		}
+	}
+}
+
+//******************************************************************************
+//
+// BuildSymbolBitmap
+// 
+// Private function for ExtractSymbols() and ExtractSymbolsMultiSize()
+//
+// Bit i of SymbolBits is set when symbol i of the symbol list is not null.
+// Approach 1, symbol i is the linear pixels i*n*m to (i+1)*n*m-1.
+// Approach 2, the symbol list is the rows of symbols side by side, column c
+// of the symbol list is column c % Xsize of symbol row c / Xsize.  The m rows
+// of each symbol row are OR'ed together into ColumnBits (rows that are all
+// null are skipped) and symbol i is the columns i*n to (i+1)*n-1.
+// Both bitmaps are filled a word at a time so the words can be done in
+// parallel.  ColumnBits is only used for approach 2.
+//
+//******************************************************************************
+static void BuildSymbolBitmap(const ULONGLONG* PixelBits, const ULONGLONG* RowBits, int Xsize, int Ysize,
+	int xsizesymbol, int ysizesymbol, int Approach, ULONGLONG* ColumnBits, ULONGLONG* SymbolBits, BOOL Parallel)
+{
+	size_t NumPixels = (size_t)Xsize * (size_t)Ysize;
+	size_t TotalInputSymbols = NumPixels / ((size_t)xsizesymbol * (size_t)ysizesymbol);
+	size_t SymbolListXsize = NumPixels / (size_t)ysizesymbol;
+	const ULONGLONG* SymbolSource;
+	size_t SymbolBitSize;
+
+	auto ForWords = [&](size_t NumBits, const std::function<void(int, int)>& Body) {
+		int NumWords = (int)((NumBits + 63) / 64);
+		if (Parallel) {
+			ParallelFor(0, NumWords, Body);
+		}
+		else {
+			Body(0, NumWords);
+		}
+	};
+
+	// bits Start to Start+NumBits-1 of a bitmap, NumBits 1 to 64
+	auto GetBits = [](const ULONGLONG* Bits, size_t Start, size_t NumBits) -> ULONGLONG {
+		size_t Word = Start >> 6;
+		int Shift = (int)(Start & 63);
+		ULONGLONG Value = Bits[Word] >> Shift;
+		if (Shift != 0) {
+			Value |= Bits[Word + 1] << (64 - Shift);
 		}
+		if (NumBits < 64) {
+			Value &= (1ULL << NumBits) - 1;
+		}
+		return Value;
+	};
+
+	if (Approach == 1) {
+		SymbolSource = PixelBits;
+		SymbolBitSize = (size_t)xsizesymbol * (size_t)ysizesymbol;
 	}
 	else {
-		int i = 0;
-		for (int y = 0; y < OutYsize;) {
-			for (int j=0; j<ysizesymbol; j++, y++) {
-				for (int x = 0; x < ImageHeader.Xsize; x++, i++) {
-					Pixel.Long = OutputImage[i];
-					if (ImageHeader.PixelSize == 1) {
-						if (Pixel.Long > 255) Pixel.Long = 255;
-						fwrite(&Pixel.Byte, 1, 1, Out);
-					}
-					else if (ImageHeader.PixelSize == 2) {
-						if (Pixel.Long > 65535) Pixel.Long = 65535;
-						fwrite(&Pixel.uShort, 2, 1, Out);
-					}
-					else {
-						fwrite(&Pixel.Long, 4, 1, Out);
+		ForWords(SymbolListXsize, [&](int StartWord, int EndWord) {
+			for (int Word = StartWord; Word < EndWord; Word++) {
+				size_t Start = (size_t)Word * 64;
+				size_t End = Start + 64 < SymbolListXsize ? Start + 64 : SymbolListXsize;
+				ULONGLONG Value = 0;
+
+				// a word may cover the end of one symbol row and the start of the next
+				for (size_t c = Start; c < End;) {
+					size_t SymbolRow = c / (size_t)Xsize;
+					size_t x = c % (size_t)Xsize;
+					size_t Length = (size_t)Xsize - x < End - c ? (size_t)Xsize - x : End - c;
+
+					for (int k = 0; k < ysizesymbol; k++) {
+						size_t y = SymbolRow * (size_t)ysizesymbol + (size_t)k;
+						if ((RowBits[y >> 6] >> (y & 63)) & 1) {
+							Value |= GetBits(PixelBits, y * (size_t)Xsize + x, Length) << (c - Start);
+						}
 					}
+					c += Length;
 				}
+				ColumnBits[Word] = Value;
 			}
-			// write blanks between phrases
-			Pixel.Long = HIGHLIGHT_NULL;
-			for (int k = 0; k < OutXsize * ysizesymbol;  k++) {
-				if (ImageHeader.PixelSize == 1) {
-					if (Pixel.Long > 255) Pixel.Long = 255;
-					fwrite(&Pixel.Byte, 1, 1, Out);
-				}
-				else if (ImageHeader.PixelSize == 2) {
-					if (Pixel.Long > 65535) Pixel.Long = 65535;
-					fwrite(&Pixel.uShort, 2, 1, Out);
+		});
+		ColumnBits[(SymbolListXsize + 63) / 64] = 0;
+		SymbolSource = ColumnBits;
+		SymbolBitSize = (size_t)xsizesymbol;
+	}
+
+	ForWords(TotalInputSymbols, [&](int StartWord, int EndWord) {
+		for (int Word = StartWord; Word < EndWord; Word++) {
+			size_t Start = (size_t)Word * 64;
+			size_t End = Start + 64 < TotalInputSymbols ? Start + 64 : TotalInputSymbols;
+			ULONGLONG Value = 0;
+
+			for (size_t i = Start; i < End; i++) {
+				size_t Bit = i * SymbolBitSize;
+				size_t Left = SymbolBitSize;
+				while (Left != 0) {
+					size_t Length = Left < 64 ? Left : 64;
+					if (GetBits(SymbolSource, Bit, Length) != 0) {
+						Value |= 1ULL << (i - Start);
+						break;
+					}
+					Bit += Length;
+					Left -= Length;
 				}
-				else {
-					fwrite(&Pixel.Long, 4, 1, Out);
+			}
+			SymbolBits[Word] = Value;
+		}
+	});
+	SymbolBits[(TotalInputSymbols + 63) / 64] = 0;
+}
+
+//******************************************************************************
+//
+// SymbolGroupStats
+// 
+// Private function for ExtractSymbols() and ExtractSymbolsMultiSize()
+//
+// Scan the symbol bitmap for the number of symbol groups ('sentences') and
+// the length of the longest one, see ExtractSymbols()
+//
+//******************************************************************************
+static void SymbolGroupStats(const ULONGLONG* SymbolBits, int TotalInputSymbols, int MaxNull,
+	int* NumSymbolsGroups, int* LongestSymbolGroup)
+{
+	int LengthSymbolGroup = 0;
+
+	*NumSymbolsGroups = 0;
+	*LongestSymbolGroup = 0;
+
+	for (int i = 0; i < TotalInputSymbols; i++) {
+		//look for start of symbol
+		i = (int)NextBitSet(SymbolBits, i, TotalInputSymbols);
+		if (i >= TotalInputSymbols) {
+			break;
+		}
+		(*NumSymbolsGroups)++;
+		// found start of sentence
+		// now  find break that is greater then MaxNull
+		LengthSymbolGroup++;
+		if (LengthSymbolGroup > *LongestSymbolGroup) {
+			(*LongestSymbolGroup)++;
+		}
+		int NullsFound = 0;
+		for (i++; i < TotalInputSymbols; i++) {
+			if ((SymbolBits[i >> 6] >> (i & 63)) & 1) {
+				NullsFound = 0;
+				LengthSymbolGroup++;
+				if (LengthSymbolGroup > *LongestSymbolGroup) {
+					(*LongestSymbolGroup)++;
 				}
+				continue;
+			}
+			NullsFound++;
+			if (NullsFound > MaxNull) {
+				// end of sentence
+				LengthSymbolGroup = 0;
+				break;
+			}
+			LengthSymbolGroup++;
+			if (LengthSymbolGroup > *LongestSymbolGroup) {
+				(*LongestSymbolGroup)++;
 			}
 		}
 	}
+}
 
-	delete[] OutputImage;
-	fclose(Out);
+//******************************************************************************
+//
+// NextBitSet
+// 
+// Private function, first set bit in a bitmap at or after bit Start
+//
+//  return value:
+//  bit number, NumBits if there is no set bit before NumBits
+//
+//******************************************************************************
+static size_t NextBitSet(const ULONGLONG* Bits, size_t Start, size_t NumBits)
+{
+	unsigned long Index;
+	size_t Word;
+	ULONGLONG Value;
 
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
+	if (Start >= NumBits) {
+		return NumBits;
+	}
+	Word = Start >> 6;
+	Value = Bits[Word] & (~0ULL << (Start & 63));
+	for (;;) {
+		if (ScanForward64(&Index, Value)) {
+			Start = (Word << 6) + Index;
+			return Start < NumBits ? Start : NumBits;
+		}
+		Word++;
+		if ((Word << 6) >= NumBits) {
+			return NumBits;
+		}
+		Value = Bits[Word];
 	}
-
-	return APP_SUCCESS;
 }
 
 //******************************************************************************
@@ -4595,33 +5939,29 @@ int InsertImage(HWND hDlg, WCHAR* ImageInputFile, WCHAR* ImageInputFile2, WCHAR*
 	// write result to output file
 	ErrNum = _wfopen_s(&Out, ImageOutputFile, L"wb");
 	if (Out == NULL) {
+		delete[] NewImage;
 		MessageBox(hDlg, L"Could not open output file", L"File I/O", MB_OK);
 		return APPERR_FILEOPEN;
 	}
 
-	PIXEL Pixel;
 	
 	// save new image header
-	fwrite(&OutputHeader, sizeof(OutputHeader), 1, Out);
-
-	// write image
-	for (int i = 0; i < (OutputHeader.Xsize * OutputHeader.Ysize); i++) {
-		Pixel.Long = NewImage[i];
-		if (OutputHeader.PixelSize == 1) {
-			if (Pixel.Long > 255) Pixel.Long = 255;
-			fwrite(&Pixel.Byte, 1, 1, Out);
-		}
-		else if (OutputHeader.PixelSize == 2) {
-			if (Pixel.Long > 65535) Pixel.Long = 65535;
-			fwrite(&Pixel.uShort, 2, 1, Out);
-		}
-		else {
-			fwrite(&Pixel.Long, 4, 1, Out);
-		}
+	iRes = APPERR_FILEWRITE;
+	if (fwrite(&OutputHeader, sizeof(OutputHeader), 1, Out) == 1) {
+		// write image
+		iRes = WriteImagePixels(Out, NewImage,
+			(size_t)OutputHeader.Xsize * (size_t)OutputHeader.Ysize,
+			OutputHeader.PixelSize, OutputHeader.Endian);
 	}
 
-	fclose(Out);
+	if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+		iRes = APPERR_FILEWRITE;
+	}
 	delete[] NewImage;
+	if (iRes != APP_SUCCESS) {
+		MessageBox(hDlg, L"Could not write output file", L"File I/O", MB_OK);
+		return iRes;
+	}
 
 	if (DisplayResults) {
 		DisplayImage(ImageOutputFile);
@@ -4808,6 +6148,7 @@ int PixelReorderBatch(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, int ScalePi
 	int Found = 0;
 	WCHAR InputImageFile[MAX_PATH];
 	WCHAR OutputImageFile[MAX_PATH];
+	PngBatch PngFiles;
 
 	ErrNum = _wfopen_s(&BatchFile, InputFile, L"r");
 	if (BatchFile == NULL) {
@@ -4895,7 +6236,7 @@ int PixelReorderBatch(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, int ScalePi
 				if (err == 0) {
 					err = _wmakepath_s(BMPfilename, _MAX_PATH, Drive, Dir, Fname, L".bmp");
 					if (err == 0) {
-						SaveBMP(BMPfilename, OutputImageFile, FALSE, ScalePixel);
+						SaveBMP(BMPfilename, OutputImageFile, FALSE, ScalePixel, &PngFiles);
 					}
 				}
 			}
@@ -4904,6 +6245,12 @@ int PixelReorderBatch(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, int ScalePi
 		iProcessed++;
 	}
 	fclose(BatchFile);
+
+	// the .png files of the BMP files are written by the PNG encode queue
+	iRes = WaitAutoPNG(hDlg, &PngFiles);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
 	
 	{
 		TCHAR pszMessageBuf[MAX_PATH];
@@ -4959,17 +6306,14 @@ BOOL StringBlankorComnent(WCHAR* Line,int LineSize)
 int AddSubtractKernel(HWND hDlg, WCHAR* InputFile, WCHAR* TextFile, WCHAR* OutputFile, int AddFlag)
 {
 	int iRes;
-	int* InputImage1;
 	int* Kernel;
-	int* OutputImage;
+	int* KernelRows;
 	int KernelXsize;
 	int KernelYsize;
-	errno_t ErrNum;
-	PIXEL Pixel;
-	FILE* Out;
-	IMAGINGHEADER Input1Header;
+	IMAGEBUFFER Input = { 0 };
+	IMAGEBUFFER Output = { 0 };
 
-	iRes = LoadImageFile(&InputImage1, InputFile, &Input1Header);
+	iRes = LoadImageBuffer(&Input, InputFile);
 	if (iRes != APP_SUCCESS) {
 		MessageBox(hDlg, L"Could not load first input image", L"File I/O error", MB_OK);
 		return iRes;
@@ -4977,83 +6321,57 @@ int AddSubtractKernel(HWND hDlg, WCHAR* InputFile, WCHAR* TextFile, WCHAR* Outpu
 
 	iRes = ReadIntKernelFile(hDlg, TextFile, &Kernel, &KernelXsize, &KernelYsize);
 	if (iRes != APP_SUCCESS) {
-		delete[] InputImage1;
+		FreeImageBuffer(&Input);
 		return iRes;
 	}
 
-	if ((Input1Header.Xsize % KernelXsize !=0)|| (Input1Header.Ysize % KernelYsize!=0)) {
+	int Xsize = Input.Header.Xsize;
+	int Ysize = Input.Header.Ysize;
+	if ((Xsize % KernelXsize !=0)|| (Ysize % KernelYsize!=0)) {
+		FreeImageBuffer(&Input);
+		delete[] Kernel;
 		MessageBox(hDlg, L"Input file x,y size must be divisible by kernel x,y size", L"Files incomptaible", MB_OK);
 		return APPERR_PARAMETER;
 	}
 
-	OutputImage = new int[(size_t)Input1Header.Xsize * (size_t)Input1Header.Ysize * (size_t)Input1Header.NumFrames];
-	if (OutputImage == NULL) {
-		delete[] InputImage1;
+	// each kernel row repeated across an image row, so an image row is
+	// one element-wise add/subtract
+	KernelRows = new int[(size_t)Xsize * (size_t)KernelYsize];
+	if (KernelRows == NULL) {
+		FreeImageBuffer(&Input);
 		delete[] Kernel;
 		MessageBox(hDlg, L"Could not allocate output image", L"File I/O error", MB_OK);
-		return APPERR_PARAMETER;
+		return APPERR_MEMALLOC;
 	}
-	int KernelValue;
-	int FrameOffset;
-	int Address;
-
-	for (int Frame = 0; Frame < Input1Header.NumFrames; Frame++) {
-		FrameOffset = Frame * Input1Header.Xsize * Input1Header.Ysize;
-		for (int y = 0; y < Input1Header.Ysize; ) {
-			for (int yKernel = 0; yKernel < KernelYsize; y++, yKernel++) {
-				for (int x = 0; x < Input1Header.Xsize;) {
-					for (int xKernel = 0; xKernel < KernelXsize; x++, xKernel++) {
-						KernelValue = Kernel[xKernel + yKernel * KernelXsize];
-						Address = x + y * Input1Header.Xsize;
-						if (AddFlag) {
-							OutputImage[Address] = InputImage1[Address] + KernelValue;
-						}
-						else {
-							OutputImage[Address] = InputImage1[Address] - KernelValue;
-						}
-						if (OutputImage[Address] < 0) OutputImage[Address] = 0;
-					}
-				}
-			}
+	for (int yKernel = 0; yKernel < KernelYsize; yKernel++) {
+		for (int x = 0; x < Xsize; x++) {
+			KernelRows[(size_t)yKernel * (size_t)Xsize + x] = Kernel[(x % KernelXsize) + yKernel * KernelXsize];
 		}
 	}
-	delete[] InputImage1;
 	delete[] Kernel;
 
-	ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-	if (Out == NULL) {
-		delete[] OutputImage;
-		MessageBox(hDlg, L"Could not open output file", L"File I/O", MB_OK);
-		return APPERR_FILEOPEN;
+	iRes = ReserveImageBuffer(&Output, &Input.Header);
+	if (iRes != APP_SUCCESS) {
+		FreeImageBuffer(&Input);
+		delete[] KernelRows;
+		MessageBox(hDlg, L"Could not allocate output image", L"File I/O error", MB_OK);
+		return iRes;
 	}
 
-	//write output image
-	fwrite(&Input1Header, sizeof(Input1Header), 1, Out);
+	// the frames and rows are independent of each other
+	int Operation = AddFlag ? PIXELMATH_ADD : PIXELMATH_SUBTRACT;
+	ParallelForFrames(Input.Header.NumFrames, Ysize, [&](int Frame, int StartY, int EndY) {
+		for (int y = StartY; y < EndY; y++) {
+			size_t Address = ((size_t)Frame * (size_t)Ysize + (size_t)y) * (size_t)Xsize;
 
-	// write image
-	for (int i = 0; i < (Input1Header.Xsize * Input1Header.Ysize * Input1Header.NumFrames); i++) {
-		Pixel.Long = OutputImage[i];
-		if (Input1Header.PixelSize == 1) {
-			if (Pixel.Long > 255) Pixel.Long = 255;
-			fwrite(&Pixel.Byte, 1, 1, Out);
-		}
-		else if (Input1Header.PixelSize == 2) {
-			if (Pixel.Long > 65535) Pixel.Long = 65535;
-			fwrite(&Pixel.uShort, 2, 1, Out);
-		}
-		else {
-			fwrite(&Pixel.Long, 4, 1, Out);
+			PixelMath(Operation, Input.Image + Address, KernelRows + (size_t)(y % KernelYsize) * (size_t)Xsize,
+				Output.Image + Address, (size_t)Xsize, INT_MAX);
 		}
-	}
+	});
+	FreeImageBuffer(&Input);
+	delete[] KernelRows;
 
-	delete[] OutputImage;
-	fclose(Out);
-	
-	if (DisplayResults) {
-		DisplayImage(OutputFile);
-	}
-	
-	return APP_SUCCESS;
+	return WriteTransformResult(hDlg, OutputFile, &Output);
 }
 
 //*******************************************************************************
@@ -5240,8 +6558,8 @@ int BlockReorder(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, WCHAR* OutputFil
 	int NumKernels;
 	int NumXblocks;
 	int NumYblocks;
+	PngBatch PngFiles;
 
-	PIXEL Pixel;
 	errno_t ErrNum;
 
 	// read input image file
@@ -5326,6 +6644,16 @@ int BlockReorder(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, WCHAR* OutputFil
 		WCHAR BMPfilename[MAX_PATH];
 		WCHAR NewFilename[MAX_PATH];
 
+		JobProgress(Kernel, NumKernels);
+		if (JobCancelled()) {
+			delete[] DecomY;
+			delete[] DecomX;
+			delete[] InputImage;
+			delete[] DecomAddress;
+			delete[] OutputImage;
+			return APPERR_CANCELLED;
+		}
+
 		KernelOffset = Kernel * DecomXsize * DecomYsize;
 
 		// calculate decom address table
@@ -5428,28 +6756,28 @@ int BlockReorder(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, WCHAR* OutputFil
 		}
 
 		// write imgheader record out, no parameters in the header have changed
-
-		fwrite(&ImgHeader, sizeof(ImgHeader), 1, Out);
-
-		// write image
-		for (int i = 0; i < (FrameSize * ImgHeader.NumFrames); i++) {
-			Pixel.Long = OutputImage[i];
-			if (ImgHeader.PixelSize == 1) {
-				if (Pixel.Long > 255) Pixel.Long = 255;
-				fwrite(&Pixel.Byte, 1, 1, Out);
-			}
-			else if (ImgHeader.PixelSize == 2) {
-				if (Pixel.Long > 65535) Pixel.Long = 65535;
-				fwrite(&Pixel.uShort, 2, 1, Out);
-			}
-			else {
-				fwrite(&Pixel.Long, 4, 1, Out);
-			}
+		iRes = APPERR_FILEWRITE;
+		if (fwrite(&ImgHeader, sizeof(ImgHeader), 1, Out) == 1) {
+			// write image
+			iRes = WriteImagePixels(Out, OutputImage,
+				FrameSize * (size_t)ImgHeader.NumFrames,
+				ImgHeader.PixelSize, ImgHeader.Endian);
+		}
+		if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+			iRes = APPERR_FILEWRITE;
+		}
+		if (iRes != APP_SUCCESS) {
+			delete[] DecomY;
+			delete[] DecomX;
+			delete[] InputImage;
+			delete[] DecomAddress;
+			delete[] OutputImage;
+			MessageBox(hDlg, L"Could not write output file", L"File I/O", MB_OK);
+			return iRes;
 		}
-		fclose(Out);
 
 		if (EnableBatch && GenerateBMP) {
-			SaveBMP(BMPfilename, NewFilename, FALSE, TRUE);
+			SaveBMP(BMPfilename, NewFilename, FALSE, TRUE, &PngFiles);
 		}
 
 	}
@@ -5459,6 +6787,14 @@ int BlockReorder(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, WCHAR* OutputFil
 	delete[] DecomAddress;
 	delete[] OutputImage;
 
+	// the .png files of the BMP files are written by the PNG encode queue
+	if (EnableBatch && GenerateBMP) {
+		iRes = WaitAutoPNG(hDlg, &PngFiles);
+		if (iRes != APP_SUCCESS) {
+			return iRes;
+		}
+	}
+
 	if (DisplayResults && !EnableBatch) {
 		DisplayImage(OutputFile);
 	}
@@ -53,6 +53,13 @@
 // V1.3.1.1 2023-12-28  Replaced application error numbers with #define to improve clarity
 //                      Changed batch processing to display results for each step in processing
 //                      Added offset x,y loc values to ExtractImage dialog the same as BatchExtractImage
+// V1.3.2.1 2026-10-14  Added, Run transform pipeline dialog
+//                      Changed, Reorder, Reorder blocks and Extract symbols are queued as background
+//                      jobs, the dialog stays open so more can be queued
+//                      Added, Extract symbols, symbol size report for a range of symbol sizes
+//                      Added, Pixel math dialog, min, max, AND, OR, XOR, threshold of 2 images
+//                      or an image and a constant
+//                      Correction, Batch extract image reports AutoPNG .png file write errors
 // 
 // Imaging tools dialog box handlers
 // 
@@ -79,6 +86,10 @@
 #include "AppFunctions.h"
 #include "Imaging.h"
 #include "FileFunctions.h"
+#include "Pipeline.h"
+#include "PixelMath.h"
+#include "JobRunner.h"
+#include "PngWriter.h"
 #include "shellapi.h"
 
 // Add new callback prototype declarations in my MySETIapp.cpp
@@ -893,8 +904,11 @@ INT_PTR CALLBACK ReorderImageDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM
                 }
             }
 
-            PixelReorder(hDlg, TextInput, InputFile, OutputFile, ScalePixel, FALSE, EnableBatch,
+            // run on the job thread, the parameters are copied into the job
+            QueueJob(L"Reorder pixels", [=]() mutable {
+                return PixelReorder(NULL, TextInput, InputFile, OutputFile, ScalePixel, FALSE, EnableBatch,
                             GenerateBMP, Invert);
+            });
             wcscpy_s(szCurrentFilename, OutputFile);
             return (INT_PTR)TRUE;
         }
@@ -1159,8 +1173,11 @@ INT_PTR CALLBACK ReorderBlocksImageDlg(HWND hDlg, UINT message, WPARAM wParam, L
                 }
             }
 
-            BlockReorder(hDlg, TextInput, InputFile, OutputFile, ScalePixel, FALSE, EnableBatch,
-                GenerateBMP, Xsize, Ysize, PixelSize, Invert);
+            // run on the job thread, the parameters are copied into the job
+            QueueJob(L"Reorder blocks", [=]() mutable {
+                return BlockReorder(NULL, TextInput, InputFile, OutputFile, ScalePixel, FALSE, EnableBatch,
+                    GenerateBMP, Xsize, Ysize, PixelSize, Invert);
+            });
             wcscpy_s(szCurrentFilename, OutputFile);
             return (INT_PTR)TRUE;
         }
@@ -3860,6 +3877,278 @@ INT_PTR CALLBACK MathConstantDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM
     return (INT_PTR)FALSE;
 }
 
+//*******************************************************************************
+//
+// Message handler for ImageMathDlg dialog box.
+// 
+// The operation radio buttons IDC_MATH_ADD ... IDC_MATH_SUBTRACT are in the
+// same order as the PIXELMATH_ operation codes
+// 
+//*******************************************************************************
+INT_PTR CALLBACK ImageMathDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    UNREFERENCED_PARAMETER(lParam);
+    switch (message)
+    {
+        WCHAR szString[MAX_PATH];
+
+    case WM_INITDIALOG:
+    {
+        IMAGINGHEADER ImageHeader;
+        int Operation;
+        int UseConstant;
+        int Warn;
+
+        GetPrivateProfileString(L"ImageMathDlg", L"ImageInput", L"Message.raw", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_IMAGE_INPUT, szString);
+        if (ReadImageHeader(szString, &ImageHeader) == 1) {
+            SetDlgItemInt(hDlg, IDC_XSIZEI, ImageHeader.Xsize, TRUE);
+            SetDlgItemInt(hDlg, IDC_YSIZEI, ImageHeader.Ysize, TRUE);
+            SetDlgItemInt(hDlg, IDC_NUM_FRAMES, ImageHeader.NumFrames, TRUE);
+        }
+        else {
+            SetDlgItemInt(hDlg, IDC_XSIZEI, 0, TRUE);
+            SetDlgItemInt(hDlg, IDC_YSIZEI, 0, TRUE);
+            SetDlgItemInt(hDlg, IDC_NUM_FRAMES, 0, TRUE);
+        }
+
+        GetPrivateProfileString(L"ImageMathDlg", L"ImageInput2", L"Message.raw", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_IMAGE_INPUT2, szString);
+        if (ReadImageHeader(szString, &ImageHeader) == 1) {
+            SetDlgItemInt(hDlg, IDC_XSIZEI2, ImageHeader.Xsize, TRUE);
+            SetDlgItemInt(hDlg, IDC_YSIZEI2, ImageHeader.Ysize, TRUE);
+            SetDlgItemInt(hDlg, IDC_NUM_FRAMES2, ImageHeader.NumFrames, TRUE);
+        }
+        else {
+            SetDlgItemInt(hDlg, IDC_XSIZEI2, 0, TRUE);
+            SetDlgItemInt(hDlg, IDC_YSIZEI2, 0, TRUE);
+            SetDlgItemInt(hDlg, IDC_NUM_FRAMES2, 0, TRUE);
+        }
+
+        GetPrivateProfileString(L"ImageMathDlg", L"ImageOutput", L"Result.raw", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString);
+
+        GetPrivateProfileString(L"ImageMathDlg", L"Value", L"1", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_VALUE, szString);
+
+        Operation = GetPrivateProfileInt(L"ImageMathDlg", L"Operation", PIXELMATH_AND, (LPCTSTR)strAppNameINI);
+        if (Operation < 0 || Operation >= PIXELMATH_NUMOPS) {
+            Operation = PIXELMATH_AND;
+        }
+        CheckRadioButton(hDlg, IDC_MATH_ADD, IDC_MATH_SUBTRACT, IDC_MATH_ADD + Operation);
+
+        UseConstant = GetPrivateProfileInt(L"ImageMathDlg", L"UseConstant", 0, (LPCTSTR)strAppNameINI);
+        if (!UseConstant) {
+            CheckDlgButton(hDlg, IDC_MATH_USE_CONSTANT, BST_UNCHECKED);
+        }
+        else {
+            CheckDlgButton(hDlg, IDC_MATH_USE_CONSTANT, BST_CHECKED);
+        }
+
+        Warn = GetPrivateProfileInt(L"ImageMathDlg", L"Warn", 1, (LPCTSTR)strAppNameINI);
+        if (!Warn) {
+            CheckDlgButton(hDlg, IDC_WARN, BST_UNCHECKED);
+        }
+        else {
+            CheckDlgButton(hDlg, IDC_WARN, BST_CHECKED);
+        }
+        return (INT_PTR)TRUE;
+    }
+
+    case WM_COMMAND:
+        switch (LOWORD(wParam)) {
+        case IDC_IMAGE_INPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            IMAGINGHEADER ImageHeader;
+
+            GetDlgItemText(hDlg, IDC_IMAGE_INPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC rawType[] =
+            {
+                 { L"Image files", L"*.raw" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileOpen(hDlg, szString, &pszFilename, FALSE, 2, rawType, L"*.raw")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_IMAGE_INPUT, szString);
+
+            if (ReadImageHeader(szString, &ImageHeader) == 1) {
+                SetDlgItemInt(hDlg, IDC_XSIZEI, ImageHeader.Xsize, TRUE);
+                SetDlgItemInt(hDlg, IDC_YSIZEI, ImageHeader.Ysize, TRUE);
+                SetDlgItemInt(hDlg, IDC_NUM_FRAMES, ImageHeader.NumFrames, TRUE);
+            }
+            else {
+                SetDlgItemInt(hDlg, IDC_XSIZEI, 0, TRUE);
+                SetDlgItemInt(hDlg, IDC_YSIZEI, 0, TRUE);
+                SetDlgItemInt(hDlg, IDC_NUM_FRAMES, 0, TRUE);
+                MessageBox(hDlg, L"Selected file is not an image file", L"File incompatible", MB_OK);
+            }
+
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_IMAGE_INPUT_BROWSE2:
+        {
+            PWSTR pszFilename;
+            IMAGINGHEADER ImageHeader;
+
+            GetDlgItemText(hDlg, IDC_IMAGE_INPUT2, szString, MAX_PATH);
+            COMDLG_FILTERSPEC rawType[] =
+            {
+                 { L"Image files", L"*.raw" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileOpen(hDlg, szString, &pszFilename, FALSE, 2, rawType, L"*.raw")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_IMAGE_INPUT2, szString);
+
+            if (ReadImageHeader(szString, &ImageHeader) == 1) {
+                SetDlgItemInt(hDlg, IDC_XSIZEI2, ImageHeader.Xsize, TRUE);
+                SetDlgItemInt(hDlg, IDC_YSIZEI2, ImageHeader.Ysize, TRUE);
+                SetDlgItemInt(hDlg, IDC_NUM_FRAMES2, ImageHeader.NumFrames, TRUE);
+            }
+            else {
+                SetDlgItemInt(hDlg, IDC_XSIZEI2, 0, TRUE);
+                SetDlgItemInt(hDlg, IDC_YSIZEI2, 0, TRUE);
+                SetDlgItemInt(hDlg, IDC_NUM_FRAMES2, 0, TRUE);
+                MessageBox(hDlg, L"Selected file is not an image file", L"File incompatible", MB_OK);
+            }
+
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_IMAGE_OUTPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+
+            GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC rawType[] =
+            {
+                 { L"Image files", L"*.raw" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileSave(hDlg, szString, &pszFilename, FALSE, 2, rawType, L"*.raw")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString);
+
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_PERFORM:
+        {
+            BOOL bSuccess;
+            WCHAR InputFile[MAX_PATH];
+            WCHAR InputFile2[MAX_PATH];
+            WCHAR OutputFile[MAX_PATH];
+            int Value;
+            int Operation = PIXELMATH_ADD;
+            int Warn = 0;
+            int iRes;
+            int ArithmeticFlag = 0;
+
+            GetDlgItemText(hDlg, IDC_IMAGE_INPUT, InputFile, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_IMAGE_INPUT2, InputFile2, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, OutputFile, MAX_PATH);
+            Value = GetDlgItemInt(hDlg, IDC_VALUE, &bSuccess, TRUE);
+
+            for (int Id = IDC_MATH_ADD; Id <= IDC_MATH_SUBTRACT; Id++) {
+                if (IsDlgButtonChecked(hDlg, Id)) {
+                    Operation = Id - IDC_MATH_ADD;
+                }
+            }
+
+            if (IsDlgButtonChecked(hDlg, IDC_WARN)) {
+                Warn = 1;
+            }
+
+            if (IsDlgButtonChecked(hDlg, IDC_MATH_USE_CONSTANT)) {
+                if (Operation == PIXELMATH_DIVIDE && Value <= 0) {
+                    MessageBox(hDlg, L"Value must be >=1 for division operation", L"Bad math", MB_OK);
+                    return (INT_PTR)TRUE;
+                }
+                iRes = MathConstant2Image(InputFile, OutputFile, Value, Operation, Warn, &ArithmeticFlag);
+                if (iRes != APP_SUCCESS) {
+                    MessageMySETIappError(hDlg, iRes, L"pixel math operation");
+                    return (INT_PTR)TRUE;
+                }
+            }
+            else {
+                // ImageMath reports its own errors
+                iRes = ImageMath(hDlg, InputFile, InputFile2, OutputFile, Operation, &ArithmeticFlag);
+                if (iRes != APP_SUCCESS) {
+                    return (INT_PTR)TRUE;
+                }
+            }
+            if (Warn && ArithmeticFlag) {
+                MessageBox(hDlg, L"Overflow or underflow occured on at least one pixel", L"Arithmetic warning", MB_OK);
+            }
+
+            wcscpy_s(szCurrentFilename, OutputFile);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDOK:
+        {
+            GetDlgItemText(hDlg, IDC_IMAGE_INPUT, szString, MAX_PATH);
+            WritePrivateProfileString(L"ImageMathDlg", L"ImageInput", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_IMAGE_INPUT2, szString, MAX_PATH);
+            WritePrivateProfileString(L"ImageMathDlg", L"ImageInput2", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString, MAX_PATH);
+            WritePrivateProfileString(L"ImageMathDlg", L"ImageOutput", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_VALUE, szString, MAX_PATH);
+            WritePrivateProfileString(L"ImageMathDlg", L"Value", szString, (LPCTSTR)strAppNameINI);
+
+            for (int Id = IDC_MATH_ADD; Id <= IDC_MATH_SUBTRACT; Id++) {
+                if (IsDlgButtonChecked(hDlg, Id)) {
+                    swprintf_s(szString, MAX_PATH, L"%d", Id - IDC_MATH_ADD);
+                    WritePrivateProfileString(L"ImageMathDlg", L"Operation", szString, (LPCTSTR)strAppNameINI);
+                }
+            }
+
+            if (IsDlgButtonChecked(hDlg, IDC_MATH_USE_CONSTANT)) {
+                WritePrivateProfileString(L"ImageMathDlg", L"UseConstant", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"ImageMathDlg", L"UseConstant", L"0", (LPCTSTR)strAppNameINI);
+            }
+
+            if (IsDlgButtonChecked(hDlg, IDC_WARN)) {
+                WritePrivateProfileString(L"ImageMathDlg", L"Warn", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"ImageMathDlg", L"Warn", L"0", (LPCTSTR)strAppNameINI);
+            }
+
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+        }
+
+        case IDCANCEL:
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+        }
+    }
+    return (INT_PTR)FALSE;
+}
+
 //*******************************************************************************
 //
 // Message handler for ExtractPacketsDlg dialog box.
@@ -3901,6 +4190,12 @@ INT_PTR CALLBACK ExtractSymbolsDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
         GetPrivateProfileString(L"ExtractSymbolsDlg", L"ysizesymbol", L"1", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
         SetDlgItemText(hDlg, IDC_YSIZE_SYMBOL, szString);
 
+        GetPrivateProfileString(L"ExtractSymbolsDlg", L"xsizesymbolMax", L"8", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_XSIZE_SYMBOL_MAX, szString);
+
+        GetPrivateProfileString(L"ExtractSymbolsDlg", L"ysizesymbolMax", L"8", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_YSIZE_SYMBOL_MAX, szString);
+
         int Approach = GetPrivateProfileInt(L"ExtractSymbolsDlg", L"Approach", 1, (LPCTSTR)strAppNameINI);
         if (Approach == 1) {
             CheckRadioButton(hDlg, IDC_1D, IDC_2D, IDC_1D);
@@ -4011,11 +4306,61 @@ INT_PTR CALLBACK ExtractSymbolsDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
                 Highlight = 1;
             }
             
-            ExtractSymbols(hDlg, InputFile, OutputFile, SkipBits, xsizesymbol, ysizesymbol,Approach, Highlight);
+            // run on the job thread, the parameters are copied into the job
+            QueueJob(L"Extract symbols", [=]() mutable {
+                return ExtractSymbols(NULL, InputFile, OutputFile, SkipBits, xsizesymbol, ysizesymbol, Approach, Highlight);
+            });
             wcscpy_s(szCurrentFilename, OutputFile);
             return (INT_PTR)TRUE;
         }
 
+        case IDC_EXTRACT_MULTI:
+        {
+            // symbol size report, the results image file with a .csv extension
+            BOOL bSuccess;
+            WCHAR InputFile[MAX_PATH];
+            WCHAR OutputFile[MAX_PATH];
+            WCHAR ReportFile[MAX_PATH];
+            WCHAR Drive[_MAX_DRIVE];
+            WCHAR Dir[_MAX_DIR];
+            WCHAR Fname[_MAX_FNAME];
+            WCHAR Ext[_MAX_EXT];
+            int SkipBits;
+            int xsizesymbol;
+            int ysizesymbol;
+            int xsizesymbolMax;
+            int ysizesymbolMax;
+            int Approach;
+
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, InputFile, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, OutputFile, MAX_PATH);
+
+            if (_wsplitpath_s(OutputFile, Drive, _MAX_DRIVE, Dir, _MAX_DIR, Fname, _MAX_FNAME, Ext, _MAX_EXT) != 0 ||
+                _wmakepath_s(ReportFile, MAX_PATH, Drive, Dir, Fname, L".csv") != 0) {
+                MessageBox(hDlg, L"Could not create report filename", L"File I/O", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+
+            SkipBits = GetDlgItemInt(hDlg, IDC_SKIP_BITS, &bSuccess, TRUE);
+            xsizesymbol = GetDlgItemInt(hDlg, IDC_XSIZE_SYMBOL, &bSuccess, TRUE);
+            ysizesymbol = GetDlgItemInt(hDlg, IDC_YSIZE_SYMBOL, &bSuccess, TRUE);
+            xsizesymbolMax = GetDlgItemInt(hDlg, IDC_XSIZE_SYMBOL_MAX, &bSuccess, TRUE);
+            ysizesymbolMax = GetDlgItemInt(hDlg, IDC_YSIZE_SYMBOL_MAX, &bSuccess, TRUE);
+
+            if (IsDlgButtonChecked(hDlg, IDC_1D)) {
+                Approach = 1;
+            }
+            else {
+                Approach = 2;
+            }
+
+            QueueJob(L"Symbol size report", [=]() mutable {
+                return ExtractSymbolsMultiSize(NULL, InputFile, ReportFile, SkipBits, xsizesymbol, ysizesymbol,
+                    xsizesymbolMax, ysizesymbolMax, Approach);
+            });
+            return (INT_PTR)TRUE;
+        }
+
         case IDOK:
             GetDlgItemText(hDlg, IDC_BINARY_INPUT, szString, MAX_PATH);
             WritePrivateProfileString(L"ExtractSymbolsDlg", L"BinaryInput", szString, (LPCTSTR)strAppNameINI);
@@ -4032,6 +4377,12 @@ INT_PTR CALLBACK ExtractSymbolsDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
             GetDlgItemText(hDlg, IDC_YSIZE_SYMBOL, szString, MAX_PATH);
             WritePrivateProfileString(L"ExtractSymbolsDlg", L"ysizesymbol", szString, (LPCTSTR)strAppNameINI);
 
+            GetDlgItemText(hDlg, IDC_XSIZE_SYMBOL_MAX, szString, MAX_PATH);
+            WritePrivateProfileString(L"ExtractSymbolsDlg", L"xsizesymbolMax", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_YSIZE_SYMBOL_MAX, szString, MAX_PATH);
+            WritePrivateProfileString(L"ExtractSymbolsDlg", L"ysizesymbolMax", szString, (LPCTSTR)strAppNameINI);
+
             if (IsDlgButtonChecked(hDlg, IDC_1D)) {
                 WritePrivateProfileString(L"ExtractSymbolsDlg", L"Approach", L"1", (LPCTSTR)strAppNameINI);
             }
@@ -5033,6 +5384,7 @@ INT_PTR CALLBACK BatchExtractImageDlg(HWND hDlg, UINT message, WPARAM wParam, LP
             int EndFrame = 0;
             int GenerateBMP = 0;
             int GenerateFileList = 0;
+            PngBatch PngFiles;
 
             GetDlgItemText(hDlg, IDC_IMAGE_INPUT, InputFile, MAX_PATH);
             GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, OutputFile, MAX_PATH);
@@ -5177,7 +5529,7 @@ INT_PTR CALLBACK BatchExtractImageDlg(HWND hDlg, UINT message, WPARAM wParam, LP
                             MessageBox(hDlg, L"Could not creat output bmp filename", L"Batch filename", MB_OK);
                             return APPERR_FILEOPEN;
                         }
-                        SaveBMP(BMPfilename, NewFilename, DefaultRBG, AutoScaleResults);
+                        SaveBMP(BMPfilename, NewFilename, DefaultRBG, AutoScaleResults, &PngFiles);
 
 
                     }
@@ -5190,6 +5542,10 @@ INT_PTR CALLBACK BatchExtractImageDlg(HWND hDlg, UINT message, WPARAM wParam, LP
             if (BatchFileList != NULL) {
                 fclose(BatchFileList);
             }
+            // the .png files of the BMP files are written by the PNG encode queue
+            if (GenerateBMP == 1 && WaitAutoPNG(hDlg, &PngFiles) != APP_SUCCESS) {
+                return (INT_PTR)TRUE;
+            }
             MessageBox(hDlg, L"Completed", L"Success",MB_OK);
 
             return (INT_PTR)TRUE;
@@ -5278,3 +5634,157 @@ INT_PTR CALLBACK BatchExtractImageDlg(HWND hDlg, UINT message, WPARAM wParam, LP
     }
     return (INT_PTR)FALSE;
 }
+
+//*******************************************************************************
+//
+// Message handler for PipelineDlg dialog box.
+// 
+//*******************************************************************************
+INT_PTR CALLBACK PipelineDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    UNREFERENCED_PARAMETER(lParam);
+    switch (message)
+    {
+        WCHAR szString[MAX_PATH];
+
+
+    case WM_INITDIALOG:
+    {
+        IMAGINGHEADER ImageHeader;
+
+        GetPrivateProfileString(L"PipelineDlg", L"ImageInput", L"Message.raw", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_IMAGE_INPUT, szString);
+        if (ReadImageHeader(szString, &ImageHeader) == 1) {
+            SetDlgItemInt(hDlg, IDC_XSIZEI, ImageHeader.Xsize, TRUE);
+            SetDlgItemInt(hDlg, IDC_YSIZEI, ImageHeader.Ysize, TRUE);
+            SetDlgItemInt(hDlg, IDC_NUM_FRAMES, ImageHeader.NumFrames, TRUE);
+        }
+        else {
+            SetDlgItemInt(hDlg, IDC_XSIZEI, 0, TRUE);
+            SetDlgItemInt(hDlg, IDC_YSIZEI, 0, TRUE);
+            SetDlgItemInt(hDlg, IDC_NUM_FRAMES, 0, TRUE);
+        }
+
+        GetPrivateProfileString(L"PipelineDlg", L"PipelineFile", L"Pipeline\\Pipeline.txt", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_TEXT_INPUT, szString);
+
+        GetPrivateProfileString(L"PipelineDlg", L"ImageOutput", L"Pipeline.raw", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString);
+
+        return (INT_PTR)TRUE;
+    }
+
+    case WM_COMMAND:
+        switch (LOWORD(wParam)) {
+        case IDC_IMAGE_INPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            IMAGINGHEADER ImageHeader;
+
+            GetDlgItemText(hDlg, IDC_IMAGE_INPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC rawType[] =
+            {
+                 { L"text files", L"*.raw" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileOpen(hDlg, szString, &pszFilename, FALSE, 2, rawType, L"*.raw")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_IMAGE_INPUT, szString);
+
+            if (ReadImageHeader(szString, &ImageHeader) == 1) {
+                SetDlgItemInt(hDlg, IDC_XSIZEI, ImageHeader.Xsize, TRUE);
+                SetDlgItemInt(hDlg, IDC_YSIZEI, ImageHeader.Ysize, TRUE);
+                SetDlgItemInt(hDlg, IDC_NUM_FRAMES, ImageHeader.NumFrames, TRUE);
+            }
+            else {
+                SetDlgItemInt(hDlg, IDC_XSIZEI, 0, TRUE);
+                SetDlgItemInt(hDlg, IDC_YSIZEI, 0, TRUE);
+                SetDlgItemInt(hDlg, IDC_NUM_FRAMES, 0, TRUE);
+                MessageBox(hDlg, L"Selected file is not an image file", L"File incompatible", MB_OK);
+            }
+
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_TEXT_INPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_TEXT_INPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC textType[] =
+            {
+                 { L"text files", L"*.txt" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileOpen(hDlg, szString, &pszFilename, FALSE, 2, textType, L"*.txt")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_TEXT_INPUT, szString);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_IMAGE_OUTPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC rawType[] =
+            {
+                 { L"text files", L"*.raw" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileSave(hDlg, szString, &pszFilename, FALSE, 2, rawType, L"*.raw")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_RUN_PIPELINE:
+        {
+            WCHAR InputFile[MAX_PATH];
+            WCHAR TextInput[MAX_PATH];
+            WCHAR OutputFile[MAX_PATH];
+
+
+            GetDlgItemText(hDlg, IDC_IMAGE_INPUT, InputFile, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_TEXT_INPUT, TextInput, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, OutputFile, MAX_PATH);
+            
+            if (RunPipeline(hDlg, TextInput, InputFile, OutputFile) == APP_SUCCESS) {
+                wcscpy_s(szCurrentFilename, OutputFile);
+            }
+            return (INT_PTR)TRUE;
+        }
+
+        case IDOK:
+            GetDlgItemText(hDlg, IDC_IMAGE_INPUT, szString, MAX_PATH);
+            WritePrivateProfileString(L"PipelineDlg", L"ImageInput", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_TEXT_INPUT, szString, MAX_PATH);
+            WritePrivateProfileString(L"PipelineDlg", L"PipelineFile", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString, MAX_PATH);
+            WritePrivateProfileString(L"PipelineDlg", L"ImageOutput", szString, (LPCTSTR)strAppNameINI);
+
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+
+        case IDCANCEL:
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+        }
+    }
+    return (INT_PTR)FALSE;
+}
@@ -0,0 +1,216 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// IntegralImage.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Summed area table (integral image) of one image frame
+//
+// Entry (x,y) of the table is the sum of all the pixels above and to the
+// left of pixel (x,y) of the frame.  The table has an extra row and column
+// of 0 at the top and left so that the sum of any rectangle in the frame is
+// 4 table lookups (SummedAreaTable::Sum), no matter how large the rectangle is.
+// The sums are 64 bit so they do not overflow for any frame size.
+//
+// Build() makes the table of the pixel values, used for block sums and means
+// (StdDecimateImageBuffer).  BuildCount() makes the table of the number of
+// pixels that are not the null value, a rectangle is all null when its count
+// is 0.
+//
+// Building the table is one pass over the frame, split into row bands and
+// then column bands on the worker threads.  The table is kept between
+// frames and is only reallocated when a larger frame is built.
+//
+// V1.3.2.1 2026-10-14  Initial release
+//
+#include "framework.h"
+#include "AppErrors.h"
+#include "Parallel.h"
+#include "IntegralImage.h"
+
+//*****************************************************************************************
+//
+//	SummedAreaTable::Build
+//
+//	Build the table of the pixel values of a frame
+//
+// Parameters:
+//	const PIXELTYPE* Image	first pixel of the frame
+//	int FrameXsize			x size of the frame
+//	int FrameYsize			y size of the frame
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+int SummedAreaTable::Build(const PIXELTYPE* Image, int FrameXsize, int FrameYsize)
+{
+	int iRes;
+
+	iRes = Reserve(FrameXsize, FrameYsize);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	// running sum along each row, the rows are independent of each other
+	ParallelFor(0, Ysize, [&](int StartRow, int EndRow) {
+		size_t Stride = (size_t)Xsize + 1;
+		for (int y = StartRow; y < EndRow; y++) {
+			const PIXELTYPE* Row = &Image[(size_t)y * (size_t)Xsize];
+			LONGLONG* TableRow = &Table[((size_t)y + 1) * Stride];
+			LONGLONG RowSum = 0;
+
+			TableRow[0] = 0;
+			for (int x = 0; x < Xsize; x++) {
+				RowSum += (LONGLONG)Row[x];
+				TableRow[x + 1] = RowSum;
+			}
+		}
+	});
+
+	Accumulate();
+	return APP_SUCCESS;
+}
+
+template int SummedAreaTable::Build(const int* Image, int FrameXsize, int FrameYsize);
+template int SummedAreaTable::Build(const BYTE* Image, int FrameXsize, int FrameYsize);
+template int SummedAreaTable::Build(const USHORT* Image, int FrameXsize, int FrameYsize);
+
+//*****************************************************************************************
+//
+//	SummedAreaTable::BuildCount
+//
+//	Build the table of the number of pixels in a frame that are not the null value
+//
+// Parameters:
+//	const PIXELTYPE* Image	first pixel of the frame
+//	int FrameXsize			x size of the frame
+//	int FrameYsize			y size of the frame
+//	int NullValue			pixel value that is not counted
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+int SummedAreaTable::BuildCount(const PIXELTYPE* Image, int FrameXsize, int FrameYsize, int NullValue)
+{
+	int iRes;
+
+	iRes = Reserve(FrameXsize, FrameYsize);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	ParallelFor(0, Ysize, [&](int StartRow, int EndRow) {
+		size_t Stride = (size_t)Xsize + 1;
+		for (int y = StartRow; y < EndRow; y++) {
+			const PIXELTYPE* Row = &Image[(size_t)y * (size_t)Xsize];
+			LONGLONG* TableRow = &Table[((size_t)y + 1) * Stride];
+			LONGLONG RowCount = 0;
+
+			TableRow[0] = 0;
+			for (int x = 0; x < Xsize; x++) {
+				RowCount += (int)Row[x] != NullValue ? 1 : 0;
+				TableRow[x + 1] = RowCount;
+			}
+		}
+	});
+
+	Accumulate();
+	return APP_SUCCESS;
+}
+
+template int SummedAreaTable::BuildCount(const int* Image, int FrameXsize, int FrameYsize, int NullValue);
+template int SummedAreaTable::BuildCount(const BYTE* Image, int FrameXsize, int FrameYsize, int NullValue);
+template int SummedAreaTable::BuildCount(const USHORT* Image, int FrameXsize, int FrameYsize, int NullValue);
+
+//*****************************************************************************************
+//
+//	SummedAreaTable::Release
+//
+//	Free the table
+//
+//*****************************************************************************************
+void SummedAreaTable::Release(void)
+{
+	if (Table != NULL) {
+		delete[] Table;
+	}
+	Table = NULL;
+	TableSize = 0;
+	Xsize = 0;
+	Ysize = 0;
+}
+
+//*****************************************************************************************
+//
+//	SummedAreaTable::Reserve
+//
+//	Private function, make sure the table is large enough for the frame size
+//	and clear the top row
+//
+//*****************************************************************************************
+int SummedAreaTable::Reserve(int NewXsize, int NewYsize)
+{
+	size_t NewSize;
+
+	if (NewXsize <= 0 || NewYsize <= 0) {
+		return APPERR_PARAMETER;
+	}
+
+	NewSize = ((size_t)NewXsize + 1) * ((size_t)NewYsize + 1);
+	if (NewSize > TableSize) {
+		Release();
+		Table = new LONGLONG[NewSize];
+		if (Table == NULL) {
+			return APPERR_MEMALLOC;
+		}
+		TableSize = NewSize;
+	}
+	Xsize = NewXsize;
+	Ysize = NewYsize;
+
+	for (int x = 0; x <= Xsize; x++) {
+		Table[x] = 0;
+	}
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	SummedAreaTable::Accumulate
+//
+//	Private function, add each row of running row sums to the row above it,
+//	the columns are independent of each other so this is split into
+//	column bands.  Each band walks down the rows so the reads stay in order.
+//
+//*****************************************************************************************
+void SummedAreaTable::Accumulate(void)
+{
+	ParallelFor(1, Xsize + 1, [&](int StartColumn, int EndColumn) {
+		size_t Stride = (size_t)Xsize + 1;
+		for (int y = 1; y <= Ysize; y++) {
+			const LONGLONG* Above = &Table[((size_t)y - 1) * Stride];
+			LONGLONG* TableRow = &Table[(size_t)y * Stride];
+			for (int x = StartColumn; x < EndColumn; x++) {
+				TableRow[x] += Above[x];
+			}
+		}
+	});
+}
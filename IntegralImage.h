@@ -0,0 +1,57 @@
+#pragma once
+//
+// IntegralImage.h
+// class definition for the summed area table in IntegralImage.cpp
+//
+
+class SummedAreaTable
+{
+private:
+	LONGLONG* Table = NULL;				// (Xsize+1) x (Ysize+1), first row and column are 0
+	size_t TableSize = 0;				// # of entries allocated in Table
+	int Xsize = 0;						// x size of the frame the table was built from
+	int Ysize = 0;						// y size of the frame the table was built from
+
+	int Reserve(int NewXsize, int NewYsize);
+	void Accumulate(void);
+
+public:
+	SummedAreaTable() {
+	};
+
+	~SummedAreaTable() {
+		Release();
+	};
+
+	template <typename PIXELTYPE> int Build(const PIXELTYPE* Image, int FrameXsize, int FrameYsize);
+	template <typename PIXELTYPE> int BuildCount(const PIXELTYPE* Image, int FrameXsize, int FrameYsize, int NullValue);
+	void Release(void);
+
+	int GetXsize(void) {
+		return Xsize;
+	};
+
+	int GetYsize(void) {
+		return Ysize;
+	};
+
+	// sum of the rectangle x..x+RectXsize-1, y..y+RectYsize-1
+	// the rectangle must be inside the frame
+	LONGLONG Sum(int x, int y, int RectXsize, int RectYsize) {
+		size_t Stride = (size_t)Xsize + 1;
+		size_t Top = (size_t)y * Stride;
+		size_t Bottom = ((size_t)y + (size_t)RectYsize) * Stride;
+		size_t Right = (size_t)x + (size_t)RectXsize;
+
+		return Table[Bottom + Right] - Table[Top + Right] - Table[Bottom + x] + Table[Top + x];
+	};
+
+	double Mean(int x, int y, int RectXsize, int RectYsize) {
+		return (double)Sum(x, y, RectXsize, RectYsize) / ((double)RectXsize * (double)RectYsize);
+	};
+
+	// for a table from BuildCount(), TRUE if every pixel in the rectangle is the null value
+	BOOL AllNull(int x, int y, int RectXsize, int RectYsize) {
+		return Sum(x, y, RectXsize, RectYsize) == 0;
+	};
+};
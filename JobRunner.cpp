@@ -0,0 +1,484 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// JobRunner.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Background job runner
+//
+// Long operations (extract symbols, reorder by blocks, batch reordering,
+// batch bitstream to image,...) are queued by their dialogs with QueueJob()
+// instead of being run in the dialog's WM_COMMAND handler.  The jobs are run
+// one at a time, in the order they were queued, on a single job thread so the
+// application windows stay responsive and more jobs can be lined up while one
+// is running.
+//
+// While a job is running its inner loops call:
+//	JobProgress(Done, Total)	units done (frames, kernels, symbols, x sizes,...)
+//	JobCancelled()				TRUE when the user cancelled the running job, the
+//								function cleans up and returns APPERR_CANCELLED
+//
+// Progress is posted to the main window (WM_JOB_STATUS) which updates the
+// modeless 'Jobs' progress window.  The progress window has the Cancel
+// (running job) and Cancel all (running job and queue) buttons.
+//
+// A job is called with hDlg = NULL.  Error message boxes are owned by the
+// desktop and the progress text a function would put in its dialog caption
+// is not shown.  Displaying results is done on the UI thread, DisplayImage()
+// and DisplayImageFrame() use RunOnUIThread() when they are called by a job.
+//
+// V1.3.2.1 2026-10-14  Initial release, background job runner with progress and cancel
+//
+#include "framework.h"
+#include "resource.h"
+#include <atlstr.h>
+#include <CommCtrl.h>
+#include <strsafe.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include "AppErrors.h"
+#include "ImageDialog.h"
+#include "Globals.h"
+#include "Parallel.h"
+#include "JobRunner.h"
+
+// resolution of the progress bar
+#define PROGRESS_RANGE	1000
+
+// one queued job
+typedef struct JOB {
+	WCHAR Name[MAX_PATH];		// shown in the progress window
+	JOBFUNCTION Function;
+} JOB;
+
+// guarded by JobLock
+static std::deque<JOB> JobQueue;
+static WCHAR CurrentJob[MAX_PATH] = L"";	// name of the running job, "" if none
+static BOOL JobThreadStarted = FALSE;
+static BOOL StopRequested = FALSE;
+
+static std::mutex JobLock;
+static std::condition_variable JobReady;
+static std::thread JobThread;
+static std::atomic<DWORD> JobThreadId(0);
+static std::atomic<bool> JobThreadDone(false);
+static std::atomic<bool> CancelRequested(false);
+static std::atomic<bool> Stopping(false);
+static std::atomic<bool> StatusPending(false);
+static std::atomic<int> ProgressDone(0);
+static std::atomic<int> ProgressTotal(0);
+
+static HWND hwndJobs = NULL;	// modeless progress window
+static BOOL JobsHidden = FALSE;	// progress window closed by the user until the queue is empty
+
+static INT_PTR CALLBACK JobProgressDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam);
+
+//*****************************************************************************************
+//
+//	PostJobStatus
+//
+//	Private function, tell the main window that the job status changed.
+//	Only one WM_JOB_STATUS is pending at a time so a job reporting
+//	progress in a tight loop does not flood the message queue.
+//
+//*****************************************************************************************
+static void PostJobStatus(void)
+{
+	if (hwndMain == NULL) {
+		return;
+	}
+	if (!StatusPending.exchange(true)) {
+		if (!PostMessage(hwndMain, WM_JOB_STATUS, 0, 0)) {
+			StatusPending = false;
+		}
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	JobThreadMain
+//
+//	Private function, the job thread.  Runs the queued jobs one at a time
+//	until StopJobRunner() is called.
+//
+//*****************************************************************************************
+static void JobThreadMain(void)
+{
+	JOB Job;
+
+	JobThreadId = GetCurrentThreadId();
+
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> Guard(JobLock);
+			JobReady.wait(Guard, [] { return !JobQueue.empty() || StopRequested; });
+			if (StopRequested) {
+				break;
+			}
+			Job = JobQueue.front();
+			JobQueue.pop_front();
+			StringCchCopy(CurrentJob, MAX_PATH, Job.Name);
+			ProgressDone = 0;
+			ProgressTotal = 0;
+			CancelRequested = false;
+		}
+		PostJobStatus();
+
+		// the job reports its own errors
+		try {
+			Job.Function();
+		}
+		catch (...) {
+			// a failed allocation must not end the job thread
+		}
+
+		{
+			std::lock_guard<std::mutex> Guard(JobLock);
+			CurrentJob[0] = 0;
+			CancelRequested = false;
+		}
+		PostJobStatus();
+	}
+
+	JobThreadDone = true;
+	return;
+}
+
+//*****************************************************************************************
+//
+//	QueueJob
+//
+//	Add a job to the end of the job queue.  Called from the UI thread.
+//	The job thread is started when the first job is queued.
+//
+// Parameters:
+//	const WCHAR* Name				job name shown in the progress window
+//	const JOBFUNCTION& Function		job to run, called on the job thread
+//									everything it uses must be captured by value
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list
+//
+//*****************************************************************************************
+int QueueJob(const WCHAR* Name, const JOBFUNCTION& Function)
+{
+	JOB Job;
+
+	if (Stopping) {
+		return APPERR_PARAMETER;
+	}
+
+	StringCchCopy(Job.Name, MAX_PATH, Name);
+	Job.Function = Function;
+
+	{
+		std::lock_guard<std::mutex> Guard(JobLock);
+		JobQueue.push_back(Job);
+		if (!JobThreadStarted) {
+			try {
+				JobThread = std::thread(JobThreadMain);
+				JobThreadStarted = TRUE;
+			}
+			catch (...) {
+				JobQueue.pop_back();
+				MessageBox(hwndMain, L"Could not start job thread", L"System Error", MB_OK);
+				return APPERR_MEMALLOC;
+			}
+		}
+	}
+	JobReady.notify_one();
+
+	JobsHidden = FALSE;
+	UpdateJobStatus();
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	JobProgress
+//
+//	Report the progress of the running job, called from the inner loops of
+//	a job (from any of its threads).
+//
+// Parameters:
+//	int Done				# of units done
+//	int Total				total # of units
+//
+//*****************************************************************************************
+void JobProgress(int Done, int Total)
+{
+	ProgressTotal = Total;
+	if (ProgressDone.exchange(Done) != Done) {
+		PostJobStatus();
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	JobCancelled
+//
+//	Cooperative cancellation, checked in the inner loops of a job
+//	(from any of its threads).
+//
+//  return value:
+//  TRUE - the user cancelled the running job
+//
+//*****************************************************************************************
+BOOL JobCancelled(void)
+{
+	return CancelRequested ? TRUE : FALSE;
+}
+
+//*****************************************************************************************
+//
+//	IsJobThread
+//
+//  return value:
+//  TRUE - the calling thread is the job thread
+//
+//*****************************************************************************************
+BOOL IsJobThread(void)
+{
+	DWORD ThreadId = JobThreadId;
+
+	return (ThreadId != 0 && ThreadId == GetCurrentThreadId()) ? TRUE : FALSE;
+}
+
+//*****************************************************************************************
+//
+//	RunOnUIThread
+//
+//	Run a function on the UI thread, used for display updates from a job.
+//	If called from the UI thread the function is called directly.  From the
+//	job thread the call waits until the UI thread has run the function.
+//
+// Parameters:
+//	const JOBFUNCTION& Function		function to run
+//
+//  return value:
+//  return value of the function
+//  APPERR_CANCELLED if the application is closing
+//
+//*****************************************************************************************
+int RunOnUIThread(const JOBFUNCTION& Function)
+{
+	if (!IsJobThread()) {
+		return Function();
+	}
+	if (Stopping || hwndMain == NULL) {
+		return APPERR_CANCELLED;
+	}
+	return (int)SendMessage(hwndMain, WM_JOB_CALL, 0, (LPARAM)&Function);
+}
+
+//*****************************************************************************************
+//
+//	CancelJobs
+//
+//	Cancel the running job and optionally the queued jobs
+//
+// Parameters:
+//	BOOL All				TRUE - also remove all the queued jobs
+//
+//*****************************************************************************************
+void CancelJobs(BOOL All)
+{
+	{
+		std::lock_guard<std::mutex> Guard(JobLock);
+		if (All) {
+			JobQueue.clear();
+		}
+		if (CurrentJob[0] != 0) {
+			CancelRequested = true;
+		}
+	}
+	PostJobStatus();
+	return;
+}
+
+//*****************************************************************************************
+//
+//	UpdateJobStatus
+//
+//	Update the progress window, called by the main window on WM_JOB_STATUS.
+//	The progress window is shown while there are jobs and hidden when
+//	the queue is empty.
+//
+//*****************************************************************************************
+void UpdateJobStatus(void)
+{
+	WCHAR Name[MAX_PATH];
+	WCHAR szString[MAX_PATH];
+	int NumQueued;
+	int Done;
+	int Total;
+	BOOL Cancelling;
+
+	StatusPending = false;
+	if (Stopping) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> Guard(JobLock);
+		StringCchCopy(Name, MAX_PATH, CurrentJob);
+		NumQueued = (int)JobQueue.size();
+		Cancelling = CancelRequested ? TRUE : FALSE;
+	}
+	Done = ProgressDone;
+	Total = ProgressTotal;
+
+	if (Name[0] == 0 && NumQueued == 0) {
+		if (hwndJobs != NULL) {
+			ShowWindow(hwndJobs, SW_HIDE);
+		}
+		JobsHidden = FALSE;
+		return;
+	}
+
+	if (hwndJobs == NULL) {
+		hwndJobs = CreateDialog(hInst, MAKEINTRESOURCE(IDD_JOB_PROGRESS), hwndMain, JobProgressDlg);
+		if (hwndJobs == NULL) {
+			return;
+		}
+	}
+
+	if (Name[0] == 0) {
+		SetDlgItemText(hwndJobs, IDC_JOB_NAME, L"Starting next job");
+		SendDlgItemMessage(hwndJobs, IDC_JOB_PROGRESS, PBM_SETPOS, 0, 0);
+	}
+	else {
+		if (Cancelling) {
+			StringCchPrintf(szString, MAX_PATH, L"%s, cancelling", Name);
+		}
+		else if (Total > 0) {
+			StringCchPrintf(szString, MAX_PATH, L"%s, %d of %d", Name, Done, Total);
+		}
+		else {
+			StringCchCopy(szString, MAX_PATH, Name);
+		}
+		SetDlgItemText(hwndJobs, IDC_JOB_NAME, szString);
+		SendDlgItemMessage(hwndJobs, IDC_JOB_PROGRESS, PBM_SETPOS,
+			Total > 0 ? (WPARAM)(((long long)Done * PROGRESS_RANGE) / Total) : 0, 0);
+	}
+
+	StringCchPrintf(szString, MAX_PATH, L"%d more job%s queued", NumQueued, NumQueued == 1 ? L"" : L"s");
+	SetDlgItemText(hwndJobs, IDC_JOB_QUEUED, szString);
+	EnableWindow(GetDlgItem(hwndJobs, IDC_CANCEL_JOB), Name[0] != 0 && !Cancelling);
+
+	if (!JobsHidden && !IsWindowVisible(hwndJobs)) {
+		ShowWindow(hwndJobs, SW_SHOWNOACTIVATE);
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	IsJobDialogMessage
+//
+//	Keyboard handling for the modeless progress window, used by the main
+//	message loop.
+//
+//  return value:
+//  TRUE - message was processed by the progress window
+//
+//*****************************************************************************************
+BOOL IsJobDialogMessage(MSG* msg)
+{
+	if (hwndJobs == NULL || !IsWindow(hwndJobs)) {
+		return FALSE;
+	}
+	return IsDialogMessage(hwndJobs, msg);
+}
+
+//*****************************************************************************************
+//
+//	StopJobRunner
+//
+//	Cancel the running job, drop the queue and end the job thread.
+//	Called by the main window when the application is closing.
+//	The running job may be waiting for the UI thread (RunOnUIThread), so
+//	messages are processed while waiting for the job thread to end.
+//
+//*****************************************************************************************
+void StopJobRunner(void)
+{
+	BOOL Started;
+
+	Stopping = true;
+	{
+		std::lock_guard<std::mutex> Guard(JobLock);
+		JobQueue.clear();
+		StopRequested = TRUE;
+		if (CurrentJob[0] != 0) {
+			CancelRequested = true;
+		}
+		Started = JobThreadStarted;
+	}
+	JobReady.notify_all();
+
+	if (Started) {
+		while (!JobThreadDone) {
+			WaitProcessingMessages(100);
+		}
+		JobThread.join();
+	}
+
+	if (hwndJobs != NULL) {
+		DestroyWindow(hwndJobs);
+		hwndJobs = NULL;
+	}
+	return;
+}
+
+//*******************************************************************************
+//
+// Message handler for the jobs progress window
+//
+//*******************************************************************************
+static INT_PTR CALLBACK JobProgressDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
+{
+	UNREFERENCED_PARAMETER(lParam);
+	switch (message) {
+	case WM_INITDIALOG:
+		SendDlgItemMessage(hDlg, IDC_JOB_PROGRESS, PBM_SETRANGE32, 0, PROGRESS_RANGE);
+		return (INT_PTR)TRUE;
+
+	case WM_COMMAND:
+		switch (LOWORD(wParam)) {
+		case IDC_CANCEL_JOB:
+			CancelJobs(FALSE);
+			return (INT_PTR)TRUE;
+
+		case IDC_CANCEL_ALL:
+			CancelJobs(TRUE);
+			return (INT_PTR)TRUE;
+
+		case IDCANCEL:
+			// only hides the window, the jobs continue
+			JobsHidden = TRUE;
+			ShowWindow(hDlg, SW_HIDE);
+			return (INT_PTR)TRUE;
+		}
+		break;
+	}
+	return (INT_PTR)FALSE;
+}
@@ -0,0 +1,31 @@
+#pragma once
+//
+// JobRunner.h
+// function prototypes for the background job runner in JobRunner.cpp
+//
+#include <functional>
+
+// messages sent to the main window by the job thread
+#define WM_JOB_STATUS		(WM_APP + 1)	// progress or job queue changed
+#define WM_JOB_CALL			(WM_APP + 2)	// lParam is a JOBFUNCTION* to run on the UI thread
+
+// a job returns a standardized app error number
+typedef std::function<int(void)> JOBFUNCTION;
+
+int QueueJob(const WCHAR* Name, const JOBFUNCTION& Function);
+
+void JobProgress(int Done, int Total);
+
+BOOL JobCancelled(void);
+
+BOOL IsJobThread(void);
+
+int RunOnUIThread(const JOBFUNCTION& Function);
+
+void CancelJobs(BOOL All);
+
+void UpdateJobStatus(void);
+
+BOOL IsJobDialogMessage(MSG* msg);
+
+void StopJobRunner(void);
@@ -0,0 +1,305 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// Lz4.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// LZ4 block compression
+//
+// Fast lossless compression used for the frames of version 2 image files
+// (ImageFile.cpp).  The compressed data is the standard LZ4 block format so
+// it can also be decoded by other LZ4 tools:
+//
+//	sequence	token, high 4 bits # of literals, low 4 bits match length - 4
+//				more literal length bytes if the literal length is >= 15
+//				the literals
+//				2 byte offset of the match (PC format), 1 to 65535 bytes back
+//				more match length bytes if the match length is >= 15+4
+//
+//	A length byte of 255 means another length byte follows.  The last
+//	sequence is only literals.  The last 5 bytes are always literals and
+//	a match does not start in the last 12 bytes.
+//
+// The compressor is a single pass, greedy match finder with a hash table
+// of the last position of each 4 byte sequence.  It is meant for speed, not
+// for the best compression ratio.  Binary images and images with large
+// blank areas compress well, noise does not compress at all.
+//
+// The decompressor checks every length and offset against the input and
+// output sizes, a damaged file is reported as a read error.
+//
+// V1.3.2.1 2026-10-14  Initial release
+//
+#include "framework.h"
+#include <vector>
+#include "AppErrors.h"
+#include "Lz4.h"
+
+#define LZ4_MINMATCH		4			// shortest match
+#define LZ4_LASTLITERALS	5			// the last 5 bytes are always literals
+#define LZ4_MFLIMIT			12			// a match can not start in the last 12 bytes
+#define LZ4_MAXOFFSET		65535		// furthest match back
+#define LZ4_HASHLOG			16			// hash table size, 2^LZ4_HASHLOG entries
+#define LZ4_SKIPTRIGGER		6			// search step grows after 2^LZ4_SKIPTRIGGER misses
+
+static inline UINT32 Read32(const BYTE* Src)
+{
+	UINT32 Value;
+
+	memcpy(&Value, Src, sizeof(UINT32));
+	return Value;
+}
+
+static inline UINT32 HashSequence(UINT32 Sequence)
+{
+	return (Sequence * 2654435761U) >> (32 - LZ4_HASHLOG);
+}
+
+static inline BYTE* WriteLength(BYTE* Dst, size_t Length)
+{
+	while (Length >= 255) {
+		*Dst++ = 255;
+		Length -= 255;
+	}
+	*Dst++ = (BYTE)Length;
+	return Dst;
+}
+
+//*****************************************************************************************
+//
+//	Lz4CompressBound
+//
+//	Largest compressed size of SrcSize bytes, data that does not compress
+//	is stored as literals with a few bytes of length overhead
+//
+//*****************************************************************************************
+size_t Lz4CompressBound(size_t SrcSize)
+{
+	return SrcSize + SrcSize / 255 + 16;
+}
+
+//*****************************************************************************************
+//
+//	Lz4Compress
+//
+//	Compress a block of data in the LZ4 block format
+//
+// Parameters:
+//	const BYTE* Src			data to compress
+//	size_t SrcSize			# of bytes in Src, less than 2^31
+//	BYTE* Dst				receives the compressed data
+//	size_t DstCapacity		size of Dst
+//
+//  return value:
+//  # of bytes in the compressed data
+//  0 - the compressed data does not fit in DstCapacity bytes or SrcSize is too large,
+//		this is used to skip the compression of data that does not get smaller
+//
+//*****************************************************************************************
+size_t Lz4Compress(const BYTE* Src, size_t SrcSize, BYTE* Dst, size_t DstCapacity)
+{
+	BYTE* Out = Dst;
+	BYTE* OutEnd = Dst + DstCapacity;
+	size_t Anchor = 0;		// first byte not yet written
+
+	if (SrcSize >= 0x7fffffff) {
+		return 0;
+	}
+
+	if (SrcSize > LZ4_MFLIMIT) {
+		std::vector<UINT32> Table((size_t)1 << LZ4_HASHLOG, 0);
+		size_t MatchStartLimit = SrcSize - LZ4_MFLIMIT;
+		size_t MatchEndLimit = SrcSize - LZ4_LASTLITERALS;
+		size_t Pos = 0;
+
+		while (Pos <= MatchStartLimit) {
+			UINT32 Sequence = Read32(&Src[Pos]);
+			UINT32 Hash = HashSequence(Sequence);
+			size_t Candidate = (size_t)Table[Hash];
+
+			Table[Hash] = (UINT32)Pos;
+			if (Candidate >= Pos || Pos - Candidate > LZ4_MAXOFFSET || Read32(&Src[Candidate]) != Sequence) {
+				// no match, step further ahead the longer there has been no match
+				Pos += 1 + ((Pos - Anchor) >> LZ4_SKIPTRIGGER);
+				continue;
+			}
+
+			// extend the match back over the pending literals and forward
+			while (Pos > Anchor && Candidate > 0 && Src[Pos - 1] == Src[Candidate - 1]) {
+				Pos--;
+				Candidate--;
+			}
+			size_t MatchLength = LZ4_MINMATCH;
+			while (Pos + MatchLength < MatchEndLimit && Src[Pos + MatchLength] == Src[Candidate + MatchLength]) {
+				MatchLength++;
+			}
+
+			size_t LiteralLength = Pos - Anchor;
+			size_t Offset = Pos - Candidate;
+			if ((size_t)(OutEnd - Out) < 1 + LiteralLength + LiteralLength / 255 + 1 + 2 +
+					(MatchLength - LZ4_MINMATCH) / 255 + 1) {
+				return 0;
+			}
+
+			BYTE* Token = Out++;
+			if (LiteralLength >= 15) {
+				*Token = 15 << 4;
+				Out = WriteLength(Out, LiteralLength - 15);
+			}
+			else {
+				*Token = (BYTE)(LiteralLength << 4);
+			}
+			memcpy(Out, &Src[Anchor], LiteralLength);
+			Out += LiteralLength;
+
+			*Out++ = (BYTE)(Offset & 0xff);
+			*Out++ = (BYTE)(Offset >> 8);
+
+			if (MatchLength - LZ4_MINMATCH >= 15) {
+				*Token |= 15;
+				Out = WriteLength(Out, MatchLength - LZ4_MINMATCH - 15);
+			}
+			else {
+				*Token |= (BYTE)(MatchLength - LZ4_MINMATCH);
+			}
+
+			Pos += MatchLength;
+			Anchor = Pos;
+			// the position just before the next search is likely to start a match
+			if (Pos - 2 <= MatchStartLimit) {
+				Table[HashSequence(Read32(&Src[Pos - 2]))] = (UINT32)(Pos - 2);
+			}
+		}
+	}
+
+	// last sequence, the rest of the data as literals
+	size_t LiteralLength = SrcSize - Anchor;
+	if ((size_t)(OutEnd - Out) < 1 + LiteralLength + LiteralLength / 255 + 1) {
+		return 0;
+	}
+	if (LiteralLength >= 15) {
+		*Out++ = 15 << 4;
+		Out = WriteLength(Out, LiteralLength - 15);
+	}
+	else {
+		*Out++ = (BYTE)(LiteralLength << 4);
+	}
+	memcpy(Out, &Src[Anchor], LiteralLength);
+	Out += LiteralLength;
+
+	return (size_t)(Out - Dst);
+}
+
+//*****************************************************************************************
+//
+//	Lz4Decompress
+//
+//	Decompress a block of LZ4 block format data
+//
+// Parameters:
+//	const BYTE* Src			compressed data
+//	size_t SrcSize			# of bytes of compressed data
+//	BYTE* Dst				receives the decompressed data
+//	size_t DstSize			exact size of the decompressed data
+//
+//  return value:
+//  1 - Success
+//  APPERR_FILEREAD the compressed data is damaged or does not decompress
+//	to exactly DstSize bytes
+//
+//*****************************************************************************************
+int Lz4Decompress(const BYTE* Src, size_t SrcSize, BYTE* Dst, size_t DstSize)
+{
+	size_t In = 0;
+	size_t Out = 0;
+	BYTE Length;
+
+	while (In < SrcSize) {
+		BYTE Token = Src[In++];
+
+		size_t LiteralLength = Token >> 4;
+		if (LiteralLength == 15) {
+			do {
+				if (In >= SrcSize) {
+					return APPERR_FILEREAD;
+				}
+				Length = Src[In++];
+				LiteralLength += Length;
+			} while (Length == 255);
+		}
+		if (LiteralLength > SrcSize - In || LiteralLength > DstSize - Out) {
+			return APPERR_FILEREAD;
+		}
+		memcpy(&Dst[Out], &Src[In], LiteralLength);
+		In += LiteralLength;
+		Out += LiteralLength;
+
+		if (In == SrcSize) {
+			// last sequence has no match
+			break;
+		}
+
+		if (SrcSize - In < 2) {
+			return APPERR_FILEREAD;
+		}
+		size_t Offset = (size_t)Src[In] | ((size_t)Src[In + 1] << 8);
+		In += 2;
+		if (Offset == 0 || Offset > Out) {
+			return APPERR_FILEREAD;
+		}
+
+		size_t MatchLength = Token & 15;
+		if (MatchLength == 15) {
+			do {
+				if (In >= SrcSize) {
+					return APPERR_FILEREAD;
+				}
+				Length = Src[In++];
+				MatchLength += Length;
+			} while (Length == 255);
+		}
+		MatchLength += LZ4_MINMATCH;
+		if (MatchLength > DstSize - Out) {
+			return APPERR_FILEREAD;
+		}
+
+		// a match that overlaps itself repeats the last Offset bytes,
+		// copy it in pieces that double in size so each copy does not overlap
+		const BYTE* Match = &Dst[Out - Offset];
+		if (Offset == 1) {
+			memset(&Dst[Out], *Match, MatchLength);
+		}
+		else if (Offset >= MatchLength) {
+			memcpy(&Dst[Out], Match, MatchLength);
+		}
+		else {
+			size_t Copied = 0;
+			while (Copied < MatchLength) {
+				size_t Count = Offset + Copied;
+				if (Count > MatchLength - Copied) {
+					Count = MatchLength - Copied;
+				}
+				memcpy(&Dst[Out + Copied], Match, Count);
+				Copied += Count;
+			}
+		}
+		Out += MatchLength;
+	}
+
+	if (Out != DstSize) {
+		return APPERR_FILEREAD;
+	}
+	return APP_SUCCESS;
+}
@@ -0,0 +1,11 @@
+#pragma once
+//
+// Lz4.h
+// function prototypes for the LZ4 block compression functions in Lz4.cpp
+//
+
+size_t Lz4CompressBound(size_t SrcSize);
+
+size_t Lz4Compress(const BYTE* Src, size_t SrcSize, BYTE* Dst, size_t DstCapacity);
+
+int Lz4Decompress(const BYTE* Src, size_t SrcSize, BYTE* Dst, size_t DstSize);
@@ -153,6 +153,18 @@
 //                      Merged the bitmap viewer from MySETIviewer
 //                      Replaced application error numbers with #define to improve clarity
 //                      Chnaged the batch processing to also display results after each step
+// V1.3.2.1 2026-10-14  Added, Bit tools menu, Bitstream autocorrelation (find period)
+//                      Added, Next/Previous frame of the displayed image file, PgDn/PgUp
+//                      Added, Image tools menu, Run transform pipeline
+//                      Added, background job runner, long operations are run on a job thread
+//                      with a progress window, cancel and a queue of further operations
+//                      Added, WorkerThreads global setting, number of image processing threads
+//                      Added, ResultCacheFolder and ResultCacheSizeMB global settings
+//                      Added, TimingLog global setting, operation timing log file
+//                      Added, ImageFileVersion and CompressImages global settings
+//                      Changed, the PNG encode queue is finished when the application closes
+//                      Added, Image tools menu, Pixel math (min, max, AND, OR, XOR, threshold)
+//                      Changed, the buffer pool is released when the application closes
 // 
 // MySETIapp.cpp : Defines the entry point for the application.
 //
@@ -181,6 +193,15 @@
 #include "FileFunctions.h"
 #include "AppFunctions.h"
 #include "ImageDialog.h"
+#include "JobRunner.h"
+#include "Parallel.h"
+#include "ResultCache.h"
+#include "Timing.h"
+#include <stdio.h>
+#include <vector>
+#include "ImageFile.h"
+#include "PngWriter.h"
+#include "BufferPool.h"
 
 #define MAX_LOADSTRING 100
 
@@ -230,6 +251,7 @@ INT_PTR CALLBACK    BitExtractDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    BitDistancesDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    BitSequencesDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    BitStatsDlg(HWND, UINT, WPARAM, LPARAM);
+INT_PTR CALLBACK    BitAutocorrelationDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    BitReorderDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    BitImageDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    ExtractSymbolsDlg(HWND, UINT, WPARAM, LPARAM);
@@ -245,6 +267,7 @@ INT_PTR CALLBACK    LeftAccordionImageDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    RightAccordionImageDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    LeftShiftRowsImageDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    ConvolutionImageDlg(HWND, UINT, WPARAM, LPARAM);
+INT_PTR CALLBACK    PipelineDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    AddImagesImageDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    RotateDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    MirrorDlg(HWND, UINT, WPARAM, LPARAM);
@@ -254,6 +277,7 @@ INT_PTR CALLBACK    GlobalSettingsDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    ImageDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    Text2StreamDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    MathConstantDlg(HWND, UINT, WPARAM, LPARAM);
+INT_PTR CALLBACK    ImageMathDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    StdDecimationDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    ReplicationDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    ReorderAlgDlg(HWND, UINT, WPARAM, LPARAM);
@@ -324,9 +348,18 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
             // Modeless dialog need to process messages intended for the modeless dialog only.
             // Check that message is not for each modeless dialog box.
             //
+            // PgDn/PgUp in the image window pages through the frames
+            if (msg.message == WM_KEYDOWN && (msg.wParam == VK_NEXT || msg.wParam == VK_PRIOR) &&
+                IsWindow(hwndImage) && (msg.hwnd == hwndImage || IsChild(hwndImage, msg.hwnd))) {
+                SendMessage(hwndMain, WM_COMMAND, msg.wParam == VK_NEXT ? IDM_NEXT_FRAME : IDM_PREV_FRAME, 0);
+                continue;
+            }
             if (IsWindow(hwndImage) && IsDialogMessage(hwndImage, &msg)) {
                 continue;
             }
+            if (IsJobDialogMessage(&msg)) {
+                continue;
+            }
             // // Modeless dialog B
             //if (IsWindow(hwndBDlg) && IsDialogMessage(hwndBtDlg, &msg)) {
             //    continue;
@@ -411,6 +444,9 @@ BOOL InitInstance(HINSTANCE hInstance, int nCmdShow)
    // this must be done before ImageDialog class created
    ShowStatusBar = GetPrivateProfileInt(L"GlobalSettings", L"ShowStatusBar", 1, (LPCTSTR)strAppNameINI);
 
+   // number of threads used by the image transforms, 0 - one per processor
+   SetWorkerCount(GetPrivateProfileInt(L"GlobalSettings", L"WorkerThreads", 0, (LPCTSTR)strAppNameINI));
+
    ImgDlg = new ImageDialog;
    
    // create image window
@@ -445,6 +481,18 @@ BOOL InitInstance(HINSTANCE hInstance, int nCmdShow)
    GetPrivateProfileString(L"GlobalSettings", L"TempImageFilename", L"", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
    wcscpy_s(szTempImageFilename, szString);
 
+   // result cache, a blank folder turns it off
+   GetPrivateProfileString(L"GlobalSettings", L"ResultCacheFolder", L"", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+   SetResultCache(szString, GetPrivateProfileInt(L"GlobalSettings", L"ResultCacheSizeMB", RESULTCACHE_DEFAULT_MB, (LPCTSTR)strAppNameINI));
+
+   // operation timing log, blank turns it off
+   GetPrivateProfileString(L"GlobalSettings", L"TimingLog", L"", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+   SetTimingLog(szString);
+
+   // image file version written by the image operations
+   SetImageFileFormat(GetPrivateProfileInt(L"GlobalSettings", L"ImageFileVersion", 1, (LPCTSTR)strAppNameINI),
+       GetPrivateProfileInt(L"GlobalSettings", L"CompressImages", 0, (LPCTSTR)strAppNameINI));
+
    GetPrivateProfileString(L"GlobalSettings", L"CurrentFIlename", L"", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
    wcscpy_s(szCurrentFilename, szString);
 
@@ -581,6 +629,10 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
                 DialogBox(hInst, MAKEINTRESOURCE(IDD_BITTOOLS_BITSTATS), hWnd, BitStatsDlg);
                 break;
 
+            case IDM_BITTOOLS_AUTOCORRELATION:
+                DialogBox(hInst, MAKEINTRESOURCE(IDD_BITTOOLS_AUTOCORRELATION), hWnd, BitAutocorrelationDlg);
+                break;
+
             case IDM_BITTOOLS_BITREORDER:
                 DialogBox(hInst, MAKEINTRESOURCE(IDD_BITTOOLS_REORDER), hWnd, BitReorderDlg);
                 break;
@@ -689,6 +741,10 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             case IDM_IMGTOOLS_CONVOLUTION:
                 DialogBox(hInst, MAKEINTRESOURCE(IDD_IMGTOOLS_CONVOLUTION), hWnd, ConvolutionImageDlg);
                 break;
+
+            case IDM_IMGTOOLS_PIPELINE:
+                DialogBox(hInst, MAKEINTRESOURCE(IDD_IMGTOOLS_PIPELINE), hWnd, PipelineDlg);
+                break;
                 
             case IDM_IMGTOOLS_ADD_KERNEL:
                 DialogBox(hInst, MAKEINTRESOURCE(IDD_IMGTOOLS_ADD_KERNEL), hWnd, AddKernelDlg);
@@ -721,6 +777,10 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             case IDM_MATH_CONSTANT:
                 DialogBox(hInst, MAKEINTRESOURCE(IDD_IMGTOOLS_MATH_CONSTANT), hWnd, MathConstantDlg);
                 break;
+
+            case IDM_IMGTOOLS_IMAGE_MATH:
+                DialogBox(hInst, MAKEINTRESOURCE(IDD_IMGTOOLS_IMAGE_MATH), hWnd, ImageMathDlg);
+                break;
                 
             case IDM_IMAGETOOLS_REPLICATION:
                 DialogBox(hInst, MAKEINTRESOURCE(IDD_IMGTOOLS_REPLICATION), hWnd, ReplicationDlg);
@@ -756,6 +816,28 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
                 break;
             }
 
+            case IDM_NEXT_FRAME:
+            case IDM_PREV_FRAME:
+            {
+                int Page, Pages;
+                int iRes;
+                Page = ImgDlg->GetFrame(&Pages);
+                if (Pages <= 1 || hwndImage == NULL) {
+                    break;
+                }
+                Page = Page + (wmId == IDM_NEXT_FRAME ? 1 : -1);
+                if (Page < 0 || Page >= Pages) {
+                    break;
+                }
+                iRes = ImgDlg->ShowFrame(Page);
+                if (iRes != APP_SUCCESS) {
+                    MessageBox(hWnd, L"Display frame failed", L"Display image", MB_OK);
+                    break;
+                }
+                SendMessage(hwndImage, WM_COMMAND, IDC_UPDATE_IMAGE, 0l);
+                break;
+            }
+
             case IDM_RESET_WINDOW_POSITIONS:
                 WritePrivateProfileString(L"GlobalSettings", L"ResetWindows", L"1", (LPCTSTR)strAppNameINI);
                 break;
@@ -769,7 +851,21 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         }
         break;
 
+    case WM_JOB_STATUS:
+        UpdateJobStatus();
+        break;
+
+    case WM_JOB_CALL:
+        // function sent by the job thread to run on the UI thread, see RunOnUIThread()
+        return (LRESULT)(*(JOBFUNCTION*)lParam)();
+
     case WM_DESTROY:
+        // cancel the running job and the queued jobs
+        StopJobRunner();
+        // finish writing the queued PNG files
+        StopPNGQueue();
+        // return the cached image buffers to the OS
+        TrimBufferPool();
         {   // save window position/size data
             CString csString = L"MainWindow";
             WritePrivateProfileString(L"GlobalSettings", L"CurrentFIlename", szCurrentFilename, (LPCTSTR)strAppNameINI);
@@ -0,0 +1,437 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// MySETIcli.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Console front end, entry point of MySETIcli.exe (MySETIcli.vcxproj)
+//
+// This runs the image transforms without the user interface so they can be
+// used from scripts and batch files.  It uses the same image processing code
+// as MySETIapp (the in memory pipeline in Pipeline.cpp).  Nothing is displayed
+// and there are no message boxes, errors are printed to the console and
+// returned in the exit code.
+//
+// Usage:
+//	MySETIcli pipeline <pipeline file> <input image> <output image>
+//	MySETIcli <step> [parameters] <input image> <output image>
+//	MySETIcli jobs <job file>
+//	MySETIcli bench <work folder> [Xsize Ysize NumFrames PixelSize Repeat]
+//	MySETIcli convert Version Compress <input image> <output image>
+//
+//	<step> [parameters] is a single pipeline step, same as a line in a
+//	pipeline file (see Pipeline.cpp), for example:
+//		MySETIcli rotate 1 Message.raw Rotated.raw
+//
+//	A job file is a text file with one job per line, each line has the same
+//	arguments as the command line (without MySETIcli).  Blank lines and
+//	lines starting with / ; or : are ignored.  Filenames with spaces are put
+//	in quotes.  The jobs are independent of each other and are run in parallel,
+//	one job per worker thread.  A job must not use the output of another job
+//	in the same job file.
+//
+//	bench runs the benchmark of the core functions (see Benchmark.cpp) on
+//	generated files in the work folder and prints the results.  The default
+//	is 1024 x 1024, 4 frames, 1 byte pixels, fastest of 3 runs.
+//
+//	convert copies an image file to a version 1 or version 2 image file
+//	(see ImageFile.cpp), Compress 1 compresses the frames of a version 2
+//	file.  It can also be used in a job file to convert a set of files.
+//	The pipeline and step jobs write version 1 image files.
+//
+// Exit code:
+//	0 - all jobs were successful
+//	otherwise 1 - (standardized app error number) of the first failed job
+//	in the job or command line order:
+//		1 parameter or image header problem
+//		2 memory allocation failure
+//		3 open file failure
+//		4 file read failure
+//		5 incorect file type
+//		6 file sizes mismatch
+//		7 not yet implemented
+//		8 file write failure
+//
+// V1.3.2.1 2026-10-14  Initial release, console front end
+//                      Changed, images too large to load are streamed a block of frames at a time
+//                      Added, bench command, benchmark of the core functions
+//                      Added, convert job, convert image files to and from version 2 image files
+//
+#include "framework.h"
+#include <stdio.h>
+#include <wchar.h>
+#include <atlstr.h>
+#include <strsafe.h>
+#include <shellapi.h>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include "AppErrors.h"
+#include "ImageDialog.h"
+#include "imaging.h"
+#include "ImageIO.h"
+#include "Parallel.h"
+#include "Pipeline.h"
+#include "Benchmark.h"
+#include "ImageFile.h"
+
+// Global Variables:
+// These are referenced by the shared image processing modules (see Globals.h)
+// There are no windows in the console version, results are never displayed.
+HINSTANCE hInst = NULL;
+WCHAR szBMPFilename[MAX_PATH] = L"";
+WCHAR szCurrentFilename[MAX_PATH] = L"";
+WCHAR szTempImageFilename[MAX_PATH] = L"";
+BOOL DisplayResults = FALSE;
+BOOL AutoScaleResults = FALSE;
+BOOL DefaultRBG = FALSE;
+BOOL AutoSize = FALSE;
+BOOL AutoPNG = FALSE;
+BOOL ShowStatusBar = FALSE;
+CString strProductName;
+CString strProductVersion;
+CString strName;
+CString strCopyright;
+CString strAppNameEXE;
+CString strAppNameINI;
+ImageDialog* ImgDlg = NULL;
+HWND hwndMain = NULL;
+HWND hwndImage = NULL;
+
+#define MAX_JOBLINE (3 * MAX_PATH)
+
+// one job, from the command line or a line in a job file
+typedef struct CLIJOB {
+    std::vector<CString> Args;  // arguments, same as the command line without MySETIcli
+    int Line;                   // line # in the job file, 0 when from the command line
+    int Result;                 // standardized app error number
+    WCHAR Message[MAX_JOBLINE]; // result text printed when the job finishes
+} CLIJOB;
+
+static std::mutex ConsoleLock;  // job results are printed by the worker threads
+
+//*******************************************************************************
+//
+// Usage
+//
+// Print the command line usage
+//
+//*******************************************************************************
+static void Usage(void)
+{
+    wprintf(L"Usage:\n");
+    wprintf(L"  MySETIcli pipeline <pipeline file> <input image> <output image>\n");
+    wprintf(L"  MySETIcli <step> [parameters] <input image> <output image>\n");
+    wprintf(L"  MySETIcli jobs <job file>\n");
+    wprintf(L"  MySETIcli bench <work folder> [Xsize Ysize NumFrames PixelSize Repeat]\n");
+    wprintf(L"  MySETIcli convert Version Compress <input image> <output image>\n");
+    wprintf(L"\n");
+    wprintf(L"Steps:\n");
+    wprintf(L"  fold_left FoldColumn, fold_right FoldColumn\n");
+    wprintf(L"  fold_down FoldRow, fold_up FoldRow\n");
+    wprintf(L"  rotate Direction, mirror Direction\n");
+    wprintf(L"  convolve KernelFile\n");
+    wprintf(L"  resize Xsize Ysize PixelSize\n");
+    wprintf(L"  reorder Xsize Ysize PixelSize Algorithm P1 P2 P3 Invert\n");
+    wprintf(L"  decimate Xsize Ysize PixelSize\n");
+    wprintf(L"  replicate Xsize Ysize\n");
+    wprintf(L"  math Operation Value\n");
+    return;
+}
+
+//*******************************************************************************
+//
+// RunJob
+//
+// Run one job.  Either a pipeline file or a single pipeline step is run
+// on the input image and the result is written to the output image,
+// or the input image is converted to another image file version.
+// The result text is returned in Job->Message.
+//
+// This is run on a worker thread, it must not print to the console.
+//
+// Parameters:
+//	CLIJOB* Job			job to run
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+static int RunJob(CLIJOB* Job)
+{
+    std::vector<PIPELINESTEP> Steps;
+    WCHAR* InputFile;
+    WCHAR* OutputFile;
+    int NumArgs;
+    int ErrorLine;
+    int ErrorStep;
+    int iRes;
+
+    NumArgs = (int)Job->Args.size();
+    if (NumArgs < 3) {
+        StringCchPrintf(Job->Message, MAX_JOBLINE, L"missing arguments");
+        return APPERR_PARAMETER;
+    }
+    InputFile = (WCHAR*)(LPCWSTR)Job->Args[NumArgs - 2];
+    OutputFile = (WCHAR*)(LPCWSTR)Job->Args[NumArgs - 1];
+
+    if (Job->Args[0].CompareNoCase(L"convert") == 0) {
+        int Version;
+        int Compress;
+
+        if (NumArgs != 5) {
+            StringCchPrintf(Job->Message, MAX_JOBLINE, L"convert needs a version, compress flag, input image and output image");
+            return APPERR_PARAMETER;
+        }
+        Version = _wtoi(Job->Args[1]);
+        Compress = _wtoi(Job->Args[2]);
+        if ((Version != 1 && Version != IMAGEFILE_VERSION_PACKED) || (Compress != 0 && Compress != 1)) {
+            StringCchPrintf(Job->Message, MAX_JOBLINE, L"convert version must be 1 or 2, compress 0 or 1");
+            return APPERR_PARAMETER;
+        }
+        iRes = ConvertImageFile(InputFile, OutputFile, Version, Compress);
+        if (iRes != APP_SUCCESS) {
+            StringCchPrintf(Job->Message, MAX_JOBLINE, L"could not convert %s to %s", InputFile, OutputFile);
+            return iRes;
+        }
+        StringCchPrintf(Job->Message, MAX_JOBLINE, L"%s", OutputFile);
+        return APP_SUCCESS;
+    }
+
+    if (Job->Args[0].CompareNoCase(L"pipeline") == 0) {
+        if (NumArgs != 4) {
+            StringCchPrintf(Job->Message, MAX_JOBLINE, L"pipeline needs a pipeline file, input image and output image");
+            return APPERR_PARAMETER;
+        }
+        iRes = ReadPipelineFile((WCHAR*)(LPCWSTR)Job->Args[1], Steps, &ErrorLine);
+        if (iRes != APP_SUCCESS) {
+            if (ErrorLine == 0) {
+                StringCchPrintf(Job->Message, MAX_JOBLINE, L"could not read pipeline file %s",
+                    (LPCWSTR)Job->Args[1]);
+            }
+            else {
+                StringCchPrintf(Job->Message, MAX_JOBLINE, L"pipeline file %s error in line %d",
+                    (LPCWSTR)Job->Args[1], ErrorLine);
+            }
+            return iRes;
+        }
+    }
+    else {
+        // single step, the arguments before the image files are the step
+        CString StepText;
+        PIPELINESTEP Step;
+
+        for (int i = 0; i < NumArgs - 2; i++) {
+            if (i != 0) {
+                StepText += L" ";
+            }
+            StepText += Job->Args[i];
+        }
+        iRes = ParsePipelineStep((WCHAR*)(LPCWSTR)StepText, &Step);
+        if (iRes != APP_SUCCESS) {
+            StringCchPrintf(Job->Message, MAX_JOBLINE, L"invalid step '%s'", (LPCWSTR)StepText);
+            return iRes;
+        }
+        Step.Line = 1;
+        Steps.push_back(Step);
+    }
+
+    // images too large to load are streamed through the steps
+    iRes = RunPipelineFile(Steps, InputFile, OutputFile, &ErrorStep);
+    if (iRes != APP_SUCCESS) {
+        if (ErrorStep == PIPE_ERROR_LOAD) {
+            StringCchPrintf(Job->Message, MAX_JOBLINE, L"could not load input image %s", InputFile);
+        }
+        else if (ErrorStep == PIPE_ERROR_WRITE) {
+            StringCchPrintf(Job->Message, MAX_JOBLINE, L"could not write output image %s", OutputFile);
+        }
+        else {
+            StringCchPrintf(Job->Message, MAX_JOBLINE, L"step in line %d failed", Steps[ErrorStep].Line);
+        }
+        FreePipeline(Steps);
+        return iRes;
+    }
+    FreePipeline(Steps);
+
+    StringCchPrintf(Job->Message, MAX_JOBLINE, L"%s", OutputFile);
+    return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+// ReadJobFile
+//
+// Read a job file, one job per line.  The arguments in a line are split
+// the same way as a command line, arguments with spaces are put in quotes.
+//
+// Parameters:
+//	WCHAR* JobFile				job text file
+//	std::vector<CLIJOB>& Jobs	returned jobs
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+static int ReadJobFile(WCHAR* JobFile, std::vector<CLIJOB>& Jobs)
+{
+    FILE* In;
+    errno_t ErrNum;
+    WCHAR Line[MAX_JOBLINE];
+    LPWSTR* Argv;
+    int Argc;
+    int iLine = 0;
+
+    ErrNum = _wfopen_s(&In, JobFile, L"r");
+    if (In == NULL) {
+        return APPERR_FILEOPEN;
+    }
+
+    while (fgetws(Line, MAX_JOBLINE, In) != NULL) {
+        iLine++;
+        if (StringBlankorComnent(Line, MAX_JOBLINE)) {
+            continue;
+        }
+        Line[wcscspn(Line, L"\r\n")] = 0;
+
+        Argv = CommandLineToArgvW(Line, &Argc);
+        if (Argv == NULL) {
+            fclose(In);
+            return APPERR_MEMALLOC;
+        }
+
+        CLIJOB Job;
+        for (int i = 0; i < Argc; i++) {
+            Job.Args.push_back(CString(Argv[i]));
+        }
+        Job.Line = iLine;
+        Job.Result = APP_SUCCESS;
+        Job.Message[0] = 0;
+        Jobs.push_back(Job);
+        LocalFree(Argv);
+    }
+    fclose(In);
+
+    if (Jobs.empty()) {
+        return APPERR_PARAMETER;
+    }
+    return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+// wmain
+//
+// Console entry point
+//
+//*******************************************************************************
+int wmain(int argc, wchar_t* argv[])
+{
+    std::vector<CLIJOB> Jobs;
+    std::atomic<int> NextJob(0);
+    int NumJobs;
+    int iRes;
+
+    if (argc < 2 || wcscmp(argv[1], L"-?") == 0 || _wcsicmp(argv[1], L"help") == 0) {
+        Usage();
+        return APP_SUCCESS - APPERR_PARAMETER;
+    }
+
+    if (_wcsicmp(argv[1], L"bench") == 0) {
+        int Xsize = 1024;
+        int Ysize = 1024;
+        int NumFrames = 4;
+        int PixelSize = 1;
+        int Repeat = 3;
+
+        if (argc != 3 && argc != 8) {
+            Usage();
+            return APP_SUCCESS - APPERR_PARAMETER;
+        }
+        if (argc == 8) {
+            Xsize = _wtoi(argv[3]);
+            Ysize = _wtoi(argv[4]);
+            NumFrames = _wtoi(argv[5]);
+            PixelSize = _wtoi(argv[6]);
+            Repeat = _wtoi(argv[7]);
+        }
+        iRes = RunBenchmark(argv[2], Xsize, Ysize, NumFrames, PixelSize, Repeat);
+        return APP_SUCCESS - iRes;
+    }
+
+    if (_wcsicmp(argv[1], L"jobs") == 0) {
+        if (argc != 3) {
+            Usage();
+            return APP_SUCCESS - APPERR_PARAMETER;
+        }
+        iRes = ReadJobFile(argv[2], Jobs);
+        if (iRes != APP_SUCCESS) {
+            fwprintf(stderr, L"Could not read job file %s, error %d\n", argv[2], iRes);
+            return APP_SUCCESS - iRes;
+        }
+    }
+    else {
+        CLIJOB Job;
+        for (int i = 1; i < argc; i++) {
+            Job.Args.push_back(CString(argv[i]));
+        }
+        Job.Line = 0;
+        Job.Result = APP_SUCCESS;
+        Job.Message[0] = 0;
+        Jobs.push_back(Job);
+    }
+
+    // Run the jobs, each worker takes the next job that has not been started
+    // so that a long job does not hold up the jobs after it.
+    // The image transforms in each job also use the worker threads.
+    NumJobs = (int)Jobs.size();
+    ParallelFor(0, NumJobs, [&](int BandStart, int BandEnd) {
+        int CurrentJob;
+        for (;;) {
+            CurrentJob = NextJob++;
+            if (CurrentJob >= NumJobs) {
+                break;
+            }
+            CLIJOB* Job = &Jobs[CurrentJob];
+            Job->Result = RunJob(Job);
+
+            std::lock_guard<std::mutex> Lock(ConsoleLock);
+            if (Job->Result == APP_SUCCESS) {
+                if (Job->Line != 0) {
+                    wprintf(L"Job line %d: done, %s\n", Job->Line, Job->Message);
+                }
+                else {
+                    wprintf(L"Done, %s\n", Job->Message);
+                }
+            }
+            else {
+                if (Job->Line != 0) {
+                    fwprintf(stderr, L"Job line %d: error %d, %s\n", Job->Line, Job->Result, Job->Message);
+                }
+                else {
+                    fwprintf(stderr, L"Error %d, %s\n", Job->Result, Job->Message);
+                }
+            }
+        }
+    });
+
+    for (int i = 0; i < NumJobs; i++) {
+        if (Jobs[i].Result != APP_SUCCESS) {
+            return APP_SUCCESS - Jobs[i].Result;
+        }
+    }
+    return 0;
+}
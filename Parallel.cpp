@@ -0,0 +1,268 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// Parallel.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Worker thread helpers
+//
+// Most of the image transforms are a loop over rows (or frames) where each
+// iteration only reads the input image and writes its own part of the output
+// image.  ParallelFor() splits such a loop into contiguous bands and runs
+// each band on its own thread.  The calling thread runs the last band and
+// waits for the other threads to finish before returning.
+//
+// The body must not call any of the Win32 UI functions (MessageBox,...)
+// since it is not running on the UI thread.
+//
+// ParallelForFrames() is the same for the per frame image transforms.  Each
+// call of the body is one frame and a band of rows in that frame, so images
+// with many frames run whole frames on each thread and single frame images
+// are split into row bands.
+//
+// The number of threads is set by the WorkerThreads global setting,
+// 0 uses one thread per processor.
+//
+// When the UI thread has to wait for worker threads for a long time it
+// calls WaitProcessingMessages() so that the windows are still repainted.
+//
+// V1.3.2.1 2026-10-14  Initial release, ParallelFor
+//                      Added, WaitProcessingMessages
+//                      Added, ParallelForFrames, SetWorkerCount
+//                      Correction, ParallelForFrames when frames * rows is larger than an int
+//
+#include "framework.h"
+#include <limits.h>
+#include <thread>
+#include <vector>
+#include "Parallel.h"
+
+static int WorkerCount = 0;		// 0 - one worker per processor
+
+//*****************************************************************************************
+//
+//	GetWorkerCount
+//
+//	Number of worker threads used by ParallelFor()
+//
+// Parameters: none
+//
+//  return value:
+//  number of threads, always >= 1
+//
+//*****************************************************************************************
+int GetWorkerCount(void)
+{
+	int NumWorkers;
+
+	if (WorkerCount > 0) {
+		return WorkerCount;
+	}
+
+	NumWorkers = (int)std::thread::hardware_concurrency();
+	if (NumWorkers < 1) {
+		NumWorkers = 1;
+	}
+	return NumWorkers;
+}
+
+//*****************************************************************************************
+//
+//	SetWorkerCount
+//
+//	Set the number of worker threads used by ParallelFor()
+//	This is the WorkerThreads global setting.
+//
+// Parameters:
+//	int NumWorkers			number of threads, 0 - one per processor
+//							limited to MAX_WORKER_THREADS
+//
+//  return value: none
+//
+//*****************************************************************************************
+void SetWorkerCount(int NumWorkers)
+{
+	if (NumWorkers < 0) {
+		NumWorkers = 0;
+	}
+	if (NumWorkers > MAX_WORKER_THREADS) {
+		NumWorkers = MAX_WORKER_THREADS;
+	}
+	WorkerCount = NumWorkers;
+	return;
+}
+
+//*****************************************************************************************
+//
+//	ParallelFor
+//
+//	Run Body(BandStart, BandEnd) over the range Start to End-1 using
+//	the worker threads.  The range is split into contiguous bands, one per thread.
+//	If there is only one worker or only one iteration the Body is called directly.
+//
+// Parameters:
+//	int Start				first index in the range
+//	int End					one past the last index in the range
+//	Body					function called for each band, Body(BandStart, BandEnd)
+//							processes indexes BandStart to BandEnd-1
+//
+//  return value: none
+//
+//*****************************************************************************************
+void ParallelFor(int Start, int End, const std::function<void(int, int)>& Body)
+{
+	int Count;
+	int NumBands;
+	int BandSize;
+	int Remainder;
+	int BandStart;
+	int BandEnd;
+	std::vector<std::thread> Workers;
+
+	Count = End - Start;
+	if (Count <= 0) {
+		return;
+	}
+
+	NumBands = GetWorkerCount();
+	if (NumBands > Count) {
+		NumBands = Count;
+	}
+	if (NumBands == 1) {
+		Body(Start, End);
+		return;
+	}
+
+	BandSize = Count / NumBands;
+	Remainder = Count % NumBands;
+
+	BandStart = Start;
+	for (int Band = 0; Band < NumBands; Band++) {
+		// spread the remainder over the first bands
+		BandEnd = BandStart + BandSize + (Band < Remainder ? 1 : 0);
+		if (Band == NumBands - 1) {
+			// last band is done on this thread
+			Body(BandStart, BandEnd);
+		}
+		else {
+			try {
+				Workers.emplace_back(Body, BandStart, BandEnd);
+			}
+			catch (...) {
+				// could not start a thread, do this band here
+				Body(BandStart, BandEnd);
+			}
+		}
+		BandStart = BandEnd;
+	}
+
+	for (auto& Worker : Workers) {
+		Worker.join();
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	ParallelForFrames
+//
+//	Run Body(Frame, StartRow, EndRow) over all the rows of all the frames
+//	of an image using the worker threads.  The rows of all the frames are
+//	split into contiguous bands, a band that crosses a frame boundary is
+//	given to Body as one call per frame.  With more frames than workers
+//	most calls are whole frames, with a single frame these are row bands.
+//
+// Parameters:
+//	int NumFrames			number of frames
+//	int NumRows				number of rows in each frame, this is the loop
+//							that Body splits, normally the output image rows
+//	Body					function called for each part of a band
+//							processes rows StartRow to EndRow-1 of Frame
+//
+//  return value: none
+//
+//*****************************************************************************************
+void ParallelForFrames(int NumFrames, int NumRows, const std::function<void(int, int, int)>& Body)
+{
+	if (NumFrames <= 0 || NumRows <= 0) {
+		return;
+	}
+
+	// the bands are made of units of RowsPerUnit rows, a unit is one row
+	// unless frames * rows does not fit in an int
+	int UnitsPerFrame = INT_MAX / NumFrames;
+	if (UnitsPerFrame > NumRows) {
+		UnitsPerFrame = NumRows;
+	}
+	int RowsPerUnit = (int)(((LONGLONG)NumRows + UnitsPerFrame - 1) / UnitsPerFrame);
+	UnitsPerFrame = (int)(((LONGLONG)NumRows + RowsPerUnit - 1) / RowsPerUnit);
+
+	ParallelFor(0, NumFrames * UnitsPerFrame, [&](int StartBand, int EndBand) {
+		int Frame;
+		int StartUnit;
+		int EndUnit;
+		LONGLONG EndRow;
+
+		while (StartBand < EndBand) {
+			Frame = StartBand / UnitsPerFrame;
+			StartUnit = StartBand - Frame * UnitsPerFrame;
+			EndUnit = EndBand - Frame * UnitsPerFrame;
+			if (EndUnit > UnitsPerFrame) {
+				EndUnit = UnitsPerFrame;
+			}
+			EndRow = (LONGLONG)EndUnit * (LONGLONG)RowsPerUnit;
+			if (EndRow > NumRows) {
+				EndRow = NumRows;
+			}
+			Body(Frame, StartUnit * RowsPerUnit, (int)EndRow);
+			StartBand = Frame * UnitsPerFrame + EndUnit;
+		}
+	});
+	return;
+}
+
+//*****************************************************************************************
+//
+//	WaitProcessingMessages
+//
+//	Used by the UI thread while it is waiting for worker threads.
+//	Waits up to Timeout msec for a window message and then dispatches
+//	all pending messages so that the application windows are repainted.
+//	The caller should disable its dialog while waiting so that the user
+//	can not start another operation.
+//
+// Parameters:
+//	DWORD Timeout			maximum wait time in msec
+//
+//  return value: none
+//
+//*****************************************************************************************
+void WaitProcessingMessages(DWORD Timeout)
+{
+	MSG msg;
+
+	MsgWaitForMultipleObjects(0, NULL, FALSE, Timeout, QS_ALLINPUT);
+
+	while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+		if (msg.message == WM_QUIT) {
+			// leave it for the main message loop
+			PostQuitMessage((int)msg.wParam);
+			break;
+		}
+		TranslateMessage(&msg);
+		DispatchMessage(&msg);
+	}
+	return;
+}
@@ -0,0 +1,18 @@
+#pragma once
+//
+// Parallel.h
+// function prototypes for the worker thread helpers in Parallel.cpp
+//
+#include <functional>
+
+#define MAX_WORKER_THREADS	64		// upper limit of the WorkerThreads setting
+
+int GetWorkerCount(void);
+
+void SetWorkerCount(int NumWorkers);
+
+void ParallelFor(int Start, int End, const std::function<void(int, int)>& Body);
+
+void ParallelForFrames(int NumFrames, int NumRows, const std::function<void(int, int, int)>& Body);
+
+void WaitProcessingMessages(DWORD Timeout);
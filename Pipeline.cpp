@@ -0,0 +1,609 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// Pipeline.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Image transform pipeline
+//
+// Each image tool loads its input image file and writes its output image file.
+// An analysis that uses several transforms one after the other writes and loads
+// an intermediate image file for every step.  A pipeline runs a list of
+// transforms on an image in memory.  The image is loaded once, the steps are
+// run back to back using two image buffers that are reused (the output of one
+// step is the input of the next), and only the final result and any 'tap'
+// steps are written to image files.
+//
+// Between steps the pixels are clamped to the PixelSize of the image the same
+// way the image file writer does, so the result is the same as running the
+// image tools one at a time.
+//
+// An image that is too large to load into memory is streamed through the
+// steps a block of frames at a time (see StreamImageFile in ImageIO.cpp).
+// All the steps work on each frame independently so the result is the same.
+// This is not done when the pipeline has a tap step, a tap needs the complete
+// image.
+//
+// The pipeline is a text file with one step per line.  Blank lines and lines
+// starting with / ; or : are ignored.  The steps are:
+//
+//	fold_left  FoldColumn
+//	fold_right FoldColumn
+//	fold_down  FoldRow
+//	fold_up    FoldRow
+//	rotate     Direction			0 - counter clockwise, 1 - clockwise
+//	mirror     Direction			0 - around horizontal axis, 1 - around vertical axis
+//	convolve   KernelFile			convolution kernel text file
+//	resize     Xsize Ysize PixelSize	0 - keep the current value
+//	reorder    Xsize Ysize PixelSize Algorithm P1 P2 P3 Invert
+//	decimate   Xsize Ysize PixelSize	standard decimation (summation)
+//	replicate  Xsize Ysize
+//	math       Operation Value		0 - add, 1 - multiply, 2 - divide
+//										3 - min, 4 - max, 5 - AND, 6 - OR, 7 - XOR,
+//										8 - threshold (1 if >= Value), 9 - subtract
+//	tap        ImageFile			write the current image to an image file
+//
+// Application standardized error numbers for functions that perform transform processes:
+//      1 - success
+//      0 - parameter or image header problem
+//     -1 memory allocation failure
+//     -2 open file failure
+//     -3 file read failure
+//     -4 incorect file type
+//     -5 file sizes mismatch
+//     -6 not yet implemented
+//     -7 file write failure
+//
+// V1.3.2.1 2026-10-14  Initial release, in memory image transform pipeline
+//                      Added, ParsePipelineStep for the console front end
+//                      Changed, mirror and the rotation of a square image are done in place
+//                      Added, RunPipelineFile, streams images that are too large to load
+//                      Added, RunPipelineFile adds its load, compute and write times to the timing log
+//                      Added, math step min, max, AND, OR, XOR, threshold, subtract
+//
+#include "framework.h"
+#include <stdio.h>
+#include <wchar.h>
+#include <strsafe.h>
+#include <vector>
+#include "AppErrors.h"
+#include "ImageDialog.h"
+#include "Globals.h"
+#include "imaging.h"
+#include "ImageIO.h"
+#include "FileFunctions.h"
+#include "Pipeline.h"
+#include "Timing.h"
+
+// pipeline file keywords
+typedef struct PIPEOPERATION {
+	const WCHAR* Name;
+	int Operation;
+	int NumParams;		// # of integer parameters
+	int FileParam;		// the parameter is a filename
+} PIPEOPERATION;
+
+static const PIPEOPERATION PipeOperations[] = {
+	{ L"fold_left",		PIPE_FOLD_LEFT,		1, FALSE },
+	{ L"fold_right",	PIPE_FOLD_RIGHT,	1, FALSE },
+	{ L"fold_down",		PIPE_FOLD_DOWN,		1, FALSE },
+	{ L"fold_up",		PIPE_FOLD_UP,		1, FALSE },
+	{ L"rotate",		PIPE_ROTATE,		1, FALSE },
+	{ L"mirror",		PIPE_MIRROR,		1, FALSE },
+	{ L"convolve",		PIPE_CONVOLVE,		0, TRUE },
+	{ L"resize",		PIPE_RESIZE,		3, FALSE },
+	{ L"reorder",		PIPE_REORDER,		8, FALSE },
+	{ L"decimate",		PIPE_DECIMATE,		3, FALSE },
+	{ L"replicate",		PIPE_REPLICATE,		2, FALSE },
+	{ L"math",			PIPE_MATH,			2, FALSE },
+	{ L"tap",			PIPE_TAP,			0, TRUE },
+};
+
+//*******************************************************************************
+//
+// ParsePipelineLine
+//
+// Private function for ParsePipelineStep()
+//
+// Parse one pipeline file line into a pipeline step.
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+static int ParsePipelineLine(WCHAR* Line, PIPELINESTEP* Step)
+{
+	WCHAR Keyword[32];
+	WCHAR* Rest;
+	const PIPEOPERATION* Op = NULL;
+	int Length;
+	int iRes;
+
+	// keyword
+	while (*Line && iswspace(*Line)) {
+		Line++;
+	}
+	for (Length = 0; Line[Length] && !iswspace(Line[Length]); Length++) {
+		if (Length >= 31) {
+			return APPERR_PARAMETER;
+		}
+		Keyword[Length] = towlower(Line[Length]);
+	}
+	Keyword[Length] = 0;
+	Rest = Line + Length;
+
+	for (int i = 0; i < sizeof(PipeOperations) / sizeof(PipeOperations[0]); i++) {
+		if (wcscmp(Keyword, PipeOperations[i].Name) == 0) {
+			Op = &PipeOperations[i];
+			break;
+		}
+	}
+	if (Op == NULL) {
+		return APPERR_PARAMETER;
+	}
+	Step->Operation = Op->Operation;
+
+	if (Op->FileParam) {
+		// the rest of the line is the filename, filenames may contain spaces
+		while (*Rest && iswspace(*Rest)) {
+			Rest++;
+		}
+		Length = (int)wcslen(Rest);
+		while (Length > 0 && iswspace(Rest[Length - 1])) {
+			Length--;
+		}
+		if (Length == 0 || Length >= MAX_PATH) {
+			return APPERR_PARAMETER;
+		}
+		wcsncpy_s(Step->Filename, MAX_PATH, Rest, Length);
+		return APP_SUCCESS;
+	}
+
+	int* P = Step->Param;
+	iRes = swscanf_s(Rest, L"%d %d %d %d %d %d %d %d", &P[0], &P[1], &P[2], &P[3], &P[4], &P[5], &P[6], &P[7]);
+	if (iRes < Op->NumParams) {
+		return APPERR_PARAMETER;
+	}
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+// ParsePipelineStep
+//
+// Parse one pipeline step, using the same syntax as a line in a pipeline
+// file.  The convolution kernel of a convolve step is loaded.
+//
+// Parameters:
+//	WCHAR* Line				pipeline step text
+//	PIPELINESTEP* Step		returned step, release the kernel with FreePipeline()
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int ParsePipelineStep(WCHAR* Line, PIPELINESTEP* Step)
+{
+	int iRes;
+
+	memset(Step, 0, sizeof(PIPELINESTEP));
+
+	iRes = ParsePipelineLine(Line, Step);
+	if (iRes == APP_SUCCESS && Step->Operation == PIPE_CONVOLVE) {
+		iRes = ReadConvolutionKernel(Step->Filename, &Step->Kernel, &Step->KernelXsize, &Step->KernelYsize);
+	}
+	return iRes;
+}
+
+//*******************************************************************************
+//
+// ReadPipelineFile
+//
+// Read a pipeline text file into a list of pipeline steps.  The convolution
+// kernels used by the pipeline are loaded when the file is read so that a
+// bad kernel file is reported before any processing is done.
+//
+// Parameters:
+//	WCHAR* PipelineFile				pipeline text file
+//	std::vector<PIPELINESTEP>& Steps	returned steps, release with FreePipeline()
+//	int* ErrorLine					line # of the step that could not be read
+//									0 if the file could not be read
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int ReadPipelineFile(WCHAR* PipelineFile, std::vector<PIPELINESTEP>& Steps, int* ErrorLine)
+{
+	FILE* In;
+	errno_t ErrNum;
+	WCHAR Line[MAX_PATH + 64];
+	int iLine = 0;
+	int iRes;
+
+	*ErrorLine = 0;
+	Steps.clear();
+
+	ErrNum = _wfopen_s(&In, PipelineFile, L"r");
+	if (In == NULL) {
+		return APPERR_FILEOPEN;
+	}
+
+	while (fgetws(Line, MAX_PATH + 64, In) != NULL) {
+		iLine++;
+		if (StringBlankorComnent(Line, MAX_PATH + 64)) {
+			continue;
+		}
+
+		PIPELINESTEP Step;
+		iRes = ParsePipelineStep(Line, &Step);
+		if (iRes != APP_SUCCESS) {
+			fclose(In);
+			FreePipeline(Steps);
+			*ErrorLine = iLine;
+			return iRes;
+		}
+		Step.Line = iLine;
+		Steps.push_back(Step);
+	}
+	fclose(In);
+
+	if (Steps.empty()) {
+		return APPERR_PARAMETER;
+	}
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+// FreePipeline
+//
+// Release the pipeline steps read by ReadPipelineFile()
+//
+//*******************************************************************************
+void FreePipeline(std::vector<PIPELINESTEP>& Steps)
+{
+	for (size_t i = 0; i < Steps.size(); i++) {
+		if (Steps[i].Kernel) {
+			delete[] Steps[i].Kernel;
+			Steps[i].Kernel = NULL;
+		}
+	}
+	Steps.clear();
+	return;
+}
+
+//*******************************************************************************
+//
+// RunPipelineSteps
+//
+// Run the pipeline steps on an image in memory.  The result replaces the
+// image in Image.  A second image buffer is used for the output of each step
+// and the two buffers are swapped after each step, the buffers are only
+// reallocated when a step makes the image larger.  Mirror and the rotation
+// of a square image are done in place.
+//
+// Parameters:
+//	std::vector<PIPELINESTEP>& Steps	steps to run
+//	IMAGEBUFFER* Image				input image, replaced by the result
+//	int* ErrorStep					index of the step that failed
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int RunPipelineSteps(std::vector<PIPELINESTEP>& Steps, IMAGEBUFFER* Image, int* ErrorStep)
+{
+	IMAGEBUFFER Work = { 0 };
+	IMAGEBUFFER Swap;
+	int ArithmeticFlag;
+	int iRes = APP_SUCCESS;
+
+	*ErrorStep = 0;
+
+	for (size_t i = 0; i < Steps.size(); i++) {
+		PIPELINESTEP* Step = &Steps[i];
+		int* P = Step->Param;
+		BOOL InPlace = FALSE;
+
+		switch (Step->Operation) {
+		case PIPE_FOLD_LEFT:
+			iRes = FoldImageLeftBuffer(Image, &Work, P[0]);
+			break;
+
+		case PIPE_FOLD_RIGHT:
+			iRes = FoldImageRightBuffer(Image, &Work, P[0]);
+			break;
+
+		case PIPE_FOLD_DOWN:
+			iRes = FoldImageDownBuffer(Image, &Work, P[0]);
+			break;
+
+		case PIPE_FOLD_UP:
+			iRes = FoldImageUpBuffer(Image, &Work, P[0]);
+			break;
+
+		case PIPE_ROTATE:
+			if (Image->Header.Xsize == Image->Header.Ysize) {
+				// a square image is rotated in place
+				iRes = RotateImageBuffer(Image, Image, P[0]);
+				InPlace = TRUE;
+			}
+			else {
+				iRes = RotateImageBuffer(Image, &Work, P[0]);
+			}
+			break;
+
+		case PIPE_MIRROR:
+			// mirrored in place
+			iRes = MirrorImageBuffer(Image, Image, P[0]);
+			InPlace = TRUE;
+			break;
+
+		case PIPE_CONVOLVE:
+			iRes = ConvolveImageBuffer(Image, &Work, Step->Kernel, Step->KernelXsize, Step->KernelYsize);
+			break;
+
+		case PIPE_RESIZE:
+			iRes = ResizeImageBuffer(Image, &Work, P[0], P[1], P[2]);
+			break;
+
+		case PIPE_REORDER:
+			iRes = ReorderAlgBuffer(Image, &Work, P[0], P[1], P[2], P[3], P[4], P[5], P[6], P[7]);
+			break;
+
+		case PIPE_DECIMATE:
+			iRes = StdDecimateImageBuffer(Image, &Work, P[0], P[1], P[2]);
+			break;
+
+		case PIPE_REPLICATE:
+			iRes = ReplicateImageBuffer(Image, &Work, P[0], P[1]);
+			break;
+
+		case PIPE_MATH:
+			iRes = MathConstantImageBuffer(Image, &Work, P[1], P[0], FALSE, &ArithmeticFlag);
+			break;
+
+		case PIPE_TAP:
+			// intermediate result, the image is not changed
+			iRes = SaveImageBuffer(Step->Filename, Image);
+			if (iRes != APP_SUCCESS) {
+				*ErrorStep = (int)i;
+				FreeImageBuffer(&Work);
+				return iRes;
+			}
+			continue;
+
+		default:
+			iRes = APPERR_PARAMETER;
+			break;
+		}
+
+		if (iRes != APP_SUCCESS) {
+			*ErrorStep = (int)i;
+			FreeImageBuffer(&Work);
+			return iRes;
+		}
+
+		if (InPlace) {
+			// the pixels were only moved, Image is still clamped
+			continue;
+		}
+
+		// the output of this step is the input of the next
+		ClampImageBuffer(&Work);
+		Swap = *Image;
+		*Image = Work;
+		Work = Swap;
+	}
+
+	FreeImageBuffer(&Work);
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+// RunPipelineFile
+//
+// Run the pipeline steps on an image file and write the result to an image
+// file.  If the image is too large to load (see StreamFramesPerBlock) and the
+// pipeline has no tap step the image is streamed through the steps a block of
+// frames at a time.
+//
+// Parameters:
+//	std::vector<PIPELINESTEP>& Steps	steps to run
+//	WCHAR* InputFile				input image file
+//	WCHAR* OutputFile				output image file
+//	int* ErrorStep					index of the step that failed,
+//									PIPE_ERROR_LOAD - input image could not be read
+//									PIPE_ERROR_WRITE - output image could not be written
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int RunPipelineFile(std::vector<PIPELINESTEP>& Steps, WCHAR* InputFile, WCHAR* OutputFile, int* ErrorStep)
+{
+	IMAGEBUFFER Image = { 0 };
+	IMAGINGHEADER Header;
+	FILE* In;
+	int FramesPerBlock = 0;
+	int StepResult = APP_SUCCESS;
+	OPTIMING Timing = { 0.0, 0.0, 0.0, 0.0 };
+	ULONGLONG NumPixels;
+	LONGLONG Start;
+	LONGLONG Mark;
+	LONGLONG Now;
+	int iRes;
+
+	*ErrorStep = PIPE_ERROR_LOAD;
+	Start = TimerNow();
+
+	// check the size of the image to decide if it is streamed
+	_wfopen_s(&In, InputFile, L"rb");
+	if (In != NULL) {
+		if (fread(&Header, sizeof(IMAGINGHEADER), 1, In) == 1 && ValidateLoadHeader(&Header) == APP_SUCCESS) {
+			FramesPerBlock = StreamFramesPerBlock(&Header);
+		}
+		fclose(In);
+	}
+	for (size_t i = 0; i < Steps.size(); i++) {
+		if (Steps[i].Operation == PIPE_TAP) {
+			FramesPerBlock = 0;
+		}
+	}
+
+	if (FramesPerBlock == 0) {
+		iRes = LoadImageBuffer(&Image, InputFile);
+		if (iRes != APP_SUCCESS) {
+			return iRes;
+		}
+		NumPixels = (ULONGLONG)Image.Header.Xsize * (ULONGLONG)Image.Header.Ysize *
+			(ULONGLONG)Image.Header.NumFrames;
+		Mark = TimerNow();
+		Timing.Load = TimerSeconds(Start, Mark);
+
+		iRes = RunPipelineSteps(Steps, &Image, ErrorStep);
+		if (iRes != APP_SUCCESS) {
+			FreeImageBuffer(&Image);
+			return iRes;
+		}
+		Now = TimerNow();
+		Timing.Compute = TimerSeconds(Mark, Now);
+		Mark = Now;
+
+		iRes = SaveImageBuffer(OutputFile, &Image);
+		FreeImageBuffer(&Image);
+		if (iRes != APP_SUCCESS) {
+			*ErrorStep = PIPE_ERROR_WRITE;
+			return iRes;
+		}
+		if (TimingEnabled()) {
+			Now = TimerNow();
+			Timing.Write = TimerSeconds(Mark, Now);
+			Timing.Total = TimerSeconds(Start, Now);
+			LogOperationTiming(L"Pipeline", InputFile, NumPixels, &Timing);
+		}
+		return iRes;
+	}
+
+	// the result of the steps replaces the block, hand it back as the output
+	// the reads and writes overlap the steps, only the steps are timed
+	NumPixels = 0;
+	iRes = StreamImageFile<int>(InputFile, OutputFile, FramesPerBlock,
+		[&](IMAGEBUFFER* BlockIn, IMAGEBUFFER* BlockOut) -> int {
+			IMAGEBUFFER Swap;
+			LONGLONG BlockStart = TimerNow();
+
+			NumPixels += (ULONGLONG)BlockIn->Header.Xsize * (ULONGLONG)BlockIn->Header.Ysize *
+				(ULONGLONG)BlockIn->Header.NumFrames;
+			StepResult = RunPipelineSteps(Steps, BlockIn, ErrorStep);
+			Timing.Compute += TimerSeconds(BlockStart, TimerNow());
+			if (StepResult != APP_SUCCESS) {
+				return StepResult;
+			}
+			Swap = *BlockOut;
+			*BlockOut = *BlockIn;
+			*BlockIn = Swap;
+			return APP_SUCCESS;
+		}, NULL);
+	if (iRes != APP_SUCCESS && StepResult == APP_SUCCESS) {
+		if (iRes == APPERR_FILEOPEN || iRes == APPERR_FILEWRITE) {
+			*ErrorStep = PIPE_ERROR_WRITE;
+		}
+		else {
+			*ErrorStep = PIPE_ERROR_LOAD;
+		}
+	}
+	if (iRes == APP_SUCCESS && TimingEnabled()) {
+		Timing.Load = -1.0;
+		Timing.Write = -1.0;
+		Timing.Total = TimerSeconds(Start, TimerNow());
+		LogOperationTiming(L"Pipeline", InputFile, NumPixels, &Timing);
+	}
+	return iRes;
+}
+
+//*******************************************************************************
+//
+// RunPipeline
+//
+// Run a pipeline file on an image file and write the result to an image file.
+//
+// Parameters:
+//	HWND hDlg				Handle of calling window or dialog
+//	WCHAR* PipelineFile		pipeline text file
+//	WCHAR* InputFile		input image file
+//	WCHAR* OutputFile		output image file
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int RunPipeline(HWND hDlg, WCHAR* PipelineFile, WCHAR* InputFile, WCHAR* OutputFile)
+{
+	std::vector<PIPELINESTEP> Steps;
+	WCHAR szString[MAX_PATH + 64];
+	int ErrorLine;
+	int ErrorStep;
+	int iRes;
+
+	iRes = ReadPipelineFile(PipelineFile, Steps, &ErrorLine);
+	if (iRes != APP_SUCCESS) {
+		if (iRes == APPERR_FILEOPEN && ErrorLine == 0) {
+			MessageBox(hDlg, L"Could not open pipeline file", L"File I/O", MB_OK);
+		}
+		else if (ErrorLine == 0) {
+			MessageBox(hDlg, L"Pipeline file has no steps", L"Pipeline", MB_OK);
+		}
+		else {
+			StringCchPrintf(szString, MAX_PATH + 64, L"Pipeline file error in line %d", ErrorLine);
+			MessageBox(hDlg, szString, L"Pipeline", MB_OK);
+		}
+		return iRes;
+	}
+
+	iRes = RunPipelineFile(Steps, InputFile, OutputFile, &ErrorStep);
+	if (iRes != APP_SUCCESS) {
+		if (ErrorStep == PIPE_ERROR_LOAD) {
+			MessageBox(hDlg, L"Could not load input image", L"File I/O error", MB_OK);
+		}
+		else if (ErrorStep == PIPE_ERROR_WRITE) {
+			MessageBox(hDlg, L"Could not write output file", L"File I/O", MB_OK);
+		}
+		else {
+			StringCchPrintf(szString, MAX_PATH + 64, L"Pipeline step in line %d failed, error %d",
+				Steps[ErrorStep].Line, iRes);
+			MessageBox(hDlg, szString, L"Pipeline", MB_OK);
+		}
+		FreePipeline(Steps);
+		return iRes;
+	}
+	FreePipeline(Steps);
+
+	// the result is displayed from the file, only the displayed frame is loaded
+	if (DisplayResults) {
+		DisplayImage(OutputFile);
+	}
+
+	return APP_SUCCESS;
+}
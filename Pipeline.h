@@ -0,0 +1,50 @@
+#pragma once
+//
+// Pipeline.h
+// function prototypes for the image transform pipeline in Pipeline.cpp
+//
+#include <vector>
+
+// pipeline step operations
+#define PIPE_FOLD_LEFT		1
+#define PIPE_FOLD_RIGHT		2
+#define PIPE_FOLD_DOWN		3
+#define PIPE_FOLD_UP		4
+#define PIPE_ROTATE			5
+#define PIPE_MIRROR			6
+#define PIPE_CONVOLVE		7
+#define PIPE_RESIZE			8
+#define PIPE_REORDER		9
+#define PIPE_DECIMATE		10
+#define PIPE_REPLICATE		11
+#define PIPE_MATH			12
+#define PIPE_TAP			13
+
+#define PIPE_MAXPARAMS		8
+
+// RunPipelineFile ErrorStep when the failure is not in a step
+#define PIPE_ERROR_LOAD		-1
+#define PIPE_ERROR_WRITE	-2
+
+// one step of a pipeline, read from a pipeline text file
+typedef struct PIPELINESTEP {
+	int Operation;					// PIPE_xxx
+	int Param[PIPE_MAXPARAMS];		// integer parameters of the operation
+	WCHAR Filename[MAX_PATH];		// PIPE_CONVOLVE kernel file, PIPE_TAP output file
+	float* Kernel;					// PIPE_CONVOLVE kernel, released by FreePipeline()
+	int KernelXsize;
+	int KernelYsize;
+	int Line;						// line # in the pipeline file
+} PIPELINESTEP;
+
+int ParsePipelineStep(WCHAR* Line, PIPELINESTEP* Step);
+
+int ReadPipelineFile(WCHAR* PipelineFile, std::vector<PIPELINESTEP>& Steps, int* ErrorLine);
+
+void FreePipeline(std::vector<PIPELINESTEP>& Steps);
+
+int RunPipelineSteps(std::vector<PIPELINESTEP>& Steps, IMAGEBUFFER* Image, int* ErrorStep);
+
+int RunPipelineFile(std::vector<PIPELINESTEP>& Steps, WCHAR* InputFile, WCHAR* OutputFile, int* ErrorStep);
+
+int RunPipeline(HWND hDlg, WCHAR* PipelineFile, WCHAR* InputFile, WCHAR* OutputFile);
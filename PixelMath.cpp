@@ -0,0 +1,598 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// PixelMath.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Element-wise pixel math kernels used by AddSubtractImages(), ImageMath(),
+// AddSubtractKernel() and MathConstant2Image()
+//
+// Each kernel combines a row of pixels with a second row of pixels or with
+// a constant: add, subtract, multiply, divide, minimum, maximum, AND, OR,
+// XOR and threshold (1 if pixel >= operand, otherwise 0).
+//
+// The arithmetic saturates, results < 0 are set to 0 and results larger
+// than the pixel type can hold are set to its largest value.  The kernels
+// return 1 when any result was clipped so the callers can warn about an
+// underflow or overflow.  For 'int' pixels a smaller maximum (the PixelSize
+// of the image file) can be given that only sets the warning, the 'int'
+// result is not clipped at it since the writer clamps the pixels anyway.
+//
+// 16 bytes of pixels are done at a time in SSE2 registers, the saturating
+// add and subtract of BYTE and USHORT pixels are single instructions.
+// SSE2 has no integer divide and no 32 bit multiply, division and the
+// multiply of 'int' pixels are done one pixel at a time, as are the pixels
+// left over at the end of the row.
+//
+// The kernels are single threaded, the callers split the image into bands.
+//
+// V1.3.2.1 2026-10-14  Initial release, SSE2 element-wise pixel math kernels
+//                      Changed, PixelMathConstant keeps negative constants on the SSE2 path
+//
+#include "framework.h"
+#include <emmintrin.h>
+#include <limits.h>
+#include "PixelMath.h"
+
+template <typename PIXELTYPE>
+static inline LONGLONG PixelTypeMax(void);
+
+template <typename PIXELTYPE>
+static inline PIXELTYPE ScalarPixelMath(int Operation, LONGLONG A, LONGLONG B, LONGLONG WarnMax, int* Clipped);
+
+template <int OPERATION>
+static inline __m128i VectorPixelMath(const BYTE*, __m128i A, __m128i B, __m128i& Clip, __m128i WarnMax);
+
+template <int OPERATION>
+static inline __m128i VectorPixelMath(const USHORT*, __m128i A, __m128i B, __m128i& Clip, __m128i WarnMax);
+
+template <int OPERATION>
+static inline __m128i VectorPixelMath(const int*, __m128i A, __m128i B, __m128i& Clip, __m128i WarnMax);
+
+template <int OPERATION, typename PIXELTYPE>
+static size_t VectorLoop(const PIXELTYPE* A, const PIXELTYPE* B, __m128i Constant, PIXELTYPE* Out,
+	size_t NumPixels, __m128i WarnMax, __m128i& Clip);
+
+template <typename PIXELTYPE>
+static size_t VectorPixelMathLoop(int Operation, const PIXELTYPE* A, const PIXELTYPE* B, __m128i Constant,
+	PIXELTYPE* Out, size_t NumPixels, __m128i WarnMax, __m128i& Clip);
+
+static inline __m128i SetPixels(const BYTE*, int Value);
+static inline __m128i SetPixels(const USHORT*, int Value);
+static inline __m128i SetPixels(const int*, int Value);
+
+//*****************************************************************************************
+//
+//	PixelMath
+//
+//	Out[i] = A[i] Operation B[i]
+//
+// Parameters:
+//	int Operation			PIXELMATH_ADD ... PIXELMATH_SUBTRACT, see PixelMath.h
+//	const PIXELTYPE* A		first operand
+//	const PIXELTYPE* B		second operand
+//	PIXELTYPE* Out			result, may be A or B
+//	size_t NumPixels		number of pixels
+//	int WarnMax				'int' pixels, results larger than this set the return value
+//							BYTE and USHORT pixels use the largest value of the type
+//
+//  return value:
+//  0 - no result was clipped
+//  1 - at least one result was < 0, larger than WarnMax or divided by 0
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+int PixelMath(int Operation, const PIXELTYPE* A, const PIXELTYPE* B, PIXELTYPE* Out, size_t NumPixels, int WarnMax)
+{
+	__m128i Clip = _mm_setzero_si128();
+	int Clipped = 0;
+	size_t i;
+
+	if (sizeof(PIXELTYPE) < sizeof(int)) {
+		WarnMax = (int)PixelTypeMax<PIXELTYPE>();
+	}
+
+	i = VectorPixelMathLoop(Operation, A, B, _mm_setzero_si128(), Out, NumPixels, _mm_set1_epi32(WarnMax), Clip);
+	for (; i < NumPixels; i++) {
+		Out[i] = ScalarPixelMath<PIXELTYPE>(Operation, A[i], B[i], WarnMax, &Clipped);
+	}
+
+	if (_mm_movemask_epi8(_mm_cmpeq_epi8(Clip, _mm_setzero_si128())) != 0xFFFF) {
+		Clipped = 1;
+	}
+	return Clipped;
+}
+
+//*****************************************************************************************
+//
+//	PixelMathConstant
+//
+//	Out[i] = A[i] Operation Value
+//
+// Parameters:
+//	int Operation			PIXELMATH_ADD ... PIXELMATH_SUBTRACT, see PixelMath.h
+//	const PIXELTYPE* A		first operand
+//	int Value				second operand
+//	PIXELTYPE* Out			result, may be A
+//	size_t NumPixels		number of pixels
+//	int WarnMax				'int' pixels, results larger than this set the return value
+//							BYTE and USHORT pixels use the largest value of the type
+//
+//  return value:
+//  0 - no result was clipped
+//  1 - at least one result was < 0, larger than WarnMax or divided by 0
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+int PixelMathConstant(int Operation, const PIXELTYPE* A, int Value, PIXELTYPE* Out, size_t NumPixels, int WarnMax)
+{
+	__m128i Clip = _mm_setzero_si128();
+	int Clipped = 0;
+	size_t i = 0;
+
+	if (sizeof(PIXELTYPE) < sizeof(int)) {
+		WarnMax = (int)PixelTypeMax<PIXELTYPE>();
+	}
+
+	// adding a negative constant to a BYTE or USHORT pixel is subtracting
+	// it, the unsigned lanes only hold values >= 0
+	if (sizeof(PIXELTYPE) < sizeof(int) && Value < 0 && -(LONGLONG)Value <= PixelTypeMax<PIXELTYPE>()) {
+		if (Operation == PIXELMATH_ADD) {
+			Operation = PIXELMATH_SUBTRACT;
+			Value = -Value;
+		}
+		else if (Operation == PIXELMATH_SUBTRACT) {
+			Operation = PIXELMATH_ADD;
+			Value = -Value;
+		}
+	}
+
+	// an 'int' lane holds any constant, a constant that does not fit in a
+	// BYTE or USHORT lane is done one pixel at a time
+	if (sizeof(PIXELTYPE) == sizeof(int) || (Value >= 0 && (LONGLONG)Value <= PixelTypeMax<PIXELTYPE>())) {
+		i = VectorPixelMathLoop(Operation, A, (const PIXELTYPE*)NULL, SetPixels(A, Value), Out, NumPixels,
+			_mm_set1_epi32(WarnMax), Clip);
+	}
+	for (; i < NumPixels; i++) {
+		Out[i] = ScalarPixelMath<PIXELTYPE>(Operation, A[i], Value, WarnMax, &Clipped);
+	}
+
+	if (_mm_movemask_epi8(_mm_cmpeq_epi8(Clip, _mm_setzero_si128())) != 0xFFFF) {
+		Clipped = 1;
+	}
+	return Clipped;
+}
+
+//*****************************************************************************************
+//
+//	PixelTypeMax
+//
+//	Private function, the largest value of a pixel type
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+static inline LONGLONG PixelTypeMax(void)
+{
+	if (sizeof(PIXELTYPE) == 1) {
+		return 255;
+	}
+	if (sizeof(PIXELTYPE) == 2) {
+		return 65535;
+	}
+	return INT_MAX;
+}
+
+//*****************************************************************************************
+//
+//	ScalarPixelMath
+//
+//	Private function, one pixel of an operation.  The operands are widened
+//	so the result can be checked before it is saturated.
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+static inline PIXELTYPE ScalarPixelMath(int Operation, LONGLONG A, LONGLONG B, LONGLONG WarnMax, int* Clipped)
+{
+	const LONGLONG MaxValue = PixelTypeMax<PIXELTYPE>();
+	LONGLONG Result;
+
+	switch (Operation) {
+	case PIXELMATH_ADD:
+		Result = A + B;
+		break;
+
+	case PIXELMATH_SUBTRACT:
+		Result = A - B;
+		break;
+
+	case PIXELMATH_MULTIPLY:
+		Result = A * B;
+		break;
+
+	case PIXELMATH_DIVIDE:
+		// division by 0 saturates
+		if (B == 0) {
+			Result = (A > 0) ? MaxValue + 1 : 0;
+		}
+		else {
+			Result = A / B;
+		}
+		break;
+
+	case PIXELMATH_MIN:
+		Result = (A < B) ? A : B;
+		break;
+
+	case PIXELMATH_MAX:
+		Result = (A > B) ? A : B;
+		break;
+
+	case PIXELMATH_AND:
+		Result = (int)A & (int)B;
+		break;
+
+	case PIXELMATH_OR:
+		Result = (int)A | (int)B;
+		break;
+
+	case PIXELMATH_XOR:
+		Result = (int)A ^ (int)B;
+		break;
+
+	case PIXELMATH_THRESHOLD:
+		Result = (A >= B) ? 1 : 0;
+		break;
+
+	default:
+		Result = 0;
+		break;
+	}
+
+	if (Result < 0) {
+		*Clipped = 1;
+		return 0;
+	}
+	if (Result > WarnMax) {
+		*Clipped = 1;
+		if (Result > MaxValue) {
+			Result = MaxValue;
+		}
+	}
+	return (PIXELTYPE)Result;
+}
+
+//*****************************************************************************************
+//
+//	VectorPixelMath
+//
+//	Private function, 16 bytes of pixels of an operation.  Bits that are set
+//	in Clip mark a result that was saturated.  The operation is a template
+//	parameter so the switch is resolved at compile time.
+//
+//*****************************************************************************************
+// 16 BYTE pixels
+template <int OPERATION>
+static inline __m128i VectorPixelMath(const BYTE*, __m128i A, __m128i B, __m128i& Clip, __m128i WarnMax)
+{
+	const __m128i Zero = _mm_setzero_si128();
+	__m128i Result;
+
+	UNREFERENCED_PARAMETER(WarnMax);
+	switch (OPERATION) {
+	case PIXELMATH_ADD:
+		// the saturated sum differs from the wrapped sum when it overflowed
+		Result = _mm_adds_epu8(A, B);
+		Clip = _mm_or_si128(Clip, _mm_xor_si128(Result, _mm_add_epi8(A, B)));
+		break;
+
+	case PIXELMATH_SUBTRACT:
+		Result = _mm_subs_epu8(A, B);
+		Clip = _mm_or_si128(Clip, _mm_xor_si128(Result, _mm_sub_epi8(A, B)));
+		break;
+
+	case PIXELMATH_MULTIPLY:
+	{
+		// 16 bit products, a product > 255 has bits set in its high byte
+		const __m128i Max = _mm_set1_epi16(255);
+		__m128i ProductLo = _mm_mullo_epi16(_mm_unpacklo_epi8(A, Zero), _mm_unpacklo_epi8(B, Zero));
+		__m128i ProductHi = _mm_mullo_epi16(_mm_unpackhi_epi8(A, Zero), _mm_unpackhi_epi8(B, Zero));
+		__m128i OverLo = _mm_srli_epi16(ProductLo, 8);
+		__m128i OverHi = _mm_srli_epi16(ProductHi, 8);
+		__m128i InRangeLo = _mm_cmpeq_epi16(OverLo, Zero);
+		__m128i InRangeHi = _mm_cmpeq_epi16(OverHi, Zero);
+
+		ProductLo = _mm_or_si128(_mm_and_si128(InRangeLo, ProductLo), _mm_andnot_si128(InRangeLo, Max));
+		ProductHi = _mm_or_si128(_mm_and_si128(InRangeHi, ProductHi), _mm_andnot_si128(InRangeHi, Max));
+		Result = _mm_packus_epi16(ProductLo, ProductHi);
+		Clip = _mm_or_si128(Clip, _mm_or_si128(OverLo, OverHi));
+		break;
+	}
+
+	case PIXELMATH_MIN:
+		Result = _mm_min_epu8(A, B);
+		break;
+
+	case PIXELMATH_MAX:
+		Result = _mm_max_epu8(A, B);
+		break;
+
+	case PIXELMATH_AND:
+		Result = _mm_and_si128(A, B);
+		break;
+
+	case PIXELMATH_OR:
+		Result = _mm_or_si128(A, B);
+		break;
+
+	case PIXELMATH_XOR:
+		Result = _mm_xor_si128(A, B);
+		break;
+
+	case PIXELMATH_THRESHOLD:
+		// A >= B when max(A,B) is A
+		Result = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(A, B), A), _mm_set1_epi8(1));
+		break;
+
+	default:
+		Result = A;
+		break;
+	}
+	return Result;
+}
+
+// 8 USHORT pixels
+template <int OPERATION>
+static inline __m128i VectorPixelMath(const USHORT*, __m128i A, __m128i B, __m128i& Clip, __m128i WarnMax)
+{
+	// SSE2 only has signed 16 bit compare, min and max, the pixels are
+	// biased by 0x8000 for these
+	const __m128i Bias = _mm_set1_epi16((short)0x8000);
+	const __m128i Zero = _mm_setzero_si128();
+	__m128i Result;
+
+	UNREFERENCED_PARAMETER(WarnMax);
+	switch (OPERATION) {
+	case PIXELMATH_ADD:
+		Result = _mm_adds_epu16(A, B);
+		Clip = _mm_or_si128(Clip, _mm_xor_si128(Result, _mm_add_epi16(A, B)));
+		break;
+
+	case PIXELMATH_SUBTRACT:
+		Result = _mm_subs_epu16(A, B);
+		Clip = _mm_or_si128(Clip, _mm_xor_si128(Result, _mm_sub_epi16(A, B)));
+		break;
+
+	case PIXELMATH_MULTIPLY:
+	{
+		// the high 16 bits of the product are not 0 when it overflowed
+		__m128i ProductHi = _mm_mulhi_epu16(A, B);
+		__m128i InRange = _mm_cmpeq_epi16(ProductHi, Zero);
+
+		Result = _mm_or_si128(_mm_mullo_epi16(A, B), _mm_xor_si128(InRange, _mm_cmpeq_epi16(Zero, Zero)));
+		Clip = _mm_or_si128(Clip, ProductHi);
+		break;
+	}
+
+	case PIXELMATH_MIN:
+		Result = _mm_xor_si128(_mm_min_epi16(_mm_xor_si128(A, Bias), _mm_xor_si128(B, Bias)), Bias);
+		break;
+
+	case PIXELMATH_MAX:
+		Result = _mm_xor_si128(_mm_max_epi16(_mm_xor_si128(A, Bias), _mm_xor_si128(B, Bias)), Bias);
+		break;
+
+	case PIXELMATH_AND:
+		Result = _mm_and_si128(A, B);
+		break;
+
+	case PIXELMATH_OR:
+		Result = _mm_or_si128(A, B);
+		break;
+
+	case PIXELMATH_XOR:
+		Result = _mm_xor_si128(A, B);
+		break;
+
+	case PIXELMATH_THRESHOLD:
+		// A >= B when B > A is false
+		Result = _mm_andnot_si128(_mm_cmpgt_epi16(_mm_xor_si128(B, Bias), _mm_xor_si128(A, Bias)),
+			_mm_set1_epi16(1));
+		break;
+
+	default:
+		Result = A;
+		break;
+	}
+	return Result;
+}
+
+// 4 'int' pixels
+template <int OPERATION>
+static inline __m128i VectorPixelMath(const int*, __m128i A, __m128i B, __m128i& Clip, __m128i WarnMax)
+{
+	const __m128i IntMax = _mm_set1_epi32(INT_MAX);
+	__m128i Result;
+
+	switch (OPERATION) {
+	case PIXELMATH_ADD:
+	case PIXELMATH_SUBTRACT:
+	{
+		// a signed overflow saturates towards the sign of A, the
+		// negative side is then set to 0 below
+		__m128i Overflow;
+		if (OPERATION == PIXELMATH_ADD) {
+			Result = _mm_add_epi32(A, B);
+			Overflow = _mm_and_si128(_mm_xor_si128(A, Result), _mm_xor_si128(B, Result));
+		}
+		else {
+			Result = _mm_sub_epi32(A, B);
+			Overflow = _mm_and_si128(_mm_xor_si128(A, B), _mm_xor_si128(A, Result));
+		}
+		Overflow = _mm_srai_epi32(Overflow, 31);
+		Result = _mm_or_si128(_mm_and_si128(Overflow, _mm_andnot_si128(_mm_srai_epi32(A, 31), IntMax)),
+			_mm_andnot_si128(Overflow, Result));
+		Clip = _mm_or_si128(Clip, Overflow);
+		break;
+	}
+
+	case PIXELMATH_MIN:
+	{
+		__m128i Greater = _mm_cmpgt_epi32(A, B);
+		Result = _mm_or_si128(_mm_and_si128(Greater, B), _mm_andnot_si128(Greater, A));
+		break;
+	}
+
+	case PIXELMATH_MAX:
+	{
+		__m128i Greater = _mm_cmpgt_epi32(A, B);
+		Result = _mm_or_si128(_mm_and_si128(Greater, A), _mm_andnot_si128(Greater, B));
+		break;
+	}
+
+	case PIXELMATH_AND:
+		Result = _mm_and_si128(A, B);
+		break;
+
+	case PIXELMATH_OR:
+		Result = _mm_or_si128(A, B);
+		break;
+
+	case PIXELMATH_XOR:
+		Result = _mm_xor_si128(A, B);
+		break;
+
+	case PIXELMATH_THRESHOLD:
+		Result = _mm_andnot_si128(_mm_cmpgt_epi32(B, A), _mm_set1_epi32(1));
+		break;
+
+	default:
+		Result = A;
+		break;
+	}
+
+	// results < 0 are set to 0
+	__m128i Negative = _mm_srai_epi32(Result, 31);
+	Clip = _mm_or_si128(Clip, _mm_or_si128(Negative, _mm_cmpgt_epi32(Result, WarnMax)));
+	return _mm_andnot_si128(Negative, Result);
+}
+
+//*****************************************************************************************
+//
+//	VectorLoop
+//
+//	Private function, an operation on the pixels that fill whole SSE2
+//	registers.  B is NULL to use Constant as the second operand.
+//
+//  return value:
+//  number of pixels done
+//
+//*****************************************************************************************
+template <int OPERATION, typename PIXELTYPE>
+static size_t VectorLoop(const PIXELTYPE* A, const PIXELTYPE* B, __m128i Constant, PIXELTYPE* Out,
+	size_t NumPixels, __m128i WarnMax, __m128i& Clip)
+{
+	const size_t Lanes = sizeof(__m128i) / sizeof(PIXELTYPE);
+	size_t i = 0;
+
+	for (; i + Lanes <= NumPixels; i += Lanes) {
+		__m128i VectorA = _mm_loadu_si128((const __m128i*)(A + i));
+		__m128i VectorB = B ? _mm_loadu_si128((const __m128i*)(B + i)) : Constant;
+
+		_mm_storeu_si128((__m128i*)(Out + i), VectorPixelMath<OPERATION>(A, VectorA, VectorB, Clip, WarnMax));
+	}
+	return i;
+}
+
+//*****************************************************************************************
+//
+//	VectorPixelMathLoop
+//
+//	Private function, select the vector loop of an operation
+//
+//  return value:
+//  number of pixels done, 0 if the operation has no SSE2 version
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+static size_t VectorPixelMathLoop(int Operation, const PIXELTYPE* A, const PIXELTYPE* B, __m128i Constant,
+	PIXELTYPE* Out, size_t NumPixels, __m128i WarnMax, __m128i& Clip)
+{
+	switch (Operation) {
+	case PIXELMATH_ADD:
+		return VectorLoop<PIXELMATH_ADD>(A, B, Constant, Out, NumPixels, WarnMax, Clip);
+
+	case PIXELMATH_SUBTRACT:
+		return VectorLoop<PIXELMATH_SUBTRACT>(A, B, Constant, Out, NumPixels, WarnMax, Clip);
+
+	case PIXELMATH_MULTIPLY:
+		// SSE2 has no 32 bit multiply
+		if (sizeof(PIXELTYPE) == sizeof(int)) {
+			return 0;
+		}
+		return VectorLoop<PIXELMATH_MULTIPLY>(A, B, Constant, Out, NumPixels, WarnMax, Clip);
+
+	case PIXELMATH_MIN:
+		return VectorLoop<PIXELMATH_MIN>(A, B, Constant, Out, NumPixels, WarnMax, Clip);
+
+	case PIXELMATH_MAX:
+		return VectorLoop<PIXELMATH_MAX>(A, B, Constant, Out, NumPixels, WarnMax, Clip);
+
+	case PIXELMATH_AND:
+		return VectorLoop<PIXELMATH_AND>(A, B, Constant, Out, NumPixels, WarnMax, Clip);
+
+	case PIXELMATH_OR:
+		return VectorLoop<PIXELMATH_OR>(A, B, Constant, Out, NumPixels, WarnMax, Clip);
+
+	case PIXELMATH_XOR:
+		return VectorLoop<PIXELMATH_XOR>(A, B, Constant, Out, NumPixels, WarnMax, Clip);
+
+	case PIXELMATH_THRESHOLD:
+		return VectorLoop<PIXELMATH_THRESHOLD>(A, B, Constant, Out, NumPixels, WarnMax, Clip);
+
+	default:
+		// SSE2 has no integer divide
+		return 0;
+	}
+}
+
+//*****************************************************************************************
+//
+//	SetPixels
+//
+//	Private function, a constant in every pixel of an SSE2 register
+//
+//*****************************************************************************************
+static inline __m128i SetPixels(const BYTE*, int Value)
+{
+	return _mm_set1_epi8((char)Value);
+}
+
+static inline __m128i SetPixels(const USHORT*, int Value)
+{
+	return _mm_set1_epi16((short)Value);
+}
+
+static inline __m128i SetPixels(const int*, int Value)
+{
+	return _mm_set1_epi32(Value);
+}
+
+// the pixel math kernels used for 'int', BYTE and USHORT images
+template int PixelMath(int Operation, const int* A, const int* B, int* Out, size_t NumPixels, int WarnMax);
+template int PixelMath(int Operation, const BYTE* A, const BYTE* B, BYTE* Out, size_t NumPixels, int WarnMax);
+template int PixelMath(int Operation, const USHORT* A, const USHORT* B, USHORT* Out, size_t NumPixels, int WarnMax);
+template int PixelMathConstant(int Operation, const int* A, int Value, int* Out, size_t NumPixels, int WarnMax);
+template int PixelMathConstant(int Operation, const BYTE* A, int Value, BYTE* Out, size_t NumPixels, int WarnMax);
+template int PixelMathConstant(int Operation, const USHORT* A, int Value, USHORT* Out, size_t NumPixels, int WarnMax);
@@ -0,0 +1,26 @@
+#pragma once
+//
+// PixelMath.h
+// function prototypes for the element-wise pixel math kernels in PixelMath.cpp
+//
+
+// pixel math operations, these are also the Operation codes
+// of MathConstant2Image() and the pipeline 'math' step
+#define PIXELMATH_ADD			0
+#define PIXELMATH_MULTIPLY		1
+#define PIXELMATH_DIVIDE		2
+#define PIXELMATH_MIN			3
+#define PIXELMATH_MAX			4
+#define PIXELMATH_AND			5
+#define PIXELMATH_OR			6
+#define PIXELMATH_XOR			7
+#define PIXELMATH_THRESHOLD		8		// 1 if pixel >= operand, otherwise 0
+#define PIXELMATH_SUBTRACT		9
+#define PIXELMATH_NUMOPS		10
+
+// instantiated for int, BYTE and USHORT pixels
+template <typename PIXELTYPE>
+int PixelMath(int Operation, const PIXELTYPE* A, const PIXELTYPE* B, PIXELTYPE* Out, size_t NumPixels, int WarnMax);
+
+template <typename PIXELTYPE>
+int PixelMathConstant(int Operation, const PIXELTYPE* A, int Value, PIXELTYPE* Out, size_t NumPixels, int WarnMax);
@@ -0,0 +1,608 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// PngWriter.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// PNG file writer and encode queue
+//
+// With the AutoPNG setting every BMP file written by SaveBMP() also gets a
+// .png copy.  The batch operations make hundreds of these.  The PNG is
+// encoded from the BMP image already in memory, there is no reloading of the
+// BMP file and GDI+ is not used.
+//
+// WritePNG() writes an 8 bit greyscale, 256 color palette or 24 bit RGB PNG
+// file.  The image data is compressed with a fast deflate: a single pass,
+// greedy LZ77 match finder (one hash table entry per 3 byte sequence) and the
+// fixed Huffman codes.  That is close to the zlib 'fastest' level for the
+// binary and greyscale images made by this application.  Data that does not
+// compress is written as stored blocks.
+//
+// QueuePNG() hands an image to a pool of encode worker threads and returns
+// at once so writing the PNG files does not hold up a batch.  The queue is
+// limited to 2 images per worker, QueuePNG() waits for room when it is full.
+// Each image is queued for a PngBatch, the images of one operation.  Encode
+// errors are kept in the batch until WaitPNGBatch() is called, the operations
+// that save BMP files call it through WaitAutoPNG() (FileFunctions.cpp) when
+// they finish so a .png write error is reported to the operation that made
+// the file.  StopPNGQueue() is called when the application closes, it
+// finishes the queued images first.
+//
+// V1.3.2.1 2026-10-14  Initial release
+//                      Changed, encode errors are kept per PngBatch instead of for the whole queue
+//
+#include "framework.h"
+#include <stdio.h>
+#include <strsafe.h>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "AppErrors.h"
+#include "Parallel.h"
+#include "PngWriter.h"
+
+#define DEFLATE_WINDOW		32768		// furthest match back
+#define DEFLATE_MINMATCH	3			// shortest match
+#define DEFLATE_MAXMATCH	258			// longest match
+#define DEFLATE_HASHLOG		15			// hash table size, 2^DEFLATE_HASHLOG entries
+#define DEFLATE_MAXSTORED	65535		// largest stored block
+
+// deflate length codes 257-285 and distance codes 0-29, RFC 1951
+static const USHORT LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const BYTE LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const USHORT DistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const BYTE DistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// code tables made once, see GetDeflateTables()
+typedef struct DEFLATETABLES {
+	USHORT LiteralCode[288];			// fixed Huffman codes, bit reversed
+	BYTE LiteralBits[288];
+	BYTE DistanceCode[30];				// bit reversed 5 bit codes
+	BYTE LengthIndex[DEFLATE_MAXMATCH + 1];		// match length to length code - 257
+	BYTE DistanceIndex[DEFLATE_WINDOW + 1];		// match distance to distance code
+	UINT32 Crc[256];					// PNG chunk CRC table
+} DEFLATETABLES;
+
+// output bits, least significant bit first
+typedef struct BITOUT {
+	std::vector<BYTE>* Out;
+	UINT64 Bits;
+	int Count;
+} BITOUT;
+
+// one queued image
+typedef struct PNGJOB {
+	WCHAR Filename[MAX_PATH];
+	std::vector<BYTE> Pixels;
+	int Width;
+	int Height;
+	int Channels;
+	std::vector<RGBQUAD> Palette;		// empty if none
+	PngBatch* Batch;					// operation that queued the image
+} PNGJOB;
+
+// guarded by PngLock
+static std::deque<PNGJOB> PngQueue;
+static std::vector<std::thread> PngWorkers;
+static int PngBusy = 0;					// # of images being encoded
+static BOOL PngStop = FALSE;
+
+static std::mutex PngLock;
+static std::condition_variable PngReady;	// image queued or stopping
+static std::condition_variable PngDone;		// image finished
+
+static const DEFLATETABLES* GetDeflateTables(void);
+static void Deflate(const BYTE* Src, size_t SrcSize, std::vector<BYTE>* Out);
+static void PngWorkerMain(void);
+
+static inline void PutBits(BITOUT* Bits, UINT32 Value, int Length)
+{
+	Bits->Bits |= (UINT64)Value << Bits->Count;
+	Bits->Count += Length;
+	while (Bits->Count >= 8) {
+		Bits->Out->push_back((BYTE)Bits->Bits);
+		Bits->Bits >>= 8;
+		Bits->Count -= 8;
+	}
+}
+
+static inline void PutBigEndian(std::vector<BYTE>* Out, UINT32 Value)
+{
+	Out->push_back((BYTE)(Value >> 24));
+	Out->push_back((BYTE)(Value >> 16));
+	Out->push_back((BYTE)(Value >> 8));
+	Out->push_back((BYTE)Value);
+}
+
+static inline UINT32 Hash3(const BYTE* Src)
+{
+	UINT32 Sequence = ((UINT32)Src[0] << 16) | ((UINT32)Src[1] << 8) | (UINT32)Src[2];
+	return (Sequence * 2654435761U) >> (32 - DEFLATE_HASHLOG);
+}
+
+//*****************************************************************************************
+//
+//	WritePNG
+//
+//	Write an image to a PNG file
+//
+// Parameters:
+//	const WCHAR* Filename	PNG output file
+//	const BYTE* Pixels		Width*Channels bytes per row, top row first
+//							RGB order for 3 channels
+//	int Width				image size
+//	int Height
+//	int Channels			1 - greyscale or palette, 3 - RGB
+//	const RGBQUAD* Palette	256 entry color map of a 1 channel image, NULL for greyscale
+//							a palette that is the greyscale ramp is written as greyscale
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list
+//
+//*****************************************************************************************
+int WritePNG(const WCHAR* Filename, const BYTE* Pixels, int Width, int Height, int Channels,
+	const RGBQUAD* Palette)
+{
+	static const BYTE Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	const DEFLATETABLES* Tables = GetDeflateTables();
+	FILE* Out;
+	errno_t ErrNum;
+
+	if (Width <= 0 || Height <= 0 || (Channels != 1 && Channels != 3)) {
+		return APPERR_PARAMETER;
+	}
+	if (Palette != NULL) {
+		BOOL Greyscale = TRUE;
+		for (int i = 0; i < 256; i++) {
+			if (Palette[i].rgbRed != i || Palette[i].rgbGreen != i || Palette[i].rgbBlue != i) {
+				Greyscale = FALSE;
+				break;
+			}
+		}
+		if (Greyscale || Channels != 1) {
+			Palette = NULL;
+		}
+	}
+
+	// filtered image data, a filter type byte at the start of each row
+	// palette and greyscale rows are not filtered, RGB rows use the Sub filter
+	size_t RowSize = (size_t)Width * (size_t)Channels;
+	std::vector<BYTE> Filtered(((size_t)RowSize + 1) * (size_t)Height);
+	BYTE* Dst = Filtered.data();
+	for (int y = 0; y < Height; y++) {
+		const BYTE* Row = Pixels + (size_t)y * RowSize;
+		if (Channels == 1) {
+			*Dst++ = 0;
+			memcpy(Dst, Row, RowSize);
+		}
+		else {
+			*Dst++ = 1;
+			memcpy(Dst, Row, 3);
+			for (size_t i = 3; i < RowSize; i++) {
+				Dst[i] = (BYTE)(Row[i] - Row[i - 3]);
+			}
+		}
+		Dst += RowSize;
+	}
+
+	// IHDR, PLTE, IDAT and IEND chunks as length, type, data, CRC of type and data
+	std::vector<BYTE> Chunks;
+	std::vector<BYTE> Data;
+	auto AddChunk = [&](const char* Type) {
+		size_t Start = Chunks.size();
+		PutBigEndian(&Chunks, (UINT32)Data.size());
+		Chunks.insert(Chunks.end(), Type, Type + 4);
+		Chunks.insert(Chunks.end(), Data.begin(), Data.end());
+		UINT32 Crc = 0xffffffff;
+		for (size_t i = Start + 4; i < Chunks.size(); i++) {
+			Crc = Tables->Crc[(Crc ^ Chunks[i]) & 0xff] ^ (Crc >> 8);
+		}
+		PutBigEndian(&Chunks, Crc ^ 0xffffffff);
+		Data.clear();
+	};
+
+	PutBigEndian(&Data, (UINT32)Width);
+	PutBigEndian(&Data, (UINT32)Height);
+	Data.push_back(8);								// bits per channel
+	Data.push_back(Channels == 3 ? 2 : (Palette != NULL ? 3 : 0));	// color type
+	Data.push_back(0);								// deflate
+	Data.push_back(0);								// adaptive filtering
+	Data.push_back(0);								// not interlaced
+	AddChunk("IHDR");
+
+	if (Palette != NULL) {
+		for (int i = 0; i < 256; i++) {
+			Data.push_back(Palette[i].rgbRed);
+			Data.push_back(Palette[i].rgbGreen);
+			Data.push_back(Palette[i].rgbBlue);
+		}
+		AddChunk("PLTE");
+	}
+
+	Deflate(Filtered.data(), Filtered.size(), &Data);
+	AddChunk("IDAT");
+	AddChunk("IEND");
+
+	ErrNum = _wfopen_s(&Out, Filename, L"wb");
+	if (!Out) {
+		return APPERR_FILEOPEN;
+	}
+	BOOL Written = fwrite(Signature, 1, sizeof(Signature), Out) == sizeof(Signature) &&
+		fwrite(Chunks.data(), 1, Chunks.size(), Out) == Chunks.size();
+	if (fclose(Out) != 0 || !Written) {
+		return APPERR_FILEWRITE;
+	}
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	QueuePNG
+//
+//	Queue an image to be written to a PNG file by the encode worker threads.
+//	The workers are started when the first image is queued.
+//
+// Parameters:
+//	const WCHAR* Filename	PNG output file
+//	std::vector<BYTE>&& Pixels	image, see WritePNG(), the queue takes it over
+//	int Width				image size
+//	int Height
+//	int Channels			1 - greyscale or palette, 3 - RGB
+//	const RGBQUAD* Palette	256 entry color map, NULL for greyscale
+//	PngBatch* Batch			batch of the operation queueing the image
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list, errors writing the file are
+//		returned by WaitPNGBatch()
+//
+//*****************************************************************************************
+int QueuePNG(const WCHAR* Filename, std::vector<BYTE>&& Pixels, int Width, int Height, int Channels,
+	const RGBQUAD* Palette, PngBatch* Batch)
+{
+	PNGJOB Job;
+
+	if (Batch == NULL || Width <= 0 || Height <= 0 || (Channels != 1 && Channels != 3) ||
+			Pixels.size() != (size_t)Width * (size_t)Height * (size_t)Channels) {
+		return APPERR_PARAMETER;
+	}
+	if (FAILED(StringCchCopy(Job.Filename, MAX_PATH, Filename))) {
+		return APPERR_PARAMETER;
+	}
+	Job.Pixels = std::move(Pixels);
+	Job.Width = Width;
+	Job.Height = Height;
+	Job.Channels = Channels;
+	if (Palette != NULL) {
+		Job.Palette.assign(Palette, Palette + 256);
+	}
+	Job.Batch = Batch;
+
+	{
+		std::unique_lock<std::mutex> Guard(PngLock);
+		if (PngWorkers.empty()) {
+			int NumWorkers = GetWorkerCount();
+			if (NumWorkers > PNG_MAX_WORKERS) {
+				NumWorkers = PNG_MAX_WORKERS;
+			}
+			for (int i = 0; i < NumWorkers; i++) {
+				PngWorkers.push_back(std::thread(PngWorkerMain));
+			}
+		}
+		size_t MaxQueued = 2 * PngWorkers.size();
+		PngDone.wait(Guard, [MaxQueued] { return PngQueue.size() < MaxQueued; });
+		PngQueue.push_back(std::move(Job));
+		Batch->Queued++;
+	}
+	PngReady.notify_one();
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	WaitPNGBatch
+//
+//	Wait for the images queued for a batch to be written
+//
+// Parameters:
+//	PngBatch* Batch			images queued by one operation
+//
+//  return value:
+//  1 - Success
+//  !=1 first error writing a PNG file of the batch since the last call
+//
+//*****************************************************************************************
+int WaitPNGBatch(PngBatch* Batch)
+{
+	int Error;
+
+	std::unique_lock<std::mutex> Guard(PngLock);
+	PngDone.wait(Guard, [Batch] { return Batch->Queued == 0; });
+	Error = Batch->Error;
+	Batch->Error = APP_SUCCESS;
+	return Error;
+}
+
+//*****************************************************************************************
+//
+//	~PngBatch
+//
+//	The queue workers update the batch until its last image is written
+//
+//*****************************************************************************************
+PngBatch::~PngBatch()
+{
+	std::unique_lock<std::mutex> Guard(PngLock);
+	PngDone.wait(Guard, [this] { return Queued == 0; });
+}
+
+//*****************************************************************************************
+//
+//	StopPNGQueue
+//
+//	Finish the queued images and end the encode worker threads.
+//	Called when the application is closing.
+//
+//*****************************************************************************************
+void StopPNGQueue(void)
+{
+	{
+		std::unique_lock<std::mutex> Guard(PngLock);
+		PngDone.wait(Guard, [] { return PngQueue.empty() && PngBusy == 0; });
+		PngStop = TRUE;
+	}
+	PngReady.notify_all();
+	for (auto& Worker : PngWorkers) {
+		Worker.join();
+	}
+	std::lock_guard<std::mutex> Guard(PngLock);
+	PngWorkers.clear();
+	PngStop = FALSE;
+	return;
+}
+
+//*****************************************************************************************
+//
+//	PngWorkerMain
+//
+//	Private function, an encode worker thread.  Writes the queued images
+//	until StopPNGQueue() is called.
+//
+//*****************************************************************************************
+static void PngWorkerMain(void)
+{
+	for (;;) {
+		PNGJOB Job;
+		{
+			std::unique_lock<std::mutex> Guard(PngLock);
+			PngReady.wait(Guard, [] { return !PngQueue.empty() || PngStop; });
+			if (PngQueue.empty()) {
+				break;
+			}
+			Job = std::move(PngQueue.front());
+			PngQueue.pop_front();
+			PngBusy++;
+		}
+		// room in the queue
+		PngDone.notify_all();
+
+		int iRes;
+		try {
+			iRes = WritePNG(Job.Filename, Job.Pixels.data(), Job.Width, Job.Height, Job.Channels,
+				Job.Palette.empty() ? NULL : Job.Palette.data());
+		}
+		catch (...) {
+			// a failed allocation must not end the worker
+			iRes = APPERR_MEMALLOC;
+		}
+
+		{
+			std::lock_guard<std::mutex> Guard(PngLock);
+			PngBusy--;
+			if (iRes != APP_SUCCESS && Job.Batch->Error == APP_SUCCESS) {
+				Job.Batch->Error = iRes;
+			}
+			// the batch can be gone once Queued is 0
+			Job.Batch->Queued--;
+		}
+		PngDone.notify_all();
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	GetDeflateTables
+//
+//	Private function, the code tables are made the first time they are used
+//
+//*****************************************************************************************
+static const DEFLATETABLES* GetDeflateTables(void)
+{
+	static const DEFLATETABLES* Tables = [] {
+		static DEFLATETABLES NewTables;
+		DEFLATETABLES* T = &NewTables;
+
+		// fixed Huffman codes, RFC 1951 3.2.6
+		// deflate writes Huffman codes most significant bit first
+		for (int Symbol = 0; Symbol < 288; Symbol++) {
+			UINT32 Code;
+			int Bits;
+			if (Symbol < 144) {
+				Code = 0x30 + Symbol;
+				Bits = 8;
+			}
+			else if (Symbol < 256) {
+				Code = 0x190 + (Symbol - 144);
+				Bits = 9;
+			}
+			else if (Symbol < 280) {
+				Code = Symbol - 256;
+				Bits = 7;
+			}
+			else {
+				Code = 0xc0 + (Symbol - 280);
+				Bits = 8;
+			}
+			UINT32 Reversed = 0;
+			for (int i = 0; i < Bits; i++) {
+				Reversed |= ((Code >> i) & 1) << (Bits - 1 - i);
+			}
+			T->LiteralCode[Symbol] = (USHORT)Reversed;
+			T->LiteralBits[Symbol] = (BYTE)Bits;
+		}
+		for (int Code = 0; Code < 30; Code++) {
+			UINT32 Reversed = 0;
+			for (int i = 0; i < 5; i++) {
+				Reversed |= ((Code >> i) & 1) << (4 - i);
+			}
+			T->DistanceCode[Code] = (BYTE)Reversed;
+		}
+
+		// the last code of a length or distance wins, 258 is code 285
+		for (int Index = 0; Index < 29; Index++) {
+			for (int Length = LengthBase[Index];
+					Length < LengthBase[Index] + (1 << LengthExtra[Index]) && Length <= DEFLATE_MAXMATCH; Length++) {
+				T->LengthIndex[Length] = (BYTE)Index;
+			}
+		}
+		for (int Index = 0; Index < 30; Index++) {
+			for (int Distance = DistanceBase[Index];
+					Distance < DistanceBase[Index] + (1 << DistanceExtra[Index]); Distance++) {
+				T->DistanceIndex[Distance] = (BYTE)Index;
+			}
+		}
+
+		for (UINT32 n = 0; n < 256; n++) {
+			UINT32 c = n;
+			for (int k = 0; k < 8; k++) {
+				c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+			}
+			T->Crc[n] = c;
+		}
+		return (const DEFLATETABLES*)T;
+	}();
+	return Tables;
+}
+
+//*****************************************************************************************
+//
+//	Deflate
+//
+//	Private function, compress data into a zlib stream (RFC 1950) of one
+//	fixed Huffman block, or stored blocks if the data does not compress
+//
+// Parameters:
+//	const BYTE* Src			data to compress
+//	size_t SrcSize			# of bytes in Src
+//	std::vector<BYTE>* Out	the zlib stream is added to the end of this
+//
+//*****************************************************************************************
+static void Deflate(const BYTE* Src, size_t SrcSize, std::vector<BYTE>* Out)
+{
+	const DEFLATETABLES* T = GetDeflateTables();
+	size_t Start = Out->size();
+	BITOUT Bits = { Out, 0, 0 };
+
+	// zlib header, deflate with a 32K window, fastest compression
+	Out->push_back(0x78);
+	Out->push_back(0x01);
+
+	// single final block with the fixed Huffman codes
+	PutBits(&Bits, 1, 1);
+	PutBits(&Bits, 1, 2);
+
+	std::vector<int> Head((size_t)1 << DEFLATE_HASHLOG, -1);
+	size_t Pos = 0;
+	while (Pos + DEFLATE_MINMATCH <= SrcSize) {
+		UINT32 Hash = Hash3(&Src[Pos]);
+		int Candidate = Head[Hash];
+		Head[Hash] = (int)Pos;
+
+		if (Candidate >= 0 && Pos - (size_t)Candidate <= DEFLATE_WINDOW &&
+				Src[Candidate] == Src[Pos] && Src[Candidate + 1] == Src[Pos + 1] && Src[Candidate + 2] == Src[Pos + 2]) {
+			size_t MaxLength = SrcSize - Pos < DEFLATE_MAXMATCH ? SrcSize - Pos : DEFLATE_MAXMATCH;
+			size_t Length = DEFLATE_MINMATCH;
+			while (Length < MaxLength && Src[Candidate + Length] == Src[Pos + Length]) {
+				Length++;
+			}
+			size_t Distance = Pos - (size_t)Candidate;
+
+			int LengthIndex = T->LengthIndex[Length];
+			int Symbol = 257 + LengthIndex;
+			PutBits(&Bits, T->LiteralCode[Symbol], T->LiteralBits[Symbol]);
+			PutBits(&Bits, (UINT32)(Length - LengthBase[LengthIndex]), LengthExtra[LengthIndex]);
+
+			int DistanceIndex = T->DistanceIndex[Distance];
+			PutBits(&Bits, T->DistanceCode[DistanceIndex], 5);
+			PutBits(&Bits, (UINT32)(Distance - DistanceBase[DistanceIndex]), DistanceExtra[DistanceIndex]);
+
+			Pos += Length;
+		}
+		else {
+			PutBits(&Bits, T->LiteralCode[Src[Pos]], T->LiteralBits[Src[Pos]]);
+			Pos++;
+		}
+	}
+	while (Pos < SrcSize) {
+		PutBits(&Bits, T->LiteralCode[Src[Pos]], T->LiteralBits[Src[Pos]]);
+		Pos++;
+	}
+	// end of block
+	PutBits(&Bits, T->LiteralCode[256], T->LiteralBits[256]);
+	if (Bits.Count > 0) {
+		PutBits(&Bits, 0, 8 - Bits.Count);
+	}
+
+	// data that does not compress is stored instead
+	size_t StoredSize = 2 + SrcSize + 5 * (SrcSize / DEFLATE_MAXSTORED + 1);
+	if (Out->size() - Start > StoredSize) {
+		Out->resize(Start + 2);
+		size_t Stored = 0;
+		do {
+			size_t Length = SrcSize - Stored < DEFLATE_MAXSTORED ? SrcSize - Stored : DEFLATE_MAXSTORED;
+			Out->push_back(Stored + Length == SrcSize ? 1 : 0);
+			Out->push_back((BYTE)Length);
+			Out->push_back((BYTE)(Length >> 8));
+			Out->push_back((BYTE)~Length);
+			Out->push_back((BYTE)(~Length >> 8));
+			Out->insert(Out->end(), Src + Stored, Src + Stored + Length);
+			Stored += Length;
+		} while (Stored < SrcSize);
+	}
+
+	// Adler-32 of the uncompressed data, sums are reduced every 5552 bytes
+	UINT32 A = 1;
+	UINT32 B = 0;
+	size_t i = 0;
+	while (i < SrcSize) {
+		size_t End = SrcSize - i < 5552 ? SrcSize : i + 5552;
+		for (; i < End; i++) {
+			A += Src[i];
+			B += A;
+		}
+		A %= 65521;
+		B %= 65521;
+	}
+	PutBigEndian(Out, (B << 16) | A);
+	return;
+}
@@ -0,0 +1,40 @@
+#pragma once
+//
+// PngWriter.h
+// function prototypes for the PNG file writer and encode queue in PngWriter.cpp
+//
+#include <vector>
+
+#define PNG_MAX_WORKERS		8		// most encode queue worker threads
+
+//
+// The images queued by one operation.  WaitPNGBatch() waits for them and
+// returns the first error writing them, the errors of other operations
+// using the queue at the same time are not mixed in.  The destructor waits
+// for the images still queued so an early return can not leave the queue
+// pointing at a batch that no longer exists.
+//
+class PngBatch
+{
+public:
+	int Queued = 0;				// # of images not yet written, guarded by the queue lock
+	int Error = 1;				// first error writing an image, 1 (APP_SUCCESS) - none
+
+	PngBatch() {
+	};
+
+	~PngBatch();
+
+	PngBatch(const PngBatch&) = delete;
+	PngBatch& operator=(const PngBatch&) = delete;
+};
+
+int WritePNG(const WCHAR* Filename, const BYTE* Pixels, int Width, int Height, int Channels,
+	const RGBQUAD* Palette);
+
+int QueuePNG(const WCHAR* Filename, std::vector<BYTE>&& Pixels, int Width, int Height, int Channels,
+	const RGBQUAD* Palette, PngBatch* Batch);
+
+int WaitPNGBatch(PngBatch* Batch);
+
+void StopPNGQueue(void);
@@ -0,0 +1,512 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// ResultCache.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Result cache
+//
+// Exploring a message means running the same extract, decode and reorder
+// steps over and over with the same input and parameters.  The result cache
+// keeps the output file of those steps in a cache folder.  When the same
+// function is run again on the same input file content with the same
+// parameters the stored output is copied to the output file instead of
+// computing it again.
+//
+// The key of a result is a hash of the function name, the parameter list
+// and the content of the input file (and of a second input file such as the
+// reordering kernel file of PixelReorder).  The content hash of a file is
+// remembered for as long as the size and last write time of the file do
+// not change, so a cache hit does not have to read the whole input file.
+// The image file format setting (ImageFile.cpp) is also part of the key.
+//
+// Each result is one file in the cache folder, <key>.rcache.  The total size
+// of the cache folder is limited by the ResultCacheSizeMB setting, the least
+// recently used results are deleted first.  The last write time of a result
+// file is its last use, so the order is kept from one run to the next.
+//
+// The cache is off when the ResultCacheFolder setting is blank.  Any failure
+// in the cache itself only means the result is computed as usual.
+//
+// V1.3.2.1 2026-10-14  Initial release
+//                      Added, CachedFileResult with a second input file in the key
+//                      Changed, Compute() and the result file copies run without CacheMutex
+//
+#include "framework.h"
+#include <stdio.h>
+#include <atlstr.h>
+#include <mutex>
+#include <map>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "AppErrors.h"
+#include "ImageDialog.h"
+#include "Globals.h"
+#include "FileFunctions.h"
+#include "ResultCache.h"
+#include "imaging.h"
+#include "ImageFile.h"
+
+#define FNV_OFFSET	14695981039346656037ULL
+#define FNV_PRIME	1099511628211ULL
+#define HASH_CHUNK	(1024*1024)		// bytes read at a time when hashing a file
+
+typedef struct {
+	ULONGLONG Size;
+	ULONGLONG LastUsed;			// FILETIME of last store or hit
+} CACHEENTRY;
+
+typedef struct {
+	ULONGLONG Size;
+	ULONGLONG WriteTime;
+	ULONGLONG Hash;
+} CONTENTHASH;
+
+static std::mutex CacheMutex;
+static WCHAR CacheFolder[MAX_PATH] = L"";	// blank - result cache is off
+static ULONGLONG CacheMaxBytes = (ULONGLONG)RESULTCACHE_DEFAULT_MB * 1024 * 1024;
+static BOOL IndexLoaded = FALSE;
+static ULONGLONG CacheBytes = 0;
+static std::map<std::wstring, CACHEENTRY> CacheIndex;			// result filename -> entry
+static std::map<std::wstring, CONTENTHASH> ContentHashes;		// input filename -> content hash
+
+static ULONGLONG HashBytes(ULONGLONG Hash, const void* Data, size_t Size);
+static ULONGLONG FileTimeValue(const FILETIME* Time);
+static BOOL GetFileInfo(const WCHAR* Filename, ULONGLONG* Size, ULONGLONG* WriteTime);
+static BOOL HashFileContent(WCHAR* Filename, ULONGLONG* Hash, ULONGLONG* Size);
+static void LoadCacheIndex(void);
+static void TouchFile(const WCHAR* Filename, FILETIME* Time);
+static void EvictResults(void);
+
+//*****************************************************************************************
+//
+//	SetResultCache
+//
+//	Set the cache folder and size limit, called at startup and from the
+//	settings dialog
+//
+// Parameters:
+//	const WCHAR* Folder		folder holding the cached results, "" turns the cache off
+//							the folder is created if it does not exist
+//	int MaxSizeMB			limit of the total size of the cached results in MB
+//
+//  return value: none
+//
+//*****************************************************************************************
+void SetResultCache(const WCHAR* Folder, int MaxSizeMB)
+{
+	std::lock_guard<std::mutex> Lock(CacheMutex);
+
+	if (MaxSizeMB < 1) {
+		MaxSizeMB = 1;
+	}
+	CacheMaxBytes = (ULONGLONG)MaxSizeMB * 1024 * 1024;
+
+	if (wcscmp(CacheFolder, Folder) != 0) {
+		wcscpy_s(CacheFolder, Folder);
+		CacheIndex.clear();
+		CacheBytes = 0;
+		IndexLoaded = FALSE;
+		if (wcscmp(CacheFolder, L"") != 0) {
+			CreateDirectory(CacheFolder, NULL);
+		}
+	}
+}
+
+//*****************************************************************************************
+//
+//	CachedFileResult
+//
+//	Run a file to file function through the result cache.  If the result
+//	is in the cache it is copied to OutputFile and displayed if
+//	DisplayResults is set, the same as Compute() would have done.
+//	Otherwise Compute() is run and a successful result is added to the cache.
+//
+// Parameters:
+//	const WCHAR* Function	name of the function, part of the key
+//	WCHAR* InputFile		input file, its content is part of the key
+//	WCHAR* OutputFile		output file written by Compute()
+//	const int* Params		every parameter that changes the result
+//	int NumParams			# of entries in Params
+//	const std::function<int(void)>& Compute		computes the result into OutputFile
+//
+//  return value:
+//  APP_SUCCESS for a cache hit, otherwise the return value of Compute()
+//
+//*****************************************************************************************
+int CachedFileResult(const WCHAR* Function, WCHAR* InputFile, WCHAR* OutputFile,
+	const int* Params, int NumParams, const std::function<int(void)>& Compute)
+{
+	return CachedFileResult(Function, InputFile, NULL, OutputFile, Params, NumParams, Compute);
+}
+
+//*****************************************************************************************
+//
+//	CachedFileResult
+//
+//	Same as above for a function with a second input file, such as the
+//	reordering kernel file of PixelReorder().  The content of both files
+//	is part of the key.
+//
+// Parameters:
+//	WCHAR* KeyFile			second input file, NULL if none
+//
+//*****************************************************************************************
+int CachedFileResult(const WCHAR* Function, WCHAR* InputFile, WCHAR* KeyFile, WCHAR* OutputFile,
+	const int* Params, int NumParams, const std::function<int(void)>& Compute)
+{
+	WCHAR ResultName[24];
+	WCHAR ResultFile[MAX_PATH];
+	WCHAR Folder[MAX_PATH];
+	ULONGLONG ContentHash;
+	ULONGLONG ContentSize;
+	ULONGLONG KeyFileHash;
+	ULONGLONG KeyFileSize;
+	ULONGLONG Key;
+	CACHEENTRY NewEntry;
+	int FileFormat[2];
+	FILETIME Now;
+	BOOL Hit;
+	BOOL Copied;
+	int iRes;
+
+	// Compute() and the file copies run without CacheMutex, a job can take
+	// minutes and wait on the UI thread to display its result
+	{
+		std::lock_guard<std::mutex> Lock(CacheMutex);
+		wcscpy_s(Folder, CacheFolder);
+	}
+	if (wcscmp(Folder, L"") == 0) {
+		return Compute();
+	}
+
+	if (!HashFileContent(InputFile, &ContentHash, &ContentSize)) {
+		return Compute();
+	}
+	if (KeyFile != NULL && !HashFileContent(KeyFile, &KeyFileHash, &KeyFileSize)) {
+		return Compute();
+	}
+
+	Key = HashBytes(FNV_OFFSET, Function, wcslen(Function) * sizeof(WCHAR));
+	Key = HashBytes(Key, &NumParams, sizeof(int));
+	Key = HashBytes(Key, Params, (size_t)NumParams * sizeof(int));
+	Key = HashBytes(Key, &ContentHash, sizeof(ULONGLONG));
+	Key = HashBytes(Key, &ContentSize, sizeof(ULONGLONG));
+	if (KeyFile != NULL) {
+		Key = HashBytes(Key, &KeyFileHash, sizeof(ULONGLONG));
+		Key = HashBytes(Key, &KeyFileSize, sizeof(ULONGLONG));
+	}
+	// the same result is stored differently for each image file version
+	GetImageFileFormat(&FileFormat[0], &FileFormat[1]);
+	Key = HashBytes(Key, FileFormat, sizeof(FileFormat));
+	swprintf_s(ResultName, L"%016llx.rcache", Key);
+
+	{
+		std::lock_guard<std::mutex> Lock(CacheMutex);
+		wcscpy_s(Folder, CacheFolder);
+		if (wcscmp(Folder, L"") != 0) {
+			LoadCacheIndex();
+			Hit = CacheIndex.find(ResultName) != CacheIndex.end();
+		}
+		else {
+			Hit = FALSE;
+		}
+	}
+	if (wcscmp(Folder, L"") == 0) {
+		return Compute();
+	}
+	swprintf_s(ResultFile, L"%s\\%s", Folder, ResultName);
+
+	if (Hit) {
+		Copied = CopyFile(ResultFile, OutputFile, FALSE);
+		GetSystemTimeAsFileTime(&Now);
+		if (Copied) {
+			// CopyFile() keeps the time of the cached file, the output is new
+			TouchFile(ResultFile, &Now);
+			TouchFile(OutputFile, &Now);
+		}
+
+		{
+			std::lock_guard<std::mutex> Lock(CacheMutex);
+			// the folder could have been changed or the result evicted while copying
+			auto Entry = CacheIndex.find(ResultName);
+			if (wcscmp(Folder, CacheFolder) == 0 && Entry != CacheIndex.end()) {
+				if (Copied) {
+					Entry->second.LastUsed = FileTimeValue(&Now);
+				}
+				else {
+					// the result file is gone or unreadable
+					CacheBytes -= Entry->second.Size;
+					CacheIndex.erase(Entry);
+				}
+			}
+		}
+		if (Copied) {
+			if (DisplayResults) {
+				DisplayImage(OutputFile);
+			}
+			return APP_SUCCESS;
+		}
+	}
+
+	iRes = Compute();
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	if (!CopyFile(OutputFile, ResultFile, FALSE)) {
+		return iRes;
+	}
+	GetSystemTimeAsFileTime(&Now);
+	TouchFile(ResultFile, &Now);
+	if (!GetFileInfo(ResultFile, &NewEntry.Size, &NewEntry.LastUsed)) {
+		DeleteFile(ResultFile);
+		return iRes;
+	}
+	NewEntry.LastUsed = FileTimeValue(&Now);
+
+	{
+		std::lock_guard<std::mutex> Lock(CacheMutex);
+
+		// the folder could have been changed while computing, the index
+		// of a new folder is built from its files when it is loaded
+		if (wcscmp(Folder, CacheFolder) != 0 || !IndexLoaded) {
+			return iRes;
+		}
+		auto Entry = CacheIndex.find(ResultName);
+		if (Entry != CacheIndex.end()) {
+			CacheBytes -= Entry->second.Size;
+		}
+		CacheIndex[ResultName] = NewEntry;
+		CacheBytes += NewEntry.Size;
+		EvictResults();
+	}
+
+	return iRes;
+}
+
+//*****************************************************************************************
+//
+//	HashBytes
+//
+//	64 bit FNV-1a hash, continued from Hash
+//
+//*****************************************************************************************
+static ULONGLONG HashBytes(ULONGLONG Hash, const void* Data, size_t Size)
+{
+	const BYTE* Bytes = (const BYTE*)Data;
+
+	for (size_t i = 0; i < Size; i++) {
+		Hash ^= (ULONGLONG)Bytes[i];
+		Hash *= FNV_PRIME;
+	}
+	return Hash;
+}
+
+//*****************************************************************************************
+//
+//	FileTimeValue
+//
+//*****************************************************************************************
+static ULONGLONG FileTimeValue(const FILETIME* Time)
+{
+	return ((ULONGLONG)Time->dwHighDateTime << 32) | (ULONGLONG)Time->dwLowDateTime;
+}
+
+//*****************************************************************************************
+//
+//	GetFileInfo
+//
+//	size and last write time of a file
+//
+//  return value:
+//  TRUE - file exists
+//
+//*****************************************************************************************
+static BOOL GetFileInfo(const WCHAR* Filename, ULONGLONG* Size, ULONGLONG* WriteTime)
+{
+	WIN32_FILE_ATTRIBUTE_DATA FileInfo;
+
+	if (!GetFileAttributesEx(Filename, GetFileExInfoStandard, &FileInfo)) {
+		return FALSE;
+	}
+	*Size = ((ULONGLONG)FileInfo.nFileSizeHigh << 32) | (ULONGLONG)FileInfo.nFileSizeLow;
+	*WriteTime = FileTimeValue(&FileInfo.ftLastWriteTime);
+	return TRUE;
+}
+
+//*****************************************************************************************
+//
+//	HashFileContent
+//
+//	Hash of the content of a file.  The hash is remembered until the size
+//	or last write time of the file changes.
+//
+// Parameters:
+//	WCHAR* Filename			file to hash
+//	ULONGLONG* Hash			returned content hash
+//	ULONGLONG* Size			returned file size
+//
+//  return value:
+//  TRUE - Hash is valid
+//
+//*****************************************************************************************
+static BOOL HashFileContent(WCHAR* Filename, ULONGLONG* Hash, ULONGLONG* Size)
+{
+	CONTENTHASH Content;
+	FILE* In;
+	BYTE* Buffer;
+	size_t NumRead;
+	errno_t ErrNum;
+
+	if (Filename == NULL || !GetFileInfo(Filename, &Content.Size, &Content.WriteTime)) {
+		return FALSE;
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(CacheMutex);
+		auto Entry = ContentHashes.find(Filename);
+		if (Entry != ContentHashes.end() &&
+			Entry->second.Size == Content.Size &&
+			Entry->second.WriteTime == Content.WriteTime) {
+			*Hash = Entry->second.Hash;
+			*Size = Content.Size;
+			return TRUE;
+		}
+	}
+
+	ErrNum = _wfopen_s(&In, Filename, L"rb");
+	if (In == NULL) {
+		return FALSE;
+	}
+	Buffer = new BYTE[HASH_CHUNK];
+	if (Buffer == NULL) {
+		fclose(In);
+		return FALSE;
+	}
+	Content.Hash = FNV_OFFSET;
+	while ((NumRead = fread(Buffer, 1, HASH_CHUNK, In)) != 0) {
+		Content.Hash = HashBytes(Content.Hash, Buffer, NumRead);
+	}
+	delete[] Buffer;
+	if (ferror(In)) {
+		fclose(In);
+		return FALSE;
+	}
+	fclose(In);
+
+	{
+		std::lock_guard<std::mutex> Lock(CacheMutex);
+		ContentHashes[Filename] = Content;
+	}
+	*Hash = Content.Hash;
+	*Size = Content.Size;
+	return TRUE;
+}
+
+//*****************************************************************************************
+//
+//	LoadCacheIndex
+//
+//	Build the list of cached results from the files in the cache folder,
+//	done once per folder.  CacheMutex must be held.
+//
+//*****************************************************************************************
+static void LoadCacheIndex(void)
+{
+	WCHAR Pattern[MAX_PATH];
+	WIN32_FIND_DATA FindData;
+	HANDLE hFind;
+	CACHEENTRY Entry;
+
+	if (IndexLoaded) {
+		return;
+	}
+	IndexLoaded = TRUE;
+	CacheIndex.clear();
+	CacheBytes = 0;
+
+	swprintf_s(Pattern, L"%s\\*.rcache", CacheFolder);
+	hFind = FindFirstFile(Pattern, &FindData);
+	if (hFind == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	do {
+		if (FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			continue;
+		}
+		Entry.Size = ((ULONGLONG)FindData.nFileSizeHigh << 32) | (ULONGLONG)FindData.nFileSizeLow;
+		Entry.LastUsed = FileTimeValue(&FindData.ftLastWriteTime);
+		CacheIndex[FindData.cFileName] = Entry;
+		CacheBytes += Entry.Size;
+	} while (FindNextFile(hFind, &FindData));
+	FindClose(hFind);
+
+	EvictResults();
+}
+
+//*****************************************************************************************
+//
+//	TouchFile
+//
+//	Set the last write time of a file
+//
+//*****************************************************************************************
+static void TouchFile(const WCHAR* Filename, FILETIME* Time)
+{
+	HANDLE hFile;
+
+	hFile = CreateFile(Filename, FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	SetFileTime(hFile, NULL, NULL, Time);
+	CloseHandle(hFile);
+}
+
+//*****************************************************************************************
+//
+//	EvictResults
+//
+//	Delete the least recently used results until the cache is within
+//	CacheMaxBytes.  CacheMutex must be held.
+//
+//*****************************************************************************************
+static void EvictResults(void)
+{
+	std::vector<std::pair<ULONGLONG, std::wstring>> ByAge;
+	WCHAR ResultFile[MAX_PATH];
+
+	if (CacheBytes <= CacheMaxBytes) {
+		return;
+	}
+
+	for (auto& Entry : CacheIndex) {
+		ByAge.push_back(std::make_pair(Entry.second.LastUsed, Entry.first));
+	}
+	std::sort(ByAge.begin(), ByAge.end());
+
+	for (auto& Oldest : ByAge) {
+		if (CacheBytes <= CacheMaxBytes) {
+			break;
+		}
+		swprintf_s(ResultFile, L"%s\\%s", CacheFolder, Oldest.second.c_str());
+		DeleteFile(ResultFile);
+		CacheBytes -= CacheIndex[Oldest.second].Size;
+		CacheIndex.erase(Oldest.second);
+	}
+}
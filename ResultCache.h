@@ -0,0 +1,16 @@
+#pragma once
+//
+// ResultCache.h
+// function prototypes for the result cache in ResultCache.cpp
+//
+#include <functional>
+
+#define RESULTCACHE_DEFAULT_MB	1024	// default ResultCacheSizeMB setting
+
+void SetResultCache(const WCHAR* Folder, int MaxSizeMB);
+
+int CachedFileResult(const WCHAR* Function, WCHAR* InputFile, WCHAR* OutputFile,
+	const int* Params, int NumParams, const std::function<int(void)>& Compute);
+
+int CachedFileResult(const WCHAR* Function, WCHAR* InputFile, WCHAR* KeyFile, WCHAR* OutputFile,
+	const int* Params, int NumParams, const std::function<int(void)>& Compute);
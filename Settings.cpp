@@ -30,6 +30,11 @@
 // V1.2.10.1 2023-11-2  Changed, global Setting, added auto save PNG flag when creating a BMP file
 // V1.3.1.1 2023-12-28  Replaced application error numbers with #define to improve clarity
 //                      Moved the .exe and .ini file info to the About dialog
+// V1.3.2.1 2026-10-14  Added, WorkerThreads setting, number of threads used by the
+//                      image transforms, 0 uses one thread per processor
+//                      Added, result cache folder and size settings
+//                      Added, timing log file setting
+//                      Added, image file version and compression settings (ImageFile.cpp)
 //
 // Global Settings dialog box handler
 // 
@@ -47,6 +52,10 @@
 #include "Globals.h"
 #include "imaging.h"
 #include "FileFunctions.h"
+#include "Parallel.h"
+#include "ResultCache.h"
+#include "Timing.h"
+#include "ImageFile.h"
 
 //*******************************************************************************
 //
@@ -69,6 +78,17 @@ INT_PTR CALLBACK GlobalSettingsDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
         GetPrivateProfileString(L"GlobalSettings", L"TempImageFilename", L"working.raw", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
         SetDlgItemText(hDlg, IDC_IMG_TEMP, szString);
 
+        // IDC_SETTINGS_CACHE_FOLDER, blank - no result cache
+        GetPrivateProfileString(L"GlobalSettings", L"ResultCacheFolder", L"", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_SETTINGS_CACHE_FOLDER, szString);
+
+        iRes = GetPrivateProfileInt(L"GlobalSettings", L"ResultCacheSizeMB", RESULTCACHE_DEFAULT_MB, (LPCTSTR)strAppNameINI);
+        SetDlgItemInt(hDlg, IDC_SETTINGS_CACHE_SIZE, iRes, TRUE);
+
+        // IDC_SETTINGS_TIMING_LOG, blank - no timing
+        GetPrivateProfileString(L"GlobalSettings", L"TimingLog", L"", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_SETTINGS_TIMING_LOG, szString);
+
         //IDC_SETTINGS_DISPLAY_RESULTS
         iRes = GetPrivateProfileInt(L"GlobalSettings", L"DisplayResults", 1, (LPCTSTR)strAppNameINI);
         if (iRes != 0) {
@@ -97,6 +117,22 @@ INT_PTR CALLBACK GlobalSettingsDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
             CheckDlgButton(hDlg, IDC_SETTINGS_STATUSBAR, BST_CHECKED);
         }
 
+        // IDC_SETTINGS_WORKERS
+        GetPrivateProfileString(L"GlobalSettings", L"WorkerThreads", L"0", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_SETTINGS_WORKERS, szString);
+
+        // IDC_SETTINGS_PACKED_IMAGES
+        iRes = GetPrivateProfileInt(L"GlobalSettings", L"ImageFileVersion", 1, (LPCTSTR)strAppNameINI);
+        if (iRes == IMAGEFILE_VERSION_PACKED) {
+            CheckDlgButton(hDlg, IDC_SETTINGS_PACKED_IMAGES, BST_CHECKED);
+        }
+
+        // IDC_SETTINGS_COMPRESS_IMAGES
+        iRes = GetPrivateProfileInt(L"GlobalSettings", L"CompressImages", 0, (LPCTSTR)strAppNameINI);
+        if (iRes != 0) {
+            CheckDlgButton(hDlg, IDC_SETTINGS_COMPRESS_IMAGES, BST_CHECKED);
+        }
+
         return (INT_PTR)TRUE;
     }
 
@@ -144,6 +180,43 @@ INT_PTR CALLBACK GlobalSettingsDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
             return (INT_PTR)TRUE;
         }
 
+        case IDC_SETTINGS_CACHE_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_SETTINGS_CACHE_FOLDER, szString, MAX_PATH);
+            if (!CCFileOpen(hDlg, szString, &pszFilename, TRUE, 0, NULL, NULL)) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_SETTINGS_CACHE_FOLDER, szString);
+
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_SETTINGS_TIMING_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_SETTINGS_TIMING_LOG, szString, MAX_PATH);
+            COMDLG_FILTERSPEC CSVType[] =
+            {
+                 { L"CSV files", L"*.csv" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileSave(hDlg, szString, &pszFilename, FALSE, 2, CSVType, L".csv")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_SETTINGS_TIMING_LOG, szString);
+
+            return (INT_PTR)TRUE;
+        }
+
         case IDOK:
             GetDlgItemText(hDlg, IDC_BMP_RESULTS, szString, MAX_PATH);
             wcscpy_s(szBMPFilename, szString);
@@ -153,6 +226,27 @@ INT_PTR CALLBACK GlobalSettingsDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
             wcscpy_s(szTempImageFilename, szString);
             WritePrivateProfileString(L"GlobalSettings", L"TempImageFilename", szString, (LPCTSTR)strAppNameINI);
 
+            // IDC_SETTINGS_CACHE_FOLDER, IDC_SETTINGS_CACHE_SIZE
+            {
+                WCHAR szFolder[MAX_PATH];
+                int CacheSizeMB;
+
+                GetDlgItemText(hDlg, IDC_SETTINGS_CACHE_FOLDER, szFolder, MAX_PATH);
+                WritePrivateProfileString(L"GlobalSettings", L"ResultCacheFolder", szFolder, (LPCTSTR)strAppNameINI);
+
+                GetDlgItemText(hDlg, IDC_SETTINGS_CACHE_SIZE, szString, MAX_PATH);
+                CacheSizeMB = _wtoi(szString);
+                if (CacheSizeMB < 1) CacheSizeMB = RESULTCACHE_DEFAULT_MB;
+                swprintf_s(szString, L"%d", CacheSizeMB);
+                WritePrivateProfileString(L"GlobalSettings", L"ResultCacheSizeMB", szString, (LPCTSTR)strAppNameINI);
+                SetResultCache(szFolder, CacheSizeMB);
+            }
+
+            // IDC_SETTINGS_TIMING_LOG
+            GetDlgItemText(hDlg, IDC_SETTINGS_TIMING_LOG, szString, MAX_PATH);
+            WritePrivateProfileString(L"GlobalSettings", L"TimingLog", szString, (LPCTSTR)strAppNameINI);
+            SetTimingLog(szString);
+
             //IDC_SETTINGS_DISPLAY_RESULTS
             if (IsDlgButtonChecked(hDlg, IDC_SETTINGS_DISPLAY_RESULTS) == BST_CHECKED) {
                 WritePrivateProfileString(L"GlobalSettings", L"DisplayResults", L"1", (LPCTSTR)strAppNameINI);
@@ -207,6 +301,36 @@ INT_PTR CALLBACK GlobalSettingsDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
                 ImgDlg->Repaint();
             }
 
+            // IDC_SETTINGS_WORKERS
+            {
+                int NumWorkers;
+
+                GetDlgItemText(hDlg, IDC_SETTINGS_WORKERS, szString, MAX_PATH);
+                NumWorkers = _wtoi(szString);
+                if (NumWorkers < 0) NumWorkers = 0;
+                if (NumWorkers > MAX_WORKER_THREADS) NumWorkers = MAX_WORKER_THREADS;
+                swprintf_s(szString, L"%d", NumWorkers);
+                WritePrivateProfileString(L"GlobalSettings", L"WorkerThreads", szString, (LPCTSTR)strAppNameINI);
+                SetWorkerCount(NumWorkers);
+            }
+
+            // IDC_SETTINGS_PACKED_IMAGES, IDC_SETTINGS_COMPRESS_IMAGES
+            {
+                int Version = 1;
+                BOOL Compress = FALSE;
+
+                if (IsDlgButtonChecked(hDlg, IDC_SETTINGS_PACKED_IMAGES) == BST_CHECKED) {
+                    Version = IMAGEFILE_VERSION_PACKED;
+                }
+                if (IsDlgButtonChecked(hDlg, IDC_SETTINGS_COMPRESS_IMAGES) == BST_CHECKED) {
+                    Compress = TRUE;
+                }
+                swprintf_s(szString, L"%d", Version);
+                WritePrivateProfileString(L"GlobalSettings", L"ImageFileVersion", szString, (LPCTSTR)strAppNameINI);
+                WritePrivateProfileString(L"GlobalSettings", L"CompressImages", Compress ? L"1" : L"0", (LPCTSTR)strAppNameINI);
+                SetImageFileFormat(Version, Compress);
+            }
+
             EndDialog(hDlg, LOWORD(wParam));
             return (INT_PTR)TRUE;
 
@@ -0,0 +1,169 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// Timing.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Operation timing
+//
+// The image transforms and the pipeline measure how long the load, compute
+// and write parts of each operation take and add a line to the timing log
+// file.  The log is a csv file so it can be loaded into a spreadsheet:
+//
+//	Date,Time,Operation,Pixels,Load s,Compute s,Write s,Total s,Mpixels/s,Input file
+//
+// When an image is streamed (see StreamImageFile) the load and write overlap
+// the compute and are not reported separately, these are blank in the log.
+//
+// Timing is off when the TimingLog setting is blank.
+//
+// The timer functions are also used by the benchmark (Benchmark.cpp).
+//
+// V1.3.2.1 2026-10-14  Initial release
+//
+#include "framework.h"
+#include <stdio.h>
+#include <mutex>
+#include "Timing.h"
+
+static std::mutex TimingMutex;
+static WCHAR TimingLogFile[MAX_PATH] = L"";		// blank - timing is off
+
+//*****************************************************************************************
+//
+//	TimerNow
+//
+//	Current value of the high resolution timer
+//
+//*****************************************************************************************
+LONGLONG TimerNow(void)
+{
+	LARGE_INTEGER Now;
+
+	QueryPerformanceCounter(&Now);
+	return Now.QuadPart;
+}
+
+//*****************************************************************************************
+//
+//	TimerSeconds
+//
+//	Seconds between two TimerNow() values
+//
+//*****************************************************************************************
+double TimerSeconds(LONGLONG Start, LONGLONG End)
+{
+	static LONGLONG Frequency = 0;
+	LARGE_INTEGER Value;
+
+	if (Frequency == 0) {
+		QueryPerformanceFrequency(&Value);
+		Frequency = Value.QuadPart;
+	}
+	return (double)(End - Start) / (double)Frequency;
+}
+
+//*****************************************************************************************
+//
+//	SetTimingLog
+//
+//	Set the timing log file, called at startup and from the settings dialog
+//
+// Parameters:
+//	const WCHAR* Filename	csv file the timing lines are added to, "" - timing is off
+//
+//  return value: none
+//
+//*****************************************************************************************
+void SetTimingLog(const WCHAR* Filename)
+{
+	std::lock_guard<std::mutex> Lock(TimingMutex);
+
+	wcscpy_s(TimingLogFile, Filename);
+}
+
+//*****************************************************************************************
+//
+//	TimingEnabled
+//
+//  return value:
+//  TRUE - there is a timing log, operations should be timed
+//
+//*****************************************************************************************
+BOOL TimingEnabled(void)
+{
+	std::lock_guard<std::mutex> Lock(TimingMutex);
+
+	return wcscmp(TimingLogFile, L"") != 0;
+}
+
+//*****************************************************************************************
+//
+//	LogOperationTiming
+//
+//	Add the timing of an operation to the timing log.  This may be called
+//	from any thread.
+//
+// Parameters:
+//	const WCHAR* Operation	name of the operation
+//	const WCHAR* InputFile	input file of the operation
+//	ULONGLONG NumPixels		# of pixels processed, used for the throughput
+//	const OPTIMING* Timing	measured times
+//
+//  return value: none
+//
+//*****************************************************************************************
+void LogOperationTiming(const WCHAR* Operation, const WCHAR* InputFile, ULONGLONG NumPixels, const OPTIMING* Timing)
+{
+	std::lock_guard<std::mutex> Lock(TimingMutex);
+	SYSTEMTIME Now;
+	FILE* Log;
+	long long LogSize;
+	errno_t ErrNum;
+
+	if (wcscmp(TimingLogFile, L"") == 0) {
+		return;
+	}
+
+	ErrNum = _wfopen_s(&Log, TimingLogFile, L"a");
+	if (Log == NULL) {
+		return;
+	}
+
+	// new log file, start with the column names
+	fseek(Log, 0, SEEK_END);
+	LogSize = _ftelli64(Log);
+	if (LogSize == 0) {
+		fwprintf(Log, L"Date,Time,Operation,Pixels,Load s,Compute s,Write s,Total s,Mpixels/s,Input file\n");
+	}
+
+	GetLocalTime(&Now);
+	fwprintf(Log, L"%04d-%02d-%02d,%02d:%02d:%02d.%03d,%s,%llu,",
+		Now.wYear, Now.wMonth, Now.wDay, Now.wHour, Now.wMinute, Now.wSecond, Now.wMilliseconds,
+		Operation, NumPixels);
+	if (Timing->Load >= 0.0) {
+		fwprintf(Log, L"%.6f", Timing->Load);
+	}
+	fwprintf(Log, L",%.6f,", Timing->Compute);
+	if (Timing->Write >= 0.0) {
+		fwprintf(Log, L"%.6f", Timing->Write);
+	}
+	fwprintf(Log, L",%.6f,", Timing->Total);
+	if (Timing->Total > 0.0) {
+		fwprintf(Log, L"%.3f", (double)NumPixels / Timing->Total / 1.0e6);
+	}
+	fwprintf(Log, L",%s\n", InputFile);
+	fclose(Log);
+}
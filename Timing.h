@@ -0,0 +1,24 @@
+#pragma once
+//
+// Timing.h
+// function prototypes for the operation timing in Timing.cpp
+//
+
+// time spent in each part of an operation, in seconds
+// Load and Write are < 0 when they overlap the compute (streamed images)
+typedef struct OPTIMING {
+	double Load;		// reading the input image
+	double Compute;		// the transform
+	double Write;		// writing (and displaying) the output image
+	double Total;		// the whole operation
+} OPTIMING;
+
+LONGLONG TimerNow(void);
+
+double TimerSeconds(LONGLONG Start, LONGLONG End);
+
+void SetTimingLog(const WCHAR* Filename);
+
+BOOL TimingEnabled(void);
+
+void LogOperationTiming(const WCHAR* Operation, const WCHAR* InputFile, ULONGLONG NumPixels, const OPTIMING* Timing);
@@ -0,0 +1,524 @@
+//
+// MySETIapp, a set tools for decoding bitstreams into various formats and manipulating those files
+// Transpose.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIapp.
+//
+// MySETIapp is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIapp is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Rotate and mirror kernels used by RotateImage() and MirrorImage()
+//
+// A 90 degree rotation is a transpose of the frame, with the rows of the
+// input (clockwise) or of the output (counter clockwise) taken in reverse
+// order.  Done one pixel at a time either the reads or the writes step
+// through memory an entire row apart, so once a row no longer fits in the
+// cache every one of these is a cache miss.  Here the frame is transposed in
+// TRANSPOSE_TILE x TRANSPOSE_TILE tiles so the input and output rows of a tile
+// stay in the L1 cache while it is done.  Inside a tile 4x4 blocks of pixels
+// are transposed in SSE2 registers.
+//
+// Mirroring reverses the pixels of each row (SSE2 shuffle) or the order of
+// the rows (row copies).
+//
+// Both can be done in place.  Mirroring and the rotation of a square frame
+// need no extra memory, the rotation of a frame that is not square uses
+// a copy of one frame.
+//
+// The output rows of all the frames are split into bands that are processed
+// in parallel.
+//
+// The kernels are templates for 'int', BYTE and USHORT pixels.  The SSE2
+// 4x4 transpose and row reversal are used for 'int' pixels, the 1 and 2 byte
+// pixels use the same tiling with plain loops inside the tiles.
+//
+// V1.3.2.1 2026-10-14  Initial release, tiled SSE2 rotate, mirror
+//                      Added, BYTE and USHORT versions of the kernels
+//
+#include "framework.h"
+#include <emmintrin.h>
+#include <string.h>
+#include <algorithm>
+#include "AppErrors.h"
+#include "Parallel.h"
+#include "Transpose.h"
+
+// tile size in pixels, 2 tiles of 32x32 pixels use 8KB of L1 cache
+#define TRANSPOSE_TILE 32
+
+static void Transpose4x4(const int* Input, ptrdiff_t InStride, int* Output, ptrdiff_t OutStride);
+
+template <typename PIXELTYPE>
+static void Transpose4x4(const PIXELTYPE* Input, ptrdiff_t InStride, PIXELTYPE* Output, ptrdiff_t OutStride);
+
+template <typename PIXELTYPE>
+static void Swap4x4(PIXELTYPE* A, PIXELTYPE* B, ptrdiff_t Stride);
+
+template <typename PIXELTYPE>
+static void TransposeTiles(const PIXELTYPE* Input, ptrdiff_t InStride, PIXELTYPE* Output, ptrdiff_t OutStride,
+	int Rows, int Cols);
+
+template <typename PIXELTYPE>
+static void SwapTransposeTiles(PIXELTYPE* Image, int Size, int TileY, int TileX);
+
+template <typename PIXELTYPE>
+static void TransposeSquare(PIXELTYPE* Image, int Size);
+
+static void ReverseRow(const int* Input, int* Output, int Xsize);
+
+template <typename PIXELTYPE>
+static void ReverseRow(const PIXELTYPE* Input, PIXELTYPE* Output, int Xsize);
+
+static void ReverseRowInPlace(int* Row, int Xsize);
+
+template <typename PIXELTYPE>
+static void ReverseRowInPlace(PIXELTYPE* Row, int Xsize);
+
+//*****************************************************************************************
+//
+//	RotateFrames
+//
+//	Rotate the frames of an image 90 degrees.  The output frames are
+//	Ysize wide and Xsize high.
+//
+// Parameters:
+//	const PIXELTYPE* Input	Xsize by Ysize by NumFrames input image
+//	PIXELTYPE* Output		Ysize by Xsize by NumFrames output image, must not be Input
+//	int Xsize				input frame x size
+//	int Ysize				input frame y size
+//	int NumFrames			number of frames
+//	int Direction			0 - rotate counter clockwise
+//							1 - rotate clockwise
+//
+//  return value: none
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+void RotateFrames(const PIXELTYPE* Input, PIXELTYPE* Output, int Xsize, int Ysize, int NumFrames, int Direction)
+{
+	size_t FrameSize = (size_t)Xsize * (size_t)Ysize;
+
+	// output row r is input column r (clockwise) or input column Xsize-1-r
+	// (counter clockwise)
+	ParallelForFrames(NumFrames, Xsize, [&](int Frame, int StartRow, int EndRow) {
+		const PIXELTYPE* InFrame = Input + (size_t)Frame * FrameSize;
+		PIXELTYPE* OutFrame = Output + (size_t)Frame * FrameSize;
+
+		if (Direction) {
+			// clockwise, transpose of the input with its rows in reverse order
+			TransposeTiles(InFrame + (size_t)(Ysize - 1) * (size_t)Xsize + StartRow, -(ptrdiff_t)Xsize,
+				OutFrame + (size_t)StartRow * (size_t)Ysize, Ysize,
+				Ysize, EndRow - StartRow);
+		}
+		else {
+			// counter clockwise, transpose of the input into the output
+			// with its rows in reverse order
+			TransposeTiles(InFrame + (Xsize - EndRow), Xsize,
+				OutFrame + (size_t)(EndRow - 1) * (size_t)Ysize, -(ptrdiff_t)Ysize,
+				Ysize, EndRow - StartRow);
+		}
+	});
+	return;
+}
+
+//*****************************************************************************************
+//
+//	RotateFramesInPlace
+//
+//	Rotate the frames of an image 90 degrees in place.  A square frame is
+//	transposed in place and its rows reversed.  Other sizes use a copy
+//	of one frame.
+//
+// Parameters:
+//	PIXELTYPE* Image		Xsize by Ysize by NumFrames image, replaced by
+//							the Ysize by Xsize by NumFrames rotated image
+//	int Xsize				input frame x size
+//	int Ysize				input frame y size
+//	int NumFrames			number of frames
+//	int Direction			0 - rotate counter clockwise
+//							1 - rotate clockwise
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list in AppErrors.h
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+int RotateFramesInPlace(PIXELTYPE* Image, int Xsize, int Ysize, int NumFrames, int Direction)
+{
+	size_t FrameSize = (size_t)Xsize * (size_t)Ysize;
+	PIXELTYPE* Frame;
+
+	if (Xsize == Ysize) {
+		for (int FrameNum = 0; FrameNum < NumFrames; FrameNum++) {
+			Frame = Image + (size_t)FrameNum * FrameSize;
+			if (Direction) {
+				// clockwise, reverse the rows then transpose
+				MirrorFrames(Frame, Frame, Xsize, Ysize, 1, 0);
+				TransposeSquare(Frame, Xsize);
+			}
+			else {
+				// counter clockwise, transpose then reverse the rows
+				TransposeSquare(Frame, Xsize);
+				MirrorFrames(Frame, Frame, Xsize, Ysize, 1, 0);
+			}
+		}
+		return APP_SUCCESS;
+	}
+
+	PIXELTYPE* Copy;
+
+	Copy = new PIXELTYPE[FrameSize];
+	if (Copy == NULL) {
+		return APPERR_MEMALLOC;
+	}
+	for (int FrameNum = 0; FrameNum < NumFrames; FrameNum++) {
+		Frame = Image + (size_t)FrameNum * FrameSize;
+		memcpy(Copy, Frame, FrameSize * sizeof(PIXELTYPE));
+		RotateFrames(Copy, Frame, Xsize, Ysize, 1, Direction);
+	}
+	delete[] Copy;
+
+	return APP_SUCCESS;
+}
+
+//*****************************************************************************************
+//
+//	MirrorFrames
+//
+//	Mirror the frames of an image.
+//
+// Parameters:
+//	const PIXELTYPE* Input	Xsize by Ysize by NumFrames input image
+//	PIXELTYPE* Output		Xsize by Ysize by NumFrames output image
+//							if this is Input the image is mirrored in place
+//	int Xsize				frame x size
+//	int Ysize				frame y size
+//	int NumFrames			number of frames
+//	int Direction			0 - mirror around horizontal axis
+//							1 - mirror around vertical axis
+//
+//  return value: none
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+void MirrorFrames(const PIXELTYPE* Input, PIXELTYPE* Output, int Xsize, int Ysize, int NumFrames, int Direction)
+{
+	size_t FrameSize = (size_t)Xsize * (size_t)Ysize;
+	BOOL InPlace = (Input == Output);
+
+	if (Direction) {
+		// mirror around vertical axis, reverse each row
+		ParallelForFrames(NumFrames, Ysize, [&](int Frame, int StartY, int EndY) {
+			for (int y = StartY; y < EndY; y++) {
+				size_t Offset = (size_t)Frame * FrameSize + (size_t)y * (size_t)Xsize;
+				if (InPlace) {
+					ReverseRowInPlace(Output + Offset, Xsize);
+				}
+				else {
+					ReverseRow(Input + Offset, Output + Offset, Xsize);
+				}
+			}
+		});
+	}
+	else if (!InPlace) {
+		// mirror around horizontal axis, copy the rows in reverse order
+		ParallelForFrames(NumFrames, Ysize, [&](int Frame, int StartY, int EndY) {
+			for (int y = StartY; y < EndY; y++) {
+				memcpy(Output + (size_t)Frame * FrameSize + (size_t)y * (size_t)Xsize,
+					Input + (size_t)Frame * FrameSize + (size_t)((Ysize - 1) - y) * (size_t)Xsize,
+					(size_t)Xsize * sizeof(PIXELTYPE));
+			}
+		});
+	}
+	else {
+		// mirror around horizontal axis in place, swap the top and bottom rows
+		ParallelForFrames(NumFrames, Ysize / 2, [&](int Frame, int StartY, int EndY) {
+			for (int y = StartY; y < EndY; y++) {
+				PIXELTYPE* Top = Output + (size_t)Frame * FrameSize + (size_t)y * (size_t)Xsize;
+				PIXELTYPE* Bottom = Output + (size_t)Frame * FrameSize + (size_t)((Ysize - 1) - y) * (size_t)Xsize;
+				std::swap_ranges(Top, Top + Xsize, Bottom);
+			}
+		});
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	Transpose4x4
+//
+//	Transpose a 4x4 block of pixels in SSE2 registers,
+//		Output[j*OutStride + i] = Input[i*InStride + j]
+//	All 4 input rows are loaded before the output is stored so Input
+//	and Output can be the same block.
+//
+//*****************************************************************************************
+static void Transpose4x4(const int* Input, ptrdiff_t InStride, int* Output, ptrdiff_t OutStride)
+{
+	__m128i Row0 = _mm_loadu_si128((const __m128i*)(Input));
+	__m128i Row1 = _mm_loadu_si128((const __m128i*)(Input + InStride));
+	__m128i Row2 = _mm_loadu_si128((const __m128i*)(Input + 2 * InStride));
+	__m128i Row3 = _mm_loadu_si128((const __m128i*)(Input + 3 * InStride));
+
+	// a0 b0 a1 b1, c0 d0 c1 d1, a2 b2 a3 b3, c2 d2 c3 d3
+	__m128i Low01 = _mm_unpacklo_epi32(Row0, Row1);
+	__m128i Low23 = _mm_unpacklo_epi32(Row2, Row3);
+	__m128i High01 = _mm_unpackhi_epi32(Row0, Row1);
+	__m128i High23 = _mm_unpackhi_epi32(Row2, Row3);
+
+	_mm_storeu_si128((__m128i*)(Output), _mm_unpacklo_epi64(Low01, Low23));
+	_mm_storeu_si128((__m128i*)(Output + OutStride), _mm_unpackhi_epi64(Low01, Low23));
+	_mm_storeu_si128((__m128i*)(Output + 2 * OutStride), _mm_unpacklo_epi64(High01, High23));
+	_mm_storeu_si128((__m128i*)(Output + 3 * OutStride), _mm_unpackhi_epi64(High01, High23));
+	return;
+}
+
+// 1 and 2 byte pixels
+template <typename PIXELTYPE>
+static void Transpose4x4(const PIXELTYPE* Input, ptrdiff_t InStride, PIXELTYPE* Output, ptrdiff_t OutStride)
+{
+	PIXELTYPE Block[16];
+
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			Block[j * 4 + i] = Input[i * InStride + j];
+		}
+	}
+	for (int j = 0; j < 4; j++) {
+		memcpy(Output + j * OutStride, Block + j * 4, 4 * sizeof(PIXELTYPE));
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	Swap4x4
+//
+//	Replace 4x4 block A with the transpose of block B and B with the
+//	transpose of A.  A and B must not overlap.
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+static void Swap4x4(PIXELTYPE* A, PIXELTYPE* B, ptrdiff_t Stride)
+{
+	PIXELTYPE BlockA[16];
+
+	Transpose4x4(A, Stride, BlockA, 4);
+	Transpose4x4(B, Stride, A, Stride);
+	for (int i = 0; i < 4; i++) {
+		memcpy(B + i * Stride, BlockA + i * 4, 4 * sizeof(PIXELTYPE));
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	TransposeTiles
+//
+//	Output[j*OutStride + i] = Input[i*InStride + j] for i < Rows, j < Cols
+//	The strides can be negative to take the rows in reverse order.
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+static void TransposeTiles(const PIXELTYPE* Input, ptrdiff_t InStride, PIXELTYPE* Output, ptrdiff_t OutStride,
+	int Rows, int Cols)
+{
+	int EndY;
+	int EndX;
+	int x;
+	int y;
+
+	for (int TileY = 0; TileY < Rows; TileY += TRANSPOSE_TILE) {
+		EndY = min(TileY + TRANSPOSE_TILE, Rows);
+		for (int TileX = 0; TileX < Cols; TileX += TRANSPOSE_TILE) {
+			EndX = min(TileX + TRANSPOSE_TILE, Cols);
+			for (y = TileY; y + 4 <= EndY; y += 4) {
+				for (x = TileX; x + 4 <= EndX; x += 4) {
+					Transpose4x4(Input + y * InStride + x, InStride, Output + x * OutStride + y, OutStride);
+				}
+				// right edge of the tile
+				for (; x < EndX; x++) {
+					for (int i = y; i < y + 4; i++) {
+						Output[x * OutStride + i] = Input[i * InStride + x];
+					}
+				}
+			}
+			// bottom edge of the tile
+			for (; y < EndY; y++) {
+				for (x = TileX; x < EndX; x++) {
+					Output[x * OutStride + y] = Input[y * InStride + x];
+				}
+			}
+		}
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	SwapTransposeTiles
+//
+//	In place transpose of a square frame, one pair of tiles.  The tile at
+//	TileY,TileX is swapped with the tile at TileX,TileY, both transposed.
+//	A tile on the diagonal (TileX == TileY) is transposed in place.
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+static void SwapTransposeTiles(PIXELTYPE* Image, int Size, int TileY, int TileX)
+{
+	int EndY = min(TileY + TRANSPOSE_TILE, Size);
+	int EndX = min(TileX + TRANSPOSE_TILE, Size);
+	int BlockEndY = TileY + ((EndY - TileY) & ~3);
+	int BlockEndX = TileX + ((EndX - TileX) & ~3);
+	PIXELTYPE* Block;
+
+	// 4x4 blocks, on the diagonal only the blocks on or above the diagonal
+	for (int y = TileY; y < BlockEndY; y += 4) {
+		for (int x = (TileX == TileY) ? y : TileX; x < BlockEndX; x += 4) {
+			Block = Image + (size_t)y * (size_t)Size + x;
+			if (x == y) {
+				Transpose4x4(Block, Size, Block, Size);
+			}
+			else {
+				Swap4x4(Block, Image + (size_t)x * (size_t)Size + y, Size);
+			}
+		}
+	}
+
+	// pixels at the edges of the tile that are not in a 4x4 block
+	for (int y = TileY; y < EndY; y++) {
+		for (int x = (TileX == TileY) ? y + 1 : TileX; x < EndX; x++) {
+			if (y < BlockEndY && x < BlockEndX) {
+				continue;
+			}
+			std::swap(Image[(size_t)y * (size_t)Size + x], Image[(size_t)x * (size_t)Size + y]);
+		}
+	}
+	return;
+}
+
+//*****************************************************************************************
+//
+//	TransposeSquare
+//
+//	In place transpose of a Size by Size frame.  The tile pairs on and
+//	above the diagonal are split into bands that are processed in parallel.
+//
+//*****************************************************************************************
+template <typename PIXELTYPE>
+static void TransposeSquare(PIXELTYPE* Image, int Size)
+{
+	int NumTiles = (Size + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+	int NumPairs = NumTiles * (NumTiles + 1) / 2;
+
+	ParallelFor(0, NumPairs, [&](int StartPair, int EndPair) {
+		int TileRow = 0;
+		int TileCol;
+		int Pair = StartPair;
+
+		// tile row TileRow has the pairs TileRow,TileRow to TileRow,NumTiles-1
+		while (Pair >= NumTiles - TileRow) {
+			Pair -= NumTiles - TileRow;
+			TileRow++;
+		}
+		TileCol = TileRow + Pair;
+
+		for (Pair = StartPair; Pair < EndPair; Pair++) {
+			SwapTransposeTiles(Image, Size, TileRow * TRANSPOSE_TILE, TileCol * TRANSPOSE_TILE);
+			TileCol++;
+			if (TileCol == NumTiles) {
+				TileRow++;
+				TileCol = TileRow;
+			}
+		}
+	});
+	return;
+}
+
+//*****************************************************************************************
+//
+//	ReverseRow
+//
+//	Output[x] = Input[Xsize-1-x], Output must not be Input
+//
+//*****************************************************************************************
+static void ReverseRow(const int* Input, int* Output, int Xsize)
+{
+	const int* End = Input + Xsize;
+	int x;
+
+	for (x = 0; x + 4 <= Xsize; x += 4) {
+		__m128i Pixels = _mm_loadu_si128((const __m128i*)(End - x - 4));
+		_mm_storeu_si128((__m128i*)(Output + x), _mm_shuffle_epi32(Pixels, _MM_SHUFFLE(0, 1, 2, 3)));
+	}
+	for (; x < Xsize; x++) {
+		Output[x] = Input[(Xsize - 1) - x];
+	}
+	return;
+}
+
+// 1 and 2 byte pixels
+template <typename PIXELTYPE>
+static void ReverseRow(const PIXELTYPE* Input, PIXELTYPE* Output, int Xsize)
+{
+	std::reverse_copy(Input, Input + Xsize, Output);
+	return;
+}
+
+//*****************************************************************************************
+//
+//	ReverseRowInPlace
+//
+//	Reverse the order of the pixels in a row
+//
+//*****************************************************************************************
+static void ReverseRowInPlace(int* Row, int Xsize)
+{
+	int Left = 0;
+	int Right = Xsize;		// one past the right pixel
+
+	// swap 4 pixels from each end until they would overlap
+	while (Right - Left >= 8) {
+		__m128i LeftPixels = _mm_loadu_si128((const __m128i*)(Row + Left));
+		__m128i RightPixels = _mm_loadu_si128((const __m128i*)(Row + Right - 4));
+		_mm_storeu_si128((__m128i*)(Row + Left), _mm_shuffle_epi32(RightPixels, _MM_SHUFFLE(0, 1, 2, 3)));
+		_mm_storeu_si128((__m128i*)(Row + Right - 4), _mm_shuffle_epi32(LeftPixels, _MM_SHUFFLE(0, 1, 2, 3)));
+		Left += 4;
+		Right -= 4;
+	}
+	while (Right - Left >= 2) {
+		std::swap(Row[Left], Row[Right - 1]);
+		Left++;
+		Right--;
+	}
+	return;
+}
+
+// 1 and 2 byte pixels
+template <typename PIXELTYPE>
+static void ReverseRowInPlace(PIXELTYPE* Row, int Xsize)
+{
+	std::reverse(Row, Row + Xsize);
+	return;
+}
+
+// the rotate and mirror kernels used for 'int', BYTE and USHORT images
+template void RotateFrames(const int* Input, int* Output, int Xsize, int Ysize, int NumFrames, int Direction);
+template void RotateFrames(const BYTE* Input, BYTE* Output, int Xsize, int Ysize, int NumFrames, int Direction);
+template void RotateFrames(const USHORT* Input, USHORT* Output, int Xsize, int Ysize, int NumFrames, int Direction);
+template int RotateFramesInPlace(int* Image, int Xsize, int Ysize, int NumFrames, int Direction);
+template int RotateFramesInPlace(BYTE* Image, int Xsize, int Ysize, int NumFrames, int Direction);
+template int RotateFramesInPlace(USHORT* Image, int Xsize, int Ysize, int NumFrames, int Direction);
+template void MirrorFrames(const int* Input, int* Output, int Xsize, int Ysize, int NumFrames, int Direction);
+template void MirrorFrames(const BYTE* Input, BYTE* Output, int Xsize, int Ysize, int NumFrames, int Direction);
+template void MirrorFrames(const USHORT* Input, USHORT* Output, int Xsize, int Ysize, int NumFrames, int Direction);
@@ -0,0 +1,15 @@
+#pragma once
+//
+// Transpose.h
+// function prototypes for the rotate and mirror kernels in Transpose.cpp
+//
+
+// instantiated for int, BYTE and USHORT pixels
+template <typename PIXELTYPE>
+void RotateFrames(const PIXELTYPE* Input, PIXELTYPE* Output, int Xsize, int Ysize, int NumFrames, int Direction);
+
+template <typename PIXELTYPE>
+int RotateFramesInPlace(PIXELTYPE* Image, int Xsize, int Ysize, int NumFrames, int Direction);
+
+template <typename PIXELTYPE>
+void MirrorFrames(const PIXELTYPE* Input, PIXELTYPE* Output, int Xsize, int Ysize, int NumFrames, int Direction);
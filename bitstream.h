@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vector>
 #include "SPP.h"
 
 void ExtractFromBitStreamText(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
@@ -12,12 +13,19 @@ void BitDistance(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int SkipSize,
 void BitSequences(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int PrologueSize,
     int BitOrder);
 
+int BitRunHistogram(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, WCHAR* ImageFile,
+    int SkipSize, int BitOrder);
+
 void FileHexDump(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int xsize, int SkipBytes);
 
 void BitStreamStats(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
     int PrologueSize, int BlockHeaderBits, int NumBlockBodyBits,
     int BlockNum, int BitOrder);
 
+int BitAutocorrelation(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
+    int PrologueSize, int NumBlockHeaderBits, int NumBlockBodyBits, int BlockNum,
+    int MinLag, int MaxLag, int NumCandidates, int BitOrder);
+
 void ExtractBits(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
     int SkipSize, int CopyBits, int xsize, int Invert, int BitOrder);
 
@@ -27,7 +35,13 @@ int BitStream2Image(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
 
 void BatchBitStream2Image(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
     int PrologueSize, int BlockHeaderBits, int NumBlockBodyBits, int BlockNum, int xsize,
-    int xsizeEnd, int BitDepth, int BitOrder, int BitScale, int Invert, int InputBitOrder);
+    int xsizeEnd, int BitDepth, int BitOrder, int BitScale, int Invert, int InputBitOrder,
+    int DeferBMP);
+
+void BatchBitStream2Image(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
+    int PrologueSize, int BlockHeaderBits, int NumBlockBodyBits, int BlockNum,
+    const std::vector<int>& Xsizes, int BitDepth, int BitOrder, int BitScale, int Invert,
+    int InputBitOrder, int DeferBMP);
 
 int ConvertText2BitStream(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int BitOrder);
 
@@ -35,6 +49,9 @@ int ExtractSPP(HWND hDlg, WCHAR* APIDoutputFile, WCHAR* InputFile, WCHAR* Output
                 int APID, int SkipBytes, int SecondaryHeaderSize,
                 int Strict, int SaveSPP);
 
+int DemuxSPP(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, WCHAR* ReportFile,
+                int SkipBytes, int SecondaryHeaderSize, int Strict, int BinaryOutput, int SaveReport);
+
 int DecodeSPP(SPP_PRIMARY_HEADER* PackedPriHeader, SPP_UNPACKED_PRIMARY_HEADER* PriHeader, int Strict);
 
 uint16_t ByteSwap(uint16_t Value);
@@ -43,3 +60,8 @@ void RemoveNULLbytes(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int NULLval
                     int NullLength, int SkipBytes);
 
 int FindAPrime(HWND hDlg, WCHAR* Filename, int Start, int End);
+
+int BitStreamFactorSizes(WCHAR* InputFile, int PrologueSize, int BitDepth, int xsize, int xsizeEnd,
+    std::vector<int>* Xsizes, int* NumBlockBodyBits, ULONGLONG* NumBits);
+
+int FactorBitStreamLength(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int PrologueSize, int BitDepth);
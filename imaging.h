@@ -12,10 +12,42 @@ typedef struct IMAGINGHEADER {
 	short NumFrames;	// Number of image frames in the file
 	short Version;		// header version  number
 						// 1 - this 32 byte header
+						// 2 - frame offset table and packed frames follow
+						//     the header, see ImageFile.cpp
 	short Padding[6];	// dummy entries reserved for other uses
 } IMAGINGHEADER;
 #pragma pack(pop)
 
+// image held in memory, used to chain image transforms without writing
+// intermediate image files, see Pipeline.cpp
+// PIXELTYPE is the type the pixels are stored as.  All the transforms work
+// on 'int' pixels (IMAGEBUFFER).  The transforms that only move pixels or add
+// them (fold, rotate, mirror, reorder, add/subtract, decimate) can also keep
+// 1 and 2 byte images at their file pixel size (IMAGEBUFFER8, IMAGEBUFFER16).
+template <typename PIXELTYPE>
+struct PIXELBUFFER {
+	IMAGINGHEADER Header;	// header of the image in Image
+	PIXELTYPE* Image;		// Xsize*Ysize*NumFrames pixels
+	size_t Capacity;		// # of pixels allocated for Image
+};
+typedef PIXELBUFFER<int> IMAGEBUFFER;
+typedef PIXELBUFFER<BYTE> IMAGEBUFFER8;
+typedef PIXELBUFFER<USHORT> IMAGEBUFFER16;
+
+// store a transform result in a pixel, 1 and 2 byte pixels are clamped to
+// 0-255 and 0-65535 the same way the image file writer clamps 'int' pixels
+template <typename PIXELTYPE>
+inline PIXELTYPE SaturatePixel(int Value)
+{
+	if (sizeof(PIXELTYPE) >= sizeof(int)) {
+		return (PIXELTYPE)Value;
+	}
+	const int MaxValue = sizeof(PIXELTYPE) == 1 ? 255 : 65535;
+	Value = Value < 0 ? 0 : Value;
+	Value = Value > MaxValue ? MaxValue : Value;
+	return (PIXELTYPE)Value;
+}
+
 union PIXEL {
 	BYTE Byte[4];
 	USHORT uShort;
@@ -24,6 +56,8 @@ union PIXEL {
 
 int LoadImageFile(int** ImagePtr, WCHAR* ImagingFilename, IMAGINGHEADER* header);
 
+int ValidateLoadHeader(IMAGINGHEADER* Header);
+
 void ReportImageHeader(HWND hDlg, WCHAR* szCurrentFilename);
 
 void ReportImageProperties(HWND hDlg, WCHAR* Filename);
@@ -65,14 +99,14 @@ int ConvolveImage(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, WCHAR* OutputFi
 
 int AddSubtractImages(HWND hDlg, WCHAR* InputFile, WCHAR* InputFile2, WCHAR* OutputFile, int ADDflag);
 
+int ImageMath(HWND hDlg, WCHAR* InputFile, WCHAR* InputFile2, WCHAR* OutputFile, int Operation, int* ArithmeticFlag);
+
 int AddSubtractKernel(HWND hDlg, WCHAR* InputFile, WCHAR* InputFile2, WCHAR* OutputFile, int ADDflag);
 
 int RotateImage(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Direction);
 
 int MirrorImage(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Direction);
 
-int CalculateConvPixel(int x, int y, int* Image, float* Kernel, int KernelXsize, int KernelYsize, int xsize);
-
 void Convolve(float* Kernel, int KernelXsize, int KernelYsize, int* Image, int* NewImage, int xsize, int ysize);
 
 int ConvertDecomList2Relative(int* DecomX, int* DecomY, int DecomXsize, int DecomYsize, int NumKernels);
@@ -93,6 +127,9 @@ int ReorderAlg(WCHAR* InputFile, WCHAR* OutputFile, int Xsize, int Ysize, int Pi
 int ExtractSymbols(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int SkipBits,
 					int xsizesymbol, int ysizesymbol, int Approach, int Highlight);
 
+int ExtractSymbolsMultiSize(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int MaxNull,
+	int xsizesymbol, int ysizesymbol, int xsizesymbolMax, int ysizesymbolMax, int Approach);
+
 int SymbolTest(int* InputImage, int xsize, int ysize, int Yoffset, int NullValue);
 
 void SymbolCopy(int* InputImage, int* OutputImage, int xsize, int ysize,
@@ -118,3 +155,47 @@ int BlockReorder(HWND hDlg, WCHAR* TextInput, WCHAR* InputFile, WCHAR* OutputFil
 void ComputeBlockReordering(int* DecomAddress, int xsize, int ysize, int* DecomX, int* DecomY,
 	int DecomXsize, int DecomYsize, int BlockXsize, int BlockYsize);
 
+// in memory versions of the image transforms
+// the templates are instantiated for IMAGEBUFFER, IMAGEBUFFER8 and IMAGEBUFFER16
+template <typename PIXELTYPE>
+int FoldImageLeftBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int FoldColumn);
+
+template <typename PIXELTYPE>
+int FoldImageRightBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int FoldColumn);
+
+template <typename PIXELTYPE>
+int FoldImageDownBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int FoldRow);
+
+template <typename PIXELTYPE>
+int FoldImageUpBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int FoldRow);
+
+template <typename PIXELTYPE>
+int RotateImageBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int Direction);
+
+template <typename PIXELTYPE>
+int MirrorImageBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int Direction);
+
+template <typename PIXELTYPE>
+int AddSubtractImageBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* In2, PIXELBUFFER<PIXELTYPE>* Out, int AddFlag);
+
+template <typename PIXELTYPE>
+int ImageMathBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* In2, PIXELBUFFER<PIXELTYPE>* Out,
+	int Operation, int* ArithmeticFlag);
+
+int ConvolveImageBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, float* Kernel, int KernelXsize, int KernelYsize);
+
+int ReadConvolutionKernel(WCHAR* TextInput, float** KernelPtr, int* KernelXsize, int* KernelYsize);
+
+int ResizeImageBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, int Xsize, int Ysize, int PixelSize);
+
+template <typename PIXELTYPE>
+int ReorderAlgBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int Xsize, int Ysize, int PixelSize,
+	int Algorithm, int P1, int P2, int P3, int Invert);
+
+template <typename PIXELTYPE>
+int StdDecimateImageBuffer(PIXELBUFFER<PIXELTYPE>* In, PIXELBUFFER<PIXELTYPE>* Out, int Xsize, int Ysize, int PixelSize);
+
+int ReplicateImageBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, int Xsize, int Ysize);
+
+int MathConstantImageBuffer(IMAGEBUFFER* In, IMAGEBUFFER* Out, int Value,
+	int Operation, int Warn, int* ArithmeticFlag);
@@ -54,6 +54,10 @@
 #define IDD_IMGTOOLS_REORDER_BLOCKS     170
 #define IDD_PROPERTIES_FINDAPRIME       171
 #define IDD_IMGTOOLS_EXTRACTBATCH       172
+#define IDD_BITTOOLS_AUTOCORRELATION    173
+#define IDD_IMGTOOLS_PIPELINE           174
+#define IDD_JOB_PROGRESS                175
+#define IDD_IMGTOOLS_IMAGE_MATH         176
 #define ID_IMG_STATUSBAR                200
 #define IDC_APID                        1060
 #define IDC_HEADER2SIZE                 1061
@@ -189,6 +193,42 @@
 #define IDC_CALCULATE                   1302
 #define IDC_XLOC_START                  1303
 #define IDC_YLOC_START                  1304
+#define IDC_FULL_REPORT                 1305
+#define IDC_DEFER_BMP                   1306
+#define IDC_NUM_CANDIDATES              1307
+#define IDC_DEMUX                       1308
+#define IDC_DEMUX_BINARY                1309
+#define IDC_UPDATE_IMAGE                1310
+#define IDC_RUN_PIPELINE                1311
+#define IDC_JOB_NAME                    1312
+#define IDC_JOB_PROGRESS                1313
+#define IDC_JOB_QUEUED                  1314
+#define IDC_CANCEL_JOB                  1315
+#define IDC_CANCEL_ALL                  1316
+#define IDC_SETTINGS_WORKERS            1317
+#define IDC_SETTINGS_CACHE_FOLDER       1318
+#define IDC_SETTINGS_CACHE_BROWSE       1319
+#define IDC_SETTINGS_CACHE_SIZE         1320
+#define IDC_SETTINGS_TIMING_LOG         1321
+#define IDC_SETTINGS_TIMING_BROWSE      1322
+#define IDC_XSIZE_SYMBOL_MAX            1323
+#define IDC_YSIZE_SYMBOL_MAX            1324
+#define IDC_EXTRACT_MULTI               1325
+#define IDC_SETTINGS_PACKED_IMAGES      1326
+#define IDC_SETTINGS_COMPRESS_IMAGES    1327
+#define IDC_MATH_ADD                    1328
+#define IDC_MATH_MULTIPLY               1329
+#define IDC_MATH_DIVIDE                 1330
+#define IDC_MATH_MIN                    1331
+#define IDC_MATH_MAX                    1332
+#define IDC_MATH_AND                    1333
+#define IDC_MATH_OR                     1334
+#define IDC_MATH_XOR                    1335
+#define IDC_MATH_THRESHOLD              1336
+#define IDC_MATH_SUBTRACT               1337
+#define IDC_MATH_USE_CONSTANT           1338
+#define IDC_FACTOR                      1339
+#define IDC_FACTOR_XSIZES               1340
 #define IDM_BITTOOLS_TEXT_IMAGE         32795
 #define IDM_BITTOOLS_HEXDUMP            32796
 #define IDM_BITTOOLS_TEXT_STREAM        32797
@@ -253,6 +293,11 @@
 #define IDM_RESET_WINDOW_POSITIONS      32914
 #define IDM_RESET_ZOOM                  32917
 #define IDM__RESET_PANXY                32918
+#define IDM_BITTOOLS_AUTOCORRELATION    32919
+#define IDM_NEXT_FRAME                  32920
+#define IDM_PREV_FRAME                  32921
+#define IDM_IMGTOOLS_PIPELINE           32922
+#define IDM_IMGTOOLS_IMAGE_MATH         32923
 #define IDC_STATIC                      -1
 
 // Next default values for new objects
@@ -261,8 +306,8 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NO_MFC                     1
 #define _APS_NEXT_RESOURCE_VALUE        200
-#define _APS_NEXT_COMMAND_VALUE         32919
-#define _APS_NEXT_CONTROL_VALUE         1305
+#define _APS_NEXT_COMMAND_VALUE         32924
+#define _APS_NEXT_CONTROL_VALUE         1341
 #define _APS_NEXT_SYMED_VALUE           300
 #endif
 #endif